@@ -0,0 +1,424 @@
+#include "cong/bbr2.h"
+#include <stddef.h>
+
+#define GQUIC_CONG_BBR2_MSS 1460
+#define GQUIC_CONG_BBR2_UNSET ((u_int64_t) -1)
+#define GQUIC_CONG_BBR2_STARTUP_PACING_GAIN 2.77
+#define GQUIC_CONG_BBR2_DRAIN_PACING_GAIN 0.35
+#define GQUIC_CONG_BBR2_LOSS_THRESH 0.02
+#define GQUIC_CONG_BBR2_ECN_THRESH 0.5
+#define GQUIC_CONG_BBR2_BETA 0.7
+#define GQUIC_CONG_BBR2_HEADROOM 0.85
+#define GQUIC_CONG_BBR2_FULL_BW_GROWTH 1.25
+#define GQUIC_CONG_BBR2_FULL_BW_ROUNDS 3
+#define GQUIC_CONG_BBR2_STARTUP_FULL_LOSS_COUNT 8
+#define GQUIC_CONG_BBR2_RENO_ROUNDS 63
+
+static int gquic_cong_bbr2_set_state(gquic_cong_bbr2_t *const, const u_int8_t, const u_int64_t);
+static int gquic_cong_bbr2_begin_round(gquic_cong_bbr2_t *const, const u_int64_t, const u_int64_t);
+static int gquic_cong_bbr2_end_round(gquic_cong_bbr2_t *const, const u_int64_t, const u_int64_t);
+static int gquic_cong_bbr2_update_max_bw(gquic_cong_bbr2_t *const, const u_int64_t);
+static int gquic_cong_bbr2_update_min_rtt(gquic_cong_bbr2_t *const, const u_int64_t);
+static int gquic_cong_bbr2_update_state(gquic_cong_bbr2_t *const, const u_int64_t, const u_int64_t);
+static int gquic_cong_bbr2_update_cwnd(gquic_cong_bbr2_t *const, const u_int64_t);
+static int gquic_cong_bbr2_update_pacing_rate(gquic_cong_bbr2_t *const);
+
+int gquic_cong_bbr2_init(gquic_cong_bbr2_t *const bbr) {
+    if (bbr == NULL) {
+        return -1;
+    }
+    bbr->rtt = NULL;
+    bbr->state = GQUIC_CONG_BBR2_STARTUP;
+    bbr->pacing_gain = GQUIC_CONG_BBR2_STARTUP_PACING_GAIN;
+    bbr->cwnd_gain = 2;
+    bbr->round_count = 0;
+    bbr->round_start_time = 0;
+    bbr->round_delivered = 0;
+    bbr->round_lost = 0;
+    bbr->round_ce = 0;
+    bbr->round_max_infly = 0;
+    bbr->round_app_limited = 0;
+    bbr->round_bw = 0;
+    bbr->delivered = 0;
+    bbr->max_bw_filter[0] = 0;
+    bbr->max_bw_filter[1] = 0;
+    bbr->max_bw = 0;
+    bbr->bw_lo = GQUIC_CONG_BBR2_UNSET;
+    bbr->inflight_lo = GQUIC_CONG_BBR2_UNSET;
+    bbr->inflight_hi = GQUIC_CONG_BBR2_UNSET;
+    bbr->min_rtt = 0;
+    bbr->min_rtt_stamp = 0;
+    bbr->probe_rtt_done_stamp = 0;
+    bbr->probe_rtt_round = 0;
+    bbr->prior_cwnd = 0;
+    bbr->full_bw = 0;
+    bbr->full_bw_count = 0;
+    bbr->full_bw_reached = 0;
+    bbr->cycle_count = 0;
+    bbr->cycle_stamp = 0;
+    bbr->probe_wait = 0;
+    bbr->cycle_round = 0;
+    bbr->cwnd = 0;
+    bbr->initial_cwnd = 0;
+    bbr->min_cwnd = 4 * GQUIC_CONG_BBR2_MSS;
+    bbr->max_cwnd = 0;
+    bbr->pacing_rate = 0;
+    return 0;
+}
+
+int gquic_cong_bbr2_ctor(gquic_cong_bbr2_t *const bbr, const gquic_rtt_t *const rtt, const u_int64_t initial_cwnd, const u_int64_t max_cwnd) {
+    if (bbr == NULL || rtt == NULL) {
+        return -1;
+    }
+    bbr->rtt = rtt;
+    bbr->cwnd = initial_cwnd;
+    bbr->initial_cwnd = initial_cwnd;
+    bbr->max_cwnd = max_cwnd;
+    return 0;
+}
+
+int gquic_cong_bbr2_on_packet_sent(gquic_cong_bbr2_t *const bbr, const u_int64_t bytes, const u_int64_t infly) {
+    (void) bytes;
+    if (bbr == NULL) {
+        return -1;
+    }
+    if (infly > bbr->round_max_infly) {
+        bbr->round_max_infly = infly;
+    }
+    return 0;
+}
+
+int gquic_cong_bbr2_on_packet_acked(gquic_cong_bbr2_t *const bbr,
+                                    const u_int64_t bytes,
+                                    const u_int64_t infly,
+                                    const u_int64_t sent_time,
+                                    const u_int64_t now) {
+    if (bbr == NULL) {
+        return -1;
+    }
+    bbr->delivered += bytes;
+    gquic_cong_bbr2_update_min_rtt(bbr, now);
+    if (bbr->round_start_time == 0) {
+        gquic_cong_bbr2_begin_round(bbr, now, infly);
+    }
+    else if (sent_time >= bbr->round_start_time) {
+        gquic_cong_bbr2_end_round(bbr, now, infly);
+    }
+    gquic_cong_bbr2_update_state(bbr, infly, now);
+    gquic_cong_bbr2_update_cwnd(bbr, bytes);
+    gquic_cong_bbr2_update_pacing_rate(bbr);
+    return 0;
+}
+
+int gquic_cong_bbr2_on_packet_lost(gquic_cong_bbr2_t *const bbr, const u_int64_t bytes) {
+    if (bbr == NULL) {
+        return -1;
+    }
+    // the response waits for the end of the round, when the loss rate is known
+    bbr->round_lost += bytes;
+    return 0;
+}
+
+int gquic_cong_bbr2_on_ecn_ce(gquic_cong_bbr2_t *const bbr, const u_int64_t ce_packets) {
+    if (bbr == NULL) {
+        return -1;
+    }
+    // weighed against the round's delivery at its end, like loss
+    bbr->round_ce += ce_packets * GQUIC_CONG_BBR2_MSS;
+    return 0;
+}
+
+int gquic_cong_bbr2_on_spurious_loss(gquic_cong_bbr2_t *const bbr, const u_int64_t bytes) {
+    if (bbr == NULL) {
+        return -1;
+    }
+    // reordering, not congestion: it no longer counts against this round, and the short term bounds go
+    bbr->round_lost = bbr->round_lost > bytes ? bbr->round_lost - bytes : 0;
+    bbr->bw_lo = GQUIC_CONG_BBR2_UNSET;
+    bbr->inflight_lo = GQUIC_CONG_BBR2_UNSET;
+    return 0;
+}
+
+int gquic_cong_bbr2_on_rate_sample(gquic_cong_bbr2_t *const bbr, const gquic_packet_rate_sample_t *const sample) {
+    if (bbr == NULL || sample == NULL) {
+        return -1;
+    }
+    if (sample->delivery_rate == 0) {
+        return 0;
+    }
+    if (sample->is_app_limited) {
+        bbr->round_app_limited = 1;
+    }
+    // an app limited sample only shows what the app offered, unless that was more than we knew of
+    if (!sample->is_app_limited || sample->delivery_rate > bbr->max_bw) {
+        gquic_cong_bbr2_update_max_bw(bbr, sample->delivery_rate);
+    }
+    if (sample->delivery_rate > bbr->round_bw) {
+        bbr->round_bw = sample->delivery_rate;
+    }
+    return 0;
+}
+
+u_int64_t gquic_cong_bbr2_time_until_send(gquic_cong_bbr2_t *const bbr) {
+    if (bbr == NULL || bbr->pacing_rate == 0) {
+        return 0;
+    }
+    return GQUIC_CONG_BBR2_MSS * 1000 * 1000 / bbr->pacing_rate;
+}
+
+u_int64_t gquic_cong_bbr2_bdp(const gquic_cong_bbr2_t *const bbr, const double gain) {
+    u_int64_t bw = 0;
+    if (bbr == NULL) {
+        return 0;
+    }
+    bw = bbr->max_bw < bbr->bw_lo ? bbr->max_bw : bbr->bw_lo;
+    if (bbr->min_rtt == 0 || bw == 0) {
+        return gain * bbr->initial_cwnd;
+    }
+    return gain * bw * bbr->min_rtt / (1000 * 1000);
+}
+
+static int gquic_cong_bbr2_set_state(gquic_cong_bbr2_t *const bbr, const u_int8_t state, const u_int64_t now) {
+    bbr->state = state;
+    bbr->cwnd_gain = 2;
+    switch (state) {
+    case GQUIC_CONG_BBR2_STARTUP:
+        bbr->pacing_gain = GQUIC_CONG_BBR2_STARTUP_PACING_GAIN;
+        break;
+    case GQUIC_CONG_BBR2_DRAIN:
+        bbr->pacing_gain = GQUIC_CONG_BBR2_DRAIN_PACING_GAIN;
+        break;
+    case GQUIC_CONG_BBR2_PROBE_BW_DOWN:
+        bbr->pacing_gain = 0.9;
+        // a new cycle: the filter forgets what was seen two cycles ago
+        bbr->cycle_count++;
+        bbr->max_bw_filter[1] = bbr->max_bw_filter[0];
+        bbr->max_bw_filter[0] = 0;
+        // probe again in 2 to 3 s, spread so competing flows do not probe in lockstep
+        bbr->cycle_stamp = now;
+        bbr->cycle_round = bbr->round_count;
+        bbr->probe_wait = 2 * 1000 * 1000 + (bbr->cycle_count % 8) * 125 * 1000;
+        break;
+    case GQUIC_CONG_BBR2_PROBE_BW_CRUISE:
+        bbr->pacing_gain = 1;
+        break;
+    case GQUIC_CONG_BBR2_PROBE_BW_REFILL:
+        // the lower bounds came from the previous cycle, probing starts from the full model
+        bbr->pacing_gain = 1;
+        bbr->bw_lo = GQUIC_CONG_BBR2_UNSET;
+        bbr->inflight_lo = GQUIC_CONG_BBR2_UNSET;
+        bbr->cycle_round = bbr->round_count;
+        break;
+    case GQUIC_CONG_BBR2_PROBE_BW_UP:
+        bbr->pacing_gain = 1.25;
+        bbr->cwnd_gain = 2.25;
+        bbr->cycle_round = bbr->round_count;
+        break;
+    case GQUIC_CONG_BBR2_PROBE_RTT:
+        bbr->pacing_gain = 1;
+        bbr->prior_cwnd = bbr->cwnd;
+        bbr->probe_rtt_done_stamp = 0;
+        break;
+    }
+    return 0;
+}
+
+static int gquic_cong_bbr2_begin_round(gquic_cong_bbr2_t *const bbr, const u_int64_t now, const u_int64_t infly) {
+    bbr->round_start_time = now;
+    bbr->round_delivered = bbr->delivered;
+    bbr->round_lost = 0;
+    bbr->round_ce = 0;
+    bbr->round_max_infly = infly;
+    bbr->round_app_limited = 0;
+    bbr->round_bw = 0;
+    return 0;
+}
+
+static int gquic_cong_bbr2_end_round(gquic_cong_bbr2_t *const bbr, const u_int64_t now, const u_int64_t infly) {
+    u_int64_t round_bytes = bbr->delivered - bbr->round_delivered;
+    u_int64_t sample = bbr->round_bw;
+    int congested = 0;
+    bbr->round_count++;
+
+    congested = bbr->round_lost > GQUIC_CONG_BBR2_LOSS_THRESH * (round_bytes + bbr->round_lost)
+        || bbr->round_ce > GQUIC_CONG_BBR2_ECN_THRESH * round_bytes;
+    if (congested) {
+        switch (bbr->state) {
+        case GQUIC_CONG_BBR2_STARTUP:
+            // early rounds are short, a few random losses there do not mean the pipe is full
+            if (bbr->round_lost + bbr->round_ce < GQUIC_CONG_BBR2_STARTUP_FULL_LOSS_COUNT * GQUIC_CONG_BBR2_MSS) {
+                break;
+            }
+            bbr->full_bw_reached = 1;
+            bbr->inflight_hi = bbr->round_max_infly > gquic_cong_bbr2_bdp(bbr, 1) ? bbr->round_max_infly : gquic_cong_bbr2_bdp(bbr, 1);
+            break;
+        case GQUIC_CONG_BBR2_PROBE_BW_UP:
+            bbr->inflight_hi = GQUIC_CONG_BBR2_BETA * bbr->round_max_infly;
+            if (bbr->inflight_hi < gquic_cong_bbr2_bdp(bbr, 1)) {
+                bbr->inflight_hi = gquic_cong_bbr2_bdp(bbr, 1);
+            }
+            gquic_cong_bbr2_set_state(bbr, GQUIC_CONG_BBR2_PROBE_BW_DOWN, now);
+            break;
+        default:
+            if (bbr->bw_lo == GQUIC_CONG_BBR2_UNSET) {
+                bbr->bw_lo = bbr->max_bw;
+            }
+            bbr->bw_lo = GQUIC_CONG_BBR2_BETA * bbr->bw_lo > sample ? GQUIC_CONG_BBR2_BETA * bbr->bw_lo : sample;
+            if (bbr->inflight_lo == GQUIC_CONG_BBR2_UNSET) {
+                bbr->inflight_lo = bbr->cwnd;
+            }
+            bbr->inflight_lo = GQUIC_CONG_BBR2_BETA * bbr->inflight_lo > round_bytes ? GQUIC_CONG_BBR2_BETA * bbr->inflight_lo : round_bytes;
+            break;
+        }
+    }
+    else if (bbr->state == GQUIC_CONG_BBR2_PROBE_BW_UP
+             && bbr->inflight_hi != GQUIC_CONG_BBR2_UNSET
+             && bbr->round_max_infly + GQUIC_CONG_BBR2_MSS >= bbr->inflight_hi) {
+        // the path took all inflight_hi allowed without loss, raise it exponentially per round
+        bbr->inflight_hi += GQUIC_CONG_BBR2_MSS << (bbr->round_count - bbr->cycle_round < 10 ? bbr->round_count - bbr->cycle_round : 10);
+    }
+
+    if (!bbr->full_bw_reached && !bbr->round_app_limited) {
+        if (bbr->max_bw >= GQUIC_CONG_BBR2_FULL_BW_GROWTH * bbr->full_bw) {
+            bbr->full_bw = bbr->max_bw;
+            bbr->full_bw_count = 0;
+        }
+        else if (++bbr->full_bw_count >= GQUIC_CONG_BBR2_FULL_BW_ROUNDS) {
+            bbr->full_bw_reached = 1;
+        }
+    }
+    gquic_cong_bbr2_begin_round(bbr, now, infly);
+    return 0;
+}
+
+static int gquic_cong_bbr2_update_max_bw(gquic_cong_bbr2_t *const bbr, const u_int64_t bw) {
+    if (bw > bbr->max_bw_filter[0]) {
+        bbr->max_bw_filter[0] = bw;
+    }
+    bbr->max_bw = bbr->max_bw_filter[0] > bbr->max_bw_filter[1] ? bbr->max_bw_filter[0] : bbr->max_bw_filter[1];
+    return 0;
+}
+
+static int gquic_cong_bbr2_update_min_rtt(gquic_cong_bbr2_t *const bbr, const u_int64_t now) {
+    u_int64_t sample = bbr->rtt->latest;
+    if (sample == 0) {
+        return 0;
+    }
+    if (bbr->min_rtt == 0 || sample <= bbr->min_rtt || now > bbr->min_rtt_stamp + GQUIC_CONG_BBR2_MIN_RTT_WINDOW) {
+        bbr->min_rtt = sample;
+        bbr->min_rtt_stamp = now;
+    }
+    return 0;
+}
+
+static int gquic_cong_bbr2_update_state(gquic_cong_bbr2_t *const bbr, const u_int64_t infly, const u_int64_t now) {
+    u_int64_t target = 0;
+    switch (bbr->state) {
+    case GQUIC_CONG_BBR2_STARTUP:
+        if (bbr->full_bw_reached) {
+            gquic_cong_bbr2_set_state(bbr, GQUIC_CONG_BBR2_DRAIN, now);
+        }
+        break;
+    case GQUIC_CONG_BBR2_DRAIN:
+        if (infly <= gquic_cong_bbr2_bdp(bbr, 1)) {
+            gquic_cong_bbr2_set_state(bbr, GQUIC_CONG_BBR2_PROBE_BW_DOWN, now);
+        }
+        break;
+    case GQUIC_CONG_BBR2_PROBE_BW_DOWN:
+        target = gquic_cong_bbr2_bdp(bbr, 1);
+        if (bbr->inflight_hi != GQUIC_CONG_BBR2_UNSET && GQUIC_CONG_BBR2_HEADROOM * bbr->inflight_hi < target) {
+            target = GQUIC_CONG_BBR2_HEADROOM * bbr->inflight_hi;
+        }
+        if (infly <= target) {
+            gquic_cong_bbr2_set_state(bbr, GQUIC_CONG_BBR2_PROBE_BW_CRUISE, now);
+        }
+        break;
+    case GQUIC_CONG_BBR2_PROBE_BW_CRUISE:
+        // wall clock bounded, and in rounds so a Reno flow sharing the path is not starved
+        if (now >= bbr->cycle_stamp + bbr->probe_wait || bbr->round_count - bbr->cycle_round >= GQUIC_CONG_BBR2_RENO_ROUNDS) {
+            gquic_cong_bbr2_set_state(bbr, GQUIC_CONG_BBR2_PROBE_BW_REFILL, now);
+        }
+        break;
+    case GQUIC_CONG_BBR2_PROBE_BW_REFILL:
+        if (bbr->round_count > bbr->cycle_round) {
+            gquic_cong_bbr2_set_state(bbr, GQUIC_CONG_BBR2_PROBE_BW_UP, now);
+        }
+        break;
+    case GQUIC_CONG_BBR2_PROBE_BW_UP:
+        if (bbr->round_count > bbr->cycle_round && infly >= gquic_cong_bbr2_bdp(bbr, 1.25)) {
+            gquic_cong_bbr2_set_state(bbr, GQUIC_CONG_BBR2_PROBE_BW_DOWN, now);
+        }
+        break;
+    case GQUIC_CONG_BBR2_PROBE_RTT:
+        if (bbr->probe_rtt_done_stamp == 0) {
+            if (infly <= gquic_cong_bbr2_bdp(bbr, 0.5) || infly <= bbr->min_cwnd) {
+                bbr->probe_rtt_done_stamp = now + GQUIC_CONG_BBR2_PROBE_RTT_DURATION;
+                bbr->probe_rtt_round = bbr->round_count;
+            }
+        }
+        else if (now >= bbr->probe_rtt_done_stamp && bbr->round_count > bbr->probe_rtt_round) {
+            bbr->min_rtt_stamp = now;
+            bbr->cwnd = bbr->cwnd > bbr->prior_cwnd ? bbr->cwnd : bbr->prior_cwnd;
+            gquic_cong_bbr2_set_state(bbr, bbr->full_bw_reached ? GQUIC_CONG_BBR2_PROBE_BW_DOWN : GQUIC_CONG_BBR2_STARTUP, now);
+        }
+        return 0;
+    }
+    // min rtt not seen again for a while: drain the queue briefly to measure it
+    if (bbr->min_rtt_stamp != 0 && now > bbr->min_rtt_stamp + GQUIC_CONG_BBR2_PROBE_RTT_INTERVAL) {
+        gquic_cong_bbr2_set_state(bbr, GQUIC_CONG_BBR2_PROBE_RTT, now);
+    }
+    return 0;
+}
+
+static int gquic_cong_bbr2_update_cwnd(gquic_cong_bbr2_t *const bbr, const u_int64_t bytes) {
+    u_int64_t target = gquic_cong_bbr2_bdp(bbr, bbr->cwnd_gain) + 3 * GQUIC_CONG_BBR2_MSS;
+    u_int64_t bound = 0;
+    if (bbr->full_bw_reached) {
+        bbr->cwnd = bbr->cwnd + bytes < target ? bbr->cwnd + bytes : target;
+    }
+    else if (bbr->cwnd < target || bbr->delivered < bbr->initial_cwnd) {
+        bbr->cwnd += bytes;
+    }
+
+    if (bbr->state == GQUIC_CONG_BBR2_PROBE_RTT) {
+        bound = gquic_cong_bbr2_bdp(bbr, 0.5);
+        bbr->cwnd = bbr->cwnd < bound ? bbr->cwnd : bound;
+    }
+    if (bbr->inflight_hi != GQUIC_CONG_BBR2_UNSET) {
+        // leave headroom under the loss bound except while probing for more
+        bound = bbr->state == GQUIC_CONG_BBR2_PROBE_BW_UP || bbr->state == GQUIC_CONG_BBR2_STARTUP
+            ? bbr->inflight_hi
+            : GQUIC_CONG_BBR2_HEADROOM * bbr->inflight_hi;
+        bbr->cwnd = bbr->cwnd < bound ? bbr->cwnd : bound;
+    }
+    if (bbr->inflight_lo != GQUIC_CONG_BBR2_UNSET) {
+        bbr->cwnd = bbr->cwnd < bbr->inflight_lo ? bbr->cwnd : bbr->inflight_lo;
+    }
+    if (bbr->cwnd < bbr->min_cwnd) {
+        bbr->cwnd = bbr->min_cwnd;
+    }
+    if (bbr->max_cwnd != 0 && bbr->cwnd > bbr->max_cwnd) {
+        bbr->cwnd = bbr->max_cwnd;
+    }
+    return 0;
+}
+
+static int gquic_cong_bbr2_update_pacing_rate(gquic_cong_bbr2_t *const bbr) {
+    u_int64_t bw = bbr->max_bw < bbr->bw_lo ? bbr->max_bw : bbr->bw_lo;
+    u_int64_t rate = 0;
+    if (bw == 0) {
+        if (bbr->rtt->smooth == 0) {
+            return 0;
+        }
+        rate = bbr->pacing_gain * bbr->cwnd * 1000 * 1000 / bbr->rtt->smooth;
+    }
+    else {
+        // a little under the estimate, so the bottleneck queue drains over time
+        rate = bbr->pacing_gain * bw * 0.99;
+    }
+    // before the pipe is full a low sample only means the round was short
+    if (bbr->full_bw_reached || rate > bbr->pacing_rate) {
+        bbr->pacing_rate = rate;
+    }
+    return 0;
+}
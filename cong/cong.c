@@ -0,0 +1,295 @@
+#include "cong/cong.h"
+#include "cong/cubic.h"
+#include "cong/bbr2.h"
+#include <malloc.h>
+
+static int gquic_cong_cubic_on_packet_sent_wrapper(void *const, const u_int64_t, const u_int64_t, const u_int64_t, const int);
+static int gquic_cong_cubic_on_packet_acked_wrapper(void *const, const u_int64_t, const u_int64_t, const u_int64_t, const u_int64_t, const u_int64_t);
+static int gquic_cong_cubic_on_packet_lost_wrapper(void *const, const u_int64_t, const u_int64_t, const u_int64_t);
+static int gquic_cong_cubic_on_spurious_loss_wrapper(void *const, const u_int64_t, const u_int64_t);
+static int gquic_cong_cubic_on_ecn_ce_wrapper(void *const, const u_int64_t, const u_int64_t, const u_int64_t);
+static int gquic_cong_cubic_on_rtt_updated_wrapper(void *const);
+static int gquic_cong_cubic_on_rate_sample_wrapper(void *const, const gquic_packet_rate_sample_t *const);
+static int gquic_cong_cubic_on_app_limited_wrapper(void *const, const u_int64_t);
+static int gquic_cong_cubic_can_send_wrapper(void *const, const u_int64_t);
+static u_int64_t gquic_cong_cubic_time_until_send_wrapper(void *const, const u_int64_t);
+static u_int64_t gquic_cong_cubic_pacing_rate_wrapper(void *const);
+static u_int64_t gquic_cong_cubic_cwnd_wrapper(void *const);
+static int gquic_cong_cubic_in_slow_start_wrapper(void *const);
+static int gquic_cong_cubic_in_recovery_wrapper(void *const);
+
+static int gquic_cong_bbr2_on_packet_sent_wrapper(void *const, const u_int64_t, const u_int64_t, const u_int64_t, const int);
+static int gquic_cong_bbr2_on_packet_acked_wrapper(void *const, const u_int64_t, const u_int64_t, const u_int64_t, const u_int64_t, const u_int64_t);
+static int gquic_cong_bbr2_on_packet_lost_wrapper(void *const, const u_int64_t, const u_int64_t, const u_int64_t);
+static int gquic_cong_bbr2_on_spurious_loss_wrapper(void *const, const u_int64_t, const u_int64_t);
+static int gquic_cong_bbr2_on_ecn_ce_wrapper(void *const, const u_int64_t, const u_int64_t, const u_int64_t);
+static int gquic_cong_bbr2_on_rtt_updated_wrapper(void *const);
+static int gquic_cong_bbr2_on_rate_sample_wrapper(void *const, const gquic_packet_rate_sample_t *const);
+static int gquic_cong_bbr2_on_app_limited_wrapper(void *const, const u_int64_t);
+static int gquic_cong_bbr2_can_send_wrapper(void *const, const u_int64_t);
+static u_int64_t gquic_cong_bbr2_time_until_send_wrapper(void *const, const u_int64_t);
+static u_int64_t gquic_cong_bbr2_pacing_rate_wrapper(void *const);
+static u_int64_t gquic_cong_bbr2_cwnd_wrapper(void *const);
+static int gquic_cong_bbr2_in_slow_start_wrapper(void *const);
+static int gquic_cong_bbr2_in_recovery_wrapper(void *const);
+
+static int gquic_cong_free_wrapper(void *const);
+
+int gquic_cong_init(gquic_cong_t *const cong) {
+    if (cong == NULL) {
+        return -1;
+    }
+    cong->self = NULL;
+    cong->on_packet_sent = NULL;
+    cong->on_packet_acked = NULL;
+    cong->on_packet_lost = NULL;
+    cong->on_spurious_loss = NULL;
+    cong->on_ecn_ce = NULL;
+    cong->on_rtt_updated = NULL;
+    cong->on_rate_sample = NULL;
+    cong->on_app_limited = NULL;
+    cong->can_send = NULL;
+    cong->time_until_send = NULL;
+    cong->pacing_rate = NULL;
+    cong->cwnd = NULL;
+    cong->in_slow_start = NULL;
+    cong->in_recovery = NULL;
+    cong->dtor = NULL;
+    return 0;
+}
+
+int gquic_cong_ctor(gquic_cong_t *const cong,
+                    const int algo,
+                    const gquic_rtt_t *const rtt,
+                    const u_int64_t initial_cwnd,
+                    const u_int64_t max_cwnd) {
+    gquic_cong_cubic_t *cubic = NULL;
+    gquic_cong_bbr2_t *bbr = NULL;
+    if (cong == NULL || rtt == NULL) {
+        return -1;
+    }
+    switch (algo) {
+    case GQUIC_CONG_CUBIC:
+        if ((cubic = malloc(sizeof(gquic_cong_cubic_t))) == NULL) {
+            return -2;
+        }
+        gquic_cong_cubic_init(cubic);
+        gquic_cong_cubic_ctor(cubic, rtt, initial_cwnd, max_cwnd);
+        cong->self = cubic;
+        cong->on_packet_sent = gquic_cong_cubic_on_packet_sent_wrapper;
+        cong->on_packet_acked = gquic_cong_cubic_on_packet_acked_wrapper;
+        cong->on_packet_lost = gquic_cong_cubic_on_packet_lost_wrapper;
+        cong->on_spurious_loss = gquic_cong_cubic_on_spurious_loss_wrapper;
+        cong->on_ecn_ce = gquic_cong_cubic_on_ecn_ce_wrapper;
+        cong->on_rtt_updated = gquic_cong_cubic_on_rtt_updated_wrapper;
+        cong->on_rate_sample = gquic_cong_cubic_on_rate_sample_wrapper;
+        cong->on_app_limited = gquic_cong_cubic_on_app_limited_wrapper;
+        cong->can_send = gquic_cong_cubic_can_send_wrapper;
+        cong->time_until_send = gquic_cong_cubic_time_until_send_wrapper;
+        cong->pacing_rate = gquic_cong_cubic_pacing_rate_wrapper;
+        cong->cwnd = gquic_cong_cubic_cwnd_wrapper;
+        cong->in_slow_start = gquic_cong_cubic_in_slow_start_wrapper;
+        cong->in_recovery = gquic_cong_cubic_in_recovery_wrapper;
+        break;
+    case GQUIC_CONG_BBR2:
+        if ((bbr = malloc(sizeof(gquic_cong_bbr2_t))) == NULL) {
+            return -2;
+        }
+        gquic_cong_bbr2_init(bbr);
+        gquic_cong_bbr2_ctor(bbr, rtt, initial_cwnd, max_cwnd);
+        cong->self = bbr;
+        cong->on_packet_sent = gquic_cong_bbr2_on_packet_sent_wrapper;
+        cong->on_packet_acked = gquic_cong_bbr2_on_packet_acked_wrapper;
+        cong->on_packet_lost = gquic_cong_bbr2_on_packet_lost_wrapper;
+        cong->on_spurious_loss = gquic_cong_bbr2_on_spurious_loss_wrapper;
+        cong->on_ecn_ce = gquic_cong_bbr2_on_ecn_ce_wrapper;
+        cong->on_rtt_updated = gquic_cong_bbr2_on_rtt_updated_wrapper;
+        cong->on_rate_sample = gquic_cong_bbr2_on_rate_sample_wrapper;
+        cong->on_app_limited = gquic_cong_bbr2_on_app_limited_wrapper;
+        cong->can_send = gquic_cong_bbr2_can_send_wrapper;
+        cong->time_until_send = gquic_cong_bbr2_time_until_send_wrapper;
+        cong->pacing_rate = gquic_cong_bbr2_pacing_rate_wrapper;
+        cong->cwnd = gquic_cong_bbr2_cwnd_wrapper;
+        cong->in_slow_start = gquic_cong_bbr2_in_slow_start_wrapper;
+        cong->in_recovery = gquic_cong_bbr2_in_recovery_wrapper;
+        break;
+    default:
+        return -3;
+    }
+    cong->dtor = gquic_cong_free_wrapper;
+    return 0;
+}
+
+int gquic_cong_dtor(gquic_cong_t *const cong) {
+    if (cong == NULL) {
+        return -1;
+    }
+    if (cong->dtor != NULL) {
+        cong->dtor(cong->self);
+    }
+    gquic_cong_init(cong);
+    return 0;
+}
+
+static int gquic_cong_cubic_on_packet_sent_wrapper(void *const self,
+                                                   const u_int64_t pn,
+                                                   const u_int64_t bytes,
+                                                   const u_int64_t infly,
+                                                   const int ack_eliciting) {
+    (void) infly;
+    return gquic_cong_cubic_on_packet_sent(self, pn, bytes, ack_eliciting);
+}
+
+static int gquic_cong_cubic_on_packet_acked_wrapper(void *const self,
+                                                    const u_int64_t pn,
+                                                    const u_int64_t bytes,
+                                                    const u_int64_t infly,
+                                                    const u_int64_t sent_time,
+                                                    const u_int64_t now) {
+    (void) sent_time;
+    return gquic_cong_cubic_on_packet_acked(self, pn, bytes, infly, now);
+}
+
+static int gquic_cong_cubic_on_packet_lost_wrapper(void *const self, const u_int64_t pn, const u_int64_t bytes, const u_int64_t infly) {
+    return gquic_cong_cubic_on_packet_lost(self, pn, bytes, infly);
+}
+
+static int gquic_cong_cubic_on_spurious_loss_wrapper(void *const self, const u_int64_t pn, const u_int64_t bytes) {
+    (void) bytes;
+    return gquic_cong_cubic_on_spurious_loss(self, pn);
+}
+
+static int gquic_cong_cubic_on_ecn_ce_wrapper(void *const self, const u_int64_t pn, const u_int64_t ce_packets, const u_int64_t infly) {
+    (void) ce_packets;
+    return gquic_cong_cubic_on_ecn_ce(self, pn, infly);
+}
+
+static int gquic_cong_cubic_on_rtt_updated_wrapper(void *const self) {
+    return gquic_cong_cubic_try_exit_slow_start(self);
+}
+
+static int gquic_cong_cubic_on_rate_sample_wrapper(void *const self, const gquic_packet_rate_sample_t *const sample) {
+    // cubic is loss based
+    (void) self;
+    (void) sample;
+    return 0;
+}
+
+static int gquic_cong_cubic_on_app_limited_wrapper(void *const self, const u_int64_t infly) {
+    // cubic already holds its window while not cwnd limited
+    (void) self;
+    (void) infly;
+    return 0;
+}
+
+static int gquic_cong_cubic_can_send_wrapper(void *const self, const u_int64_t infly) {
+    return gquic_cong_cubic_allowable_send(self, infly);
+}
+
+static u_int64_t gquic_cong_cubic_time_until_send_wrapper(void *const self, const u_int64_t infly) {
+    return gquic_cong_cubic_time_util_send(self, infly);
+}
+
+static u_int64_t gquic_cong_cubic_pacing_rate_wrapper(void *const self) {
+    return gquic_cong_cubic_pacing_rate(self);
+}
+
+static u_int64_t gquic_cong_cubic_cwnd_wrapper(void *const self) {
+    return ((gquic_cong_cubic_t *) self)->cwnd;
+}
+
+static int gquic_cong_cubic_in_slow_start_wrapper(void *const self) {
+    return gquic_cong_cubic_in_slow_start(self);
+}
+
+static int gquic_cong_cubic_in_recovery_wrapper(void *const self) {
+    return gquic_cong_cubic_in_recovery(self);
+}
+
+static int gquic_cong_bbr2_on_packet_sent_wrapper(void *const self,
+                                                  const u_int64_t pn,
+                                                  const u_int64_t bytes,
+                                                  const u_int64_t infly,
+                                                  const int ack_eliciting) {
+    (void) pn;
+    if (!ack_eliciting) {
+        return 0;
+    }
+    return gquic_cong_bbr2_on_packet_sent(self, bytes, infly);
+}
+
+static int gquic_cong_bbr2_on_packet_acked_wrapper(void *const self,
+                                                   const u_int64_t pn,
+                                                   const u_int64_t bytes,
+                                                   const u_int64_t infly,
+                                                   const u_int64_t sent_time,
+                                                   const u_int64_t now) {
+    (void) pn;
+    return gquic_cong_bbr2_on_packet_acked(self, bytes, infly, sent_time, now);
+}
+
+static int gquic_cong_bbr2_on_packet_lost_wrapper(void *const self, const u_int64_t pn, const u_int64_t bytes, const u_int64_t infly) {
+    (void) pn;
+    (void) infly;
+    return gquic_cong_bbr2_on_packet_lost(self, bytes);
+}
+
+static int gquic_cong_bbr2_on_spurious_loss_wrapper(void *const self, const u_int64_t pn, const u_int64_t bytes) {
+    (void) pn;
+    return gquic_cong_bbr2_on_spurious_loss(self, bytes);
+}
+
+static int gquic_cong_bbr2_on_ecn_ce_wrapper(void *const self, const u_int64_t pn, const u_int64_t ce_packets, const u_int64_t infly) {
+    (void) pn;
+    (void) infly;
+    return gquic_cong_bbr2_on_ecn_ce(self, ce_packets);
+}
+
+static int gquic_cong_bbr2_on_rtt_updated_wrapper(void *const self) {
+    // min rtt is taken on the ack that follows
+    (void) self;
+    return 0;
+}
+
+static int gquic_cong_bbr2_on_rate_sample_wrapper(void *const self, const gquic_packet_rate_sample_t *const sample) {
+    return gquic_cong_bbr2_on_rate_sample(self, sample);
+}
+
+static int gquic_cong_bbr2_on_app_limited_wrapper(void *const self, const u_int64_t infly) {
+    // the rate samples carry it
+    (void) self;
+    (void) infly;
+    return 0;
+}
+
+static int gquic_cong_bbr2_can_send_wrapper(void *const self, const u_int64_t infly) {
+    return infly < ((gquic_cong_bbr2_t *) self)->cwnd;
+}
+
+static u_int64_t gquic_cong_bbr2_time_until_send_wrapper(void *const self, const u_int64_t infly) {
+    (void) infly;
+    return gquic_cong_bbr2_time_until_send(self);
+}
+
+static u_int64_t gquic_cong_bbr2_pacing_rate_wrapper(void *const self) {
+    return ((gquic_cong_bbr2_t *) self)->pacing_rate;
+}
+
+static u_int64_t gquic_cong_bbr2_cwnd_wrapper(void *const self) {
+    return ((gquic_cong_bbr2_t *) self)->cwnd;
+}
+
+static int gquic_cong_bbr2_in_slow_start_wrapper(void *const self) {
+    return ((gquic_cong_bbr2_t *) self)->state == GQUIC_CONG_BBR2_STARTUP;
+}
+
+static int gquic_cong_bbr2_in_recovery_wrapper(void *const self) {
+    // loss only bounds the model, there is no recovery window
+    (void) self;
+    return 0;
+}
+
+static int gquic_cong_free_wrapper(void *const self) {
+    free(self);
+    return 0;
+}
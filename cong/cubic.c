@@ -7,7 +7,7 @@ int gquic_cong_cubic_init(gquic_cong_cubic_t *const cubic) {
     if (cubic == NULL) {
         return -1;
     }
-    gquic_cong_hybrid_slow_start_init(&cubic->hybrid_slow_start);
+    gquic_cong_hystart_init(&cubic->hystart);
     gquic_prr_init(&cubic->prr);
     cubic->rtt = NULL;
     gquic_cubic_init(&cubic->cubic);
@@ -28,6 +28,12 @@ int gquic_cong_cubic_init(gquic_cong_cubic_t *const cubic) {
     cubic->initial_cwnd = 0;
     cubic->initial_max_cwnd = 0;
     cubic->min_slow_start_exit_wnd = 0;
+    cubic->undo.lost_packets = 0;
+    cubic->undo.cwnd = 0;
+    cubic->undo.slow_start_threshold = 0;
+    cubic->undo.largest_sent_last_cut = -1;
+    gquic_cubic_init(&cubic->undo.cubic);
+    cubic->undo.hystart_state = GQUIC_CONG_HYSTART_SLOW_START;
 
     return 0;
 }
@@ -40,8 +46,8 @@ int gquic_cong_cubic_ctor(gquic_cong_cubic_t *const cubic, const gquic_rtt_t *co
     cubic->initial_max_cwnd = initial_max_cwnd;
     cubic->cwnd = initial_cwnd;
     cubic->min_cwnd = 1460 * 2;
-    cubic->slow_start_threshold = initial_cwnd;
-    cubic->max_cwnd = initial_cwnd;
+    cubic->slow_start_threshold = initial_max_cwnd;
+    cubic->max_cwnd = initial_max_cwnd;
     cubic->conn_count = 1;
     cubic->rtt = rtt;
 
@@ -60,6 +66,13 @@ u_int64_t gquic_cong_cubic_time_util_send(gquic_cong_cubic_t *const cubic, const
     return cubic->rtt->smooth * 1460 / (2 * cubic->cwnd);
 }
 
+u_int64_t gquic_cong_cubic_pacing_rate(gquic_cong_cubic_t *const cubic) {
+    if (cubic == NULL || cubic->rtt->smooth == 0) {
+        return 0;
+    }
+    return 2 * cubic->cwnd * 1000 * 1000 / cubic->rtt->smooth;
+}
+
 int gquic_cong_cubic_on_packet_sent(gquic_cong_cubic_t *const cubic,
                                     const u_int64_t pn,
                                     const u_int64_t bytes,
@@ -74,7 +87,7 @@ int gquic_cong_cubic_on_packet_sent(gquic_cong_cubic_t *const cubic,
         cubic->prr.sent_bytes += bytes;
     }
     cubic->largest_sent_pn = pn;
-    cubic->hybrid_slow_start.last_sent_pn = pn;
+    gquic_cong_hystart_on_packet_sent(&cubic->hystart, pn);
     return 0;
 }
 
@@ -107,8 +120,10 @@ int gquic_cong_cubic_on_packet_acked(gquic_cong_cubic_t *const cubic,
     }
     gquic_cong_cubic_try_increase_cwnd(cubic, acked_bytes, infly, event_time);
     if (gquic_cong_cubic_in_slow_start(cubic)) {
-        if (cubic->hybrid_slow_start.end_pn < pn) {
-            cubic->hybrid_slow_start.started = 0;
+        gquic_cong_hystart_on_packet_acked(&cubic->hystart, pn);
+        // conservative slow start ran its rounds without the rtt falling back
+        if (cubic->hystart.state == GQUIC_CONG_HYSTART_DONE) {
+            cubic->slow_start_threshold = cubic->cwnd;
         }
     }
     return 0;
@@ -129,7 +144,7 @@ static int gquic_cong_cubic_try_increase_cwnd(gquic_cong_cubic_t *const cubic,
         return 0;
     }
     if (gquic_cong_cubic_in_slow_start(cubic)) {
-        cubic->cwnd += 1460;
+        cubic->cwnd += gquic_cong_hystart_cwnd_increase(&cubic->hystart, 1460);
         return 0;
     }
     cubic->cwnd = gquic_cubic_cwnd_after_packet_ack(&cubic->cubic, ack_bytes, cubic->cwnd, cubic->rtt->min, event_time);
@@ -158,7 +173,11 @@ int gquic_cong_cubic_on_packet_lost(gquic_cong_cubic_t *const cubic,
     if (cubic == NULL) {
         return -1;
     }
-    if (pn <= cubic->largest_sent_last_cut) {
+    if (cubic->largest_sent_last_cut != (u_int64_t) -1 && pn <= cubic->largest_sent_last_cut) {
+        if (cubic->undo.lost_packets != 0
+            && (cubic->undo.largest_sent_last_cut == (u_int64_t) -1 || pn > cubic->undo.largest_sent_last_cut)) {
+            cubic->undo.lost_packets++;
+        }
         if (cubic->last_cut_slow_start_exited) {
             cubic->stat.lost_packets++;
             cubic->stat.lost_bytes += lost_bytes;
@@ -170,6 +189,12 @@ int gquic_cong_cubic_on_packet_lost(gquic_cong_cubic_t *const cubic,
         }
         return 0;
     }
+    cubic->undo.lost_packets = 1;
+    cubic->undo.cwnd = cubic->cwnd;
+    cubic->undo.slow_start_threshold = cubic->slow_start_threshold;
+    cubic->undo.largest_sent_last_cut = cubic->largest_sent_last_cut;
+    cubic->undo.cubic = cubic->cubic;
+    cubic->undo.hystart_state = cubic->hystart.state;
     cubic->last_cut_slow_start_exited = gquic_cong_cubic_in_slow_start(cubic);
     if (gquic_cong_cubic_in_slow_start(cubic)) {
         cubic->stat.lost_packets++;
@@ -190,8 +215,59 @@ int gquic_cong_cubic_on_packet_lost(gquic_cong_cubic_t *const cubic,
         cubic->cwnd = cubic->min_cwnd;
     }
     cubic->slow_start_threshold = cubic->cwnd;
+    gquic_cong_hystart_exit(&cubic->hystart);
+    cubic->largest_sent_last_cut = cubic->largest_sent_pn;
+    cubic->acked_packets_count = 0;
+
+    return 0;
+}
+
+int gquic_cong_cubic_on_ecn_ce(gquic_cong_cubic_t *const cubic, const u_int64_t pn, const u_int64_t infly) {
+    if (cubic == NULL) {
+        return -1;
+    }
+    // like a loss, at most one cut per window
+    if (cubic->largest_sent_last_cut != (u_int64_t) -1 && pn <= cubic->largest_sent_last_cut) {
+        return 0;
+    }
+    // nothing was lost, so there is nothing for a spurious loss to undo
+    cubic->undo.lost_packets = 0;
+    cubic->last_cut_slow_start_exited = 0;
+    if (!cubic->disable_prr) {
+        gquic_prr_packet_lost(&cubic->prr, infly);
+    }
+    cubic->cwnd = gquic_cubic_cwnd_after_packet_loss(&cubic->cubic, cubic->cwnd);
+    if (cubic->cwnd < cubic->min_cwnd) {
+        cubic->cwnd = cubic->min_cwnd;
+    }
+    cubic->slow_start_threshold = cubic->cwnd;
+    gquic_cong_hystart_exit(&cubic->hystart);
     cubic->largest_sent_last_cut = cubic->largest_sent_pn;
     cubic->acked_packets_count = 0;
 
     return 0;
 }
+
+int gquic_cong_cubic_on_spurious_loss(gquic_cong_cubic_t *const cubic, const u_int64_t pn) {
+    if (cubic == NULL) {
+        return -1;
+    }
+    // only losses behind the last cut count, older ones were settled by it
+    if (cubic->undo.lost_packets == 0
+        || cubic->largest_sent_last_cut == (u_int64_t) -1
+        || pn > cubic->largest_sent_last_cut
+        || (cubic->undo.largest_sent_last_cut != (u_int64_t) -1 && pn <= cubic->undo.largest_sent_last_cut)) {
+        return 0;
+    }
+    if (--cubic->undo.lost_packets != 0) {
+        return 0;
+    }
+    cubic->cwnd = cubic->cwnd > cubic->undo.cwnd ? cubic->cwnd : cubic->undo.cwnd;
+    cubic->slow_start_threshold = cubic->slow_start_threshold > cubic->undo.slow_start_threshold
+        ? cubic->slow_start_threshold
+        : cubic->undo.slow_start_threshold;
+    cubic->largest_sent_last_cut = cubic->undo.largest_sent_last_cut;
+    cubic->cubic = cubic->undo.cubic;
+    cubic->hystart.state = cubic->undo.hystart_state;
+    return 0;
+}
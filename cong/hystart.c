@@ -0,0 +1,105 @@
+#include "cong/hystart.h"
+#include <stddef.h>
+
+static int gquic_cong_hystart_start_round(gquic_cong_hystart_t *const);
+
+int gquic_cong_hystart_init(gquic_cong_hystart_t *const hystart) {
+    if (hystart == NULL) {
+        return -1;
+    }
+    hystart->state = GQUIC_CONG_HYSTART_SLOW_START;
+    hystart->window_end = 0;
+    hystart->last_sent_pn = 0;
+    hystart->rtt_sample_count = 0;
+    hystart->current_round_min_rtt = -1;
+    hystart->last_round_min_rtt = -1;
+    hystart->css_baseline_min_rtt = -1;
+    hystart->css_rounds = 0;
+
+    return 0;
+}
+
+int gquic_cong_hystart_on_packet_sent(gquic_cong_hystart_t *const hystart, const u_int64_t pn) {
+    if (hystart == NULL) {
+        return -1;
+    }
+    hystart->last_sent_pn = pn;
+    return 0;
+}
+
+static int gquic_cong_hystart_start_round(gquic_cong_hystart_t *const hystart) {
+    if (hystart == NULL) {
+        return -1;
+    }
+    hystart->window_end = hystart->last_sent_pn;
+    hystart->last_round_min_rtt = hystart->current_round_min_rtt;
+    hystart->current_round_min_rtt = -1;
+    hystart->rtt_sample_count = 0;
+    return 0;
+}
+
+int gquic_cong_hystart_on_rtt_sample(gquic_cong_hystart_t *const hystart, const u_int64_t rtt) {
+    u_int64_t thresh = 0;
+    if (hystart == NULL) {
+        return -1;
+    }
+    if (hystart->state == GQUIC_CONG_HYSTART_DONE) {
+        return 0;
+    }
+    hystart->current_round_min_rtt = rtt < hystart->current_round_min_rtt ? rtt : hystart->current_round_min_rtt;
+    hystart->rtt_sample_count++;
+    if (hystart->rtt_sample_count < GQUIC_CONG_HYSTART_N_RTT_SAMPLE || hystart->last_round_min_rtt == (u_int64_t) -1) {
+        return 0;
+    }
+    switch (hystart->state) {
+    case GQUIC_CONG_HYSTART_SLOW_START:
+        thresh = hystart->last_round_min_rtt / GQUIC_CONG_HYSTART_MIN_RTT_DIVISOR;
+        thresh = thresh < GQUIC_CONG_HYSTART_MAX_RTT_THRESH ? thresh : GQUIC_CONG_HYSTART_MAX_RTT_THRESH;
+        thresh = thresh > GQUIC_CONG_HYSTART_MIN_RTT_THRESH ? thresh : GQUIC_CONG_HYSTART_MIN_RTT_THRESH;
+        if (hystart->current_round_min_rtt >= hystart->last_round_min_rtt + thresh) {
+            hystart->css_baseline_min_rtt = hystart->current_round_min_rtt;
+            hystart->css_rounds = 0;
+            hystart->state = GQUIC_CONG_HYSTART_CSS;
+        }
+        break;
+    case GQUIC_CONG_HYSTART_CSS:
+        if (hystart->current_round_min_rtt < hystart->css_baseline_min_rtt) {
+            hystart->css_baseline_min_rtt = -1;
+            hystart->state = GQUIC_CONG_HYSTART_SLOW_START;
+        }
+        break;
+    }
+    return 0;
+}
+
+int gquic_cong_hystart_on_packet_acked(gquic_cong_hystart_t *const hystart, const u_int64_t pn) {
+    if (hystart == NULL) {
+        return -1;
+    }
+    if (hystart->state == GQUIC_CONG_HYSTART_DONE || pn <= hystart->window_end) {
+        return 0;
+    }
+    if (hystart->state == GQUIC_CONG_HYSTART_CSS && ++hystart->css_rounds >= GQUIC_CONG_HYSTART_CSS_ROUNDS) {
+        hystart->state = GQUIC_CONG_HYSTART_DONE;
+        return 0;
+    }
+    return gquic_cong_hystart_start_round(hystart);
+}
+
+int gquic_cong_hystart_exit(gquic_cong_hystart_t *const hystart) {
+    if (hystart == NULL) {
+        return -1;
+    }
+    hystart->state = GQUIC_CONG_HYSTART_DONE;
+    return 0;
+}
+
+u_int64_t gquic_cong_hystart_cwnd_increase(const gquic_cong_hystart_t *const hystart, const u_int64_t acked_bytes) {
+    if (hystart == NULL) {
+        return 0;
+    }
+    if (hystart->state == GQUIC_CONG_HYSTART_CSS) {
+        return acked_bytes / GQUIC_CONG_HYSTART_CSS_GROWTH_DIVISOR;
+    }
+    return acked_bytes;
+}
@@ -39,9 +39,9 @@ static size_t gquic_frame_ack_size(const void *const frame) {
         return 0;
     }
     ret = 1 + gquic_varint_size(&spec->largest_ack) + gquic_varint_size(&spec->delay) + gquic_varint_size(&spec->count) + gquic_varint_size(&spec->first_range);
-    gquic_frame_ack_range_t *range;
-    GQUIC_LIST_FOREACH(range, &spec->ranges) {
-        ret += gquic_varint_size(&range->gap) + gquic_varint_size(&range->range);
+    u_int64_t i = 0;
+    for (i = 0; i < spec->count; i++) {
+        ret += gquic_varint_size(&spec->ranges[i].gap) + gquic_varint_size(&spec->ranges[i].range);
     }
     if (GQUIC_FRAME_META(spec).type == 0x03) {
         ret += gquic_varint_size(&spec->ecn.ect[0]) + gquic_varint_size(&spec->ecn.ect[1]) + gquic_varint_size(&spec->ecn.ecn_ce);
@@ -67,13 +67,11 @@ static int gquic_frame_ack_serialize(const void *const frame, gquic_writer_str_t
             return -4;
         }
     }
-    gquic_frame_ack_range_t *range;
-    GQUIC_LIST_FOREACH(range, &spec->ranges) {
-        u_int64_t *vars[] = { &range->gap, &range->range };
-        for (i = 0; i < 2; i++) {
-            if (gquic_varint_serialize(vars[i], writer) != 0) {
-                return -5;
-            }
+    u_int64_t j = 0;
+    for (j = 0; j < spec->count; j++) {
+        if (gquic_varint_serialize(&spec->ranges[j].gap, writer) != 0
+            || gquic_varint_serialize(&spec->ranges[j].range, writer) != 0) {
+            return -5;
         }
     }
     if (GQUIC_FRAME_META(spec).type == 0x03) {
@@ -105,20 +103,20 @@ static int gquic_frame_ack_deserialize(void *const frame, gquic_reader_str_t *co
             return -3;
         }
     }
-    for (i = 0; i < spec->count - 1; i++) {
-        gquic_frame_ack_range_t *range = gquic_list_alloc(sizeof(gquic_frame_ack_range_t));
-        gquic_frame_ack_range_init(range);
-        if (gquic_list_insert_before(&spec->ranges, range) != 0) {
-            return -4;
+    for (i = 0; i < spec->count; i++) {
+        gquic_frame_ack_range_t range;
+        gquic_frame_ack_range_init(&range);
+        if (gquic_varint_deserialize(&range.gap, reader) != 0
+            || gquic_varint_deserialize(&range.range, reader) != 0) {
+            return -5;
         }
-        u_int64_t *range_vars[] = { &range->gap, &range->range };
-        int j = 0;
-        for (j = 0; j < 2; j++) {
-            if (gquic_varint_deserialize(range_vars[i], reader) != 0) {
-                return -5;
-            }
+        if (i < GQUIC_FRAME_ACK_MAX_RANGES) {
+            spec->ranges[i] = range;
         }
     }
+    if (spec->count > GQUIC_FRAME_ACK_MAX_RANGES) {
+        spec->count = GQUIC_FRAME_ACK_MAX_RANGES;
+    }
 
     if (GQUIC_FRAME_META(spec).type == 0x03) {
         u_int64_t *vars[] = { &spec->ecn.ect[0], &spec->ecn.ect[1], &spec->ecn.ecn_ce };
@@ -143,7 +141,6 @@ static int gquic_frame_ack_init(void *const frame) {
     spec->ecn.ect[1] = 0;
     spec->first_range = 0;
     spec->largest_ack = 0;
-    gquic_list_head_init(&spec->ranges);
     return 0;
 }
 
@@ -152,9 +149,7 @@ static int gquic_frame_ack_dtor(void *const frame) {
     if (spec == NULL) {
         return -1;
     }
-    while (gquic_list_next(GQUIC_LIST_PAYLOAD(&spec->ranges)) != GQUIC_LIST_PAYLOAD(&spec->ranges)) {
-        gquic_list_release(gquic_list_next(GQUIC_LIST_PAYLOAD(&spec->ranges)));
-    }
+    spec->count = 0;
     return 0;
 }
 
@@ -163,11 +158,11 @@ int gquic_frame_ack_acks_packet(const gquic_list_t *const blocks, const u_int64_
     if (blocks == NULL) {
         return 0;
     }
-    if (pn < ((gquic_frame_ack_block_t *) GQUIC_LIST_LAST(&blocks))->smallest
-        || ((gquic_frame_ack_block_t *) GQUIC_LIST_FIRST(&blocks))->largest < pn) {
+    if (pn < ((gquic_frame_ack_block_t *) GQUIC_LIST_LAST(blocks))->smallest
+        || ((gquic_frame_ack_block_t *) GQUIC_LIST_FIRST(blocks))->largest < pn) {
         return 0;
     }
-    GQUIC_LIST_FOREACH(block, &blocks) {
+    GQUIC_LIST_FOREACH(block, blocks) {
         if (pn >= block->smallest) {
             return pn <= block->largest;
         }
@@ -177,9 +172,9 @@ int gquic_frame_ack_acks_packet(const gquic_list_t *const blocks, const u_int64_
 
 int gquic_frame_ack_ranges_to_blocks(gquic_list_t *const blocks, const gquic_frame_ack_t *const spec) {
     gquic_frame_ack_block_t *block = NULL;
-    gquic_frame_ack_range_t *range = NULL;
     u_int64_t largest = 0;
     u_int64_t smallest = 0;
+    u_int64_t i = 0;
     if (blocks == NULL || spec == NULL) {
         return -1;
     }
@@ -191,9 +186,9 @@ int gquic_frame_ack_ranges_to_blocks(gquic_list_t *const blocks, const gquic_fra
     block->largest = largest;
     block->smallest = smallest;
     gquic_list_insert_before(blocks, block);
-    GQUIC_LIST_FOREACH(range, &spec->ranges) {
-        largest = smallest - range->gap - 2;
-        smallest = largest - range->range;
+    for (i = 0; i < spec->count; i++) {
+        largest = smallest - spec->ranges[i].gap - 2;
+        smallest = largest - spec->ranges[i].range;
         if ((block = gquic_list_alloc(sizeof(gquic_frame_ack_block_t))) == NULL) {
             return -3;
         }
@@ -206,7 +201,6 @@ int gquic_frame_ack_ranges_to_blocks(gquic_list_t *const blocks, const gquic_fra
 
 int gquic_frame_ack_ranges_from_blocks(gquic_frame_ack_t *const spec, const gquic_list_t *const blocks) {
     int is_first = 1;
-    gquic_frame_ack_range_t *range = NULL;
     gquic_frame_ack_block_t *block = NULL;
     u_int64_t largest = 0;
     u_int64_t smallest = 0;
@@ -224,13 +218,13 @@ int gquic_frame_ack_ranges_from_blocks(gquic_frame_ack_t *const spec, const gqui
             is_first = 0;
             continue;
         }
-        if ((range = gquic_list_alloc(sizeof(gquic_frame_ack_range_t))) == NULL) {
-            return -2;
+        if (spec->count >= GQUIC_FRAME_ACK_MAX_RANGES) {
+            break;
         }
-        range->gap = smallest - block->largest - 2;
-        range->range = block->largest - block->smallest;
-        gquic_list_insert_before(&spec->ranges, range);
+        spec->ranges[spec->count].gap = smallest - block->largest - 2;
+        spec->ranges[spec->count].range = block->largest - block->smallest;
         spec->count++;
+        smallest = block->smallest;
     }
 
     return 0;
@@ -0,0 +1,98 @@
+#include "frame/ack_frequency.h"
+#include "frame/meta.h"
+#include <stddef.h>
+
+static size_t gquic_frame_ack_frequency_size(const void *const);
+static int gquic_frame_ack_frequency_serialize(const void *const, gquic_writer_str_t *const);
+static int gquic_frame_ack_frequency_deserialize(void *const, gquic_reader_str_t *const);
+static int gquic_frame_ack_frequency_init(void *const);
+static int gquic_frame_ack_frequency_dtor(void *const);
+
+gquic_frame_ack_frequency_t *gquic_frame_ack_frequency_alloc() {
+    gquic_frame_ack_frequency_t *frame = gquic_frame_alloc(sizeof(gquic_frame_ack_frequency_t));
+    if (frame == NULL) {
+        return NULL;
+    }
+    GQUIC_FRAME_META(frame).type = 0xaf;
+    GQUIC_FRAME_META(frame).deserialize_func = gquic_frame_ack_frequency_deserialize;
+    GQUIC_FRAME_META(frame).init_func = gquic_frame_ack_frequency_init;
+    GQUIC_FRAME_META(frame).dtor_func = gquic_frame_ack_frequency_dtor;
+    GQUIC_FRAME_META(frame).serialize_func = gquic_frame_ack_frequency_serialize;
+    GQUIC_FRAME_META(frame).size_func = gquic_frame_ack_frequency_size;
+    return frame;
+}
+
+static size_t gquic_frame_ack_frequency_size(const void *const frame) {
+    const gquic_frame_ack_frequency_t *spec = frame;
+    u_int64_t type = 0;
+    if (spec == NULL) {
+        return 0;
+    }
+    type = GQUIC_FRAME_META(spec).type;
+    return gquic_varint_size(&type)
+        + gquic_varint_size(&spec->seq)
+        + gquic_varint_size(&spec->ack_eliciting_threshold)
+        + gquic_varint_size(&spec->max_ack_delay)
+        + gquic_varint_size(&spec->reordering_threshold);
+}
+
+static int gquic_frame_ack_frequency_serialize(const void *const frame, gquic_writer_str_t *const writer) {
+    const gquic_frame_ack_frequency_t *spec = frame;
+    u_int64_t type = 0;
+    int i = 0;
+    if (spec == NULL || writer == NULL) {
+        return -1;
+    }
+    if (GQUIC_FRAME_SIZE(spec) > GQUIC_STR_SIZE(writer)) {
+        return -2;
+    }
+    type = GQUIC_FRAME_META(spec).type;
+    if (gquic_varint_serialize(&type, writer) != 0) {
+        return -3;
+    }
+    const u_int64_t *vars[] = { &spec->seq, &spec->ack_eliciting_threshold, &spec->max_ack_delay, &spec->reordering_threshold };
+    for (i = 0; i < 4; i++) {
+        if (gquic_varint_serialize(vars[i], writer) != 0) {
+            return -4;
+        }
+    }
+    return 0;
+}
+
+static int gquic_frame_ack_frequency_deserialize(void *const frame, gquic_reader_str_t *const reader) {
+    gquic_frame_ack_frequency_t *spec = frame;
+    u_int64_t type = 0;
+    int i = 0;
+    if (spec == NULL || reader == NULL) {
+        return -1;
+    }
+    if (gquic_varint_deserialize(&type, reader) != 0 || type != GQUIC_FRAME_META(spec).type) {
+        return -2;
+    }
+    u_int64_t *vars[] = { &spec->seq, &spec->ack_eliciting_threshold, &spec->max_ack_delay, &spec->reordering_threshold };
+    for (i = 0; i < 4; i++) {
+        if (gquic_varint_deserialize(vars[i], reader) != 0) {
+            return -3;
+        }
+    }
+    return 0;
+}
+
+static int gquic_frame_ack_frequency_init(void *const frame) {
+    gquic_frame_ack_frequency_t *spec = frame;
+    if (spec == NULL) {
+        return -1;
+    }
+    spec->seq = 0;
+    spec->ack_eliciting_threshold = 0;
+    spec->max_ack_delay = 0;
+    spec->reordering_threshold = 0;
+    return 0;
+}
+
+static int gquic_frame_ack_frequency_dtor(void *const frame) {
+    if (frame == NULL) {
+        return -1;
+    }
+    return 0;
+}
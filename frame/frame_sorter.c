@@ -1,264 +1,201 @@
 #include "frame/frame_sorter.h"
 #include <stddef.h>
+#include <string.h>
+#include <malloc.h>
 
-static int gquic_frame_sorter_entry_release(void *const);
-static int gquic_frame_sorter_push_inner(gquic_frame_sorter_t *const,
-                                         const gquic_str_t *const,
-                                         u_int64_t,
-                                         int (*) (void *const),
-                                         void *);
+static int gquic_frame_sorter_reserve(gquic_frame_sorter_t *const, const u_int64_t);
+static int gquic_frame_sorter_add_interval(gquic_frame_sorter_t *const, const u_int64_t, const u_int64_t);
+static void gquic_frame_sorter_ring_write(u_int8_t *const, const u_int64_t, const u_int64_t, const u_int8_t *, u_int64_t);
+static void gquic_frame_sorter_ring_read(u_int8_t *, const u_int8_t *const, const u_int64_t, const u_int64_t, u_int64_t);
 
-int gquic_frame_sorter_entry_init(gquic_frame_sorter_entry_t *const entry) {
-    if (entry == NULL) {
+int gquic_frame_sorter_init(gquic_frame_sorter_t *const sorter) {
+    if (sorter == NULL) {
         return -1;
     }
-    gquic_str_init(&entry->data);
-    entry->done_cb.cb = NULL;
-    entry->done_cb.self = NULL;
+    sorter->buf = NULL;
+    sorter->cap = 0;
+    sorter->max_size = 0;
+    sorter->read_pos = 0;
+    sorter->intervals_count = 0;
+    sorter->intervals_cap = 0;
+    sorter->intervals = NULL;
     return 0;
 }
 
-int gquic_frame_sorter_init(gquic_frame_sorter_t *const sorter) {
-    if (sorter == NULL) {
+int gquic_frame_sorter_ctor(gquic_frame_sorter_t *const sorter, const u_int64_t max_size) {
+    if (sorter == NULL || max_size == 0) {
         return -1;
     }
-    gquic_list_head_init(&sorter->gaps);
-    gquic_rbtree_root_init(&sorter->root);
-    sorter->read_pos = 0;
-    sorter->gaps_count = 0;
+    sorter->max_size = max_size;
     return 0;
 }
 
-int gquic_frame_sorter_ctor(gquic_frame_sorter_t *const sorter) {
-    gquic_byte_interval_t *interval = NULL;
+int gquic_frame_sorter_dtor(gquic_frame_sorter_t *const sorter) {
     if (sorter == NULL) {
         return -1;
     }
-    if ((interval = gquic_list_alloc(sizeof(gquic_byte_interval_t))) == NULL) {
-        return -2;
+    if (sorter->buf != NULL) {
+        free(sorter->buf);
     }
-    interval->start = 0;
-    interval->end = (1UL << 62) - 1;
-    sorter->gaps_count++;
-    gquic_list_insert_after(&sorter->gaps, interval);
+    if (sorter->intervals != NULL) {
+        free(sorter->intervals);
+    }
+    sorter->buf = NULL;
+    sorter->cap = 0;
+    sorter->intervals = NULL;
+    sorter->intervals_count = 0;
+    sorter->intervals_cap = 0;
     return 0;
 }
 
-int gquic_frame_sorter_dtor(gquic_frame_sorter_t *const sorter) {
-    gquic_rbtree_t *node = NULL;
+int gquic_frame_sorter_push(gquic_frame_sorter_t *const sorter, const gquic_str_t *const data, const u_int64_t off) {
+    u_int64_t start = off;
+    u_int64_t end = off + GQUIC_STR_SIZE(data);
+    const u_int8_t *src = GQUIC_STR_VAL(data);
     if (sorter == NULL) {
         return -1;
     }
-    while (!gquic_list_head_empty(&sorter->gaps)) {
-        sorter->gaps_count--;
-        gquic_list_release(GQUIC_LIST_FIRST(&sorter->gaps));
+    if (start == end || end <= sorter->read_pos) {
+        return 0;
+    }
+    if (start < sorter->read_pos) {
+        src += sorter->read_pos - start;
+        start = sorter->read_pos;
     }
-    while (!gquic_rbtree_is_nil(sorter->root)) {
-        node = sorter->root;
-        gquic_rbtree_remove(&sorter->root, &node);
-        gquic_rbtree_release(node, gquic_frame_sorter_entry_release);
+    if (end - sorter->read_pos > sorter->max_size) {
+        return -2;
+    }
+    if (gquic_frame_sorter_reserve(sorter, end - sorter->read_pos) != 0) {
+        return -3;
+    }
+    gquic_frame_sorter_ring_write(sorter->buf, sorter->cap, start, src, end - start);
+    if (gquic_frame_sorter_add_interval(sorter, start, end) != 0) {
+        return -4;
     }
     return 0;
 }
 
-static int gquic_frame_sorter_entry_release(void *const entry) {
-    gquic_frame_sorter_entry_t *spec = entry;
-    if (entry == NULL) {
+int gquic_frame_sorter_read(gquic_writer_str_t *const writer, gquic_frame_sorter_t *const sorter) {
+    u_int64_t size = 0;
+    if (writer == NULL || sorter == NULL) {
         return -1;
     }
-    gquic_str_reset(&spec->data);
+    size = gquic_frame_sorter_readable(sorter);
+    if (size > GQUIC_STR_SIZE(writer)) {
+        size = GQUIC_STR_SIZE(writer);
+    }
+    if (size == 0) {
+        return 0;
+    }
+    gquic_frame_sorter_ring_read(GQUIC_STR_VAL(writer), sorter->buf, sorter->cap, sorter->read_pos, size);
+    gquic_writer_str_writed_size(writer, size);
+    sorter->read_pos += size;
+    sorter->intervals[0].start = sorter->read_pos;
+    if (sorter->intervals[0].start == sorter->intervals[0].end) {
+        sorter->intervals_count--;
+        memmove(sorter->intervals, sorter->intervals + 1, sorter->intervals_count * sizeof(gquic_byte_interval_t));
+    }
     return 0;
 }
 
-static int gquic_frame_sorter_push_inner(gquic_frame_sorter_t *const sorter,
-                                         const gquic_str_t *const data,
-                                         u_int64_t off,
-                                         int (*done_cb) (void *const),
-                                         void *done_cb_self) {
-    const gquic_rbtree_t *old_entry = NULL;
-    gquic_frame_sorter_entry_t *old_entry_spec = NULL;
-    gquic_byte_interval_t *gap = NULL;
-    gquic_byte_interval_t *end_gap = NULL;
-    gquic_byte_interval_t *next_end_gap = NULL;
-    gquic_byte_interval_t *intv = NULL;
-    const gquic_rbtree_t *cb_rbt = NULL;
-    gquic_frame_sorter_entry_t *entry = NULL;
-    u_int64_t start = 0;
-    u_int64_t end = 0;
-    u_int64_t cut_len = 0;
-    u_int64_t len = 0;
-    int cut_flag = 0;
-    gquic_str_t tmp_data = { GQUIC_STR_SIZE(data), GQUIC_STR_VAL(data) };
-    if (sorter == NULL) {
+int gquic_frame_sorter_copy(gquic_str_t *const data, const gquic_frame_sorter_t *const sorter) {
+    if (data == NULL || sorter == NULL) {
         return -1;
     }
-    if (GQUIC_STR_SIZE(&tmp_data) == 0) {
+    if (gquic_frame_sorter_readable(sorter) < GQUIC_STR_SIZE(data)) {
         return -2;
     }
-    if (gquic_rbtree_find(&old_entry, sorter->root, &off, sizeof(u_int64_t)) == 0) {
-        old_entry_spec = GQUIC_RBTREE_VALUE(old_entry);
-        if (GQUIC_STR_SIZE(&tmp_data) <= GQUIC_STR_SIZE(&old_entry_spec->data)) {
-            return -3;
-        }
-        if (old_entry_spec->done_cb.self != NULL) {
-            GQUIC_FRAME_SORTER_ENTRY_DONE(old_entry_spec);
-        }
-        gquic_str_reset(&old_entry_spec->data);
-        gquic_str_copy(&old_entry_spec->data, &tmp_data);
-        old_entry_spec->done_cb.cb = done_cb;
-        old_entry_spec->done_cb.self = done_cb_self;
+    gquic_frame_sorter_ring_read(GQUIC_STR_VAL(data), sorter->buf, sorter->cap, sorter->read_pos, GQUIC_STR_SIZE(data));
+    return 0;
+}
+
+static int gquic_frame_sorter_reserve(gquic_frame_sorter_t *const sorter, const u_int64_t size) {
+    u_int8_t *buf = NULL;
+    u_int64_t cap = 0;
+    u_int64_t head = 0;
+    if (sorter == NULL) {
+        return -1;
     }
-    start = off;
-    end = off + GQUIC_STR_SIZE(&tmp_data);
-    GQUIC_LIST_FOREACH(gap, &sorter->gaps) {
-        if (end < gap->start) {
-            return -4;
-        }
-        if (start <= gap->end && gap->start < end) {
-            break;
-        }
+    if (size <= sorter->cap) {
+        return 0;
     }
-    if (gap == NULL || gap == GQUIC_LIST_PAYLOAD(&sorter->gaps)) {
-        return -5;
+    for (cap = sorter->cap == 0 ? 4096 : sorter->cap; cap < size; cap <<= 1);
+    if ((buf = malloc(cap)) == NULL) {
+        return -2;
     }
-    if (start < gap->start) {
-        cut_flag = 1;
-        u_int64_t added = gap->start - start;
-        off += added;
-        start += added;
-        tmp_data.size -= added;
-        tmp_data.val += added;
+    if (sorter->buf != NULL) {
+        head = sorter->read_pos & (sorter->cap - 1);
+        gquic_frame_sorter_ring_write(buf, cap, sorter->read_pos, sorter->buf + head, sorter->cap - head);
+        gquic_frame_sorter_ring_write(buf, cap, sorter->read_pos + sorter->cap - head, sorter->buf, head);
+        free(sorter->buf);
     }
-    end_gap = gap;
-    while (end >= end_gap->end) {
-        next_end_gap = gquic_list_next(end_gap);
-        if (next_end_gap == GQUIC_LIST_PAYLOAD(&sorter->gaps)) {
-            return -6;
-        }
-        u_int64_t tmp_end = end_gap->end;
-        if (end_gap != gap) {
-            sorter->gaps_count--;
-            gquic_list_release(end_gap);
-        }
-        if (end < next_end_gap->start) {
-            break;
-        }
-        if (tmp_end != off) {
-            if (gquic_rbtree_find(&cb_rbt, sorter->root, &tmp_end, sizeof(tmp_end)) == 0) {
-                GQUIC_FRAME_SORTER_ENTRY_DONE((gquic_frame_sorter_entry_t *) GQUIC_RBTREE_VALUE(cb_rbt));
-                gquic_rbtree_remove(&sorter->root, (gquic_rbtree_t **) &cb_rbt);
-                gquic_rbtree_release((gquic_rbtree_t *) cb_rbt, gquic_frame_sorter_entry_release);
-            }
-        }
-        end_gap = next_end_gap;
-    }
-    if (end > end_gap->end) {
-        cut_len = end - end_gap->end;
-        len = GQUIC_STR_SIZE(&tmp_data) - cut_len;
-        end -= cut_len;
-        tmp_data.size = len;
-        cut_flag = 1;
+    sorter->buf = buf;
+    sorter->cap = cap;
+    return 0;
+}
+
+static int gquic_frame_sorter_add_interval(gquic_frame_sorter_t *const sorter, const u_int64_t start, const u_int64_t end) {
+    int i = 0;
+    int j = 0;
+    u_int64_t merged_start = start;
+    u_int64_t merged_end = end;
+    gquic_byte_interval_t *intervals = NULL;
+    if (sorter == NULL) {
+        return -1;
     }
-    if (start == gap->start) {
-        if (end >= gap->end) {
-            sorter->gaps_count--;
-            gquic_list_remove(gap);
+    for (i = 0; i < sorter->intervals_count && sorter->intervals[i].end < start; i++);
+    for (j = i; j < sorter->intervals_count && sorter->intervals[j].start <= end; j++) {
+        if (sorter->intervals[j].start < merged_start) {
+            merged_start = sorter->intervals[j].start;
         }
-        if (end < end_gap->end) {
-            end_gap->start = end;
+        if (sorter->intervals[j].end > merged_end) {
+            merged_end = sorter->intervals[j].end;
         }
     }
-    else if (end == end_gap->end) {
-        gap->end = start;
-    }
-    else {
-        if (gap == end_gap) {
-            if ((intv = gquic_list_alloc(sizeof(gquic_byte_interval_t))) == NULL) {
-                return -7;
+    if (i == j) {
+        if (sorter->intervals_count == sorter->intervals_cap) {
+            if (sorter->intervals_cap >= GQUIC_FRAME_SORTER_MAX_INTERVALS) {
+                return -2;
             }
-            intv->start = end;
-            intv->end = gap->end;
-            gquic_list_insert_after(&GQUIC_LIST_META(gap), intv);
-            gap->end = start;
-        }
-        else {
-            gap->end = start;
-            end_gap->start = end;
-        }
-    }
-
-    if (sorter->gaps_count > 1000) {
-        return -6;
-    }
-
-    if (cut_flag && GQUIC_STR_SIZE(&tmp_data) < 128) {
-        if (done_cb_self != NULL) {
-            done_cb(done_cb_self);
-            done_cb_self = NULL;
+            if ((intervals = realloc(sorter->intervals,
+                                     (sorter->intervals_cap == 0 ? 8 : 2 * sorter->intervals_cap) * sizeof(gquic_byte_interval_t))) == NULL) {
+                return -3;
+            }
+            sorter->intervals = intervals;
+            sorter->intervals_cap = sorter->intervals_cap == 0 ? 8 : 2 * sorter->intervals_cap;
         }
+        memmove(sorter->intervals + i + 1, sorter->intervals + i, (sorter->intervals_count - i) * sizeof(gquic_byte_interval_t));
+        sorter->intervals_count++;
     }
-    if (gquic_rbtree_find(&cb_rbt, sorter->root, &off, sizeof(u_int64_t)) == 0) {
-        entry = GQUIC_RBTREE_VALUE(cb_rbt);
-        gquic_str_reset(&entry->data);
-        gquic_str_copy(&entry->data, &tmp_data);
-        entry->done_cb.cb = done_cb;
-        entry->done_cb.self = NULL;
-    }
-    else {
-        if (gquic_rbtree_alloc((gquic_rbtree_t **) &cb_rbt, sizeof(u_int64_t), sizeof(gquic_frame_sorter_entry_t)) != 0) {
-            return -7;
-        }
-        *((u_int64_t *) GQUIC_RBTREE_KEY(cb_rbt)) = off;
-        ((gquic_frame_sorter_entry_t *) GQUIC_RBTREE_VALUE(cb_rbt))->done_cb.cb = done_cb;
-        ((gquic_frame_sorter_entry_t *) GQUIC_RBTREE_VALUE(cb_rbt))->done_cb.self = done_cb_self;
-        gquic_str_copy(&((gquic_frame_sorter_entry_t *) GQUIC_RBTREE_VALUE(cb_rbt))->data, &tmp_data);
-        gquic_rbtree_insert(&sorter->root, (gquic_rbtree_t *) cb_rbt);
+    else if (j - i > 1) {
+        memmove(sorter->intervals + i + 1, sorter->intervals + j, (sorter->intervals_count - j) * sizeof(gquic_byte_interval_t));
+        sorter->intervals_count -= j - i - 1;
     }
-
+    sorter->intervals[i].start = merged_start;
+    sorter->intervals[i].end = merged_end;
     return 0;
 }
 
-int gquic_frame_sorter_push(gquic_frame_sorter_t *const sorter,
-                            const gquic_str_t *const data,
-                            const u_int64_t off,
-                            int (*done_cb) (void *const),
-                            void *const done_cb_self) {
-    int ret;
-    if (sorter == NULL) {
-        return -1;
+static void gquic_frame_sorter_ring_write(u_int8_t *const buf, const u_int64_t cap, const u_int64_t off, const u_int8_t *src, u_int64_t len) {
+    u_int64_t pos = off & (cap - 1);
+    u_int64_t size = 0;
+    while (len > 0) {
+        size = cap - pos < len ? cap - pos : len;
+        memcpy(buf + pos, src, size);
+        src += size;
+        len -= size;
+        pos = 0;
     }
-    ret = gquic_frame_sorter_push_inner(sorter, data, off, done_cb, done_cb_self);
-    if (ret == -2 || ret == -3 || ret == -4) {
-        if (done_cb_self != NULL) {
-            done_cb(done_cb_self);
-        }
-        return 0;
-    }
-    return ret;
 }
 
-int gquic_frame_sorter_pop(u_int64_t *const off,
-                           gquic_str_t *const data,
-                           int (**done_cb) (void *const),
-                           void **done_cb_self,
-                           gquic_frame_sorter_t *const sorter) {
-    const gquic_rbtree_t *cb_rbt = NULL;
-    if (off == NULL || data == NULL || done_cb == NULL || done_cb_self == NULL || sorter == NULL) {
-        return -1;
+static void gquic_frame_sorter_ring_read(u_int8_t *dst, const u_int8_t *const buf, const u_int64_t cap, const u_int64_t off, u_int64_t len) {
+    u_int64_t pos = off & (cap - 1);
+    u_int64_t size = 0;
+    while (len > 0) {
+        size = cap - pos < len ? cap - pos : len;
+        memcpy(dst, buf + pos, size);
+        dst += size;
+        len -= size;
+        pos = 0;
     }
-    if (gquic_rbtree_find(&cb_rbt, sorter->root, &sorter->read_pos, sizeof(u_int64_t)) != 0) {
-        *off = sorter->read_pos;
-        *done_cb = NULL;
-        *done_cb_self = NULL;
-        return 0;
-    }
-    gquic_rbtree_remove(&sorter->root, (gquic_rbtree_t **) &cb_rbt);
-    *off = sorter->read_pos;
-    sorter->read_pos += GQUIC_STR_SIZE(&((gquic_frame_sorter_entry_t *) GQUIC_RBTREE_VALUE(cb_rbt))->data);
-    *data = ((gquic_frame_sorter_entry_t *) GQUIC_RBTREE_VALUE(cb_rbt))->data;
-    *done_cb = ((gquic_frame_sorter_entry_t *) GQUIC_RBTREE_VALUE(cb_rbt))->done_cb.cb;
-    *done_cb_self = ((gquic_frame_sorter_entry_t *) GQUIC_RBTREE_VALUE(cb_rbt))->done_cb.self;
-    gquic_rbtree_release((gquic_rbtree_t *) cb_rbt, NULL);
-
-    return 0;
 }
@@ -0,0 +1,61 @@
+#include "frame/immediate_ack.h"
+#include "frame/meta.h"
+#include <stddef.h>
+
+static size_t gquic_frame_immediate_ack_size(const void *const);
+static int gquic_frame_immediate_ack_serialize(const void *const, gquic_writer_str_t *const);
+static int gquic_frame_immediate_ack_deserialize(void *const, gquic_reader_str_t *const);
+static int gquic_frame_immediate_ack_init(void *const);
+static int gquic_frame_immediate_ack_dtor(void *const);
+
+gquic_frame_immediate_ack_t *gquic_frame_immediate_ack_alloc() {
+    gquic_frame_immediate_ack_t *frame = gquic_frame_alloc(0);
+    if (frame == NULL) {
+        return NULL;
+    }
+    GQUIC_FRAME_META(frame).type = 0x1f;
+    GQUIC_FRAME_META(frame).deserialize_func = gquic_frame_immediate_ack_deserialize;
+    GQUIC_FRAME_META(frame).init_func = gquic_frame_immediate_ack_init;
+    GQUIC_FRAME_META(frame).dtor_func = gquic_frame_immediate_ack_dtor;
+    GQUIC_FRAME_META(frame).serialize_func = gquic_frame_immediate_ack_serialize;
+    GQUIC_FRAME_META(frame).size_func = gquic_frame_immediate_ack_size;
+    return frame;
+}
+
+static size_t gquic_frame_immediate_ack_size(const void *const frame) {
+    (void) frame;
+    return 1;
+}
+
+static int gquic_frame_immediate_ack_serialize(const void *const frame, gquic_writer_str_t *const writer) {
+    if (frame == NULL || writer == NULL) {
+        return -1;
+    }
+    if (GQUIC_FRAME_SIZE(frame) > GQUIC_STR_SIZE(writer)) {
+        return -2;
+    }
+    if (gquic_writer_str_write_byte(writer, GQUIC_FRAME_META(frame).type) != 0) {
+        return -3;
+    }
+    return 0;
+}
+
+static int gquic_frame_immediate_ack_deserialize(void *const frame, gquic_reader_str_t *const reader) {
+    if (frame == NULL || reader == NULL) {
+        return -1;
+    }
+    if (gquic_reader_str_read_byte(reader) != GQUIC_FRAME_META(frame).type) {
+        return -2;
+    }
+    return 0;
+}
+
+static int gquic_frame_immediate_ack_init(void *const frame) {
+    (void) frame;
+    return 0;
+}
+
+static int gquic_frame_immediate_ack_dtor(void *const frame) {
+    (void) frame;
+    return 0;
+}
@@ -19,6 +19,8 @@
 #include "frame/path_challenge.h"
 #include "frame/path_response.h"
 #include "frame/connection_close.h"
+#include "frame/ack_frequency.h"
+#include "frame/immediate_ack.h"
 #include "tls/common.h"
 #include <stddef.h>
 
@@ -75,6 +77,17 @@ static int gquic_frame_parser_parse(void **const frame_storage,
             return -2;
         }
         break;
+    case GQUIC_ENC_LV_0RTT:
+        switch (GQUIC_STR_FIRST_BYTE(reader)) {
+        case 0x02:
+        case 0x03: // ack
+        case 0x06: // crypto
+        case 0x07: // new token
+        case 0x1b: // path response
+        case 0x1e: // handshake done
+            return -2;
+        }
+        break;
     case GQUIC_ENC_LV_1RTT:
         break;
     default:
@@ -142,6 +155,16 @@ static int gquic_frame_parser_parse(void **const frame_storage,
     case 0x1d:
         *frame_storage = gquic_frame_connection_close_alloc();
         break;
+    case 0x1f:
+        *frame_storage = gquic_frame_immediate_ack_alloc();
+        break;
+    case 0x40:
+        // two byte frame types, only ACK_FREQUENCY (0xaf) is known
+        if (GQUIC_STR_SIZE(reader) < 2 || ((u_int8_t *) GQUIC_STR_VAL(reader))[1] != 0xaf) {
+            return -5;
+        }
+        *frame_storage = gquic_frame_ack_frequency_alloc();
+        break;
     default:
         return -5;
     }
@@ -21,7 +21,9 @@ int gquic_long_header_sealer_ctor(gquic_long_header_sealer_t *const sealer,
     if (sealer == NULL || aead_suite == NULL || key == NULL || iv == NULL || protector_suite == NULL || traffic_sec == NULL) {
         return -1;
     }
-    gquic_header_protector_ctor(&sealer->protector, protector_suite, traffic_sec, 1);
+    if (gquic_header_protector_ctor(&sealer->protector, protector_suite, traffic_sec, 1) != 0) {
+        return -4;
+    }
     if (aead_suite->aead(&sealer->aead, key, iv) != 0) {
         return -2;
     }
@@ -39,7 +41,9 @@ int gquic_long_header_sealer_traffic_ctor(gquic_long_header_sealer_t *const seal
     if (sealer == NULL || suite == NULL || traffic_sec == NULL) {
         return -1;
     }
-    gquic_header_protector_ctor(&sealer->protector, suite, traffic_sec, 1);
+    if (gquic_header_protector_ctor(&sealer->protector, suite, traffic_sec, 1) != 0) {
+        return -4;
+    }
     if (gquic_tls_create_aead(&sealer->aead, suite, traffic_sec) != 0) {
         return -2;
     }
@@ -51,6 +55,28 @@ int gquic_long_header_sealer_traffic_ctor(gquic_long_header_sealer_t *const seal
     return 0;
 }
 
+int gquic_long_header_sealer_key_ctor(gquic_long_header_sealer_t *const sealer,
+                                      const gquic_tls_cipher_suite_t *const suite,
+                                      const gquic_str_t *key,
+                                      const gquic_str_t *iv,
+                                      const gquic_str_t *const header_protector_key) {
+    if (sealer == NULL || suite == NULL || key == NULL || iv == NULL || header_protector_key == NULL) {
+        return -1;
+    }
+    if (gquic_header_protector_key_ctor(&sealer->protector, suite, header_protector_key, 1) != 0) {
+        return -4;
+    }
+    if (suite->aead(&sealer->aead, key, iv) != 0) {
+        return -2;
+    }
+    if (gquic_str_alloc(&sealer->nonce_buf, 12) != 0) {
+        return -3;
+    }
+    gquic_str_clear(&sealer->nonce_buf);
+
+    return 0;
+}
+
 int gquic_long_header_sealer_dtor(gquic_long_header_sealer_t *const sealer) {
     if (sealer == NULL) {
         return -1;
@@ -63,18 +89,17 @@ int gquic_long_header_sealer_dtor(gquic_long_header_sealer_t *const sealer) {
 }
 
 int gquic_long_header_sealer_seal(gquic_str_t *const tag,
-                                  gquic_str_t *const cipher_text,
+                                  gquic_str_t *const text,
                                   gquic_long_header_sealer_t *const sealer,
                                   const u_int64_t pn,
-                                  const gquic_str_t *const plain_text,
                                   const gquic_str_t *const addata) {
-    if (cipher_text == NULL || tag == NULL || sealer == NULL || plain_text == NULL || addata == NULL) {
+    if (text == NULL || tag == NULL || sealer == NULL || addata == NULL) {
         return -1;
     }
     if (gquic_big_endian_transfer(GQUIC_STR_VAL(&sealer->nonce_buf) + GQUIC_STR_SIZE(&sealer->nonce_buf) - 8, &pn, 8) != 0) {
         return -2;
     }
-    if (GQUIC_TLS_AEAD_SEAL(tag, cipher_text, &sealer->aead, &sealer->nonce_buf, plain_text, addata) != 0) {
+    if (GQUIC_TLS_AEAD_SEAL(tag, text, &sealer->aead, &sealer->nonce_buf, addata) != 0) {
         return -3;
     }
     return 0;
@@ -100,7 +125,9 @@ int gquic_long_header_opener_ctor(gquic_long_header_opener_t *const opener,
     if (opener == NULL || aead_suite == NULL || key == NULL || iv == NULL || protector_suite == NULL || traffic_sec == NULL) {
         return -1;
     }
-    gquic_header_protector_ctor(&opener->protector, protector_suite, traffic_sec, 1);
+    if (gquic_header_protector_ctor(&opener->protector, protector_suite, traffic_sec, 1) != 0) {
+        return -4;
+    }
     if (aead_suite->aead(&opener->aead, key, iv) != 0) {
         return -2;
     }
@@ -117,7 +144,9 @@ int gquic_long_header_opener_traffic_ctor(gquic_long_header_opener_t *const open
     if (opener == NULL || suite == NULL || traffic_sec == NULL) {
         return -1;
     }
-    gquic_header_protector_ctor(&opener->protector, suite, traffic_sec, 1);
+    if (gquic_header_protector_ctor(&opener->protector, suite, traffic_sec, 1) != 0) {
+        return -4;
+    }
     if (gquic_tls_create_aead(&opener->aead, suite, traffic_sec) != 0) {
         return -2;
     }
@@ -128,6 +157,28 @@ int gquic_long_header_opener_traffic_ctor(gquic_long_header_opener_t *const open
     return 0;
 }
 
+int gquic_long_header_opener_key_ctor(gquic_long_header_opener_t *const opener,
+                                      const gquic_tls_cipher_suite_t *const suite,
+                                      const gquic_str_t *key,
+                                      const gquic_str_t *iv,
+                                      const gquic_str_t *const header_protector_key) {
+    if (opener == NULL || suite == NULL || key == NULL || iv == NULL || header_protector_key == NULL) {
+        return -1;
+    }
+    if (gquic_header_protector_key_ctor(&opener->protector, suite, header_protector_key, 1) != 0) {
+        return -4;
+    }
+    if (suite->aead(&opener->aead, key, iv) != 0) {
+        return -2;
+    }
+    if (gquic_str_alloc(&opener->nonce_buf, 12) != 0) {
+        return -3;
+    }
+    gquic_str_clear(&opener->nonce_buf);
+
+    return 0;
+}
+
 int gquic_long_header_opener_dtor(gquic_long_header_opener_t *const opener) {
     if (opener == NULL) {
         return -1;
@@ -139,19 +190,18 @@ int gquic_long_header_opener_dtor(gquic_long_header_opener_t *const opener) {
     return 0;
 }
 
-int gquic_long_header_opener_open(gquic_str_t *const plain_text,
+int gquic_long_header_opener_open(gquic_str_t *const text,
                                   gquic_long_header_opener_t *const opener,
                                   const u_int64_t pn,
                                   const gquic_str_t *const tag,
-                                  const gquic_str_t *const cipher_text,
                                   const gquic_str_t *const addata) {
-    if (plain_text == NULL || opener == NULL || tag == NULL || cipher_text == NULL || addata == NULL) {
+    if (text == NULL || opener == NULL || tag == NULL || addata == NULL) {
         return -1;
     }
     if (gquic_big_endian_transfer(GQUIC_STR_VAL(&opener->nonce_buf) + GQUIC_STR_SIZE(&opener->nonce_buf) - 8, &pn, 8) != 0) {
         return -2;
     }
-    if (GQUIC_TLS_AEAD_OPEN(plain_text, &opener->aead, &opener->nonce_buf, tag, cipher_text, addata) != 0) {
+    if (GQUIC_TLS_AEAD_OPEN(text, &opener->aead, &opener->nonce_buf, tag, addata) != 0) {
         return -3;
     }
     return 0;
@@ -186,7 +236,9 @@ int gquic_handshake_sealer_ctor(gquic_handshake_sealer_t *const sealer,
         || drop_keys_self == NULL) {
         return -1;
     }
-    gquic_long_header_sealer_ctor(&sealer->sealer, aead_suite, key, iv, protector_suite, traffic_sec);
+    if (gquic_long_header_sealer_ctor(&sealer->sealer, aead_suite, key, iv, protector_suite, traffic_sec) != 0) {
+        return -2;
+    }
     sealer->drop_keys.cb = drop_keys_cb;
     sealer->drop_keys.self = drop_keys_self;
 
@@ -200,7 +252,9 @@ int gquic_handshake_sealer_traffic_ctor(gquic_handshake_sealer_t *const sealer,
     if (sealer == NULL || suite == NULL || traffic_sec == NULL || drop_keys_self == NULL || drop_keys_cb == NULL) {
         return -1;
     }
-    gquic_long_header_sealer_traffic_ctor(&sealer->sealer, suite, traffic_sec);
+    if (gquic_long_header_sealer_traffic_ctor(&sealer->sealer, suite, traffic_sec) != 0) {
+        return -2;
+    }
     sealer->drop_keys.cb = drop_keys_cb;
     sealer->drop_keys.self = drop_keys_self;
     return 0;
@@ -217,15 +271,14 @@ int gquic_handshake_sealer_dtor(gquic_handshake_sealer_t *const sealer) {
 }
 
 int gquic_handshake_sealer_seal(gquic_str_t *const tag,
-                                gquic_str_t *const cipher_text,
+                                gquic_str_t *const text,
                                 gquic_handshake_sealer_t *const sealer,
                                 const u_int64_t pn,
-                                const gquic_str_t *const plain_text,
                                 const gquic_str_t *const addata) {
-    if (tag == NULL || cipher_text == NULL || sealer == NULL || plain_text == NULL || addata == NULL) {
+    if (tag == NULL || text == NULL || sealer == NULL || addata == NULL) {
         return -1;
     }
-    if (gquic_long_header_sealer_seal(tag, cipher_text, &sealer->sealer, pn, plain_text, addata) != 0) {
+    if (gquic_long_header_sealer_seal(tag, text, &sealer->sealer, pn, addata) != 0) {
         return -2;
     }
     if (!sealer->dropped) {
@@ -264,7 +317,9 @@ int gquic_handshake_opener_ctor(gquic_handshake_opener_t *const opener,
         || drop_keys_cb == NULL) {
         return -1;
     }
-    gquic_long_header_opener_ctor(&opener->opener, aead_suite, key, iv, protector_suite, traffic_sec);
+    if (gquic_long_header_opener_ctor(&opener->opener, aead_suite, key, iv, protector_suite, traffic_sec) != 0) {
+        return -2;
+    }
     opener->drop_keys.cb = drop_keys_cb;
     opener->drop_keys.self = drop_keys_self;
 
@@ -280,7 +335,9 @@ int gquic_handshake_opener_traffic_ctor(gquic_handshake_opener_t *const opener,
     if (opener == NULL || suite == NULL || traffic_sec == NULL || drop_keys_self == NULL || drop_keys_cb == NULL) {
         return -1;
     }
-    gquic_long_header_opener_traffic_ctor(&opener->opener, suite, traffic_sec);
+    if (gquic_long_header_opener_traffic_ctor(&opener->opener, suite, traffic_sec) != 0) {
+        return -2;
+    }
     opener->drop_keys.cb = drop_keys_cb;
     opener->drop_keys.self = drop_keys_self;
     return 0;
@@ -297,16 +354,15 @@ int gquic_handshake_opener_dtor(gquic_handshake_opener_t *const opener) {
     return 0;
 }
 
-int gquic_handshake_opener_open(gquic_str_t *const plain_text,
+int gquic_handshake_opener_open(gquic_str_t *const text,
                                 gquic_handshake_opener_t *const opener,
                                 const u_int64_t pn,
                                 const gquic_str_t *const tag,
-                                const gquic_str_t *const cipher_text,
                                 const gquic_str_t *const addata) {
-    if (tag == NULL || cipher_text == NULL || opener == NULL || plain_text == NULL || addata == NULL) {
+    if (tag == NULL || text == NULL || opener == NULL || addata == NULL) {
         return -1;
     }
-    if (gquic_long_header_opener_open(plain_text, &opener->opener, pn, tag, cipher_text, addata) != 0) {
+    if (gquic_long_header_opener_open(text, &opener->opener, pn, tag, addata) != 0) {
         return -2;
     }
     if (!opener->dropped) {
@@ -357,6 +413,22 @@ int gquic_common_long_header_sealer_long_header_traffic_ctor(gquic_common_long_h
     return 0;
 }
 
+int gquic_common_long_header_sealer_long_header_key_ctor(gquic_common_long_header_sealer_t *const sealer,
+                                                         const gquic_tls_cipher_suite_t *const suite,
+                                                         const gquic_str_t *key,
+                                                         const gquic_str_t *iv,
+                                                         const gquic_str_t *const header_protector_key) {
+    if (sealer == NULL || suite == NULL || key == NULL || iv == NULL || header_protector_key == NULL) {
+        return -1;
+    }
+    if (gquic_long_header_sealer_key_ctor(&sealer->sealer.long_header_sealer, suite, key, iv, header_protector_key) != 0) {
+        return -2;
+    }
+    sealer->available = 1;
+    sealer->use_handshake = 0;
+    return 0;
+}
+
 int gquic_common_long_header_sealer_handshake_ctor(gquic_common_long_header_sealer_t *const sealer,
                                                    const gquic_tls_cipher_suite_t *const aead_suite,
                                                    const gquic_str_t *key,
@@ -426,22 +498,21 @@ int gquic_common_long_header_sealer_dtor(gquic_common_long_header_sealer_t *cons
 }
 
 int gquic_common_long_header_sealer_seal(gquic_str_t *const tag,
-                                         gquic_str_t *const cipher_text,
+                                         gquic_str_t *const text,
                                          gquic_common_long_header_sealer_t *const sealer,
                                          const u_int64_t pn,
-                                         const gquic_str_t *const plain_text,
                                          const gquic_str_t *const addata) {
-    if (tag == NULL || cipher_text == NULL || sealer == NULL || plain_text == NULL || addata == NULL) {
+    if (tag == NULL || text == NULL || sealer == NULL || addata == NULL) {
         return -1;
     }
     if (!sealer->available) {
         return -2;
     }
     if (sealer->use_handshake) {
-        return gquic_handshake_sealer_seal(tag, cipher_text, &sealer->sealer.handshake_sealer, pn, plain_text, addata);
+        return gquic_handshake_sealer_seal(tag, text, &sealer->sealer.handshake_sealer, pn, addata);
     }
     else {
-        return gquic_long_header_sealer_seal(tag, cipher_text, &sealer->sealer.long_header_sealer, pn, plain_text, addata);
+        return gquic_long_header_sealer_seal(tag, text, &sealer->sealer.long_header_sealer, pn, addata);
     }
 }
 
@@ -504,6 +575,22 @@ int gquic_common_long_header_opener_long_header_traffic_ctor(gquic_common_long_h
     return 0;
 }
 
+int gquic_common_long_header_opener_long_header_key_ctor(gquic_common_long_header_opener_t *const opener,
+                                                         const gquic_tls_cipher_suite_t *const suite,
+                                                         const gquic_str_t *key,
+                                                         const gquic_str_t *iv,
+                                                         const gquic_str_t *const header_protector_key) {
+    if (opener == NULL || suite == NULL || key == NULL || iv == NULL || header_protector_key == NULL) {
+        return -1;
+    }
+    if (gquic_long_header_opener_key_ctor(&opener->opener.long_header_opener, suite, key, iv, header_protector_key) != 0) {
+        return -2;
+    }
+    opener->available = 1;
+    opener->use_handshake = 0;
+    return 0;
+}
+
 int gquic_common_long_header_opener_handshake_ctor(gquic_common_long_header_opener_t *const opener,
                                                    const gquic_tls_cipher_suite_t *const aead_suite,
                                                    const gquic_str_t *key,
@@ -571,23 +658,22 @@ int gquic_common_long_header_opener_dtor(gquic_common_long_header_opener_t *cons
     return 0;
 }
 
-int gquic_common_long_header_opener_open(gquic_str_t *const plain_text,
+int gquic_common_long_header_opener_open(gquic_str_t *const text,
                                          gquic_common_long_header_opener_t *const opener,
                                          const u_int64_t pn,
                                          const gquic_str_t *const tag,
-                                         const gquic_str_t *const cipher_text,
                                          const gquic_str_t *const addata) {
-    if (plain_text == NULL || opener == NULL || tag == NULL || cipher_text == NULL || addata == NULL) {
+    if (text == NULL || opener == NULL || tag == NULL || addata == NULL) {
         return -1;
     }
     if (!opener->available) {
         return -2;
     }
     if (opener->use_handshake) {
-        return gquic_handshake_opener_open(plain_text, &opener->opener.handshake_opener, pn, tag, cipher_text, addata);
+        return gquic_handshake_opener_open(text, &opener->opener.handshake_opener, pn, tag, addata);
     }
     else {
-        return gquic_long_header_opener_open(plain_text, &opener->opener.long_header_opener, pn, tag, cipher_text, addata);
+        return gquic_long_header_opener_open(text, &opener->opener.long_header_opener, pn, tag, addata);
     }
 }
 
@@ -1,10 +1,41 @@
 #include "handshake/auto_update_aead.h"
 #include "tls/key_schedule.h"
 #include "util/big_endian.h"
+#include "util/sem_list.h"
+#include <pthread.h>
+#include <string.h>
+#include <malloc.h>
+
+typedef struct gquic_auto_update_aead_refresh_job_s gquic_auto_update_aead_refresh_job_t;
+struct gquic_auto_update_aead_refresh_job_s {
+    gquic_auto_update_aead_refresh_t *refresh;
+    const gquic_tls_cipher_suite_t *suite;
+    gquic_auto_update_aead_keys_t *prev;
+};
+
+static gquic_sem_list_t gquic_auto_update_aead_refresh_jobs;
+static size_t gquic_auto_update_aead_refresh_threads = 0;
+static pthread_once_t gquic_auto_update_aead_refresh_once = PTHREAD_ONCE_INIT;
 
 static int gquic_auto_update_aead_next_traffic_sec(gquic_str_t *const,
                                                    const gquic_tls_cipher_suite_t *const,
                                                    const gquic_str_t *const);
+static int gquic_auto_update_aead_keys_init(gquic_auto_update_aead_keys_t *const);
+static int gquic_auto_update_aead_keys_dtor(gquic_auto_update_aead_keys_t *const);
+static gquic_auto_update_aead_keys_t *gquic_auto_update_aead_keys_alloc();
+static int gquic_auto_update_aead_keys_release(gquic_auto_update_aead_keys_t **const);
+static int gquic_auto_update_aead_keys_derive_half(gquic_str_t *const,
+                                                   gquic_tls_aead_t *const,
+                                                   const gquic_tls_cipher_suite_t *const,
+                                                   const gquic_str_t *const);
+static int gquic_auto_update_aead_keys_derive(gquic_auto_update_aead_keys_t *const,
+                                              const gquic_tls_cipher_suite_t *const,
+                                              const gquic_auto_update_aead_keys_t *const);
+static void gquic_auto_update_aead_refresh_pool_init();
+static void *gquic_auto_update_aead_refresh_worker(void *const);
+static int gquic_auto_update_aead_refresh_release(gquic_auto_update_aead_refresh_t *const);
+static int gquic_auto_update_aead_post_refresh(gquic_auto_update_aead_t *const);
+static gquic_auto_update_aead_keys_t *gquic_auto_update_aead_take_refreshed(gquic_auto_update_aead_t *const);
 
 int gquic_auto_update_aead_init(gquic_auto_update_aead_t *const aead) {
     if (aead == NULL) {
@@ -13,7 +44,8 @@ int gquic_auto_update_aead_init(gquic_auto_update_aead_t *const aead) {
     aead->suite = NULL;
     aead->times = 0;
     aead->last_ack_pn = -1;
-    aead->update_interval = 0;
+    aead->update_after_packets = GQUIC_AUTO_UPDATE_AEAD_DEFAULT_UPDATE_PACKETS;
+    aead->update_after_bytes = GQUIC_AUTO_UPDATE_AEAD_DEFAULT_UPDATE_BYTES;
 
     aead->prev_recv_aead_expire = 0;
     gquic_tls_aead_init(&aead->prev_recv_aead);
@@ -22,15 +54,14 @@ int gquic_auto_update_aead_init(gquic_auto_update_aead_t *const aead) {
     aead->cur_key_first_sent_pn = -1;
     aead->cur_key_num_recv = 0;
     aead->cur_key_num_sent = 0;
+    aead->cur_key_bytes_sent = 0;
 
     gquic_tls_aead_init(&aead->recv_aead);
     gquic_tls_aead_init(&aead->send_aead);
 
-    gquic_tls_aead_init(&aead->next_recv_aead);
-    gquic_tls_aead_init(&aead->next_send_aead);
-
-    gquic_str_init(&aead->next_recv_traffic_sec);
-    gquic_str_init(&aead->next_send_traffic_sec);
+    aead->next = NULL;
+    aead->next_seq = 0;
+    aead->refresh = NULL;
 
     gquic_header_protector_init(&aead->header_enc);
     gquic_header_protector_init(&aead->header_dec);
@@ -42,61 +73,111 @@ int gquic_auto_update_aead_init(gquic_auto_update_aead_t *const aead) {
     return 0;
 }
 
+int gquic_auto_update_aead_dtor(gquic_auto_update_aead_t *const aead) {
+    if (aead == NULL) {
+        return -1;
+    }
+    // a job still queued keeps the refresh slot alive, not the AEAD
+    if (aead->refresh != NULL) {
+        gquic_auto_update_aead_refresh_release(aead->refresh);
+        aead->refresh = NULL;
+    }
+    gquic_auto_update_aead_keys_release(&aead->next);
+    gquic_tls_aead_dtor(&aead->prev_recv_aead);
+    gquic_tls_aead_dtor(&aead->recv_aead);
+    gquic_tls_aead_dtor(&aead->send_aead);
+    gquic_header_protector_dtor(&aead->header_enc);
+    gquic_header_protector_dtor(&aead->header_dec);
+    gquic_str_reset(&aead->nonce_buf);
+    return 0;
+}
+
 int gquic_auto_update_aead_roll(gquic_auto_update_aead_t *const aead, const u_int64_t now) {
-    int ret = 0;
-    useconds_t pto = 0;
-    gquic_str_t next_recv_traffic_sec = { 0, NULL };
-    gquic_str_t next_send_traffic_sec = { 0, NULL };
+    gquic_auto_update_aead_keys_t *after_next = NULL;
+    u_int64_t pto = 0;
     if (aead == NULL) {
         return -1;
     }
+    if (aead->next == NULL) {
+        return -2;
+    }
+    if ((after_next = gquic_auto_update_aead_take_refreshed(aead)) == NULL) {
+        // no worker is done yet, derive generation N + 2 here
+        if ((after_next = gquic_auto_update_aead_keys_alloc()) == NULL) {
+            return -3;
+        }
+        if (gquic_auto_update_aead_keys_derive(after_next, aead->suite, aead->next) != 0) {
+            gquic_auto_update_aead_keys_release(&after_next);
+            return -4;
+        }
+    }
 
     aead->times++;
     aead->cur_key_first_recv_pn = -1;
     aead->cur_key_first_sent_pn = -1;
     aead->cur_key_num_recv = 0;
     aead->cur_key_num_sent = 0;
+    aead->cur_key_bytes_sent = 0;
 
+    // the previous receive keys are kept for 3 PTO, gquic_auto_update_aead_drop_prev_keys releases them
     gquic_tls_aead_dtor(&aead->prev_recv_aead);
-    gquic_tls_aead_init(&aead->prev_recv_aead);
-    gquic_tls_aead_copy(&aead->prev_recv_aead, &aead->recv_aead);
-    pto = 3 * gquic_time_pto(aead->rtt, 1);
-    aead->prev_recv_aead_expire = now + pto;
-    gquic_tls_aead_copy(&aead->recv_aead, &aead->next_recv_aead);
+    aead->prev_recv_aead = aead->recv_aead;
+    aead->prev_recv_aead_expire = -1;
+    // without an rtt there is no PTO, the keys are then kept until the next roll
+    if (aead->rtt != NULL) {
+        pto = gquic_time_pto(aead->rtt, 1);
+        if (pto <= (((u_int64_t) -1) - now) / 3) {
+            aead->prev_recv_aead_expire = now + 3 * pto;
+        }
+    }
+    aead->recv_aead = aead->next->recv_aead;
+    gquic_tls_aead_init(&aead->next->recv_aead);
     gquic_tls_aead_dtor(&aead->send_aead);
-    gquic_tls_aead_init(&aead->send_aead);
-    gquic_tls_aead_copy(&aead->send_aead, &aead->next_send_aead);
+    aead->send_aead = aead->next->send_aead;
+    gquic_tls_aead_init(&aead->next->send_aead);
 
-    if (gquic_auto_update_aead_next_traffic_sec(&next_recv_traffic_sec, aead->suite, &aead->next_recv_traffic_sec) != 0) {
-        ret = -2;
-        goto failure;
+    gquic_auto_update_aead_keys_release(&aead->next);
+    aead->next = after_next;
+    aead->next_seq++;
+
+    gquic_auto_update_aead_post_refresh(aead);
+    return 0;
+}
+
+int gquic_auto_update_aead_try_update(gquic_auto_update_aead_t *const aead, const u_int64_t now) {
+    if (aead == NULL) {
+        return -1;
+    }
+    if (aead->next == NULL) {
+        return 0;
     }
-    if (gquic_auto_update_aead_next_traffic_sec(&next_send_traffic_sec, aead->suite, &aead->next_send_traffic_sec) != 0) {
-        ret = -3;
-        goto failure;
+    if (!((aead->update_after_packets != 0 && aead->cur_key_num_sent >= aead->update_after_packets)
+          || (aead->update_after_bytes != 0 && aead->cur_key_bytes_sent >= aead->update_after_bytes))) {
+        return 0;
     }
-    gquic_str_reset(&aead->next_recv_traffic_sec);
-    gquic_str_reset(&aead->next_send_traffic_sec);
-    gquic_str_copy(&aead->next_recv_traffic_sec, &next_recv_traffic_sec);
-    gquic_str_copy(&aead->next_send_traffic_sec, &next_send_traffic_sec);
-    
-    if (gquic_tls_create_aead(&aead->next_recv_aead, aead->suite, &aead->next_recv_traffic_sec) != 0) {
-        ret = -4;
-        goto failure;
+    // an update may only be started once a packet sent with the current keys was acknowledged
+    if (aead->cur_key_first_sent_pn == ((u_int64_t) -1)
+        || aead->last_ack_pn == ((u_int64_t) -1)
+        || aead->last_ack_pn < aead->cur_key_first_sent_pn) {
+        return 0;
     }
-    if (gquic_tls_create_aead(&aead->next_send_aead, aead->suite, &aead->next_send_traffic_sec) != 0) {
-        ret = -5;
-        goto failure;
+    if (gquic_auto_update_aead_roll(aead, now) != 0) {
+        return -2;
     }
-
-    gquic_str_reset(&next_recv_traffic_sec);
-    gquic_str_reset(&next_send_traffic_sec);
     return 0;
-failure:
+}
 
-    gquic_str_reset(&next_recv_traffic_sec);
-    gquic_str_reset(&next_send_traffic_sec);
-    return ret;
+int gquic_auto_update_aead_drop_prev_keys(gquic_auto_update_aead_t *const aead, const u_int64_t now) {
+    if (aead == NULL) {
+        return -1;
+    }
+    if (aead->prev_recv_aead.self == NULL || now < aead->prev_recv_aead_expire) {
+        return 0;
+    }
+    gquic_tls_aead_dtor(&aead->prev_recv_aead);
+    gquic_tls_aead_init(&aead->prev_recv_aead);
+    aead->prev_recv_aead_expire = 0;
+    return 0;
 }
 
 static int gquic_auto_update_aead_next_traffic_sec(gquic_str_t *const ret,
@@ -112,6 +193,7 @@ static int gquic_auto_update_aead_next_traffic_sec(gquic_str_t *const ret,
         return -2;
     }
     if (gquic_tls_hkdf_expand_label(ret, &hash, traffic_sec, NULL, &label, EVP_MD_size(hash.md)) != 0) {
+        gquic_tls_mac_dtor(&hash);
         return -3;
     }
 
@@ -119,10 +201,193 @@ static int gquic_auto_update_aead_next_traffic_sec(gquic_str_t *const ret,
     return 0;
 }
 
+static int gquic_auto_update_aead_keys_init(gquic_auto_update_aead_keys_t *const keys) {
+    if (keys == NULL) {
+        return -1;
+    }
+    gquic_str_init(&keys->recv_traffic_sec);
+    gquic_str_init(&keys->send_traffic_sec);
+    gquic_tls_aead_init(&keys->recv_aead);
+    gquic_tls_aead_init(&keys->send_aead);
+    keys->seq = 0;
+    return 0;
+}
+
+static int gquic_auto_update_aead_keys_dtor(gquic_auto_update_aead_keys_t *const keys) {
+    if (keys == NULL) {
+        return -1;
+    }
+    gquic_str_reset(&keys->recv_traffic_sec);
+    gquic_str_reset(&keys->send_traffic_sec);
+    gquic_tls_aead_dtor(&keys->recv_aead);
+    gquic_tls_aead_dtor(&keys->send_aead);
+    return 0;
+}
+
+static gquic_auto_update_aead_keys_t *gquic_auto_update_aead_keys_alloc() {
+    gquic_auto_update_aead_keys_t *keys = malloc(sizeof(gquic_auto_update_aead_keys_t));
+    if (keys == NULL) {
+        return NULL;
+    }
+    gquic_auto_update_aead_keys_init(keys);
+    return keys;
+}
+
+static int gquic_auto_update_aead_keys_release(gquic_auto_update_aead_keys_t **const keys) {
+    if (keys == NULL) {
+        return -1;
+    }
+    if (*keys != NULL) {
+        gquic_auto_update_aead_keys_dtor(*keys);
+        free(*keys);
+        *keys = NULL;
+    }
+    return 0;
+}
+
+static int gquic_auto_update_aead_keys_derive_half(gquic_str_t *const next_traffic_sec,
+                                                   gquic_tls_aead_t *const next_aead,
+                                                   const gquic_tls_cipher_suite_t *const suite,
+                                                   const gquic_str_t *const traffic_sec) {
+    gquic_str_reset(next_traffic_sec);
+    if (gquic_auto_update_aead_next_traffic_sec(next_traffic_sec, suite, traffic_sec) != 0) {
+        return -1;
+    }
+    gquic_tls_aead_dtor(next_aead);
+    gquic_tls_aead_init(next_aead);
+    if (gquic_tls_create_aead(next_aead, suite, next_traffic_sec) != 0) {
+        return -2;
+    }
+    return 0;
+}
+
+static int gquic_auto_update_aead_keys_derive(gquic_auto_update_aead_keys_t *const keys,
+                                              const gquic_tls_cipher_suite_t *const suite,
+                                              const gquic_auto_update_aead_keys_t *const prev) {
+    if (keys == NULL || suite == NULL || prev == NULL) {
+        return -1;
+    }
+    if (gquic_auto_update_aead_keys_derive_half(&keys->recv_traffic_sec, &keys->recv_aead, suite, &prev->recv_traffic_sec) != 0) {
+        return -2;
+    }
+    if (gquic_auto_update_aead_keys_derive_half(&keys->send_traffic_sec, &keys->send_aead, suite, &prev->send_traffic_sec) != 0) {
+        return -3;
+    }
+    return 0;
+}
+
+static void gquic_auto_update_aead_refresh_pool_init() {
+    pthread_t thread;
+    size_t i;
+    gquic_sem_list_init(&gquic_auto_update_aead_refresh_jobs);
+    // the workers live as long as the process
+    for (i = 0; i < GQUIC_AUTO_UPDATE_AEAD_REFRESH_THREADS; i++) {
+        if (pthread_create(&thread, NULL, gquic_auto_update_aead_refresh_worker, NULL) == 0) {
+            pthread_detach(thread);
+            gquic_auto_update_aead_refresh_threads++;
+        }
+    }
+}
+
+static void *gquic_auto_update_aead_refresh_worker(void *const unused) {
+    gquic_auto_update_aead_refresh_job_t *job = NULL;
+    gquic_auto_update_aead_keys_t *keys = NULL;
+    (void) unused;
+    for ( ;; ) {
+        job = NULL;
+        if (gquic_sem_list_pop((void **) &job, &gquic_auto_update_aead_refresh_jobs) != 0 || job == NULL) {
+            continue;
+        }
+        keys = NULL;
+        // the AEAD has rolled or been rekeyed since, these keys would be thrown away
+        if (job->prev->seq == __atomic_load_n(&job->refresh->seq, __ATOMIC_ACQUIRE)
+            && (keys = gquic_auto_update_aead_keys_alloc()) != NULL
+            && gquic_auto_update_aead_keys_derive(keys, job->suite, job->prev) == 0) {
+            keys->seq = job->prev->seq;
+            keys = __atomic_exchange_n(&job->refresh->ready, keys, __ATOMIC_ACQ_REL);
+        }
+        // keys that failed to derive, or earlier ones no roll took
+        gquic_auto_update_aead_keys_release(&keys);
+        gquic_auto_update_aead_keys_release(&job->prev);
+        gquic_auto_update_aead_refresh_release(job->refresh);
+        gquic_list_release(job);
+    }
+    return NULL;
+}
+
+static int gquic_auto_update_aead_refresh_release(gquic_auto_update_aead_refresh_t *const refresh) {
+    if (refresh == NULL) {
+        return -1;
+    }
+    if (__atomic_sub_fetch(&refresh->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        gquic_auto_update_aead_keys_release(&refresh->ready);
+        free(refresh);
+    }
+    return 0;
+}
+
+static int gquic_auto_update_aead_post_refresh(gquic_auto_update_aead_t *const aead) {
+    gquic_auto_update_aead_refresh_job_t *job = NULL;
+    if (aead->next == NULL || aead->suite == NULL) {
+        return 0;
+    }
+    if (GQUIC_STR_SIZE(&aead->next->recv_traffic_sec) == 0 || GQUIC_STR_SIZE(&aead->next->send_traffic_sec) == 0) {
+        return 0;
+    }
+    pthread_once(&gquic_auto_update_aead_refresh_once, gquic_auto_update_aead_refresh_pool_init);
+    if (gquic_auto_update_aead_refresh_threads == 0) {
+        // no worker to run the job, every roll derives its keys itself
+        return -1;
+    }
+    if (aead->refresh == NULL) {
+        if ((aead->refresh = malloc(sizeof(gquic_auto_update_aead_refresh_t))) == NULL) {
+            return -2;
+        }
+        aead->refresh->refs = 1;
+        aead->refresh->seq = 0;
+        aead->refresh->ready = NULL;
+    }
+    __atomic_store_n(&aead->refresh->seq, aead->next_seq, __ATOMIC_RELEASE);
+
+    if ((job = gquic_list_alloc(sizeof(gquic_auto_update_aead_refresh_job_t))) == NULL) {
+        return -3;
+    }
+    job->refresh = aead->refresh;
+    job->suite = aead->suite;
+    // the worker gets its own copy of the secrets, next may be gone by the time it runs
+    if ((job->prev = gquic_auto_update_aead_keys_alloc()) == NULL
+        || gquic_str_copy(&job->prev->recv_traffic_sec, &aead->next->recv_traffic_sec) != 0
+        || gquic_str_copy(&job->prev->send_traffic_sec, &aead->next->send_traffic_sec) != 0) {
+        gquic_auto_update_aead_keys_release(&job->prev);
+        gquic_list_release(job);
+        return -4;
+    }
+    job->prev->seq = aead->next_seq;
+    __atomic_add_fetch(&aead->refresh->refs, 1, __ATOMIC_RELAXED);
+    if (gquic_sem_list_push(&gquic_auto_update_aead_refresh_jobs, job) != 0) {
+        gquic_auto_update_aead_refresh_release(aead->refresh);
+        gquic_auto_update_aead_keys_release(&job->prev);
+        gquic_list_release(job);
+        return -5;
+    }
+    return 0;
+}
+
+static gquic_auto_update_aead_keys_t *gquic_auto_update_aead_take_refreshed(gquic_auto_update_aead_t *const aead) {
+    gquic_auto_update_aead_keys_t *keys = NULL;
+    if (aead->refresh == NULL) {
+        return NULL;
+    }
+    keys = __atomic_exchange_n(&aead->refresh->ready, NULL, __ATOMIC_ACQUIRE);
+    if (keys != NULL && keys->seq != aead->next_seq) {
+        gquic_auto_update_aead_keys_release(&keys);
+    }
+    return keys;
+}
+
 int gquic_auto_update_aead_set_rkey(gquic_auto_update_aead_t *const aead,
                                     const gquic_tls_cipher_suite_t *const suite,
                                     const gquic_str_t *const traffic_sec) {
-    gquic_str_t next_recv_traffic_sec = { 0, NULL };
     if (aead == NULL || suite == NULL || traffic_sec == NULL) {
         return -1;
     }
@@ -142,27 +407,24 @@ int gquic_auto_update_aead_set_rkey(gquic_auto_update_aead_t *const aead,
         if (gquic_str_alloc(&aead->nonce_buf, 12) != 0) {
             return -4;
         }
+        gquic_str_clear(&aead->nonce_buf);
         aead->suite = suite;
     }
-    if (gquic_auto_update_aead_next_traffic_sec(&next_recv_traffic_sec, suite, traffic_sec) != 0) {
+    if (aead->next == NULL && (aead->next = gquic_auto_update_aead_keys_alloc()) == NULL) {
         return -5;
     }
-    gquic_str_reset(&aead->next_recv_traffic_sec);
-    gquic_str_copy(&aead->next_recv_traffic_sec, &next_recv_traffic_sec);
-    gquic_tls_aead_dtor(&aead->next_recv_aead);
-    gquic_tls_aead_init(&aead->next_recv_aead);
-    if (gquic_tls_create_aead(&aead->next_recv_aead, suite, &aead->next_recv_traffic_sec) != 0) {
+    if (gquic_auto_update_aead_keys_derive_half(&aead->next->recv_traffic_sec, &aead->next->recv_aead, suite, traffic_sec) != 0) {
         return -6;
     }
+    aead->next_seq++;
 
-    gquic_str_reset(&next_recv_traffic_sec);
+    gquic_auto_update_aead_post_refresh(aead);
     return 0;
 }
 
 int gquic_auto_update_aead_set_wkey(gquic_auto_update_aead_t *const aead,
                                     const gquic_tls_cipher_suite_t *const suite,
                                     const gquic_str_t *const traffic_sec) {
-    gquic_str_t next_send_traffic_sec = { 0, NULL };
     if (aead == NULL || suite == NULL || traffic_sec == NULL) {
         return -1;
     }
@@ -182,40 +444,32 @@ int gquic_auto_update_aead_set_wkey(gquic_auto_update_aead_t *const aead,
         if (gquic_str_alloc(&aead->nonce_buf, 12) != 0) {
             return -4;
         }
+        gquic_str_clear(&aead->nonce_buf);
         aead->suite = suite;
     }
-    if (gquic_auto_update_aead_next_traffic_sec(&next_send_traffic_sec, suite, traffic_sec) != 0) {
+    if (aead->next == NULL && (aead->next = gquic_auto_update_aead_keys_alloc()) == NULL) {
         return -5;
     }
-    gquic_str_reset(&aead->next_send_traffic_sec);
-    gquic_str_copy(&aead->next_send_traffic_sec, &next_send_traffic_sec);
-    gquic_tls_aead_dtor(&aead->next_send_aead);
-    gquic_tls_aead_init(&aead->next_send_aead);
-    if (gquic_tls_create_aead(&aead->next_send_aead, suite, &aead->next_send_traffic_sec) != 0) {
+    if (gquic_auto_update_aead_keys_derive_half(&aead->next->send_traffic_sec, &aead->next->send_aead, suite, traffic_sec) != 0) {
         return -6;
     }
+    aead->next_seq++;
 
-    gquic_str_reset(&next_send_traffic_sec);
+    gquic_auto_update_aead_post_refresh(aead);
     return 0;
 }
 
-int gquic_auto_update_aead_open(gquic_str_t *const plain_text,
+int gquic_auto_update_aead_open(gquic_str_t *const text,
                                 gquic_auto_update_aead_t *const aead,
                                 const u_int64_t recv_time,
                                 const u_int64_t pn,
                                 int kp,
                                 const gquic_str_t *const tag,
-                                const gquic_str_t *const cipher_text,
                                 const gquic_str_t *const addata) {
-    if (plain_text == NULL || aead == NULL || tag == NULL || cipher_text == NULL || addata == NULL) {
+    if (text == NULL || aead == NULL || tag == NULL || addata == NULL) {
         return -1;
     }
-    if (aead->prev_recv_aead.self != NULL && recv_time > aead->prev_recv_aead_expire) {
-        gquic_tls_aead_dtor(&aead->prev_recv_aead);
-        gquic_tls_aead_init(&aead->prev_recv_aead);
-        aead->prev_recv_aead_expire = 0;
-    }
-    gquic_big_endian_transfer(GQUIC_STR_VAL(&aead->nonce_buf) - 8, &pn, 8);
+    gquic_big_endian_transfer(GQUIC_STR_VAL(&aead->nonce_buf) + GQUIC_STR_SIZE(&aead->nonce_buf) - 8, &pn, 8);
     if (kp != (aead->times % 2 == 1)) {
         if (aead->cur_key_first_recv_pn == ((u_int64_t) -1) || pn < aead->cur_key_first_recv_pn) {
             if (aead->times == 0) {
@@ -224,12 +478,15 @@ int gquic_auto_update_aead_open(gquic_str_t *const plain_text,
             if (aead->prev_recv_aead.self == NULL) {
                 return -3;
             }
-            if (GQUIC_TLS_AEAD_OPEN(plain_text, &aead->prev_recv_aead, &aead->nonce_buf, tag, cipher_text, addata) != 0) {
+            if (GQUIC_TLS_AEAD_OPEN(text, &aead->prev_recv_aead, &aead->nonce_buf, tag, addata) != 0) {
                 return -4;
             }
             return 0;
         }
-        if (GQUIC_TLS_AEAD_OPEN(plain_text, &aead->next_recv_aead, &aead->nonce_buf, tag, cipher_text, addata) != 0) {
+        if (aead->next == NULL) {
+            return -9;
+        }
+        if (GQUIC_TLS_AEAD_OPEN(text, &aead->next->recv_aead, &aead->nonce_buf, tag, addata) != 0) {
             return -5;
         }
         if (aead->cur_key_first_sent_pn == ((u_int64_t) -1)) {
@@ -241,7 +498,7 @@ int gquic_auto_update_aead_open(gquic_str_t *const plain_text,
         aead->cur_key_first_recv_pn = pn;
         return 0;
     }
-    if (GQUIC_TLS_AEAD_OPEN(plain_text, &aead->recv_aead, &aead->nonce_buf, tag, cipher_text, addata) != 0) {
+    if (GQUIC_TLS_AEAD_OPEN(text, &aead->recv_aead, &aead->nonce_buf, tag, addata) != 0) {
         return -8;
     }
     aead->cur_key_num_recv++;
@@ -253,21 +510,63 @@ int gquic_auto_update_aead_open(gquic_str_t *const plain_text,
 }
 
 int gquic_auto_update_aead_seal(gquic_str_t *const tag,
-                                gquic_str_t *const cipher_text,
+                                gquic_str_t *const text,
                                 gquic_auto_update_aead_t *const aead,
                                 const u_int64_t pn,
-                                const gquic_str_t *const plain_text,
                                 const gquic_str_t *const addata) {
-    if (cipher_text == NULL || tag == NULL || aead == NULL || plain_text == NULL || addata == NULL) {
+    if (text == NULL || tag == NULL || aead == NULL || addata == NULL) {
         return -1;
     }
     if (aead->cur_key_first_sent_pn == ((u_int64_t) -1)) {
         aead->cur_key_first_sent_pn = pn;
     }
     aead->cur_key_num_sent++;
-    gquic_big_endian_transfer(GQUIC_STR_VAL(&aead->nonce_buf) - 8, &pn, 8);
-    if (GQUIC_TLS_AEAD_SEAL(tag, cipher_text, &aead->send_aead, &aead->nonce_buf, plain_text, addata) != 0) {
+    aead->cur_key_bytes_sent += GQUIC_STR_SIZE(text);
+    gquic_big_endian_transfer(GQUIC_STR_VAL(&aead->nonce_buf) + GQUIC_STR_SIZE(&aead->nonce_buf) - 8, &pn, 8);
+    if (GQUIC_TLS_AEAD_SEAL(tag, text, &aead->send_aead, &aead->nonce_buf, addata) != 0) {
         return -2;
     }
     return 0;
 }
+
+int gquic_auto_update_aead_seal_batch(gquic_str_t *const tags,
+                                      gquic_str_t *const texts,
+                                      gquic_auto_update_aead_t *const aead,
+                                      const u_int64_t *const pns,
+                                      const gquic_str_t *const addatas,
+                                      const size_t count) {
+    u_int8_t nonce_bufs[GQUIC_TLS_AEAD_MAX_BATCH][12];
+    gquic_str_t nonces[GQUIC_TLS_AEAD_MAX_BATCH];
+    size_t off = 0;
+    size_t n = 0;
+    size_t i = 0;
+    if (tags == NULL || texts == NULL || aead == NULL || pns == NULL || addatas == NULL) {
+        return -1;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    if (GQUIC_STR_SIZE(&aead->nonce_buf) != sizeof(nonce_bufs[0])) {
+        return -2;
+    }
+    if (aead->cur_key_first_sent_pn == ((u_int64_t) -1)) {
+        aead->cur_key_first_sent_pn = pns[0];
+    }
+    aead->cur_key_num_sent += count;
+    for (i = 0; i < count; i++) {
+        aead->cur_key_bytes_sent += GQUIC_STR_SIZE(&texts[i]);
+    }
+    for (off = 0; off < count; off += n) {
+        n = count - off < GQUIC_TLS_AEAD_MAX_BATCH ? count - off : GQUIC_TLS_AEAD_MAX_BATCH;
+        for (i = 0; i < n; i++) {
+            memcpy(nonce_bufs[i], GQUIC_STR_VAL(&aead->nonce_buf), sizeof(nonce_bufs[i]));
+            gquic_big_endian_transfer(nonce_bufs[i] + sizeof(nonce_bufs[i]) - 8, &pns[off + i], 8);
+            nonces[i].size = sizeof(nonce_bufs[i]);
+            nonces[i].val = nonce_bufs[i];
+        }
+        if (GQUIC_TLS_AEAD_SEAL_BATCH(tags + off, texts + off, &aead->send_aead, nonces, addatas + off, n) != 0) {
+            return -3;
+        }
+    }
+    return 0;
+}
@@ -5,6 +5,7 @@
 
 
 static void *__establish_run(void *);
+static int gquic_establish_handshake_done(void *const, const int);
 static int gquic_establish_check_enc_level(const u_int8_t, const u_int8_t);
 static int gquic_establish_waiting_handshake_done_cmp(const void *const, const void *const);
 static int gquic_establish_cli_handle_msg(gquic_handshake_establish_t *const, const u_int8_t);
@@ -35,6 +36,8 @@ int gquic_handshake_event_init(gquic_handshake_event_t *const event) {
     event->drop_keys.self = NULL;
     event->on_handshake_complete.cb = NULL;
     event->on_handshake_complete.self = NULL;
+    event->on_restore_params.cb = NULL;
+    event->on_restore_params.self = NULL;
 
     return 0;
 }
@@ -53,6 +56,7 @@ int gquic_handshake_establish_init(gquic_handshake_establish_t *const est) {
     gquic_sem_list_init(&est->handshake_process_events_queue);
     est->cli_hello_written = 0;
     est->is_client = 0;
+    est->version = 0;
     sem_init(&est->client_written_sem, 0, 0);
     sem_init(&est->mtx, 0, 1);
     est->read_enc_level = GQUIC_ENC_LV_INITIAL;
@@ -63,6 +67,8 @@ int gquic_handshake_establish_init(gquic_handshake_establish_t *const est) {
     gquic_io_init(&est->handshake_output);
     gquic_common_long_header_opener_init(&est->handshake_opener);
     gquic_common_long_header_sealer_init(&est->handshake_sealer);
+    gquic_common_long_header_opener_init(&est->zero_rtt_opener);
+    gquic_common_long_header_sealer_init(&est->zero_rtt_sealer);
     gquic_io_init(&est->one_rtt_output);
     gquic_auto_update_aead_init(&est->aead);
     est->has_1rtt_sealer = 0;
@@ -82,6 +88,10 @@ int gquic_handshake_establish_dtor(gquic_handshake_establish_t *const est) {
     }
     
     // TODO
+    gquic_common_long_header_opener_dtor(&est->zero_rtt_opener);
+    gquic_common_long_header_sealer_dtor(&est->zero_rtt_sealer);
+    gquic_auto_update_aead_dtor(&est->aead);
+    gquic_str_reset(&est->conn.app_data);
 
     return 0;
 }
@@ -97,6 +107,7 @@ int gquic_handshake_establish_ctor(gquic_handshake_establish_t *const est,
                                    int (*chello_written_cb) (void *const),
                                    gquic_tls_config_t *const cfg,
                                    const gquic_str_t *const conn_id,
+                                   const gquic_version_t version,
                                    const gquic_transport_parameters_t *const params,
                                    gquic_rtt_t *const rtt,
                                    const gquic_net_addr_t *const addr,
@@ -111,7 +122,9 @@ int gquic_handshake_establish_ctor(gquic_handshake_establish_t *const est,
 
     gquic_common_long_header_sealer_init(&est->initial_sealer);
     gquic_common_long_header_opener_init(&est->initial_opener);
-    gquic_handshake_initial_aead_init(&est->initial_sealer, &est->initial_opener, conn_id, is_client);
+    if (gquic_handshake_initial_aead_init(&est->initial_sealer, &est->initial_opener, version, conn_id, is_client) != 0) {
+        return -2;
+    }
 
     gquic_io_writer_implement(&est->init_output, initial_stream_self, initial_stream_cb);
     gquic_io_writer_implement(&est->handshake_output, handshake_stream_self, handshake_stream_cb);
@@ -120,10 +133,13 @@ int gquic_handshake_establish_ctor(gquic_handshake_establish_t *const est,
     est->aead.rtt = rtt;
     est->cfg = cfg;
     est->is_client = is_client;
+    est->version = version;
     est->conn.addr = addr;
     est->conn.cfg = cfg;
     est->conn.is_client = is_client;
     est->conn.ver = GQUIC_TLS_VERSION_13;
+    est->conn.on_handshake_done.self = est;
+    est->conn.on_handshake_done.cb = gquic_establish_handshake_done;
 
     est->chello_written.cb = chello_written_cb;
     est->chello_written.self = chello_written_self;
@@ -141,6 +157,7 @@ int gquic_handshake_establish_change_conn_id(gquic_handshake_establish_t *const
     gquic_common_long_header_opener_init(&est->handshake_opener);
     if (gquic_handshake_initial_aead_init(&est->handshake_sealer,
                                           &est->handshake_opener,
+                                          est->version,
                                           conn_id,
                                           est->is_client) != 0) {
         return -2;
@@ -187,6 +204,8 @@ int gquic_handshake_establish_run(gquic_handshake_establish_t *const est) {
 
     case GQUIC_ESTABLISH_ENDING_EVENT_CLOSE:
         gquic_sem_list_close(&est->msg_events_queue);
+        // a handshake suspended on its signature fails on the closed queue and reports DONE
+        gquic_tls_conn_handshake_resume(&est->conn);
         gquic_sem_list_waiting_pop((void **) &process_event,
                                    &est->handshake_process_events_queue,
                                    gquic_establish_waiting_handshake_done_cmp,
@@ -233,14 +252,27 @@ failure:
 
 static void *__establish_run(void *arg) {
     int err_ret;
+    gquic_handshake_establish_t *const est = arg;
+    if (est == NULL) {
+        return NULL;
+    }
+    // a pending handshake is finished by the sign pool, which calls on_handshake_done
+    if ((err_ret = gquic_tls_conn_handshake(&est->conn)) == GQUIC_TLS_HANDSHAKE_PENDING) {
+        return NULL;
+    }
+    gquic_establish_handshake_done(est, err_ret);
+    return NULL;
+}
+
+static int gquic_establish_handshake_done(void *const est_, const int err_ret) {
     gquic_establish_ending_event_t *ending_event = NULL;
     gquic_establish_err_event_t *err_event = NULL;
     gquic_establish_process_event_t *process_event = NULL;
-    gquic_handshake_establish_t *const est = arg;
+    gquic_handshake_establish_t *const est = est_;
     if (est == NULL) {
-        goto finish;
+        return -1;
     }
-    if ((err_ret = gquic_tls_conn_handshake(&est->conn)) != 0) {
+    if (err_ret != 0) {
         if ((err_event = gquic_list_alloc(sizeof(gquic_establish_err_event_t))) == NULL) {
             goto finish;
         }
@@ -259,14 +291,14 @@ static void *__establish_run(void *arg) {
     }
     ending_event->type = GQUIC_ESTABLISH_ENDING_EVENT_HANDSHAKE_COMPLETE;
     gquic_sem_list_push(&est->handshake_ending_events_queue, ending_event);
-    return NULL;
+    return 0;
 finish:
     if ((process_event = gquic_list_alloc(sizeof(gquic_establish_process_event_t))) == NULL) {
-        return NULL;
+        return -2;
     }
     process_event->type = GQUIC_ESTABLISH_PROCESS_EVENT_DONE;
     gquic_sem_list_rpush(&est->handshake_process_events_queue, process_event);
-    return NULL;
+    return 0;
 }
 
 int gquic_handshake_establish_close(gquic_handshake_establish_t *const est) {
@@ -566,12 +598,19 @@ ignore_ext:
         return 0;
 
     case GQUIC_TLS_HANDSHAKE_MSG_TYPE_FINISHED:
+        // a handshake suspended on its signature reads the queued Finished here
+        gquic_tls_conn_handshake_resume(&est->conn);
+        // the 1-RTT write key is installed before the client's Finished is read
+ignore_wkey:
         gquic_sem_list_waiting_pop((void **) &process_event,
                                    &est->handshake_process_events_queue,
                                    gquic_establish_waiting_ser_handle_cmp,
                                    &msg_type);
         type = process_event->type;
         gquic_list_release(process_event);
+        if (type == GQUIC_ESTABLISH_PROCESS_EVENT_RECV_WKEY) {
+            goto ignore_wkey;
+        }
         switch (type) {
         case GQUIC_ESTABLISH_PROCESS_EVENT_RECV_RKEY:
             break;
@@ -604,6 +643,7 @@ static int gquic_establish_waiting_ser_handle_cmp(const void *const event, const
         break;
     case GQUIC_TLS_HANDSHAKE_MSG_TYPE_FINISHED:
         if (process_event->type == GQUIC_ESTABLISH_PROCESS_EVENT_RECV_RKEY
+            || process_event->type == GQUIC_ESTABLISH_PROCESS_EVENT_RECV_WKEY
             || process_event->type == GQUIC_ESTABLISH_PROCESS_EVENT_DONE) {
             return 0;
         }
@@ -649,6 +689,17 @@ int gquic_handshake_establish_set_rkey(gquic_handshake_establish_t *const est,
                                                                est->is_client);
         break;
 
+    case GQUIC_ENC_LV_0RTT:
+        // the handshake does not wait on the 0-RTT key, so no process event for it
+        gquic_common_long_header_opener_dtor(&est->zero_rtt_opener);
+        gquic_common_long_header_opener_init(&est->zero_rtt_opener);
+        if (gquic_common_long_header_opener_long_header_traffic_ctor(&est->zero_rtt_opener, suite, traffic_sec) != 0) {
+            ret = -7;
+            goto failure;
+        }
+        sem_post(&est->mtx);
+        return 0;
+
     case GQUIC_ENC_LV_APP:
         est->read_enc_level = GQUIC_ENC_LV_1RTT;
         if (gquic_auto_update_aead_set_rkey(&est->aead, suite, traffic_sec) != 0) {
@@ -683,8 +734,22 @@ int gquic_handshake_establish_set_wkey(gquic_handshake_establish_t *const est,
     if (est == NULL || suite == NULL || traffic_sec == NULL) {
         return -1;
     }
+    if (enc_level == GQUIC_ENC_LV_0RTT) {
+        // limits for early data come from the parameters remembered with the ticket
+        GQUIC_HANDSHAKE_EVENT_ON_RESTORE_PARAMS(&est->events, &est->conn.app_data);
+    }
     sem_wait(&est->mtx);
     switch (enc_level) {
+    case GQUIC_ENC_LV_0RTT:
+        gquic_common_long_header_sealer_dtor(&est->zero_rtt_sealer);
+        gquic_common_long_header_sealer_init(&est->zero_rtt_sealer);
+        if (gquic_common_long_header_sealer_long_header_traffic_ctor(&est->zero_rtt_sealer, suite, traffic_sec) != 0) {
+            ret = -7;
+            goto failure;
+        }
+        sem_post(&est->mtx);
+        return 0;
+
     case GQUIC_ENC_LV_HANDSHAKE:
         est->write_enc_level = GQUIC_ENC_LV_HANDSHAKE;
         gquic_common_long_header_sealer_dtor(&est->handshake_sealer);
@@ -716,6 +781,10 @@ int gquic_handshake_establish_set_wkey(gquic_handshake_establish_t *const est,
     }
     process_event->type = GQUIC_ESTABLISH_PROCESS_EVENT_RECV_WKEY;
     gquic_sem_list_push(&est->handshake_process_events_queue, process_event);
+    if (enc_level == GQUIC_ENC_LV_APP && est->is_client) {
+        // from here on the client sends 1-RTT packets only
+        gquic_handshake_establish_drop_0rtt_keys(est);
+    }
     return 0;
 failure:
     sem_post(&est->mtx);
@@ -752,6 +821,24 @@ int gquic_handshake_establish_drop_handshake_keys(gquic_handshake_establish_t *c
     return 0;
 }
 
+int gquic_handshake_establish_drop_0rtt_keys(gquic_handshake_establish_t *const est) {
+    int dropped = 0;
+    if (est == NULL) {
+        return -1;
+    }
+    sem_wait(&est->mtx);
+    if (est->zero_rtt_opener.available || est->zero_rtt_sealer.available) {
+        gquic_common_long_header_opener_dtor(&est->zero_rtt_opener);
+        gquic_common_long_header_sealer_dtor(&est->zero_rtt_sealer);
+        dropped = 1;
+    }
+    sem_post(&est->mtx);
+    if (dropped) {
+        GQUIC_HANDSHAKE_EVENT_DROP_KEYS(&est->events, GQUIC_ENC_LV_0RTT);
+    }
+    return 0;
+}
+
 static int gquic_establish_drop_initial_keys_wrap(void *const est) {
     return gquic_handshake_establish_drop_initial_keys(est);
 }
@@ -959,6 +1046,25 @@ int gquic_handshake_establish_get_handshake_opener(gquic_header_protector_t **co
     return ret;
 }
 
+int gquic_handshake_establish_get_0rtt_opener(gquic_header_protector_t **const protector,
+                                              gquic_common_long_header_opener_t **const opener,
+                                              gquic_handshake_establish_t *const est) {
+    int ret = 0;
+    if (protector == NULL || opener == NULL || est == NULL) {
+        return -1;
+    }
+    sem_wait(&est->mtx);
+    if (!est->zero_rtt_opener.available) {
+        ret = -2;
+    }
+    else if (gquic_common_long_header_opener_get_header_opener(protector, &est->zero_rtt_opener) != 0) {
+        ret = -3;
+    }
+    *opener = &est->zero_rtt_opener;
+    sem_post(&est->mtx);
+    return ret;
+}
+
 int gquic_handshake_establish_get_1rtt_opener(gquic_header_protector_t **const protector,
                                               gquic_auto_update_aead_t **const opener,
                                               gquic_handshake_establish_t *const est) {
@@ -1021,6 +1127,25 @@ int gquic_handshake_establish_get_handshake_sealer(gquic_header_protector_t **co
     return ret;
 }
 
+int gquic_handshake_establish_get_0rtt_sealer(gquic_header_protector_t **const protector,
+                                              gquic_common_long_header_sealer_t **const sealer,
+                                              gquic_handshake_establish_t *const est) {
+    int ret = 0;
+    if (protector == NULL || sealer == NULL || est == NULL) {
+        return -1;
+    }
+    sem_wait(&est->mtx);
+    if (!est->zero_rtt_sealer.available) {
+        ret = -2;
+    }
+    else if (gquic_common_long_header_sealer_get_header_sealer(protector, &est->zero_rtt_sealer) != 0) {
+        ret = -3;
+    }
+    *sealer = &est->zero_rtt_sealer;
+    sem_post(&est->mtx);
+    return ret;
+}
+
 int gquic_handshake_establish_get_1rtt_sealer(gquic_header_protector_t **const protector,
                                               gquic_auto_update_aead_t **const sealer,
                                               gquic_handshake_establish_t *const est) {
@@ -1,13 +1,13 @@
 #include "handshake/header_protector.h"
 #include "tls/key_schedule.h"
 #include <malloc.h>
+#include <string.h>
 #include <openssl/evp.h>
-#include <openssl/aes.h>
 
 typedef struct gquic_aes_header_protector_s gquic_aes_header_protector_t;
 struct gquic_aes_header_protector_s {
-    gquic_str_t mask;
-    AES_KEY key;
+    u_int8_t mask[16];
+    EVP_CIPHER_CTX *ctx;
     int is_long_header;
 };
 
@@ -19,18 +19,46 @@ static int gquic_aes_header_protector_ctor(gquic_aes_header_protector_t *const,
 static int gquic_aes_header_protector_set_key(void *const, gquic_str_t *const);
 static int gquic_aes_header_protector_encrypt(gquic_str_t *const, u_int8_t *const, void *const);
 static int gquic_aes_header_protector_decrypt(gquic_str_t *const, u_int8_t *const, void *const);
-static int gquic_aes_header_protector_apply(gquic_str_t *const,
-                                            u_int8_t *const,
-                                            gquic_aes_header_protector_t *const);
+static int gquic_aes_header_protector_apply_batch(gquic_str_t *const,
+                                                  u_int8_t *const *const,
+                                                  void *const,
+                                                  const gquic_str_t *const,
+                                                  const size_t);
 static int gquic_aes_header_protector_dtor(void *const);
 
+typedef struct gquic_chacha20_header_protector_s gquic_chacha20_header_protector_t;
+struct gquic_chacha20_header_protector_s {
+    u_int8_t mask[5];
+    EVP_CIPHER_CTX *ctx;
+    int is_long_header;
+};
+
+static int gquic_chacha20_header_protector_init(gquic_chacha20_header_protector_t *const);
+static int gquic_chacha20_header_protector_ctor(gquic_chacha20_header_protector_t *const,
+                                                const gquic_tls_cipher_suite_t *const,
+                                                const gquic_str_t *const,
+                                                int);
+static int gquic_chacha20_header_protector_set_key(void *const, gquic_str_t *const);
+static int gquic_chacha20_header_protector_encrypt(gquic_str_t *const, u_int8_t *const, void *const);
+static int gquic_chacha20_header_protector_decrypt(gquic_str_t *const, u_int8_t *const, void *const);
+static int gquic_chacha20_header_protector_apply_batch(gquic_str_t *const,
+                                                       u_int8_t *const *const,
+                                                       void *const,
+                                                       const gquic_str_t *const,
+                                                       const size_t);
+static int gquic_chacha20_header_protector_dtor(void *const);
+
+static int gquic_header_protector_apply_mask(gquic_str_t *const, u_int8_t *const, const u_int8_t *const, const int);
+
 int gquic_header_protector_init(gquic_header_protector_t *const protector) {
     if (protector == NULL) {
         return -1;
     }
     protector->self = NULL;
+    protector->set_key = NULL;
     protector->encrypt = NULL;
     protector->decrypt = NULL;
+    protector->apply_batch = NULL;
     protector->dtor = NULL;
     return 0;
 }
@@ -39,9 +67,46 @@ int gquic_header_protector_ctor(gquic_header_protector_t *const protector,
                                 const gquic_tls_cipher_suite_t *const suite,
                                 const gquic_str_t *const traffic_sec,
                                 int is_long_header) {
+    int ret = 0;
+    gquic_str_t header_protector_key = { 0, NULL };
     if (protector == NULL || suite == NULL || traffic_sec == NULL) {
         return -1;
     }
+    if (gquic_header_protector_derive_key(&header_protector_key, suite, traffic_sec) != 0) {
+        return -5;
+    }
+    ret = gquic_header_protector_key_ctor(protector, suite, &header_protector_key, is_long_header);
+    gquic_str_reset(&header_protector_key);
+    return ret;
+}
+
+int gquic_header_protector_derive_key(gquic_str_t *const header_protector_key,
+                                      const gquic_tls_cipher_suite_t *const suite,
+                                      const gquic_str_t *const traffic_sec) {
+    static const gquic_str_t label = { 7, "quic hp" };
+    gquic_tls_mac_t hash;
+    if (header_protector_key == NULL || suite == NULL || traffic_sec == NULL) {
+        return -1;
+    }
+    gquic_tls_mac_init(&hash);
+    if (suite->mac(&hash, GQUIC_TLS_VERSION_13, NULL) != 0) {
+        return -2;
+    }
+    if (gquic_tls_hkdf_expand_label(header_protector_key, &hash, traffic_sec, NULL, &label, suite->key_len) != 0) {
+        gquic_tls_mac_dtor(&hash);
+        return -3;
+    }
+    gquic_tls_mac_dtor(&hash);
+    return 0;
+}
+
+int gquic_header_protector_key_ctor(gquic_header_protector_t *const protector,
+                                    const gquic_tls_cipher_suite_t *const suite,
+                                    const gquic_str_t *const header_protector_key,
+                                    int is_long_header) {
+    if (protector == NULL || suite == NULL || header_protector_key == NULL) {
+        return -1;
+    }
 
     switch (suite->id) {
     case GQUIC_TLS_CIPHER_SUITE_AES_128_GCM_SHA256:
@@ -50,16 +115,35 @@ int gquic_header_protector_ctor(gquic_header_protector_t *const protector,
             return -2;
         }
         gquic_aes_header_protector_init(protector->self);
-        if (gquic_aes_header_protector_ctor(protector->self, suite, traffic_sec, is_long_header) != 0) {
+        if (gquic_aes_header_protector_ctor(protector->self, suite, header_protector_key, is_long_header) != 0) {
+            gquic_aes_header_protector_dtor(protector->self);
+            free(protector->self);
+            protector->self = NULL;
             return -3;
         }
         protector->set_key = gquic_aes_header_protector_set_key;
         protector->encrypt = gquic_aes_header_protector_encrypt;
         protector->decrypt = gquic_aes_header_protector_decrypt;
+        protector->apply_batch = gquic_aes_header_protector_apply_batch;
         protector->dtor = gquic_aes_header_protector_dtor;
         break;
     case GQUIC_TLS_CIPHER_SUITE_CHACHA20_POLY1305_SHA256:
-        // TODO
+        if ((protector->self = malloc(sizeof(gquic_chacha20_header_protector_t))) == NULL) {
+            return -2;
+        }
+        gquic_chacha20_header_protector_init(protector->self);
+        if (gquic_chacha20_header_protector_ctor(protector->self, suite, header_protector_key, is_long_header) != 0) {
+            gquic_chacha20_header_protector_dtor(protector->self);
+            free(protector->self);
+            protector->self = NULL;
+            return -3;
+        }
+        protector->set_key = gquic_chacha20_header_protector_set_key;
+        protector->encrypt = gquic_chacha20_header_protector_encrypt;
+        protector->decrypt = gquic_chacha20_header_protector_decrypt;
+        protector->apply_batch = gquic_chacha20_header_protector_apply_batch;
+        protector->dtor = gquic_chacha20_header_protector_dtor;
+        break;
     default:
         return -4;
     }
@@ -71,83 +155,111 @@ static int gquic_aes_header_protector_init(gquic_aes_header_protector_t *const p
     if (protector == NULL) {
         return -1;
     }
-    gquic_str_init(&protector->mask);
+    memset(protector->mask, 0, sizeof(protector->mask));
+    protector->ctx = NULL;
     protector->is_long_header = 0;
 
     return 0;
 }
 
 static int gquic_aes_header_protector_ctor(gquic_aes_header_protector_t *const protector,
-                                                     const gquic_tls_cipher_suite_t *const suite,
-                                                     const gquic_str_t *const traffic_sec,
-                                                     int is_long_header) {
-    gquic_tls_mac_t hash;
-    gquic_str_t header_protector_key = { 0, NULL };
-    static const gquic_str_t label = { 7, "quic hp" };
-    if (protector == NULL || suite == NULL || traffic_sec == NULL) {
+                                           const gquic_tls_cipher_suite_t *const suite,
+                                           const gquic_str_t *const header_protector_key,
+                                           int is_long_header) {
+    const EVP_CIPHER *cipher = NULL;
+    if (protector == NULL || suite == NULL || header_protector_key == NULL) {
         return -1;
     }
-    gquic_tls_mac_init(&hash);
-    suite->mac(&hash, GQUIC_TLS_VERSION_13, NULL);
-    gquic_tls_hkdf_expand_label(&header_protector_key, &hash, traffic_sec, NULL, &label, suite->key_len);
-    if (AES_set_encrypt_key(GQUIC_STR_VAL(&header_protector_key), suite->key_len * 8, &protector->key) < 0) {
+    switch (suite->key_len) {
+    case 16:
+        cipher = EVP_aes_128_ecb();
+        break;
+    case 32:
+        cipher = EVP_aes_256_ecb();
+        break;
+    default:
         return -2;
     }
-    if (gquic_str_alloc(&protector->mask, suite->key_len) != 0) {
+    if (GQUIC_STR_SIZE(header_protector_key) != suite->key_len) {
         return -3;
     }
+    if ((protector->ctx = EVP_CIPHER_CTX_new()) == NULL) {
+        return -4;
+    }
+    // keyed once; every sample is a single ECB block, so many samples can go through one update
+    if (EVP_EncryptInit_ex(protector->ctx, cipher, NULL, GQUIC_STR_VAL(header_protector_key), NULL) <= 0
+        || EVP_CIPHER_CTX_set_padding(protector->ctx, 0) <= 0) {
+        return -5;
+    }
     protector->is_long_header = is_long_header;
 
-    gquic_tls_mac_dtor(&hash);
-    gquic_str_reset(&header_protector_key);
     return 0;
 }
 
 static int gquic_aes_header_protector_set_key(void *const self_, gquic_str_t *const sample) {
+    int outlen = 0;
     gquic_aes_header_protector_t *const self = self_;
     if (self == NULL || sample == NULL) {
         return -1;
     }
-    if (GQUIC_STR_SIZE(sample) != GQUIC_STR_SIZE(&self->mask)) {
+    if (GQUIC_STR_SIZE(sample) != sizeof(self->mask)) {
         return -2;
     }
-    AES_encrypt(GQUIC_STR_VAL(sample), GQUIC_STR_VAL(&self->mask), &self->key);
+    if (EVP_EncryptUpdate(self->ctx, self->mask, &outlen, GQUIC_STR_VAL(sample), sizeof(self->mask)) <= 0) {
+        return -3;
+    }
     return 0;
 }
 
 static int gquic_aes_header_protector_encrypt(gquic_str_t *const header,
                                               u_int8_t *const first_byte,
                                               void *const self) {
-    return gquic_aes_header_protector_apply(header, first_byte, self);
+    if (self == NULL) {
+        return -1;
+    }
+    return gquic_header_protector_apply_mask(header, first_byte,
+                                             ((gquic_aes_header_protector_t *) self)->mask,
+                                             ((gquic_aes_header_protector_t *) self)->is_long_header);
 }
 
 static int gquic_aes_header_protector_decrypt(gquic_str_t *const header,
                                               u_int8_t *const first_byte,
                                               void *const self) {
-    return gquic_aes_header_protector_apply(header, first_byte, self);
+    return gquic_aes_header_protector_encrypt(header, first_byte, self);
 }
 
-static int gquic_aes_header_protector_apply(gquic_str_t *const header,
-                                            u_int8_t *const first_byte,
-                                            gquic_aes_header_protector_t *const self) {
-    size_t i;
-    if (self == NULL || (header == NULL && first_byte == NULL)) {
+static int gquic_aes_header_protector_apply_batch(gquic_str_t *const headers,
+                                                  u_int8_t *const *const first_bytes,
+                                                  void *const self_,
+                                                  const gquic_str_t *const samples,
+                                                  const size_t count) {
+    u_int8_t blocks[GQUIC_HEADER_PROTECTOR_MAX_BATCH][16];
+    int outlen = 0;
+    size_t off = 0;
+    size_t n = 0;
+    size_t i = 0;
+    gquic_aes_header_protector_t *const self = self_;
+    if (headers == NULL || first_bytes == NULL || self == NULL || samples == NULL) {
         return -1;
     }
-    if (first_byte != NULL) {
-        if (self->is_long_header) {
-            *first_byte ^= GQUIC_STR_FIRST_BYTE(&self->mask) & 0x0f;
+    for (off = 0; off < count; off += n) {
+        n = count - off < GQUIC_HEADER_PROTECTOR_MAX_BATCH ? count - off : GQUIC_HEADER_PROTECTOR_MAX_BATCH;
+        for (i = 0; i < n; i++) {
+            if (GQUIC_STR_SIZE(&samples[off + i]) != 16) {
+                return -2;
+            }
+            memcpy(blocks[i], GQUIC_STR_VAL(&samples[off + i]), 16);
         }
-        else {
-            *first_byte ^= GQUIC_STR_FIRST_BYTE(&self->mask) & 0x1f;
+        // one update over all blocks lets the cipher pipeline them
+        if (EVP_EncryptUpdate(self->ctx, blocks[0], &outlen, blocks[0], n * 16) <= 0) {
+            return -3;
         }
-    }
-    if (header != NULL) {
-        for (i = 0; i < GQUIC_STR_SIZE(header); i++) {
-            ((u_int8_t *) GQUIC_STR_VAL(header))[i] ^= ((u_int8_t *) GQUIC_STR_VAL(&self->mask))[i % GQUIC_STR_SIZE(&self->mask)];
+        for (i = 0; i < n; i++) {
+            if (gquic_header_protector_apply_mask(&headers[off + i], first_bytes[off + i], blocks[i], self->is_long_header) != 0) {
+                return -4;
+            }
         }
     }
-
     return 0;
 }
 
@@ -155,7 +267,141 @@ static int gquic_aes_header_protector_dtor(void *const protector) {
     if (protector == NULL) {
         return -1;
     }
-    gquic_str_reset(&((gquic_aes_header_protector_t *) protector)->mask);
+    if (((gquic_aes_header_protector_t *) protector)->ctx != NULL) {
+        EVP_CIPHER_CTX_free(((gquic_aes_header_protector_t *) protector)->ctx);
+        ((gquic_aes_header_protector_t *) protector)->ctx = NULL;
+    }
+    return 0;
+}
+
+static int gquic_chacha20_header_protector_init(gquic_chacha20_header_protector_t *const protector) {
+    if (protector == NULL) {
+        return -1;
+    }
+    memset(protector->mask, 0, sizeof(protector->mask));
+    protector->ctx = NULL;
+    protector->is_long_header = 0;
+
+    return 0;
+}
+
+static int gquic_chacha20_header_protector_ctor(gquic_chacha20_header_protector_t *const protector,
+                                                const gquic_tls_cipher_suite_t *const suite,
+                                                const gquic_str_t *const header_protector_key,
+                                                int is_long_header) {
+    if (protector == NULL || suite == NULL || header_protector_key == NULL) {
+        return -1;
+    }
+    if (GQUIC_STR_SIZE(header_protector_key) != suite->key_len) {
+        return -2;
+    }
+    if ((protector->ctx = EVP_CIPHER_CTX_new()) == NULL) {
+        return -3;
+    }
+    // keyed once, the sample is loaded as counter || nonce for every packet
+    if (EVP_EncryptInit_ex(protector->ctx, EVP_chacha20(), NULL, GQUIC_STR_VAL(header_protector_key), NULL) <= 0) {
+        return -4;
+    }
+    protector->is_long_header = is_long_header;
+
+    return 0;
+}
+
+static int gquic_chacha20_header_protector_set_key(void *const self_, gquic_str_t *const sample) {
+    static const u_int8_t zeros[5] = { 0 };
+    int outlen = 0;
+    gquic_chacha20_header_protector_t *const self = self_;
+    if (self == NULL || sample == NULL) {
+        return -1;
+    }
+    if (GQUIC_STR_SIZE(sample) != 16) {
+        return -2;
+    }
+    if (EVP_EncryptInit_ex(self->ctx, NULL, NULL, NULL, GQUIC_STR_VAL(sample)) <= 0
+        || EVP_EncryptUpdate(self->ctx, self->mask, &outlen, zeros, sizeof(zeros)) <= 0) {
+        return -3;
+    }
+    return 0;
+}
+
+static int gquic_chacha20_header_protector_encrypt(gquic_str_t *const header,
+                                                   u_int8_t *const first_byte,
+                                                   void *const self) {
+    if (self == NULL) {
+        return -1;
+    }
+    return gquic_header_protector_apply_mask(header, first_byte,
+                                             ((gquic_chacha20_header_protector_t *) self)->mask,
+                                             ((gquic_chacha20_header_protector_t *) self)->is_long_header);
+}
+
+static int gquic_chacha20_header_protector_decrypt(gquic_str_t *const header,
+                                                   u_int8_t *const first_byte,
+                                                   void *const self) {
+    return gquic_chacha20_header_protector_encrypt(header, first_byte, self);
+}
+
+static int gquic_chacha20_header_protector_apply_batch(gquic_str_t *const headers,
+                                                       u_int8_t *const *const first_bytes,
+                                                       void *const self,
+                                                       const gquic_str_t *const samples,
+                                                       const size_t count) {
+    size_t i;
+    if (headers == NULL || first_bytes == NULL || self == NULL || samples == NULL) {
+        return -1;
+    }
+    // every sample is its own counter and nonce, so there is nothing to share between packets
+    for (i = 0; i < count; i++) {
+        if (gquic_chacha20_header_protector_set_key(self, (gquic_str_t *) &samples[i]) != 0) {
+            return -2;
+        }
+        if (gquic_chacha20_header_protector_encrypt(&headers[i], first_bytes[i], self) != 0) {
+            return -3;
+        }
+    }
+    return 0;
+}
+
+static int gquic_chacha20_header_protector_dtor(void *const protector) {
+    if (protector == NULL) {
+        return -1;
+    }
+    if (((gquic_chacha20_header_protector_t *) protector)->ctx != NULL) {
+        EVP_CIPHER_CTX_free(((gquic_chacha20_header_protector_t *) protector)->ctx);
+        ((gquic_chacha20_header_protector_t *) protector)->ctx = NULL;
+    }
+    return 0;
+}
+
+/*
+ * mask[0] protects the low bits of the first byte, mask[1..4] the packet
+ * number bytes (RFC 9001, 5.4.1).
+ */
+static int gquic_header_protector_apply_mask(gquic_str_t *const header,
+                                             u_int8_t *const first_byte,
+                                             const u_int8_t *const mask,
+                                             const int is_long_header) {
+    size_t i;
+    if (mask == NULL || (header == NULL && first_byte == NULL)) {
+        return -1;
+    }
+    if (first_byte != NULL) {
+        if (is_long_header) {
+            *first_byte ^= mask[0] & 0x0f;
+        }
+        else {
+            *first_byte ^= mask[0] & 0x1f;
+        }
+    }
+    if (header != NULL) {
+        if (GQUIC_STR_SIZE(header) > 4) {
+            return -2;
+        }
+        for (i = 0; i < GQUIC_STR_SIZE(header); i++) {
+            ((u_int8_t *) GQUIC_STR_VAL(header))[i] ^= mask[1 + i];
+        }
+    }
+
     return 0;
 }
 
@@ -1,21 +1,79 @@
 #include "handshake/initial_aead.h"
 #include "tls/key_schedule.h"
 #include "tls/cipher_suite.h"
+#include <string.h>
+#include <pthread.h>
 
-static int gquic_handshake_generate_secs(gquic_str_t *const, gquic_str_t *const, const gquic_str_t *const);
+typedef struct gquic_handshake_initial_salt_s gquic_handshake_initial_salt_t;
+struct gquic_handshake_initial_salt_s {
+    gquic_version_t version;
+    u_int8_t salt[20];
+};
+
+static const gquic_handshake_initial_salt_t gquic_handshake_initial_salts[] = {
+    {
+        GQUIC_VERSION_DRAFT_27,
+        {
+            0xc3, 0xee, 0xf7, 0x12,
+            0xc7, 0x2e, 0xbb, 0x5a,
+            0x11, 0xa7, 0xd2, 0x43,
+            0x2b, 0xb4, 0x63, 0x65,
+            0xbe, 0xf9, 0xf5, 0x02
+        }
+    },
+    {
+        GQUIC_VERSION_1,
+        {
+            0x38, 0x76, 0x2c, 0xf7,
+            0xf5, 0x59, 0x34, 0xb3,
+            0x4d, 0x17, 0x9a, 0xe6,
+            0xa4, 0xc8, 0x0c, 0xad,
+            0xcc, 0xbb, 0x7f, 0x0a
+        }
+    }
+};
+
+typedef struct gquic_handshake_initial_cache_entry_s gquic_handshake_initial_cache_entry_t;
+struct gquic_handshake_initial_cache_entry_s {
+    int valid;
+    gquic_version_t version;
+    u_int8_t conn_id_len;
+    u_int8_t conn_id[GQUIC_HANDSHAKE_INITIAL_MAX_CONN_ID_LEN];
+    u_int64_t last_used;
+    gquic_handshake_initial_keys_t keys;
+};
+
+typedef struct gquic_handshake_initial_cache_set_s gquic_handshake_initial_cache_set_t;
+struct gquic_handshake_initial_cache_set_s {
+    pthread_mutex_t mtx;
+    u_int64_t tick;
+    gquic_handshake_initial_cache_entry_t ways[GQUIC_HANDSHAKE_INITIAL_CACHE_WAYS];
+};
+
+static gquic_handshake_initial_cache_set_t gquic_handshake_initial_cache[GQUIC_HANDSHAKE_INITIAL_CACHE_SETS];
+static pthread_once_t gquic_handshake_initial_cache_once = PTHREAD_ONCE_INIT;
+
+static const u_int8_t *gquic_handshake_initial_salt(const gquic_version_t);
+static void gquic_handshake_initial_cache_init();
+static gquic_handshake_initial_cache_set_t *gquic_handshake_initial_cache_set(const gquic_version_t, const gquic_str_t *const);
+static int gquic_handshake_initial_cache_lookup(gquic_handshake_initial_keys_t *const, const gquic_version_t, const gquic_str_t *const);
+static int gquic_handshake_initial_cache_insert(const gquic_handshake_initial_keys_t *const, const gquic_version_t, const gquic_str_t *const);
+static int gquic_handshake_initial_keys_derive(gquic_handshake_initial_keys_t *const, const u_int8_t *const, const gquic_str_t *const);
+static int gquic_handshake_generate_secs(gquic_str_t *const, gquic_str_t *const, const u_int8_t *const, const gquic_str_t *const);
 static int gquic_handshake_generate_key_iv(gquic_str_t *const, gquic_str_t *const, const gquic_str_t *const);
 
 int gquic_handshake_initial_aead_init(gquic_common_long_header_sealer_t *const sealer,
                                       gquic_common_long_header_opener_t *const opener,
+                                      const gquic_version_t version,
                                       const gquic_str_t *const conn_id,
                                       int is_client) {
-    int ret = 0;
-    gquic_str_t cli_sec = { 0, NULL };
-    gquic_str_t ser_sec = { 0, NULL };
-    gquic_str_t cli_key = { 0, NULL };
-    gquic_str_t cli_iv = { 0, NULL };
-    gquic_str_t ser_key = { 0, NULL };
-    gquic_str_t ser_iv = { 0, NULL };
+    gquic_handshake_initial_keys_t keys;
+    gquic_str_t cli_key = { sizeof(keys.cli_key), keys.cli_key };
+    gquic_str_t cli_iv = { sizeof(keys.cli_iv), keys.cli_iv };
+    gquic_str_t cli_hp_key = { sizeof(keys.cli_hp_key), keys.cli_hp_key };
+    gquic_str_t ser_key = { sizeof(keys.ser_key), keys.ser_key };
+    gquic_str_t ser_iv = { sizeof(keys.ser_iv), keys.ser_iv };
+    gquic_str_t ser_hp_key = { sizeof(keys.ser_hp_key), keys.ser_hp_key };
     const gquic_tls_cipher_suite_t *suite = NULL;
     if (sealer == NULL || opener == NULL || conn_id == NULL) {
         return -1;
@@ -25,72 +83,214 @@ int gquic_handshake_initial_aead_init(gquic_common_long_header_sealer_t *const s
     }
     gquic_common_long_header_sealer_init(sealer);
     gquic_common_long_header_opener_init(opener);
-    if (gquic_handshake_generate_secs(&cli_sec, &ser_sec, conn_id) != 0) {
+    if (gquic_handshake_initial_keys_get(&keys, version, conn_id) != 0) {
         return -3;
     }
-    if (gquic_handshake_generate_key_iv(&cli_key, &cli_iv, &cli_sec) != 0) {
-        ret = -4;
-        goto failure;
-    }
-    if (gquic_handshake_generate_key_iv(&ser_key, &ser_iv, &ser_sec) != 0) {
-        ret = -5;
-        goto failure;
-    }
     if (is_client) {
-        if (gquic_common_long_header_sealer_long_header_ctor(sealer, suite, &cli_key, &cli_iv, suite, &cli_sec) != 0) {
-            ret = -6;
-            goto failure;
+        if (gquic_common_long_header_sealer_long_header_key_ctor(sealer, suite, &cli_key, &cli_iv, &cli_hp_key) != 0) {
+            return -6;
         }
-        if (gquic_common_long_header_opener_long_header_ctor(opener, suite, &ser_key, &ser_iv, suite, &ser_sec) != 0) {
-            ret = -7;
-            goto failure;
+        if (gquic_common_long_header_opener_long_header_key_ctor(opener, suite, &ser_key, &ser_iv, &ser_hp_key) != 0) {
+            return -7;
         }
     }
     else {
-        if (gquic_common_long_header_sealer_long_header_ctor(sealer, suite, &ser_key, &ser_iv, suite, &ser_sec) != 0) {
-            ret = -7;
-            goto failure;
+        if (gquic_common_long_header_sealer_long_header_key_ctor(sealer, suite, &ser_key, &ser_iv, &ser_hp_key) != 0) {
+            return -7;
         }
-        if (gquic_common_long_header_opener_long_header_ctor(opener, suite, &cli_key, &cli_iv, suite, &cli_sec) != 0) {
-            ret = -6;
-            goto failure;
+        if (gquic_common_long_header_opener_long_header_key_ctor(opener, suite, &cli_key, &cli_iv, &cli_hp_key) != 0) {
+            return -6;
         }
     }
 
-    gquic_str_reset(&cli_sec);
-    gquic_str_reset(&ser_sec);
-    gquic_str_reset(&cli_key);
-    gquic_str_reset(&cli_iv);
-    gquic_str_reset(&ser_key);
-    gquic_str_reset(&ser_iv);
     return 0;
+}
 
-failure:
+int gquic_handshake_initial_keys_get(gquic_handshake_initial_keys_t *const keys,
+                                     const gquic_version_t version,
+                                     const gquic_str_t *const conn_id) {
+    const u_int8_t *salt = NULL;
+    if (keys == NULL || conn_id == NULL) {
+        return -1;
+    }
+    if ((salt = gquic_handshake_initial_salt(version)) == NULL) {
+        return -2;
+    }
+    if (gquic_handshake_initial_cache_lookup(keys, version, conn_id) == 0) {
+        return 0;
+    }
+    if (gquic_handshake_initial_keys_derive(keys, salt, conn_id) != 0) {
+        return -3;
+    }
+    gquic_handshake_initial_cache_insert(keys, version, conn_id);
+    return 0;
+}
+
+static const u_int8_t *gquic_handshake_initial_salt(const gquic_version_t version) {
+    size_t i;
+    for (i = 0; i < sizeof(gquic_handshake_initial_salts) / sizeof(gquic_handshake_initial_salt_t); i++) {
+        if (gquic_handshake_initial_salts[i].version == version) {
+            return gquic_handshake_initial_salts[i].salt;
+        }
+    }
+    return NULL;
+}
+
+static void gquic_handshake_initial_cache_init() {
+    int i;
+    for (i = 0; i < GQUIC_HANDSHAKE_INITIAL_CACHE_SETS; i++) {
+        pthread_mutex_init(&gquic_handshake_initial_cache[i].mtx, NULL);
+    }
+}
+
+static gquic_handshake_initial_cache_set_t *gquic_handshake_initial_cache_set(const gquic_version_t version,
+                                                                               const gquic_str_t *const conn_id) {
+    // FNV-1a over the version and the connection id
+    u_int32_t hash = 2166136261u;
+    size_t i;
+    pthread_once(&gquic_handshake_initial_cache_once, gquic_handshake_initial_cache_init);
+    for (i = 0; i < sizeof(version); i++) {
+        hash = (hash ^ ((version >> (8 * i)) & 0xff)) * 16777619u;
+    }
+    for (i = 0; i < GQUIC_STR_SIZE(conn_id); i++) {
+        hash = (hash ^ ((u_int8_t *) GQUIC_STR_VAL(conn_id))[i]) * 16777619u;
+    }
+    return &gquic_handshake_initial_cache[hash % GQUIC_HANDSHAKE_INITIAL_CACHE_SETS];
+}
+
+static int gquic_handshake_initial_cache_lookup(gquic_handshake_initial_keys_t *const keys,
+                                                const gquic_version_t version,
+                                                const gquic_str_t *const conn_id) {
+    gquic_handshake_initial_cache_set_t *set = NULL;
+    gquic_handshake_initial_cache_entry_t *entry = NULL;
+    int i;
+    if (GQUIC_STR_SIZE(conn_id) > GQUIC_HANDSHAKE_INITIAL_MAX_CONN_ID_LEN) {
+        return -1;
+    }
+    set = gquic_handshake_initial_cache_set(version, conn_id);
+    pthread_mutex_lock(&set->mtx);
+    for (i = 0; i < GQUIC_HANDSHAKE_INITIAL_CACHE_WAYS; i++) {
+        entry = &set->ways[i];
+        if (entry->valid
+            && entry->version == version
+            && entry->conn_id_len == GQUIC_STR_SIZE(conn_id)
+            && memcmp(entry->conn_id, GQUIC_STR_VAL(conn_id), entry->conn_id_len) == 0) {
+            break;
+        }
+    }
+    if (i == GQUIC_HANDSHAKE_INITIAL_CACHE_WAYS) {
+        pthread_mutex_unlock(&set->mtx);
+        return -2;
+    }
+    memcpy(keys, &entry->keys, sizeof(gquic_handshake_initial_keys_t));
+    entry->last_used = ++set->tick;
+    pthread_mutex_unlock(&set->mtx);
+    return 0;
+}
+
+static int gquic_handshake_initial_cache_insert(const gquic_handshake_initial_keys_t *const keys,
+                                                const gquic_version_t version,
+                                                const gquic_str_t *const conn_id) {
+    gquic_handshake_initial_cache_set_t *set = NULL;
+    gquic_handshake_initial_cache_entry_t *victim = NULL;
+    int i;
+    if (GQUIC_STR_SIZE(conn_id) > GQUIC_HANDSHAKE_INITIAL_MAX_CONN_ID_LEN) {
+        return -1;
+    }
+    set = gquic_handshake_initial_cache_set(version, conn_id);
+    pthread_mutex_lock(&set->mtx);
+
+    // take a free way or the one another thread filled for the same key meanwhile, else evict the least recently used
+    victim = &set->ways[0];
+    for (i = 0; i < GQUIC_HANDSHAKE_INITIAL_CACHE_WAYS; i++) {
+        if (!set->ways[i].valid
+            || (set->ways[i].version == version
+                && set->ways[i].conn_id_len == GQUIC_STR_SIZE(conn_id)
+                && memcmp(set->ways[i].conn_id, GQUIC_STR_VAL(conn_id), set->ways[i].conn_id_len) == 0)) {
+            victim = &set->ways[i];
+            break;
+        }
+        if (set->ways[i].last_used < victim->last_used) {
+            victim = &set->ways[i];
+        }
+    }
+    victim->valid = 1;
+    victim->version = version;
+    victim->conn_id_len = GQUIC_STR_SIZE(conn_id);
+    memcpy(victim->conn_id, GQUIC_STR_VAL(conn_id), victim->conn_id_len);
+    memcpy(&victim->keys, keys, sizeof(gquic_handshake_initial_keys_t));
+    victim->last_used = ++set->tick;
+
+    pthread_mutex_unlock(&set->mtx);
+    return 0;
+}
+
+static int gquic_handshake_initial_keys_derive(gquic_handshake_initial_keys_t *const keys,
+                                               const u_int8_t *const salt,
+                                               const gquic_str_t *const conn_id) {
+    int ret = 0;
+    gquic_str_t cli_sec = { 0, NULL };
+    gquic_str_t ser_sec = { 0, NULL };
+    gquic_str_t cli_key = { 0, NULL };
+    gquic_str_t cli_iv = { 0, NULL };
+    gquic_str_t cli_hp_key = { 0, NULL };
+    gquic_str_t ser_key = { 0, NULL };
+    gquic_str_t ser_iv = { 0, NULL };
+    gquic_str_t ser_hp_key = { 0, NULL };
+    const gquic_tls_cipher_suite_t *suite = NULL;
+    if (gquic_tls_get_cipher_suite(&suite, GQUIC_TLS_CIPHER_SUITE_AES_128_GCM_SHA256) != 0) {
+        return -1;
+    }
+    if (gquic_handshake_generate_secs(&cli_sec, &ser_sec, salt, conn_id) != 0) {
+        return -2;
+    }
+    if (gquic_handshake_generate_key_iv(&cli_key, &cli_iv, &cli_sec) != 0) {
+        ret = -3;
+        goto finished;
+    }
+    if (gquic_handshake_generate_key_iv(&ser_key, &ser_iv, &ser_sec) != 0) {
+        ret = -4;
+        goto finished;
+    }
+    if (gquic_header_protector_derive_key(&cli_hp_key, suite, &cli_sec) != 0) {
+        ret = -5;
+        goto finished;
+    }
+    if (gquic_header_protector_derive_key(&ser_hp_key, suite, &ser_sec) != 0) {
+        ret = -6;
+        goto finished;
+    }
+    memcpy(keys->cli_key, GQUIC_STR_VAL(&cli_key), sizeof(keys->cli_key));
+    memcpy(keys->cli_iv, GQUIC_STR_VAL(&cli_iv), sizeof(keys->cli_iv));
+    memcpy(keys->cli_hp_key, GQUIC_STR_VAL(&cli_hp_key), sizeof(keys->cli_hp_key));
+    memcpy(keys->ser_key, GQUIC_STR_VAL(&ser_key), sizeof(keys->ser_key));
+    memcpy(keys->ser_iv, GQUIC_STR_VAL(&ser_iv), sizeof(keys->ser_iv));
+    memcpy(keys->ser_hp_key, GQUIC_STR_VAL(&ser_hp_key), sizeof(keys->ser_hp_key));
+
+finished:
     gquic_str_reset(&cli_sec);
     gquic_str_reset(&ser_sec);
     gquic_str_reset(&cli_key);
     gquic_str_reset(&cli_iv);
+    gquic_str_reset(&cli_hp_key);
     gquic_str_reset(&ser_key);
     gquic_str_reset(&ser_iv);
+    gquic_str_reset(&ser_hp_key);
     return ret;
 }
 
-static int gquic_handshake_generate_secs(gquic_str_t *const cli_sec, gquic_str_t *const ser_sec, const gquic_str_t *const conn_id) {
-    static const u_int8_t salt_cnt[] = {
-        0xc3, 0xee, 0xf7, 0x12,
-        0xc7, 0x2e, 0xbb, 0x5a,
-        0x11, 0xa7, 0xd2, 0x43,
-        0x2b, 0xb4, 0x63, 0x65,
-        0xbe, 0xf9, 0xf5, 0x02
-    };
-    static const gquic_str_t salt = { sizeof(salt_cnt), (void *) salt_cnt };
+static int gquic_handshake_generate_secs(gquic_str_t *const cli_sec,
+                                         gquic_str_t *const ser_sec,
+                                         const u_int8_t *const salt_cnt,
+                                         const gquic_str_t *const conn_id) {
     static const gquic_str_t cli_sec_label = { 9, "client in" };
     static const gquic_str_t ser_sec_label = { 9, "server in" };
+    const gquic_str_t salt = { 20, (void *) salt_cnt };
     int ret = 0;
     gquic_str_t initial_sec = { 0, NULL };
     const gquic_tls_cipher_suite_t *suite = NULL;
     gquic_tls_mac_t hash;
-    if (cli_sec == NULL || ser_sec == NULL || conn_id == NULL) {
+    if (cli_sec == NULL || ser_sec == NULL || salt_cnt == NULL || conn_id == NULL) {
         return -1;
     }
     gquic_str_init(cli_sec);
@@ -114,7 +314,7 @@ static int gquic_handshake_generate_secs(gquic_str_t *const cli_sec, gquic_str_t
         ret = -6;
         goto failure;
     }
-    
+
     gquic_str_reset(&initial_sec);
     gquic_tls_mac_dtor(&hash);
     return 0;
@@ -144,7 +344,7 @@ static int gquic_handshake_generate_key_iv(gquic_str_t *const key, gquic_str_t *
         gquic_tls_mac_dtor(&hash);
         return -4;
     }
-    if (gquic_tls_hkdf_expand_label(iv, &hash, sec, NULL, &iv_label, 16) != 0) {
+    if (gquic_tls_hkdf_expand_label(iv, &hash, sec, NULL, &iv_label, 12) != 0) {
         gquic_tls_mac_dtor(&hash);
         return -5;
     }
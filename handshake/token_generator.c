@@ -0,0 +1,267 @@
+#include "handshake/token_generator.h"
+#include "util/big_endian.h"
+#include <openssl/crypto.h>
+#include <openssl/rand.h>
+#include <string.h>
+
+#define GQUIC_HANDSHAKE_TOKEN_NONCE_SIZE 12
+#define GQUIC_HANDSHAKE_TOKEN_TAG_SIZE 16
+#define GQUIC_HANDSHAKE_TOKEN_MAX_PLAIN_SIZE (1 + 8 + 1 + 16 + 1 + 20)
+
+static int gquic_handshake_token_generator_seal(gquic_str_t *const,
+                                                gquic_handshake_token_generator_t *const,
+                                                const gquic_net_addr_t *const,
+                                                const int,
+                                                const gquic_str_t *const,
+                                                const u_int64_t);
+static int gquic_handshake_token_generator_addr_ip(gquic_str_t *const, const gquic_net_addr_t *const);
+
+int gquic_handshake_token_init(gquic_handshake_token_t *const token) {
+    if (token == NULL) {
+        return -1;
+    }
+    token->is_retry = 0;
+    token->sent_time = 0;
+    gquic_str_init(&token->odcid);
+    return 0;
+}
+
+int gquic_handshake_token_dtor(gquic_handshake_token_t *const token) {
+    if (token == NULL) {
+        return -1;
+    }
+    gquic_str_reset(&token->odcid);
+    return 0;
+}
+
+int gquic_handshake_token_generator_init(gquic_handshake_token_generator_t *const gen) {
+    if (gen == NULL) {
+        return -1;
+    }
+    gen->enc = NULL;
+    gen->dec = NULL;
+    return 0;
+}
+
+int gquic_handshake_token_generator_ctor(gquic_handshake_token_generator_t *const gen, const u_int8_t *const secret) {
+    u_int8_t key[GQUIC_HANDSHAKE_TOKEN_SECRET_SIZE];
+    int ret = 0;
+    if (gen == NULL) {
+        return -1;
+    }
+    // without a shared secret tokens are only good for this process
+    if (secret != NULL) {
+        memcpy(key, secret, sizeof(key));
+    }
+    else if (RAND_bytes(key, sizeof(key)) <= 0) {
+        return -2;
+    }
+    if ((gen->enc = EVP_CIPHER_CTX_new()) == NULL || (gen->dec = EVP_CIPHER_CTX_new()) == NULL) {
+        ret = -3;
+        goto failure;
+    }
+    if (EVP_EncryptInit_ex(gen->enc, EVP_aes_128_gcm(), NULL, key, NULL) <= 0) {
+        ret = -4;
+        goto failure;
+    }
+    if (EVP_DecryptInit_ex(gen->dec, EVP_aes_128_gcm(), NULL, key, NULL) <= 0) {
+        ret = -5;
+        goto failure;
+    }
+    OPENSSL_cleanse(key, sizeof(key));
+    return 0;
+failure:
+    OPENSSL_cleanse(key, sizeof(key));
+    gquic_handshake_token_generator_dtor(gen);
+    return ret;
+}
+
+int gquic_handshake_token_generator_dtor(gquic_handshake_token_generator_t *const gen) {
+    if (gen == NULL) {
+        return -1;
+    }
+    if (gen->enc != NULL) {
+        EVP_CIPHER_CTX_free(gen->enc);
+    }
+    if (gen->dec != NULL) {
+        EVP_CIPHER_CTX_free(gen->dec);
+    }
+    gen->enc = NULL;
+    gen->dec = NULL;
+    return 0;
+}
+
+int gquic_handshake_token_generator_new_token(gquic_str_t *const token,
+                                              gquic_handshake_token_generator_t *const gen,
+                                              const gquic_net_addr_t *const addr,
+                                              const u_int64_t now) {
+    if (token == NULL || gen == NULL || addr == NULL) {
+        return -1;
+    }
+    return gquic_handshake_token_generator_seal(token, gen, addr, 0, NULL, now);
+}
+
+int gquic_handshake_token_generator_new_retry_token(gquic_str_t *const token,
+                                                    gquic_handshake_token_generator_t *const gen,
+                                                    const gquic_net_addr_t *const addr,
+                                                    const gquic_str_t *const odcid,
+                                                    const u_int64_t now) {
+    if (token == NULL || gen == NULL || addr == NULL || odcid == NULL) {
+        return -1;
+    }
+    if (GQUIC_STR_SIZE(odcid) > 20) {
+        return -2;
+    }
+    return gquic_handshake_token_generator_seal(token, gen, addr, 1, odcid, now);
+}
+
+int gquic_handshake_token_generator_validate(gquic_handshake_token_t *const info,
+                                             gquic_handshake_token_generator_t *const gen,
+                                             const gquic_str_t *const token,
+                                             const gquic_net_addr_t *const addr,
+                                             const u_int64_t now) {
+    u_int8_t plain[GQUIC_HANDSHAKE_TOKEN_MAX_PLAIN_SIZE];
+    u_int8_t *p = plain;
+    size_t plain_size = 0;
+    gquic_str_t ip = { 0, NULL };
+    EVP_CIPHER_CTX *dec = NULL;
+    int size = 0;
+    int ret = GQUIC_HANDSHAKE_TOKEN_VALID;
+    if (info == NULL || gen == NULL || token == NULL || addr == NULL) {
+        return -1;
+    }
+    if (gen->dec == NULL) {
+        return -4;
+    }
+    if (GQUIC_STR_SIZE(token) < GQUIC_HANDSHAKE_TOKEN_NONCE_SIZE + 1 + 8 + 1 + 1 + GQUIC_HANDSHAKE_TOKEN_TAG_SIZE
+        || GQUIC_STR_SIZE(token) > GQUIC_HANDSHAKE_TOKEN_NONCE_SIZE + sizeof(plain) + GQUIC_HANDSHAKE_TOKEN_TAG_SIZE) {
+        return GQUIC_HANDSHAKE_TOKEN_INVALID;
+    }
+    plain_size = GQUIC_STR_SIZE(token) - GQUIC_HANDSHAKE_TOKEN_NONCE_SIZE - GQUIC_HANDSHAKE_TOKEN_TAG_SIZE;
+
+    if ((dec = EVP_CIPHER_CTX_new()) == NULL || EVP_CIPHER_CTX_copy(dec, gen->dec) <= 0) {
+        ret = -5;
+        goto finished;
+    }
+    // a token that fails to open was forged, damaged or sealed under another key
+    if (EVP_DecryptInit_ex(dec, NULL, NULL, NULL, GQUIC_STR_VAL(token)) <= 0
+        || EVP_DecryptUpdate(dec, plain, &size, GQUIC_STR_VAL(token) + GQUIC_HANDSHAKE_TOKEN_NONCE_SIZE, plain_size) <= 0
+        || EVP_CIPHER_CTX_ctrl(dec, EVP_CTRL_GCM_SET_TAG, GQUIC_HANDSHAKE_TOKEN_TAG_SIZE,
+                               GQUIC_STR_VAL(token) + GQUIC_STR_SIZE(token) - GQUIC_HANDSHAKE_TOKEN_TAG_SIZE) <= 0
+        || EVP_DecryptFinal_ex(dec, plain + size, &size) <= 0) {
+        ret = GQUIC_HANDSHAKE_TOKEN_INVALID;
+        goto finished;
+    }
+
+    info->is_retry = *p++;
+    gquic_big_endian_transfer(&info->sent_time, p, 8);
+    p += 8;
+    gquic_handshake_token_generator_addr_ip(&ip, addr);
+    if (*p != GQUIC_STR_SIZE(&ip) || p + 1 + *p + 1 > plain + plain_size || memcmp(p + 1, GQUIC_STR_VAL(&ip), *p) != 0) {
+        ret = GQUIC_HANDSHAKE_TOKEN_INVALID;
+        goto finished;
+    }
+    p += 1 + *p;
+    if (p + 1 + *p != plain + plain_size) {
+        ret = GQUIC_HANDSHAKE_TOKEN_INVALID;
+        goto finished;
+    }
+    gquic_str_reset(&info->odcid);
+    if (*p != 0) {
+        if (gquic_str_alloc(&info->odcid, *p) != 0) {
+            ret = -6;
+            goto finished;
+        }
+        memcpy(GQUIC_STR_VAL(&info->odcid), p + 1, *p);
+    }
+
+    if (info->sent_time > now + 1000 * 1000
+        || now - info->sent_time > (info->is_retry ? GQUIC_HANDSHAKE_TOKEN_RETRY_LIFETIME : GQUIC_HANDSHAKE_TOKEN_NEW_TOKEN_LIFETIME)) {
+        ret = GQUIC_HANDSHAKE_TOKEN_EXPIRED;
+    }
+finished:
+    if (dec != NULL) {
+        EVP_CIPHER_CTX_free(dec);
+    }
+    return ret;
+}
+
+static int gquic_handshake_token_generator_seal(gquic_str_t *const token,
+                                                gquic_handshake_token_generator_t *const gen,
+                                                const gquic_net_addr_t *const addr,
+                                                const int is_retry,
+                                                const gquic_str_t *const odcid,
+                                                const u_int64_t now) {
+    u_int8_t plain[GQUIC_HANDSHAKE_TOKEN_MAX_PLAIN_SIZE];
+    u_int8_t *p = plain;
+    gquic_str_t ip = { 0, NULL };
+    EVP_CIPHER_CTX *enc = NULL;
+    int size = 0;
+    int ret = 0;
+    if (gen->enc == NULL) {
+        return -3;
+    }
+
+    *p++ = is_retry;
+    gquic_big_endian_transfer(p, &now, 8);
+    p += 8;
+    gquic_handshake_token_generator_addr_ip(&ip, addr);
+    *p++ = GQUIC_STR_SIZE(&ip);
+    memcpy(p, GQUIC_STR_VAL(&ip), GQUIC_STR_SIZE(&ip));
+    p += GQUIC_STR_SIZE(&ip);
+    *p++ = GQUIC_STR_SIZE(odcid);
+    if (GQUIC_STR_SIZE(odcid) != 0) {
+        memcpy(p, GQUIC_STR_VAL(odcid), GQUIC_STR_SIZE(odcid));
+        p += GQUIC_STR_SIZE(odcid);
+    }
+
+    if (gquic_str_alloc(token, GQUIC_HANDSHAKE_TOKEN_NONCE_SIZE + (p - plain) + GQUIC_HANDSHAKE_TOKEN_TAG_SIZE) != 0) {
+        return -4;
+    }
+    // the nonce is random, 96 bits leave no practical chance of a repeat under one key
+    if (RAND_bytes(GQUIC_STR_VAL(token), GQUIC_HANDSHAKE_TOKEN_NONCE_SIZE) <= 0) {
+        ret = -5;
+        goto failure;
+    }
+    if ((enc = EVP_CIPHER_CTX_new()) == NULL || EVP_CIPHER_CTX_copy(enc, gen->enc) <= 0) {
+        ret = -6;
+        goto failure;
+    }
+    if (EVP_EncryptInit_ex(enc, NULL, NULL, NULL, GQUIC_STR_VAL(token)) <= 0
+        || EVP_EncryptUpdate(enc, GQUIC_STR_VAL(token) + GQUIC_HANDSHAKE_TOKEN_NONCE_SIZE, &size, plain, p - plain) <= 0
+        || EVP_EncryptFinal_ex(enc, GQUIC_STR_VAL(token) + GQUIC_HANDSHAKE_TOKEN_NONCE_SIZE + size, &size) <= 0) {
+        ret = -7;
+        goto failure;
+    }
+    if (EVP_CIPHER_CTX_ctrl(enc, EVP_CTRL_GCM_GET_TAG, GQUIC_HANDSHAKE_TOKEN_TAG_SIZE,
+                            GQUIC_STR_VAL(token) + GQUIC_STR_SIZE(token) - GQUIC_HANDSHAKE_TOKEN_TAG_SIZE) <= 0) {
+        ret = -8;
+        goto failure;
+    }
+    EVP_CIPHER_CTX_free(enc);
+    return 0;
+failure:
+    if (enc != NULL) {
+        EVP_CIPHER_CTX_free(enc);
+    }
+    gquic_str_reset(token);
+    return ret;
+}
+
+static int gquic_handshake_token_generator_addr_ip(gquic_str_t *const ip, const gquic_net_addr_t *const addr) {
+    // only the ip is bound, a NAT rebinding the port keeps the token valid
+    switch (addr->type) {
+    case AF_INET:
+        ip->size = sizeof(addr->addr.v4.sin_addr);
+        ip->val = (void *) &addr->addr.v4.sin_addr;
+        break;
+    case AF_INET6:
+        ip->size = sizeof(addr->addr.v6.sin6_addr);
+        ip->val = (void *) &addr->addr.v6.sin6_addr;
+        break;
+    default:
+        ip->size = 0;
+        ip->val = NULL;
+    }
+    return 0;
+}
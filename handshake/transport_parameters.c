@@ -25,6 +25,7 @@ int gquic_transport_parameters_init(gquic_transport_parameters_t *const params)
     params->max_ack_delay = 25 * 1000;
     params->disable_migration = 1;
     params->active_conn_id_limit = 0;
+    params->min_ack_delay = 0;
 
     return 0;
 }
@@ -34,6 +35,8 @@ size_t gquic_transport_parameters_size(const gquic_transport_parameters_t *const
     if (params == NULL) {
         return 0;
     }
+    // the length prefix of the parameter list
+    ret += 2;
     ret += 2 + 2 + gquic_varint_size(&params->init_max_data);
     ret += 2 + 2 + gquic_varint_size(&params->init_max_stream_data_uni);
     ret += 2 + 2 + gquic_varint_size(&params->init_max_stream_data_bidi_local);
@@ -60,6 +63,9 @@ size_t gquic_transport_parameters_size(const gquic_transport_parameters_t *const
         ret += 2 + 2 + GQUIC_STR_SIZE(&params->original_conn_id);
     }
     ret += 2 + 2 + gquic_varint_size(&params->active_conn_id_limit);
+    if (params->min_ack_delay != 0) {
+        ret += 2 + 2 + gquic_varint_size(&params->min_ack_delay);
+    }
     return ret;
 }
 
@@ -110,6 +116,10 @@ int gquic_transport_parameters_serialize(const gquic_transport_parameters_t *con
     }
     __serialize_var(writer, &prefix_len_stack,
                     GQUIC_TRANSPORT_PARAM_ACTIVE_CONN_ID_LIMIT, params->active_conn_id_limit);
+    if (params->min_ack_delay != 0) {
+        __serialize_var(writer, &prefix_len_stack,
+                        GQUIC_TRANSPORT_PARAM_MIN_ACK_DELAY, params->min_ack_delay);
+    }
 
     __gquic_fill_prefix_len(&prefix_len_stack, writer);
     return 0;
@@ -142,6 +152,13 @@ int gquic_transport_parameters_deserialize(gquic_transport_parameters_t *const p
             if (gquic_varint_deserialize(&params->max_ack_delay, &inner_reader) != 0) {
                 return -3;
             }
+            // sent in milliseconds
+            params->max_ack_delay *= 1000;
+            break;
+        case GQUIC_TRANSPORT_PARAM_MIN_ACK_DELAY:
+            if (gquic_varint_deserialize(&params->min_ack_delay, &inner_reader) != 0) {
+                return -3;
+            }
             break;
         case GQUIC_TRANSPORT_PARAM_INITIAL_MAX_DATA:
             if (gquic_varint_deserialize(&params->init_max_data, &inner_reader) != 0) {
@@ -207,6 +224,10 @@ int gquic_transport_parameters_deserialize(gquic_transport_parameters_t *const p
                 return -7;
             }
             break;
+        default:
+            if (gquic_reader_str_readed_size(&inner_reader, param_len) != 0) {
+                return -8;
+            }
         }
     }
 
@@ -5,6 +5,10 @@
 #include "util/list.h"
 #include "util/str.h"
 #include "tls/config.h"
+#include "handshake/token_generator.h"
+#include "token_store.h"
+#include "packet/retry_policy.h"
+#include "cong/cong.h"
 
 typedef struct gquic_config_s gquic_config_t;
 struct gquic_config_s {
@@ -18,6 +22,26 @@ struct gquic_config_s {
     u_int64_t max_incoming_streams;
     gquic_str_t stateless_reset_key;
     int keep_alive;
+    u_int64_t key_update_packets;
+    u_int64_t key_update_bytes;
+    // server: issues NEW_TOKEN tokens and validates the ones clients bring back
+    gquic_handshake_token_generator_t *token_generator;
+    // client: keeps NEW_TOKEN tokens for the next connection to the same server
+    gquic_token_store_t *token_store;
+    // server: counts this server's half-open sessions towards its Retry decision
+    gquic_packet_retry_policy_t *retry_policy;
+    // GQUIC_CONG_CUBIC or GQUIC_CONG_BBR2
+    int cong_algo;
+    // bytes, 0 for 10000 full sized packets; a 10 Gbit/s path at 100 ms needs about 125 MB
+    u_int64_t max_cwnd;
+    // datagrams the pacer lets out back to back, 0 for the default of 10
+    u_int64_t pacing_burst_packets;
+    // datagrams per GSO send, the pacer releases whole batches; 0 or 1 without GSO
+    u_int64_t gso_segments;
+    // hand the pacing schedule to the fq qdisc with SO_TXTIME, paces in user space where the socket lacks it
+    int txtime;
+    // mark 1-RTT packets ECT(0) and react to CE, stops by itself on paths that mangle the ECN field
+    int ecn;
 
     gquic_tls_config_t tls_config;
 };
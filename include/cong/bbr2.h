@@ -0,0 +1,94 @@
+#ifndef _LIBGQUIC_CONG_BBR2_H
+#define _LIBGQUIC_CONG_BBR2_H
+
+#include "util/rtt.h"
+#include "packet/rate_sampler.h"
+#include <sys/types.h>
+
+/*
+ * BBRv2. the path is modelled by its bottleneck bandwidth (max_bw, the max
+ * delivery rate seen over the last two probe cycles) and its min rtt, and the sender
+ * paces at about max_bw and keeps about one BDP in flight. unlike v1, loss
+ * above 2% in a round bounds the model: inflight_hi caps what probing may
+ * put in flight, bw_lo and inflight_lo shrink while not probing. random
+ * loss below the threshold leaves the sending rate alone. CE marks on more
+ * than half of what a round delivered bound it the same way.
+ *
+ * max_bw is fed the best delivery rate sample of each round, app limited
+ * samples only when they are above it.
+ */
+#define GQUIC_CONG_BBR2_STARTUP 0
+#define GQUIC_CONG_BBR2_DRAIN 1
+#define GQUIC_CONG_BBR2_PROBE_BW_DOWN 2
+#define GQUIC_CONG_BBR2_PROBE_BW_CRUISE 3
+#define GQUIC_CONG_BBR2_PROBE_BW_REFILL 4
+#define GQUIC_CONG_BBR2_PROBE_BW_UP 5
+#define GQUIC_CONG_BBR2_PROBE_RTT 6
+
+#define GQUIC_CONG_BBR2_MIN_RTT_WINDOW (10 * 1000 * 1000)
+#define GQUIC_CONG_BBR2_PROBE_RTT_INTERVAL (5 * 1000 * 1000)
+#define GQUIC_CONG_BBR2_PROBE_RTT_DURATION (200 * 1000)
+
+typedef struct gquic_cong_bbr2_s gquic_cong_bbr2_t;
+struct gquic_cong_bbr2_s {
+    const gquic_rtt_t *rtt;
+    u_int8_t state;
+    double pacing_gain;
+    double cwnd_gain;
+
+    // a round ends with the ack of the first packet sent after it began
+    u_int64_t round_count;
+    u_int64_t round_start_time;
+    u_int64_t round_delivered;
+    u_int64_t round_lost;
+    u_int64_t round_ce;
+    u_int64_t round_max_infly;
+    int round_app_limited;
+    u_int64_t round_bw;
+    u_int64_t delivered;
+
+    // max delivery rate of this probe cycle and of the previous one
+    u_int64_t max_bw_filter[2];
+    u_int64_t max_bw;
+    u_int64_t bw_lo;
+    u_int64_t inflight_lo;
+    u_int64_t inflight_hi;
+
+    u_int64_t min_rtt;
+    u_int64_t min_rtt_stamp;
+    u_int64_t probe_rtt_done_stamp;
+    u_int64_t probe_rtt_round;
+    u_int64_t prior_cwnd;
+
+    u_int64_t full_bw;
+    int full_bw_count;
+    int full_bw_reached;
+
+    u_int64_t cycle_count;
+    u_int64_t cycle_stamp;
+    u_int64_t probe_wait;
+    u_int64_t cycle_round;
+
+    u_int64_t cwnd;
+    u_int64_t initial_cwnd;
+    u_int64_t min_cwnd;
+    u_int64_t max_cwnd;
+    u_int64_t pacing_rate;
+};
+
+int gquic_cong_bbr2_init(gquic_cong_bbr2_t *const bbr);
+int gquic_cong_bbr2_ctor(gquic_cong_bbr2_t *const bbr, const gquic_rtt_t *const rtt, const u_int64_t initial_cwnd, const u_int64_t max_cwnd);
+int gquic_cong_bbr2_on_packet_sent(gquic_cong_bbr2_t *const bbr, const u_int64_t bytes, const u_int64_t infly);
+int gquic_cong_bbr2_on_packet_acked(gquic_cong_bbr2_t *const bbr,
+                                    const u_int64_t bytes,
+                                    const u_int64_t infly,
+                                    const u_int64_t sent_time,
+                                    const u_int64_t now);
+int gquic_cong_bbr2_on_packet_lost(gquic_cong_bbr2_t *const bbr, const u_int64_t bytes);
+int gquic_cong_bbr2_on_spurious_loss(gquic_cong_bbr2_t *const bbr, const u_int64_t bytes);
+int gquic_cong_bbr2_on_ecn_ce(gquic_cong_bbr2_t *const bbr, const u_int64_t ce_packets);
+int gquic_cong_bbr2_on_rate_sample(gquic_cong_bbr2_t *const bbr, const gquic_packet_rate_sample_t *const sample);
+u_int64_t gquic_cong_bbr2_time_until_send(gquic_cong_bbr2_t *const bbr);
+u_int64_t gquic_cong_bbr2_bdp(const gquic_cong_bbr2_t *const bbr, const double gain);
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef _LIBGQUIC_CONG_CONG_H
+#define _LIBGQUIC_CONG_CONG_H
+
+#include "util/rtt.h"
+#include "packet/rate_sampler.h"
+#include <sys/types.h>
+
+/*
+ * congestion controller interface used by the sent packet handler. a
+ * controller sees every packet sent, acked and lost, and answers how much
+ * may be in flight (cwnd), how fast to send it (pacing_rate, in bytes/s)
+ * and how long to wait after a packet (time_until_send, in us).
+ * on_rate_sample hands it the delivery rate measured by each ack, before
+ * the acked packets themselves are reported.
+ * on_app_limited tells it the sender ran out of data while the window was
+ * still open, so the current round says nothing about the path's capacity.
+ * on_spurious_loss reports a packet passed to on_packet_lost that was acked
+ * later, the controller may undo what that loss made it do.
+ * on_ecn_ce reports ce_packets newly CE marked packets, pn the largest one
+ * acked with them: the path signalled congestion without dropping anything.
+ */
+#define GQUIC_CONG_CUBIC 0
+#define GQUIC_CONG_BBR2 1
+
+typedef struct gquic_cong_s gquic_cong_t;
+struct gquic_cong_s {
+    void *self;
+    int (*on_packet_sent) (void *const self, const u_int64_t pn, const u_int64_t bytes, const u_int64_t infly, const int ack_eliciting);
+    int (*on_packet_acked) (void *const self,
+                            const u_int64_t pn,
+                            const u_int64_t bytes,
+                            const u_int64_t infly,
+                            const u_int64_t sent_time,
+                            const u_int64_t now);
+    int (*on_packet_lost) (void *const self, const u_int64_t pn, const u_int64_t bytes, const u_int64_t infly);
+    int (*on_spurious_loss) (void *const self, const u_int64_t pn, const u_int64_t bytes);
+    int (*on_ecn_ce) (void *const self, const u_int64_t pn, const u_int64_t ce_packets, const u_int64_t infly);
+    int (*on_rtt_updated) (void *const self);
+    int (*on_rate_sample) (void *const self, const gquic_packet_rate_sample_t *const sample);
+    int (*on_app_limited) (void *const self, const u_int64_t infly);
+    int (*can_send) (void *const self, const u_int64_t infly);
+    u_int64_t (*time_until_send) (void *const self, const u_int64_t infly);
+    u_int64_t (*pacing_rate) (void *const self);
+    u_int64_t (*cwnd) (void *const self);
+    int (*in_slow_start) (void *const self);
+    int (*in_recovery) (void *const self);
+    int (*dtor) (void *const self);
+};
+
+#define GQUIC_CONG_ON_PACKET_SENT(cong, pn, bytes, infly, ack_eliciting) \
+    ((cong)->on_packet_sent((cong)->self, (pn), (bytes), (infly), (ack_eliciting)))
+#define GQUIC_CONG_ON_PACKET_ACKED(cong, pn, bytes, infly, sent_time, now) \
+    ((cong)->on_packet_acked((cong)->self, (pn), (bytes), (infly), (sent_time), (now)))
+#define GQUIC_CONG_ON_PACKET_LOST(cong, pn, bytes, infly) ((cong)->on_packet_lost((cong)->self, (pn), (bytes), (infly)))
+#define GQUIC_CONG_ON_SPURIOUS_LOSS(cong, pn, bytes) ((cong)->on_spurious_loss((cong)->self, (pn), (bytes)))
+#define GQUIC_CONG_ON_ECN_CE(cong, pn, ce_packets, infly) ((cong)->on_ecn_ce((cong)->self, (pn), (ce_packets), (infly)))
+#define GQUIC_CONG_ON_RTT_UPDATED(cong) ((cong)->on_rtt_updated((cong)->self))
+#define GQUIC_CONG_ON_RATE_SAMPLE(cong, sample) ((cong)->on_rate_sample((cong)->self, (sample)))
+#define GQUIC_CONG_ON_APP_LIMITED(cong, infly) ((cong)->on_app_limited((cong)->self, (infly)))
+#define GQUIC_CONG_CAN_SEND(cong, infly) ((cong)->can_send((cong)->self, (infly)))
+#define GQUIC_CONG_TIME_UNTIL_SEND(cong, infly) ((cong)->time_until_send((cong)->self, (infly)))
+#define GQUIC_CONG_PACING_RATE(cong) ((cong)->pacing_rate((cong)->self))
+#define GQUIC_CONG_CWND(cong) ((cong)->cwnd((cong)->self))
+#define GQUIC_CONG_IN_SLOW_START(cong) ((cong)->in_slow_start((cong)->self))
+#define GQUIC_CONG_IN_RECOVERY(cong) ((cong)->in_recovery((cong)->self))
+
+int gquic_cong_init(gquic_cong_t *const cong);
+int gquic_cong_ctor(gquic_cong_t *const cong,
+                    const int algo,
+                    const gquic_rtt_t *const rtt,
+                    const u_int64_t initial_cwnd,
+                    const u_int64_t max_cwnd);
+int gquic_cong_dtor(gquic_cong_t *const cong);
+
+#endif
@@ -4,12 +4,12 @@
 #include "util/prr.h"
 #include "util/rtt.h"
 #include "util/cubic.h"
-#include "cong/hybrid_slow_start.h"
+#include "cong/hystart.h"
 #include <stddef.h>
 
 typedef struct gquic_cong_cubic_s gquic_cong_cubic_t;
 struct gquic_cong_cubic_s {
-    gquic_cong_bybrid_slow_start_t hybrid_slow_start;
+    gquic_cong_hystart_t hystart;
     gquic_prr_t prr;
     const gquic_rtt_t *rtt;
     gquic_cubic_t cubic;
@@ -32,6 +32,16 @@ struct gquic_cong_cubic_s {
     u_int64_t initial_cwnd;
     u_int64_t initial_max_cwnd;
     u_int64_t min_slow_start_exit_wnd;
+
+    // the state before the last cut, back when every loss behind it was spurious
+    struct {
+        u_int64_t lost_packets;
+        u_int64_t cwnd;
+        u_int64_t slow_start_threshold;
+        u_int64_t largest_sent_last_cut;
+        gquic_cubic_t cubic;
+        u_int8_t hystart_state;
+    } undo;
 };
 
 int gquic_cong_cubic_init(gquic_cong_cubic_t *const cubic);
@@ -52,6 +62,9 @@ int gquic_cong_cubic_on_packet_lost(gquic_cong_cubic_t *const cubic,
                                     const u_int64_t pn,
                                     const u_int64_t lost_bytes,
                                     const u_int64_t infly);
+int gquic_cong_cubic_on_spurious_loss(gquic_cong_cubic_t *const cubic, const u_int64_t pn);
+int gquic_cong_cubic_on_ecn_ce(gquic_cong_cubic_t *const cubic, const u_int64_t pn, const u_int64_t infly);
+u_int64_t gquic_cong_cubic_pacing_rate(gquic_cong_cubic_t *const cubic);
 
 static inline int gquic_cong_cubic_in_recovery(const gquic_cong_cubic_t *const cubic) {
     if (cubic == NULL) {
@@ -72,12 +85,8 @@ static inline int gquic_cong_cubic_try_exit_slow_start(gquic_cong_cubic_t *const
     if (cubic == NULL) {
         return 0;
     }
-    if (gquic_cong_cubic_in_slow_start(cubic)
-        && gquic_hybrid_slow_start_should_exit(&cubic->hybrid_slow_start,
-                                               cubic->rtt->latest,
-                                               cubic->rtt->min,
-                                               cubic->cwnd / 1460)) {
-        gquic_cong_cubic_try_exit_slow_start(cubic);
+    if (gquic_cong_cubic_in_slow_start(cubic)) {
+        gquic_cong_hystart_on_rtt_sample(&cubic->hystart, cubic->rtt->latest);
     }
     return 0;
 }
@@ -0,0 +1,47 @@
+#ifndef _LIBGQUIC_CONG_HYSTART_H
+#define _LIBGQUIC_CONG_HYSTART_H
+
+#include <sys/types.h>
+
+/*
+ * HyStart++ (RFC 9406). slow start compares the min rtt of the first
+ * samples of each round with the one of the previous round, and a rise
+ * of rtt / 8 (clamped to 4 .. 16 ms) moves it to conservative slow start:
+ * the window grows a quarter as fast for up to 5 rounds. if the rtt drops
+ * back below the baseline in the meantime, the rise was spurious and
+ * slow start resumes, otherwise it ends for good.
+ */
+#define GQUIC_CONG_HYSTART_SLOW_START 0
+#define GQUIC_CONG_HYSTART_CSS 1
+#define GQUIC_CONG_HYSTART_DONE 2
+
+#define GQUIC_CONG_HYSTART_MIN_RTT_THRESH (4 * 1000)
+#define GQUIC_CONG_HYSTART_MAX_RTT_THRESH (16 * 1000)
+#define GQUIC_CONG_HYSTART_MIN_RTT_DIVISOR 8
+#define GQUIC_CONG_HYSTART_N_RTT_SAMPLE 8
+#define GQUIC_CONG_HYSTART_CSS_GROWTH_DIVISOR 4
+#define GQUIC_CONG_HYSTART_CSS_ROUNDS 5
+
+typedef struct gquic_cong_hystart_s gquic_cong_hystart_t;
+struct gquic_cong_hystart_s {
+    u_int8_t state;
+
+    // a round ends with the ack of a packet sent after it began
+    u_int64_t window_end;
+    u_int64_t last_sent_pn;
+    u_int64_t rtt_sample_count;
+    u_int64_t current_round_min_rtt;
+    u_int64_t last_round_min_rtt;
+
+    u_int64_t css_baseline_min_rtt;
+    u_int64_t css_rounds;
+};
+
+int gquic_cong_hystart_init(gquic_cong_hystart_t *const hystart);
+int gquic_cong_hystart_on_packet_sent(gquic_cong_hystart_t *const hystart, const u_int64_t pn);
+int gquic_cong_hystart_on_rtt_sample(gquic_cong_hystart_t *const hystart, const u_int64_t rtt);
+int gquic_cong_hystart_on_packet_acked(gquic_cong_hystart_t *const hystart, const u_int64_t pn);
+int gquic_cong_hystart_exit(gquic_cong_hystart_t *const hystart);
+u_int64_t gquic_cong_hystart_cwnd_increase(const gquic_cong_hystart_t *const hystart, const u_int64_t acked_bytes);
+
+#endif
@@ -7,6 +7,11 @@
 #define GQUIC_EVENT_PACKET_SENT 0x01
 #define GQUIC_EVENT_PACKET_RECEIVED 0x02
 #define GQUIC_EVENT_PACKET_LOST 0x04
+#define GQUIC_EVENT_RATE_SAMPLE 0x08
+// a packet declared lost was acked after all
+#define GQUIC_EVENT_SPURIOUS_LOSS 0x10
+// the peer counted more CE marks, p_size is how many
+#define GQUIC_EVENT_ECN_CE 0x20
 
 typedef struct gquic_event_s gquic_event_t;
 struct gquic_event_s {
@@ -25,6 +30,13 @@ struct gquic_event_s {
     u_int64_t pn;
     u_int64_t p_size;
     const gquic_list_t *frames;
+    // GQUIC_EVENT_RATE_SAMPLE only, rates in bytes/s
+    struct {
+        u_int64_t delivery_rate;
+        u_int64_t bandwidth;
+        u_int64_t interval;
+        int is_app_limited;
+    } rate;
 };
 
 #endif
@@ -10,6 +10,19 @@ struct gquic_frame_ack_ecn_s {
     u_int64_t ecn_ce;
 };
 
+typedef struct gquic_frame_ack_range_s gquic_frame_ack_range_t;
+struct gquic_frame_ack_range_s {
+    u_int64_t gap;
+    u_int64_t range;
+};
+
+/*
+ * ack ranges are kept inline, so building or parsing an ACK frame never
+ * allocates per-range nodes. ranges beyond the capacity (the lowest ones)
+ * are dropped when parsing; they will be acknowledged again later.
+ */
+#define GQUIC_FRAME_ACK_MAX_RANGES 64
+
 typedef struct gquic_frame_ack_s gquic_frame_ack_t;
 struct gquic_frame_ack_s {
     u_int64_t largest_ack;
@@ -17,17 +30,11 @@ struct gquic_frame_ack_s {
     u_int64_t count;
     u_int64_t first_range;
 
-    gquic_list_t ranges;
+    gquic_frame_ack_range_t ranges[GQUIC_FRAME_ACK_MAX_RANGES];
 
     gquic_frame_ack_ecn_t ecn;
 };
 
-typedef struct gquic_frame_ack_range_s gquic_frame_ack_range_t;
-struct gquic_frame_ack_range_s {
-    u_int64_t gap;
-    u_int64_t range;
-};
-
 int gquic_frame_ack_range_init(gquic_frame_ack_range_t *const range);
 
 typedef struct gquic_frame_ack_block_s gquic_frame_ack_block_t;
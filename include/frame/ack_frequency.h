@@ -0,0 +1,21 @@
+#ifndef _LIBGQUIC_FRAME_ACK_FREQUENCY_H
+#define _LIBGQUIC_FRAME_ACK_FREQUENCY_H
+
+#include "util/varint.h"
+
+/*
+ * ACK_FREQUENCY (draft-ietf-quic-ack-frequency). the frame type 0xaf needs a
+ * two byte varint on the wire, the meta type keeps its low byte.
+ * max_ack_delay is in microseconds.
+ */
+typedef struct gquic_frame_ack_frequency_s gquic_frame_ack_frequency_t;
+struct gquic_frame_ack_frequency_s {
+    u_int64_t seq;
+    u_int64_t ack_eliciting_threshold;
+    u_int64_t max_ack_delay;
+    u_int64_t reordering_threshold;
+};
+
+gquic_frame_ack_frequency_t *gquic_frame_ack_frequency_alloc();
+
+#endif
@@ -2,8 +2,8 @@
 #define _LIBGQUIC_FRAME_FRAME_SORTER_H
 
 #include "util/str.h"
-#include "util/rbtree.h"
-#include "util/list.h"
+#include <sys/types.h>
+#include <stddef.h>
 
 typedef struct gquic_byte_interval_s gquic_byte_interval_t;
 struct gquic_byte_interval_s {
@@ -11,41 +11,44 @@ struct gquic_byte_interval_s {
     u_int64_t end;
 };
 
-typedef struct gquic_frame_sorter_entry_s gquic_frame_sorter_entry_t;
-struct gquic_frame_sorter_entry_s {
-    gquic_str_t data;
-    struct {
-        void *self;
-        int (*cb) (void *const);
-    } done_cb;
-};
-
-#define GQUIC_FRAME_SORTER_ENTRY_DONE(entry) ((entry)->done_cb.self != NULL \
-                                              ? (entry)->done_cb.cb((entry)->done_cb.self) \
-                                              : -1);
-
-int gquic_frame_sorter_entry_init(gquic_frame_sorter_entry_t *const entry);
+/*
+ * reassembly buffer for STREAM and CRYPTO data.
+ * received bytes are copied into a ring indexed by stream offset, so the ring
+ * only ever holds [read_pos, read_pos + cap). the ring grows on demand up to
+ * max_size, which the owner sets to its receive window. the received ranges
+ * that are not read yet are kept as sorted intervals; when the first one
+ * starts at read_pos it is readable in place.
+ */
+#define GQUIC_FRAME_SORTER_MAX_INTERVALS 1000
 
 typedef struct gquic_frame_sorter_s gquic_frame_sorter_t;
 struct gquic_frame_sorter_s {
-    gquic_rbtree_t *root; /* u_int64_t: gquic_frame_sorter_entry_t */
+    u_int8_t *buf;
+    u_int64_t cap;
+    u_int64_t max_size;
     u_int64_t read_pos;
-    int gaps_count;
-    gquic_list_t gaps;
+
+    int intervals_count;
+    int intervals_cap;
+    gquic_byte_interval_t *intervals; /* received, unread; ascending */
 };
 
 int gquic_frame_sorter_init(gquic_frame_sorter_t *const sorter);
-int gquic_frame_sorter_ctor(gquic_frame_sorter_t *const sorter);
+int gquic_frame_sorter_ctor(gquic_frame_sorter_t *const sorter, const u_int64_t max_size);
 int gquic_frame_sorter_dtor(gquic_frame_sorter_t *const sorter);
-int gquic_frame_sorter_push(gquic_frame_sorter_t *const sorter,
-                            const gquic_str_t *const data,
-                            const u_int64_t off,
-                            int (*done_cb) (void *const),
-                            void *const done_cb_self);
-int gquic_frame_sorter_pop(u_int64_t *const off,
-                           gquic_str_t *const data,
-                           int (**done_cb) (void *const),
-                           void **done_cb_self,
-                           gquic_frame_sorter_t *const sorter);
+int gquic_frame_sorter_push(gquic_frame_sorter_t *const sorter, const gquic_str_t *const data, const u_int64_t off);
+int gquic_frame_sorter_read(gquic_writer_str_t *const writer, gquic_frame_sorter_t *const sorter);
+int gquic_frame_sorter_copy(gquic_str_t *const data, const gquic_frame_sorter_t *const sorter);
+
+static inline u_int64_t gquic_frame_sorter_readable(const gquic_frame_sorter_t *const sorter) {
+    if (sorter == NULL || sorter->intervals_count == 0 || sorter->intervals[0].start != sorter->read_pos) {
+        return 0;
+    }
+    return sorter->intervals[0].end - sorter->read_pos;
+}
+
+static inline int gquic_frame_sorter_empty(const gquic_frame_sorter_t *const sorter) {
+    return sorter == NULL || sorter->intervals_count == 0;
+}
 
 #endif
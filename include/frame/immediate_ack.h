@@ -0,0 +1,9 @@
+#ifndef _LIBGQUIC_FRAME_IMMEDIATE_ACK_H
+#define _LIBGQUIC_FRAME_IMMEDIATE_ACK_H
+
+typedef struct gquic_frame_immediate_ack_s gquic_frame_immediate_ack_t;
+struct gquic_frame_immediate_ack_s { };
+
+gquic_frame_immediate_ack_t *gquic_frame_immediate_ack_alloc();
+
+#endif
@@ -21,12 +21,16 @@ int gquic_long_header_sealer_ctor(gquic_long_header_sealer_t *const sealer,
 int gquic_long_header_sealer_traffic_ctor(gquic_long_header_sealer_t *const sealer,
                                           const gquic_tls_cipher_suite_t *const suite,
                                           const gquic_str_t *const traffic_sec);
+int gquic_long_header_sealer_key_ctor(gquic_long_header_sealer_t *const sealer,
+                                      const gquic_tls_cipher_suite_t *const suite,
+                                      const gquic_str_t *key,
+                                      const gquic_str_t *iv,
+                                      const gquic_str_t *const header_protector_key);
 int gquic_long_header_sealer_dtor(gquic_long_header_sealer_t *const sealer);
 int gquic_long_header_sealer_seal(gquic_str_t *const tag,
-                                  gquic_str_t *const cipher_text,
+                                  gquic_str_t *const text,
                                   gquic_long_header_sealer_t *const sealer,
                                   const u_int64_t pn,
-                                  const gquic_str_t *const plain_text,
                                   const gquic_str_t *const addata);
 
 typedef struct gquic_long_header_opener_s gquic_long_header_opener_t;
@@ -46,12 +50,16 @@ int gquic_long_header_opener_ctor(gquic_long_header_opener_t *const opener,
 int gquic_long_header_opener_traffic_ctor(gquic_long_header_opener_t *const opener,
                                           const gquic_tls_cipher_suite_t *const suite,
                                           const gquic_str_t *const traffic_sec);
+int gquic_long_header_opener_key_ctor(gquic_long_header_opener_t *const opener,
+                                      const gquic_tls_cipher_suite_t *const suite,
+                                      const gquic_str_t *key,
+                                      const gquic_str_t *iv,
+                                      const gquic_str_t *const header_protector_key);
 int gquic_long_header_opener_dtor(gquic_long_header_opener_t *const opener);
-int gquic_long_header_opener_open(gquic_str_t *const plain_text,
+int gquic_long_header_opener_open(gquic_str_t *const text,
                                   gquic_long_header_opener_t *const opener,
                                   const u_int64_t pn,
                                   const gquic_str_t *const tag,
-                                  const gquic_str_t *const cipher_text,
                                   const gquic_str_t *const addata);
 
 typedef struct gquic_handshake_sealer_s gquic_handshake_sealer_t;
@@ -80,10 +88,9 @@ int gquic_handshake_sealer_traffic_ctor(gquic_handshake_sealer_t *const sealer,
                                         int (*drop_keys_cb) (void *const));
 int gquic_handshake_sealer_dtor(gquic_handshake_sealer_t *const sealer);
 int gquic_handshake_sealer_seal(gquic_str_t *const tag,
-                                gquic_str_t *const cipher_text,
+                                gquic_str_t *const text,
                                 gquic_handshake_sealer_t *const sealer,
                                 const u_int64_t pn,
-                                const gquic_str_t *const plain_text,
                                 const gquic_str_t *const addata);
 
 #define GQUIC_HANDSHAKE_SEALER_DROP_KEYS(sealer) ((sealer)->drop_keys.cb((sealer)->drop_keys.self))
@@ -115,11 +122,10 @@ int gquic_handshake_opener_traffic_ctor(gquic_handshake_opener_t *const opener,
                                         void *drop_keys_self,
                                         int (*drop_keys_cb) (void *const));
 int gquic_handshake_opener_dtor(gquic_handshake_opener_t *const opener);
-int gquic_handshake_opener_open(gquic_str_t *const plain_text,
+int gquic_handshake_opener_open(gquic_str_t *const text,
                                 gquic_handshake_opener_t *const opener,
                                 const u_int64_t pn,
                                 const gquic_str_t *const tag,
-                                const gquic_str_t *const cipher_text,
                                 const gquic_str_t *const addata);
 
 typedef struct gquic_common_long_header_sealer_s gquic_common_long_header_sealer_t;
@@ -142,6 +148,11 @@ int gquic_common_long_header_sealer_long_header_ctor(gquic_common_long_header_se
 int gquic_common_long_header_sealer_long_header_traffic_ctor(gquic_common_long_header_sealer_t *const sealer,
                                                              const gquic_tls_cipher_suite_t *const suite,
                                                              const gquic_str_t *const traffic_sec);
+int gquic_common_long_header_sealer_long_header_key_ctor(gquic_common_long_header_sealer_t *const sealer,
+                                                         const gquic_tls_cipher_suite_t *const suite,
+                                                         const gquic_str_t *key,
+                                                         const gquic_str_t *iv,
+                                                         const gquic_str_t *const header_protector_key);
 int gquic_common_long_header_sealer_handshake_ctor(gquic_common_long_header_sealer_t *const sealer,
                                                    const gquic_tls_cipher_suite_t *const aead_suite,
                                                    const gquic_str_t *key,
@@ -159,10 +170,9 @@ int gquic_common_long_header_sealer_handshake_traffic_ctor(gquic_common_long_hea
                                                            int is_client);
 int gquic_common_long_header_sealer_dtor(gquic_common_long_header_sealer_t *const sealer);
 int gquic_common_long_header_sealer_seal(gquic_str_t *const tag,
-                                         gquic_str_t *const cipher_text,
+                                         gquic_str_t *const text,
                                          gquic_common_long_header_sealer_t *const sealer,
                                          const u_int64_t pn,
-                                         const gquic_str_t *const plain_text,
                                          const gquic_str_t *const addata);
 int gquic_common_long_header_sealer_get_header_sealer(gquic_header_protector_t **const protector,
                                                       gquic_common_long_header_sealer_t *const sealer);
@@ -186,6 +196,11 @@ int gquic_common_long_header_opener_long_header_ctor(gquic_common_long_header_op
 int gquic_common_long_header_opener_long_header_traffic_ctor(gquic_common_long_header_opener_t *const opener,
                                                              const gquic_tls_cipher_suite_t *const suite,
                                                              const gquic_str_t *const traffic_sec);
+int gquic_common_long_header_opener_long_header_key_ctor(gquic_common_long_header_opener_t *const opener,
+                                                         const gquic_tls_cipher_suite_t *const suite,
+                                                         const gquic_str_t *key,
+                                                         const gquic_str_t *iv,
+                                                         const gquic_str_t *const header_protector_key);
 int gquic_common_long_header_opener_handshake_ctor(gquic_common_long_header_opener_t *const opener,
                                                    const gquic_tls_cipher_suite_t *const aead_suite,
                                                    const gquic_str_t *key,
@@ -202,11 +217,10 @@ int gquic_common_long_header_opener_handshake_traffic_ctor(gquic_common_long_hea
                                                            int (*drop_keys_cb) (void *const),
                                                            int is_client);
 int gquic_common_long_header_opener_dtor(gquic_common_long_header_opener_t *const opener);
-int gquic_common_long_header_opener_open(gquic_str_t *const plain_text,
+int gquic_common_long_header_opener_open(gquic_str_t *const text,
                                          gquic_common_long_header_opener_t *const opener,
                                          const u_int64_t pn,
                                          const gquic_str_t *const tag,
-                                         const gquic_str_t *const cipher_text,
                                          const gquic_str_t *const addata);
 int gquic_common_long_header_opener_get_header_opener(gquic_header_protector_t **const protector,
                                                       gquic_common_long_header_opener_t *const opener);
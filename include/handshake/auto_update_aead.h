@@ -6,12 +6,47 @@
 #include "util/rtt.h"
 #include "handshake/header_protector.h"
 
+/*
+ * keys of one key phase generation. the secrets are kept so the generation
+ * after it can be derived.
+ */
+typedef struct gquic_auto_update_aead_keys_s gquic_auto_update_aead_keys_t;
+struct gquic_auto_update_aead_keys_s {
+    gquic_str_t recv_traffic_sec;
+    gquic_str_t send_traffic_sec;
+    gquic_tls_aead_t recv_aead;
+    gquic_tls_aead_t send_aead;
+    // the next_seq these keys were derived for
+    u_int64_t seq;
+};
+
+#define GQUIC_AUTO_UPDATE_AEAD_DEFAULT_UPDATE_PACKETS (1 << 23)
+#define GQUIC_AUTO_UPDATE_AEAD_DEFAULT_UPDATE_BYTES (1ULL << 36)
+
+/*
+ * where a refresh job publishes the keys it derived. it is shared by an AEAD
+ * and the jobs it queued, and freed by whichever of them lets go last, so a
+ * worker never touches the AEAD itself.
+ */
+typedef struct gquic_auto_update_aead_refresh_s gquic_auto_update_aead_refresh_t;
+struct gquic_auto_update_aead_refresh_s {
+    int refs;
+    // the next_seq the AEAD wants keys for, older jobs are skipped
+    u_int64_t seq;
+    gquic_auto_update_aead_keys_t *ready;
+};
+
+#define GQUIC_AUTO_UPDATE_AEAD_REFRESH_THREADS 2
+
 typedef struct gquic_auto_update_aead_s gquic_auto_update_aead_t;
 struct gquic_auto_update_aead_s {
     const gquic_tls_cipher_suite_t *suite;
     u_int64_t times;
     u_int64_t last_ack_pn;
-    u_int64_t update_interval;
+
+    /* a key update is started once either limit is reached under the current keys, 0 disables it */
+    u_int64_t update_after_packets;
+    u_int64_t update_after_bytes;
 
     u_int64_t prev_recv_aead_expire;
     gquic_tls_aead_t prev_recv_aead;
@@ -20,15 +55,22 @@ struct gquic_auto_update_aead_s {
     u_int64_t cur_key_first_sent_pn;
     u_int64_t cur_key_num_recv;
     u_int64_t cur_key_num_sent;
+    u_int64_t cur_key_bytes_sent;
 
     gquic_tls_aead_t recv_aead;
     gquic_tls_aead_t send_aead;
 
-    gquic_tls_aead_t next_recv_aead;
-    gquic_tls_aead_t next_send_aead;
-
-    gquic_str_t next_recv_traffic_sec;
-    gquic_str_t next_send_traffic_sec;
+    /*
+     * generation N + 1 is always ready. generation N + 2 is derived by one of
+     * GQUIC_AUTO_UPDATE_AEAD_REFRESH_THREADS workers shared by every AEAD of
+     * the process, and published to refresh->ready. the pointer is swapped
+     * atomically: a roll takes the keys if they are there and derives them
+     * itself otherwise, it never waits on a worker. next_seq changes with
+     * next, so keys derived from an older next are thrown away.
+     */
+    gquic_auto_update_aead_keys_t *next;
+    u_int64_t next_seq;
+    gquic_auto_update_aead_refresh_t *refresh;
 
     gquic_header_protector_t header_enc;
     gquic_header_protector_t header_dec;
@@ -39,26 +81,33 @@ struct gquic_auto_update_aead_s {
 };
 
 int gquic_auto_update_aead_init(gquic_auto_update_aead_t *const aead);
+int gquic_auto_update_aead_dtor(gquic_auto_update_aead_t *const aead);
 int gquic_auto_update_aead_roll(gquic_auto_update_aead_t *const aead, const u_int64_t now);
+int gquic_auto_update_aead_try_update(gquic_auto_update_aead_t *const aead, const u_int64_t now);
+int gquic_auto_update_aead_drop_prev_keys(gquic_auto_update_aead_t *const aead, const u_int64_t now);
 int gquic_auto_update_aead_set_rkey(gquic_auto_update_aead_t *const aead,
                                     const gquic_tls_cipher_suite_t *const suite,
                                     const gquic_str_t *const traffic_sec);
 int gquic_auto_update_aead_set_wkey(gquic_auto_update_aead_t *const aead,
                                     const gquic_tls_cipher_suite_t *const suite,
                                     const gquic_str_t *const traffic_sec);
-int gquic_auto_update_aead_open(gquic_str_t *const plain_text,
+int gquic_auto_update_aead_open(gquic_str_t *const text,
                                 gquic_auto_update_aead_t *const aead,
                                 const u_int64_t recv_time,
                                 const u_int64_t pn,
                                 int kp,
                                 const gquic_str_t *const tag,
-                                const gquic_str_t *const cipher_text,
                                 const gquic_str_t *const addata);
 int gquic_auto_update_aead_seal(gquic_str_t *const tag,
-                                gquic_str_t *const cipher_text,
+                                gquic_str_t *const text,
                                 gquic_auto_update_aead_t *const aead,
                                 const u_int64_t pn,
-                                const gquic_str_t *const plain_text,
                                 const gquic_str_t *const addata);
+int gquic_auto_update_aead_seal_batch(gquic_str_t *const tags,
+                                      gquic_str_t *const texts,
+                                      gquic_auto_update_aead_t *const aead,
+                                      const u_int64_t *const pns,
+                                      const gquic_str_t *const addatas,
+                                      const size_t count);
 
 #endif
@@ -10,6 +10,7 @@
 #include "handshake/aead.h"
 #include "handshake/transport_parameters.h"
 #include "handshake/extension_handler.h"
+#include "util/version.h"
 #include <semaphore.h>
 
 typedef struct gquic_establish_ending_event_s gquic_establish_ending_event_t;
@@ -61,6 +62,10 @@ struct gquic_handshake_event_s {
         void *self;
         int (*cb) (void *const);
     } on_handshake_complete;
+    struct {
+        void *self;
+        int (*cb) (void *const, const gquic_str_t *const);
+    } on_restore_params;
 };
 
 #define GQUIC_HANDSHAKE_EVENT_ON_RECV_PARAMS(p, e) \
@@ -79,6 +84,10 @@ struct gquic_handshake_event_s {
     (((p) == NULL || (p)->on_handshake_complete.cb == NULL || (p)->on_handshake_complete.self == NULL) \
      ? -1 \
      : ((p)->on_handshake_complete.cb((p)->on_handshake_complete.self)))
+#define GQUIC_HANDSHAKE_EVENT_ON_RESTORE_PARAMS(p, e) \
+    (((p) == NULL || (p)->on_restore_params.cb == NULL || (p)->on_restore_params.self == NULL) \
+     ? -1 \
+     : ((p)->on_restore_params.cb((p)->on_restore_params.self, (e))))
 
 int gquic_handshake_event_init(gquic_handshake_event_t *const event);
 
@@ -93,6 +102,7 @@ struct gquic_handshake_establish_s {
     gquic_sem_list_t handshake_process_events_queue;
     int cli_hello_written;
     int is_client;
+    gquic_version_t version;
     sem_t mtx;
     sem_t client_written_sem;
     u_int8_t read_enc_level;
@@ -103,6 +113,8 @@ struct gquic_handshake_establish_s {
     gquic_io_t handshake_output;
     gquic_common_long_header_opener_t handshake_opener;
     gquic_common_long_header_sealer_t handshake_sealer;
+    gquic_common_long_header_opener_t zero_rtt_opener;
+    gquic_common_long_header_sealer_t zero_rtt_sealer;
     gquic_io_t one_rtt_output;
     gquic_auto_update_aead_t aead;
     int has_1rtt_sealer;
@@ -133,6 +145,7 @@ int gquic_handshake_establish_ctor(gquic_handshake_establish_t *const est,
                                    int (*chello_written_cb) (void *const),
                                    gquic_tls_config_t *const cfg,
                                    const gquic_str_t *const conn_id,
+                                   const gquic_version_t version,
                                    const gquic_transport_parameters_t *const params,
                                    gquic_rtt_t *const rtt,
                                    const gquic_net_addr_t *const addr,
@@ -156,6 +169,7 @@ int gquic_handshake_establish_set_wkey(gquic_handshake_establish_t *const est,
                                        const gquic_str_t *const traffic_sec);
 int gquic_handshake_establish_drop_initial_keys(gquic_handshake_establish_t *const est);
 int gquic_handshake_establish_drop_handshake_keys(gquic_handshake_establish_t *const est);
+int gquic_handshake_establish_drop_0rtt_keys(gquic_handshake_establish_t *const est);
 int gquic_handshake_establish_write_record(size_t *const size, gquic_handshake_establish_t *const est, const gquic_str_t *const data);
 int gquic_handshake_establish_send_alert(gquic_handshake_establish_t *const est, const u_int8_t alert);
 int gquic_handshake_establish_set_record_layer(gquic_tls_record_layer_t *const record_layer, gquic_handshake_establish_t *const est);
@@ -165,6 +179,9 @@ int gquic_handshake_establish_get_initial_opener(gquic_header_protector_t **cons
 int gquic_handshake_establish_get_handshake_opener(gquic_header_protector_t **const protector,
                                                    gquic_common_long_header_opener_t **const opener,
                                                    gquic_handshake_establish_t *const est);
+int gquic_handshake_establish_get_0rtt_opener(gquic_header_protector_t **const protector,
+                                              gquic_common_long_header_opener_t **const opener,
+                                              gquic_handshake_establish_t *const est);
 int gquic_handshake_establish_get_1rtt_opener(gquic_header_protector_t **const protector,
                                               gquic_auto_update_aead_t **const opener,
                                               gquic_handshake_establish_t *const est);
@@ -174,6 +191,9 @@ int gquic_handshake_establish_get_initial_sealer(gquic_header_protector_t **cons
 int gquic_handshake_establish_get_handshake_sealer(gquic_header_protector_t **const protector,
                                                    gquic_common_long_header_sealer_t **const sealer,
                                                    gquic_handshake_establish_t *const est);
+int gquic_handshake_establish_get_0rtt_sealer(gquic_header_protector_t **const protector,
+                                              gquic_common_long_header_sealer_t **const sealer,
+                                              gquic_handshake_establish_t *const est);
 int gquic_handshake_establish_get_1rtt_sealer(gquic_header_protector_t **const protector,
                                               gquic_auto_update_aead_t **const sealer,
                                               gquic_handshake_establish_t *const est);
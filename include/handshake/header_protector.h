@@ -10,18 +10,33 @@ struct gquic_header_protector_s {
     int (*set_key) (void *const, gquic_str_t *const);
     int (*encrypt) (gquic_str_t *const, u_int8_t *const, void *const);
     int (*decrypt) (gquic_str_t *const, u_int8_t *const, void *const);
+    int (*apply_batch) (gquic_str_t *const, u_int8_t *const *const, void *const, const gquic_str_t *const, const size_t);
     int (*dtor) (void *const);
 };
 
+/*
+ * apply_batch masks the packet number bytes in headers[i] and *first_bytes[i]
+ * with the mask of samples[i]. masking is a xor, so it serves both directions.
+ */
+#define GQUIC_HEADER_PROTECTOR_MAX_BATCH 64
+
 #define GQUIC_HEADER_PROTECTOR_SET_KEY(p, s) ((p)->set_key((p)->self, (s)))
 #define GQUIC_HEADER_PROTECTOR_ENCRYPT(h, f, p) ((p)->encrypt((h), (f), (p)->self))
 #define GQUIC_HEADER_PROTECTOR_DECRYPT(h, f, p) ((p)->decrypt((h), (f), (p)->self))
+#define GQUIC_HEADER_PROTECTOR_APPLY_BATCH(hs, fs, p, ss, n) ((p)->apply_batch((hs), (fs), (p)->self, (ss), (n)))
 
 int gquic_header_protector_init(gquic_header_protector_t *const protector);
 int gquic_header_protector_ctor(gquic_header_protector_t *const protector,
                                   const gquic_tls_cipher_suite_t *const suite,
                                   const gquic_str_t *const traffic_sec,
                                   int is_long_header);
+int gquic_header_protector_derive_key(gquic_str_t *const header_protector_key,
+                                      const gquic_tls_cipher_suite_t *const suite,
+                                      const gquic_str_t *const traffic_sec);
+int gquic_header_protector_key_ctor(gquic_header_protector_t *const protector,
+                                    const gquic_tls_cipher_suite_t *const suite,
+                                    const gquic_str_t *const header_protector_key,
+                                    int is_long_header);
 int gquic_header_protector_dtor(gquic_header_protector_t *const protector);
 
 #endif
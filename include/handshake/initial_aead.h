@@ -3,9 +3,36 @@
 
 #include "handshake/header_protector.h"
 #include "handshake/aead.h"
+#include "util/version.h"
+
+typedef struct gquic_handshake_initial_keys_s gquic_handshake_initial_keys_t;
+struct gquic_handshake_initial_keys_s {
+    u_int8_t cli_key[16];
+    u_int8_t cli_iv[12];
+    u_int8_t cli_hp_key[16];
+    u_int8_t ser_key[16];
+    u_int8_t ser_iv[12];
+    u_int8_t ser_hp_key[16];
+};
+
+/*
+ * derived Initial keys are cached by (version, destination connection id),
+ * so a repeated Initial for the same connection id costs a lookup instead of
+ * the HKDF chain. the cache is process wide and shared by the sessions of
+ * every thread. it is set associative, and each set has its own mutex, held
+ * only to compare and copy its ways; the HKDF chain runs outside of it.
+ */
+#define GQUIC_HANDSHAKE_INITIAL_CACHE_SETS 256
+#define GQUIC_HANDSHAKE_INITIAL_CACHE_WAYS 4
+#define GQUIC_HANDSHAKE_INITIAL_MAX_CONN_ID_LEN 20
+
+int gquic_handshake_initial_keys_get(gquic_handshake_initial_keys_t *const keys,
+                                     const gquic_version_t version,
+                                     const gquic_str_t *const conn_id);
 
 int gquic_handshake_initial_aead_init(gquic_common_long_header_sealer_t *const sealer,
                                       gquic_common_long_header_opener_t *const opener,
+                                      const gquic_version_t version,
                                       const gquic_str_t *const conn_id,
                                       int is_client);
 
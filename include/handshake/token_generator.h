@@ -0,0 +1,60 @@
+#ifndef _LIBGQUIC_HANDSHAKE_TOKEN_GENERATOR_H
+#define _LIBGQUIC_HANDSHAKE_TOKEN_GENERATOR_H
+
+#include "util/str.h"
+#include "net/addr.h"
+#include <openssl/evp.h>
+#include <sys/types.h>
+
+/*
+ * server address validation tokens. a token is AES-128-GCM sealed under a
+ * key only the server (or servers sharing the secret) knows, and binds the
+ * client ip and the time it was issued, so presenting one proves the client
+ * received it at that address. retry tokens also carry the original
+ * destination connection id and live for seconds, NEW_TOKEN tokens live for
+ * a day. the generator is keyed once at ctor and only read afterwards, so
+ * one generator serves every session without a lock.
+ */
+#define GQUIC_HANDSHAKE_TOKEN_RETRY_LIFETIME (10 * 1000 * 1000)
+#define GQUIC_HANDSHAKE_TOKEN_NEW_TOKEN_LIFETIME (24 * 60 * 60 * 1000 * 1000UL)
+#define GQUIC_HANDSHAKE_TOKEN_SECRET_SIZE 16
+
+#define GQUIC_HANDSHAKE_TOKEN_VALID 0
+#define GQUIC_HANDSHAKE_TOKEN_INVALID -2
+#define GQUIC_HANDSHAKE_TOKEN_EXPIRED -3
+
+typedef struct gquic_handshake_token_s gquic_handshake_token_t;
+struct gquic_handshake_token_s {
+    int is_retry;
+    u_int64_t sent_time;
+    gquic_str_t odcid;
+};
+
+int gquic_handshake_token_init(gquic_handshake_token_t *const token);
+int gquic_handshake_token_dtor(gquic_handshake_token_t *const token);
+
+typedef struct gquic_handshake_token_generator_s gquic_handshake_token_generator_t;
+struct gquic_handshake_token_generator_s {
+    EVP_CIPHER_CTX *enc;
+    EVP_CIPHER_CTX *dec;
+};
+
+int gquic_handshake_token_generator_init(gquic_handshake_token_generator_t *const gen);
+int gquic_handshake_token_generator_ctor(gquic_handshake_token_generator_t *const gen, const u_int8_t *const secret);
+int gquic_handshake_token_generator_dtor(gquic_handshake_token_generator_t *const gen);
+int gquic_handshake_token_generator_new_token(gquic_str_t *const token,
+                                              gquic_handshake_token_generator_t *const gen,
+                                              const gquic_net_addr_t *const addr,
+                                              const u_int64_t now);
+int gquic_handshake_token_generator_new_retry_token(gquic_str_t *const token,
+                                                    gquic_handshake_token_generator_t *const gen,
+                                                    const gquic_net_addr_t *const addr,
+                                                    const gquic_str_t *const odcid,
+                                                    const u_int64_t now);
+int gquic_handshake_token_generator_validate(gquic_handshake_token_t *const info,
+                                             gquic_handshake_token_generator_t *const gen,
+                                             const gquic_str_t *const token,
+                                             const gquic_net_addr_t *const addr,
+                                             const u_int64_t now);
+
+#endif
@@ -18,6 +18,8 @@
 #define GQUIC_TRANSPORT_PARAM_MAX_ACK_DELAY 0x0b
 #define GQUIC_TRANSPORT_PARAM_DISABLE_MIGRATION 0x0c
 #define GQUIC_TRANSPORT_PARAM_ACTIVE_CONN_ID_LIMIT 0x0e
+// draft-ietf-quic-ack-frequency, in microseconds. absent (0) means the peer does not take ACK_FREQUENCY
+#define GQUIC_TRANSPORT_PARAM_MIN_ACK_DELAY 0xde1a
 
 
 typedef struct gquic_transport_parameters_s gquic_transport_parameters_t;
@@ -36,6 +38,7 @@ struct gquic_transport_parameters_s {
     u_int64_t max_ack_delay;
     int disable_migration;
     u_int64_t active_conn_id_limit;
+    u_int64_t min_ack_delay;
 };
 
 int gquic_transport_parameters_init(gquic_transport_parameters_t *const params);
@@ -8,6 +8,10 @@ typedef struct gquic_net_conn_s gquic_net_conn_t;
 struct gquic_net_conn_s {
     gquic_net_addr_t addr;
     int fd;
+    // SO_TXTIME is on, datagrams carry their departure time for the qdisc
+    int txtime;
+    // ECN codepoints may be set on sent datagrams, off once the kernel refuses them
+    int ecn;
 
     struct {
         void *self;
@@ -20,4 +24,28 @@ struct gquic_net_conn_s {
 int gquic_net_conn_init(gquic_net_conn_t *const conn);
 int gquic_net_conn_write(gquic_net_conn_t *const conn, const gquic_str_t *const raw);
 
+/*
+ * kernel assisted pacing. once SO_TXTIME is set on the socket each datagram
+ * written with a departure time (µs, gettimeofday clock) carries it as
+ * SCM_TXTIME and the fq qdisc holds it until then. a departure time of 0, a
+ * custom writer or a socket without SO_TXTIME sends at once. a send the
+ * kernel rejects for its txtime turns the option off for the conn, so the
+ * caller can go back to pacing in user space.
+ */
+int gquic_net_conn_enable_txtime(gquic_net_conn_t *const conn);
+int gquic_net_conn_write_at(gquic_net_conn_t *const conn, const gquic_str_t *const raw, const u_int64_t txtime, const u_int8_t ecn);
+
+/*
+ * the ECN field, the low two bits of the IPv4 TOS / IPv6 traffic class byte.
+ * write_at sets it through an IP_TOS / IPV6_TCLASS cmsg, receivers turn on
+ * IP_RECVTOS / IPV6_RECVTCLASS to see what the path left of it.
+ */
+#define GQUIC_NET_ECN_NOT_ECT 0
+#define GQUIC_NET_ECN_ECT1 1
+#define GQUIC_NET_ECN_ECT0 2
+#define GQUIC_NET_ECN_CE 3
+#define GQUIC_NET_ECN_MASK 3
+
+int gquic_net_enable_recv_ecn(const int fd);
+
 #endif
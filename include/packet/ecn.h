@@ -0,0 +1,44 @@
+#ifndef _LIBGQUIC_PACKET_ECN_H
+#define _LIBGQUIC_PACKET_ECN_H
+
+#include "frame/ack.h"
+#include <sys/types.h>
+
+/*
+ * ECN validation of the path (RFC 9000 13.4.2). the first
+ * GQUIC_PACKET_ECN_TESTING_PACKETS ack-eliciting 1-RTT packets go out as
+ * ECT(0), then marking pauses until an ACK shows the marks arrived. the path
+ * is capable once an ACK_ECN accounts for every newly acked marked packet in
+ * its ECT(0) and CE counts. it has failed, and marking stops for good, when
+ * the counts go missing, go down, exceed what was marked, show ECT(1) we
+ * never sent, or when every testing packet is lost.
+ */
+#define GQUIC_PACKET_ECN_DISABLED 0
+#define GQUIC_PACKET_ECN_TESTING 1
+#define GQUIC_PACKET_ECN_UNKNOWN 2
+#define GQUIC_PACKET_ECN_CAPABLE 3
+#define GQUIC_PACKET_ECN_FAILED 4
+
+#define GQUIC_PACKET_ECN_TESTING_PACKETS 10
+
+typedef struct gquic_packet_ecn_s gquic_packet_ecn_t;
+struct gquic_packet_ecn_s {
+    u_int8_t state;
+    u_int64_t testing_sent;
+    u_int64_t testing_lost;
+    u_int64_t marked;
+
+    // counts of the last ACK_ECN that passed
+    gquic_frame_ack_ecn_t peer;
+};
+
+int gquic_packet_ecn_init(gquic_packet_ecn_t *const ecn);
+int gquic_packet_ecn_enable(gquic_packet_ecn_t *const ecn);
+u_int8_t gquic_packet_ecn_mark(gquic_packet_ecn_t *const ecn);
+int gquic_packet_ecn_on_packet_lost(gquic_packet_ecn_t *const ecn, const u_int8_t codepoint);
+int gquic_packet_ecn_on_ack(u_int64_t *const ce_increase,
+                            gquic_packet_ecn_t *const ecn,
+                            const gquic_frame_ack_t *const ack_frame,
+                            const u_int64_t newly_acked_marked);
+
+#endif
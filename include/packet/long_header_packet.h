@@ -35,10 +35,11 @@ struct gquic_packet_handshake_header_s {
     u_int64_t pn;
 };
 
+#define GQUIC_PACKET_RETRY_TAG_SIZE 16
+
 typedef struct gquic_packet_retry_header_s gquic_packet_retry_header_t;
 struct gquic_packet_retry_header_s {
-    unsigned char odcid_len;
-    unsigned char odcid[20];
+    u_int8_t tag[GQUIC_PACKET_RETRY_TAG_SIZE];
 };
 
 
@@ -0,0 +1,47 @@
+#ifndef _LIBGQUIC_PACKET_PACER_H
+#define _LIBGQUIC_PACKET_PACER_H
+
+#include <sys/types.h>
+
+/*
+ * token bucket pacer. the bucket fills at the congestion controller's
+ * pacing rate and holds at most one burst: burst_packets datagrams, or
+ * what the rate delivers in two minimum delays if that is more, so a late
+ * timer does not cost throughput at high rates. the sender sleeps until
+ * the bucket holds a release quantum, one datagram, or one whole GSO batch
+ * when segmentation offload is used.
+ */
+#define GQUIC_PACKET_PACER_DEFAULT_BURST_PACKETS 10
+#define GQUIC_PACKET_PACER_MIN_DELAY (200)
+
+typedef struct gquic_packet_pacer_s gquic_packet_pacer_t;
+struct gquic_packet_pacer_s {
+    u_int64_t budget_at_last_sent;
+    u_int64_t last_sent_time;
+
+    u_int64_t max_datagram_size;
+    u_int64_t burst_packets;
+    u_int64_t gso_segments;
+};
+
+int gquic_packet_pacer_init(gquic_packet_pacer_t *const pacer);
+int gquic_packet_pacer_ctor(gquic_packet_pacer_t *const pacer,
+                            const u_int64_t max_datagram_size,
+                            const u_int64_t burst_packets,
+                            const u_int64_t gso_segments);
+u_int64_t gquic_packet_pacer_max_burst(const gquic_packet_pacer_t *const pacer, const u_int64_t rate);
+u_int64_t gquic_packet_pacer_budget(const gquic_packet_pacer_t *const pacer, const u_int64_t rate, const u_int64_t now);
+int gquic_packet_pacer_sent_packet(gquic_packet_pacer_t *const pacer, const u_int64_t rate, const u_int64_t now, const u_int64_t bytes);
+u_int64_t gquic_packet_pacer_allowed_packets(const gquic_packet_pacer_t *const pacer, const u_int64_t rate, const u_int64_t now);
+u_int64_t gquic_packet_pacer_next_release(const gquic_packet_pacer_t *const pacer, const u_int64_t rate, const u_int64_t now);
+
+/*
+ * when the kernel paces (SO_TXTIME) a whole window is handed over at once,
+ * each datagram stamped with the time the bucket would have let it out.
+ */
+u_int64_t gquic_packet_pacer_departure_time(const gquic_packet_pacer_t *const pacer,
+                                            const u_int64_t rate,
+                                            const u_int64_t now,
+                                            const u_int64_t bytes);
+
+#endif
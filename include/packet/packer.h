@@ -23,6 +23,10 @@ struct gquic_packed_packet_s {
     gquic_frame_ack_t *ack;
     gquic_list_t *frames;
     gquic_packet_buffer_t *buffer;
+    // departure time handed to the kernel with SO_TXTIME, 0 to send at once
+    u_int64_t txtime;
+    // ECN codepoint set in the IP header
+    u_int8_t ecn;
 };
 
 int gquic_packed_packet_init(gquic_packed_packet_t *const packed_packet);
@@ -46,7 +50,6 @@ struct gquic_packed_packet_payload_s {
                   gquic_str_t *const,
                   void *const,
                   const u_int64_t,
-                  const gquic_str_t *const,
                   const gquic_str_t *const);
     } sealer;
     gquic_header_protector_t *header_sealer;
@@ -58,8 +61,25 @@ struct gquic_packed_packet_payload_s {
 int gquic_packed_packet_payload_init(gquic_packed_packet_payload_t *const payload);
 int gquic_packed_packet_payload_dtor(gquic_packed_packet_payload_t *const payload);
 
-#define GQUIC_PACKED_PACKET_PAYLOAD_SEAL(tag, cipher_text, payload, pn, plain_text, addata) \
-    ((payload)->sealer.cb((tag), (cipher_text), (payload)->sealer.self, (pn), (plain_text), (addata)))
+#define GQUIC_PACKED_PACKET_PAYLOAD_SEAL(tag, text, payload, pn, addata) \
+    ((payload)->sealer.cb((tag), (text), (payload)->sealer.self, (pn), (addata)))
+
+/*
+ * 1-RTT packets packed while a batch is open are serialized but left in
+ * plain text; sealing and header protection run once for the whole batch
+ * when it is flushed.
+ */
+typedef struct gquic_packet_packer_batch_s gquic_packet_packer_batch_t;
+struct gquic_packet_packer_batch_s {
+    size_t count;
+    gquic_auto_update_aead_t *sealer;
+    gquic_header_protector_t *header_sealer;
+    u_int64_t pns[GQUIC_TLS_AEAD_MAX_BATCH];
+    int pn_lens[GQUIC_TLS_AEAD_MAX_BATCH];
+    gquic_str_t tags[GQUIC_TLS_AEAD_MAX_BATCH];
+    gquic_str_t texts[GQUIC_TLS_AEAD_MAX_BATCH];
+    gquic_str_t addatas[GQUIC_TLS_AEAD_MAX_BATCH];
+};
 
 typedef struct gquic_packet_packer_s gquic_packet_packer_t;
 struct gquic_packet_packer_s {
@@ -88,6 +108,8 @@ struct gquic_packet_packer_s {
 
     u_int64_t max_packet_size;
     int non_ack_eliciting_acks_count;
+
+    gquic_packet_packer_batch_t *batch;
 };
 
 int gquic_packet_packer_init(gquic_packet_packer_t *const packer);
@@ -139,6 +161,10 @@ int gquic_packet_packer_pack_crypto_packet(gquic_packed_packet_t *const packed_p
                                            gquic_packet_packer_t *const packer,
                                            gquic_packed_packet_payload_t *const payload,
                                            const int has_retransmission);
+int gquic_packet_packer_pack_app_packets(gquic_packed_packet_t *const packed_packets,
+                                         size_t *const count,
+                                         gquic_packet_packer_t *const packer,
+                                         const size_t max_count);
 
 
 inline static int gquic_packet_packer_handshake_confirmed(gquic_packet_packer_t *const packer) {
@@ -13,6 +13,14 @@ struct gquic_packet_s {
     u_int8_t enc_lv;
     u_int64_t send_time;
     int included_infly;
+    // ECN codepoint it went out with
+    u_int8_t ecn;
+
+    // delivery rate sampler state when the packet was sent
+    u_int64_t delivered;
+    u_int64_t delivered_time;
+    u_int64_t first_sent_time;
+    int is_app_limited;
 };
 
 int gquic_packet_init(gquic_packet_t *const packet);
@@ -0,0 +1,87 @@
+#ifndef _LIBGQUIC_PACKET_RATE_SAMPLER_H
+#define _LIBGQUIC_PACKET_RATE_SAMPLER_H
+
+#include "packet/packet.h"
+#include "util/max_filter.h"
+#include <sys/types.h>
+
+/*
+ * delivery rate sampler (draft-cheng-iccrg-delivery-rate-estimation). each
+ * packet remembers how much had been delivered, and when, at the time it
+ * was sent. its ack then gives the bytes delivered over the interval the
+ * packet spent in flight, and the rate is those bytes over the longer of
+ * the send and the ack interval, which hides ack compression.
+ *
+ * a sample taken while the sender ran out of data is flagged app limited,
+ * it shows what the app offered rather than what the path can carry.
+ */
+#define GQUIC_PACKET_RATE_SAMPLER_BW_FILTER_ROUNDS 10
+
+typedef struct gquic_packet_rate_sample_s gquic_packet_rate_sample_t;
+struct gquic_packet_rate_sample_s {
+    u_int64_t delivery_rate; // bytes/s, 0 when the ack gave no valid sample
+    u_int64_t delivered;
+    u_int64_t interval;
+    u_int64_t prior_delivered;
+    u_int64_t prior_time;
+    u_int64_t send_elapsed;
+    u_int64_t ack_elapsed;
+    int is_app_limited;
+};
+
+int gquic_packet_rate_sample_init(gquic_packet_rate_sample_t *const sample);
+
+typedef struct gquic_packet_rate_stats_s gquic_packet_rate_stats_t;
+struct gquic_packet_rate_stats_s {
+    u_int64_t bandwidth; // max delivery rate over the last rounds
+    u_int64_t latest_rate;
+    u_int64_t latest_interval;
+    int latest_app_limited;
+    u_int64_t delivered;
+    u_int64_t round_count;
+    u_int64_t samples;
+    u_int64_t app_limited_samples;
+};
+
+typedef struct gquic_packet_rate_sampler_s gquic_packet_rate_sampler_t;
+struct gquic_packet_rate_sampler_s {
+    u_int64_t delivered;
+    u_int64_t delivered_time;
+    u_int64_t first_sent_time;
+    // delivered count that ends the app limited phase, 0 when not app limited
+    u_int64_t app_limited;
+
+    // the sample being built from the packets of the current ack
+    int has_sample;
+    gquic_packet_rate_sample_t sample;
+
+    u_int64_t round_count;
+    u_int64_t next_round_delivered;
+    gquic_max_filter_t bw_filter;
+
+    gquic_packet_rate_sample_t latest;
+    u_int64_t samples;
+    u_int64_t app_limited_samples;
+};
+
+int gquic_packet_rate_sampler_init(gquic_packet_rate_sampler_t *const sampler);
+int gquic_packet_rate_sampler_on_packet_sent(gquic_packet_rate_sampler_t *const sampler,
+                                             gquic_packet_t *const packet,
+                                             const u_int64_t prior_infly);
+int gquic_packet_rate_sampler_on_packet_acked(gquic_packet_rate_sampler_t *const sampler,
+                                              const gquic_packet_t *const packet,
+                                              const u_int64_t now);
+int gquic_packet_rate_sampler_on_app_limited(gquic_packet_rate_sampler_t *const sampler, const u_int64_t infly);
+int gquic_packet_rate_sampler_generate(gquic_packet_rate_sample_t *const sample,
+                                       gquic_packet_rate_sampler_t *const sampler,
+                                       const u_int64_t min_rtt);
+int gquic_packet_rate_sampler_stats(gquic_packet_rate_stats_t *const stats, const gquic_packet_rate_sampler_t *const sampler);
+
+static inline u_int64_t gquic_packet_rate_sampler_bandwidth(const gquic_packet_rate_sampler_t *const sampler) {
+    if (sampler == NULL) {
+        return 0;
+    }
+    return gquic_max_filter_get(&sampler->bw_filter);
+}
+
+#endif
@@ -11,6 +11,8 @@ typedef struct gquic_received_packet_s gquic_received_packet_t;
 struct gquic_received_packet_s {
     gquic_net_addr_t remote_addr;
     u_int64_t recv_time;
+    // ECN codepoint of the IP header, GQUIC_NET_ECN_*
+    u_int8_t ecn;
     gquic_str_t data;
     gquic_str_t dst_conn_id;
 
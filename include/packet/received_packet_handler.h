@@ -5,6 +5,7 @@
 #include "util/list.h"
 #include "util/rtt.h"
 #include "frame/ack.h"
+#include "frame/ack_frequency.h"
 
 typedef struct gquic_packet_interval_s gquic_packet_interval_t;
 struct gquic_packet_interval_s {
@@ -12,10 +13,27 @@ struct gquic_packet_interval_s {
     u_int64_t end;
 };
 
+/*
+ * received packet numbers are kept as a sorted array of disjoint ranges,
+ * updated as each packet arrives, so an ACK frame is copied straight out of
+ * it. a bitmap window anchored at the largest received packet number
+ * (bit i <=> largest - i) answers duplicate checks without a search. the
+ * array keeps as many ranges below the window as the old interval list did
+ * (500) plus room for every other packet inside it; only the oldest range is
+ * dropped when it fills. nothing here allocates.
+ */
+#define GQUIC_PACKET_RECEIVED_MEM_WINDOW 256
+#define GQUIC_PACKET_RECEIVED_MEM_MAX_INTERVALS (500 + GQUIC_PACKET_RECEIVED_MEM_WINDOW / 2)
+
 typedef struct gquic_packet_received_mem_s gquic_packet_received_mem_t;
 struct gquic_packet_received_mem_s {
-    int ranges_count;
-    gquic_list_t ranges;
+    int received;
+    u_int64_t largest;
+    u_int64_t window[GQUIC_PACKET_RECEIVED_MEM_WINDOW / 64];
+
+    int intervals_count;
+    gquic_packet_interval_t intervals[GQUIC_PACKET_RECEIVED_MEM_MAX_INTERVALS]; /* ascending */
+
     u_int64_t deleted_below;
 };
 
@@ -23,9 +41,25 @@ int gquic_packet_received_mem_init(gquic_packet_received_mem_t *const mem);
 int gquic_packet_received_mem_dtor(gquic_packet_received_mem_t *const mem);
 int gquic_packet_reveived_mem_received(gquic_packet_received_mem_t *const mem, const u_int64_t pn);
 int gquic_packet_received_mem_delete_below(gquic_packet_received_mem_t *const mem, const u_int64_t pn);
-int gquic_packet_received_mem_get_blocks(gquic_list_t *const blocks,
-                                         const gquic_packet_received_mem_t *const mem);
+int gquic_packet_received_mem_contains(const gquic_packet_received_mem_t *const mem, const u_int64_t pn);
+int gquic_packet_received_mem_empty(const gquic_packet_received_mem_t *const mem);
+u_int64_t gquic_packet_received_mem_highest_range_start(const gquic_packet_received_mem_t *const mem);
+int gquic_packet_received_mem_fill_ack_frame(gquic_frame_ack_t *const ack, const gquic_packet_received_mem_t *const mem);
 
+/*
+ * without an ACK_FREQUENCY from the peer, ack-eliciting packets are acked every
+ * second one early on and every tenth one later. once the peer asks for a
+ * threshold and a max ack delay, those are honoured instead, and a gap of
+ * reordering_threshold packets below the largest received one (0 turns this
+ * off) still gets an immediate ACK. the smallest delay we accept is sent to
+ * the peer as min_ack_delay.
+ *
+ * the ECN codepoints of the packets received in the number space are counted
+ * once per packet number, and once any is non zero ACKs go out as ACK_ECN
+ * carrying them. a CE marked ack-eliciting packet is acked at once, so the
+ * peer can react to the congestion within a round trip.
+ */
+#define GQUIC_PACKET_RECEIVED_MIN_ACK_DELAY 1000
 
 typedef struct gquic_packet_received_packet_handler_s gquic_packet_received_packet_handler_t;
 struct gquic_packet_received_packet_handler_s {
@@ -41,7 +75,15 @@ struct gquic_packet_received_packet_handler_s {
     } since_last_ack;
     int ack_queued;
     u_int64_t ack_alarm;
-    gquic_frame_ack_t *last_ack;
+    int has_last_ack;
+    u_int64_t last_ack_largest;
+
+    int ack_frequency_set;
+    u_int64_t ack_frequency_seq;
+    u_int64_t ack_eliciting_threshold;
+    u_int64_t reordering_threshold;
+
+    gquic_frame_ack_ecn_t ecn;
 };
 
 int gquic_packet_received_packet_handler_init(gquic_packet_received_packet_handler_t *const handler);
@@ -51,9 +93,13 @@ int gquic_packet_received_packet_handler_dtor(gquic_packet_received_packet_handl
 int gquic_packet_received_packet_handler_received_packet(gquic_packet_received_packet_handler_t *const handler,
                                                          const u_int64_t pn,
                                                          const u_int64_t recv_time,
-                                                         const int should_inst_ack);
+                                                         const int should_inst_ack,
+                                                         const u_int8_t ecn);
 int gquic_packet_received_packet_handler_get_ack_frame(gquic_frame_ack_t **const ack,
-                                                       gquic_packet_received_packet_handler_t *const handler);
+                                                       gquic_packet_received_packet_handler_t *const handler,
+                                                       const int only_if_queued);
+int gquic_packet_received_packet_handler_set_ack_frequency(gquic_packet_received_packet_handler_t *const handler,
+                                                           const gquic_frame_ack_frequency_t *const frame);
 int gquic_packet_received_packet_handler_ignore_below(gquic_packet_received_packet_handler_t *const handler,
                                                       const u_int64_t pn);
 
@@ -76,7 +122,8 @@ int gquic_packet_received_packet_handlers_received_packet(gquic_packet_received_
                                                           const u_int64_t pn,
                                                           const u_int64_t recv_time,
                                                           const int should_inst_ack,
-                                                          const u_int8_t enc_lv);
+                                                          const u_int8_t enc_lv,
+                                                          const u_int8_t ecn);
 int gquic_packet_received_packet_handlers_ignore_below(gquic_packet_received_packet_handlers_t *const handlers,
                                                        const u_int64_t pn);
 int gquic_packet_received_packet_handlers_drop_packets(gquic_packet_received_packet_handlers_t *const handlers,
@@ -84,6 +131,10 @@ int gquic_packet_received_packet_handlers_drop_packets(gquic_packet_received_pac
 u_int64_t gquic_packet_received_packet_handlers_get_alarm_timeout(gquic_packet_received_packet_handlers_t *const handlers);
 int gquic_packet_received_packet_handlers_get_ack_frame(gquic_frame_ack_t **const ack,
                                                         gquic_packet_received_packet_handlers_t *const handlers,
-                                                        const u_int8_t enc_lv);
+                                                        const u_int8_t enc_lv,
+                                                        const int only_if_queued);
+int gquic_packet_received_packet_handlers_set_ack_frequency(gquic_packet_received_packet_handlers_t *const handlers,
+                                                            const gquic_frame_ack_frequency_t *const frame);
+int gquic_packet_received_packet_handlers_immediate_ack(gquic_packet_received_packet_handlers_t *const handlers);
 
 #endif
@@ -0,0 +1,89 @@
+#ifndef _LIBGQUIC_PACKET_RETRY_POLICY_H
+#define _LIBGQUIC_PACKET_RETRY_POLICY_H
+
+#include "handshake/token_generator.h"
+#include "net/addr.h"
+#include "util/str.h"
+#include "util/version.h"
+#include <semaphore.h>
+
+/*
+ * server side Retry decision for Initials that belong to no session yet.
+ * while the server is not under load every client gets a session right
+ * away. once the number of half-open sessions or the process CPU load
+ * crosses its limit, clients without a valid token are answered with a
+ * stateless Retry instead, which costs one packet and no session state, so
+ * a flood from spoofed addresses never gets past it. the policy leaves
+ * Retry mode again once both have dropped to 3/4 of their limits.
+ *
+ * on_initial belongs in the server's unknown packet handler
+ * (gquic_packet_handler_map_t.server), called for each Initial that matches
+ * no session before one is created for it: a RETRY decision sends its packet
+ * back and drops the Initial, an ACCEPT one creates the session.
+ */
+#define GQUIC_PACKET_RETRY_POLICY_DEFAULT_HALF_OPEN_LIMIT 1024
+#define GQUIC_PACKET_RETRY_POLICY_DEFAULT_CPU_LIMIT 0.75
+#define GQUIC_PACKET_RETRY_POLICY_CPU_SAMPLE_INTERVAL (100 * 1000)
+
+#define GQUIC_PACKET_RETRY_POLICY_ACCEPT 0
+#define GQUIC_PACKET_RETRY_POLICY_RETRY 1
+
+typedef struct gquic_packet_retry_decision_s gquic_packet_retry_decision_t;
+struct gquic_packet_retry_decision_s {
+    gquic_str_t odcid; /* ACCEPT after a Retry: the client's first destination conn ID */
+    gquic_str_t packet; /* RETRY: the Retry packet to send back */
+};
+
+int gquic_packet_retry_decision_init(gquic_packet_retry_decision_t *const decision);
+int gquic_packet_retry_decision_dtor(gquic_packet_retry_decision_t *const decision);
+
+typedef struct gquic_packet_retry_policy_s gquic_packet_retry_policy_t;
+struct gquic_packet_retry_policy_s {
+    sem_t mtx;
+    gquic_handshake_token_generator_t *token_generator;
+    int conn_id_len;
+    u_int64_t half_open_limit; /* 0 never retries on the half-open count */
+    double cpu_limit; /* share of all cores, 0 never retries on CPU load */
+
+    int retrying;
+    u_int64_t half_open;
+    double cpu_load;
+    u_int64_t sampled_at;
+    u_int64_t sampled_cpu;
+    long cores;
+
+    u_int64_t retries;
+    u_int64_t retried_accepted;
+};
+
+int gquic_packet_retry_policy_init(gquic_packet_retry_policy_t *const policy);
+int gquic_packet_retry_policy_ctor(gquic_packet_retry_policy_t *const policy,
+                                   gquic_handshake_token_generator_t *const token_generator,
+                                   const int conn_id_len,
+                                   const u_int64_t half_open_limit,
+                                   const double cpu_limit);
+int gquic_packet_retry_policy_dtor(gquic_packet_retry_policy_t *const policy);
+int gquic_packet_retry_policy_on_initial(gquic_packet_retry_decision_t *const decision,
+                                         gquic_packet_retry_policy_t *const policy,
+                                         const gquic_str_t *const data,
+                                         const gquic_net_addr_t *const addr,
+                                         const u_int64_t now);
+int gquic_packet_retry_policy_handshake_started(gquic_packet_retry_policy_t *const policy);
+int gquic_packet_retry_policy_handshake_finished(gquic_packet_retry_policy_t *const policy);
+/*
+ * the Retry Integrity Tag (RFC 9001, 5.8) over the Retry packet without
+ * its tag, keyed by the version; the client checks it against the
+ * destination conn ID of its first Initial.
+ */
+int gquic_packet_retry_integrity_tag(u_int8_t *const tag,
+                                     const gquic_version_t version,
+                                     const gquic_str_t *const odcid,
+                                     const gquic_str_t *const retry);
+int gquic_packet_retry_pack(gquic_str_t *const packet,
+                            const gquic_version_t version,
+                            const gquic_str_t *const dcid,
+                            const gquic_str_t *const scid,
+                            const gquic_str_t *const odcid,
+                            const gquic_str_t *const token);
+
+#endif
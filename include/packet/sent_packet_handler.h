@@ -4,28 +4,87 @@
 #include "packet/packet.h"
 #include "packet/packet_number.h"
 #include "util/list.h"
-#include "util/rbtree.h"
-#include "cong/cubic.h"
+#include "cong/cong.h"
+#include "packet/rate_sampler.h"
+#include "packet/pacer.h"
+#include "packet/ecn.h"
 #include "event/event.h"
 #include "frame/ack.h"
 
+/*
+ * outstanding packets of one packet number space, in a ring indexed by
+ * packet number: slot pn & (cap - 1) for pn in [smallest, end). sending,
+ * looking up and removing a packet are O(1) and cost one pointer per slot;
+ * the ring doubles when the window outgrows it. acked and lost packets
+ * leave empty slots until the oldest outstanding packet moves past them.
+ * the packet records and their frame lists are still allocated one by one
+ * by the caller, they are most of the memory of a tracked packet.
+ */
 typedef struct gquic_packet_sent_mem_s gquic_packet_sent_mem_t;
 struct gquic_packet_sent_mem_s {
-    int count;
-    gquic_list_t list; /* gquic_packet_t * */
-    gquic_rbtree_t *root;
+    u_int64_t count;
+    gquic_packet_t **slots;
+    u_int64_t cap;
+    u_int64_t smallest;
+    u_int64_t end;
 };
 
+#define GQUIC_PACKET_SENT_MEM_INIT_CAP 64
+#define GQUIC_PACKET_SENT_MEM_SLOT(mem, pn) ((mem)->slots[(pn) & ((mem)->cap - 1)])
+#define GQUIC_PACKET_SENT_MEM_FOREACH(packet, pn, mem) \
+    for ((pn) = (mem)->smallest; (pn) < (mem)->end; (pn)++) \
+        if (((packet) = GQUIC_PACKET_SENT_MEM_SLOT((mem), (pn))) != NULL)
+
 int gquic_packet_sent_mem_init(gquic_packet_sent_mem_t *const mem);
 int gquic_packet_sent_mem_dtor(gquic_packet_sent_mem_t *const mem);
 int gquic_packet_sent_mem_sent_packet(gquic_packet_sent_mem_t *const mem, const gquic_packet_t *const packet);
 int gquic_packet_sent_mem_get_packet(const gquic_packet_t **const packet, gquic_packet_sent_mem_t *const mem, const u_int64_t pn);
 int gquic_packet_sent_mem_remove(gquic_packet_sent_mem_t *const mem, const u_int64_t pn, int (*release_packet_func) (gquic_packet_t *const));
+gquic_packet_t *gquic_packet_sent_mem_first(const gquic_packet_sent_mem_t *const mem);
+
+/*
+ * a packet declared lost is remembered for three PTOs. an ack for it in
+ * that time shows the loss was reordering: the reordering thresholds grow
+ * to cover it and the congestion controller undoes its response.
+ */
+typedef struct gquic_packet_sent_lost_s gquic_packet_sent_lost_t;
+struct gquic_packet_sent_lost_s {
+    u_int64_t pn;
+    u_int64_t len;
+    u_int64_t send_time;
+    u_int64_t lost_time;
+    int included_infly;
+    int acked;
+};
+
+/*
+ * losses are declared in packet number order, so the records sit sorted in
+ * a ring: an ack block finds its lost packets by binary search, and the
+ * oldest expire from the front by lost time. a record acked in the middle
+ * is marked and dropped once it reaches the front.
+ */
+typedef struct gquic_packet_sent_lost_mem_s gquic_packet_sent_lost_mem_t;
+struct gquic_packet_sent_lost_mem_s {
+    gquic_packet_sent_lost_t *records;
+    u_int64_t cap;
+    u_int64_t head;
+    u_int64_t count;
+};
+
+#define GQUIC_PACKET_SENT_LOST_MEM_INIT_CAP 16
+#define GQUIC_PACKET_SENT_LOST_MEM_AT(mem, i) ((mem)->records[((mem)->head + (i)) & ((mem)->cap - 1)])
+
+int gquic_packet_sent_lost_mem_init(gquic_packet_sent_lost_mem_t *const mem);
+int gquic_packet_sent_lost_mem_dtor(gquic_packet_sent_lost_mem_t *const mem);
+int gquic_packet_sent_lost_mem_add(gquic_packet_sent_lost_mem_t *const mem, const gquic_packet_sent_lost_t *const lost);
+int gquic_packet_sent_lost_mem_expire(gquic_packet_sent_lost_mem_t *const mem, const u_int64_t lost_before);
+u_int64_t gquic_packet_sent_lost_mem_lower_bound(const gquic_packet_sent_lost_mem_t *const mem, const u_int64_t pn);
 
 typedef struct gquic_packet_sent_pn_s gquic_packet_sent_pn_t;
 struct gquic_packet_sent_pn_s {
     gquic_packet_sent_mem_t mem;
     gquic_packet_number_gen_t pn_gen;
+    gquic_packet_sent_lost_mem_t lost;
 
     u_int64_t loss_time;
     u_int64_t last_sent_ack_time;
@@ -38,21 +97,51 @@ int gquic_packet_sent_pn_init(gquic_packet_sent_pn_t *const sent_pn);
 int gquic_packet_sent_pn_ctor(gquic_packet_sent_pn_t *const sent_pn, const u_int64_t init_pn);
 int gquic_packet_sent_pn_dtor(gquic_packet_sent_pn_t *const sent_pn);
 
+/*
+ * how many packets may be outstanding follows the congestion window, the
+ * ring above keeps the per packet cost flat however large it gets.
+ */
+#define GQUIC_PACKET_SENT_PACKET_HANDLER_MIN_TRACKED 2000
+#define GQUIC_PACKET_SENT_PACKET_HANDLER_DEFAULT_MAX_CWND (10000 * 1460)
+
+/*
+ * a packet is lost once a packet sent reordering_threshold packets after it
+ * is acked, or once it has been out for max(srtt, latest rtt) plus that rtt
+ * >> reordering_shift. both start at RFC 9002's 3 packets and 9/8 rtt and
+ * grow with every spurious loss to cover the reordering seen.
+ */
+#define GQUIC_PACKET_SENT_PACKET_HANDLER_PACKET_THRESHOLD 3
+#define GQUIC_PACKET_SENT_PACKET_HANDLER_MAX_PACKET_THRESHOLD 256
+#define GQUIC_PACKET_SENT_PACKET_HANDLER_TIME_THRESHOLD_SHIFT 3
+
 typedef struct gquic_packet_sent_packet_handler_s gquic_packet_sent_packet_handler_t;
 struct gquic_packet_sent_packet_handler_s {
-    u_int64_t next_send_time;
     gquic_packet_sent_pn_t *initial_packets;
     gquic_packet_sent_pn_t *handshake_packets;
     gquic_packet_sent_pn_t *one_rtt_packets;
     int handshake_complete;
     u_int64_t lowest_not_confirm_acked;
     u_int64_t infly_bytes;
-    gquic_cong_cubic_t cong;
+    gquic_cong_t cong;
+    gquic_packet_rate_sampler_t rate_sampler;
+    gquic_packet_pacer_t pacer;
+    // the kernel paces: packets get departure times, the sender never waits on the pacer
+    int txtime;
+    // ack-eliciting 1-RTT packets carry ECT(0) while the path passes validation
+    gquic_packet_ecn_t ecn;
     gquic_rtt_t *rtt;
     u_int32_t pto_count;
     u_int8_t pto_mode;
     int num_probes_to_send;
     u_int64_t alarm;
+    u_int64_t reordering_threshold;
+    u_int8_t reordering_shift;
+    u_int64_t spurious_losses;
+
+    // a server sends at most 3x what it received until the client address is validated
+    int peer_addr_validated;
+    u_int64_t bytes_received;
+    u_int64_t bytes_sent;
     struct {
         void *self;
         int (*cb)(void *const, gquic_event_t *const);
@@ -65,6 +154,8 @@ int gquic_packet_sent_packet_handler_init(gquic_packet_sent_packet_handler_t *co
 int gquic_packet_sent_packet_handler_ctor(gquic_packet_sent_packet_handler_t *const handler,
                                           const u_int64_t initial_pn,
                                           gquic_rtt_t *const rtt,
+                                          const int cong_algo,
+                                          const u_int64_t max_cwnd,
                                           void *const event_self,
                                           int (*event_cb)(void *const, gquic_event_t *const));
 int gquic_packet_sent_packet_handler_dtor(gquic_packet_sent_packet_handler_t *const handler);
@@ -83,9 +174,22 @@ int gquic_packet_sent_packet_handler_peek_pn(u_int64_t *const pn,
                                              const u_int8_t enc_lv);
 int gquic_packet_sent_packet_handler_pop_pn(u_int64_t *const ret, gquic_packet_sent_packet_handler_t *const handler, const u_int8_t enc_lv);
 u_int8_t gquic_packet_sent_packet_handler_send_mode(gquic_packet_sent_packet_handler_t *const handler);
-int gquic_packet_sent_packet_handler_should_send_packets_count(gquic_packet_sent_packet_handler_t *const handler);
+int gquic_packet_sent_packet_handler_should_send_packets_count(gquic_packet_sent_packet_handler_t *const handler, const u_int64_t now);
+u_int64_t gquic_packet_sent_packet_handler_next_send_time(gquic_packet_sent_packet_handler_t *const handler, const u_int64_t now);
+int gquic_packet_sent_packet_handler_set_pacing(gquic_packet_sent_packet_handler_t *const handler,
+                                                const u_int64_t max_datagram_size,
+                                                const u_int64_t burst_packets,
+                                                const u_int64_t gso_segments);
+int gquic_packet_sent_packet_handler_set_txtime(gquic_packet_sent_packet_handler_t *const handler, const int txtime);
+int gquic_packet_sent_packet_handler_enable_ecn(gquic_packet_sent_packet_handler_t *const handler);
+u_int64_t gquic_packet_sent_packet_handler_allowable_packets_count(gquic_packet_sent_packet_handler_t *const handler, const u_int64_t packet_size);
+int gquic_packet_sent_packet_handler_set_app_limited(gquic_packet_sent_packet_handler_t *const handler);
+int gquic_packet_sent_packet_handler_rate_stats(gquic_packet_rate_stats_t *const stats, const gquic_packet_sent_packet_handler_t *const handler);
 int gquic_packet_sent_packet_handler_queue_probe_packet(gquic_packet_sent_packet_handler_t *const handler, const u_int8_t enc_lv);
 int gquic_packet_sent_packet_handler_reset_for_retry(gquic_packet_sent_packet_handler_t *const handler);
+int gquic_packet_sent_packet_handler_reset_for_0rtt_reject(gquic_packet_sent_packet_handler_t *const handler);
 int gquic_packet_sent_packet_handler_set_handshake_complete(gquic_packet_sent_packet_handler_t *const handler);
+int gquic_packet_sent_packet_handler_received_bytes(gquic_packet_sent_packet_handler_t *const handler, const u_int64_t n);
+int gquic_packet_sent_packet_handler_set_peer_addr_validated(gquic_packet_sent_packet_handler_t *const handler);
 
 #endif
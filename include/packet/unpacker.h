@@ -11,8 +11,8 @@ struct gquic_unpacked_packet_payload_s {
         int is_1rtt;
         void *self;
         union {
-            int (*cb) (gquic_str_t *const, void *const, const u_int64_t, const gquic_str_t *const, const gquic_str_t *const, const gquic_str_t *const);
-            int (*one_rtt_cb) (gquic_str_t *const, void *const, const u_int64_t, const u_int64_t, const int, const gquic_str_t *const, const gquic_str_t *const, const gquic_str_t *const);
+            int (*cb) (gquic_str_t *const, void *const, const u_int64_t, const gquic_str_t *const, const gquic_str_t *const);
+            int (*one_rtt_cb) (gquic_str_t *const, void *const, const u_int64_t, const u_int64_t, const int, const gquic_str_t *const, const gquic_str_t *const);
         } cb;
     } opener;
     const gquic_str_t *data;
@@ -20,10 +20,10 @@ struct gquic_unpacked_packet_payload_s {
     u_int64_t recv_time;
 };
 
-#define GQUIC_UNPACKED_PACKET_PAYLOAD_OPEN(plain_text, payload, recv_time, pn, kp, tag, cipher_text, addata) \
+#define GQUIC_UNPACKED_PACKET_PAYLOAD_OPEN(text, payload, recv_time, pn, kp, tag, addata) \
     ((payload)->opener.is_1rtt \
-     ? ((payload)->opener.cb.one_rtt_cb((plain_text), (payload)->opener.self, (recv_time), (pn), (kp), (tag), (cipher_text), (addata)))\
-     : ((payload)->opener.cb.cb((plain_text), (payload)->opener.self, (pn), (tag), (cipher_text), (addata))))
+     ? ((payload)->opener.cb.one_rtt_cb((text), (payload)->opener.self, (recv_time), (pn), (kp), (tag), (addata)))\
+     : ((payload)->opener.cb.cb((text), (payload)->opener.self, (pn), (tag), (addata))))
 
 int gquic_unpacked_packet_payload_init(gquic_unpacked_packet_payload_t *const payload);
 
@@ -33,7 +33,7 @@ struct gquic_unpacked_packet_s {
     u_int64_t pn;
     gquic_packet_header_t hdr;
     u_int8_t enc_lv;
-    gquic_str_t data;
+    gquic_str_t data; /* decrypted in place, points into the received packet */
 };
 
 int gquic_unpacked_packet_init(gquic_unpacked_packet_t *const unpacked_packet);
@@ -52,7 +52,6 @@ struct gquic_session_s {
     gquic_wnd_update_queue_t wnd_update_queue;
     gquic_flowcontrol_conn_flow_ctrl_t conn_flow_ctrl;
     gquic_str_t token_store_key;
-    // TODO token generator
     
     gquic_packet_packer_t packer;
     gquic_packet_unpacker_t unpacker;
@@ -65,6 +64,7 @@ struct gquic_session_s {
     gquic_list_t undecryptable_packets; /* received_packet * */
 
     int handshake_completed;
+    int half_open;
 
     int received_retry;
     int received_first_packet;
@@ -74,6 +74,7 @@ struct gquic_session_s {
     u_int64_t last_packet_received_time;
     u_int64_t first_ack_eliciting_packet;
     u_int64_t pacing_deadline;
+    u_int64_t drop_0rtt_keys_time;
     
     int peer_params_seted;
     gquic_transport_parameters_t peer_params;
@@ -83,6 +84,14 @@ struct gquic_session_s {
     int keep_alive_ping_sent;
     u_int64_t keep_alive_interval;
 
+    // the last ACK_FREQUENCY sent to the peer, seq is the next sequence number
+    struct {
+        u_int64_t seq;
+        u_int64_t ack_eliciting_threshold;
+        u_int64_t max_ack_delay;
+        u_int64_t reordering_threshold;
+    } ack_frequency;
+
     gquic_packet_handler_map_t *runner;
     gquic_crypto_stream_t initial_stream;
     gquic_crypto_stream_t handshake_stream;
@@ -108,12 +117,14 @@ int gquic_session_ctor(gquic_session_t *const sess,
                        const gquic_str_t *const src_conn_id,
                        const gquic_str_t *const stateless_reset_token,
                        gquic_config_t *const cfg,
+                       const gquic_version_t version,
                        const u_int64_t initial_pn,
                        const int is_client);
 int gquic_session_handle_packet(gquic_session_t *const sess, gquic_received_packet_t *const rp);
 int gquic_session_close(gquic_session_t *const sess);
 int gquic_session_destroy(gquic_session_t *const sess, const int err);
 int gquic_session_queue_control_frame(gquic_session_t *const sess, void *const frame);
+int gquic_session_rate_stats(gquic_packet_rate_stats_t *const stats, gquic_session_t *const sess);
 int gquic_session_run(gquic_session_t *const sess);
 
 #endif
@@ -6,11 +6,11 @@
 #include "streams/framer.h"
 #include "util/str.h"
 
+#define GQUIC_CRYPTO_STREAM_MAX_OFF (16 * (1 << 10))
+
 typedef struct gquic_crypto_stream_s gquic_crypto_stream_t;
 struct gquic_crypto_stream_s {
     gquic_frame_sorter_t sorter;
-    gquic_reader_str_t in_reader;
-    gquic_str_t in_buf;
 
     u_int64_t highest_off;
     int finished;
@@ -24,5 +24,6 @@ int gquic_framer_queue_ctrl_frame(gquic_framer_t *const framer, void *const fram
 int gquic_framer_append_ctrl_frame(gquic_list_t *const frames, u_int64_t *const length, gquic_framer_t *const framer, const u_int64_t max_len);
 int gquic_framer_add_active_stream(gquic_framer_t *const framer, const u_int64_t id);
 int gquic_framer_append_stream_frames(gquic_list_t *const frames, u_int64_t *const length, gquic_framer_t *const framer, const u_int64_t max_len);
+int gquic_framer_has_data(gquic_framer_t *const framer);
 
 #endif
@@ -17,13 +17,6 @@ struct gquic_recv_stream_s {
     gquic_frame_sorter_t frame_queue;
     u_int64_t read_off;
     u_int64_t final_off;
-    gquic_str_t cur_frame;
-    struct {
-        void *self;
-        int (*cb) (void *const);
-    } cur_frame_done_cb;
-    int cur_frame_is_last;
-    int frame_read_pos;
     int close_for_shutdown_reason;
     int cancel_read_reason;
     int reset_remote_reason;
@@ -0,0 +1,48 @@
+#ifndef _LIBGQUIC_TLS_ANTI_REPLAY_H
+#define _LIBGQUIC_TLS_ANTI_REPLAY_H
+
+#include "util/str.h"
+#include <sys/types.h>
+#include <semaphore.h>
+
+/*
+ * server side 0-RTT replay protection. early data is only accepted when the
+ * ticket age the client reports is within window / 2 of the age the server
+ * computes, so a replayed ClientHello falls out of the window at most
+ * window ms after the original. with cap != 0 every accepted ticket is also
+ * remembered for that long (two generations of a hash set, rotated each
+ * window), which makes each ticket single-use for early data. with cap == 0
+ * only the time window applies. when a generation fills up early data is
+ * rejected, the handshake itself goes on as 1-RTT.
+ */
+#define GQUIC_TLS_ANTI_REPLAY_DEFAULT_WINDOW 10000
+
+#define GQUIC_TLS_ANTI_REPLAY_ACCEPT 0
+#define GQUIC_TLS_ANTI_REPLAY_STALE -2
+#define GQUIC_TLS_ANTI_REPLAY_REPLAYED -3
+#define GQUIC_TLS_ANTI_REPLAY_FULL -4
+
+typedef struct gquic_tls_anti_replay_s gquic_tls_anti_replay_t;
+struct gquic_tls_anti_replay_s {
+    sem_t mtx;
+    u_int64_t window;
+    size_t cap;
+    size_t count;
+    u_int64_t *seen[2]; /* [0] current generation, [1] previous one */
+    u_int64_t rotated_at;
+
+    u_int64_t accepted;
+    u_int64_t stale;
+    u_int64_t replayed;
+    u_int64_t full;
+};
+
+int gquic_tls_anti_replay_init(gquic_tls_anti_replay_t *const ar);
+int gquic_tls_anti_replay_ctor(gquic_tls_anti_replay_t *const ar, const u_int64_t window, const size_t cap);
+int gquic_tls_anti_replay_dtor(gquic_tls_anti_replay_t *const ar);
+int gquic_tls_anti_replay_check(gquic_tls_anti_replay_t *const ar,
+                                const gquic_str_t *const ticket,
+                                const int64_t age_skew,
+                                const u_int64_t now);
+
+#endif
@@ -15,6 +15,7 @@ int gquic_tls_selected_sigalg(u_int16_t *const sigalg,
                               const u_int16_t tls_ver);
 
 int gquic_tls_verify_handshake_sign(const EVP_MD *const hash,
+                                    const u_int8_t sig_type,
                                     EVP_PKEY *const pubkey,
                                     const gquic_str_t *sign,
                                     const gquic_str_t *sig);
@@ -47,30 +47,47 @@
 typedef struct gquic_tls_aead_s gquic_tls_aead_t;
 struct gquic_tls_aead_s {
     void *self;
+    /*
+     * seal and open work in place: text is encrypted / decrypted where it is.
+     * seal writes the tag into the caller's buffer (tag->size must be at
+     * least GQUIC_TLS_AEAD_TAG_SIZE and is set to it).
+     */
     int (*seal)(gquic_str_t *const,
                 gquic_str_t *const,
                 void *const,
                 const gquic_str_t *const,
-                const gquic_str_t *const,
                 const gquic_str_t *const);
     int (*open)(gquic_str_t *const,
                 void *const,
                 const gquic_str_t *const,
                 const gquic_str_t *const,
-                const gquic_str_t *const,
                 const gquic_str_t *const);
+    /* seals count packets in place, with the same arguments as seal in arrays */
+    int (*seal_batch)(gquic_str_t *const,
+                      gquic_str_t *const,
+                      void *const,
+                      const gquic_str_t *const,
+                      const gquic_str_t *const,
+                      const size_t);
     int (*dtor) (void *const);
 };
 
-#define GQUIC_TLS_AEAD_SEAL(tag, cipher_text, aead, nonce, plain_text, addata) \
+#define GQUIC_TLS_AEAD_TAG_SIZE 16
+#define GQUIC_TLS_AEAD_MAX_BATCH 64
+
+#define GQUIC_TLS_AEAD_SEAL(tag, text, aead, nonce, addata) \
     (((aead)->seal) == NULL \
     ? -1 \
-    : ((aead)->seal((tag), (cipher_text), (aead)->self, (nonce), (plain_text), (addata))))
+    : ((aead)->seal((tag), (text), (aead)->self, (nonce), (addata))))
 
-#define GQUIC_TLS_AEAD_OPEN(plain_text, aead, nonce, tag, cipher_text, addata) \
+#define GQUIC_TLS_AEAD_OPEN(text, aead, nonce, tag, addata) \
     (((aead)->open) == NULL \
      ? -1 \
-     : ((aead)->open((plain_text), (aead)->self, (nonce), (tag), (cipher_text), (addata))))
+     : ((aead)->open((text), (aead)->self, (nonce), (tag), (addata))))
+#define GQUIC_TLS_AEAD_SEAL_BATCH(tags, texts, aead, nonces, addatas, count) \
+    (((aead)->seal_batch) == NULL \
+     ? -1 \
+     : ((aead)->seal_batch((tags), (texts), (aead)->self, (nonces), (addatas), (count))))
 #define GQUIC_TLS_AEAD_DTOR(aead) \
     (((aead)->dtor) == NULL \
      ? -1 \
@@ -19,8 +19,23 @@ struct gquic_tls_client_sess_state_s {
     gquic_str_t nonce;
     time_t use_by;
     u_int32_t age_add;
+    u_int32_t max_early_data;
+    // the server's transport parameters, 0-RTT runs under them
+    gquic_str_t app_data;
 };
 
+int gquic_tls_client_sess_state_init(gquic_tls_client_sess_state_t *const state);
+int gquic_tls_client_sess_state_dtor(gquic_tls_client_sess_state_t *const state);
+int gquic_tls_client_sess_state_copy(gquic_tls_client_sess_state_t *const state, const gquic_tls_client_sess_state_t *const ref);
+gquic_tls_client_sess_state_t *gquic_tls_client_sess_state_alloc();
+int gquic_tls_client_sess_state_release(gquic_tls_client_sess_state_t *const state);
+
+/*
+ * get hands out a copy of the cached state which the caller releases with
+ * gquic_tls_client_sess_state_release, so the cache may evict or replace the
+ * entry at any time. put copies the state; a NULL state removes the key.
+ */
+
 typedef struct gquic_tls_client_sess_cache_s gquic_tls_client_sess_cache_t;
 struct gquic_tls_client_sess_cache_s {
     void *self;
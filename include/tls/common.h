@@ -85,6 +85,7 @@
 #define GQUIC_ENC_LV_HANDSHAKE 2
 #define GQUIC_ENC_LV_1RTT 3
 #define GQUIC_ENC_LV_APP 4
+#define GQUIC_ENC_LV_0RTT 5
 
 
 #define GQUIC_CLI_AUTH_REQ 0x01
@@ -11,6 +11,10 @@
 #include "tls/cert_req_msg.h"
 #include "tls/common.h"
 #include "tls/cipher_suite.h"
+#include "tls/sign_pool.h"
+#include "tls/key_share_pool.h"
+#include "tls/anti_replay.h"
+#include "tls/ticket_keys.h"
 
 typedef struct gquic_tls_record_layer_s gquic_tls_record_layer_t;
 struct gquic_tls_record_layer_s {
@@ -40,7 +44,6 @@ struct gquic_tls_config_s {
     u_int16_t min_v;
     u_int16_t max_v;
     int dynamic_record_sizing_disabled;
-    gquic_list_t sess_ticket_keys;
     int renegotiation;
     gquic_list_t curve_perfers;
     gquic_tls_client_sess_cache_t *cli_sess_cache;
@@ -50,6 +53,15 @@ struct gquic_tls_config_s {
     int (*verify_peer_certs) (const gquic_list_t *const, const gquic_list_t *const);
     int (*get_ser_cert) (gquic_str_t *const, const gquic_tls_client_hello_msg_t *const);
     int (*get_cli_cert) (gquic_str_t *const, const gquic_tls_cert_req_msg_t *const);
+    gquic_tls_signer_t signer;
+    gquic_tls_sign_pool_t *sign_pool;
+    gquic_tls_key_share_pool_t *key_share_pool;
+    // a server without one issues no session tickets
+    gquic_tls_ticket_keys_t *ticket_keys;
+    // 0-RTT stays off while 0; a server also puts it in its tickets
+    u_int32_t max_early_data;
+    // a server without one rejects all early data
+    gquic_tls_anti_replay_t *anti_replay;
     gquic_tls_record_layer_t alt_record;
     int enforce_next_proto_selection;
     u_int8_t cli_auth;
@@ -43,6 +43,14 @@ int gquic_tls_half_conn_set_traffic_sec(gquic_tls_half_conn_t *const half_conn,
                                         const gquic_str_t *const secret,
                                         int is_read);
 
+#define GQUIC_TLS_EARLY_DATA_NONE 0
+#define GQUIC_TLS_EARLY_DATA_OFFERED 1
+#define GQUIC_TLS_EARLY_DATA_ACCEPTED 2
+#define GQUIC_TLS_EARLY_DATA_REJECTED 3
+
+// the handshake went on in the background, on_handshake_done reports its end
+#define GQUIC_TLS_HANDSHAKE_PENDING 1
+
 typedef struct gquic_tls_conn_s gquic_tls_conn_t;
 struct gquic_tls_conn_s {
     const gquic_net_addr_t *addr;
@@ -70,9 +78,25 @@ struct gquic_tls_conn_s {
     int buffering;
     gquic_str_t cli_proto;
     int cli_proto_fallback;
+    u_int8_t early_data;
+    // client: the server's transport parameters, remembered with the tickets
+    gquic_str_t app_data;
     sem_t handshake_mtx;
+
+    // server: the handshake suspended on its CertificateVerify signature
+    struct gquic_tls_handshake_server_state_s *ser_state;
+    // set once the client's Finished (or a close) can be read without blocking
+    int resumed;
+    sem_t resume_mtx;
+    struct {
+        void *self;
+        int (*cb) (void *const, const int);
+    } on_handshake_done;
 };
 
+#define GQUIC_TLS_CONN_ON_HANDSHAKE_DONE(conn, ret) \
+    ((conn)->on_handshake_done.cb((conn)->on_handshake_done.self, (ret)))
+
 int gquic_tls_conn_init(gquic_tls_conn_t *const conn);
 
 int gquic_tls_conn_load_session(gquic_str_t *const cache_key,
@@ -90,6 +114,7 @@ int gquic_tls_conn_send_alert(gquic_tls_conn_t *const conn, u_int8_t alert);
 int gquic_tls_conn_verify_ser_cert(gquic_tls_conn_t *const conn, const gquic_list_t *const certs);
 
 int gquic_tls_conn_handshake(gquic_tls_conn_t *const conn);
+int gquic_tls_conn_handshake_resume(gquic_tls_conn_t *const conn);
 
 int gquic_tls_conn_decrypt_ticket(gquic_str_t *const plain, int *const is_oldkey, gquic_tls_conn_t *const conn, const gquic_str_t *const encrypted);
 int gquic_tls_conn_encrypt_ticket(gquic_str_t *const encrypted, gquic_tls_conn_t *const conn, const gquic_str_t *const state);
@@ -7,6 +7,7 @@
 typedef struct gquic_tls_encrypt_ext_msg_s gquic_tls_encrypt_ext_msg_t;
 struct gquic_tls_encrypt_ext_msg_s {
     gquic_str_t alpn_proto;
+    int early_data;
     gquic_list_t addition_exts;
 };
 
@@ -5,6 +5,8 @@
 #include "tls/server_hello_msg.h"
 #include "tls/cipher_suite.h"
 #include "tls/conn.h"
+#include "tls/cert_verify_msg.h"
+#include <openssl/evp.h>
 
 typedef struct gquic_tls_handshake_server_state_s gquic_tls_handshake_server_state_t;
 struct gquic_tls_handshake_server_state_s {
@@ -13,6 +15,7 @@ struct gquic_tls_handshake_server_state_s {
     gquic_tls_server_hello_msg_t *s_hello;
     int sent_dummy_ccs;
     int using_psk;
+    int early_data;
     const gquic_tls_cipher_suite_t *suite;
     gquic_str_t cert;
     u_int16_t sigalg;
@@ -23,12 +26,23 @@ struct gquic_tls_handshake_server_state_s {
     gquic_str_t traffic_sec;
     gquic_tls_mac_t transport;
     gquic_str_t cli_finished;
+    EVP_PKEY *pkey;
+
+    // a CertificateVerify signed on the sign pool suspends the handshake
+    u_int8_t stage;
+    gquic_tls_cert_verify_msg_t *verify_msg;
+    gquic_str_t signed_cnt;
 };
 
+#define GQUIC_TLS_SERVER_STAGE_RUNNING 0
+#define GQUIC_TLS_SERVER_STAGE_SIGNING 1
+#define GQUIC_TLS_SERVER_STAGE_WAIT_CLI_FINISHED 2
+
 int gquic_tls_handshake_server_state_init(gquic_tls_handshake_server_state_t *const ser_state);
 int gquic_tls_handshake_server_state_release(gquic_tls_handshake_server_state_t *const ser_state);
 
 int gquic_tls_server_handshake(gquic_tls_conn_t *const conn);
 int gquic_tls_server_handshake_state_handshake(gquic_tls_handshake_server_state_t *const ser_state);
+int gquic_tls_server_handshake_resume(gquic_tls_conn_t *const conn);
 
 #endif
@@ -0,0 +1,58 @@
+#ifndef _LIBGQUIC_TLS_KEY_SHARE_POOL_H
+#define _LIBGQUIC_TLS_KEY_SHARE_POOL_H
+
+#include "tls/key_schedule.h"
+#include "util/list.h"
+#include <pthread.h>
+#include <semaphore.h>
+
+/*
+ * pre-generated ephemeral ECDHE keys, one ring per curve. handshakes take a
+ * key instead of generating one; a background thread refills a ring once it
+ * drops below low_water. a take from an empty ring generates inline and is
+ * counted as starved.
+ */
+#define GQUIC_TLS_KEY_SHARE_POOL_MAX_CURVES 4
+#define GQUIC_TLS_KEY_SHARE_POOL_DEFAULT_CAP 64
+#define GQUIC_TLS_KEY_SHARE_POOL_DEFAULT_LOW_WATER 16
+
+typedef struct gquic_tls_key_share_pool_curve_s gquic_tls_key_share_pool_curve_t;
+struct gquic_tls_key_share_pool_curve_s {
+    u_int16_t curve_id;
+    gquic_tls_ecdhe_params_t *keys;
+    size_t head;
+    size_t count;
+
+    u_int64_t taken;
+    u_int64_t starved;
+};
+
+typedef struct gquic_tls_key_share_pool_s gquic_tls_key_share_pool_t;
+struct gquic_tls_key_share_pool_s {
+    sem_t mtx;
+    sem_t refill;
+    size_t cap;
+    size_t low_water;
+    size_t curves_count;
+    gquic_tls_key_share_pool_curve_t curves[GQUIC_TLS_KEY_SHARE_POOL_MAX_CURVES];
+
+    pthread_t thread;
+    int running;
+    int closed;
+};
+
+int gquic_tls_key_share_pool_init(gquic_tls_key_share_pool_t *const pool);
+int gquic_tls_key_share_pool_ctor(gquic_tls_key_share_pool_t *const pool,
+                                  gquic_list_t *const curve_perfers,
+                                  const size_t cap,
+                                  const size_t low_water);
+int gquic_tls_key_share_pool_dtor(gquic_tls_key_share_pool_t *const pool);
+int gquic_tls_key_share_pool_take(gquic_tls_ecdhe_params_t *const params,
+                                  gquic_tls_key_share_pool_t *const pool,
+                                  const u_int16_t curve_id);
+int gquic_tls_key_share_pool_stats(u_int64_t *const taken,
+                                   u_int64_t *const starved,
+                                   gquic_tls_key_share_pool_t *const pool,
+                                   const u_int16_t curve_id);
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef _LIBGQUIC_TLS_LRU_SESS_CACHE_H
+#define _LIBGQUIC_TLS_LRU_SESS_CACHE_H
+
+#include "tls/client_sess_state.h"
+#include "util/list.h"
+#include <semaphore.h>
+
+/*
+ * capacity-bounded LRU client session cache. keys hash to one of
+ * shards_count shards, each with its own lock, bucket chains and LRU queue,
+ * so client threads resuming different servers rarely contend. a TLS 1.3
+ * session is dropped once its ticket lifetime (use_by) has passed.
+ */
+#define GQUIC_TLS_LRU_SESS_CACHE_DEFAULT_CAP 64
+
+typedef struct gquic_tls_lru_sess_cache_entry_s gquic_tls_lru_sess_cache_entry_t;
+struct gquic_tls_lru_sess_cache_entry_s {
+    u_int64_t hash;
+    gquic_str_t key;
+    gquic_tls_client_sess_state_t state;
+    gquic_tls_lru_sess_cache_entry_t *bucket_next;
+};
+
+typedef struct gquic_tls_lru_sess_cache_shard_s gquic_tls_lru_sess_cache_shard_t;
+struct gquic_tls_lru_sess_cache_shard_s {
+    sem_t mtx;
+    gquic_tls_lru_sess_cache_entry_t **buckets;
+    size_t buckets_mask;
+    gquic_list_t q; /* gquic_tls_lru_sess_cache_entry_t, most recently used first */
+    size_t count;
+    size_t cap;
+
+    u_int64_t hits;
+    u_int64_t misses;
+    u_int64_t expired;
+    u_int64_t evicted;
+};
+
+typedef struct gquic_tls_lru_sess_cache_stats_s gquic_tls_lru_sess_cache_stats_t;
+struct gquic_tls_lru_sess_cache_stats_s {
+    u_int64_t hits;
+    u_int64_t misses;
+    u_int64_t expired;
+    u_int64_t evicted;
+    size_t count;
+};
+
+typedef struct gquic_tls_lru_sess_cache_s gquic_tls_lru_sess_cache_t;
+struct gquic_tls_lru_sess_cache_s {
+    gquic_tls_client_sess_cache_t base;
+    gquic_tls_lru_sess_cache_shard_t *shards;
+    size_t shards_count;
+};
+
+int gquic_tls_lru_sess_cache_init(gquic_tls_lru_sess_cache_t *const cache);
+int gquic_tls_lru_sess_cache_ctor(gquic_tls_lru_sess_cache_t *const cache, const size_t cap, const size_t shards_count);
+int gquic_tls_lru_sess_cache_dtor(gquic_tls_lru_sess_cache_t *const cache);
+int gquic_tls_lru_sess_cache_get(gquic_tls_client_sess_state_t **const state, gquic_tls_lru_sess_cache_t *const cache, const gquic_str_t *const key);
+int gquic_tls_lru_sess_cache_put(gquic_tls_lru_sess_cache_t *const cache, const gquic_str_t *const key, const gquic_tls_client_sess_state_t *const state);
+int gquic_tls_lru_sess_cache_stats(gquic_tls_lru_sess_cache_stats_t *const stats, gquic_tls_lru_sess_cache_t *const cache);
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef _LIBGQUIC_TLS_SIGN_POOL_H
+#define _LIBGQUIC_TLS_SIGN_POOL_H
+
+#include "util/str.h"
+#include "util/sem_list.h"
+#include <pthread.h>
+#include <openssl/evp.h>
+
+/*
+ * signer produces the CertificateVerify signature of msg. the default signs
+ * locally with pkey; an external signer (e.g. a key server) may ignore pkey.
+ */
+typedef struct gquic_tls_signer_s gquic_tls_signer_t;
+struct gquic_tls_signer_s {
+    void *self;
+    int (*sign) (gquic_str_t *const, void *const, EVP_PKEY *const, const u_int16_t, const gquic_str_t *const);
+};
+
+#define GQUIC_TLS_SIGNER_SIGN(sig, signer, pkey, sigalg, msg) \
+    ((signer)->sign((sig), (signer)->self, (pkey), (sigalg), (msg)))
+
+int gquic_tls_signer_init(gquic_tls_signer_t *const signer);
+int gquic_tls_sign(gquic_str_t *const sig, EVP_PKEY *const pkey, const u_int16_t sigalg, const gquic_str_t *const msg);
+
+typedef struct gquic_tls_sign_job_s gquic_tls_sign_job_t;
+struct gquic_tls_sign_job_s {
+    gquic_str_t *sig;
+    const gquic_tls_signer_t *signer;
+    EVP_PKEY *pkey;
+    u_int16_t sigalg;
+    const gquic_str_t *msg;
+
+    struct {
+        void *self;
+        int (*cb) (void *const, const int);
+    } on_done;
+};
+
+/*
+ * a fixed set of crypto worker threads shared by all sessions of a config.
+ * submitted jobs run in order; on_done is called from the worker thread.
+ */
+typedef struct gquic_tls_sign_pool_s gquic_tls_sign_pool_t;
+struct gquic_tls_sign_pool_s {
+    gquic_sem_list_t jobs;
+    pthread_t *threads;
+    size_t threads_count;
+};
+
+int gquic_tls_sign_pool_init(gquic_tls_sign_pool_t *const pool);
+int gquic_tls_sign_pool_ctor(gquic_tls_sign_pool_t *const pool, const size_t threads_count);
+int gquic_tls_sign_pool_dtor(gquic_tls_sign_pool_t *const pool);
+int gquic_tls_sign_pool_submit(gquic_tls_sign_pool_t *const pool, const gquic_tls_sign_job_t *const job);
+int gquic_tls_sign_pool_sign(gquic_str_t *const sig,
+                             gquic_tls_sign_pool_t *const pool,
+                             const gquic_tls_signer_t *const signer,
+                             EVP_PKEY *const pkey,
+                             const u_int16_t sigalg,
+                             const gquic_str_t *const msg);
+
+#endif
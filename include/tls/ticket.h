@@ -9,6 +9,8 @@ typedef struct gquic_tls_sess_state_s gquic_tls_sess_state_t;
 struct gquic_tls_sess_state_s {
     u_int16_t cipher_suite;
     u_int64_t create_at;
+    u_int32_t age_add;
+    u_int32_t max_early_data;
     gquic_str_t resumption_sec;
     gquic_tls_cert_t cert;
 };
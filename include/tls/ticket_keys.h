@@ -0,0 +1,71 @@
+#ifndef _LIBGQUIC_TLS_TICKET_KEYS_H
+#define _LIBGQUIC_TLS_TICKET_KEYS_H
+
+#include "util/str.h"
+#include <openssl/evp.h>
+#include <sys/types.h>
+#include <semaphore.h>
+#include <time.h>
+
+/*
+ * server session ticket keys. the first key encrypts new tickets, every key
+ * still held decrypts them, so a key stays useful for keep * interval after
+ * it was introduced. each key holds cipher and mac contexts keyed once, a
+ * ticket only copies them, and a ticket finds its key by name through a
+ * small hash index.
+ *
+ * without a key file the manager rotates by itself every interval. with one,
+ * keys come from the file instead: 32 byte secrets back to back, newest
+ * first, at most keep of them. the file is re-read whenever its mtime
+ * changes, so processes sharing it resume each other's sessions as long as
+ * whoever rotates it prepends the new secret and keeps the old ones.
+ */
+#define GQUIC_TLS_TICKET_KEYS_DEFAULT_INTERVAL (24 * 60 * 60)
+#define GQUIC_TLS_TICKET_KEYS_DEFAULT_KEEP 8
+#define GQUIC_TLS_TICKET_KEYS_SECRET_SIZE 32
+#define GQUIC_TLS_TICKET_KEYS_FILE_CHECK_INTERVAL 10
+
+typedef struct gquic_tls_ticket_keys_entry_s gquic_tls_ticket_keys_entry_t;
+struct gquic_tls_ticket_keys_entry_s {
+    u_int8_t name[16];
+    EVP_CIPHER_CTX *enc;
+    EVP_CIPHER_CTX *dec;
+    EVP_MAC_CTX *mac;
+};
+
+typedef struct gquic_tls_ticket_keys_s gquic_tls_ticket_keys_t;
+struct gquic_tls_ticket_keys_s {
+    sem_t mtx;
+    time_t interval;
+    size_t keep;
+    gquic_tls_ticket_keys_entry_t *entries; /* ring, entries[current] encrypts */
+    size_t current;
+    size_t count;
+    size_t *index; /* name hash -> entry + 1, 0 marks an empty slot */
+    size_t index_mask;
+    time_t rotated_at;
+
+    gquic_str_t path;
+    time_t checked_at;
+    time_t mtime;
+
+    EVP_MAC *hmac;
+
+    u_int64_t encrypted;
+    u_int64_t decrypted;
+    u_int64_t decrypted_old;
+    u_int64_t unknown;
+};
+
+int gquic_tls_ticket_keys_init(gquic_tls_ticket_keys_t *const keys);
+int gquic_tls_ticket_keys_ctor(gquic_tls_ticket_keys_t *const keys, const time_t interval, const size_t keep);
+int gquic_tls_ticket_keys_dtor(gquic_tls_ticket_keys_t *const keys);
+int gquic_tls_ticket_keys_set(gquic_tls_ticket_keys_t *const keys, const u_int8_t *const secrets, const size_t count);
+int gquic_tls_ticket_keys_load_file(gquic_tls_ticket_keys_t *const keys, const char *const path);
+int gquic_tls_ticket_keys_encrypt(gquic_str_t *const encrypted, gquic_tls_ticket_keys_t *const keys, const gquic_str_t *const state);
+int gquic_tls_ticket_keys_decrypt(gquic_str_t *const plain,
+                                  int *const is_oldkey,
+                                  gquic_tls_ticket_keys_t *const keys,
+                                  const gquic_str_t *const encrypted);
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef _LIBGQUIC_TOKEN_STORE_H
+#define _LIBGQUIC_TOKEN_STORE_H
+
+#include "util/str.h"
+#include "util/list.h"
+#include <semaphore.h>
+
+/*
+ * client store for NEW_TOKEN tokens, keyed by server name. a token is given
+ * out once, since reusing one lets the path be linked across connections,
+ * so each server keeps the few most recent tokens it sent.
+ */
+typedef struct gquic_token_store_s gquic_token_store_t;
+struct gquic_token_store_s {
+    void *self;
+    int (*pop) (gquic_str_t *const, void *const self, const gquic_str_t *const);
+    int (*put) (void *const self, const gquic_str_t *const, const gquic_str_t *const);
+};
+
+#define GQUIC_TOKEN_STORE_POP(store, token, key) \
+    ((store) == NULL || (store)->pop == NULL ? -1 : (store)->pop((token), (store)->self, (key)))
+#define GQUIC_TOKEN_STORE_PUT(store, key, token) \
+    ((store) == NULL || (store)->put == NULL ? -1 : (store)->put((store)->self, (key), (token)))
+
+#define GQUIC_LRU_TOKEN_STORE_DEFAULT_CAP 100
+#define GQUIC_LRU_TOKEN_STORE_TOKENS_PER_SERVER 4
+
+typedef struct gquic_lru_token_store_entry_s gquic_lru_token_store_entry_t;
+struct gquic_lru_token_store_entry_s {
+    gquic_str_t key;
+    gquic_str_t tokens[GQUIC_LRU_TOKEN_STORE_TOKENS_PER_SERVER]; /* ring, tokens[head] is the newest */
+    size_t head;
+    size_t count;
+};
+
+typedef struct gquic_lru_token_store_s gquic_lru_token_store_t;
+struct gquic_lru_token_store_s {
+    gquic_token_store_t base;
+    sem_t mtx;
+    gquic_list_t q; /* gquic_lru_token_store_entry_t, most recently used first */
+    size_t count;
+    size_t cap;
+};
+
+int gquic_lru_token_store_init(gquic_lru_token_store_t *const store);
+int gquic_lru_token_store_ctor(gquic_lru_token_store_t *const store, const size_t cap);
+int gquic_lru_token_store_dtor(gquic_lru_token_store_t *const store);
+int gquic_lru_token_store_pop(gquic_str_t *const token, gquic_lru_token_store_t *const store, const gquic_str_t *const key);
+int gquic_lru_token_store_put(gquic_lru_token_store_t *const store, const gquic_str_t *const key, const gquic_str_t *const token);
+
+#endif
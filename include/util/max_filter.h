@@ -0,0 +1,36 @@
+#ifndef _LIBGQUIC_UTIL_MAX_FILTER_H
+#define _LIBGQUIC_UTIL_MAX_FILTER_H
+
+#include <sys/types.h>
+#include <stddef.h>
+
+/*
+ * windowed max filter (kathleen nichols' algorithm). it keeps the best,
+ * second best and third best samples of different ages, so the max over
+ * the last window is known in constant space. time is whatever the caller
+ * counts in, us or round trips.
+ */
+typedef struct gquic_max_filter_sample_s gquic_max_filter_sample_t;
+struct gquic_max_filter_sample_s {
+    u_int64_t val;
+    u_int64_t time;
+};
+
+typedef struct gquic_max_filter_s gquic_max_filter_t;
+struct gquic_max_filter_s {
+    u_int64_t window;
+    gquic_max_filter_sample_t estimates[3];
+};
+
+int gquic_max_filter_init(gquic_max_filter_t *const filter, const u_int64_t window);
+int gquic_max_filter_reset(gquic_max_filter_t *const filter, const u_int64_t val, const u_int64_t time);
+int gquic_max_filter_update(gquic_max_filter_t *const filter, const u_int64_t val, const u_int64_t time);
+
+static inline u_int64_t gquic_max_filter_get(const gquic_max_filter_t *const filter) {
+    if (filter == NULL) {
+        return 0;
+    }
+    return filter->estimates[0].val;
+}
+
+#endif
@@ -3,4 +3,7 @@
 
 typedef unsigned int gquic_version_t;
 
+#define GQUIC_VERSION_1 0x00000001
+#define GQUIC_VERSION_DRAFT_27 0xff00001b
+
 #endif
@@ -1,5 +1,14 @@
 #include "net/conn.h"
 #include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <linux/net_tstamp.h>
+
+static int gquic_net_conn_sendmsg(gquic_net_conn_t *const, const gquic_str_t *const, const u_int64_t, const u_int8_t);
 
 int gquic_net_conn_init(gquic_net_conn_t *const conn) {
     if (conn == NULL) {
@@ -7,6 +16,8 @@ int gquic_net_conn_init(gquic_net_conn_t *const conn) {
     }
     gquic_net_addr_init(&conn->addr);
     conn->fd = -1;
+    conn->txtime = 0;
+    conn->ecn = 1;
     conn->write.cb = NULL;
     conn->write.self = NULL;
 
@@ -14,17 +25,166 @@ int gquic_net_conn_init(gquic_net_conn_t *const conn) {
 }
 
 int gquic_net_conn_write(gquic_net_conn_t *const conn, const gquic_str_t *const raw) {
+    return gquic_net_conn_write_at(conn, raw, 0, GQUIC_NET_ECN_NOT_ECT);
+}
+
+int gquic_net_conn_enable_txtime(gquic_net_conn_t *const conn) {
+#ifdef SO_TXTIME
+    struct sock_txtime opt;
+    if (conn == NULL) {
+        return -1;
+    }
+    if (conn->fd < 0 || conn->write.self != NULL) {
+        return -2;
+    }
+    // fq only takes monotonic time stamps
+    opt.clockid = CLOCK_MONOTONIC;
+    opt.flags = 0;
+    if (setsockopt(conn->fd, SOL_SOCKET, SO_TXTIME, &opt, sizeof(opt)) != 0) {
+        return -3;
+    }
+    conn->txtime = 1;
+    return 0;
+#else
+    (void) conn;
+    return -4;
+#endif
+}
+
+int gquic_net_conn_write_at(gquic_net_conn_t *const conn, const gquic_str_t *const raw, const u_int64_t txtime, const u_int8_t ecn) {
+    u_int64_t at = 0;
+    u_int8_t mark = 0;
     if (conn == NULL || raw == NULL) {
         return -1;
     }
     if (conn->write.self != NULL) {
         return GQUIC_NET_CONN_WRITE(conn, raw);
     }
+    for ( ;; ) {
+        at = conn->txtime ? txtime : 0;
+        mark = conn->ecn ? ecn & GQUIC_NET_ECN_MASK : 0;
+        if (at == 0 && mark == 0) {
+            break;
+        }
+        if (gquic_net_conn_sendmsg(conn, raw, at, mark) == 0) {
+            return 0;
+        }
+        if (errno != EINVAL && errno != ENOPROTOOPT && errno != EOPNOTSUPP) {
+            return -2;
+        }
+        // drop the marking first, the departure time next
+        if (mark != 0) {
+            conn->ecn = 0;
+        }
+        else {
+            conn->txtime = 0;
+        }
+    }
 
     if (conn->addr.type == AF_INET) {
-        return sendto(conn->fd, GQUIC_STR_VAL(raw), GQUIC_STR_SIZE(raw), 0, (struct sockaddr *) &conn->addr.addr.v4, sizeof(struct sockaddr_in));
+        if (sendto(conn->fd, GQUIC_STR_VAL(raw), GQUIC_STR_SIZE(raw), 0, (struct sockaddr *) &conn->addr.addr.v4, sizeof(struct sockaddr_in)) < 0) {
+            return -3;
+        }
     }
     else {
-        return sendto(conn->fd, GQUIC_STR_VAL(raw), GQUIC_STR_SIZE(raw), 0, (struct sockaddr *) &conn->addr.addr.v6, sizeof(struct sockaddr_in6));
+        if (sendto(conn->fd, GQUIC_STR_VAL(raw), GQUIC_STR_SIZE(raw), 0, (struct sockaddr *) &conn->addr.addr.v6, sizeof(struct sockaddr_in6)) < 0) {
+            return -4;
+        }
+    }
+    return 0;
+}
+
+int gquic_net_enable_recv_ecn(const int fd) {
+    int on = 1;
+    int enabled = 0;
+    if (fd < 0) {
+        return -1;
+    }
+    // a v6 socket may carry v4 traffic too, so both are asked for and one may fail
+    if (setsockopt(fd, IPPROTO_IP, IP_RECVTOS, &on, sizeof(on)) == 0) {
+        enabled = 1;
     }
+    if (setsockopt(fd, IPPROTO_IPV6, IPV6_RECVTCLASS, &on, sizeof(on)) == 0) {
+        enabled = 1;
+    }
+    return enabled ? 0 : -2;
+}
+
+static int gquic_net_conn_sendmsg(gquic_net_conn_t *const conn, const gquic_str_t *const raw, const u_int64_t txtime, const u_int8_t ecn) {
+    struct msghdr msg;
+    struct iovec iov;
+    struct cmsghdr *cmsg = NULL;
+    struct timeval tv;
+    struct timespec ts;
+    u_int64_t now = 0;
+    u_int64_t departure = 0;
+    int tos = ecn;
+    union {
+        char buf[CMSG_SPACE(sizeof(u_int64_t)) + CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+
+#ifndef SCM_TXTIME
+    if (txtime != 0) {
+        errno = EOPNOTSUPP;
+        return -1;
+    }
+#endif
+    iov.iov_base = GQUIC_STR_VAL(raw);
+    iov.iov_len = GQUIC_STR_SIZE(raw);
+    memset(&msg, 0, sizeof(msg));
+    memset(&control, 0, sizeof(control));
+    if (conn->addr.type == AF_INET) {
+        msg.msg_name = (void *) &conn->addr.addr.v4;
+        msg.msg_namelen = sizeof(struct sockaddr_in);
+    }
+    else {
+        msg.msg_name = (void *) &conn->addr.addr.v6;
+        msg.msg_namelen = sizeof(struct sockaddr_in6);
+    }
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = (txtime != 0 ? CMSG_SPACE(sizeof(u_int64_t)) : 0) + (ecn != 0 ? CMSG_SPACE(sizeof(int)) : 0);
+    cmsg = CMSG_FIRSTHDR(&msg);
+
+#ifdef SCM_TXTIME
+    if (txtime != 0) {
+        // the schedule runs on gettimeofday, the qdisc on the monotonic clock
+        gettimeofday(&tv, NULL);
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        now = tv.tv_sec * 1000 * 1000 + tv.tv_usec;
+        departure = (u_int64_t) ts.tv_sec * 1000 * 1000 * 1000 + ts.tv_nsec;
+        if (txtime > now) {
+            departure += (txtime - now) * 1000;
+        }
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_TXTIME;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(u_int64_t));
+        memcpy(CMSG_DATA(cmsg), &departure, sizeof(u_int64_t));
+        cmsg = CMSG_NXTHDR(&msg, cmsg);
+    }
+#else
+    (void) tv;
+    (void) ts;
+    (void) now;
+    (void) departure;
+#endif
+    if (ecn != 0) {
+        if (conn->addr.type == AF_INET) {
+            cmsg->cmsg_level = IPPROTO_IP;
+            cmsg->cmsg_type = IP_TOS;
+        }
+        else {
+            cmsg->cmsg_level = IPPROTO_IPV6;
+            cmsg->cmsg_type = IPV6_TCLASS;
+        }
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &tos, sizeof(int));
+    }
+
+    if (sendmsg(conn->fd, &msg, 0) < 0) {
+        return -1;
+    }
+    return 0;
 }
@@ -0,0 +1,112 @@
+#include "packet/ecn.h"
+#include "frame/meta.h"
+#include "net/conn.h"
+#include <stddef.h>
+
+static int gquic_packet_ecn_fail(gquic_packet_ecn_t *const);
+
+int gquic_packet_ecn_init(gquic_packet_ecn_t *const ecn) {
+    if (ecn == NULL) {
+        return -1;
+    }
+    ecn->state = GQUIC_PACKET_ECN_DISABLED;
+    ecn->testing_sent = 0;
+    ecn->testing_lost = 0;
+    ecn->marked = 0;
+    ecn->peer.ect[0] = 0;
+    ecn->peer.ect[1] = 0;
+    ecn->peer.ecn_ce = 0;
+    return 0;
+}
+
+int gquic_packet_ecn_enable(gquic_packet_ecn_t *const ecn) {
+    if (ecn == NULL) {
+        return -1;
+    }
+    if (ecn->state != GQUIC_PACKET_ECN_DISABLED) {
+        return 0;
+    }
+    ecn->state = GQUIC_PACKET_ECN_TESTING;
+    return 0;
+}
+
+u_int8_t gquic_packet_ecn_mark(gquic_packet_ecn_t *const ecn) {
+    if (ecn == NULL) {
+        return GQUIC_NET_ECN_NOT_ECT;
+    }
+    switch (ecn->state) {
+    case GQUIC_PACKET_ECN_TESTING:
+        if (++ecn->testing_sent == GQUIC_PACKET_ECN_TESTING_PACKETS) {
+            ecn->state = GQUIC_PACKET_ECN_UNKNOWN;
+        }
+        break;
+    case GQUIC_PACKET_ECN_CAPABLE:
+        break;
+    default:
+        return GQUIC_NET_ECN_NOT_ECT;
+    }
+    ecn->marked++;
+    return GQUIC_NET_ECN_ECT0;
+}
+
+int gquic_packet_ecn_on_packet_lost(gquic_packet_ecn_t *const ecn, const u_int8_t codepoint) {
+    if (ecn == NULL) {
+        return -1;
+    }
+    if (codepoint == GQUIC_NET_ECN_NOT_ECT) {
+        return 0;
+    }
+    // a path dropping marked packets is not told apart from one dropping everything until all of them are gone
+    if (ecn->state == GQUIC_PACKET_ECN_TESTING || ecn->state == GQUIC_PACKET_ECN_UNKNOWN) {
+        if (++ecn->testing_lost >= GQUIC_PACKET_ECN_TESTING_PACKETS) {
+            gquic_packet_ecn_fail(ecn);
+        }
+    }
+    return 0;
+}
+
+int gquic_packet_ecn_on_ack(u_int64_t *const ce_increase,
+                            gquic_packet_ecn_t *const ecn,
+                            const gquic_frame_ack_t *const ack_frame,
+                            const u_int64_t newly_acked_marked) {
+    u_int64_t ect0_increase = 0;
+    if (ce_increase == NULL || ecn == NULL || ack_frame == NULL) {
+        return -1;
+    }
+    *ce_increase = 0;
+    if (ecn->state == GQUIC_PACKET_ECN_DISABLED || ecn->state == GQUIC_PACKET_ECN_FAILED) {
+        return 0;
+    }
+    // an ACK that acks no marked packet, e.g. a reordered one, proves nothing
+    if (newly_acked_marked == 0) {
+        return 0;
+    }
+    // the marks were bleached, or the peer does not report them
+    if (GQUIC_FRAME_META(ack_frame).type != 0x03) {
+        return gquic_packet_ecn_fail(ecn);
+    }
+    if (ack_frame->ecn.ect[0] < ecn->peer.ect[0]
+        || ack_frame->ecn.ect[1] < ecn->peer.ect[1]
+        || ack_frame->ecn.ecn_ce < ecn->peer.ecn_ce) {
+        return gquic_packet_ecn_fail(ecn);
+    }
+    // only ECT(0) is sent, so ECT(1) means the path rewrites the field
+    if (ack_frame->ecn.ect[1] != ecn->peer.ect[1]) {
+        return gquic_packet_ecn_fail(ecn);
+    }
+    ect0_increase = ack_frame->ecn.ect[0] - ecn->peer.ect[0];
+    *ce_increase = ack_frame->ecn.ecn_ce - ecn->peer.ecn_ce;
+    if (ect0_increase + *ce_increase < newly_acked_marked
+        || ack_frame->ecn.ect[0] + ack_frame->ecn.ecn_ce > ecn->marked) {
+        *ce_increase = 0;
+        return gquic_packet_ecn_fail(ecn);
+    }
+    ecn->peer = ack_frame->ecn;
+    ecn->state = GQUIC_PACKET_ECN_CAPABLE;
+    return 0;
+}
+
+static int gquic_packet_ecn_fail(gquic_packet_ecn_t *const ecn) {
+    ecn->state = GQUIC_PACKET_ECN_FAILED;
+    return 0;
+}
@@ -121,15 +121,25 @@ int gquic_packet_long_header_deserialize(gquic_packet_long_header_t *const heade
     if (header == NULL) {
         return -1;
     }
+    // a client parses Retry packets with this, bound the reads as the unseal part does
+    if (GQUIC_STR_SIZE(reader) < 1 + 4 + 1) {
+        return -5;
+    }
     header->flag = gquic_reader_str_read_byte(reader);
 
     gquic_big_endian_reader_4byte(&header->version, reader);
 
     header->dcid_len = gquic_reader_str_read_byte(reader);
+    if (header->dcid_len > 20 || header->dcid_len >= GQUIC_STR_SIZE(reader)) {
+        return -6;
+    }
     gquic_str_t dcid = { header->dcid_len, header->dcid };
     gquic_reader_str_read(&dcid, reader);
 
     header->scid_len = gquic_reader_str_read_byte(reader);
+    if (header->scid_len > 20 || header->scid_len > GQUIC_STR_SIZE(reader)) {
+        return -7;
+    }
     gquic_str_t scid = { header->scid_len, header->scid };
     gquic_reader_str_read(&scid, reader);
 
@@ -158,15 +168,25 @@ int gquic_packet_long_header_deserialize_unseal_part(gquic_packet_long_header_t
     if (header == NULL) {
         return -1;
     }
+    // this runs on whatever arrives from the network, keep every read in bounds
+    if (GQUIC_STR_SIZE(reader) < 1 + 4 + 1) {
+        return -4;
+    }
     header->flag = gquic_reader_str_read_byte(reader);
 
     gquic_big_endian_reader_4byte(&header->version, reader);
 
     header->dcid_len = gquic_reader_str_read_byte(reader);
+    if (header->dcid_len > 20 || header->dcid_len >= GQUIC_STR_SIZE(reader)) {
+        return -5;
+    }
     gquic_str_t dcid = { header->dcid_len, header->dcid };
     gquic_reader_str_read(&dcid, reader);
 
     header->scid_len = gquic_reader_str_read_byte(reader);
+    if (header->scid_len > 20 || header->scid_len > GQUIC_STR_SIZE(reader)) {
+        return -6;
+    }
     gquic_str_t scid = { header->scid_len, header->scid };
     gquic_reader_str_read(&scid, reader);
 
@@ -174,6 +194,8 @@ int gquic_packet_long_header_deserialize_unseal_part(gquic_packet_long_header_t
     case 0x00:
         ret = gquic_packet_initial_header_deserialize_unseal_part(GQUIC_LONG_HEADER_SPEC(header), reader);
         break;
+    case 0x01:
+        // a 0-RTT header has the same layout as a handshake header
     case 0x02:
         ret = gquic_packet_handshake_header_deserialize_unseal_part(GQUIC_LONG_HEADER_SPEC(header), reader);
         break;
@@ -207,7 +229,9 @@ static size_t gquic_packet_handshake_header_size(const gquic_packet_handshake_he
 }
 
 static size_t gquic_packet_retry_header_size(const gquic_packet_retry_header_t *header) {
-    return 1 + header->odcid_len;
+    (void) header;
+    // the token and the integrity tag after it are written by the packer
+    return 0;
 }
 
 static int gquic_packet_initial_header_serialize(const gquic_packet_initial_header_t *header, gquic_writer_str_t *const writer) {
@@ -303,12 +327,6 @@ static int gquic_packet_retry_header_serialize(const gquic_packet_retry_header_t
     if (header == NULL || writer == NULL) {
         return -1;
     }
-    if (gquic_packet_retry_header_size(header) > GQUIC_STR_SIZE(writer)) {
-        return -2;
-    }
-    gquic_writer_str_write_byte(writer, header->odcid_len);
-    gquic_str_t odcid = { header->odcid_len, (void *) header->odcid };
-    gquic_writer_str_write(&odcid, writer);
     return 0;
 }
 
@@ -405,12 +423,12 @@ static int gquic_packet_retry_header_deserialize(gquic_packet_retry_header_t *he
     if (header == NULL || reader == NULL) {
         return -1;
     }
-    header->odcid_len = gquic_reader_str_read_byte(reader);
-    if (header->odcid_len > GQUIC_STR_SIZE(reader)) {
+    if (GQUIC_STR_SIZE(reader) < GQUIC_PACKET_RETRY_TAG_SIZE) {
         return -3;
     }
-    gquic_str_t odcid = { header->odcid_len, header->odcid };
-    gquic_reader_str_read(&odcid, reader);
+    // the tag ends the packet, what the reader is left with is the token
+    reader->size -= GQUIC_PACKET_RETRY_TAG_SIZE;
+    memcpy(header->tag, GQUIC_STR_VAL(reader) + GQUIC_STR_SIZE(reader), GQUIC_PACKET_RETRY_TAG_SIZE);
     return 0;
 }
 
@@ -477,6 +495,8 @@ int gquic_packet_long_header_deserialize_seal_part(gquic_packet_long_header_t *c
     case 0x00:
         ret = gquic_packet_initial_header_deserialize_seal_part(GQUIC_LONG_HEADER_SPEC(header), reader);
         break;
+    case 0x01:
+        // a 0-RTT header has the same layout as a handshake header
     case 0x02:
         ret = gquic_packet_handshake_header_deserialize_seal_part(GQUIC_LONG_HEADER_SPEC(header), reader);
         break;
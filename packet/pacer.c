@@ -0,0 +1,131 @@
+#include "packet/pacer.h"
+#include <stddef.h>
+
+static inline u_int64_t gquic_packet_pacer_quantum(const gquic_packet_pacer_t *const);
+
+int gquic_packet_pacer_init(gquic_packet_pacer_t *const pacer) {
+    if (pacer == NULL) {
+        return -1;
+    }
+    pacer->budget_at_last_sent = 0;
+    pacer->last_sent_time = 0;
+    pacer->max_datagram_size = 1460;
+    pacer->burst_packets = GQUIC_PACKET_PACER_DEFAULT_BURST_PACKETS;
+    pacer->gso_segments = 1;
+    return 0;
+}
+
+int gquic_packet_pacer_ctor(gquic_packet_pacer_t *const pacer,
+                            const u_int64_t max_datagram_size,
+                            const u_int64_t burst_packets,
+                            const u_int64_t gso_segments) {
+    if (pacer == NULL) {
+        return -1;
+    }
+    if (max_datagram_size != 0) {
+        pacer->max_datagram_size = max_datagram_size;
+    }
+    if (burst_packets != 0) {
+        pacer->burst_packets = burst_packets;
+    }
+    pacer->gso_segments = gso_segments != 0 ? gso_segments : 1;
+    // a full bucket lets the first flight out at once
+    pacer->budget_at_last_sent = gquic_packet_pacer_max_burst(pacer, 0);
+    return 0;
+}
+
+u_int64_t gquic_packet_pacer_max_burst(const gquic_packet_pacer_t *const pacer, const u_int64_t rate) {
+    u_int64_t burst = 0;
+    u_int64_t quantum = 0;
+    if (pacer == NULL) {
+        return 0;
+    }
+    burst = pacer->burst_packets * pacer->max_datagram_size;
+    if (2 * GQUIC_PACKET_PACER_MIN_DELAY * rate / (1000 * 1000) > burst) {
+        burst = 2 * GQUIC_PACKET_PACER_MIN_DELAY * rate / (1000 * 1000);
+    }
+    // whole GSO batches only
+    quantum = gquic_packet_pacer_quantum(pacer);
+    return (burst + quantum - 1) / quantum * quantum;
+}
+
+u_int64_t gquic_packet_pacer_budget(const gquic_packet_pacer_t *const pacer, const u_int64_t rate, const u_int64_t now) {
+    u_int64_t max_burst = 0;
+    u_int64_t budget = 0;
+    if (pacer == NULL) {
+        return 0;
+    }
+    // no rate yet, nothing to pace at
+    if (rate == 0) {
+        return (u_int64_t) -1;
+    }
+    max_burst = gquic_packet_pacer_max_burst(pacer, rate);
+    budget = pacer->budget_at_last_sent;
+    if (now > pacer->last_sent_time) {
+        budget += rate * (now - pacer->last_sent_time) / (1000 * 1000);
+    }
+    return budget < max_burst ? budget : max_burst;
+}
+
+int gquic_packet_pacer_sent_packet(gquic_packet_pacer_t *const pacer, const u_int64_t rate, const u_int64_t now, const u_int64_t bytes) {
+    u_int64_t budget = 0;
+    if (pacer == NULL) {
+        return -1;
+    }
+    budget = gquic_packet_pacer_budget(pacer, rate, now);
+    if (budget == (u_int64_t) -1) {
+        budget = gquic_packet_pacer_max_burst(pacer, rate);
+    }
+    pacer->budget_at_last_sent = budget > bytes ? budget - bytes : 0;
+    pacer->last_sent_time = now;
+    return 0;
+}
+
+u_int64_t gquic_packet_pacer_allowed_packets(const gquic_packet_pacer_t *const pacer, const u_int64_t rate, const u_int64_t now) {
+    u_int64_t budget = 0;
+    u_int64_t count = 0;
+    if (pacer == NULL) {
+        return 0;
+    }
+    if ((budget = gquic_packet_pacer_budget(pacer, rate, now)) == (u_int64_t) -1) {
+        budget = gquic_packet_pacer_max_burst(pacer, rate);
+    }
+    // a partial GSO batch waits for the rest of its budget
+    count = budget / pacer->max_datagram_size;
+    return count - count % pacer->gso_segments;
+}
+
+u_int64_t gquic_packet_pacer_next_release(const gquic_packet_pacer_t *const pacer, const u_int64_t rate, const u_int64_t now) {
+    u_int64_t quantum = 0;
+    u_int64_t delay = 0;
+    if (pacer == NULL || rate == 0) {
+        return 0;
+    }
+    quantum = gquic_packet_pacer_quantum(pacer);
+    if (gquic_packet_pacer_budget(pacer, rate, now) >= quantum) {
+        return 0;
+    }
+    // rounded up so the timer does not fire a few bytes short
+    delay = ((quantum - pacer->budget_at_last_sent) * 1000 * 1000 + rate - 1) / rate;
+    if (delay < GQUIC_PACKET_PACER_MIN_DELAY) {
+        delay = GQUIC_PACKET_PACER_MIN_DELAY;
+    }
+    return pacer->last_sent_time + delay;
+}
+
+u_int64_t gquic_packet_pacer_departure_time(const gquic_packet_pacer_t *const pacer,
+                                            const u_int64_t rate,
+                                            const u_int64_t now,
+                                            const u_int64_t bytes) {
+    u_int64_t departure = 0;
+    if (pacer == NULL || rate == 0 || gquic_packet_pacer_budget(pacer, rate, now) >= bytes) {
+        return now;
+    }
+    // the schedule may already run ahead of now, the bucket refills from its last departure
+    departure = pacer->last_sent_time + ((bytes - pacer->budget_at_last_sent) * 1000 * 1000 + rate - 1) / rate;
+    return departure > now ? departure : now;
+}
+
+static inline u_int64_t gquic_packet_pacer_quantum(const gquic_packet_pacer_t *const pacer) {
+    return pacer->gso_segments * pacer->max_datagram_size;
+}
@@ -12,16 +12,16 @@ static int gquic_common_long_header_sealer_seal_wrapper(gquic_str_t *const,
                                                gquic_str_t *const,
                                                void *const,
                                                const u_int64_t,
-                                               const gquic_str_t *const,
                                                const gquic_str_t *const);
 static int gquic_1rtt_sealer_seal_wrapper(gquic_str_t *const,
                                           gquic_str_t *const,
                                           void *const,
                                           const u_int64_t,
-                                          const gquic_str_t *const,
                                           const gquic_str_t *const);
 
 static int gquic_packet_packer_get_sealer_and_header(gquic_packed_packet_payload_t *const, gquic_packet_packer_t *const);
+static int gquic_packet_packer_seal_header(u_int8_t *const, const u_int64_t, const int, gquic_header_protector_t *const);
+static int gquic_packet_packer_flush_batch(gquic_packet_packer_batch_t *const);
 
 int gquic_packed_packet_init(gquic_packed_packet_t *const packed_packet) {
     if (packed_packet == NULL) {
@@ -33,6 +33,8 @@ int gquic_packed_packet_init(gquic_packed_packet_t *const packed_packet) {
     packed_packet->ack = NULL;
     packed_packet->frames = NULL;
     packed_packet->buffer = NULL;
+    packed_packet->txtime = 0;
+    packed_packet->ecn = 0;
 
     return 0;
 }
@@ -95,6 +97,8 @@ u_int8_t gquic_packed_packet_enc_lv(const gquic_packed_packet_t *const packed_pa
     switch (gquic_packet_long_header_type(packed_packet->hdr.hdr.l_hdr)) {
     case GQUIC_LONG_HEADER_INITIAL:
         return GQUIC_ENC_LV_INITIAL;
+    case GQUIC_LONG_HEADER_0RTT:
+        return GQUIC_ENC_LV_0RTT;
     case GQUIC_LONG_HEADER_HANDSHAKE:
         return GQUIC_ENC_LV_HANDSHAKE;
     }
@@ -135,6 +139,7 @@ int gquic_packed_packet_get_ack_packet(gquic_packet_t *const packet,
             GQUIC_FRAME_META(*(void **) frame_storage).on_lost.self = queue;
             GQUIC_FRAME_META(*(void **) frame_storage).on_lost.cb = gquic_retransmission_queue_add_handshake_wrapper;
             break;
+        case GQUIC_ENC_LV_0RTT:
         case GQUIC_ENC_LV_1RTT:
             GQUIC_FRAME_META(*(void **) frame_storage).on_lost.self = queue;
             GQUIC_FRAME_META(*(void **) frame_storage).on_lost.cb = gquic_retransmission_queue_add_app_wrapper;
@@ -237,6 +242,7 @@ int gquic_packet_packer_init(gquic_packet_packer_t *const packer) {
     packer->retransmission_queue = NULL;
     packer->max_packet_size = 0;
     packer->non_ack_eliciting_acks_count = 0;
+    packer->batch = NULL;
 
     return 0;
 }
@@ -349,21 +355,19 @@ int gquic_packet_packer_pack_conn_close(gquic_packed_packet_t *const packed_pack
 }
 
 static int gquic_common_long_header_sealer_seal_wrapper(gquic_str_t *const tag,
-                                                        gquic_str_t *const cipher_text,
+                                                        gquic_str_t *const text,
                                                         void *const self,
                                                         const u_int64_t pn,
-                                                        const gquic_str_t *const plain_text,
                                                         const gquic_str_t *const addata) {
-    return gquic_common_long_header_sealer_seal(tag, cipher_text, self, pn, plain_text, addata);
+    return gquic_common_long_header_sealer_seal(tag, text, self, pn, addata);
 }
 
 static int gquic_1rtt_sealer_seal_wrapper(gquic_str_t *const tag,
-                                          gquic_str_t *const cipher_text,
+                                          gquic_str_t *const text,
                                           void *const self,
                                           const u_int64_t pn,
-                                          const gquic_str_t *const plain_text,
                                           const gquic_str_t *const addata) {
-    return gquic_auto_update_aead_seal(tag, cipher_text, self, pn, plain_text, addata);
+    return gquic_auto_update_aead_seal(tag, text, self, pn, addata);
 }
 
 int gquic_packet_packer_get_short_header(gquic_packet_header_t *const hdr, gquic_packet_packer_t *const packer, const int times) {
@@ -432,6 +436,12 @@ int gquic_packet_packer_get_long_header(gquic_packet_header_t *const hdr, gquic_
         ((gquic_packet_handshake_header_t *) GQUIC_LONG_HEADER_SPEC(hdr->hdr.l_hdr))->len = packer->max_packet_size;
         return 0;
     }
+    else if (enc_lv == GQUIC_ENC_LV_0RTT) {
+        hdr->hdr.l_hdr->flag = 0xc0 | 0x10 | (0x03 & (pn_len - 1));
+        ((gquic_packet_0rtt_header_t *) GQUIC_LONG_HEADER_SPEC(hdr->hdr.l_hdr))->pn = pn;
+        ((gquic_packet_0rtt_header_t *) GQUIC_LONG_HEADER_SPEC(hdr->hdr.l_hdr))->len = packer->max_packet_size;
+        return 0;
+    }
 
     return -6;
 }
@@ -490,9 +500,6 @@ int gquic_packet_packer_pack_with_padding(gquic_packed_packet_t *const packed_pa
     void **frame_storage = NULL;
     gquic_packet_buffer_t *buffer = NULL;
     u_int64_t header_size = 0;
-    gquic_str_t tag = { 0, NULL };
-    gquic_str_t cipher_text = { 0, NULL };
-    gquic_str_t seal_header = { 0, NULL };
     if (packed_packet == NULL || packer == NULL || payload == NULL) {
         return -1;
     }
@@ -540,38 +547,51 @@ int gquic_packet_packer_pack_with_padding(gquic_packed_packet_t *const packed_pa
         ret = -8;
         goto failure;
     }
-    if ((u_int64_t) (GQUIC_STR_VAL(&writer) - GQUIC_STR_VAL(&buffer->slice) + 16) > packer->max_packet_size) {
+    if ((u_int64_t) (GQUIC_STR_VAL(&writer) - GQUIC_STR_VAL(&buffer->slice) + GQUIC_TLS_AEAD_TAG_SIZE) > packer->max_packet_size) {
         ret = -9;
         goto failure;
     }
+    if (GQUIC_STR_SIZE(&writer) < GQUIC_TLS_AEAD_TAG_SIZE) {
+        ret = -11;
+        goto failure;
+    }
 
-    const gquic_str_t plain_text = {
+    // seal payload in place, the tag directly follows the cipher text
+    gquic_str_t text = {
         GQUIC_STR_VAL(&writer) - GQUIC_STR_VAL(&buffer->slice) - header_size,
         GQUIC_STR_VAL(&buffer->slice) + header_size
     };
+    gquic_str_t tag = { GQUIC_TLS_AEAD_TAG_SIZE, GQUIC_STR_VAL(&writer) };
     const gquic_str_t addata = { header_size, GQUIC_STR_VAL(&buffer->slice) };
-    if (GQUIC_PACKED_PACKET_PAYLOAD_SEAL(&tag, &cipher_text, payload, gquic_packet_header_get_pn(&payload->hdr), &plain_text, &addata) != 0) {
-        ret = -10;
-        goto failure;
+    if (packer->batch != NULL && payload->enc_lv == GQUIC_ENC_LV_1RTT) {
+        // deferred, sealed by gquic_packet_packer_flush_batch
+        if (packer->batch->count >= GQUIC_TLS_AEAD_MAX_BATCH) {
+            ret = -13;
+            goto failure;
+        }
+        if (packer->batch->count == 0) {
+            packer->batch->sealer = payload->sealer.self;
+            packer->batch->header_sealer = payload->header_sealer;
+        }
+        packer->batch->pns[packer->batch->count] = hdr_pn;
+        packer->batch->pn_lens[packer->batch->count] = pn_len;
+        packer->batch->texts[packer->batch->count] = text;
+        packer->batch->tags[packer->batch->count] = tag;
+        packer->batch->addatas[packer->batch->count] = addata;
+        packer->batch->count++;
     }
-    if (header_size + GQUIC_STR_SIZE(&tag) + GQUIC_STR_SIZE(&cipher_text) > GQUIC_STR_SIZE(&buffer->slice)) {
-        ret = -11;
-        goto failure;
+    else {
+        if (GQUIC_PACKED_PACKET_PAYLOAD_SEAL(&tag, &text, payload, hdr_pn, &addata) != 0) {
+            ret = -10;
+            goto failure;
+        }
+        if (gquic_packet_packer_seal_header(GQUIC_STR_VAL(&buffer->slice), header_size, pn_len, payload->header_sealer) != 0) {
+            ret = -14;
+            goto failure;
+        }
     }
-
-    // set payload
-    memcpy(GQUIC_STR_VAL(&buffer->slice) + header_size, GQUIC_STR_VAL(&tag), GQUIC_STR_SIZE(&tag));
-    memcpy(GQUIC_STR_VAL(&buffer->slice) + header_size + GQUIC_STR_SIZE(&tag), GQUIC_STR_VAL(&cipher_text), GQUIC_STR_SIZE(&cipher_text));
-    buffer->writer.size = GQUIC_STR_SIZE(&buffer->slice) - header_size - GQUIC_STR_SIZE(&cipher_text) - GQUIC_STR_SIZE(&tag);
-    buffer->writer.val = GQUIC_STR_VAL(&buffer->slice) + header_size + GQUIC_STR_SIZE(&cipher_text) + GQUIC_STR_SIZE(&tag);
-
-    // seal header
-    gquic_str_t header = { pn_len, GQUIC_STR_VAL(&buffer->slice) + header_size - pn_len };
-    gquic_str_t sample = { 16, GQUIC_STR_VAL(&buffer->slice) + header_size - pn_len + 4 };
-    u_int8_t first = GQUIC_STR_FIRST_BYTE(&buffer->slice);
-    GQUIC_HEADER_PROTECTOR_SET_KEY(payload->header_sealer, &sample);
-    GQUIC_HEADER_PROTECTOR_ENCRYPT(&header, &first, payload->header_sealer);
-    *(u_int8_t *) GQUIC_STR_VAL(&buffer->slice) = first;
+    buffer->writer.size = GQUIC_STR_SIZE(&writer) - GQUIC_TLS_AEAD_TAG_SIZE;
+    buffer->writer.val = GQUIC_STR_VAL(&writer) + GQUIC_TLS_AEAD_TAG_SIZE;
 
     u_int64_t pn;
     if (gquic_packet_sent_packet_handler_pop_pn(&pn, packer->pn_gen, payload->enc_lv) != 0 || hdr_pn != pn) {
@@ -587,18 +607,29 @@ int gquic_packet_packer_pack_with_padding(gquic_packed_packet_t *const packed_pa
     gquic_str_t cnt = { GQUIC_STR_VAL(&buffer->writer) - GQUIC_STR_VAL(&buffer->slice), GQUIC_STR_VAL(&buffer->slice) };
     packed_packet->raw = cnt;
 
-    gquic_str_reset(&tag);
-    gquic_str_reset(&cipher_text);
-    gquic_str_reset(&seal_header);
     return 0;
 failure:
-    gquic_str_reset(&tag);
-    gquic_str_reset(&cipher_text);
-    gquic_str_reset(&seal_header);
     gquic_packet_buffer_put(buffer);
     return ret;
 }
 
+static int gquic_packet_packer_seal_header(u_int8_t *const packet,
+                                           const u_int64_t header_size,
+                                           const int pn_len,
+                                           gquic_header_protector_t *const header_sealer) {
+    gquic_str_t header = { pn_len, packet + header_size - pn_len };
+    gquic_str_t sample = { 16, packet + header_size - pn_len + 4 };
+    u_int8_t first = *packet;
+    if (GQUIC_HEADER_PROTECTOR_SET_KEY(header_sealer, &sample) != 0) {
+        return -1;
+    }
+    if (GQUIC_HEADER_PROTECTOR_ENCRYPT(&header, &first, header_sealer) != 0) {
+        return -2;
+    }
+    *packet = first;
+    return 0;
+}
+
 int gquic_packet_packer_try_pack_ack_packet(gquic_packed_packet_t *const packed_packet,
                                             gquic_packet_packer_t *const packer) {
     gquic_packed_packet_payload_t payload;
@@ -607,14 +638,14 @@ int gquic_packet_packer_try_pack_ack_packet(gquic_packed_packet_t *const packed_
     }
     gquic_packed_packet_payload_init(&payload);
     if (!gquic_packet_packer_handshake_confirmed(packer)) {
-        if (gquic_packet_received_packet_handlers_get_ack_frame(&payload.ack, packer->acks, GQUIC_ENC_LV_INITIAL) != 0) {
+        if (gquic_packet_received_packet_handlers_get_ack_frame(&payload.ack, packer->acks, GQUIC_ENC_LV_INITIAL, 1) != 0) {
             return -2;
         }
         if (payload.ack != NULL) {
             payload.enc_lv = GQUIC_ENC_LV_INITIAL;
         }
         else {
-            if (gquic_packet_received_packet_handlers_get_ack_frame(&payload.ack, packer->acks, GQUIC_ENC_LV_HANDSHAKE) != 0) {
+            if (gquic_packet_received_packet_handlers_get_ack_frame(&payload.ack, packer->acks, GQUIC_ENC_LV_HANDSHAKE, 1) != 0) {
                 gquic_packed_packet_payload_dtor(&payload);
                 return -3;
             }
@@ -624,7 +655,7 @@ int gquic_packet_packer_try_pack_ack_packet(gquic_packed_packet_t *const packed_
         }
     }
     if (payload.ack == NULL) {
-        if (gquic_packet_received_packet_handlers_get_ack_frame(&payload.ack, packer->acks, GQUIC_ENC_LV_1RTT) != 0) {
+        if (gquic_packet_received_packet_handlers_get_ack_frame(&payload.ack, packer->acks, GQUIC_ENC_LV_1RTT, 1) != 0) {
             gquic_packed_packet_payload_dtor(&payload);
             return -4;
         }
@@ -714,13 +745,14 @@ int gquic_packet_packer_try_pack_initial_packet(gquic_packed_packet_t *const pac
         return ret;
     }
     payload.sealer.cb = gquic_common_long_header_sealer_seal_wrapper;
-    if (gquic_packet_received_packet_handlers_get_ack_frame(&payload.ack, packer->acks, GQUIC_ENC_LV_INITIAL) != 0) {
+    has_retransmission = gquic_retransmission_queue_has_initial(packer->retransmission_queue);
+    if (gquic_packet_received_packet_handlers_get_ack_frame(&payload.ack, packer->acks, GQUIC_ENC_LV_INITIAL,
+                                                            !gquic_crypto_stream_has_data(packer->initial_stream) && !has_retransmission) != 0) {
         return -3;
     }
     if (payload.ack != NULL) {
         payload.len = GQUIC_FRAME_SIZE(payload.ack);
     }
-    has_retransmission = gquic_retransmission_queue_has_initial(packer->retransmission_queue);
     if (!gquic_crypto_stream_has_data(packer->initial_stream) && !has_retransmission && payload.ack == NULL) {
         gquic_packed_packet_payload_dtor(&payload);
         return 0;
@@ -755,13 +787,14 @@ int gquic_packet_packer_try_pack_handshake_packet(gquic_packed_packet_t *const p
                                                               packer->est)) != 0) {
         return ret;
     }
-    if (gquic_packet_received_packet_handlers_get_ack_frame(&payload.ack, packer->acks, GQUIC_ENC_LV_INITIAL) != 0) {
+    has_retransmission = gquic_retransmission_queue_has_initial(packer->retransmission_queue);
+    if (gquic_packet_received_packet_handlers_get_ack_frame(&payload.ack, packer->acks, GQUIC_ENC_LV_INITIAL,
+                                                            !gquic_crypto_stream_has_data(packer->initial_stream) && !has_retransmission) != 0) {
         return -4;
     }
     if (payload.ack != NULL) {
         payload.len = GQUIC_FRAME_SIZE(payload.ack);
     }
-    has_retransmission = gquic_retransmission_queue_has_initial(packer->retransmission_queue);
     if (!gquic_crypto_stream_has_data(packer->initial_stream) && !has_retransmission && payload.ack == NULL) {
         gquic_packed_packet_payload_dtor(&payload);
         return 0;
@@ -789,29 +822,50 @@ int gquic_packet_packer_try_pack_app_packet(gquic_packed_packet_t *const packed_
     gquic_packed_packet_payload_t payload;
     void *frame = NULL;
     void **frame_storage = NULL;
+    int is_0rtt = 0;
     if (packed_packet == NULL || packer == NULL) {
         return -1;
     }
     gquic_packed_packet_payload_init(&payload);
     if (!packer->est->has_1rtt_sealer) {
-        return 0;
+        if (!packer->is_client || !packer->est->zero_rtt_sealer.available) {
+            return 0;
+        }
+        is_0rtt = 1;
     }
     if ((payload.frames = malloc(sizeof(gquic_list_t))) == NULL) {
         return -2;
     }
     gquic_list_head_init(payload.frames);
-    payload.sealer.cb = gquic_1rtt_sealer_seal_wrapper;
-    gquic_handshake_establish_get_1rtt_sealer(&payload.header_sealer,
-                                              (gquic_auto_update_aead_t **) &payload.sealer.self,
-                                              packer->est);
-    if (gquic_packet_packer_get_short_header(&payload.hdr, packer, packer->est->aead.times) != 0) {
-        gquic_packed_packet_payload_dtor(&payload);
-        return -3;
+    if (is_0rtt) {
+        payload.enc_lv = GQUIC_ENC_LV_0RTT;
+        payload.sealer.cb = gquic_common_long_header_sealer_seal_wrapper;
+        if (gquic_handshake_establish_get_0rtt_sealer(&payload.header_sealer,
+                                                      (gquic_common_long_header_sealer_t **) &payload.sealer.self,
+                                                      packer->est) != 0
+            || gquic_packet_packer_get_long_header(&payload.hdr, packer, GQUIC_ENC_LV_0RTT) != 0) {
+            gquic_packed_packet_payload_dtor(&payload);
+            return -3;
+        }
+        header_len = gquic_packet_long_header_size(payload.hdr.hdr.l_hdr);
+    }
+    else {
+        payload.sealer.cb = gquic_1rtt_sealer_seal_wrapper;
+        gquic_handshake_establish_get_1rtt_sealer(&payload.header_sealer,
+                                                  (gquic_auto_update_aead_t **) &payload.sealer.self,
+                                                  packer->est);
+        if (gquic_packet_packer_get_short_header(&payload.hdr, packer, packer->est->aead.times) != 0) {
+            gquic_packed_packet_payload_dtor(&payload);
+            return -3;
+        }
+        header_len = gquic_packet_short_header_size(payload.hdr.hdr.s_hdr);
     }
-    header_len = gquic_packet_short_header_size(payload.hdr.hdr.s_hdr);
     max_size = packer->max_packet_size - 16 - header_len;
 
-    if (gquic_packet_received_packet_handlers_get_ack_frame(&payload.ack, packer->acks, GQUIC_ENC_LV_1RTT) != 0) {
+    // acknowledgements are never sent in 0-RTT packets, and go out alone only once they are due
+    if (!is_0rtt && gquic_packet_received_packet_handlers_get_ack_frame(&payload.ack, packer->acks, GQUIC_ENC_LV_1RTT,
+                                                                        gquic_list_head_empty(&packer->retransmission_queue->app)
+                                                                        && !gquic_framer_has_data(packer->framer)) != 0) {
         gquic_packed_packet_payload_dtor(&payload);
         return -4;
     }
@@ -999,11 +1053,19 @@ int gquic_packet_packer_try_pack_packet(gquic_packed_packet_t *const packed_pack
 
 int gquic_packet_packer_pack_packet(gquic_packed_packet_t *const packed_packet,
                                     gquic_packet_packer_t *const packer) {
+    int ret = 0;
     if (packed_packet == NULL || packer == NULL) {
         return -1;
     }
     if (!gquic_packet_packer_handshake_confirmed(packer)) {
-        return gquic_packet_packer_try_pack_crypto_packet(packed_packet, packer);
+        if ((ret = gquic_packet_packer_try_pack_crypto_packet(packed_packet, packer)) != 0 || packed_packet->valid == 1) {
+            return ret;
+        }
+        // with nothing left to say in the handshake, a client spends the flight on early data
+        if (packer->is_client && !packer->est->has_1rtt_sealer) {
+            return gquic_packet_packer_try_pack_app_packet(packed_packet, packer);
+        }
+        return 0;
     }
 
     return gquic_packet_packer_try_pack_app_packet(packed_packet, packer);
@@ -1027,3 +1089,62 @@ int gquic_packet_packer_try_pack_probe_packet(gquic_packed_packet_t *const packe
         return -2;
     }
 }
+
+static int gquic_packet_packer_flush_batch(gquic_packet_packer_batch_t *const batch) {
+    gquic_str_t headers[GQUIC_TLS_AEAD_MAX_BATCH];
+    gquic_str_t samples[GQUIC_TLS_AEAD_MAX_BATCH];
+    u_int8_t *first_bytes[GQUIC_TLS_AEAD_MAX_BATCH];
+    size_t i;
+    if (batch->count == 0) {
+        return 0;
+    }
+    if (gquic_auto_update_aead_seal_batch(batch->tags, batch->texts, batch->sealer, batch->pns, batch->addatas, batch->count) != 0) {
+        return -1;
+    }
+    // header masks are sampled from the cipher text, so they are computed only after the whole batch is sealed
+    for (i = 0; i < batch->count; i++) {
+        headers[i].size = batch->pn_lens[i];
+        headers[i].val = GQUIC_STR_VAL(&batch->addatas[i]) + GQUIC_STR_SIZE(&batch->addatas[i]) - batch->pn_lens[i];
+        samples[i].size = 16;
+        samples[i].val = GQUIC_STR_VAL(&headers[i]) + 4;
+        first_bytes[i] = GQUIC_STR_VAL(&batch->addatas[i]);
+    }
+    // all masks of the batch in one call, AES computes them in a single pass
+    if (GQUIC_HEADER_PROTECTOR_APPLY_BATCH(headers, first_bytes, batch->header_sealer, samples, batch->count) != 0) {
+        return -2;
+    }
+    batch->count = 0;
+    return 0;
+}
+
+int gquic_packet_packer_pack_app_packets(gquic_packed_packet_t *const packed_packets,
+                                         size_t *const count,
+                                         gquic_packet_packer_t *const packer,
+                                         const size_t max_count) {
+    int ret = 0;
+    gquic_packet_packer_batch_t batch;
+    if (packed_packets == NULL || count == NULL || packer == NULL) {
+        return -1;
+    }
+    *count = 0;
+    batch.count = 0;
+    batch.sealer = NULL;
+    batch.header_sealer = NULL;
+    packer->batch = &batch;
+    while (*count < max_count && *count < GQUIC_TLS_AEAD_MAX_BATCH) {
+        gquic_packed_packet_init(&packed_packets[*count]);
+        if (gquic_packet_packer_try_pack_app_packet(&packed_packets[*count], packer) != 0) {
+            ret = -2;
+            break;
+        }
+        if (!packed_packets[*count].valid) {
+            break;
+        }
+        (*count)++;
+    }
+    packer->batch = NULL;
+    if (gquic_packet_packer_flush_batch(&batch) != 0 && ret == 0) {
+        ret = -3;
+    }
+    return ret;
+}
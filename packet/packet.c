@@ -12,6 +12,11 @@ int gquic_packet_init(gquic_packet_t *const packet) {
     packet->enc_lv = 0;
     packet->send_time = 0;
     packet->included_infly = 0;
+    packet->ecn = 0;
+    packet->delivered = 0;
+    packet->delivered_time = 0;
+    packet->first_sent_time = 0;
+    packet->is_app_limited = 0;
     packet->frames = NULL;
 
     return 0;
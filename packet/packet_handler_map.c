@@ -4,6 +4,9 @@
 #include "net/conn.h"
 #include "util/timeout.h"
 #include <sys/time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <string.h>
 #include <openssl/rand.h>
 
 typedef struct __send_stateless_reset_param_s __send_stateless_reset_param_t;
@@ -40,6 +43,7 @@ struct __replace_with_closed_timeout_param_s {
 };
 
 static void *__packet_handler_map_listen(void *const);
+static u_int8_t __packet_handler_map_ecn(struct msghdr *const);
 static void *__packet_handler_map_try_send_stateless_reset(void *const);
 static int gquic_packet_handler_map_try_handle_stateless_reset(gquic_packet_handler_map_t *const, const gquic_str_t *const);
 static int gquic_packet_handler_rb_str_cmp(void *const, void *const);
@@ -93,6 +97,8 @@ int gquic_packet_handler_map_ctor(gquic_packet_handler_map_t *const handler,
         return -1;
     }
     handler->conn_fd = conn_fd;
+    // best effort, without it every packet reads as not ECN capable
+    gquic_net_enable_recv_ecn(conn_fd);
     handler->conn_id_len = conn_id_len;
     handler->delete_retired_session_after = 5 * 1000 * 1000;
     handler->stateless_reset_enabled = GQUIC_STR_SIZE(stateless_reset_token) > 0;
@@ -147,20 +153,29 @@ static void *__packet_handler_map_listen(void *const handler_) {
     gquic_packet_handler_map_t *handler = handler_;
     ssize_t recv_len = 0;
     char addr[sizeof(struct sockaddr_in6) > sizeof(struct sockaddr_in) ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in)] = { 0 };
-    socklen_t addr_len = 0;
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    struct msghdr msg;
+    struct iovec iov;
     if (handler == NULL) {
         return NULL;
     }
     for ( ;; ) {
-        addr_len = 0;
         if (gquic_packet_buffer_get(&buffer) != 0) {
             break;
         }
-        if ((recv_len = recvfrom(handler->conn_fd,
-                                 GQUIC_STR_VAL(&buffer->slice),
-                                 GQUIC_STR_SIZE(&buffer->slice),
-                                 0,
-                                 (struct sockaddr *) addr, &addr_len)) <= 0) {
+        iov.iov_base = GQUIC_STR_VAL(&buffer->slice);
+        iov.iov_len = GQUIC_STR_SIZE(&buffer->slice);
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_name = addr;
+        msg.msg_namelen = sizeof(addr);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+        if ((recv_len = recvmsg(handler->conn_fd, &msg, 0)) <= 0) {
             gquic_packet_handler_map_listen_close(handler, -1002);
             break;
         }
@@ -176,7 +191,8 @@ static void *__packet_handler_map_listen(void *const handler_) {
         struct timezone tz;
         gettimeofday(&tv, &tz);
         recv_packet->recv_time = tv.tv_sec * 1000 * 1000 + tv.tv_usec;
-        if (addr_len == sizeof(struct sockaddr_in6)) {
+        recv_packet->ecn = __packet_handler_map_ecn(&msg);
+        if (msg.msg_namelen == sizeof(struct sockaddr_in6)) {
             recv_packet->remote_addr.type = AF_INET6;
             recv_packet->remote_addr.addr.v6 = *(struct sockaddr_in6 *) addr;
         }
@@ -191,6 +207,22 @@ static void *__packet_handler_map_listen(void *const handler_) {
     return NULL;
 }
 
+static u_int8_t __packet_handler_map_ecn(struct msghdr *const msg) {
+    struct cmsghdr *cmsg = NULL;
+    int tclass = 0;
+    for (cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        // IPv4 hands the TOS byte back as a single byte, IPv6 the traffic class as an int
+        if (cmsg->cmsg_level == IPPROTO_IP && (cmsg->cmsg_type == IP_TOS || cmsg->cmsg_type == IP_RECVTOS)) {
+            return *(u_int8_t *) CMSG_DATA(cmsg) & GQUIC_NET_ECN_MASK;
+        }
+        if (cmsg->cmsg_level == IPPROTO_IPV6 && cmsg->cmsg_type == IPV6_TCLASS) {
+            memcpy(&tclass, CMSG_DATA(cmsg), sizeof(int));
+            return tclass & GQUIC_NET_ECN_MASK;
+        }
+    }
+    return GQUIC_NET_ECN_NOT_ECT;
+}
+
 int gquic_packet_handler_map_handle_packet(gquic_packet_handler_map_t *const handler, gquic_received_packet_t *const recv_packet) {
     int ret = 0;
     const gquic_rbtree_t *rbt = NULL;
@@ -90,6 +90,7 @@ int gquic_packet_number_gen_next(u_int64_t *const pn, gquic_packet_number_gen_t
         }
         *mem_pn = gen->next;
         gquic_list_insert_before(&gen->mem, mem_pn);
+        gen->mem_count++;
         gen->next++;
         gquic_packet_number_gen_new_skip(gen);
     }
@@ -0,0 +1,139 @@
+#include "packet/rate_sampler.h"
+
+int gquic_packet_rate_sample_init(gquic_packet_rate_sample_t *const sample) {
+    if (sample == NULL) {
+        return -1;
+    }
+    sample->delivery_rate = 0;
+    sample->delivered = 0;
+    sample->interval = 0;
+    sample->prior_delivered = 0;
+    sample->prior_time = 0;
+    sample->send_elapsed = 0;
+    sample->ack_elapsed = 0;
+    sample->is_app_limited = 0;
+    return 0;
+}
+
+int gquic_packet_rate_sampler_init(gquic_packet_rate_sampler_t *const sampler) {
+    if (sampler == NULL) {
+        return -1;
+    }
+    sampler->delivered = 0;
+    sampler->delivered_time = 0;
+    sampler->first_sent_time = 0;
+    sampler->app_limited = 0;
+    sampler->has_sample = 0;
+    gquic_packet_rate_sample_init(&sampler->sample);
+    sampler->round_count = 0;
+    sampler->next_round_delivered = 0;
+    gquic_max_filter_init(&sampler->bw_filter, GQUIC_PACKET_RATE_SAMPLER_BW_FILTER_ROUNDS);
+    gquic_packet_rate_sample_init(&sampler->latest);
+    sampler->samples = 0;
+    sampler->app_limited_samples = 0;
+    return 0;
+}
+
+int gquic_packet_rate_sampler_on_packet_sent(gquic_packet_rate_sampler_t *const sampler,
+                                             gquic_packet_t *const packet,
+                                             const u_int64_t prior_infly) {
+    if (sampler == NULL || packet == NULL) {
+        return -1;
+    }
+    // sending from idle: the intervals start now, not when the last flight ended
+    if (prior_infly == 0) {
+        sampler->first_sent_time = packet->send_time;
+        sampler->delivered_time = packet->send_time;
+    }
+    packet->delivered = sampler->delivered;
+    packet->delivered_time = sampler->delivered_time;
+    packet->first_sent_time = sampler->first_sent_time;
+    packet->is_app_limited = sampler->app_limited != 0;
+    return 0;
+}
+
+int gquic_packet_rate_sampler_on_packet_acked(gquic_packet_rate_sampler_t *const sampler,
+                                              const gquic_packet_t *const packet,
+                                              const u_int64_t now) {
+    if (sampler == NULL || packet == NULL) {
+        return -1;
+    }
+    sampler->delivered += packet->len;
+    sampler->delivered_time = now;
+    if (packet->delivered >= sampler->next_round_delivered) {
+        sampler->round_count++;
+        sampler->next_round_delivered = sampler->delivered;
+    }
+
+    // the sample is taken over the most recently sent packet of the ack
+    if (!sampler->has_sample || packet->delivered >= sampler->sample.prior_delivered) {
+        sampler->has_sample = 1;
+        sampler->sample.prior_delivered = packet->delivered;
+        sampler->sample.prior_time = packet->delivered_time;
+        sampler->sample.is_app_limited = packet->is_app_limited;
+        sampler->sample.send_elapsed = packet->send_time - packet->first_sent_time;
+        sampler->sample.ack_elapsed = sampler->delivered_time - packet->delivered_time;
+        sampler->first_sent_time = packet->send_time;
+    }
+    return 0;
+}
+
+int gquic_packet_rate_sampler_on_app_limited(gquic_packet_rate_sampler_t *const sampler, const u_int64_t infly) {
+    if (sampler == NULL) {
+        return -1;
+    }
+    // packets sent until what is in flight now has been delivered carry the flag
+    sampler->app_limited = sampler->delivered + infly > 0 ? sampler->delivered + infly : 1;
+    return 0;
+}
+
+int gquic_packet_rate_sampler_generate(gquic_packet_rate_sample_t *const sample,
+                                       gquic_packet_rate_sampler_t *const sampler,
+                                       const u_int64_t min_rtt) {
+    if (sample == NULL || sampler == NULL) {
+        return -1;
+    }
+    gquic_packet_rate_sample_init(sample);
+    if (sampler->app_limited != 0 && sampler->delivered > sampler->app_limited) {
+        sampler->app_limited = 0;
+    }
+    if (!sampler->has_sample) {
+        return 0;
+    }
+    *sample = sampler->sample;
+    sampler->has_sample = 0;
+    gquic_packet_rate_sample_init(&sampler->sample);
+
+    sample->delivered = sampler->delivered - sample->prior_delivered;
+    sample->interval = sample->send_elapsed > sample->ack_elapsed ? sample->send_elapsed : sample->ack_elapsed;
+    // shorter than a round trip, the interval only covers part of a flight
+    if (sample->interval == 0 || sample->interval < min_rtt) {
+        return 0;
+    }
+    sample->delivery_rate = sample->delivered * 1000 * 1000 / sample->interval;
+
+    sampler->samples++;
+    if (sample->is_app_limited) {
+        sampler->app_limited_samples++;
+    }
+    if (!sample->is_app_limited || sample->delivery_rate >= gquic_max_filter_get(&sampler->bw_filter)) {
+        gquic_max_filter_update(&sampler->bw_filter, sample->delivery_rate, sampler->round_count);
+    }
+    sampler->latest = *sample;
+    return 0;
+}
+
+int gquic_packet_rate_sampler_stats(gquic_packet_rate_stats_t *const stats, const gquic_packet_rate_sampler_t *const sampler) {
+    if (stats == NULL || sampler == NULL) {
+        return -1;
+    }
+    stats->bandwidth = gquic_max_filter_get(&sampler->bw_filter);
+    stats->latest_rate = sampler->latest.delivery_rate;
+    stats->latest_interval = sampler->latest.interval;
+    stats->latest_app_limited = sampler->latest.is_app_limited;
+    stats->delivered = sampler->delivered;
+    stats->round_count = sampler->round_count;
+    stats->samples = sampler->samples;
+    stats->app_limited_samples = sampler->app_limited_samples;
+    return 0;
+}
@@ -7,6 +7,7 @@ int gquic_received_packet_init(gquic_received_packet_t *const recv_packet) {
     }
     gquic_net_addr_init(&recv_packet->remote_addr);
     recv_packet->recv_time = 0;
+    recv_packet->ecn = 0;
     gquic_str_init(&recv_packet->data);
     recv_packet->buffer = NULL;
     gquic_str_init(&recv_packet->dst_conn_id);
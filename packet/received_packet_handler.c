@@ -1,21 +1,31 @@
 #include "packet/received_packet_handler.h"
 #include "frame/meta.h"
 #include "tls/common.h"
+#include "net/conn.h"
 #include <time.h>
 #include <malloc.h>
+#include <string.h>
 
-static int gquic_packet_received_mem_add(gquic_packet_received_mem_t *const, const u_int64_t);
+static int gquic_packet_received_mem_slide(gquic_packet_received_mem_t *const, const u_int64_t);
+static int gquic_packet_received_mem_add_range(gquic_packet_received_mem_t *const, const u_int64_t);
 
 static int gquic_packet_received_packet_handler_miss(const gquic_packet_received_packet_handler_t *const, const u_int64_t);
 static int gquic_packet_received_packet_handler_has_miss_packet(const gquic_packet_received_packet_handler_t *const);
+static int gquic_packet_received_packet_handler_reordered(const gquic_packet_received_packet_handler_t *const);
+
+#define GQUIC_PACKET_RECEIVED_MEM_TEST(mem, i) (((mem)->window[(i) / 64] >> ((i) % 64)) & 1)
+#define GQUIC_PACKET_RECEIVED_MEM_SET(mem, i) ((mem)->window[(i) / 64] |= ((u_int64_t) 1) << ((i) % 64))
+#define GQUIC_PACKET_RECEIVED_MEM_CLEAR(mem, i) ((mem)->window[(i) / 64] &= ~(((u_int64_t) 1) << ((i) % 64)))
 
 int gquic_packet_received_mem_init(gquic_packet_received_mem_t *const mem) {
     if (mem == NULL) {
          return -1;
     }
-    gquic_list_head_init(&mem->ranges);
+    mem->received = 0;
+    mem->largest = 0;
+    memset(mem->window, 0, sizeof(mem->window));
+    mem->intervals_count = 0;
     mem->deleted_below = 0;
-    mem->ranges_count = 0;
 
     return 0;
 }
@@ -24,9 +34,9 @@ int gquic_packet_received_mem_dtor(gquic_packet_received_mem_t *const mem) {
     if (mem == NULL) {
         return -1;
     }
-    while (!gquic_list_head_empty(&mem->ranges)) {
-        gquic_list_release(GQUIC_LIST_FIRST(&mem->ranges));
-    }
+    mem->received = 0;
+    memset(mem->window, 0, sizeof(mem->window));
+    mem->intervals_count = 0;
     return 0;
 }
 
@@ -37,85 +47,109 @@ int gquic_packet_reveived_mem_received(gquic_packet_received_mem_t *const mem, c
     if (pn < mem->deleted_below) {
         return 0;
     }
-
-    gquic_packet_received_mem_add(mem, pn);
-    if (mem->ranges_count > 500) {
-        mem->ranges_count--;
-        gquic_list_release(GQUIC_LIST_FIRST(&mem->ranges));
+    if (!mem->received) {
+        mem->received = 1;
+        mem->largest = pn;
+        memset(mem->window, 0, sizeof(mem->window));
+        GQUIC_PACKET_RECEIVED_MEM_SET(mem, 0);
+        return gquic_packet_received_mem_add_range(mem, pn);
+    }
+    if (pn > mem->largest) {
+        gquic_packet_received_mem_slide(mem, pn - mem->largest);
+        mem->largest = pn;
+        GQUIC_PACKET_RECEIVED_MEM_SET(mem, 0);
+        return gquic_packet_received_mem_add_range(mem, pn);
+    }
+    if (mem->largest - pn < GQUIC_PACKET_RECEIVED_MEM_WINDOW) {
+        // a duplicate leaves the ranges as they are
+        if (GQUIC_PACKET_RECEIVED_MEM_TEST(mem, mem->largest - pn)) {
+            return 0;
+        }
+        GQUIC_PACKET_RECEIVED_MEM_SET(mem, mem->largest - pn);
     }
-    return 0;
+
+    return gquic_packet_received_mem_add_range(mem, pn);
 }
 
-static int gquic_packet_received_mem_add(gquic_packet_received_mem_t *const mem, const u_int64_t pn) {
-    gquic_packet_interval_t *interval = NULL;
-    gquic_packet_interval_t *prev_interval = NULL;
+static int gquic_packet_received_mem_slide(gquic_packet_received_mem_t *const mem, const u_int64_t shift) {
+    int i = 0;
+    int word_shift = 0;
+    int bit_shift = 0;
     if (mem == NULL) {
         return -1;
     }
-    if (gquic_list_head_empty(&mem->ranges)) {
-        if ((interval = malloc(sizeof(gquic_packet_interval_t))) == NULL) {
-            return -1;
-        }
-        interval->end = pn;
-        interval->start = pn;
-        mem->ranges_count++;
-        if (gquic_list_insert_before(&mem->ranges, interval) != 0) {
-            return -2;
-        }
+    if (shift >= GQUIC_PACKET_RECEIVED_MEM_WINDOW) {
+        memset(mem->window, 0, sizeof(mem->window));
         return 0;
     }
 
-    GQUIC_LIST_RFOREACH(interval, &mem->ranges) {
-        if (interval->start <= pn && pn <= interval->end) {
-            return 0;
-        }
-
-        int extended = 0;
-        if (interval->end + 1 == pn) {
-            extended = 1;
-            interval->end++;
-        }
-        else if (interval->start - 1 == pn) {
-            extended = 1;
-            interval->start--;
-        }
-
-        if (extended) {
-            prev_interval = gquic_list_prev(interval);
-            if (prev_interval != GQUIC_LIST_PAYLOAD(&mem->ranges) && prev_interval->end + 1 == interval->start) {
-                prev_interval->end = interval->end;
-                gquic_list_release(interval);
-                return 0;
+    word_shift = shift / 64;
+    bit_shift = shift % 64;
+    for (i = GQUIC_PACKET_RECEIVED_MEM_WINDOW / 64 - 1; i >= 0; i--) {
+        u_int64_t word = 0;
+        if (i - word_shift >= 0) {
+            word = mem->window[i - word_shift] << bit_shift;
+            if (bit_shift != 0 && i - word_shift - 1 >= 0) {
+                word |= mem->window[i - word_shift - 1] >> (64 - bit_shift);
             }
-            return 0;
-        }
-
-        if (pn > interval->end) {
-            prev_interval = interval;
-            if ((interval = gquic_list_alloc(sizeof(gquic_packet_interval_t))) == NULL) {
-                return -3;
-            }
-            interval->start = pn;
-            interval->end = pn;
-            mem->ranges_count++;
-            gquic_list_insert_after(&GQUIC_LIST_META(prev_interval), interval);
-            return 0;
         }
+        mem->window[i] = word;
     }
+    return 0;
+}
 
-    if ((interval = gquic_list_alloc(sizeof(gquic_packet_interval_t))) == NULL) {
-        return -4;
+/*
+ * the ranges are searched from the highest one down, so a packet in order
+ * extends the highest range and a reordered one stops a few ranges below it.
+ */
+static int gquic_packet_received_mem_add_range(gquic_packet_received_mem_t *const mem, const u_int64_t pn) {
+    int i = 0;
+    int below = 0;
+    int above = 0;
+    if (mem == NULL) {
+        return -1;
     }
-    interval->end = pn;
-    interval->start = pn;
-    mem->ranges_count++;
-    gquic_list_insert_after(&mem->ranges, interval);
+    for (i = mem->intervals_count - 1; i >= 0 && mem->intervals[i].start > pn; i--);
+    if (i >= 0 && mem->intervals[i].end >= pn) {
+        return 0;
+    }
+    // pn lies between intervals[i] and intervals[i + 1], either may not exist
+    below = i >= 0 && mem->intervals[i].end + 1 == pn;
+    above = i + 1 < mem->intervals_count && mem->intervals[i + 1].start == pn + 1;
+    if (below && above) {
+        mem->intervals[i].end = mem->intervals[i + 1].end;
+        memmove(mem->intervals + i + 1, mem->intervals + i + 2,
+                (mem->intervals_count - i - 2) * sizeof(gquic_packet_interval_t));
+        mem->intervals_count--;
+        return 0;
+    }
+    if (below) {
+        mem->intervals[i].end = pn;
+        return 0;
+    }
+    if (above) {
+        mem->intervals[i + 1].start = pn;
+        return 0;
+    }
+    if (mem->intervals_count == GQUIC_PACKET_RECEIVED_MEM_MAX_INTERVALS) {
+        // full: the oldest range is forgotten, or pn itself if it is older still
+        if (i < 0) {
+            return 0;
+        }
+        memmove(mem->intervals, mem->intervals + 1, (mem->intervals_count - 1) * sizeof(gquic_packet_interval_t));
+        mem->intervals_count--;
+        i--;
+    }
+    memmove(mem->intervals + i + 2, mem->intervals + i + 1, (mem->intervals_count - i - 1) * sizeof(gquic_packet_interval_t));
+    mem->intervals[i + 1].start = pn;
+    mem->intervals[i + 1].end = pn;
+    mem->intervals_count++;
     return 0;
 }
 
 int gquic_packet_received_mem_delete_below(gquic_packet_received_mem_t *const mem, const u_int64_t pn) {
-    gquic_packet_interval_t *prev = NULL;
-    gquic_packet_interval_t *cur = NULL;
+    u_int64_t i = 0;
+    int dropped = 0;
     if (mem == NULL) {
         return -1;
     }
@@ -123,22 +157,95 @@ int gquic_packet_received_mem_delete_below(gquic_packet_received_mem_t *const me
         return 0;
     }
     mem->deleted_below = pn;
-    prev = GQUIC_LIST_FIRST(&mem->ranges);
-    GQUIC_LIST_FOREACH(cur, &mem->ranges) {
-        prev = gquic_list_prev(cur);
+    for (dropped = 0; dropped < mem->intervals_count && mem->intervals[dropped].end < pn; dropped++);
+    memmove(mem->intervals, mem->intervals + dropped, (mem->intervals_count - dropped) * sizeof(gquic_packet_interval_t));
+    mem->intervals_count -= dropped;
+    if (mem->intervals_count > 0 && mem->intervals[0].start < pn) {
+        mem->intervals[0].start = pn;
+    }
+    if (!mem->received) {
+        return 0;
+    }
+    if (pn > mem->largest) {
+        memset(mem->window, 0, sizeof(mem->window));
+        return 0;
+    }
+    for (i = mem->largest - pn + 1; i < GQUIC_PACKET_RECEIVED_MEM_WINDOW; i++) {
+        GQUIC_PACKET_RECEIVED_MEM_CLEAR(mem, i);
+    }
 
-        if (cur->end < pn) {
-            gquic_list_release(cur);
-            cur = prev;
+    return 0;
+}
+
+int gquic_packet_received_mem_contains(const gquic_packet_received_mem_t *const mem, const u_int64_t pn) {
+    int low = 0;
+    int high = 0;
+    int mid = 0;
+    if (mem == NULL || !mem->received) {
+        return 0;
+    }
+    if (pn < mem->deleted_below || pn > mem->largest) {
+        return 0;
+    }
+    if (mem->largest - pn < GQUIC_PACKET_RECEIVED_MEM_WINDOW) {
+        return GQUIC_PACKET_RECEIVED_MEM_TEST(mem, mem->largest - pn);
+    }
+    high = mem->intervals_count - 1;
+    while (low <= high) {
+        mid = (low + high) / 2;
+        if (mem->intervals[mid].end < pn) {
+            low = mid + 1;
         }
-        else if (cur->start < pn && pn <= cur->end) {
-            cur->start = pn;
-            return 0;
+        else if (mem->intervals[mid].start > pn) {
+            high = mid - 1;
         }
         else {
-            return 0;
+            return 1;
         }
     }
+    return 0;
+}
+
+int gquic_packet_received_mem_empty(const gquic_packet_received_mem_t *const mem) {
+    if (mem == NULL) {
+        return 1;
+    }
+    return mem->intervals_count == 0;
+}
+
+u_int64_t gquic_packet_received_mem_highest_range_start(const gquic_packet_received_mem_t *const mem) {
+    if (mem == NULL || !mem->received || mem->intervals_count == 0) {
+        return 0;
+    }
+    return mem->intervals[mem->intervals_count - 1].start;
+}
+
+/*
+ * the ranges are disjoint and never adjacent, so each one past the highest
+ * is one ACK range; nothing is scanned or merged here.
+ */
+int gquic_packet_received_mem_fill_ack_frame(gquic_frame_ack_t *const ack, const gquic_packet_received_mem_t *const mem) {
+    int i = 0;
+    const gquic_packet_interval_t *prev = NULL;
+    if (ack == NULL || mem == NULL) {
+        return -1;
+    }
+    ack->count = 0;
+    ack->first_range = 0;
+    ack->largest_ack = 0;
+    if (!mem->received || mem->intervals_count == 0) {
+        return 0;
+    }
+
+    prev = &mem->intervals[mem->intervals_count - 1];
+    ack->largest_ack = prev->end;
+    ack->first_range = prev->end - prev->start;
+    for (i = mem->intervals_count - 2; i >= 0 && ack->count < GQUIC_FRAME_ACK_MAX_RANGES; i--) {
+        ack->ranges[ack->count].gap = prev->start - mem->intervals[i].end - 2;
+        ack->ranges[ack->count].range = mem->intervals[i].end - mem->intervals[i].start;
+        ack->count++;
+        prev = &mem->intervals[i];
+    }
 
     return 0;
 }
@@ -158,7 +265,15 @@ int gquic_packet_received_packet_handler_init(gquic_packet_received_packet_handl
     handler->since_last_ack.packets_count = 0;
     handler->ack_queued = 0;
     handler->ack_alarm = 0;
-    handler->last_ack = NULL;
+    handler->has_last_ack = 0;
+    handler->last_ack_largest = 0;
+    handler->ack_frequency_set = 0;
+    handler->ack_frequency_seq = 0;
+    handler->ack_eliciting_threshold = 1;
+    handler->reordering_threshold = 1;
+    handler->ecn.ect[0] = 0;
+    handler->ecn.ect[1] = 0;
+    handler->ecn.ecn_ce = 0;
 
     return 0;
 }
@@ -179,22 +294,39 @@ int gquic_packet_received_packet_handler_dtor(gquic_packet_received_packet_handl
         return -1;
     }
     gquic_packet_received_mem_dtor(&handler->mem);
-    if (handler->last_ack != NULL) {
-        gquic_frame_release(handler->last_ack);
-    }
     return 0;
 }
 
 int gquic_packet_received_packet_handler_received_packet(gquic_packet_received_packet_handler_t *const handler,
                                                          const u_int64_t pn,
                                                          const u_int64_t recv_time,
-                                                         const int should_inst_ack) {
+                                                         const int should_inst_ack,
+                                                         const u_int8_t ecn) {
+    int is_missing = 0;
     if (handler == NULL) {
         return -1;
     }
     if (pn < handler->ignore_below) {
         return 0;
     }
+    is_missing = gquic_packet_received_packet_handler_miss(handler, pn);
+    // a duplicate is not counted twice
+    if (!gquic_packet_received_mem_contains(&handler->mem, pn)) {
+        switch (ecn) {
+        case GQUIC_NET_ECN_ECT0:
+            handler->ecn.ect[0]++;
+            break;
+        case GQUIC_NET_ECN_ECT1:
+            handler->ecn.ect[1]++;
+            break;
+        case GQUIC_NET_ECN_CE:
+            handler->ecn.ecn_ce++;
+            if (should_inst_ack) {
+                handler->ack_queued = 1;
+            }
+            break;
+        }
+    }
     if (pn >= handler->largest_observed) {
         handler->largest_observed = pn;
         handler->largest_obeserved_time = recv_time;
@@ -204,16 +336,25 @@ int gquic_packet_received_packet_handler_received_packet(gquic_packet_received_p
     }
 
     handler->since_last_ack.packets_count++;
-    if (handler->last_ack == NULL) {
+    if (!handler->has_last_ack) {
         handler->ack_queued = 1;
         return 0;
     }
-    if (gquic_packet_received_packet_handler_miss(handler, pn)) {
+    if (is_missing && (!handler->ack_frequency_set || handler->reordering_threshold != 0)) {
         handler->ack_queued = 1;
     }
     if (!handler->ack_queued && should_inst_ack) {
         handler->since_last_ack.ack_eliciting_count++;
-        if (pn > 100) {
+        if (handler->ack_frequency_set) {
+            if ((u_int64_t) handler->since_last_ack.ack_eliciting_count > handler->ack_eliciting_threshold
+                || gquic_packet_received_packet_handler_reordered(handler)) {
+                handler->ack_queued = 1;
+            }
+            else if (handler->ack_alarm == 0) {
+                handler->ack_alarm = recv_time + handler->max_ack_delay;
+            }
+        }
+        else if (pn > 100) {
             if (handler->since_last_ack.ack_eliciting_count >= 10) {
                 handler->ack_queued = 1;
             }
@@ -231,7 +372,7 @@ int gquic_packet_received_packet_handler_received_packet(gquic_packet_received_p
                 handler->ack_alarm = recv_time + handler->max_ack_delay;
             }
         }
-        if (gquic_packet_received_packet_handler_has_miss_packet(handler)) {
+        if (!handler->ack_frequency_set && gquic_packet_received_packet_handler_has_miss_packet(handler)) {
             u_int64_t ack_delay = handler->rtt->min / 8;
             u_int64_t ack_time = recv_time + ack_delay;
             if (handler->ack_alarm == 0 || ack_time > handler->ack_alarm) {
@@ -245,64 +386,66 @@ int gquic_packet_received_packet_handler_received_packet(gquic_packet_received_p
     return 0;
 }
 
-int gquic_packet_received_mem_get_blocks(gquic_list_t *const blocks,
-                                         const gquic_packet_received_mem_t *const mem) {
-    gquic_packet_interval_t *interval = NULL;
-    gquic_frame_ack_block_t *block = NULL;
-    if (blocks == NULL || mem == NULL) {
-        return -1;
-    }
-    gquic_list_head_init(blocks);
-    if (mem->ranges_count == 0) {
-        return 0;
-    }
-    GQUIC_LIST_RFOREACH(interval, &mem->ranges) {
-        if ((block = gquic_list_alloc(sizeof(gquic_frame_ack_block_t))) == NULL) {
-            return -2;
-        }
-        block->smallest = interval->start;
-        block->largest = interval->end;
-        gquic_list_insert_before(blocks, block);
-    }
-
-    return 0;
-}
-
 int gquic_packet_received_packet_handler_get_ack_frame(gquic_frame_ack_t **const ack,
-                                                       gquic_packet_received_packet_handler_t *const handler) {
-    gquic_list_t blocks;
+                                                       gquic_packet_received_packet_handler_t *const handler,
+                                                       const int only_if_queued) {
+    struct timeval tv;
+    struct timezone tz;
+    u_int64_t now = 0;
     if (ack == NULL || handler == NULL) {
         return -1;
     }
-    gquic_list_head_init(&blocks);
-    if (gquic_packet_received_mem_get_blocks(&blocks, &handler->mem) != 0) {
-        return -2;
+    if (gquic_packet_received_mem_empty(&handler->mem)) {
+        return 0;
     }
-    if (gquic_list_head_empty(&blocks)) {
+    gettimeofday(&tv, &tz);
+    now = tv.tv_sec * 1000 * 1000 + tv.tv_usec;
+    // an ACK on its own waits until it is due
+    if (only_if_queued && !handler->ack_queued && (handler->ack_alarm == 0 || handler->ack_alarm > now)) {
         return 0;
     }
     if ((*ack = gquic_frame_ack_alloc()) == NULL) {
-        while (!gquic_list_head_empty(&blocks)) {
-            gquic_list_release(GQUIC_LIST_FIRST(&blocks));
-        }
         return -3;
     }
     GQUIC_FRAME_INIT(*ack);
-    struct timeval tv;
-    struct timezone tz;
-    gettimeofday(&tv, &tz);
-    (*ack)->delay = tv.tv_sec * 1000 * 1000 + tv.tv_usec - handler->largest_obeserved_time;
-    gquic_frame_ack_ranges_from_blocks(*ack, &blocks);
+    (*ack)->delay = now - handler->largest_obeserved_time;
+    gquic_packet_received_mem_fill_ack_frame(*ack, &handler->mem);
+    if (handler->ecn.ect[0] != 0 || handler->ecn.ect[1] != 0 || handler->ecn.ecn_ce != 0) {
+        GQUIC_FRAME_META(*ack).type = 0x03;
+        (*ack)->ecn = handler->ecn;
+    }
 
-    handler->last_ack = *ack;
+    handler->has_last_ack = 1;
+    handler->last_ack_largest = (*ack)->largest_ack;
     handler->ack_alarm = 0;
     handler->ack_queued = 0;
     handler->since_last_ack.ack_eliciting_count = 0;
     handler->since_last_ack.packets_count = 0;
 
-    while (!gquic_list_head_empty(&blocks)) {
-        gquic_list_release(GQUIC_LIST_FIRST(&blocks));
+    return 0;
+}
+
+int gquic_packet_received_packet_handler_set_ack_frequency(gquic_packet_received_packet_handler_t *const handler,
+                                                           const gquic_frame_ack_frequency_t *const frame) {
+    if (handler == NULL || frame == NULL) {
+        return -1;
     }
+    if (frame->max_ack_delay < GQUIC_PACKET_RECEIVED_MIN_ACK_DELAY) {
+        return -2;
+    }
+    // reordered or retransmitted frames carry stale values
+    if (handler->ack_frequency_set && frame->seq < handler->ack_frequency_seq) {
+        return 0;
+    }
+    handler->ack_frequency_set = 1;
+    handler->ack_frequency_seq = frame->seq + 1;
+    handler->ack_eliciting_threshold = frame->ack_eliciting_threshold;
+    handler->max_ack_delay = frame->max_ack_delay;
+    handler->reordering_threshold = frame->reordering_threshold;
+    if (handler->ack_alarm != 0 && handler->ack_alarm > handler->largest_obeserved_time + handler->max_ack_delay) {
+        handler->ack_alarm = handler->largest_obeserved_time + handler->max_ack_delay;
+    }
+
     return 0;
 }
 
@@ -314,6 +457,7 @@ int gquic_packet_received_packet_handler_ignore_below(gquic_packet_received_pack
     if (pn <= handler->ignore_below) {
         return 0;
     }
+    handler->ignore_below = pn;
     if (gquic_packet_received_mem_delete_below(&handler->mem, pn) != 0) {
         return -2;
     }
@@ -322,35 +466,53 @@ int gquic_packet_received_packet_handler_ignore_below(gquic_packet_received_pack
 }
 
 static int gquic_packet_received_packet_handler_miss(const gquic_packet_received_packet_handler_t *const handler, const u_int64_t pn) {
-    int ret = 0;
-    gquic_list_t blocks;
     if (handler == NULL) {
         return 0;
     }
-    if (handler->last_ack == NULL || pn < handler->ignore_below) {
+    if (!handler->has_last_ack || pn < handler->ignore_below) {
         return 0;
     }
-    gquic_list_head_init(&blocks);
-    gquic_frame_ack_ranges_to_blocks(&blocks, handler->last_ack);
-    ret = pn < ((gquic_frame_ack_block_t *) GQUIC_LIST_FIRST(&blocks))->largest && gquic_frame_ack_acks_packet(&blocks, pn);
-    while (!gquic_list_head_empty(&blocks)) {
-        gquic_list_release(GQUIC_LIST_FIRST(&blocks));
-    }
-    return ret;
+    return pn < handler->last_ack_largest && !gquic_packet_received_mem_contains(&handler->mem, pn);
 }
 
 static int gquic_packet_received_packet_handler_has_miss_packet(const gquic_packet_received_packet_handler_t *const handler) {
+    u_int64_t start = 0;
     if (handler == NULL) {
         return 0;
     }
-    if (handler->last_ack == NULL) {
+    if (!handler->has_last_ack) {
+        return 0;
+    }
+    if (gquic_packet_received_mem_empty(&handler->mem)) {
+        return 0;
+    }
+    start = gquic_packet_received_mem_highest_range_start(&handler->mem);
+    return start >= handler->last_ack_largest && handler->mem.largest - start + 1 <= 4;
+}
+
+/*
+ * whether a packet is missing at least reordering_threshold below the largest
+ * received one, counting only the packets above the last acknowledged one.
+ * packets that slid out of the window are not looked at.
+ */
+static int gquic_packet_received_packet_handler_reordered(const gquic_packet_received_packet_handler_t *const handler) {
+    u_int64_t pn = 0;
+    if (handler == NULL || handler->reordering_threshold == 0 || !handler->has_last_ack) {
         return 0;
     }
-    if (gquic_list_head_empty(&handler->mem.ranges)) {
+    if (handler->mem.largest < handler->reordering_threshold) {
         return 0;
     }
-    gquic_packet_interval_t *interval = GQUIC_LIST_LAST(&handler->mem.ranges);
-    return interval->start >= handler->last_ack->largest_ack && interval->end - interval->start + 1 <= 4;
+    pn = handler->last_ack_largest + 1;
+    if (handler->mem.largest >= GQUIC_PACKET_RECEIVED_MEM_WINDOW && pn <= handler->mem.largest - GQUIC_PACKET_RECEIVED_MEM_WINDOW) {
+        pn = handler->mem.largest - GQUIC_PACKET_RECEIVED_MEM_WINDOW + 1;
+    }
+    for (; pn <= handler->mem.largest - handler->reordering_threshold; pn++) {
+        if (!gquic_packet_received_mem_contains(&handler->mem, pn)) {
+            return 1;
+        }
+    }
+    return 0;
 }
 
 int gquic_packet_received_packet_handlers_init(gquic_packet_received_packet_handlers_t *const handlers) {
@@ -400,7 +562,8 @@ int gquic_packet_received_packet_handlers_received_packet(gquic_packet_received_
                                                           const u_int64_t pn,
                                                           const u_int64_t recv_time,
                                                           const int should_inst_ack,
-                                                          const u_int8_t enc_lv) {
+                                                          const u_int8_t enc_lv,
+                                                          const u_int8_t ecn) {
     if (handlers == NULL) {
         return -1;
     }
@@ -409,17 +572,19 @@ int gquic_packet_received_packet_handlers_received_packet(gquic_packet_received_
         if (handlers->initial_dropped) {
             return -2;
         }
-        return gquic_packet_received_packet_handler_received_packet(&handlers->initial, pn, recv_time, should_inst_ack);
+        return gquic_packet_received_packet_handler_received_packet(&handlers->initial, pn, recv_time, should_inst_ack, ecn);
     case GQUIC_ENC_LV_HANDSHAKE:
         if (handlers->handshake_dropped) {
             return -3;
         }
-        return gquic_packet_received_packet_handler_received_packet(&handlers->handshake, pn, recv_time, should_inst_ack);
+        return gquic_packet_received_packet_handler_received_packet(&handlers->handshake, pn, recv_time, should_inst_ack, ecn);
+    case GQUIC_ENC_LV_0RTT:
+        // 0-RTT and 1-RTT packets share the application data number space
     case GQUIC_ENC_LV_1RTT:
         if (handlers->one_rtt_dropped) {
             return -4;
         }
-        return gquic_packet_received_packet_handler_received_packet(&handlers->one_rtt, pn, recv_time, should_inst_ack);
+        return gquic_packet_received_packet_handler_received_packet(&handlers->one_rtt, pn, recv_time, should_inst_ack, ecn);
     default:
         return -5;
     }
@@ -471,10 +636,10 @@ u_int64_t gquic_packet_received_packet_handlers_get_alarm_timeout(gquic_packet_r
     if (initial_alarm != 0) {
         ret = initial_alarm;
     }
-    if (handshake_alarm < ret && handshake_alarm != 0) {
+    if (handshake_alarm != 0 && (ret == 0 || handshake_alarm < ret)) {
         ret = handshake_alarm;
     }
-    if (one_rtt_alarm < ret && one_rtt_alarm != 0) {
+    if (one_rtt_alarm != 0 && (ret == 0 || one_rtt_alarm < ret)) {
         ret = one_rtt_alarm;
     }
     return ret;
@@ -482,27 +647,28 @@ u_int64_t gquic_packet_received_packet_handlers_get_alarm_timeout(gquic_packet_r
 
 int gquic_packet_received_packet_handlers_get_ack_frame(gquic_frame_ack_t **const ack,
                                                         gquic_packet_received_packet_handlers_t *const handlers,
-                                                        const u_int8_t enc_lv) {
+                                                        const u_int8_t enc_lv,
+                                                        const int only_if_queued) {
     if (ack == NULL || handlers == NULL) {
         return -1;
     }
     switch (enc_lv) {
     case GQUIC_ENC_LV_INITIAL:
         if (!handlers->initial_dropped) {
-            if (gquic_packet_received_packet_handler_get_ack_frame(ack, &handlers->initial) != 0) {
+            if (gquic_packet_received_packet_handler_get_ack_frame(ack, &handlers->initial, only_if_queued) != 0) {
                 return -2;
             }
         }
         break;
     case GQUIC_ENC_LV_HANDSHAKE:
         if (!handlers->handshake_dropped) {
-            if (gquic_packet_received_packet_handler_get_ack_frame(ack, &handlers->handshake) != 0) {
+            if (gquic_packet_received_packet_handler_get_ack_frame(ack, &handlers->handshake, only_if_queued) != 0) {
                 return -3;
             }
         }
         break;
     case GQUIC_ENC_LV_1RTT:
-        return gquic_packet_received_packet_handler_get_ack_frame(ack, &handlers->one_rtt);
+        return gquic_packet_received_packet_handler_get_ack_frame(ack, &handlers->one_rtt, only_if_queued);
     default:
         return 0;
     }
@@ -512,3 +678,26 @@ int gquic_packet_received_packet_handlers_get_ack_frame(gquic_frame_ack_t **cons
     }
     return 0;
 }
+
+int gquic_packet_received_packet_handlers_set_ack_frequency(gquic_packet_received_packet_handlers_t *const handlers,
+                                                            const gquic_frame_ack_frequency_t *const frame) {
+    if (handlers == NULL || frame == NULL) {
+        return -1;
+    }
+    if (handlers->one_rtt_dropped) {
+        return -2;
+    }
+    return gquic_packet_received_packet_handler_set_ack_frequency(&handlers->one_rtt, frame);
+}
+
+int gquic_packet_received_packet_handlers_immediate_ack(gquic_packet_received_packet_handlers_t *const handlers) {
+    if (handlers == NULL) {
+        return -1;
+    }
+    if (handlers->one_rtt_dropped) {
+        return -2;
+    }
+    handlers->one_rtt.ack_queued = 1;
+    handlers->one_rtt.ack_alarm = 0;
+    return 0;
+}
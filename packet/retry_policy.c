@@ -0,0 +1,356 @@
+#include "packet/retry_policy.h"
+#include "packet/long_header_packet.h"
+#include <openssl/rand.h>
+#include <openssl/evp.h>
+#include <unistd.h>
+#include <time.h>
+#include <string.h>
+
+typedef struct gquic_packet_retry_integrity_key_s gquic_packet_retry_integrity_key_t;
+struct gquic_packet_retry_integrity_key_s {
+    gquic_version_t version;
+    u_int8_t key[16];
+    u_int8_t nonce[12];
+};
+
+static const gquic_packet_retry_integrity_key_t gquic_packet_retry_integrity_keys[] = {
+    {
+        GQUIC_VERSION_DRAFT_27,
+        {
+            0x4d, 0x32, 0xec, 0xdb,
+            0x2a, 0x21, 0x33, 0xc8,
+            0x41, 0xe4, 0x04, 0x3d,
+            0xf2, 0x7d, 0x44, 0x30
+        },
+        {
+            0x4d, 0x16, 0x11, 0xd0,
+            0x55, 0x13, 0xa5, 0x52,
+            0xc5, 0x87, 0xd5, 0x75
+        }
+    },
+    {
+        GQUIC_VERSION_1,
+        {
+            0xbe, 0x0c, 0x69, 0x0b,
+            0x9f, 0x66, 0x57, 0x5a,
+            0x1d, 0x76, 0x6b, 0x54,
+            0xe3, 0x68, 0xc8, 0x4e
+        },
+        {
+            0x46, 0x15, 0x99, 0xd3,
+            0x5d, 0x63, 0x2b, 0xf2,
+            0x23, 0x98, 0x25, 0xbb
+        }
+    }
+};
+
+static int gquic_packet_retry_policy_sample_cpu(gquic_packet_retry_policy_t *const, const u_int64_t);
+static int gquic_packet_retry_policy_update(gquic_packet_retry_policy_t *const);
+static int gquic_packet_retry_policy_retry(gquic_packet_retry_decision_t *const,
+                                           gquic_packet_retry_policy_t *const,
+                                           const gquic_packet_long_header_t *const,
+                                           const gquic_net_addr_t *const,
+                                           const u_int64_t);
+
+int gquic_packet_retry_decision_init(gquic_packet_retry_decision_t *const decision) {
+    if (decision == NULL) {
+        return -1;
+    }
+    gquic_str_init(&decision->odcid);
+    gquic_str_init(&decision->packet);
+    return 0;
+}
+
+int gquic_packet_retry_decision_dtor(gquic_packet_retry_decision_t *const decision) {
+    if (decision == NULL) {
+        return -1;
+    }
+    gquic_str_reset(&decision->odcid);
+    gquic_str_reset(&decision->packet);
+    return 0;
+}
+
+int gquic_packet_retry_policy_init(gquic_packet_retry_policy_t *const policy) {
+    if (policy == NULL) {
+        return -1;
+    }
+    sem_init(&policy->mtx, 0, 1);
+    policy->token_generator = NULL;
+    policy->conn_id_len = 8;
+    policy->half_open_limit = GQUIC_PACKET_RETRY_POLICY_DEFAULT_HALF_OPEN_LIMIT;
+    policy->cpu_limit = GQUIC_PACKET_RETRY_POLICY_DEFAULT_CPU_LIMIT;
+    policy->retrying = 0;
+    policy->half_open = 0;
+    policy->cpu_load = 0;
+    policy->sampled_at = 0;
+    policy->sampled_cpu = 0;
+    policy->cores = 1;
+    policy->retries = 0;
+    policy->retried_accepted = 0;
+    return 0;
+}
+
+int gquic_packet_retry_policy_ctor(gquic_packet_retry_policy_t *const policy,
+                                   gquic_handshake_token_generator_t *const token_generator,
+                                   const int conn_id_len,
+                                   const u_int64_t half_open_limit,
+                                   const double cpu_limit) {
+    if (policy == NULL || token_generator == NULL) {
+        return -1;
+    }
+    if (conn_id_len < 0 || conn_id_len > 20) {
+        return -2;
+    }
+    policy->token_generator = token_generator;
+    if (conn_id_len != 0) {
+        policy->conn_id_len = conn_id_len;
+    }
+    policy->half_open_limit = half_open_limit;
+    policy->cpu_limit = cpu_limit;
+    if ((policy->cores = sysconf(_SC_NPROCESSORS_ONLN)) <= 0) {
+        policy->cores = 1;
+    }
+    return 0;
+}
+
+int gquic_packet_retry_policy_dtor(gquic_packet_retry_policy_t *const policy) {
+    if (policy == NULL) {
+        return -1;
+    }
+    sem_destroy(&policy->mtx);
+    return 0;
+}
+
+int gquic_packet_retry_policy_on_initial(gquic_packet_retry_decision_t *const decision,
+                                         gquic_packet_retry_policy_t *const policy,
+                                         const gquic_str_t *const data,
+                                         const gquic_net_addr_t *const addr,
+                                         const u_int64_t now) {
+    gquic_packet_long_header_t *header = NULL;
+    gquic_packet_initial_header_t *initial_header = NULL;
+    gquic_handshake_token_t info;
+    gquic_reader_str_t reader = { 0, NULL };
+    int retrying = 0;
+    int ret = GQUIC_PACKET_RETRY_POLICY_ACCEPT;
+    if (decision == NULL || policy == NULL || data == NULL || addr == NULL) {
+        return -1;
+    }
+    if (policy->token_generator == NULL) {
+        return -2;
+    }
+    if ((header = gquic_packet_long_header_alloc()) == NULL) {
+        return -3;
+    }
+    initial_header = GQUIC_LONG_HEADER_SPEC(header);
+    initial_header->token = NULL;
+    reader = *data;
+    if ((GQUIC_STR_FIRST_BYTE(data) & 0xb0) != 0x80 || gquic_packet_long_header_deserialize_unseal_part(header, &reader) != 0) {
+        ret = -4;
+        goto finished;
+    }
+
+    // a valid token proves the address, such a client is let in even under load
+    gquic_handshake_token_init(&info);
+    if (initial_header->token_len != 0) {
+        gquic_str_t token = { initial_header->token_len, initial_header->token };
+        if (gquic_handshake_token_generator_validate(&info, policy->token_generator, &token, addr, now) == GQUIC_HANDSHAKE_TOKEN_VALID) {
+            if (info.is_retry) {
+                decision->odcid = info.odcid;
+                gquic_str_init(&info.odcid);
+                sem_wait(&policy->mtx);
+                policy->retried_accepted++;
+                sem_post(&policy->mtx);
+            }
+            gquic_handshake_token_dtor(&info);
+            goto finished;
+        }
+    }
+    gquic_handshake_token_dtor(&info);
+
+    sem_wait(&policy->mtx);
+    if (policy->cpu_limit != 0 && now >= policy->sampled_at + GQUIC_PACKET_RETRY_POLICY_CPU_SAMPLE_INTERVAL) {
+        gquic_packet_retry_policy_sample_cpu(policy, now);
+        gquic_packet_retry_policy_update(policy);
+    }
+    if ((retrying = policy->retrying)) {
+        policy->retries++;
+    }
+    sem_post(&policy->mtx);
+    if (!retrying) {
+        goto finished;
+    }
+
+    if (gquic_packet_retry_policy_retry(decision, policy, header, addr, now) != 0) {
+        ret = -5;
+        goto finished;
+    }
+    ret = GQUIC_PACKET_RETRY_POLICY_RETRY;
+finished:
+    gquic_packet_long_header_release(header);
+    return ret;
+}
+
+int gquic_packet_retry_policy_handshake_started(gquic_packet_retry_policy_t *const policy) {
+    if (policy == NULL) {
+        return -1;
+    }
+    sem_wait(&policy->mtx);
+    policy->half_open++;
+    gquic_packet_retry_policy_update(policy);
+    sem_post(&policy->mtx);
+    return 0;
+}
+
+int gquic_packet_retry_policy_handshake_finished(gquic_packet_retry_policy_t *const policy) {
+    if (policy == NULL) {
+        return -1;
+    }
+    sem_wait(&policy->mtx);
+    if (policy->half_open > 0) {
+        policy->half_open--;
+    }
+    gquic_packet_retry_policy_update(policy);
+    sem_post(&policy->mtx);
+    return 0;
+}
+
+int gquic_packet_retry_pack(gquic_str_t *const packet,
+                            const gquic_version_t version,
+                            const gquic_str_t *const dcid,
+                            const gquic_str_t *const scid,
+                            const gquic_str_t *const odcid,
+                            const gquic_str_t *const token) {
+    gquic_packet_long_header_t *header = NULL;
+    gquic_writer_str_t writer = { 0, NULL };
+    int ret = 0;
+    if (packet == NULL || dcid == NULL || scid == NULL || odcid == NULL || token == NULL) {
+        return -1;
+    }
+    if (GQUIC_STR_SIZE(dcid) > 20 || GQUIC_STR_SIZE(scid) > 20 || GQUIC_STR_SIZE(odcid) > 20) {
+        return -2;
+    }
+    if ((header = gquic_packet_long_header_alloc()) == NULL) {
+        return -3;
+    }
+    header->flag = 0xc0 | 0x30;
+    header->version = version;
+    header->dcid_len = GQUIC_STR_SIZE(dcid);
+    memcpy(header->dcid, GQUIC_STR_VAL(dcid), GQUIC_STR_SIZE(dcid));
+    header->scid_len = GQUIC_STR_SIZE(scid);
+    memcpy(header->scid, GQUIC_STR_VAL(scid), GQUIC_STR_SIZE(scid));
+
+    if (gquic_str_alloc(packet, gquic_packet_long_header_size(header) + GQUIC_STR_SIZE(token) + GQUIC_PACKET_RETRY_TAG_SIZE) != 0) {
+        ret = -4;
+        goto finished;
+    }
+    writer = *packet;
+    if (gquic_packet_long_header_serialize(header, &writer) != 0) {
+        gquic_str_reset(packet);
+        ret = -5;
+        goto finished;
+    }
+    gquic_writer_str_write(&writer, token);
+    gquic_str_t retry = { GQUIC_STR_SIZE(packet) - GQUIC_PACKET_RETRY_TAG_SIZE, GQUIC_STR_VAL(packet) };
+    if (gquic_packet_retry_integrity_tag(GQUIC_STR_VAL(&writer), version, odcid, &retry) != 0) {
+        gquic_str_reset(packet);
+        ret = -6;
+    }
+finished:
+    gquic_packet_long_header_release(header);
+    return ret;
+}
+
+int gquic_packet_retry_integrity_tag(u_int8_t *const tag,
+                                     const gquic_version_t version,
+                                     const gquic_str_t *const odcid,
+                                     const gquic_str_t *const retry) {
+    const gquic_packet_retry_integrity_key_t *key = NULL;
+    EVP_CIPHER_CTX *ctx = NULL;
+    u_int8_t odcid_len = 0;
+    u_int8_t final[16];
+    int outlen = 0;
+    int ret = 0;
+    size_t i;
+    if (tag == NULL || odcid == NULL || retry == NULL || GQUIC_STR_SIZE(odcid) > 20) {
+        return -1;
+    }
+    for (i = 0; i < sizeof(gquic_packet_retry_integrity_keys) / sizeof(gquic_packet_retry_integrity_key_t); i++) {
+        if (gquic_packet_retry_integrity_keys[i].version == version) {
+            key = &gquic_packet_retry_integrity_keys[i];
+            break;
+        }
+    }
+    if (key == NULL) {
+        return -2;
+    }
+    if ((ctx = EVP_CIPHER_CTX_new()) == NULL) {
+        return -3;
+    }
+    // nothing is encrypted, the Retry pseudo-packet is all additional data
+    odcid_len = GQUIC_STR_SIZE(odcid);
+    if (EVP_EncryptInit_ex(ctx, EVP_aes_128_gcm(), NULL, key->key, key->nonce) <= 0
+        || EVP_EncryptUpdate(ctx, NULL, &outlen, &odcid_len, 1) <= 0
+        || (GQUIC_STR_SIZE(odcid) != 0 && EVP_EncryptUpdate(ctx, NULL, &outlen, GQUIC_STR_VAL(odcid), GQUIC_STR_SIZE(odcid)) <= 0)
+        || EVP_EncryptUpdate(ctx, NULL, &outlen, GQUIC_STR_VAL(retry), GQUIC_STR_SIZE(retry)) <= 0
+        || EVP_EncryptFinal_ex(ctx, final, &outlen) <= 0
+        || EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, GQUIC_PACKET_RETRY_TAG_SIZE, tag) <= 0) {
+        ret = -4;
+    }
+    EVP_CIPHER_CTX_free(ctx);
+    return ret;
+}
+
+static int gquic_packet_retry_policy_sample_cpu(gquic_packet_retry_policy_t *const policy, const u_int64_t now) {
+    struct timespec ts;
+    u_int64_t cpu = 0;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0) {
+        return -1;
+    }
+    cpu = ts.tv_sec * 1000 * 1000 + ts.tv_nsec / 1000;
+    if (policy->sampled_at != 0 && now > policy->sampled_at && cpu >= policy->sampled_cpu) {
+        policy->cpu_load = (double) (cpu - policy->sampled_cpu) / (now - policy->sampled_at) / policy->cores;
+    }
+    policy->sampled_at = now;
+    policy->sampled_cpu = cpu;
+    return 0;
+}
+
+static int gquic_packet_retry_policy_update(gquic_packet_retry_policy_t *const policy) {
+    int half_open_over = policy->half_open_limit != 0 && policy->half_open >= policy->half_open_limit;
+    int cpu_over = policy->cpu_limit != 0 && policy->cpu_load >= policy->cpu_limit;
+    // hysteresis, so a server right at the limit does not flap between modes
+    int half_open_under = policy->half_open_limit == 0 || policy->half_open <= policy->half_open_limit * 3 / 4;
+    int cpu_under = policy->cpu_limit == 0 || policy->cpu_load <= policy->cpu_limit * 3 / 4;
+    if (half_open_over || cpu_over) {
+        policy->retrying = 1;
+    }
+    else if (half_open_under && cpu_under) {
+        policy->retrying = 0;
+    }
+    return 0;
+}
+
+static int gquic_packet_retry_policy_retry(gquic_packet_retry_decision_t *const decision,
+                                           gquic_packet_retry_policy_t *const policy,
+                                           const gquic_packet_long_header_t *const header,
+                                           const gquic_net_addr_t *const addr,
+                                           const u_int64_t now) {
+    u_int8_t conn_id[20];
+    gquic_str_t token = { 0, NULL };
+    int ret = 0;
+    gquic_str_t dcid = { header->scid_len, (void *) header->scid };
+    gquic_str_t scid = { policy->conn_id_len, conn_id };
+    gquic_str_t odcid = { header->dcid_len, (void *) header->dcid };
+    // the client's next Initial goes to this conn ID, nothing is kept for it
+    if (RAND_bytes(conn_id, policy->conn_id_len) <= 0) {
+        return -1;
+    }
+    if (gquic_handshake_token_generator_new_retry_token(&token, policy->token_generator, addr, &odcid, now) != 0) {
+        return -2;
+    }
+    if (gquic_packet_retry_pack(&decision->packet, header->version, &dcid, &scid, &odcid, &token) != 0) {
+        ret = -3;
+    }
+    gquic_str_reset(&token);
+    return ret;
+}
@@ -69,7 +69,7 @@ int gquic_packet_send_queue_run(gquic_packet_send_queue_t *const queue) {
             gquic_list_release(event);
             return 0;
         case GQUIC_PACKET_SEND_QUEUE_EVENT_PACKET:
-            if (gquic_net_conn_write(queue->conn, &event->packed_packet->raw) != 0) {
+            if (gquic_net_conn_write_at(queue->conn, &event->packed_packet->raw, event->packed_packet->txtime, event->packed_packet->ecn) != 0) {
                 return -3;
             }
             gquic_packed_packet_dtor_without_frames(event->packed_packet);
@@ -4,6 +4,7 @@
 #include "util/st.h"
 #include "frame/meta.h"
 #include "event/event.h"
+#include "net/conn.h"
 #include <malloc.h>
 #include <time.h>
 #include <math.h>
@@ -31,6 +32,16 @@ static int gquic_packet_sent_packet_handler_detect_lost_packets(gquic_packet_sen
                                                                 const u_int64_t,
                                                                 const u_int8_t,
                                                                 const u_int64_t);
+static int gquic_packet_sent_packet_handler_detect_spurious_losses(gquic_packet_sent_packet_handler_t *const,
+                                                                   const gquic_list_t *const,
+                                                                   const u_int64_t,
+                                                                   const u_int8_t);
+static int gquic_packet_sent_packet_handler_on_spurious_loss(gquic_packet_sent_packet_handler_t *const,
+                                                             gquic_packet_sent_pn_t *const,
+                                                             const gquic_packet_sent_lost_t *const,
+                                                             const u_int64_t,
+                                                             const u_int64_t,
+                                                             const u_int8_t);
 static int gquic_packet_sent_packet_handler_queue_frames_for_retrans(gquic_packet_t *const);
 static int gquic_packet_sent_packet_handler_on_verified_loss_detection_timeout(gquic_packet_sent_packet_handler_t *const);
 
@@ -40,96 +51,211 @@ int gquic_packet_sent_mem_init(gquic_packet_sent_mem_t *const mem) {
         return -1;
     }
     mem->count = 0;
-    gquic_list_head_init(&mem->list);
-    gquic_rbtree_root_init(&mem->root);
+    mem->slots = NULL;
+    mem->cap = 0;
+    mem->smallest = 0;
+    mem->end = 0;
 
     return 0;
 }
 
 int gquic_packet_sent_mem_dtor(gquic_packet_sent_mem_t *const mem) {
-    gquic_rbtree_t *del = NULL;
+    gquic_packet_t *packet = NULL;
+    u_int64_t pn = 0;
     if (mem == NULL) {
         return -1;
     }
+    if (mem->slots != NULL) {
+        GQUIC_PACKET_SENT_MEM_FOREACH(packet, pn, mem) {
+            gquic_packet_sent_packet_handler_packet_release(packet);
+        }
+        free(mem->slots);
+    }
+    gquic_packet_sent_mem_init(mem);
+    return 0;
+}
 
-    while (!gquic_rbtree_is_nil(mem->root)) {
-        del = mem->root;
-        gquic_rbtree_remove(&mem->root, &del);
-        gquic_rbtree_release(del, NULL);
+static int gquic_packet_sent_mem_grow(gquic_packet_sent_mem_t *const mem, const u_int64_t span) {
+    gquic_packet_t **slots = NULL;
+    u_int64_t cap = 0;
+    u_int64_t pn = 0;
+    cap = mem->cap != 0 ? mem->cap : GQUIC_PACKET_SENT_MEM_INIT_CAP;
+    while (cap < span) {
+        cap *= 2;
     }
-    while (!gquic_list_head_empty(&mem->list)) {
-        gquic_packet_dtor(GQUIC_LIST_FIRST(&mem->list));
-        gquic_list_release(GQUIC_LIST_FIRST(&mem->list));
+    if ((slots = calloc(cap, sizeof(gquic_packet_t *))) == NULL) {
+        return -1;
     }
+    for (pn = mem->smallest; pn < mem->end; pn++) {
+        slots[pn & (cap - 1)] = GQUIC_PACKET_SENT_MEM_SLOT(mem, pn);
+    }
+    if (mem->slots != NULL) {
+        free(mem->slots);
+    }
+    mem->slots = slots;
+    mem->cap = cap;
     return 0;
 }
 
 int gquic_packet_sent_mem_sent_packet(gquic_packet_sent_mem_t *const mem, const gquic_packet_t *const packet) {
-    const gquic_packet_t **packet_storage = NULL;
-    gquic_rbtree_t *packet_storage_rb_node = NULL;
     if (mem == NULL || packet == NULL) {
         return -1;
     }
-    if ((packet_storage = gquic_list_alloc(sizeof(gquic_packet_t *))) == NULL) {
+    if (mem->count == 0) {
+        mem->smallest = packet->pn;
+        mem->end = packet->pn;
+    }
+    // packet numbers only grow within a space
+    if (packet->pn < mem->end) {
         return -2;
     }
-    if (gquic_rbtree_alloc(&packet_storage_rb_node, sizeof(u_int64_t), sizeof(gquic_packet_t ***)) != 0) {
+    if (packet->pn - mem->smallest >= mem->cap && gquic_packet_sent_mem_grow(mem, packet->pn - mem->smallest + 1) != 0) {
         return -3;
     }
-    *packet_storage = packet;
-    *(const gquic_packet_t ***) GQUIC_RBTREE_VALUE(packet_storage_rb_node) = packet_storage;
-    *(u_int64_t *) GQUIC_RBTREE_KEY(packet_storage_rb_node) = packet->pn;
-
-    gquic_list_insert_before(&mem->list, packet_storage);
-    gquic_rbtree_insert(&mem->root, packet_storage_rb_node);
+    GQUIC_PACKET_SENT_MEM_SLOT(mem, packet->pn) = (gquic_packet_t *) packet;
+    mem->end = packet->pn + 1;
     mem->count++;
 
     return 0;
 }
 
 int gquic_packet_sent_mem_get_packet(const gquic_packet_t **const packet, gquic_packet_sent_mem_t *const mem, const u_int64_t pn) {
-    const gquic_rbtree_t *packet_storage_rb_node = NULL;
     if (packet == NULL || mem == NULL) {
         return -1;
     }
     *packet = NULL;
-    if (gquic_rbtree_find(&packet_storage_rb_node, mem->root, &pn, sizeof(u_int64_t)) != 0) {
+    if (pn < mem->smallest || pn >= mem->end || GQUIC_PACKET_SENT_MEM_SLOT(mem, pn) == NULL) {
         return -2;
     }
-    *packet = **(gquic_packet_t ***) GQUIC_RBTREE_VALUE(packet_storage_rb_node);
+    *packet = GQUIC_PACKET_SENT_MEM_SLOT(mem, pn);
     return 0;
 }
 
 int gquic_packet_sent_mem_remove(gquic_packet_sent_mem_t *const mem, const u_int64_t pn, int (*release_packet_func) (gquic_packet_t *const)) {
     gquic_packet_t *packet = NULL;
-    gquic_rbtree_t *packet_storage_rb_node = NULL;
     if (mem == NULL) {
         return -1;
     }
-    if (gquic_rbtree_find((const gquic_rbtree_t **) &packet_storage_rb_node, mem->root, &pn, sizeof(u_int64_t)) != 0) {
+    if (pn < mem->smallest || pn >= mem->end || (packet = GQUIC_PACKET_SENT_MEM_SLOT(mem, pn)) == NULL) {
         return -2;
     }
-    packet = **(gquic_packet_t ***) GQUIC_RBTREE_VALUE(packet_storage_rb_node);
-
-    gquic_rbtree_remove(&mem->root, &packet_storage_rb_node);
-    gquic_list_release(*(gquic_packet_t ***) GQUIC_RBTREE_VALUE(packet_storage_rb_node));
-    gquic_rbtree_release(packet_storage_rb_node, NULL);
+    GQUIC_PACKET_SENT_MEM_SLOT(mem, pn) = NULL;
+    mem->count--;
+    // the oldest outstanding packet moves past the empty slots
+    while (mem->smallest < mem->end && GQUIC_PACKET_SENT_MEM_SLOT(mem, mem->smallest) == NULL) {
+        mem->smallest++;
+    }
 
-    if (packet != NULL && release_packet_func != NULL) {
+    if (release_packet_func != NULL) {
         if (release_packet_func(packet) != 0) {
             return -3;
         }
     }
-    mem->count--;
     return 0;
 }
 
+gquic_packet_t *gquic_packet_sent_mem_first(const gquic_packet_sent_mem_t *const mem) {
+    if (mem == NULL || mem->count == 0) {
+        return NULL;
+    }
+    return GQUIC_PACKET_SENT_MEM_SLOT(mem, mem->smallest);
+}
+
+int gquic_packet_sent_lost_mem_init(gquic_packet_sent_lost_mem_t *const mem) {
+    if (mem == NULL) {
+        return -1;
+    }
+    mem->records = NULL;
+    mem->cap = 0;
+    mem->head = 0;
+    mem->count = 0;
+
+    return 0;
+}
+
+int gquic_packet_sent_lost_mem_dtor(gquic_packet_sent_lost_mem_t *const mem) {
+    if (mem == NULL) {
+        return -1;
+    }
+    if (mem->records != NULL) {
+        free(mem->records);
+    }
+    gquic_packet_sent_lost_mem_init(mem);
+    return 0;
+}
+
+int gquic_packet_sent_lost_mem_add(gquic_packet_sent_lost_mem_t *const mem, const gquic_packet_sent_lost_t *const lost) {
+    gquic_packet_sent_lost_t *records = NULL;
+    u_int64_t cap = 0;
+    u_int64_t i = 0;
+    if (mem == NULL || lost == NULL) {
+        return -1;
+    }
+    // out of order it could not be found by binary search, it is not remembered
+    if (mem->count != 0 && lost->pn <= GQUIC_PACKET_SENT_LOST_MEM_AT(mem, mem->count - 1).pn) {
+        return -2;
+    }
+    if (mem->count == mem->cap) {
+        cap = mem->cap != 0 ? mem->cap * 2 : GQUIC_PACKET_SENT_LOST_MEM_INIT_CAP;
+        if ((records = malloc(cap * sizeof(gquic_packet_sent_lost_t))) == NULL) {
+            return -3;
+        }
+        for (i = 0; i < mem->count; i++) {
+            records[i] = GQUIC_PACKET_SENT_LOST_MEM_AT(mem, i);
+        }
+        if (mem->records != NULL) {
+            free(mem->records);
+        }
+        mem->records = records;
+        mem->cap = cap;
+        mem->head = 0;
+    }
+    GQUIC_PACKET_SENT_LOST_MEM_AT(mem, mem->count) = *lost;
+    mem->count++;
+
+    return 0;
+}
+
+int gquic_packet_sent_lost_mem_expire(gquic_packet_sent_lost_mem_t *const mem, const u_int64_t lost_before) {
+    if (mem == NULL) {
+        return -1;
+    }
+    // lost times grow with the packet numbers, the expired records are all at the front
+    while (mem->count != 0
+           && (GQUIC_PACKET_SENT_LOST_MEM_AT(mem, 0).acked || GQUIC_PACKET_SENT_LOST_MEM_AT(mem, 0).lost_time < lost_before)) {
+        mem->head = (mem->head + 1) & (mem->cap - 1);
+        mem->count--;
+    }
+    return 0;
+}
+
+u_int64_t gquic_packet_sent_lost_mem_lower_bound(const gquic_packet_sent_lost_mem_t *const mem, const u_int64_t pn) {
+    u_int64_t lo = 0;
+    u_int64_t hi = 0;
+    u_int64_t mid = 0;
+    if (mem == NULL) {
+        return 0;
+    }
+    hi = mem->count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (GQUIC_PACKET_SENT_LOST_MEM_AT(mem, mid).pn < pn) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
 int gquic_packet_sent_pn_init(gquic_packet_sent_pn_t *const sent_pn) {
     if (sent_pn == NULL) {
         return -1;
     }
     gquic_packet_sent_mem_init(&sent_pn->mem);
     gquic_packet_number_gen_init(&sent_pn->pn_gen);
+    gquic_packet_sent_lost_mem_init(&sent_pn->lost);
     sent_pn->largest_ack = -1;
     sent_pn->largest_sent = -1;
     sent_pn->loss_time = 0;
@@ -152,6 +278,7 @@ int gquic_packet_sent_pn_dtor(gquic_packet_sent_pn_t *const sent_pn) {
     }
     gquic_packet_sent_mem_dtor(&sent_pn->mem);
     gquic_packet_number_gen_dtor(&sent_pn->pn_gen);
+    gquic_packet_sent_lost_mem_dtor(&sent_pn->lost);
     return 0;
 }
 
@@ -159,19 +286,28 @@ int gquic_packet_sent_packet_handler_init(gquic_packet_sent_packet_handler_t *co
     if (handler == NULL) {
         return -1;
     }
-    handler->next_send_time = 0;
     handler->initial_packets = NULL;
     handler->handshake_packets = NULL;
     handler->one_rtt_packets = NULL;
     handler->handshake_complete = 0;
     handler->lowest_not_confirm_acked = 0;
     handler->infly_bytes = 0;
-    gquic_cong_cubic_init(&handler->cong);
+    gquic_cong_init(&handler->cong);
+    gquic_packet_rate_sampler_init(&handler->rate_sampler);
+    gquic_packet_pacer_init(&handler->pacer);
+    handler->txtime = 0;
+    gquic_packet_ecn_init(&handler->ecn);
     handler->rtt = NULL;
     handler->pto_count = 0;
     handler->pto_mode = 0;
     handler->num_probes_to_send = 0;
     handler->alarm = 0;
+    handler->reordering_threshold = GQUIC_PACKET_SENT_PACKET_HANDLER_PACKET_THRESHOLD;
+    handler->reordering_shift = GQUIC_PACKET_SENT_PACKET_HANDLER_TIME_THRESHOLD_SHIFT;
+    handler->spurious_losses = 0;
+    handler->peer_addr_validated = 0;
+    handler->bytes_received = 0;
+    handler->bytes_sent = 0;
     handler->event_cb.self = NULL;
     handler->event_cb.cb = NULL;
 
@@ -181,12 +317,13 @@ int gquic_packet_sent_packet_handler_init(gquic_packet_sent_packet_handler_t *co
 int gquic_packet_sent_packet_handler_ctor(gquic_packet_sent_packet_handler_t *const handler,
                                           const u_int64_t initial_pn,
                                           gquic_rtt_t *const rtt,
+                                          const int cong_algo,
+                                          const u_int64_t max_cwnd,
                                           void *const event_self,
                                           int (*event_cb)(void *const, gquic_event_t *const)) {
     if (handler == NULL) {
         return -1;
     }
-    gquic_cong_cubic_ctor(&handler->cong, rtt, 32 * 1460, 1000 * 1460);
     if ((handler->initial_packets = malloc(sizeof(gquic_packet_sent_pn_t))) == NULL) {
         return -2;
     }
@@ -196,6 +333,11 @@ int gquic_packet_sent_packet_handler_ctor(gquic_packet_sent_packet_handler_t *co
     if ((handler->one_rtt_packets = malloc(sizeof(gquic_packet_sent_pn_t))) == NULL) {
         return -4;
     }
+    if (gquic_cong_ctor(&handler->cong, cong_algo, rtt, 32 * 1460,
+                        max_cwnd != 0 ? max_cwnd : GQUIC_PACKET_SENT_PACKET_HANDLER_DEFAULT_MAX_CWND) != 0) {
+        return -5;
+    }
+    gquic_packet_pacer_ctor(&handler->pacer, 1460, GQUIC_PACKET_PACER_DEFAULT_BURST_PACKETS, 1);
     gquic_packet_sent_pn_init(handler->initial_packets);
     gquic_packet_sent_pn_init(handler->handshake_packets);
     gquic_packet_sent_pn_init(handler->one_rtt_packets);
@@ -225,6 +367,7 @@ int gquic_packet_sent_packet_handler_dtor(gquic_packet_sent_packet_handler_t *co
         gquic_packet_sent_pn_dtor(handler->one_rtt_packets);
         free(handler->one_rtt_packets);
     }
+    gquic_cong_dtor(&handler->cong);
 
     return 0;
 }
@@ -232,14 +375,15 @@ int gquic_packet_sent_packet_handler_dtor(gquic_packet_sent_packet_handler_t *co
 int gquic_packet_sent_packet_handler_drop_packets(gquic_packet_sent_packet_handler_t *const handler,
                                                   const u_int8_t enc_lv) {
     gquic_packet_sent_pn_t *sent_pn = NULL;
-    const gquic_packet_t **packet_storage = NULL;
+    gquic_packet_t *packet = NULL;
+    u_int64_t pn = 0;
     if (handler == NULL) {
         return -1;
     }
     sent_pn = gquic_sent_packet_handler_get_sent_pn(handler, enc_lv);
-    GQUIC_LIST_FOREACH(packet_storage, &sent_pn->mem.list) {
-        if ((*packet_storage)->included_infly) {
-            handler->infly_bytes -= (*packet_storage)->len;
+    GQUIC_PACKET_SENT_MEM_FOREACH(packet, pn, &sent_pn->mem) {
+        if (packet->included_infly) {
+            handler->infly_bytes -= packet->len;
         }
     }
     switch (enc_lv) {
@@ -290,8 +434,13 @@ int gquic_packet_sent_packet_handler_received_ack(gquic_packet_sent_packet_handl
     gquic_packet_sent_pn_t *pn_spec = NULL;
     const gquic_packet_t *packet = NULL;
     const gquic_packet_t **packet_storage = NULL;
+    gquic_packet_t acked;
+    gquic_packet_rate_sample_t rate_sample;
     u_int64_t largest_ack = 0;
     u_int64_t ack_delay = 0;
+    u_int64_t largest_newly_acked = 0;
+    u_int64_t newly_acked_marked = 0;
+    u_int64_t ce_increase = 0;
     gquic_list_t blocks;
     gquic_list_t acked_packets;
     if (handler == NULL || ack_frame == NULL) {
@@ -304,52 +453,130 @@ int gquic_packet_sent_packet_handler_received_ack(gquic_packet_sent_packet_handl
     }
     pn_spec = gquic_sent_packet_handler_get_sent_pn(handler, enc_lv);
     largest_ack = ack_frame->largest_ack;
-    if (largest_ack > pn_spec->largest_ack) {
+    // acks a packet that was never sent
+    if (pn_spec->largest_sent == (u_int64_t) -1 || largest_ack > pn_spec->largest_sent) {
         ret = -3;
         goto failure;
     }
-    pn_spec->largest_ack = pn_spec->largest_ack > largest_ack ? pn_spec->largest_ack : largest_ack;
+    // largest_ack starts out as -1, i.e. nothing acked yet
+    if (pn_spec->largest_ack == (u_int64_t) -1 || largest_ack > pn_spec->largest_ack) {
+        pn_spec->largest_ack = largest_ack;
+    }
     if (!gquic_packet_number_gen_valid(&pn_spec->pn_gen, &blocks)) {
         ret = -4;
         goto failure;
     }
-    if (gquic_packet_sent_mem_get_packet(&packet, &pn_spec->mem, ack_frame->largest_ack) != 0) {
-        ret = -5;
-        goto failure;
-    }
+    // only a newly acked largest packet gives an rtt sample
+    gquic_packet_sent_mem_get_packet(&packet, &pn_spec->mem, ack_frame->largest_ack);
     if (packet != NULL) {
         if (enc_lv == GQUIC_ENC_LV_1RTT) {
             ack_delay = ack_frame->delay < (u_int64_t) handler->rtt->max_delay ? ack_frame->delay : handler->rtt->max_delay;
         }
         gquic_rtt_update(handler->rtt, recv_time - packet->send_time, ack_delay);
-        gquic_cong_cubic_try_exit_slow_start(&handler->cong);
+        GQUIC_CONG_ON_RTT_UPDATED(&handler->cong);
     }
     if (gquic_packet_sent_packet_handler_determine_newly_acked_packets(&acked_packets, handler, &blocks, enc_lv) != 0) {
         ret = -6;
         goto failure;
     }
+    // a late ack of packets already declared lost, alone or next to outstanding ones
+    if (gquic_packet_sent_packet_handler_detect_spurious_losses(handler, &blocks, recv_time, enc_lv) != 0) {
+        ret = -7;
+        goto failure;
+    }
     if (gquic_list_head_empty(&acked_packets)) {
         goto finished;
     }
+    GQUIC_LIST_FOREACH(packet_storage, &acked_packets) {
+        if ((*packet_storage)->included_infly) {
+            gquic_packet_rate_sampler_on_packet_acked(&handler->rate_sampler, *packet_storage, recv_time);
+        }
+    }
+    gquic_packet_rate_sampler_generate(&rate_sample, &handler->rate_sampler, handler->rtt->min);
+    GQUIC_CONG_ON_RATE_SAMPLE(&handler->cong, &rate_sample);
+    if (handler->event_cb.self != NULL && rate_sample.delivery_rate != 0) {
+        gquic_event_t event = {
+            recv_time,
+            GQUIC_EVENT_RATE_SAMPLE,
+            {
+                handler->rtt->min,
+                handler->rtt->smooth,
+                handler->rtt->latest,
+                handler->infly_bytes,
+                GQUIC_CONG_CWND(&handler->cong),
+                GQUIC_CONG_IN_SLOW_START(&handler->cong),
+                GQUIC_CONG_IN_RECOVERY(&handler->cong)
+            },
+            enc_lv,
+            largest_ack,
+            rate_sample.delivered,
+            NULL,
+            {
+                rate_sample.delivery_rate,
+                gquic_packet_rate_sampler_bandwidth(&handler->rate_sampler),
+                rate_sample.interval,
+                rate_sample.is_app_limited
+            }
+        };
+        GQUIC_PACKET_SENT_PACKET_HANDLER_EVENT_CALLBACK(handler, &event);
+    }
     GQUIC_LIST_FOREACH(packet_storage, &acked_packets) {
         packet = *packet_storage;
+        // the packet is released once acked
+        acked = *packet;
         if (packet->largest_ack != (u_int64_t) -1 && enc_lv == GQUIC_ENC_LV_1RTT) {
             handler->lowest_not_confirm_acked = handler->lowest_not_confirm_acked > packet->largest_ack + 1
                 ? handler->lowest_not_confirm_acked
                 : packet->largest_ack + 1;
         }
         if (gquic_packet_sent_packet_handler_on_packet_acked(handler, packet) != 0) {
-            ret = -7;
+            ret = -10;
             goto failure;
         }
-        if (packet->included_infly) {
-            gquic_cong_cubic_on_packet_acked(&handler->cong, packet->pn, packet->len, handler->infly_bytes, recv_time);
+        if (acked.included_infly) {
+            GQUIC_CONG_ON_PACKET_ACKED(&handler->cong, acked.pn, acked.len, handler->infly_bytes, acked.send_time, recv_time);
+        }
+        largest_newly_acked = acked.pn > largest_newly_acked ? acked.pn : largest_newly_acked;
+        if (acked.ecn != GQUIC_NET_ECN_NOT_ECT) {
+            newly_acked_marked++;
         }
     }
-    if (gquic_packet_sent_packet_handler_detect_lost_packets(handler, recv_time, enc_lv, handler->infly_bytes) != 0) {
+    if (enc_lv == GQUIC_ENC_LV_1RTT) {
+        gquic_packet_ecn_on_ack(&ce_increase, &handler->ecn, ack_frame, newly_acked_marked);
+    }
+    // congestion the path signalled without dropping anything
+    if (ce_increase != 0) {
+        GQUIC_CONG_ON_ECN_CE(&handler->cong, largest_newly_acked, ce_increase, handler->infly_bytes);
+        if (handler->event_cb.self != NULL) {
+            gquic_event_t event = {
+                recv_time,
+                GQUIC_EVENT_ECN_CE,
+                {
+                    handler->rtt->min,
+                    handler->rtt->smooth,
+                    handler->rtt->latest,
+                    handler->infly_bytes,
+                    GQUIC_CONG_CWND(&handler->cong),
+                    GQUIC_CONG_IN_SLOW_START(&handler->cong),
+                    GQUIC_CONG_IN_RECOVERY(&handler->cong)
+                },
+                enc_lv,
+                largest_newly_acked,
+                ce_increase,
+                NULL,
+                { 0, 0, 0, 0 }
+            };
+            GQUIC_PACKET_SENT_PACKET_HANDLER_EVENT_CALLBACK(handler, &event);
+        }
+    }
+    if (gquic_packet_sent_packet_handler_detect_spurious_losses(handler, &blocks, recv_time, enc_lv) != 0) {
         ret = -8;
         goto failure;
     }
+    if (gquic_packet_sent_packet_handler_detect_lost_packets(handler, recv_time, enc_lv, handler->infly_bytes) != 0) {
+        ret = -9;
+        goto failure;
+    }
     handler->pto_count = 0;
     handler->num_probes_to_send = 0;
     gquic_sent_packet_handler_set_loss_detection_timer(handler);
@@ -381,6 +608,7 @@ static inline gquic_packet_sent_pn_t *gquic_sent_packet_handler_get_sent_pn(gqui
         return handler->initial_packets;
     case GQUIC_ENC_LV_HANDSHAKE:
         return handler->handshake_packets;
+    case GQUIC_ENC_LV_0RTT:
     case GQUIC_ENC_LV_1RTT:
         return handler->one_rtt_packets;
     }
@@ -449,8 +677,10 @@ static inline int gquic_sent_packet_handler_set_loss_detection_timer(gquic_packe
         return -1;
     }
     gquic_sent_packet_handler_get_earliest_loss_time_space(&loss_time, &enc_lv, handler);
+    // the time threshold goes off before any PTO
     if (loss_time != 0) {
         handler->alarm = loss_time;
+        return 0;
     }
     if (!gquic_sent_packet_handler_has_outstanding_packets(handler)) {
         handler->alarm = 0;
@@ -491,18 +721,26 @@ static inline int gquic_packet_sent_packet_handler_sent_packet_inner(gquic_packe
         return 0;
     }
     pn_spc->largest_sent = packet->pn;
+    handler->bytes_sent += packet->len;
     ack_eliciting = !gquic_list_head_empty(packet->frames);
     if (ack_eliciting) {
+        if (handler->txtime) {
+            packet->send_time = gquic_packet_pacer_departure_time(&handler->pacer,
+                                                                  GQUIC_CONG_PACING_RATE(&handler->cong), packet->send_time, packet->len);
+        }
         pn_spc->last_sent_ack_time = packet->send_time;
+        if (packet->enc_lv == GQUIC_ENC_LV_1RTT) {
+            packet->ecn = gquic_packet_ecn_mark(&handler->ecn);
+        }
+        gquic_packet_rate_sampler_on_packet_sent(&handler->rate_sampler, packet, handler->infly_bytes);
         packet->included_infly = 1;
         handler->infly_bytes += packet->len;
+        gquic_packet_pacer_sent_packet(&handler->pacer, GQUIC_CONG_PACING_RATE(&handler->cong), packet->send_time, packet->len);
         if (handler->num_probes_to_send > 0) {
             handler->num_probes_to_send--;
         }
     }
-    gquic_cong_cubic_on_packet_sent(&handler->cong, packet->pn, packet->len, ack_eliciting);
-    handler->next_send_time = (handler->next_send_time > packet->send_time ? handler->next_send_time : packet->send_time)
-        + gquic_cong_cubic_time_util_send(&handler->cong, handler->infly_bytes);
+    GQUIC_CONG_ON_PACKET_SENT(&handler->cong, packet->pn, packet->len, handler->infly_bytes, ack_eliciting);
     return ack_eliciting;
 }
 
@@ -511,14 +749,12 @@ static int gquic_packet_sent_packet_handler_determine_newly_acked_packets(gquic_
                                                                           gquic_packet_sent_packet_handler_t *const handler,
                                                                           const gquic_list_t *const blocks,
                                                                           const u_int8_t enc_lv) {
-    int ret = 0;
-    int has_mission_blocks = 0;
     gquic_packet_sent_pn_t *pn_spec = NULL;
     gquic_frame_ack_block_t *block = NULL;
-    const gquic_packet_t **packet_storage = NULL;
+    gquic_packet_t *packet = NULL;
     const gquic_packet_t **ret_packet_storage = NULL;
-    u_int64_t lowest_ack = 0;
-    u_int64_t largest_ack = 0;
+    u_int64_t pn = 0;
+    u_int64_t largest = 0;
     if (packets == NULL || handler == NULL || blocks == NULL) {
         return -1;
     }
@@ -526,46 +762,23 @@ static int gquic_packet_sent_packet_handler_determine_newly_acked_packets(gquic_
     if ((pn_spec = gquic_sent_packet_handler_get_sent_pn(handler, enc_lv)) == NULL) {
         return -2;
     }
-    lowest_ack = ((gquic_frame_ack_block_t *) GQUIC_LIST_LAST(blocks))->smallest;
-    largest_ack = ((gquic_frame_ack_block_t *) GQUIC_LIST_FIRST(blocks))->largest;
-    block = GQUIC_LIST_PAYLOAD(blocks);
-    has_mission_blocks = !gquic_list_head_empty(blocks) && GQUIC_LIST_FIRST(blocks) != GQUIC_LIST_LAST(blocks);
-    GQUIC_LIST_FOREACH(packet_storage, &pn_spec->mem.list) {
-        if ((*packet_storage)->pn < lowest_ack) {
-            continue;
-        }
-        if ((*packet_storage)->pn > largest_ack) {
-            break;
-        }
-        if (has_mission_blocks) {
-            block = gquic_list_prev(block);
-            while ((*packet_storage)->pn > block->largest && block != GQUIC_LIST_PAYLOAD(blocks)) {
-                block = gquic_list_prev(block);
-            }
-            if ((*packet_storage)->pn >= block->smallest) {
-                if ((*packet_storage)->pn > block->largest) {
-                    break;
-                }
-                if ((ret_packet_storage = gquic_list_alloc(sizeof(gquic_packet_t *))) == NULL) {
-                    ret = -4;
-                    goto failure;
-                }
-                *ret_packet_storage = *packet_storage;
-                gquic_list_insert_before(packets, ret_packet_storage);
+    // blocks run from the largest down, acked packets are listed in send order.
+    // only the outstanding part of each block is walked, what was acked before is gone
+    GQUIC_LIST_RFOREACH(block, blocks) {
+        pn = block->smallest > pn_spec->mem.smallest ? block->smallest : pn_spec->mem.smallest;
+        largest = block->largest < pn_spec->mem.end ? block->largest + 1 : pn_spec->mem.end;
+        for (; pn < largest; pn++) {
+            if ((packet = GQUIC_PACKET_SENT_MEM_SLOT(&pn_spec->mem, pn)) == NULL) {
+                continue;
             }
-        }
-        else {
             if ((ret_packet_storage = gquic_list_alloc(sizeof(gquic_packet_t *))) == NULL) {
-                ret = -4;
-                goto failure;
+                return -4;
             }
-            *ret_packet_storage = *packet_storage;
+            *ret_packet_storage = packet;
             gquic_list_insert_before(packets, ret_packet_storage);
         }
     }
     return 0;
-failure:
-    return ret;
 }
 
 static int gquic_packet_sent_packet_handler_on_packet_acked(gquic_packet_sent_packet_handler_t *const handler,
@@ -585,9 +798,11 @@ static int gquic_packet_sent_packet_handler_on_packet_acked(gquic_packet_sent_pa
     if (mem_packet == NULL) {
         return -4;
     }
-    GQUIC_LIST_FOREACH(frame, &packet->frames) {
-        if (GQUIC_FRAME_META(*frame).on_acked.self != NULL) {
-            GQUIC_FRAME_ON_ACKED(*frame);
+    if (packet->frames != NULL) {
+        GQUIC_LIST_FOREACH(frame, packet->frames) {
+            if (GQUIC_FRAME_META(*frame).on_acked.self != NULL) {
+                GQUIC_FRAME_ON_ACKED(*frame);
+            }
         }
     }
     if (packet->included_infly) {
@@ -612,48 +827,47 @@ static int gquic_packet_sent_packet_handler_detect_lost_packets(gquic_packet_sen
                                                                 const u_int64_t now,
                                                                 const u_int8_t enc_lv,
                                                                 const u_int64_t infly) {
-    double max_rtt = 0;
-    double loss_delay = 0;
+    u_int64_t max_rtt = 0;
+    u_int64_t loss_delay = 0;
     u_int64_t lost_send_time = 0;
+    u_int64_t pn = 0;
     gquic_packet_sent_pn_t *pn_spec = NULL;
-    gquic_list_t lost_packets;
-    gquic_packet_t **packet_storage = NULL;
-    gquic_packet_t **lost_packet_storage = NULL;
+    gquic_packet_t *packet = NULL;
+    u_int64_t forget_after = 0;
+    gquic_packet_sent_lost_t lost;
     if (handler == NULL) {
         return -1;
     }
-    gquic_list_head_init(&lost_packets);
     if ((pn_spec = gquic_sent_packet_handler_get_sent_pn(handler, enc_lv)) == NULL) {
         return -2;
     }
+    // the lost records stay bounded by the losses of the last 3 PTOs
+    forget_after = 3 * gquic_time_pto(handler->rtt, 1);
+    gquic_packet_sent_lost_mem_expire(&pn_spec->lost, now > forget_after ? now - forget_after : 0);
     pn_spec->loss_time = 0;
+    if (pn_spec->largest_ack == (u_int64_t) -1) {
+        return 0;
+    }
     max_rtt = handler->rtt->latest > handler->rtt->smooth ? handler->rtt->latest : handler->rtt->smooth;
-    loss_delay = 9.0 / 8 * max_rtt;
+    loss_delay = max_rtt + (max_rtt >> handler->reordering_shift);
     loss_delay = loss_delay > 1000 ? loss_delay : 1000;
-    lost_send_time = now - loss_delay;
-    GQUIC_LIST_FOREACH(packet_storage, &pn_spec->mem.list) {
-        if ((*packet_storage)->pn > pn_spec->largest_ack) {
+    lost_send_time = now > loss_delay ? now - loss_delay : 0;
+    // everything below largest_ack - reordering_threshold is declared lost here, so this only walks the last few packets
+    GQUIC_PACKET_SENT_MEM_FOREACH(packet, pn, &pn_spec->mem) {
+        if (packet->pn > pn_spec->largest_ack) {
             break;
         }
-        if ((*packet_storage)->send_time < lost_send_time
-            || pn_spec->largest_ack >= (*packet_storage)->pn + 3) {
-            if ((lost_packet_storage = gquic_list_alloc(sizeof(gquic_packet_t *))) == NULL) {
-                return -3;
+        if (packet->send_time >= lost_send_time && pn_spec->largest_ack < packet->pn + handler->reordering_threshold) {
+            if (pn_spec->loss_time == 0) {
+                pn_spec->loss_time = packet->send_time + loss_delay;
             }
-            *lost_packet_storage = *packet_storage;
-            gquic_list_insert_before(&lost_packets, lost_packet_storage);
-        }
-        else if (pn_spec->loss_time == 0) {
-            pn_spec->loss_time = (*packet_storage)->send_time + loss_delay;
+            continue;
         }
-    }
-    GQUIC_LIST_FOREACH(lost_packet_storage, &lost_packets) {
-        gquic_packet_sent_packet_handler_queue_frames_for_retrans(*lost_packet_storage);
-        if ((*lost_packet_storage)->included_infly) {
-            handler->infly_bytes -= (*lost_packet_storage)->len;
-            gquic_cong_cubic_on_packet_lost(&handler->cong, (*lost_packet_storage)->pn, (*lost_packet_storage)->len, infly);
+        if (packet->included_infly) {
+            handler->infly_bytes -= packet->len;
+            GQUIC_CONG_ON_PACKET_LOST(&handler->cong, packet->pn, packet->len, infly);
         }
-        gquic_packet_sent_mem_remove(&pn_spec->mem, (*lost_packet_storage)->pn, gquic_packet_sent_packet_handler_packet_release);
+        gquic_packet_ecn_on_packet_lost(&handler->ecn, packet->ecn);
         if (handler->event_cb.self != NULL) {
             gquic_event_t event = {
                 now,
@@ -663,30 +877,139 @@ static int gquic_packet_sent_packet_handler_detect_lost_packets(gquic_packet_sen
                     handler->rtt->smooth,
                     handler->rtt->latest,
                     handler->infly_bytes,
-                    handler->cong.cwnd,
-                    gquic_cong_cubic_in_slow_start(&handler->cong),
-                    gquic_cong_cubic_in_recovery(&handler->cong)
+                    GQUIC_CONG_CWND(&handler->cong),
+                    GQUIC_CONG_IN_SLOW_START(&handler->cong),
+                    GQUIC_CONG_IN_RECOVERY(&handler->cong)
                 },
-                (*lost_packet_storage)->enc_lv,
-                (*lost_packet_storage)->pn,
-                (*lost_packet_storage)->len,
-                (*lost_packet_storage)->frames
+                packet->enc_lv,
+                packet->pn,
+                packet->len,
+                packet->frames,
+                { 0, 0, 0, 0 }
             };
             GQUIC_PACKET_SENT_PACKET_HANDLER_EVENT_CALLBACK(handler, &event);
         }
+        lost.pn = packet->pn;
+        lost.len = packet->len;
+        lost.send_time = packet->send_time;
+        lost.lost_time = now;
+        lost.included_infly = packet->included_infly;
+        lost.acked = 0;
+        gquic_packet_sent_lost_mem_add(&pn_spec->lost, &lost);
+        gquic_packet_sent_packet_handler_queue_frames_for_retrans(packet);
+        gquic_packet_sent_mem_remove(&pn_spec->mem, pn, gquic_packet_sent_packet_handler_packet_release);
     }
 
     return 0;
 }
 
+static int gquic_packet_sent_packet_handler_detect_spurious_losses(gquic_packet_sent_packet_handler_t *const handler,
+                                                                   const gquic_list_t *const blocks,
+                                                                   const u_int64_t now,
+                                                                   const u_int8_t enc_lv) {
+    gquic_packet_sent_pn_t *pn_spec = NULL;
+    gquic_packet_sent_lost_t *lost = NULL;
+    gquic_frame_ack_block_t *block = NULL;
+    u_int64_t max_rtt = 0;
+    u_int64_t forget_after = 0;
+    u_int64_t i = 0;
+    if (handler == NULL || blocks == NULL) {
+        return -1;
+    }
+    if ((pn_spec = gquic_sent_packet_handler_get_sent_pn(handler, enc_lv)) == NULL) {
+        return -2;
+    }
+    forget_after = 3 * gquic_time_pto(handler->rtt, 1);
+    gquic_packet_sent_lost_mem_expire(&pn_spec->lost, now > forget_after ? now - forget_after : 0);
+    if (pn_spec->lost.count == 0) {
+        return 0;
+    }
+    max_rtt = handler->rtt->latest > handler->rtt->smooth ? handler->rtt->latest : handler->rtt->smooth;
+    // each block costs a binary search, then only the lost packets it acks
+    GQUIC_LIST_FOREACH(block, blocks) {
+        for (i = gquic_packet_sent_lost_mem_lower_bound(&pn_spec->lost, block->smallest);
+             i < pn_spec->lost.count && GQUIC_PACKET_SENT_LOST_MEM_AT(&pn_spec->lost, i).pn <= block->largest;
+             i++) {
+            lost = &GQUIC_PACKET_SENT_LOST_MEM_AT(&pn_spec->lost, i);
+            if (lost->acked) {
+                continue;
+            }
+            lost->acked = 1;
+            gquic_packet_sent_packet_handler_on_spurious_loss(handler, pn_spec, lost, max_rtt, now, enc_lv);
+        }
+    }
+    gquic_packet_sent_lost_mem_expire(&pn_spec->lost, 0);
+    return 0;
+}
+
+static int gquic_packet_sent_packet_handler_on_spurious_loss(gquic_packet_sent_packet_handler_t *const handler,
+                                                             gquic_packet_sent_pn_t *const pn_spec,
+                                                             const gquic_packet_sent_lost_t *const lost,
+                                                             const u_int64_t max_rtt,
+                                                             const u_int64_t now,
+                                                             const u_int8_t enc_lv) {
+    u_int64_t threshold = 0;
+    if (handler == NULL || pn_spec == NULL || lost == NULL) {
+        return -1;
+    }
+    handler->spurious_losses++;
+    // the packet made it behind largest_ack - pn later ones, or took longer than the time threshold allowed
+    threshold = pn_spec->largest_ack - lost->pn + 1;
+    threshold = threshold < GQUIC_PACKET_SENT_PACKET_HANDLER_MAX_PACKET_THRESHOLD ? threshold : GQUIC_PACKET_SENT_PACKET_HANDLER_MAX_PACKET_THRESHOLD;
+    handler->reordering_threshold = threshold > handler->reordering_threshold ? threshold : handler->reordering_threshold;
+    while (handler->reordering_shift > 0 && max_rtt + (max_rtt >> handler->reordering_shift) < now - lost->send_time) {
+        handler->reordering_shift--;
+    }
+    if (lost->included_infly) {
+        GQUIC_CONG_ON_SPURIOUS_LOSS(&handler->cong, lost->pn, lost->len);
+    }
+    if (handler->event_cb.self != NULL) {
+        gquic_event_t event = {
+            now,
+            GQUIC_EVENT_SPURIOUS_LOSS,
+            {
+                handler->rtt->min,
+                handler->rtt->smooth,
+                handler->rtt->latest,
+                handler->infly_bytes,
+                GQUIC_CONG_CWND(&handler->cong),
+                GQUIC_CONG_IN_SLOW_START(&handler->cong),
+                GQUIC_CONG_IN_RECOVERY(&handler->cong)
+            },
+            enc_lv,
+            lost->pn,
+            lost->len,
+            NULL,
+            { 0, 0, 0, 0 }
+        };
+        GQUIC_PACKET_SENT_PACKET_HANDLER_EVENT_CALLBACK(handler, &event);
+    }
+    return 0;
+}
+
 static int gquic_packet_sent_packet_handler_queue_frames_for_retrans(gquic_packet_t *const packet) {
     void **frame_storage = NULL;
     if (packet == NULL) {
         return -1;
     }
-    GQUIC_LIST_FOREACH(frame_storage, &packet->frames) {
-        GQUIC_FRAME_ON_LOST(*frame_storage);
+    if (packet->frames == NULL) {
+        return 0;
+    }
+    GQUIC_LIST_FOREACH(frame_storage, packet->frames) {
+        if (GQUIC_FRAME_META(*frame_storage).on_lost.self != NULL) {
+            GQUIC_FRAME_ON_LOST(*frame_storage);
+        }
+    }
+    // the retransmission queue owns the frames now, releasing the packet must not free them
+    while (!gquic_list_head_empty(packet->frames)) {
+        frame_storage = GQUIC_LIST_FIRST(packet->frames);
+        if (GQUIC_FRAME_META(*frame_storage).on_lost.self == NULL) {
+            gquic_frame_release(*frame_storage);
+        }
+        gquic_list_release(frame_storage);
     }
+    free(packet->frames);
+    packet->frames = NULL;
 
     return 0;
 }
@@ -722,6 +1045,8 @@ static int gquic_packet_sent_packet_handler_on_verified_loss_detection_timeout(g
                                                                  handler->infly_bytes) != 0) {
             return -2;
         }
+        // the time threshold fired, this is no PTO
+        return 0;
     }
     gquic_sent_packet_handler_get_earliest_loss_time_space(&_, &enc_lv, handler);
     handler->pto_count++;
@@ -746,7 +1071,7 @@ int gquic_packet_sent_packet_handler_peek_pn(u_int64_t *const pn,
                                              int *const pn_len,
                                              gquic_packet_sent_packet_handler_t *const handler,
                                              const u_int8_t enc_lv) {
-    gquic_packet_t **packet_storage = NULL;
+    gquic_packet_t *packet = NULL;
     gquic_packet_sent_pn_t *pn_spec = NULL;
     u_int64_t lowest_unacked = 0;
     if (pn == NULL || pn_len == NULL || handler == NULL) {
@@ -755,11 +1080,8 @@ int gquic_packet_sent_packet_handler_peek_pn(u_int64_t *const pn,
     if ((pn_spec = gquic_sent_packet_handler_get_sent_pn(handler, enc_lv)) == NULL) {
         return -2;
     }
-    if (!gquic_list_head_empty(&pn_spec->mem.list)) {
-        packet_storage = GQUIC_LIST_FIRST(&pn_spec->mem.list);
-    }
-    if (packet_storage != NULL) {
-        lowest_unacked = (*packet_storage)->pn;
+    if ((packet = gquic_packet_sent_mem_first(&pn_spec->mem)) != NULL) {
+        lowest_unacked = packet->pn;
     }
     else {
         lowest_unacked = pn_spec->largest_ack + 1;
@@ -785,6 +1107,7 @@ int gquic_packet_sent_packet_handler_pop_pn(u_int64_t *const ret, gquic_packet_s
 
 u_int8_t gquic_packet_sent_packet_handler_send_mode(gquic_packet_sent_packet_handler_t *const handler) {
     u_int64_t packets_count = 0;
+    u_int64_t max_tracked = 0;
     if (handler == NULL) {
         return GQUIC_SEND_MODE_NONE;
     }
@@ -798,55 +1121,126 @@ u_int8_t gquic_packet_sent_packet_handler_send_mode(gquic_packet_sent_packet_han
     if (handler->handshake_packets != NULL) {
         packets_count += handler->handshake_packets->mem.count;
     }
-    if (packets_count >= 1000 * 2 * 5 / 4) {
+    // a window's worth of packets is tracked, well past that acks stopped coming back
+    max_tracked = 2 * GQUIC_CONG_CWND(&handler->cong) / handler->pacer.max_datagram_size;
+    if (max_tracked < GQUIC_PACKET_SENT_PACKET_HANDLER_MIN_TRACKED) {
+        max_tracked = GQUIC_PACKET_SENT_PACKET_HANDLER_MIN_TRACKED;
+    }
+    if (packets_count >= max_tracked * 5 / 4) {
+        return GQUIC_SEND_MODE_NONE;
+    }
+    // anti-amplification, probes included
+    if (!handler->peer_addr_validated && handler->bytes_sent >= 3 * handler->bytes_received) {
         return GQUIC_SEND_MODE_NONE;
     }
     if (handler->num_probes_to_send > 0) {
         return handler->pto_mode;
     }
-    if (!gquic_cong_cubic_allowable_send(&handler->cong, handler->infly_bytes)) {
+    if (!GQUIC_CONG_CAN_SEND(&handler->cong, handler->infly_bytes)) {
         return GQUIC_SEND_MODE_ACK;
     }
-    if (packets_count >= 1000 * 2) {
+    if (packets_count >= max_tracked) {
         return GQUIC_SEND_MODE_ACK;
     }
 
     return GQUIC_SEND_MODE_ANY;
 }
 
-int gquic_packet_sent_packet_handler_should_send_packets_count(gquic_packet_sent_packet_handler_t *const handler) {
-    u_int64_t delay = 0;
+int gquic_packet_sent_packet_handler_should_send_packets_count(gquic_packet_sent_packet_handler_t *const handler, const u_int64_t now) {
     if (handler == NULL) {
         return 0;
     }
     if (handler->num_probes_to_send > 0) {
         return handler->num_probes_to_send;
     }
-    delay = gquic_cong_cubic_time_util_send(&handler->cong, handler->infly_bytes);
-    if (delay == 0 || delay > 100) {
-        return 1;
+    // the whole window goes out in one batch, the departure times space it
+    if (handler->txtime) {
+        return gquic_packet_sent_packet_handler_allowable_packets_count(handler, handler->pacer.max_datagram_size);
+    }
+    return gquic_packet_pacer_allowed_packets(&handler->pacer, GQUIC_CONG_PACING_RATE(&handler->cong), now);
+}
+
+u_int64_t gquic_packet_sent_packet_handler_next_send_time(gquic_packet_sent_packet_handler_t *const handler, const u_int64_t now) {
+    if (handler == NULL || handler->txtime) {
+        return 0;
+    }
+    return gquic_packet_pacer_next_release(&handler->pacer, GQUIC_CONG_PACING_RATE(&handler->cong), now);
+}
+
+int gquic_packet_sent_packet_handler_set_pacing(gquic_packet_sent_packet_handler_t *const handler,
+                                                const u_int64_t max_datagram_size,
+                                                const u_int64_t burst_packets,
+                                                const u_int64_t gso_segments) {
+    if (handler == NULL) {
+        return -1;
+    }
+    return gquic_packet_pacer_ctor(&handler->pacer, max_datagram_size, burst_packets, gso_segments);
+}
+
+int gquic_packet_sent_packet_handler_set_txtime(gquic_packet_sent_packet_handler_t *const handler, const int txtime) {
+    if (handler == NULL) {
+        return -1;
+    }
+    handler->txtime = txtime;
+    return 0;
+}
+
+int gquic_packet_sent_packet_handler_enable_ecn(gquic_packet_sent_packet_handler_t *const handler) {
+    if (handler == NULL) {
+        return -1;
+    }
+    return gquic_packet_ecn_enable(&handler->ecn);
+}
+
+u_int64_t gquic_packet_sent_packet_handler_allowable_packets_count(gquic_packet_sent_packet_handler_t *const handler, const u_int64_t packet_size) {
+    u_int64_t cwnd = 0;
+    if (handler == NULL || packet_size == 0) {
+        return 0;
+    }
+    // PRR grants sending one packet at a time
+    if (GQUIC_CONG_IN_RECOVERY(&handler->cong)) {
+        return GQUIC_CONG_CAN_SEND(&handler->cong, handler->infly_bytes) ? 1 : 0;
+    }
+    cwnd = GQUIC_CONG_CWND(&handler->cong);
+    if (handler->infly_bytes >= cwnd) {
+        return 0;
+    }
+    return (cwnd - handler->infly_bytes + packet_size - 1) / packet_size;
+}
+
+int gquic_packet_sent_packet_handler_set_app_limited(gquic_packet_sent_packet_handler_t *const handler) {
+    if (handler == NULL) {
+        return -1;
+    }
+    gquic_packet_rate_sampler_on_app_limited(&handler->rate_sampler, handler->infly_bytes);
+    GQUIC_CONG_ON_APP_LIMITED(&handler->cong, handler->infly_bytes);
+    return 0;
+}
+
+int gquic_packet_sent_packet_handler_rate_stats(gquic_packet_rate_stats_t *const stats, const gquic_packet_sent_packet_handler_t *const handler) {
+    if (stats == NULL || handler == NULL) {
+        return -1;
     }
-    return ceil(((double) 100) / delay);
+    return gquic_packet_rate_sampler_stats(stats, &handler->rate_sampler);
 }
 
 int gquic_packet_sent_packet_handler_queue_probe_packet(gquic_packet_sent_packet_handler_t *const handler, const u_int8_t enc_lv) {
     gquic_packet_sent_pn_t *pn_spec = NULL;
-    gquic_packet_t **packet_storage = 0;
+    gquic_packet_t *packet = NULL;
     if (handler == NULL) {
         return 0;
     }
     if ((pn_spec = gquic_sent_packet_handler_get_sent_pn(handler, enc_lv)) == NULL) {
         return 0;
     }
-    if (gquic_list_head_empty(&pn_spec->mem.list)) {
+    if ((packet = gquic_packet_sent_mem_first(&pn_spec->mem)) == NULL) {
         return 0;
     }
-    packet_storage = GQUIC_LIST_FIRST(&pn_spec->mem.list);
-    gquic_packet_sent_packet_handler_queue_frames_for_retrans(*packet_storage);
-    if ((*packet_storage)->included_infly) {
-        handler->infly_bytes -= (*packet_storage)->len;
+    gquic_packet_sent_packet_handler_queue_frames_for_retrans(packet);
+    if (packet->included_infly) {
+        handler->infly_bytes -= packet->len;
     }
-    if (gquic_packet_sent_mem_remove(&pn_spec->mem, (*packet_storage)->pn, gquic_packet_sent_packet_handler_packet_release) != 0) {
+    if (gquic_packet_sent_mem_remove(&pn_spec->mem, packet->pn, gquic_packet_sent_packet_handler_packet_release) != 0) {
         return 0;
     }
 
@@ -854,18 +1248,18 @@ int gquic_packet_sent_packet_handler_queue_probe_packet(gquic_packet_sent_packet
 }
 
 int gquic_packet_sent_packet_handler_reset_for_retry(gquic_packet_sent_packet_handler_t *const handler) {
-    gquic_packet_t **packet_storage = NULL;
+    gquic_packet_t *packet = NULL;
     u_int64_t pn = 0;
     if (handler == NULL) {
         return -1;
     }
-    handler->infly_bytes = 0;
-    GQUIC_LIST_FOREACH(packet_storage, &handler->initial_packets->mem.list) {
-        gquic_packet_sent_packet_handler_queue_frames_for_retrans(*packet_storage);
-    }
     if (handler->initial_packets == NULL) {
         return -2;
     }
+    handler->infly_bytes = 0;
+    GQUIC_PACKET_SENT_MEM_FOREACH(packet, pn, &handler->initial_packets->mem) {
+        gquic_packet_sent_packet_handler_queue_frames_for_retrans(packet);
+    }
     if (gquic_packet_number_gen_next(&pn, &handler->initial_packets->pn_gen) != 0) {
         return -3;
     }
@@ -882,6 +1276,30 @@ int gquic_packet_sent_packet_handler_reset_for_retry(gquic_packet_sent_packet_ha
     return 0;
 }
 
+int gquic_packet_sent_packet_handler_reset_for_0rtt_reject(gquic_packet_sent_packet_handler_t *const handler) {
+    gquic_packet_t *packet = NULL;
+    u_int64_t pn = 0;
+    if (handler == NULL) {
+        return -1;
+    }
+    if (handler->one_rtt_packets == NULL) {
+        return -2;
+    }
+    // the server never read these, resend their frames in 1-RTT packets without counting a loss
+    GQUIC_PACKET_SENT_MEM_FOREACH(packet, pn, &handler->one_rtt_packets->mem) {
+        if (packet->enc_lv != GQUIC_ENC_LV_0RTT) {
+            continue;
+        }
+        gquic_packet_sent_packet_handler_queue_frames_for_retrans(packet);
+        if (packet->included_infly) {
+            handler->infly_bytes -= packet->len;
+        }
+        gquic_packet_sent_mem_remove(&handler->one_rtt_packets->mem, pn, gquic_packet_sent_packet_handler_packet_release);
+    }
+    gquic_sent_packet_handler_set_loss_detection_timer(handler);
+    return 0;
+}
+
 int gquic_packet_sent_packet_handler_set_handshake_complete(gquic_packet_sent_packet_handler_t *const handler) {
     if (handler == NULL) {
         return -1;
@@ -890,3 +1308,19 @@ int gquic_packet_sent_packet_handler_set_handshake_complete(gquic_packet_sent_pa
     gquic_sent_packet_handler_set_loss_detection_timer(handler);
     return 0;
 }
+
+int gquic_packet_sent_packet_handler_received_bytes(gquic_packet_sent_packet_handler_t *const handler, const u_int64_t n) {
+    if (handler == NULL) {
+        return -1;
+    }
+    handler->bytes_received += n;
+    return 0;
+}
+
+int gquic_packet_sent_packet_handler_set_peer_addr_validated(gquic_packet_sent_packet_handler_t *const handler) {
+    if (handler == NULL) {
+        return -1;
+    }
+    handler->peer_addr_validated = 1;
+    return 0;
+}
@@ -5,7 +5,6 @@ static int gquic_common_long_header_opener_open_wrapper(gquic_str_t *const,
                                                         void *const,
                                                         const u_int64_t,
                                                         const gquic_str_t *const,
-                                                        const gquic_str_t *const,
                                                         const gquic_str_t *const);
 static int gquic_1rtt_opener_open_wrapper(gquic_str_t *const,
                                           void *const,
@@ -13,7 +12,6 @@ static int gquic_1rtt_opener_open_wrapper(gquic_str_t *const,
                                           const u_int64_t,
                                           const int,
                                           const gquic_str_t *const,
-                                          const gquic_str_t *const,
                                           const gquic_str_t *const);
 static int gquic_packet_unpacker_unpack_header_packet(gquic_unpacked_packet_t *const,
                                                       gquic_packet_unpacker_t *const,
@@ -56,7 +54,7 @@ int gquic_unpacked_packet_dtor(gquic_unpacked_packet_t *const unpacked_packet) {
         return -1;
     }
     gquic_packet_header_dtor(&unpacked_packet->hdr);
-    gquic_str_reset(&unpacked_packet->data);
+    gquic_str_init(&unpacked_packet->data);
 
     return 0;
 }
@@ -108,6 +106,19 @@ int gquic_packet_unpacker_unpack(gquic_unpacked_packet_t *const unpacked_packet,
                 return -3;
             }
             break;
+        case 0x01:
+            unpacked_packet->enc_lv = GQUIC_ENC_LV_0RTT;
+            payload.opener.is_1rtt = 0;
+            payload.opener.cb.cb = gquic_common_long_header_opener_open_wrapper;
+            if ((ret = gquic_handshake_establish_get_0rtt_opener(&payload.header_opener,
+                                                                 (gquic_common_long_header_opener_t **) &payload.opener.self,
+                                                                 unpacker->est)) != 0) {
+                if (ret == -2) {
+                    return -12; // 0-RTT key not available
+                }
+                return -13;
+            }
+            break;
         case 0x02:
             unpacked_packet->enc_lv = GQUIC_ENC_LV_HANDSHAKE;
             payload.opener.is_1rtt = 0;
@@ -160,24 +171,22 @@ int gquic_packet_unpacker_unpack(gquic_unpacked_packet_t *const unpacked_packet,
     return 0;
 }
 
-static int gquic_common_long_header_opener_open_wrapper(gquic_str_t *const plain_text,
+static int gquic_common_long_header_opener_open_wrapper(gquic_str_t *const text,
                                                         void *const self,
                                                         const u_int64_t pn,
                                                         const gquic_str_t *const tag,
-                                                        const gquic_str_t *const cipher_text,
                                                         const gquic_str_t *const addata) {
-    return gquic_common_long_header_opener_open(plain_text, self, pn, tag, cipher_text, addata);
+    return gquic_common_long_header_opener_open(text, self, pn, tag, addata);
 }
 
-static int gquic_1rtt_opener_open_wrapper(gquic_str_t *const plain_text,
+static int gquic_1rtt_opener_open_wrapper(gquic_str_t *const text,
                                           void *const self,
                                           const u_int64_t recv_time,
                                           const u_int64_t pn,
                                           const int kp,
                                           const gquic_str_t *const tag,
-                                          const gquic_str_t *const cipher_text,
                                           const gquic_str_t *const addata) {
-    return gquic_auto_update_aead_open(plain_text, self, recv_time, pn, kp, tag, cipher_text, addata);
+    return gquic_auto_update_aead_open(text, self, recv_time, pn, kp, tag, addata);
 }
 
 static int gquic_packet_unpacker_unpack_header_packet(gquic_unpacked_packet_t *const unpacked_packet,
@@ -210,19 +219,22 @@ static int gquic_packet_unpacker_unpack_header_packet(gquic_unpacked_packet_t *c
     }
 
     u_int64_t header_len = GQUIC_STR_VAL(&reader) - GQUIC_STR_VAL(payload->data);
-    gquic_str_t tag = { 16, GQUIC_STR_VAL(payload->data) + header_len };
-    gquic_str_t cipher_text = { GQUIC_STR_SIZE(payload->data) - header_len - 16, GQUIC_STR_VAL(payload->data) + header_len + 16 };
+    if (GQUIC_STR_SIZE(payload->data) < header_len + GQUIC_TLS_AEAD_TAG_SIZE) {
+        return -7;
+    }
+    gquic_str_t text = { GQUIC_STR_SIZE(payload->data) - header_len - GQUIC_TLS_AEAD_TAG_SIZE, GQUIC_STR_VAL(payload->data) + header_len };
+    gquic_str_t tag = { GQUIC_TLS_AEAD_TAG_SIZE, GQUIC_STR_VAL(&text) + GQUIC_STR_SIZE(&text) };
     gquic_str_t addata = { header_len, GQUIC_STR_VAL(payload->data) };
-    if ((ret = GQUIC_UNPACKED_PACKET_PAYLOAD_OPEN(&unpacked_packet->data,
+    if ((ret = GQUIC_UNPACKED_PACKET_PAYLOAD_OPEN(&text,
                                                   payload,
                                                   payload->recv_time,
                                                   gquic_packet_header_get_pn(&unpacked_packet->hdr),
                                                   unpacked_packet->hdr.is_long == 0 && ((GQUIC_STR_FIRST_BYTE(payload->data) & 0x04) != 0),
                                                   &tag,
-                                                  &cipher_text,
                                                   &addata)) != 0) {
-        return -7;
+        return -8;
     }
+    unpacked_packet->data = text;
     return 0;
 }
 
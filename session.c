@@ -7,8 +7,11 @@
 #include "frame/new_token.h"
 #include "frame/retire_connection_id.h"
 #include "frame/data_blocked.h"
+#include "frame/ack_frequency.h"
+#include "frame/immediate_ack.h"
 #include "util/stream_id.h"
 #include "packet/send_mode.h"
+#include <openssl/crypto.h>
 
 static int gquic_session_add_reset_token_wrapper(void *const, const gquic_str_t *const);
 static int gquic_session_add_wrapper(gquic_str_t *const, void *const, const gquic_str_t *const);
@@ -28,11 +31,13 @@ static int gquic_session_stream_flow_ctrl_ctor(gquic_flowcontrol_stream_flow_ctr
 static int gquic_session_handshake_event_on_received_params_wrapper(void *const, const gquic_str_t *const);
 static int gquic_session_handshake_event_on_error_wrapper(void *const, const u_int16_t, const int);
 static int gquic_session_handshake_event_drop_keys_wrapper(void *const, const u_int8_t);
+static int gquic_session_handshake_event_on_restore_params_wrapper(void *const, const gquic_str_t *const);
 
 static int gquic_session_pre_setup(gquic_session_t *const);
 static int gquic_session_process_transport_parameters(gquic_session_t *const, const gquic_str_t *const);
 static int gquic_session_client_process_transport_parameters(gquic_transport_parameters_t *const, gquic_session_t *const, const gquic_str_t *const);
 static int gquic_session_server_process_transport_parameters(gquic_transport_parameters_t *const, gquic_session_t *const, const gquic_str_t *const);
+static int gquic_session_restore_transport_parameters(gquic_session_t *const, const gquic_str_t *const);
 static int gquic_session_close_local(gquic_session_t *const, const int);
 static int gquic_session_close_remote(gquic_session_t *const, const int);
 static int gquic_session_drop_enc_lv(gquic_session_t *const, const u_int8_t);
@@ -45,11 +50,12 @@ static int gquic_session_handle_single_packet(gquic_session_t *const, gquic_rece
 static int gquic_session_handle_retry_packet(gquic_session_t *const, const gquic_str_t *const);
 static int gquic_session_try_queue_undecryptable_packet(gquic_session_t *const, gquic_received_packet_t *const);
 static int gquic_session_try_decrypting_queued_packets(gquic_session_t *const);
-static int gquic_session_handle_unpacked_packet(gquic_session_t *const, gquic_unpacked_packet_t *const, const u_int64_t);
+static int gquic_session_handle_unpacked_packet(gquic_session_t *const, gquic_unpacked_packet_t *const, const u_int64_t, const u_int8_t);
 static int gquic_session_handle_frame(gquic_session_t *const, void *const, const u_int8_t);
 static int gquic_session_handle_stream_frame(gquic_session_t *const, gquic_frame_stream_t *const);
 static int gquic_session_handle_crypto_frame(gquic_session_t *const, gquic_frame_crypto_t *const, const u_int8_t); 
 static int gquic_session_handle_ack_frame(gquic_session_t *const, gquic_frame_ack_t *const, const u_int8_t);
+static int gquic_session_try_update_ack_frequency(gquic_session_t *const);
 static int gquic_session_handle_connection_close_frame(gquic_session_t *const, gquic_frame_connection_close_t *const);
 static int gquic_session_handle_reset_stream_frame(gquic_session_t *const, gquic_frame_reset_stream_t *const);
 static int gquic_session_handle_max_data_frame(gquic_session_t *const, gquic_frame_max_data_t *const);
@@ -58,6 +64,8 @@ static int gquic_session_handle_max_streams_frame(gquic_session_t *const, gquic_
 static int gquic_session_handle_stop_sending_frame(gquic_session_t *const, gquic_frame_stop_sending_t *const);
 static int gquic_session_handle_path_challenge_frame(gquic_session_t *const, gquic_frame_path_challenge_t *const);
 static int gquic_session_handle_new_token_frame(gquic_session_t *const, gquic_frame_new_token_t *const);
+static int gquic_session_queue_new_token_frame(gquic_session_t *const);
+static int gquic_session_validate_peer_addr(gquic_session_t *const, gquic_unpacked_packet_t *const, const u_int64_t);
 static int gquic_session_handle_new_conn_id_frame(gquic_session_t *const, gquic_frame_new_connection_id_t *const);
 static int gquic_session_handle_retire_conn_id_frame(gquic_session_t *const, gquic_frame_retire_connection_id_t *const);
 static int gquic_session_send_packets(gquic_session_t *const);
@@ -68,6 +76,7 @@ static int gquic_session_try_send_only_ack_packet(gquic_session_t *const);
 static int gquic_session_send_probe_packet(gquic_session_t *const, const u_int8_t);
 static int gquic_session_send_packed_packet(gquic_session_t *const, gquic_packed_packet_t *const);
 static int gquic_session_send_packet(int *const, gquic_session_t *const);
+static int gquic_session_send_app_packets(u_int64_t *const, gquic_session_t *const, const u_int64_t);
 static int gquic_session_handle_close_err(gquic_session_t *const, const int, const int, const int);
 static inline u_int64_t gquic_session_idle_timeout_start_time(gquic_session_t *const);
 
@@ -92,6 +101,9 @@ static int gquic_session_client_written_callback(void *const);
 static void *gquic_session_run_handshake_thread(void *const);
 static void *gquic_session_run_send_queue_thread(void *const);
 
+// the peer still acks at least every 32 ack-eliciting packets
+#define GQUIC_SESSION_MAX_ACK_ELICITING_THRESHOLD 32
+
 #define GQUIC_SESSION_EVENT_HANDSHAKE_COMPLETED 0x01
 #define GQUIC_SESSION_EVENT_SENDING_SCHEDULED 0x02
 #define GQUIC_SESSION_EVENT_RECEIVED_PACKAET 0x03
@@ -152,6 +164,7 @@ int gquic_session_init(gquic_session_t *const sess) {
     gquic_list_head_init(&sess->undecryptable_packets);
 
     sess->handshake_completed = 0;
+    sess->half_open = 0;
 
     sess->received_retry = 0;
     sess->received_first_packet = 0;
@@ -161,6 +174,7 @@ int gquic_session_init(gquic_session_t *const sess) {
     sess->last_packet_received_time = 0;
     sess->first_ack_eliciting_packet = 0;
     sess->pacing_deadline = 0;
+    sess->drop_0rtt_keys_time = 0;
 
     sess->peer_params_seted = 0;
     gquic_transport_parameters_init(&sess->peer_params);
@@ -170,6 +184,11 @@ int gquic_session_init(gquic_session_t *const sess) {
     sess->keep_alive_ping_sent = 0;
     sess->keep_alive_interval = 0;
 
+    sess->ack_frequency.seq = 0;
+    sess->ack_frequency.ack_eliciting_threshold = 1;
+    sess->ack_frequency.max_ack_delay = 0;
+    sess->ack_frequency.reordering_threshold = 0;
+
     sess->runner = NULL;
     gquic_crypto_stream_init(&sess->initial_stream);
     gquic_crypto_stream_init(&sess->handshake_stream);
@@ -194,6 +213,7 @@ int gquic_session_ctor(gquic_session_t *const sess,
                        const gquic_str_t *const src_conn_id,
                        const gquic_str_t *const stateless_reset_token,
                        gquic_config_t *const cfg,
+                       const gquic_version_t version,
                        const u_int64_t initial_pn, 
                        const int is_client) {
     if (sess == NULL
@@ -215,6 +235,7 @@ int gquic_session_ctor(gquic_session_t *const sess,
     }
     gquic_str_copy(&sess->cli_dst_conn_id, cli_dst_conn_id);
     sess->is_client = is_client;
+    sess->version = version;
     sess->conn = conn;
     sess->cfg = cfg;
     gquic_str_copy(&sess->handshake_dst_conn_id, dst_conn_id);
@@ -242,7 +263,7 @@ int gquic_session_ctor(gquic_session_t *const sess,
     if (gquic_session_pre_setup(sess) != 0) {
         return -5;
     }
-    if (gquic_packet_sent_packet_handler_ctor(&sess->sent_packet_handler, initial_pn, &sess->rtt, NULL, NULL) != 0) {
+    if (gquic_packet_sent_packet_handler_ctor(&sess->sent_packet_handler, initial_pn, &sess->rtt, sess->cfg->cong_algo, sess->cfg->max_cwnd, NULL, NULL) != 0) {
         return -6;
     }
     if (gquic_crypto_stream_ctor(&sess->initial_stream) != 0) {
@@ -268,6 +289,7 @@ int gquic_session_ctor(gquic_session_t *const sess,
     params.ack_delay_exponent = 3;
     params.disable_migration = 1;
     params.active_conn_id_limit = 4;
+    params.min_ack_delay = GQUIC_PACKET_RECEIVED_MIN_ACK_DELAY;
     if (!is_client) {
         gquic_str_copy(&params.stateless_reset_token, stateless_reset_token);
         gquic_str_copy(&params.original_conn_id, origin_dst_conn_id);
@@ -281,12 +303,19 @@ int gquic_session_ctor(gquic_session_t *const sess,
                                        is_client ? gquic_session_client_written_callback : NULL,
                                        &cfg->tls_config,
                                        dst_conn_id,
+                                       sess->version,
                                        &params,
                                        &sess->rtt,
                                        &conn->addr,
                                        sess->is_client) != 0) {
         return -10;
     }
+    if (cfg->key_update_packets != 0) {
+        sess->est.aead.update_after_packets = cfg->key_update_packets;
+    }
+    if (cfg->key_update_bytes != 0) {
+        sess->est.aead.update_after_bytes = cfg->key_update_bytes;
+    }
     sess->est.events.on_recv_params.cb = gquic_session_handshake_event_on_received_params_wrapper;
     sess->est.events.on_recv_params.self = sess;
     sess->est.events.on_err.cb = gquic_session_handshake_event_on_error_wrapper;
@@ -297,6 +326,8 @@ int gquic_session_ctor(gquic_session_t *const sess,
         ? gquic_session_on_handshake_complete_client_wrapper
         : gquic_session_on_handshake_complete_server_wrapper;
     sess->est.events.on_handshake_complete.self = sess;
+    sess->est.events.on_restore_params.cb = gquic_session_handshake_event_on_restore_params_wrapper;
+    sess->est.events.on_restore_params.self = sess;
 
     if (gquic_crypto_stream_manager_ctor(&sess->crypto_stream_manager,
                                          &sess->est, gquic_handshake_establish_handle_msg_wrapper,
@@ -323,11 +354,29 @@ int gquic_session_ctor(gquic_session_t *const sess,
                                  sess->is_client) != 0) {
         return -13;
     }
+    gquic_packet_sent_packet_handler_set_pacing(&sess->sent_packet_handler,
+                                                sess->packer.max_packet_size, cfg->pacing_burst_packets, cfg->gso_segments);
+    if (cfg->txtime && gquic_net_conn_enable_txtime(conn) == 0) {
+        gquic_packet_sent_packet_handler_set_txtime(&sess->sent_packet_handler, 1);
+    }
+    if (cfg->ecn) {
+        gquic_packet_sent_packet_handler_enable_ecn(&sess->sent_packet_handler);
+    }
 
-    if (is_client && GQUIC_STR_SIZE(&cfg->tls_config.ser_name) != 0) {
-        gquic_str_copy(&sess->token_store_key, &cfg->tls_config.ser_name);
+    if (is_client) {
+        // the server proves the path itself, so only the server waits on the amplification limit
+        gquic_packet_sent_packet_handler_set_peer_addr_validated(&sess->sent_packet_handler);
+        if (GQUIC_STR_SIZE(&cfg->tls_config.ser_name) != 0) {
+            gquic_str_copy(&sess->token_store_key, &cfg->tls_config.ser_name);
+        }
+        if (cfg->token_store != NULL && GQUIC_STR_SIZE(&sess->token_store_key) != 0) {
+            GQUIC_TOKEN_STORE_POP(cfg->token_store, &sess->packer.token, &sess->token_store_key);
+        }
+    }
+    else if (cfg->retry_policy != NULL) {
+        gquic_packet_retry_policy_handshake_started(cfg->retry_policy);
+        sess->half_open = 1;
     }
-    // TODO is_client && token store
     return 0;
 }
 
@@ -411,6 +460,10 @@ static int gquic_session_handshake_event_drop_keys_wrapper(void *const sess, con
     return gquic_session_drop_enc_lv(sess, enc_lv);
 }
 
+static int gquic_session_handshake_event_on_restore_params_wrapper(void *const sess, const gquic_str_t *const data) {
+    return gquic_session_restore_transport_parameters(sess, data);
+}
+
 static int gquic_packet_handler_map_remove_reset_token_wrapper(void *const handler, const gquic_str_t *const token) {
     return gquic_packet_handler_map_remove_reset_token(handler, token);
 }
@@ -671,6 +724,13 @@ int gquic_session_queue_control_frame(gquic_session_t *const sess, void *const f
     return 0;
 }
 
+int gquic_session_rate_stats(gquic_packet_rate_stats_t *const stats, gquic_session_t *const sess) {
+    if (stats == NULL || sess == NULL) {
+        return -1;
+    }
+    return gquic_packet_sent_packet_handler_rate_stats(stats, &sess->sent_packet_handler);
+}
+
 int gquic_session_run(gquic_session_t *const sess) {
     int ret = 0;
     struct {
@@ -757,6 +817,15 @@ int gquic_session_run(gquic_session_t *const sess) {
         struct timezone tz;
         gettimeofday(&tv, &tz);
         u_int64_t now = tv.tv_sec * 1000 * 1000 + tv.tv_usec;
+        // the expiry is one of the session deadlines, so this runs when its timer fires
+        if (sess->est.aead.prev_recv_aead_expire != 0 && sess->est.aead.prev_recv_aead_expire <= now) {
+            gquic_auto_update_aead_drop_prev_keys(&sess->est.aead, now);
+        }
+        // the keys are dropped once; after that the time stays past every deadline
+        if (sess->drop_0rtt_keys_time != 0 && sess->drop_0rtt_keys_time <= now) {
+            gquic_handshake_establish_drop_0rtt_keys(&sess->est);
+            sess->drop_0rtt_keys_time = (u_int64_t) -1;
+        }
         if (sess->sent_packet_handler.alarm != 0 && sess->sent_packet_handler.alarm < now) {
             if ((ret = gquic_packet_sent_packet_handler_on_loss_detection_timeout(&sess->sent_packet_handler)) != 0) {
                 gquic_session_close_local(sess, 10 * ret - 9);
@@ -766,7 +835,7 @@ int gquic_session_run(gquic_session_t *const sess) {
 
         u_int64_t pacing_deadline = 0;
         if (sess->pacing_deadline == 0) {
-            pacing_deadline = sess->sent_packet_handler.next_send_time;
+            pacing_deadline = gquic_packet_sent_packet_handler_next_send_time(&sess->sent_packet_handler, now);
         }
         if (sess->cfg->keep_alive
             && !sess->keep_alive_ping_sent
@@ -802,6 +871,11 @@ closed:
     gquic_packet_send_queue_close(&sess->send_queue);
 
 finished:
+    // a session that fails to start is no longer half-open either
+    if (sess->half_open) {
+        gquic_packet_retry_policy_handshake_finished(sess->cfg->retry_policy);
+        sess->half_open = 0;
+    }
     sem_post(&sess->done_signal);
     return err_msg.err;
 }
@@ -868,6 +942,12 @@ static int gquic_session_try_reset_deadline(gquic_session_t *const sess) {
     if ((tmp = sess->pacing_deadline) != 0) {
         sess->deadline = tmp < sess->deadline ? tmp : sess->deadline;
     }
+    if ((tmp = sess->est.aead.prev_recv_aead_expire) != 0) {
+        sess->deadline = tmp < sess->deadline ? tmp : sess->deadline;
+    }
+    if ((tmp = sess->drop_0rtt_keys_time) != 0) {
+        sess->deadline = tmp < sess->deadline ? tmp : sess->deadline;
+    }
     return 0;
 }
 
@@ -945,6 +1025,8 @@ static int gquic_session_process_transport_parameters(gquic_session_t *const ses
         sess->packer.max_packet_size = sess->packer.max_packet_size < sess->peer_params.max_packet_size
             ? sess->packer.max_packet_size
             : sess->peer_params.max_packet_size;
+        gquic_packet_sent_packet_handler_set_pacing(&sess->sent_packet_handler,
+                                                    sess->packer.max_packet_size, sess->cfg->pacing_burst_packets, sess->cfg->gso_segments);
     }
     sess->frame_parser.ack_delay_exponent = sess->peer_params.ack_delay_exponent;
     gquic_flowcontrol_base_update_swnd(&sess->conn_flow_ctrl.base, sess->peer_params.init_max_data);
@@ -953,11 +1035,49 @@ static int gquic_session_process_transport_parameters(gquic_session_t *const ses
     if (GQUIC_STR_SIZE(&sess->peer_params.stateless_reset_token) != 0) {
         gquic_conn_id_manager_set_stateless_reset_token(&sess->conn_id_manager, &sess->peer_params.stateless_reset_token);
     }
+    sess->peer_params_seted = 1;
 
     sem_post(&sess->early_sess_ready);
     return 0;
 }
 
+static int gquic_session_restore_transport_parameters(gquic_session_t *const sess, const gquic_str_t *const data) {
+    gquic_transport_parameters_t params;
+    gquic_reader_str_t reader = { 0, NULL };
+    int ret = 0;
+    if (sess == NULL || data == NULL) {
+        return -1;
+    }
+    if (GQUIC_STR_SIZE(data) == 0) {
+        return 0;
+    }
+    gquic_transport_parameters_init(&params);
+    reader = *data;
+    if (gquic_transport_parameters_deserialize(&params, &reader) != 0) {
+        ret = -2;
+        goto finished;
+    }
+
+    // early data runs on the limits of the previous connection, conn IDs and the reset token do not carry over
+    sess->peer_params.init_max_data = params.init_max_data;
+    sess->peer_params.init_max_stream_data_bidi_local = params.init_max_stream_data_bidi_local;
+    sess->peer_params.init_max_stream_data_bidi_remote = params.init_max_stream_data_bidi_remote;
+    sess->peer_params.init_max_stream_data_uni = params.init_max_stream_data_uni;
+    sess->peer_params.max_streams_bidi = params.max_streams_bidi;
+    sess->peer_params.max_streams_uni = params.max_streams_uni;
+    sess->peer_params.active_conn_id_limit = params.active_conn_id_limit;
+    sess->peer_params_seted = 1;
+    if (gquic_stream_map_handle_update_limits(&sess->streams_map, &sess->peer_params) != 0) {
+        ret = -3;
+        goto finished;
+    }
+    gquic_flowcontrol_base_update_swnd(&sess->conn_flow_ctrl.base, sess->peer_params.init_max_data);
+finished:
+    gquic_str_reset(&params.original_conn_id);
+    gquic_str_reset(&params.stateless_reset_token);
+    return ret;
+}
+
 static int gquic_session_client_process_transport_parameters(gquic_transport_parameters_t *const params,
                                                              gquic_session_t *const sess,
                                                              const gquic_str_t *const data) {
@@ -992,6 +1112,14 @@ static int gquic_session_drop_enc_lv(gquic_session_t *const sess, const u_int8_t
     if (sess == NULL) {
         return -1;
     }
+    if (enc_lv == GQUIC_ENC_LV_0RTT) {
+        // 0-RTT packets live in the application data number space, which stays
+        if (sess->is_client && sess->est.conn.early_data == GQUIC_TLS_EARLY_DATA_REJECTED) {
+            gquic_packet_sent_packet_handler_reset_for_0rtt_reject(&sess->sent_packet_handler);
+            gquic_session_schedule_sending(sess);
+        }
+        return 0;
+    }
     gquic_packet_sent_packet_handler_drop_packets(&sess->sent_packet_handler, enc_lv);
     gquic_packet_received_packet_handlers_drop_packets(&sess->recv_packet_handler, enc_lv);
 
@@ -1008,7 +1136,13 @@ static int gquic_session_handle_handshake_completed(gquic_session_t *const sess)
     gquic_packet_sent_packet_handler_set_handshake_complete(&sess->sent_packet_handler);
 
     if (!sess->is_client) {
-        // TODO gen token
+        if (sess->half_open) {
+            gquic_packet_retry_policy_handshake_finished(sess->cfg->retry_policy);
+            sess->half_open = 0;
+        }
+        if (sess->cfg->token_generator != NULL) {
+            gquic_session_queue_new_token_frame(sess);
+        }
         gquic_handshake_establish_drop_handshake_keys(&sess->est);
     }
 
@@ -1033,6 +1167,7 @@ static int gquic_session_handle_packet_inner(gquic_session_t *const sess, gquic_
     }
     data = rp->data;
     p = rp;
+    gquic_packet_sent_packet_handler_received_bytes(&sess->sent_packet_handler, GQUIC_STR_SIZE(&data));
     while (GQUIC_STR_SIZE(&data) != 0) {
         if (counter > 0) {
             p = gquic_received_packet_copy(p);
@@ -1089,7 +1224,8 @@ static int gquic_session_handle_single_packet(gquic_session_t *const sess, gquic
         && gquic_str_cmp(&src_conn_id, &sess->handshake_dst_conn_id) != 0) {
         goto free_rp_finished;
     }
-    if (gquic_packet_header_deserlialize_type(&rp->data) == GQUIC_LONG_HEADER_0RTT) {
+    // only a client sends early data
+    if (sess->is_client && gquic_packet_header_deserlialize_type(&rp->data) == GQUIC_LONG_HEADER_0RTT) {
         goto free_rp_finished;
     }
     if ((ret = gquic_packet_unpacker_unpack(&packet, &sess->unpacker, &rp->data, rp->recv_time)) != 0) {
@@ -1103,6 +1239,14 @@ static int gquic_session_handle_single_packet(gquic_session_t *const sess, gquic
             was_queued = 1;
             gquic_session_try_queue_undecryptable_packet(sess, rp);
             goto finished;
+        case -12:
+            // 0-RTT key not available, a server may still derive it from the ClientHello
+            if (sess->is_client) {
+                break;
+            }
+            was_queued = 1;
+            gquic_session_try_queue_undecryptable_packet(sess, rp);
+            goto finished;
         case -10:
             gquic_session_close_local(sess, -10 * 10 - 4);
             break;
@@ -1111,7 +1255,7 @@ static int gquic_session_handle_single_packet(gquic_session_t *const sess, gquic
         goto free_rp_finished;
     }
 
-    if ((ret = gquic_session_handle_unpacked_packet(sess, &packet, rp->recv_time) != 0)) {
+    if ((ret = gquic_session_handle_unpacked_packet(sess, &packet, rp->recv_time, rp->ecn) != 0)) {
         gquic_session_close_local(sess, 10 * ret - 3);
         ret = 0;
         goto free_rp_finished;
@@ -1131,6 +1275,7 @@ static int gquic_session_handle_retry_packet(gquic_session_t *const sess, const
     int ret = 0;
     gquic_packet_long_header_t *header = NULL;
     gquic_reader_str_t reader = { 0, NULL };
+    u_int8_t tag[GQUIC_PACKET_RETRY_TAG_SIZE];
     if (sess == NULL || data == NULL) {
         return 0;
     }
@@ -1146,11 +1291,10 @@ static int gquic_session_handle_retry_packet(gquic_session_t *const sess, const
         goto finished;
     }
 
-    gquic_str_t odcid = {
-        ((gquic_packet_retry_header_t *) GQUIC_LONG_HEADER_SPEC(header))->odcid_len,
-        ((gquic_packet_retry_header_t *) GQUIC_LONG_HEADER_SPEC(header))->odcid
-    };
-    if (gquic_str_cmp(&odcid, &sess->handshake_dst_conn_id) != 0) {
+    // a Retry meant for another Initial, or corrupted on the way, fails the tag
+    gquic_str_t retry = { GQUIC_STR_SIZE(data) - GQUIC_PACKET_RETRY_TAG_SIZE, GQUIC_STR_VAL(data) };
+    if (gquic_packet_retry_integrity_tag(tag, header->version, &sess->handshake_dst_conn_id, &retry) != 0
+        || CRYPTO_memcmp(tag, ((gquic_packet_retry_header_t *) GQUIC_LONG_HEADER_SPEC(header))->tag, GQUIC_PACKET_RETRY_TAG_SIZE) != 0) {
         ret = 0;
         goto finished;
     }
@@ -1209,7 +1353,7 @@ static int gquic_session_try_queue_undecryptable_packet(gquic_session_t *const s
     return 0;
 }
 
-static int gquic_session_handle_unpacked_packet(gquic_session_t *const sess, gquic_unpacked_packet_t *const up, const u_int64_t recv_time) {
+static int gquic_session_handle_unpacked_packet(gquic_session_t *const sess, gquic_unpacked_packet_t *const up, const u_int64_t recv_time, const u_int8_t ecn) {
     void *frame = NULL;
     int is_ack_eliciting = 0;
     gquic_reader_str_t reader = { 0, NULL };
@@ -1228,6 +1372,13 @@ static int gquic_session_handle_unpacked_packet(gquic_session_t *const sess, gqu
             gquic_conn_id_manager_change_initial_conn_id(&sess->conn_id_manager, &sess->handshake_dst_conn_id);
         }
     }
+    if (!sess->is_client && !sess->sent_packet_handler.peer_addr_validated) {
+        gquic_session_validate_peer_addr(sess, up, recv_time);
+    }
+    // 0-RTT packets reordered behind the first 1-RTT one still decrypt for 3 PTO (RFC 9001, 4.9.3)
+    if (!sess->is_client && up->enc_lv == GQUIC_ENC_LV_1RTT && sess->drop_0rtt_keys_time == 0) {
+        sess->drop_0rtt_keys_time = recv_time + 3 * gquic_time_pto(&sess->rtt, 1);
+    }
     sess->received_first_packet = 1;
     sess->last_packet_received_time = recv_time;
     sess->first_ack_eliciting_packet = 0;
@@ -1249,7 +1400,7 @@ static int gquic_session_handle_unpacked_packet(gquic_session_t *const sess, gqu
             return -5;
         }
     }
-    if (gquic_packet_received_packet_handlers_received_packet(&sess->recv_packet_handler, up->pn, recv_time, is_ack_eliciting, up->enc_lv) != 0) {
+    if (gquic_packet_received_packet_handlers_received_packet(&sess->recv_packet_handler, up->pn, recv_time, is_ack_eliciting, up->enc_lv, ecn) != 0) {
         return -6;
     }
     return 0;
@@ -1260,7 +1411,7 @@ static int gquic_session_handle_frame(gquic_session_t *const sess, void *const f
     if (sess == NULL || frame == NULL) {
         return -1;
     }
-    if ((GQUIC_FRAME_META(frame).type & 0x08) != 0) {
+    if ((GQUIC_FRAME_META(frame).type & 0xf8) == 0x08) {
         ret = gquic_session_handle_stream_frame(sess, frame);
     }
     else switch (GQUIC_FRAME_META(frame).type) {
@@ -1308,6 +1459,12 @@ static int gquic_session_handle_frame(gquic_session_t *const sess, void *const f
     case 0x19:
         ret = gquic_session_handle_retire_conn_id_frame(sess, frame);
         break;
+    case 0xaf:
+        ret = gquic_packet_received_packet_handlers_set_ack_frequency(&sess->recv_packet_handler, frame);
+        break;
+    case 0x1f:
+        ret = gquic_packet_received_packet_handlers_immediate_ack(&sess->recv_packet_handler);
+        break;
     default:
         return -2;
     }
@@ -1386,6 +1543,56 @@ static int gquic_session_handle_ack_frame(gquic_session_t *const sess, gquic_fra
     if (enc_lv == GQUIC_ENC_LV_1RTT) {
         gquic_packet_received_packet_handlers_ignore_below(&sess->recv_packet_handler, sess->sent_packet_handler.lowest_not_confirm_acked);
         sess->est.aead.last_ack_pn = frame->largest_ack;
+        gquic_session_try_update_ack_frequency(sess);
+    }
+    return 0;
+}
+
+/*
+ * asks a peer that takes ACK_FREQUENCY for about four ACKs per window, no
+ * later than a quarter of the rtt, and for an immediate ACK before a gap would
+ * be declared lost. a new frame goes out only when the request changes.
+ */
+static int gquic_session_try_update_ack_frequency(gquic_session_t *const sess) {
+    gquic_frame_ack_frequency_t *frame = NULL;
+    u_int64_t threshold = 0;
+    u_int64_t max_ack_delay = 0;
+    u_int64_t reordering_threshold = 0;
+    if (sess == NULL) {
+        return -1;
+    }
+    if (!sess->peer_params_seted || sess->peer_params.min_ack_delay == 0 || !gquic_packet_packer_handshake_confirmed(&sess->packer)) {
+        return 0;
+    }
+    threshold = GQUIC_CONG_CWND(&sess->sent_packet_handler.cong) / (4 * sess->packer.max_packet_size);
+    threshold = threshold > 1 ? threshold - 1 : 1;
+    threshold = threshold < GQUIC_SESSION_MAX_ACK_ELICITING_THRESHOLD ? threshold : GQUIC_SESSION_MAX_ACK_ELICITING_THRESHOLD;
+    max_ack_delay = sess->rtt.smooth / 4 < sess->peer_params.max_ack_delay ? sess->rtt.smooth / 4 : sess->peer_params.max_ack_delay;
+    max_ack_delay = max_ack_delay > sess->peer_params.min_ack_delay ? max_ack_delay : sess->peer_params.min_ack_delay;
+    reordering_threshold = sess->sent_packet_handler.reordering_threshold;
+
+    // small rtt wobbles are not worth a frame
+    if (sess->ack_frequency.seq != 0
+        && threshold == sess->ack_frequency.ack_eliciting_threshold
+        && reordering_threshold == sess->ack_frequency.reordering_threshold
+        && 4 * max_ack_delay >= 3 * sess->ack_frequency.max_ack_delay
+        && 4 * max_ack_delay <= 5 * sess->ack_frequency.max_ack_delay) {
+        return 0;
+    }
+    if ((frame = gquic_frame_ack_frequency_alloc()) == NULL) {
+        return -2;
+    }
+    GQUIC_FRAME_INIT(frame);
+    frame->seq = sess->ack_frequency.seq++;
+    frame->ack_eliciting_threshold = threshold;
+    frame->max_ack_delay = max_ack_delay;
+    frame->reordering_threshold = reordering_threshold;
+    sess->ack_frequency.ack_eliciting_threshold = threshold;
+    sess->ack_frequency.max_ack_delay = max_ack_delay;
+    sess->ack_frequency.reordering_threshold = reordering_threshold;
+    if (gquic_framer_queue_ctrl_frame(&sess->framer, frame) != 0) {
+        gquic_frame_release(frame);
+        return -3;
     }
     return 0;
 }
@@ -1466,12 +1673,68 @@ static int gquic_session_handle_new_token_frame(gquic_session_t *const sess, gqu
     if (!sess->is_client) {
         return -2;
     }
+    if (sess->cfg->token_store == NULL || GQUIC_STR_SIZE(&sess->token_store_key) == 0 || frame->len == 0) {
+        return 0;
+    }
+    gquic_str_t token = { frame->len, frame->token };
+    GQUIC_TOKEN_STORE_PUT(sess->cfg->token_store, &sess->token_store_key, &token);
 
-    // TODO token store
+    return 0;
+}
 
+static int gquic_session_queue_new_token_frame(gquic_session_t *const sess) {
+    struct timeval tv;
+    struct timezone tz;
+    gquic_str_t token = { 0, NULL };
+    gquic_frame_new_token_t *frame = NULL;
+    if (sess == NULL) {
+        return -1;
+    }
+    gettimeofday(&tv, &tz);
+    if (gquic_handshake_token_generator_new_token(&token, sess->cfg->token_generator,
+                                                  &sess->conn->addr, tv.tv_sec * 1000 * 1000 + tv.tv_usec) != 0) {
+        return -2;
+    }
+    if ((frame = gquic_frame_new_token_alloc()) == NULL) {
+        gquic_str_reset(&token);
+        return -3;
+    }
+    GQUIC_FRAME_INIT(frame);
+    frame->len = GQUIC_STR_SIZE(&token);
+    frame->token = GQUIC_STR_VAL(&token);
+    gquic_session_queue_control_frame(sess, frame);
     return 0;
 }
 
+static int gquic_session_validate_peer_addr(gquic_session_t *const sess, gquic_unpacked_packet_t *const up, const u_int64_t recv_time) {
+    gquic_packet_initial_header_t *initial_hdr = NULL;
+    gquic_handshake_token_t info;
+    int ret = 0;
+    if (sess == NULL || up == NULL) {
+        return -1;
+    }
+    // a Handshake packet could only be built from keys in our Initial, so the client got it at that address
+    if (up->enc_lv == GQUIC_ENC_LV_HANDSHAKE) {
+        gquic_packet_sent_packet_handler_set_peer_addr_validated(&sess->sent_packet_handler);
+        return 0;
+    }
+    if (sess->received_first_packet || up->enc_lv != GQUIC_ENC_LV_INITIAL || sess->cfg->token_generator == NULL) {
+        return 0;
+    }
+    initial_hdr = GQUIC_LONG_HEADER_SPEC(up->hdr.hdr.l_hdr);
+    if (initial_hdr->token_len == 0) {
+        return 0;
+    }
+    gquic_str_t token = { initial_hdr->token_len, initial_hdr->token };
+    gquic_handshake_token_init(&info);
+    if ((ret = gquic_handshake_token_generator_validate(&info, sess->cfg->token_generator, &token, &sess->conn->addr, recv_time))
+        == GQUIC_HANDSHAKE_TOKEN_VALID) {
+        gquic_packet_sent_packet_handler_set_peer_addr_validated(&sess->sent_packet_handler);
+    }
+    gquic_handshake_token_dtor(&info);
+    return ret;
+}
+
 static int gquic_session_handle_new_conn_id_frame(gquic_session_t *const sess, gquic_frame_new_connection_id_t *const frame) {
     if (sess == NULL || frame == NULL) {
         return -1;
@@ -1569,16 +1832,32 @@ static int gquic_session_send_packets(gquic_session_t *const sess) {
     u_int8_t send_mode = 0x00;
     u_int64_t packets_count = 0;
     u_int64_t packets_sent_count = 0;
+    u_int64_t batch_count = 0;
+    u_int64_t allowable_count = 0;
+    u_int64_t batch_sent_count = 0;
     int sended = 0;
+    struct timeval tv;
+    struct timezone tz;
+    u_int64_t now = 0;
     if (sess == NULL) {
         return -1;
     }
     sess->pacing_deadline = 0;
+    // the kernel refused a txtime, pace in user space from now on
+    if (sess->sent_packet_handler.txtime && !sess->conn->txtime) {
+        gquic_packet_sent_packet_handler_set_txtime(&sess->sent_packet_handler, 0);
+    }
     send_mode = gquic_packet_sent_packet_handler_send_mode(&sess->sent_packet_handler);
     if (send_mode == GQUIC_SEND_MODE_NONE) {
         return 0;
     }
-    packets_count = gquic_packet_sent_packet_handler_should_send_packets_count(&sess->sent_packet_handler);
+    gettimeofday(&tv, &tz);
+    now = tv.tv_sec * 1000 * 1000 + tv.tv_usec;
+    // woken early, the pacer has not refilled a release quantum yet
+    if ((packets_count = gquic_packet_sent_packet_handler_should_send_packets_count(&sess->sent_packet_handler, now)) == 0) {
+        sess->pacing_deadline = gquic_packet_sent_packet_handler_next_send_time(&sess->sent_packet_handler, now);
+        return gquic_session_try_send_only_ack_packet(sess);
+    }
     for ( ;; ) {
         sended = 0;
         switch (send_mode) {
@@ -1608,10 +1887,32 @@ static int gquic_session_send_packets(gquic_session_t *const sess) {
             packets_sent_count++;
             break;
         case GQUIC_SEND_MODE_ANY:
+            if (gquic_packet_packer_handshake_confirmed(&sess->packer)) {
+                batch_count = packets_count - packets_sent_count;
+                allowable_count = gquic_packet_sent_packet_handler_allowable_packets_count(&sess->sent_packet_handler,
+                                                                                          sess->packer.max_packet_size);
+                if (batch_count > allowable_count) {
+                    batch_count = allowable_count;
+                }
+                if ((ret = gquic_session_send_app_packets(&batch_sent_count, sess, batch_count)) != 0) {
+                    return -7 + 10 * ret;
+                }
+                // the window was open but there was nothing more to send
+                if (batch_sent_count < (batch_count < GQUIC_TLS_AEAD_MAX_BATCH ? batch_count : GQUIC_TLS_AEAD_MAX_BATCH)) {
+                    gquic_packet_sent_packet_handler_set_app_limited(&sess->sent_packet_handler);
+                }
+                if (batch_sent_count == 0) {
+                    goto loop_end;
+                }
+                packets_sent_count += batch_sent_count;
+                break;
+            }
             if ((ret = gquic_session_send_packet(&sended, sess)) != 0) {
                 return -5 + 10 * ret;
             }
             if (!sended) {
+                // the window was open but there was nothing more to send
+                gquic_packet_sent_packet_handler_set_app_limited(&sess->sent_packet_handler);
                 goto loop_end;
             }
             packets_sent_count++;
@@ -1625,8 +1926,8 @@ static int gquic_session_send_packets(gquic_session_t *const sess) {
         send_mode = gquic_packet_sent_packet_handler_send_mode(&sess->sent_packet_handler);
     }
 loop_end:
-    if (packets_sent_count == packets_count) {
-        sess->pacing_deadline = sess->sent_packet_handler.next_send_time;
+    if (packets_sent_count >= packets_count) {
+        sess->pacing_deadline = gquic_packet_sent_packet_handler_next_send_time(&sess->sent_packet_handler, now);
     }
     return 0;
 }
@@ -1731,12 +2032,88 @@ static int gquic_session_send_packet(int *const sent_packet, gquic_session_t *co
 
     gquic_packed_packet_get_ack_packet(packet, packed_packet, &sess->retransmission);
     gquic_packet_sent_packet_handler_sent_packet(&sess->sent_packet_handler, packet);
+    packed_packet->txtime = sess->sent_packet_handler.txtime ? packet->send_time : 0;
+    packed_packet->ecn = packet->ecn;
     gquic_session_send_packed_packet(sess, packed_packet);
 
     *sent_packet = 1;
     return 0;
 }
 
+/*
+ * once the handshake is confirmed only 1-RTT packets are sent, so a burst is
+ * packed in one go and sealed as a batch.
+ */
+static int gquic_session_send_app_packets(u_int64_t *const sent_count, gquic_session_t *const sess, const u_int64_t max_count) {
+    int ret = 0;
+    size_t i;
+    size_t count = 0;
+    u_int64_t swnd = 0;
+    gquic_frame_data_blocked_t *blocked = NULL;
+    gquic_packed_packet_t packed_packets[GQUIC_TLS_AEAD_MAX_BATCH];
+    gquic_packed_packet_t *packed_packet = NULL;
+    gquic_packet_t *packet = NULL;
+    if (sent_count == NULL || sess == NULL) {
+        return -1;
+    }
+    *sent_count = 0;
+    if (max_count == 0) {
+        return 0;
+    }
+    if (gquic_flowcontrol_base_is_newly_blocked(&swnd, &sess->conn_flow_ctrl.base)) {
+        if ((blocked = gquic_frame_data_blocked_alloc()) == NULL) {
+            return -2;
+        }
+        blocked->limit = swnd;
+        gquic_framer_queue_ctrl_frame(&sess->framer, blocked);
+    }
+
+    gquic_wnd_update_queue_queue_all(&sess->wnd_update_queue);
+
+    struct timeval tv;
+    struct timezone tz;
+    gettimeofday(&tv, &tz);
+    if (gquic_auto_update_aead_try_update(&sess->est.aead, tv.tv_sec * 1000 * 1000 + tv.tv_usec) != 0) {
+        return -6;
+    }
+
+    if ((ret = gquic_packet_packer_pack_app_packets(packed_packets, &count, &sess->packer,
+                                                    max_count < GQUIC_TLS_AEAD_MAX_BATCH ? max_count : GQUIC_TLS_AEAD_MAX_BATCH)) != 0) {
+        for (i = 0; i < count; i++) {
+            gquic_packed_packet_dtor(&packed_packets[i]);
+        }
+        return -3 + 10 * ret;
+    }
+
+    for (i = 0; i < count; i++) {
+        if ((packet = malloc(sizeof(gquic_packet_t))) == NULL) {
+            ret = -4;
+            goto failure;
+        }
+        if ((packed_packet = malloc(sizeof(gquic_packed_packet_t))) == NULL) {
+            free(packet);
+            ret = -5;
+            goto failure;
+        }
+        gquic_packet_init(packet);
+        *packed_packet = packed_packets[i];
+
+        gquic_packed_packet_get_ack_packet(packet, packed_packet, &sess->retransmission);
+        gquic_packet_sent_packet_handler_sent_packet(&sess->sent_packet_handler, packet);
+        packed_packet->txtime = sess->sent_packet_handler.txtime ? packet->send_time : 0;
+        packed_packet->ecn = packet->ecn;
+        gquic_session_send_packed_packet(sess, packed_packet);
+        (*sent_count)++;
+    }
+
+    return 0;
+failure:
+    for (; i < count; i++) {
+        gquic_packed_packet_dtor(&packed_packets[i]);
+    }
+    return ret;
+}
+
 static int gquic_session_send_probe_packet(gquic_session_t *const sess, const u_int8_t enc_lv) {
     int ret = 0;
     gquic_packed_packet_t *packed_packet = NULL;
@@ -1807,6 +2184,8 @@ static int gquic_session_send_probe_packet(gquic_session_t *const sess, const u_
     }
     gquic_packed_packet_get_ack_packet(packet, packed_packet, &sess->retransmission);
     gquic_packet_sent_packet_handler_sent_packet(&sess->sent_packet_handler, packet);
+    packed_packet->txtime = sess->sent_packet_handler.txtime ? packet->send_time : 0;
+    packed_packet->ecn = packet->ecn;
     gquic_session_send_packed_packet(sess, packed_packet);
     return 0;
 }
@@ -2,7 +2,6 @@
 #include "tls/common.h"
 #include <malloc.h>
 
-static int gquic_crypto_stream_calc_readed_bytes(u_int64_t *const, gquic_crypto_stream_t *const);
 static int gquic_crypto_stream_calc_writed_bytes(u_int64_t *const, gquic_crypto_stream_t *const);
 
 int gquic_crypto_stream_init(gquic_crypto_stream_t *const str) {
@@ -10,8 +9,6 @@ int gquic_crypto_stream_init(gquic_crypto_stream_t *const str) {
         return -1;
     }
     gquic_frame_sorter_init(&str->sorter);
-    gquic_str_init(&str->in_reader);
-    gquic_str_init(&str->in_buf);
     str->highest_off = 0;
     str->out_off = 0;
     str->finished = 0;
@@ -25,7 +22,7 @@ int gquic_crypto_stream_ctor(gquic_crypto_stream_t *const str) {
     if (str == NULL) {
         return -1;
     }
-    gquic_frame_sorter_ctor(&str->sorter);
+    gquic_frame_sorter_ctor(&str->sorter, GQUIC_CRYPTO_STREAM_MAX_OFF);
 
     return 0;
 }
@@ -36,7 +33,7 @@ int gquic_crypto_stream_handle_crypto_frame(gquic_crypto_stream_t *const str, gq
         return -1;
     }
     highest_off = frame->off + frame->len;
-    if (highest_off > 16 * (1 << 10)) {
+    if (highest_off > GQUIC_CRYPTO_STREAM_MAX_OFF) {
         return -2;
     }
     if (str->finished) {
@@ -49,61 +46,10 @@ int gquic_crypto_stream_handle_crypto_frame(gquic_crypto_stream_t *const str, gq
         str->highest_off = highest_off;
     }
     gquic_str_t data = { frame->len, frame->data };
-    if (gquic_frame_sorter_push(&str->sorter, &data, frame->off, NULL, NULL) != 0) {
+    if (gquic_frame_sorter_push(&str->sorter, &data, frame->off) != 0) {
         return -4;
     }
-    for ( ;; ) {
-        u_int64_t off_useless;
-        u_int64_t readed_size = 0;
-        int (*fptr_useless)(void *const);
-        void *fptr_self_useless;
-        gquic_str_t data = { 0, NULL };
-        gquic_str_t concated = { 0, NULL };
-
-        if (gquic_crypto_stream_calc_readed_bytes(&readed_size, str) != 0) {
-            return -5;
-        }
 
-        if (gquic_frame_sorter_pop(&off_useless, &data, &fptr_useless, &fptr_self_useless, &str->sorter) != 0) {
-            return -6;
-        }
-        if (GQUIC_STR_SIZE(&data) == 0) {
-            return 0;
-        }
-        if (gquic_str_concat(&concated, &str->in_buf, &data) != 0) {
-            return -7;
-        }
-        gquic_str_reset(&data);
-        gquic_str_reset(&str->in_buf);
-
-        str->in_buf = concated;
-        str->in_reader = str->in_buf;
-        if (gquic_reader_str_readed_size(&str->in_reader, readed_size) != 0) {
-            return -8;
-        }
-    }
-    
-    return 0;
-}
-
-static int gquic_crypto_stream_calc_readed_bytes(u_int64_t *const ret, gquic_crypto_stream_t *const str) {
-    gquic_str_t tmp = { 0, NULL };
-    if (ret == NULL || str == NULL) {
-        return -1;
-    }
-    *ret = GQUIC_STR_VAL(&str->in_reader) - GQUIC_STR_VAL(&str->in_buf);
-    if (*ret > 2048) {
-        *ret = 0;
-        if (gquic_str_alloc(&tmp, GQUIC_STR_SIZE(&str->in_reader)) != 0) {
-            return -2;
-        }
-        if (gquic_reader_str_read(&tmp, &str->in_reader) != 0) {
-            return -3;
-        }
-        gquic_str_reset(&str->in_buf);
-        str->in_buf = tmp;
-        str->in_reader = str->in_buf;
-    }
     return 0;
 }
 
@@ -130,24 +76,27 @@ static int gquic_crypto_stream_calc_writed_bytes(u_int64_t *const ret, gquic_cry
 
 int gquic_crypto_stream_get_data(gquic_str_t *const data, gquic_crypto_stream_t *const str) {
     u_int64_t slice_len = 0;
+    u_int8_t msg_header[4] = { 0 };
+    gquic_str_t header = { sizeof(msg_header), msg_header };
+    gquic_writer_str_t writer = { 0, NULL };
     if (data == NULL || str == NULL) {
         return -1;
     }
-    if (GQUIC_STR_SIZE(&str->in_reader) < 4) {
+    if (gquic_frame_sorter_copy(&header, &str->sorter) != 0) {
         return 0;
     }
     slice_len = 4
-        + (((u_int64_t) ((u_int8_t *) GQUIC_STR_VAL(&str->in_reader))[1]) << 16)
-        + (((u_int64_t) ((u_int8_t *) GQUIC_STR_VAL(&str->in_reader))[2]) << 8)
-        + (((u_int64_t) ((u_int8_t *) GQUIC_STR_VAL(&str->in_reader))[3]));
-    if (GQUIC_STR_SIZE(&str->in_reader) < slice_len) {
+        + (((u_int64_t) msg_header[1]) << 16)
+        + (((u_int64_t) msg_header[2]) << 8)
+        + (((u_int64_t) msg_header[3]));
+    if (gquic_frame_sorter_readable(&str->sorter) < slice_len) {
         return 0;
     }
     if (gquic_str_alloc(data, slice_len) != 0) {
         return -2;
     }
-    gquic_reader_str_read(data, &str->in_reader);
-    if (gquic_crypto_stream_calc_readed_bytes(&slice_len, str) != 0) {
+    writer = *data;
+    if (gquic_frame_sorter_read(&writer, &str->sorter) != 0) {
         return -3;
     }
 
@@ -158,7 +107,7 @@ int gquic_crypto_stream_finish(gquic_crypto_stream_t *const str) {
     if (str == NULL) {
         return -1;
     }
-    if (!gquic_rbtree_is_nil(str->sorter.root)) {
+    if (!gquic_frame_sorter_empty(&str->sorter)) {
         return -2;
     }
     str->finished = 1;
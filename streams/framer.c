@@ -169,3 +169,20 @@ int gquic_framer_append_stream_frames(gquic_list_t *const frames, u_int64_t *con
     }
     return 0;
 }
+
+int gquic_framer_has_data(gquic_framer_t *const framer) {
+    int ret = 0;
+    if (framer == NULL) {
+        return 0;
+    }
+    sem_wait(&framer->ctrl_frame_mtx);
+    ret = !gquic_list_head_empty(&framer->ctrl_frames);
+    sem_post(&framer->ctrl_frame_mtx);
+    if (ret) {
+        return 1;
+    }
+    sem_wait(&framer->mtx);
+    ret = framer->stream_queue_count != 0;
+    sem_post(&framer->mtx);
+    return ret;
+}
@@ -1,15 +1,12 @@
 #include "streams/recv_stream.h"
 #include "frame/stop_sending.h"
 #include "frame/meta.h"
-#include "frame/stream_pool.h"
 #include <string.h>
 
-static inline int gquic_recv_stream_dequeue_next_frame(gquic_recv_stream_t *const);
 static int gquic_recv_stream_read_inner(int *const, int *const, gquic_recv_stream_t *const, gquic_str_t *const);
 static int gquic_recv_stream_read_cancel_inner(gquic_recv_stream_t *const, const int);
 static int gquic_recv_stream_handle_stream_frame_inner(int *const, gquic_recv_stream_t *const, gquic_frame_stream_t *const);
 static int gquic_recv_stream_handle_reset_stream_frame_inner(int *const, gquic_recv_stream_t *const, const gquic_frame_reset_stream_t *const);
-static int gquic_recv_stream_sorter_push_done_cb(void *const);
 
 int gquic_recv_stream_init(gquic_recv_stream_t *const str) {
     if (str == NULL) {
@@ -21,11 +18,6 @@ int gquic_recv_stream_init(gquic_recv_stream_t *const str) {
     gquic_frame_sorter_init(&str->frame_queue);
     str->read_off = 0;
     str->final_off = 0;
-    gquic_str_init(&str->cur_frame);
-    str->cur_frame_done_cb.self = NULL;
-    str->cur_frame_done_cb.cb = NULL;
-    str->cur_frame_is_last = 0;
-    str->frame_read_pos = 0;
     str->close_for_shutdown_reason = 0;
     str->cancel_read_reason = 0;
     str->reset_remote_reason = 0;
@@ -50,7 +42,7 @@ int gquic_recv_stream_ctor(gquic_recv_stream_t *const str,
     str->stream_id = stream_id;
     str->sender = sender;
     str->flow_ctrl = flow_ctrl;
-    gquic_frame_sorter_ctor(&str->frame_queue);
+    gquic_frame_sorter_ctor(&str->frame_queue, flow_ctrl->base.max_rwnd_size);
     str->final_off = (1UL << 62) - 1;
     return 0;
 }
@@ -61,7 +53,6 @@ int gquic_recv_stream_dtor(gquic_recv_stream_t *const str) {
     }
     sem_destroy(&str->mtx);
     gquic_frame_sorter_dtor(&str->frame_queue);
-    gquic_str_reset(&str->cur_frame);
     sem_destroy(&str->read_sem);
     return 0;
 }
@@ -114,26 +105,11 @@ int gquic_recv_stream_handle_stream_frame(gquic_recv_stream_t *const str, gquic_
     return ret;
 }
 
-static inline int gquic_recv_stream_dequeue_next_frame(gquic_recv_stream_t *const str) {
-    u_int64_t off = 0;
-    if (str == NULL) {
-        return -1;
-    }
-    if (str->cur_frame_done_cb.self != NULL) {
-        str->cur_frame_done_cb.cb(str->cur_frame_done_cb.self);
-    }
-    gquic_str_reset(&str->cur_frame);
-    gquic_str_init(&str->cur_frame);
-    gquic_frame_sorter_pop(&off, &str->cur_frame, &str->cur_frame_done_cb.cb, &str->cur_frame_done_cb.self, &str->frame_queue);
-    str->cur_frame_is_last = off + GQUIC_STR_SIZE(&str->cur_frame) >= str->final_off;
-    str->frame_read_pos = 0;
-    return 0;
-}
-
 static int gquic_recv_stream_read_inner(int *const completed, int *const read, gquic_recv_stream_t *const str, gquic_str_t *const data) {
     u_int64_t read_bytes = 0;
     u_int64_t deadline = 0;
     size_t readed_size = 0;
+    gquic_writer_str_t writer = { 0, NULL };
     if (completed == NULL || read == NULL || str == NULL || data == NULL) {
         return -1;
     }
@@ -158,10 +134,7 @@ static int gquic_recv_stream_read_inner(int *const completed, int *const read, g
         return str->close_for_shutdown_reason;
     }
     while (read_bytes < GQUIC_STR_SIZE(data)) {
-        if (GQUIC_STR_SIZE(&str->cur_frame) == 0 || (u_int64_t) str->frame_read_pos >= GQUIC_STR_SIZE(&str->cur_frame)) {
-            gquic_recv_stream_dequeue_next_frame(str);
-        }
-        if (GQUIC_STR_SIZE(&str->cur_frame) == 0 && read_bytes > 0) {
+        if (gquic_frame_sorter_readable(&str->frame_queue) == 0 && read_bytes > 0) {
             *completed = 0;
             *read = read_bytes;
             return str->close_for_shutdown_reason;
@@ -194,7 +167,7 @@ static int gquic_recv_stream_read_inner(int *const completed, int *const read, g
                     return -3;
                 }
             }
-            if (GQUIC_STR_SIZE(&str->cur_frame) != 0 || str->cur_frame_is_last) {
+            if (gquic_frame_sorter_readable(&str->frame_queue) != 0 || str->read_off >= str->final_off) {
                 break;
             }
             sem_post(&str->mtx);
@@ -206,39 +179,28 @@ static int gquic_recv_stream_read_inner(int *const completed, int *const read, g
                 sem_timedwait(&str->read_sem, &timeout);
             }
             sem_wait(&str->mtx);
-            if (GQUIC_STR_SIZE(&str->cur_frame) == 0) {
-                gquic_recv_stream_dequeue_next_frame(str);
-            }
         }
         if (read_bytes > GQUIC_STR_SIZE(data)) {
             *completed = 0;
             *read = read_bytes;
             return -4;
         }
-        if ((size_t) str->frame_read_pos > GQUIC_STR_SIZE(&str->cur_frame)) {
+
+        writer.size = GQUIC_STR_SIZE(data) - read_bytes;
+        writer.val = GQUIC_STR_VAL(data) + read_bytes;
+        if (gquic_frame_sorter_read(&writer, &str->frame_queue) != 0) {
             *completed = 0;
             *read = read_bytes;
             return -5;
         }
-
-        sem_post(&str->mtx);
-
-        readed_size = GQUIC_STR_SIZE(data) - read_bytes < GQUIC_STR_SIZE(&str->cur_frame) - str->frame_read_pos
-            ? GQUIC_STR_SIZE(data) - read_bytes
-            : GQUIC_STR_SIZE(&str->cur_frame) - str->frame_read_pos;
-        memcpy(GQUIC_STR_VAL(data) + read_bytes,
-               GQUIC_STR_VAL(&str->cur_frame) + str->frame_read_pos,
-               readed_size);
-        str->frame_read_pos += readed_size;
+        readed_size = GQUIC_STR_VAL(&writer) - GQUIC_STR_VAL(data) - read_bytes;
         read_bytes += readed_size;
         str->read_off += readed_size;
 
-        sem_wait(&str->mtx);
-
         if (!str->reset_remote) {
             gquic_flowcontrol_stream_flow_ctrl_read_add_bytes(str->flow_ctrl, readed_size);
         }
-        if ((u_int64_t) str->frame_read_pos >= GQUIC_STR_SIZE(&str->cur_frame) && str->cur_frame_is_last) {
+        if (str->read_off >= str->final_off) {
             str->fin_read = 1;
             *completed = 1;
             *read = read_bytes;
@@ -295,11 +257,7 @@ static int gquic_recv_stream_handle_stream_frame_inner(int *const completed, gqu
         *completed = newly_recv_final_off;
         return 0;
     }
-    if (gquic_frame_sorter_push(&str->frame_queue,
-                            &frame->data,
-                            frame->off,
-                            gquic_recv_stream_sorter_push_done_cb,
-                            frame) != 0) {
+    if (gquic_frame_sorter_push(&str->frame_queue, &frame->data, frame->off) != 0) {
         *completed = 0;
         return -3;
     }
@@ -308,14 +266,6 @@ static int gquic_recv_stream_handle_stream_frame_inner(int *const completed, gqu
     return 0;
 }
 
-static int gquic_recv_stream_sorter_push_done_cb(void *const frame) {
-    if (frame == NULL) {
-        return -1;
-    }
-    gquic_stream_frame_pool_put(frame);
-    return 0;
-}
-
 int gquic_recv_stream_handle_reset_stream_frame(gquic_recv_stream_t *const str, const gquic_frame_reset_stream_t *const reset_stream) {
     int completed = 0;
     int ret = 0;
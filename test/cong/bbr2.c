@@ -0,0 +1,140 @@
+#include "cong/cong.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 100 Mbit/s bottleneck, 100 ms rtt, a one BDP buffer and 1% random loss
+#define MSS 1460
+#define LINK_RATE (100 * 1000 * 1000 / 8)
+#define PROP_RTT (100 * 1000)
+#define BUFFER ((u_int64_t) LINK_RATE * PROP_RTT / (1000 * 1000))
+#define LOSS_PERCENT 1
+#define DURATION (20 * 1000 * 1000)
+#define MAX_PACKETS (1 << 18)
+
+#define OUTSTANDING 1
+#define ACKED 2
+#define LOST 3
+
+static gquic_packet_t packets[MAX_PACKETS];
+static u_int8_t state[MAX_PACKETS];
+static u_int64_t ack_pn[MAX_PACKETS];
+static u_int64_t ack_time[MAX_PACKETS];
+
+static u_int64_t emulate(const int algo) {
+    gquic_cong_t cong;
+    gquic_rtt_t rtt;
+    gquic_packet_rate_sampler_t sampler;
+    gquic_packet_rate_sample_t sample;
+    u_int64_t now = 0;
+    u_int64_t next_send = 0;
+    u_int64_t link_free = 0;
+    u_int64_t next_pn = 0;
+    u_int64_t oldest = 0;
+    u_int64_t infly = 0;
+    u_int64_t delivered = 0;
+    u_int64_t armed = 0;
+    u_int64_t ack_head = 0;
+    u_int64_t ack_tail = 0;
+    u_int64_t t_ack = 0;
+    u_int64_t t_send = 0;
+    u_int64_t t_pto = 0;
+    u_int64_t pn = 0;
+    u_int64_t pto = 0;
+
+    srand(1);
+    memset(state, 0, sizeof(state));
+    gquic_rtt_init(&rtt);
+    gquic_packet_rate_sampler_init(&sampler);
+    gquic_cong_init(&cong);
+    gquic_cong_ctor(&cong, algo, &rtt, 32 * MSS, 1000 * MSS);
+
+    while (now < DURATION && next_pn < MAX_PACKETS) {
+        t_send = GQUIC_CONG_CAN_SEND(&cong, infly) ? (next_send > now ? next_send : now) : (u_int64_t) -1;
+        pto = rtt.smooth == 0 ? 3 * PROP_RTT : 2 * rtt.smooth + 4 * rtt.mean_dev;
+        t_pto = infly != 0 ? armed + pto : (u_int64_t) -1;
+        t_ack = ack_head != ack_tail ? ack_time[ack_head] : (u_int64_t) -1;
+
+        if (t_ack != (u_int64_t) -1 && t_ack <= t_send && t_ack <= t_pto) {
+            now = t_ack;
+            pn = ack_pn[ack_head++];
+            armed = now;
+            if (state[pn] != OUTSTANDING) {
+                continue;
+            }
+            state[pn] = ACKED;
+            infly -= MSS;
+            delivered += MSS;
+            gquic_rtt_update(&rtt, now - packets[pn].send_time, 0);
+            GQUIC_CONG_ON_RTT_UPDATED(&cong);
+            gquic_packet_rate_sampler_on_packet_acked(&sampler, &packets[pn], now);
+            gquic_packet_rate_sampler_generate(&sample, &sampler, rtt.min);
+            GQUIC_CONG_ON_RATE_SAMPLE(&cong, &sample);
+            GQUIC_CONG_ON_PACKET_ACKED(&cong, pn, MSS, infly, packets[pn].send_time, now);
+            // packet threshold loss detection
+            for (; oldest + 3 <= pn; oldest++) {
+                if (state[oldest] == OUTSTANDING) {
+                    state[oldest] = LOST;
+                    GQUIC_CONG_ON_PACKET_LOST(&cong, oldest, MSS, infly);
+                    infly -= MSS;
+                }
+            }
+        }
+        else if (t_send != (u_int64_t) -1 && t_send <= t_pto) {
+            now = t_send;
+            pn = next_pn++;
+            gquic_packet_init(&packets[pn]);
+            packets[pn].pn = pn;
+            packets[pn].len = MSS;
+            packets[pn].send_time = now;
+            gquic_packet_rate_sampler_on_packet_sent(&sampler, &packets[pn], infly);
+            state[pn] = OUTSTANDING;
+            infly += MSS;
+            armed = now;
+            GQUIC_CONG_ON_PACKET_SENT(&cong, pn, MSS, infly, 1);
+            next_send = now + GQUIC_CONG_TIME_UNTIL_SEND(&cong, infly);
+            if (rand() % 100 < LOSS_PERCENT) {
+                continue;
+            }
+            if (link_free > now && (link_free - now) * LINK_RATE / (1000 * 1000) > BUFFER) {
+                continue;
+            }
+            link_free = (link_free > now ? link_free : now) + MSS * 1000 * 1000 / LINK_RATE;
+            ack_pn[ack_tail] = pn;
+            ack_time[ack_tail++] = link_free + PROP_RTT;
+        }
+        else if (t_pto != (u_int64_t) -1) {
+            // the tail got lost, nothing is left to ack
+            now = t_pto;
+            for (; oldest < next_pn; oldest++) {
+                if (state[oldest] == OUTSTANDING) {
+                    state[oldest] = LOST;
+                    GQUIC_CONG_ON_PACKET_LOST(&cong, oldest, MSS, infly);
+                    infly -= MSS;
+                }
+            }
+            armed = now;
+        }
+        else {
+            break;
+        }
+    }
+    gquic_cong_dtor(&cong);
+    return delivered * 8 / (now / (1000 * 1000));
+}
+
+int main() {
+    u_int64_t cubic = emulate(GQUIC_CONG_CUBIC);
+    u_int64_t bbr = emulate(GQUIC_CONG_BBR2);
+    printf("cubic %lu bit/s, bbr2 %lu bit/s\n", cubic, bbr);
+    // random loss under the 2% threshold does not slow bbr2 down
+    if (bbr < LINK_RATE * 8 * 8 / 10) {
+        printf("bbr2 below 80%% of the link\n");
+        return -1;
+    }
+    if (bbr < 4 * cubic) {
+        printf("bbr2 not ahead of cubic\n");
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "cong/cubic.h"
+#include <stdio.h>
+#include <string.h>
+
+// 100 Mbit/s bottleneck, 40 ms rtt and a one BDP tail drop buffer
+#define MSS 1460
+#define LINK_RATE (100 * 1000 * 1000 / 8)
+#define PROP_RTT (40 * 1000)
+#define BDP ((u_int64_t) LINK_RATE * PROP_RTT / (1000 * 1000))
+#define BUFFER BDP
+#define DURATION (3 * 1000 * 1000)
+#define MAX_PACKETS (1 << 16)
+
+#define OUTSTANDING 1
+#define ACKED 2
+#define LOST 3
+
+typedef struct result_s result_t;
+struct result_s {
+    u_int64_t exit_time;
+    u_int64_t max_cwnd;
+    u_int64_t lost;
+    u_int64_t delivered;
+};
+
+static u_int64_t send_time[MAX_PACKETS];
+static u_int8_t state[MAX_PACKETS];
+static u_int64_t ack_pn[MAX_PACKETS];
+static u_int64_t ack_time[MAX_PACKETS];
+
+// without rtt samples slow start only ends on loss
+static int emulate(result_t *const result, const int rtt_samples) {
+    gquic_cong_cubic_t cubic;
+    gquic_rtt_t rtt;
+    u_int64_t now = 0;
+    u_int64_t next_send = 0;
+    u_int64_t link_free = 0;
+    u_int64_t next_pn = 0;
+    u_int64_t oldest = 0;
+    u_int64_t infly = 0;
+    u_int64_t armed = 0;
+    u_int64_t ack_head = 0;
+    u_int64_t ack_tail = 0;
+    u_int64_t t_ack = 0;
+    u_int64_t t_send = 0;
+    u_int64_t t_pto = 0;
+    u_int64_t pn = 0;
+    u_int64_t pto = 0;
+
+    memset(state, 0, sizeof(state));
+    memset(result, 0, sizeof(result_t));
+    gquic_rtt_init(&rtt);
+    gquic_cong_cubic_init(&cubic);
+    gquic_cong_cubic_ctor(&cubic, &rtt, 10 * MSS, 10000 * MSS);
+
+    while (now < DURATION && next_pn < MAX_PACKETS) {
+        t_send = gquic_cong_cubic_allowable_send(&cubic, infly) ? (next_send > now ? next_send : now) : (u_int64_t) -1;
+        pto = rtt.smooth == 0 ? 3 * PROP_RTT : 2 * rtt.smooth + 4 * rtt.mean_dev;
+        t_pto = infly != 0 ? armed + pto : (u_int64_t) -1;
+        t_ack = ack_head != ack_tail ? ack_time[ack_head] : (u_int64_t) -1;
+
+        if (t_ack != (u_int64_t) -1 && t_ack <= t_send && t_ack <= t_pto) {
+            now = t_ack;
+            pn = ack_pn[ack_head++];
+            armed = now;
+            if (state[pn] != OUTSTANDING) {
+                continue;
+            }
+            state[pn] = ACKED;
+            infly -= MSS;
+            result->delivered += MSS;
+            gquic_rtt_update(&rtt, now - send_time[pn], 0);
+            if (rtt_samples) {
+                gquic_cong_cubic_try_exit_slow_start(&cubic);
+            }
+            gquic_cong_cubic_on_packet_acked(&cubic, pn, MSS, infly, now);
+            for (; oldest + 3 <= pn; oldest++) {
+                if (state[oldest] == OUTSTANDING) {
+                    state[oldest] = LOST;
+                    result->lost++;
+                    gquic_cong_cubic_on_packet_lost(&cubic, oldest, MSS, infly);
+                    infly -= MSS;
+                }
+            }
+        }
+        else if (t_send != (u_int64_t) -1 && t_send <= t_pto) {
+            now = t_send;
+            pn = next_pn++;
+            send_time[pn] = now;
+            state[pn] = OUTSTANDING;
+            infly += MSS;
+            armed = now;
+            gquic_cong_cubic_on_packet_sent(&cubic, pn, MSS, 1);
+            next_send = now + gquic_cong_cubic_time_util_send(&cubic, infly);
+            // tail drop once the queue holds BUFFER bytes
+            if (link_free > now && (link_free - now) * LINK_RATE / (1000 * 1000) > BUFFER) {
+                continue;
+            }
+            link_free = (link_free > now ? link_free : now) + MSS * 1000 * 1000 / LINK_RATE;
+            ack_pn[ack_tail] = pn;
+            ack_time[ack_tail++] = link_free + PROP_RTT;
+        }
+        else if (t_pto != (u_int64_t) -1) {
+            now = t_pto;
+            for (; oldest < next_pn; oldest++) {
+                if (state[oldest] == OUTSTANDING) {
+                    state[oldest] = LOST;
+                    result->lost++;
+                    gquic_cong_cubic_on_packet_lost(&cubic, oldest, MSS, infly);
+                    infly -= MSS;
+                }
+            }
+            armed = now;
+        }
+        else {
+            break;
+        }
+        // the window stops doubling, either for conservative slow start or on loss
+        if (result->exit_time == 0 && cubic.hystart.state != GQUIC_CONG_HYSTART_SLOW_START) {
+            result->exit_time = now;
+        }
+        result->max_cwnd = cubic.cwnd > result->max_cwnd ? cubic.cwnd : result->max_cwnd;
+    }
+    return 0;
+}
+
+int main() {
+    result_t loss_only;
+    result_t hystart;
+    emulate(&loss_only, 0);
+    emulate(&hystart, 1);
+    printf("loss based: exit at %lu ms, window up to %lu packets, %lu lost, %lu Mbit/s\n",
+           loss_only.exit_time / 1000, loss_only.max_cwnd / MSS, loss_only.lost, loss_only.delivered * 8 / DURATION);
+    printf("hystart++:  exit at %lu ms, window up to %lu packets, %lu lost, %lu Mbit/s\n",
+           hystart.exit_time / 1000, hystart.max_cwnd / MSS, hystart.lost, hystart.delivered * 8 / DURATION);
+    // the queueing delay shows up before the buffer overflows
+    if (hystart.exit_time == 0 || hystart.exit_time >= loss_only.exit_time || hystart.max_cwnd >= loss_only.max_cwnd) {
+        printf("slow start did not end before the loss\n");
+        return -1;
+    }
+    if (hystart.lost * 2 > loss_only.lost) {
+        printf("overshoot loss not halved\n");
+        return -1;
+    }
+    if (hystart.delivered < loss_only.delivered * 95 / 100) {
+        printf("hystart++ gave up throughput\n");
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,26 @@
+#include "frame/frame_sorter.h"
+#include <stdio.h>
+
+int main() {
+    gquic_frame_sorter_t sorter;
+    char out[32] = { 0 };
+    gquic_str_t data = { 0, NULL };
+    gquic_writer_str_t writer = { sizeof(out) - 1, out };
+    gquic_frame_sorter_init(&sorter);
+    gquic_frame_sorter_ctor(&sorter, 1 << 10);
+
+    data.val = "world"; data.size = 5;
+    gquic_frame_sorter_push(&sorter, &data, 6);
+    printf("%lu ", gquic_frame_sorter_readable(&sorter));
+    data.val = "lo wo"; data.size = 5;
+    gquic_frame_sorter_push(&sorter, &data, 3);
+    data.val = "hel"; data.size = 3;
+    gquic_frame_sorter_push(&sorter, &data, 0);
+    printf("%lu ", gquic_frame_sorter_readable(&sorter));
+
+    gquic_frame_sorter_read(&writer, &sorter);
+    printf("%s %d\n", out, gquic_frame_sorter_empty(&sorter));
+
+    gquic_frame_sorter_dtor(&sorter);
+    return 0;
+}
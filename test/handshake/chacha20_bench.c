@@ -0,0 +1,152 @@
+#include "handshake/auto_update_aead.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define PACKET_SIZE 1200
+#define HEADER_SIZE 20
+#define ROUNDS 200000
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void from_hex(u_int8_t *const ret, const char *hex) {
+    size_t i;
+    for (i = 0; hex[2 * i] != '\0'; i++) {
+        sscanf(hex + 2 * i, "%2hhx", &ret[i]);
+    }
+}
+
+static int protect(u_int8_t *const packet, const size_t header_size, const int pn_len, const size_t payload_size,
+                   gquic_auto_update_aead_t *const aead, const u_int64_t pn) {
+    gquic_str_t text = { payload_size, packet + header_size };
+    gquic_str_t tag = { GQUIC_TLS_AEAD_TAG_SIZE, packet + header_size + payload_size };
+    gquic_str_t addata = { header_size, packet };
+    gquic_str_t header = { pn_len, packet + header_size - pn_len };
+    gquic_str_t sample = { 16, packet + header_size - pn_len + 4 };
+    if (gquic_auto_update_aead_seal(&tag, &text, aead, pn, &addata) != 0) {
+        return -1;
+    }
+    if (GQUIC_HEADER_PROTECTOR_SET_KEY(&aead->header_enc, &sample) != 0) {
+        return -2;
+    }
+    return GQUIC_HEADER_PROTECTOR_ENCRYPT(&header, packet, &aead->header_enc);
+}
+
+static int unprotect(u_int8_t *const packet, const size_t header_size, const int pn_len, const size_t payload_size,
+                     gquic_auto_update_aead_t *const aead, const u_int64_t pn) {
+    gquic_str_t text = { payload_size, packet + header_size };
+    gquic_str_t tag = { GQUIC_TLS_AEAD_TAG_SIZE, packet + header_size + payload_size };
+    gquic_str_t addata = { header_size, packet };
+    gquic_str_t header = { pn_len, packet + header_size - pn_len };
+    gquic_str_t sample = { 16, packet + header_size - pn_len + 4 };
+    if (GQUIC_HEADER_PROTECTOR_SET_KEY(&aead->header_dec, &sample) != 0) {
+        return -1;
+    }
+    if (GQUIC_HEADER_PROTECTOR_DECRYPT(&header, packet, &aead->header_dec) != 0) {
+        return -2;
+    }
+    return gquic_auto_update_aead_open(&text, aead, 0, pn, 0, &tag, &addata);
+}
+
+/* RFC 9001, A.5 */
+static int chacha20_vector() {
+    const gquic_tls_cipher_suite_t *suite = NULL;
+    gquic_auto_update_aead_t aead;
+    u_int8_t secret_cnt[32];
+    gquic_str_t secret = { sizeof(secret_cnt), secret_cnt };
+    u_int8_t packet[4 + 1 + GQUIC_TLS_AEAD_TAG_SIZE];
+    u_int8_t expect[sizeof(packet)];
+    int ret = 0;
+
+    from_hex(secret_cnt, "9ac312a7f877468ebe69422748ad00a15443f18203a07d6060f688f30f21632b");
+    from_hex(packet, "4200bff401");
+    from_hex(expect, "4cfe4189655e5cd55c41f69080575d7999c25a5bfb");
+
+    gquic_tls_get_cipher_suite(&suite, GQUIC_TLS_CIPHER_SUITE_CHACHA20_POLY1305_SHA256);
+    gquic_auto_update_aead_init(&aead);
+    if (gquic_auto_update_aead_set_wkey(&aead, suite, &secret) != 0 || gquic_auto_update_aead_set_rkey(&aead, suite, &secret) != 0) {
+        ret = -1;
+        goto finished;
+    }
+    if (protect(packet, 4, 3, 1, &aead, 654360564) != 0 || memcmp(packet, expect, sizeof(packet)) != 0) {
+        ret = -2;
+        goto finished;
+    }
+    if (unprotect(packet, 4, 3, 1, &aead, 654360564) != 0 || packet[0] != 0x42 || packet[4] != 0x01) {
+        ret = -3;
+        goto finished;
+    }
+
+finished:
+    gquic_auto_update_aead_dtor(&aead);
+    return ret;
+}
+
+static int bench(const char *const name, const u_int16_t suite_id) {
+    const gquic_tls_cipher_suite_t *suite = NULL;
+    gquic_auto_update_aead_t aead;
+    gquic_str_t secret = { 32, "0123456789abcdef0123456789abcdef" };
+    u_int8_t packet[PACKET_SIZE];
+    u_int8_t plain[PACKET_SIZE];
+    const size_t payload_size = PACKET_SIZE - HEADER_SIZE - GQUIC_TLS_AEAD_TAG_SIZE;
+    double start = 0;
+    double sealed = 0;
+    double opened = 0;
+    u_int64_t pn = 0;
+    int ret = 0;
+
+    gquic_tls_get_cipher_suite(&suite, suite_id);
+    gquic_auto_update_aead_init(&aead);
+    if (gquic_auto_update_aead_set_wkey(&aead, suite, &secret) != 0 || gquic_auto_update_aead_set_rkey(&aead, suite, &secret) != 0) {
+        ret = -1;
+        goto finished;
+    }
+    memset(plain, 0x5a, sizeof(plain));
+    plain[0] = 0x41;
+
+    memcpy(packet, plain, sizeof(packet));
+    if (protect(packet, HEADER_SIZE, 2, payload_size, &aead, 1) != 0
+        || unprotect(packet, HEADER_SIZE, 2, payload_size, &aead, 1) != 0
+        || memcmp(packet, plain, HEADER_SIZE + payload_size) != 0) {
+        printf("%s: round trip failed\n", name);
+        ret = -2;
+        goto finished;
+    }
+
+    start = now();
+    for (pn = 0; pn < ROUNDS; pn++) {
+        protect(packet, HEADER_SIZE, 2, payload_size, &aead, pn);
+    }
+    sealed = now() - start;
+
+    start = now();
+    for (pn = 0; pn < ROUNDS; pn++) {
+        memcpy(packet, plain, sizeof(packet));
+        protect(packet, HEADER_SIZE, 2, payload_size, &aead, pn);
+        unprotect(packet, HEADER_SIZE, 2, payload_size, &aead, pn);
+    }
+    opened = now() - start - sealed;
+
+    printf("%-18s seal %.0f packets/s (%.0f MB/s), open %.0f packets/s\n",
+           name, ROUNDS / sealed, ROUNDS * (double) PACKET_SIZE / sealed / 1e6, ROUNDS / opened);
+
+finished:
+    gquic_auto_update_aead_dtor(&aead);
+    return ret;
+}
+
+int main() {
+    if (chacha20_vector() != 0) {
+        printf("chacha20 test vector failed\n");
+        return -1;
+    }
+    if (bench("AES-128-GCM", GQUIC_TLS_CIPHER_SUITE_AES_128_GCM_SHA256) != 0
+        || bench("ChaCha20-Poly1305", GQUIC_TLS_CIPHER_SUITE_CHACHA20_POLY1305_SHA256) != 0) {
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,338 @@
+#include "handshake/establish.h"
+#include "tls/sign_pool.h"
+#include <openssl/pkcs12.h>
+#include <openssl/x509.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * full RSA-2048 handshakes between client and server establishes in one
+ * process, many of them in flight at once. with a sign pool the server's
+ * handshake suspends on its CertificateVerify and the worker that signed
+ * resumes it, so the rate should follow the number of workers up to the
+ * number of cores.
+ */
+
+#define CONCURRENT_HANDSHAKES 32
+#define ROUNDS 4
+
+typedef struct flight_s flight_t;
+struct flight_s {
+    u_int8_t enc_lv; /* 0 ends the pump */
+    gquic_str_t data;
+};
+
+typedef struct peer_s peer_t;
+struct peer_s {
+    gquic_handshake_establish_t est;
+    gquic_tls_config_t cfg;
+    gquic_transport_parameters_t params;
+    gquic_rtt_t rtt;
+    gquic_sem_list_t in;
+    pthread_t run_thread;
+    pthread_t pump_thread;
+    int run_ret;
+    peer_t *to;
+};
+
+typedef struct pair_s pair_t;
+struct pair_s {
+    peer_t client;
+    peer_t server;
+};
+
+static gquic_net_addr_t addr;
+static gquic_str_t cert_p12 = { 0, NULL };
+static gquic_tls_sign_pool_t *sign_pool = NULL;
+static gquic_tls_signer_t signer;
+static int signed_count = 0;
+static int failed_count = 0;
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int send_flight(peer_t *const peer, const u_int8_t enc_lv, gquic_writer_str_t *const writer) {
+    flight_t *flight = gquic_list_alloc(sizeof(flight_t));
+    if (flight == NULL) {
+        return -1;
+    }
+    flight->enc_lv = enc_lv;
+    gquic_str_init(&flight->data);
+    gquic_str_copy(&flight->data, writer);
+    gquic_writer_str_writed_size(writer, GQUIC_STR_SIZE(writer));
+    gquic_sem_list_push(&peer->to->in, flight);
+    return 0;
+}
+
+static int initial_write(void *const peer, gquic_writer_str_t *const writer) {
+    return send_flight(peer, GQUIC_ENC_LV_INITIAL, writer);
+}
+
+static int handshake_write(void *const peer, gquic_writer_str_t *const writer) {
+    return send_flight(peer, GQUIC_ENC_LV_HANDSHAKE, writer);
+}
+
+static int one_rtt_write(void *const peer, gquic_writer_str_t *const writer) {
+    return send_flight(peer, GQUIC_ENC_LV_1RTT, writer);
+}
+
+static int on_err(void *const peer, const u_int16_t alert, const int ret) {
+    (void) peer;
+    (void) alert;
+    (void) ret;
+    __atomic_add_fetch(&failed_count, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+static int on_restore_params(void *const peer, const gquic_str_t *const params) {
+    (void) peer;
+    (void) params;
+    return 0;
+}
+
+static int count_sign(gquic_str_t *const sig, void *const self, EVP_PKEY *const pkey, const u_int16_t sigalg, const gquic_str_t *const msg) {
+    (void) self;
+    __atomic_add_fetch(&signed_count, 1, __ATOMIC_RELAXED);
+    return gquic_tls_sign(sig, pkey, sigalg, msg);
+}
+
+static int get_cert(gquic_str_t *const cert_s, const gquic_tls_client_hello_msg_t *const hello) {
+    (void) hello;
+    return gquic_str_copy(cert_s, &cert_p12);
+}
+
+// a self-signed RSA-2048 certificate, bundled as the server config expects
+static int make_cert() {
+    EVP_PKEY *pkey = NULL;
+    X509 *x509 = NULL;
+    X509_NAME *name = NULL;
+    PKCS12 *p12 = NULL;
+    u_int8_t *buf = NULL;
+    int ret = 0;
+    if ((pkey = EVP_RSA_gen(2048)) == NULL || (x509 = X509_new()) == NULL) {
+        ret = -1;
+        goto finished;
+    }
+    X509_set_version(x509, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(x509), 1);
+    X509_gmtime_adj(X509_getm_notBefore(x509), 0);
+    X509_gmtime_adj(X509_getm_notAfter(x509), 24 * 60 * 60);
+    X509_set_pubkey(x509, pkey);
+    name = X509_get_subject_name(x509);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const u_int8_t *) "localhost", -1, -1, 0);
+    X509_set_issuer_name(x509, name);
+    if (X509_sign(x509, pkey, EVP_sha256()) <= 0) {
+        ret = -2;
+        goto finished;
+    }
+    if ((p12 = PKCS12_create(NULL, NULL, pkey, x509, NULL, 0, 0, 0, 0, 0)) == NULL) {
+        ret = -3;
+        goto finished;
+    }
+    if (gquic_str_alloc(&cert_p12, i2d_PKCS12(p12, NULL)) != 0) {
+        ret = -4;
+        goto finished;
+    }
+    buf = GQUIC_STR_VAL(&cert_p12);
+    i2d_PKCS12(p12, &buf);
+
+finished:
+    if (p12 != NULL) {
+        PKCS12_free(p12);
+    }
+    if (x509 != NULL) {
+        X509_free(x509);
+    }
+    if (pkey != NULL) {
+        EVP_PKEY_free(pkey);
+    }
+    return ret;
+}
+
+static void *pump(void *const arg) {
+    peer_t *const peer = arg;
+    flight_t *flight = NULL;
+    gquic_reader_str_t reader;
+    gquic_str_t msg;
+    size_t len = 0;
+    for ( ;; ) {
+        if (gquic_sem_list_pop((void **) &flight, &peer->in) != 0) {
+            break;
+        }
+        if (flight->enc_lv == 0) {
+            gquic_list_release(flight);
+            break;
+        }
+        reader = flight->data;
+        while (GQUIC_STR_SIZE(&reader) >= 4) {
+            len = 4 + ((((u_int8_t *) GQUIC_STR_VAL(&reader))[1] << 16)
+                       | (((u_int8_t *) GQUIC_STR_VAL(&reader))[2] << 8)
+                       | ((u_int8_t *) GQUIC_STR_VAL(&reader))[3]);
+            gquic_str_init(&msg);
+            gquic_str_alloc(&msg, len);
+            memcpy(GQUIC_STR_VAL(&msg), GQUIC_STR_VAL(&reader), len);
+            gquic_reader_str_readed_size(&reader, len);
+            gquic_handshake_establish_handle_msg(&peer->est, &msg, flight->enc_lv);
+        }
+        gquic_str_reset(&flight->data);
+        gquic_list_release(flight);
+    }
+    return NULL;
+}
+
+static void *run(void *const arg) {
+    peer_t *const peer = arg;
+    peer->run_ret = gquic_handshake_establish_run(&peer->est);
+    return NULL;
+}
+
+static int peer_ctor(peer_t *const peer, peer_t *const to, const int is_client) {
+    gquic_str_t conn_id = { 8, "\x83\x94\xc8\xf0\x3e\x51\x57\x08" };
+    gquic_handshake_establish_init(&peer->est);
+    gquic_tls_config_init(&peer->cfg);
+    gquic_transport_parameters_init(&peer->params);
+    gquic_rtt_init(&peer->rtt);
+    gquic_sem_list_init(&peer->in);
+    peer->to = to;
+    peer->run_ret = 0;
+
+    peer->params.init_max_data = 1 << 20;
+    peer->params.max_streams_bidi = 16;
+    peer->params.idle_timeout = 30 * 1000;
+    peer->params.max_ack_delay = 26 * 1000;
+    peer->params.ack_delay_exponent = 3;
+    peer->params.active_conn_id_limit = 4;
+    peer->cfg.insecure_skiy_verify = 1;
+    if (!is_client) {
+        peer->cfg.get_ser_cert = get_cert;
+        peer->cfg.sign_pool = sign_pool;
+        peer->cfg.signer = signer;
+        gquic_str_copy(&peer->params.original_conn_id, &conn_id);
+    }
+    if (gquic_handshake_establish_ctor(&peer->est,
+                                       peer, initial_write,
+                                       peer, handshake_write,
+                                       peer, one_rtt_write,
+                                       NULL, NULL,
+                                       &peer->cfg, &conn_id, GQUIC_VERSION_1, &peer->params, &peer->rtt, &addr, is_client) != 0) {
+        return -1;
+    }
+    peer->est.events.on_err.self = peer;
+    peer->est.events.on_err.cb = on_err;
+    peer->est.events.on_restore_params.self = peer;
+    peer->est.events.on_restore_params.cb = on_restore_params;
+    return 0;
+}
+
+static int peer_stop(peer_t *const peer) {
+    flight_t *end = gquic_list_alloc(sizeof(flight_t));
+    if (end == NULL) {
+        return -1;
+    }
+    end->enc_lv = 0;
+    gquic_sem_list_push(&peer->in, end);
+    pthread_join(peer->pump_thread, NULL);
+    gquic_handshake_establish_dtor(&peer->est);
+    gquic_str_reset(&peer->params.original_conn_id);
+    return 0;
+}
+
+static int pair_start(pair_t *const pair) {
+    if (peer_ctor(&pair->client, &pair->server, 1) != 0 || peer_ctor(&pair->server, &pair->client, 0) != 0) {
+        return -1;
+    }
+    pthread_create(&pair->client.pump_thread, NULL, pump, &pair->client);
+    pthread_create(&pair->server.pump_thread, NULL, pump, &pair->server);
+    pthread_create(&pair->server.run_thread, NULL, run, &pair->server);
+    pthread_create(&pair->client.run_thread, NULL, run, &pair->client);
+    return 0;
+}
+
+static int pair_finish(pair_t *const pair) {
+    pthread_join(pair->client.run_thread, NULL);
+    pthread_join(pair->server.run_thread, NULL);
+    peer_stop(&pair->client);
+    peer_stop(&pair->server);
+    if (pair->client.run_ret != 0 || pair->server.run_ret != 0
+        || pair->client.est.conn.handshake_status != 1 || pair->server.est.conn.handshake_status != 1) {
+        return -1;
+    }
+    return 0;
+}
+
+// workers == 0 signs inline on each server's handshake thread
+static int run_rate(const size_t workers, double *const rate) {
+    static pair_t pairs[CONCURRENT_HANDSHAKES];
+    gquic_tls_sign_pool_t pool;
+    double start = 0;
+    int round;
+    int i;
+    int ret = 0;
+    sign_pool = NULL;
+    if (workers != 0) {
+        gquic_tls_sign_pool_init(&pool);
+        if (gquic_tls_sign_pool_ctor(&pool, workers) != 0) {
+            return -1;
+        }
+        sign_pool = &pool;
+    }
+    signed_count = 0;
+    start = now();
+    for (round = 0; round < ROUNDS; round++) {
+        for (i = 0; i < CONCURRENT_HANDSHAKES; i++) {
+            if (pair_start(&pairs[i]) != 0) {
+                return -2;
+            }
+        }
+        for (i = 0; i < CONCURRENT_HANDSHAKES; i++) {
+            if (pair_finish(&pairs[i]) != 0) {
+                ret = -3;
+            }
+        }
+    }
+    *rate = ROUNDS * CONCURRENT_HANDSHAKES / (now() - start);
+    if (workers != 0) {
+        gquic_tls_sign_pool_dtor(&pool);
+    }
+    if (ret == 0 && signed_count != ROUNDS * CONCURRENT_HANDSHAKES) {
+        ret = -4;
+    }
+    return ret;
+}
+
+int main() {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    double rate = 0;
+    size_t workers;
+
+    if (make_cert() != 0) {
+        printf("no certificate\n");
+        return -1;
+    }
+    gquic_net_str_to_addr_v4(&addr, "127.0.0.1");
+    gquic_tls_signer_init(&signer);
+    signer.sign = count_sign;
+
+    printf("RSA-2048 full handshakes, %d in flight, %ld cores\n", CONCURRENT_HANDSHAKES, cores);
+    if (run_rate(0, &rate) != 0 || failed_count != 0) {
+        printf("inline signing failed\n");
+        return -1;
+    }
+    printf("inline signing: %.0f handshakes/s\n", rate);
+    for (workers = 1; workers <= (size_t) (cores > 0 ? cores : 1) * 2; workers *= 2) {
+        if (run_rate(workers, &rate) != 0 || failed_count != 0) {
+            printf("%lu workers: handshakes failed\n", workers);
+            return -1;
+        }
+        printf("%2lu workers: %.0f handshakes/s\n", workers, rate);
+    }
+
+    gquic_str_reset(&cert_p12);
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include "handshake/header_protector.h"
+#include <stdio.h>
+#include <string.h>
+
+static void from_hex(u_int8_t *const ret, const char *hex) {
+    size_t i;
+    for (i = 0; hex[2 * i] != '\0'; i++) {
+        sscanf(hex + 2 * i, "%2hhx", &ret[i]);
+    }
+}
+
+/*
+ * protects the unprotected header in place with the key derived from secret
+ * and the sample, then compares it with the expected header byte for byte
+ */
+static int protect(const char *const name, const u_int16_t suite_id, const char *const secret_hex, const char *const hp_hex,
+                   const char *const header_hex, const size_t pn_off, const char *const sample_hex,
+                   const char *const expect_hex, const int is_long_header, const int batch) {
+    const gquic_tls_cipher_suite_t *suite = NULL;
+    gquic_header_protector_t protector;
+    u_int8_t secret_cnt[32];
+    u_int8_t hp[32];
+    u_int8_t header[32];
+    u_int8_t sample_cnt[16];
+    u_int8_t expect[32];
+    size_t header_len = strlen(header_hex) / 2;
+    gquic_str_t secret = { 32, secret_cnt };
+    gquic_str_t hp_key = { 0, NULL };
+    gquic_str_t sample = { 16, sample_cnt };
+    gquic_str_t pn = { header_len - pn_off, header + pn_off };
+    u_int8_t *first_byte = header;
+
+    from_hex(secret_cnt, secret_hex);
+    from_hex(hp, hp_hex);
+    from_hex(header, header_hex);
+    from_hex(sample_cnt, sample_hex);
+    from_hex(expect, expect_hex);
+    if (gquic_tls_get_cipher_suite(&suite, suite_id) != 0) {
+        printf("%s: no cipher suite\n", name);
+        return -1;
+    }
+    if (gquic_header_protector_derive_key(&hp_key, suite, &secret) != 0
+        || GQUIC_STR_SIZE(&hp_key) != suite->key_len
+        || memcmp(GQUIC_STR_VAL(&hp_key), hp, suite->key_len) != 0) {
+        printf("%s: hp key mismatch\n", name);
+        return -1;
+    }
+    gquic_str_reset(&hp_key);
+    gquic_header_protector_init(&protector);
+    if (gquic_header_protector_ctor(&protector, suite, &secret, is_long_header) != 0) {
+        printf("%s: ctor failed\n", name);
+        return -1;
+    }
+    if (batch) {
+        if (GQUIC_HEADER_PROTECTOR_APPLY_BATCH(&pn, &first_byte, &protector, &sample, 1) != 0) {
+            printf("%s: apply_batch failed\n", name);
+            return -1;
+        }
+    }
+    else if (GQUIC_HEADER_PROTECTOR_SET_KEY(&protector, &sample) != 0 || GQUIC_HEADER_PROTECTOR_ENCRYPT(&pn, first_byte, &protector) != 0) {
+        printf("%s: encrypt failed\n", name);
+        return -1;
+    }
+    if (memcmp(header, expect, header_len) != 0) {
+        printf("%s: protected header mismatch\n", name);
+        return -1;
+    }
+    // masking again removes the protection
+    if (GQUIC_HEADER_PROTECTOR_SET_KEY(&protector, &sample) != 0
+        || GQUIC_HEADER_PROTECTOR_DECRYPT(&pn, first_byte, &protector) != 0) {
+        printf("%s: decrypt failed\n", name);
+        return -1;
+    }
+    from_hex(expect, header_hex);
+    if (memcmp(header, expect, header_len) != 0) {
+        printf("%s: unprotected header mismatch\n", name);
+        return -1;
+    }
+    gquic_header_protector_dtor(&protector);
+    return 0;
+}
+
+int main() {
+    /* RFC 9001, A.2: the client Initial, packet number 2 in 4 bytes */
+    if (protect("A.2", GQUIC_TLS_CIPHER_SUITE_AES_128_GCM_SHA256,
+                "c00cf151ca5be075ed0ebfb5c80323c42d6b7db67881289af4008f1f6c357aea",
+                "9f50449e04a0e810283a1e9933adedd2",
+                "c300000001088394c8f03e5157080000449e00000002", 18,
+                "d1b1c98dd7689fb8ec11d242b123dc9b",
+                "c000000001088394c8f03e5157080000449e7b9aec34", 1, 0) != 0) {
+        return -1;
+    }
+    if (protect("A.2 batch", GQUIC_TLS_CIPHER_SUITE_AES_128_GCM_SHA256,
+                "c00cf151ca5be075ed0ebfb5c80323c42d6b7db67881289af4008f1f6c357aea",
+                "9f50449e04a0e810283a1e9933adedd2",
+                "c300000001088394c8f03e5157080000449e00000002", 18,
+                "d1b1c98dd7689fb8ec11d242b123dc9b",
+                "c000000001088394c8f03e5157080000449e7b9aec34", 1, 1) != 0) {
+        return -1;
+    }
+    /* RFC 9001, A.5: a ChaCha20-Poly1305 short header, packet number 654360564 in 3 bytes */
+    if (protect("A.5", GQUIC_TLS_CIPHER_SUITE_CHACHA20_POLY1305_SHA256,
+                "9ac312a7f877468ebe69422748ad00a15443f18203a07d6060f688f30f21632b",
+                "25a282b9e82f06f21f488917a4fc8f1b73573685608597d0efcb076b0ab7a7a4",
+                "4200bff4", 1,
+                "5e5cd55c41f69080575d7999c25a5bfb",
+                "4cfe4189", 0, 0) != 0) {
+        return -1;
+    }
+    return 0;
+}
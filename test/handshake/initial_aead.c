@@ -0,0 +1,142 @@
+#include "handshake/initial_aead.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#define ROUNDS 20000
+#define THREADS 4
+#define SHARED_CONN_IDS 2048
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void from_hex(u_int8_t *const ret, const char *hex) {
+    size_t i;
+    for (i = 0; hex[2 * i] != '\0'; i++) {
+        sscanf(hex + 2 * i, "%2hhx", &ret[i]);
+    }
+}
+
+static int check(const char *const name, const u_int8_t *const val, const char *const hex, const size_t size) {
+    u_int8_t expect[16];
+    from_hex(expect, hex);
+    if (memcmp(val, expect, size) != 0) {
+        printf("%s mismatch\n", name);
+        return -1;
+    }
+    return 0;
+}
+
+/* RFC 9001, A.1 */
+static int v1_vector(const gquic_str_t *const conn_id) {
+    gquic_handshake_initial_keys_t keys;
+    if (gquic_handshake_initial_keys_get(&keys, GQUIC_VERSION_1, conn_id) != 0) {
+        return -1;
+    }
+    return check("client key", keys.cli_key, "1f369613dd76d5467730efcbe3b1a22d", 16)
+        || check("client iv", keys.cli_iv, "fa044b2f42a3fd3b46fb255c", 12)
+        || check("client hp", keys.cli_hp_key, "9f50449e04a0e810283a1e9933adedd2", 16)
+        || check("server key", keys.ser_key, "cf3a5331653c364c88f0f379b6067e37", 16)
+        || check("server iv", keys.ser_iv, "0ac1493ca1905853b0bba03e", 12)
+        || check("server hp", keys.ser_hp_key, "c206b8d9b9f0f37644430b490eeaa314", 16) ? -2 : 0;
+}
+
+/* drafts 23 to 28 share a salt, so their keys must differ from version 1 */
+static int draft27_keys(const gquic_str_t *const conn_id) {
+    gquic_handshake_initial_keys_t keys;
+    gquic_handshake_initial_keys_t v1_keys;
+    if (gquic_handshake_initial_keys_get(&keys, GQUIC_VERSION_DRAFT_27, conn_id) != 0
+        || gquic_handshake_initial_keys_get(&v1_keys, GQUIC_VERSION_1, conn_id) != 0) {
+        return -1;
+    }
+    return memcmp(&keys, &v1_keys, sizeof(keys)) == 0 ? -2 : 0;
+}
+
+static gquic_handshake_initial_keys_t shared_keys[SHARED_CONN_IDS];
+
+// more connection ids than the cache holds, so lookups race with inserts and evictions
+static void *shared_lookups(void *const arg) {
+    u_int8_t conn_id_cnt[8] = { 0 };
+    gquic_str_t conn_id = { sizeof(conn_id_cnt), conn_id_cnt };
+    gquic_handshake_initial_keys_t keys;
+    u_int32_t i;
+    u_int32_t k;
+    for (i = 0; i < 4 * SHARED_CONN_IDS; i++) {
+        k = (i * 7919 + (intptr_t) arg * 104729) % SHARED_CONN_IDS;
+        memcpy(conn_id_cnt, &k, sizeof(k));
+        if (gquic_handshake_initial_keys_get(&keys, GQUIC_VERSION_1, &conn_id) != 0
+            || memcmp(&keys, &shared_keys[k], sizeof(keys)) != 0) {
+            return (void *) 1;
+        }
+    }
+    return NULL;
+}
+
+int main() {
+    u_int8_t conn_id_cnt[8];
+    gquic_str_t conn_id = { sizeof(conn_id_cnt), conn_id_cnt };
+    gquic_common_long_header_sealer_t sealer;
+    gquic_common_long_header_opener_t opener;
+    gquic_handshake_initial_keys_t keys;
+    double start = 0;
+    double cold = 0;
+    double warm = 0;
+    pthread_t threads[THREADS];
+    void *thread_ret = NULL;
+    int i;
+
+    from_hex(conn_id_cnt, "8394c8f03e515708");
+    // the second lookup of each version is served from the cache
+    if (v1_vector(&conn_id) != 0 || v1_vector(&conn_id) != 0) {
+        printf("v1 initial keys failed\n");
+        return -1;
+    }
+    if (draft27_keys(&conn_id) != 0) {
+        printf("draft-27 initial keys failed\n");
+        return -1;
+    }
+    if (gquic_handshake_initial_keys_get(&keys, 0x0a0a0a0a, &conn_id) == 0) {
+        printf("unknown version accepted\n");
+        return -1;
+    }
+
+    memset(conn_id_cnt, 0, sizeof(conn_id_cnt));
+    for (i = 0; i < SHARED_CONN_IDS; i++) {
+        memcpy(conn_id_cnt, &i, sizeof(i));
+        gquic_handshake_initial_keys_get(&shared_keys[i], GQUIC_VERSION_1, &conn_id);
+    }
+    for (i = 0; i < THREADS; i++) {
+        pthread_create(&threads[i], NULL, shared_lookups, (void *) (intptr_t) i);
+    }
+    for (i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], &thread_ret);
+        if (thread_ret != NULL) {
+            printf("concurrent lookup returned wrong keys\n");
+            return -1;
+        }
+    }
+
+    start = now();
+    for (i = 0; i < ROUNDS; i++) {
+        memcpy(conn_id_cnt, &i, sizeof(i));
+        gquic_handshake_initial_aead_init(&sealer, &opener, GQUIC_VERSION_1, &conn_id, 0);
+        gquic_common_long_header_sealer_dtor(&sealer);
+        gquic_common_long_header_opener_dtor(&opener);
+    }
+    cold = now() - start;
+
+    start = now();
+    for (i = 0; i < ROUNDS; i++) {
+        gquic_handshake_initial_aead_init(&sealer, &opener, GQUIC_VERSION_1, &conn_id, 0);
+        gquic_common_long_header_sealer_dtor(&sealer);
+        gquic_common_long_header_opener_dtor(&opener);
+    }
+    warm = now() - start;
+
+    printf("initial aead: new conn id %.0f/s, cached conn id %.0f/s\n", ROUNDS / cold, ROUNDS / warm);
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include "handshake/auto_update_aead.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+static int seal_open(gquic_auto_update_aead_t *const from, gquic_auto_update_aead_t *const to, const u_int64_t pn) {
+    u_int8_t packet[64 + GQUIC_TLS_AEAD_TAG_SIZE];
+    gquic_str_t text = { 64, packet };
+    gquic_str_t tag = { GQUIC_TLS_AEAD_TAG_SIZE, packet + 64 };
+    gquic_str_t addata = { 4, "head" };
+    memset(packet, (int) pn, 64);
+    if (gquic_auto_update_aead_seal(&tag, &text, from, pn, &addata) != 0) {
+        return -1;
+    }
+    if (gquic_auto_update_aead_open(&text, to, 0, pn, from->times % 2, &tag, &addata) != 0) {
+        return -2;
+    }
+    return packet[0] == (u_int8_t) pn && packet[63] == (u_int8_t) pn ? 0 : -3;
+}
+
+int main() {
+    const gquic_tls_cipher_suite_t *suite = NULL;
+    gquic_rtt_t rtt;
+    gquic_auto_update_aead_t client;
+    gquic_auto_update_aead_t server;
+    gquic_str_t client_sec = { 32, "client traffic secret 0123456789" };
+    gquic_str_t server_sec = { 32, "server traffic secret 0123456789" };
+    gquic_auto_update_aead_keys_t *ready = NULL;
+    u_int64_t pn = 0;
+    int ret = 0;
+    int i = 0;
+
+    gquic_rtt_init(&rtt);
+    gquic_tls_get_cipher_suite(&suite, GQUIC_TLS_CIPHER_SUITE_AES_128_GCM_SHA256);
+    gquic_auto_update_aead_init(&client);
+    gquic_auto_update_aead_init(&server);
+    client.rtt = &rtt;
+    server.rtt = &rtt;
+    client.update_after_packets = 4;
+    gquic_auto_update_aead_set_wkey(&client, suite, &client_sec);
+    gquic_auto_update_aead_set_rkey(&client, suite, &server_sec);
+    gquic_auto_update_aead_set_wkey(&server, suite, &server_sec);
+    gquic_auto_update_aead_set_rkey(&server, suite, &client_sec);
+
+    // the client starts an update every 4 packets, the server follows when it sees the new key phase
+    for (pn = 0; pn < 40; pn++) {
+        if (gquic_auto_update_aead_try_update(&client, pn) != 0) {
+            printf("update failed at %lu\n", pn);
+            return -1;
+        }
+        if ((ret = seal_open(&client, &server, pn)) != 0) {
+            printf("client to server failed at %lu: %d\n", pn, ret);
+            return -1;
+        }
+        if ((ret = seal_open(&server, &client, pn)) != 0) {
+            printf("server to client failed at %lu: %d\n", pn, ret);
+            return -1;
+        }
+        client.last_ack_pn = pn;
+    }
+    if (client.times != 9 || server.times != 9) {
+        printf("unexpected key phases: client %lu, server %lu\n", client.times, server.times);
+        return -1;
+    }
+
+    gquic_auto_update_aead_drop_prev_keys(&server, server.prev_recv_aead_expire);
+    if (server.prev_recv_aead.self != NULL) {
+        printf("previous keys not dropped\n");
+        return -1;
+    }
+
+    // a refresh worker publishes generation N + 2 on its own, and the roll takes it as is
+    for (i = 0; i < 1000 && (ready = __atomic_load_n(&client.refresh->ready, __ATOMIC_ACQUIRE)) == NULL; i++) {
+        usleep(1000);
+    }
+    if (ready == NULL) {
+        printf("refresher did not publish\n");
+        return -1;
+    }
+    if (gquic_auto_update_aead_roll(&client, 0) != 0 || client.next != ready) {
+        printf("refreshed keys not taken\n");
+        return -1;
+    }
+    if (client.prev_recv_aead_expire != 3 * gquic_time_pto(&rtt, 1)) {
+        printf("previous keys expire at %lu\n", client.prev_recv_aead_expire);
+        return -1;
+    }
+
+    // a standalone AEAD has no rtt, its previous keys must not get a wrapped expiry
+    client.rtt = NULL;
+    if (gquic_auto_update_aead_roll(&client, 5) != 0 || client.prev_recv_aead_expire != ((u_int64_t) -1)) {
+        printf("previous keys without rtt expire at %lu\n", client.prev_recv_aead_expire);
+        return -1;
+    }
+
+    gquic_auto_update_aead_dtor(&client);
+    gquic_auto_update_aead_dtor(&server);
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,428 @@
+#include "handshake/establish.h"
+#include "packet/sent_packet_handler.h"
+#include "frame/max_data.h"
+#include "frame/meta.h"
+#include "tls/lru_sess_cache.h"
+#include "tls/ticket_keys.h"
+#include "tls/anti_replay.h"
+#include <openssl/pem.h>
+#include <openssl/pkcs12.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * a client and a server establish run against each other in one process,
+ * their handshake messages cross through one queue per direction. the first
+ * handshake leaves a ticket, the second resumes it with 0-RTT and the third
+ * replays the same ticket, so the server rejects the early data.
+ */
+
+#define EARLY_PACKETS 4
+
+typedef struct flight_s flight_t;
+struct flight_s {
+    u_int8_t enc_lv; /* 0 ends the pump */
+    gquic_str_t data;
+};
+
+typedef struct peer_s peer_t;
+struct peer_s {
+    gquic_handshake_establish_t est;
+    gquic_tls_config_t cfg;
+    gquic_transport_parameters_t params;
+    gquic_rtt_t rtt;
+    gquic_sem_list_t in;
+    pthread_t run_thread;
+    pthread_t pump_thread;
+    int run_ret;
+    peer_t *to;
+
+    // client only: the early data sent along with the ClientHello
+    int send_early;
+    int early_sent;
+    u_int8_t early_packet[32 + GQUIC_TLS_AEAD_TAG_SIZE];
+    gquic_packet_sent_packet_handler_t sent;
+    int dropped_0rtt;
+    int resent;
+    void *resent_frames[EARLY_PACKETS];
+};
+
+static gquic_net_addr_t addr;
+static gquic_tls_lru_sess_cache_t cache;
+static gquic_tls_ticket_keys_t ticket_keys;
+static gquic_tls_anti_replay_t anti_replay;
+
+static int send_flight(peer_t *const peer, const u_int8_t enc_lv, gquic_writer_str_t *const writer) {
+    flight_t *flight = gquic_list_alloc(sizeof(flight_t));
+    if (flight == NULL) {
+        return -1;
+    }
+    flight->enc_lv = enc_lv;
+    gquic_str_init(&flight->data);
+    gquic_str_copy(&flight->data, writer);
+    gquic_writer_str_writed_size(writer, GQUIC_STR_SIZE(writer));
+    gquic_sem_list_push(&peer->to->in, flight);
+    return 0;
+}
+
+static int initial_write(void *const peer, gquic_writer_str_t *const writer) {
+    return send_flight(peer, GQUIC_ENC_LV_INITIAL, writer);
+}
+
+static int handshake_write(void *const peer, gquic_writer_str_t *const writer) {
+    return send_flight(peer, GQUIC_ENC_LV_HANDSHAKE, writer);
+}
+
+static int one_rtt_write(void *const peer, gquic_writer_str_t *const writer) {
+    return send_flight(peer, GQUIC_ENC_LV_1RTT, writer);
+}
+
+static int on_err(void *const peer, const u_int16_t alert, const int ret) {
+    printf("%s alert %d: %d\n", ((peer_t *) peer)->est.is_client ? "client" : "server", alert, ret);
+    return 0;
+}
+
+static int on_restore_params(void *const peer, const gquic_str_t *const params) {
+    (void) peer;
+    (void) params;
+    return 0;
+}
+
+// the frames are kept, as the retransmission queue would
+static int on_frame_lost(void *const peer_, void *const frame) {
+    peer_t *const peer = peer_;
+    if (peer->resent == EARLY_PACKETS) {
+        return -1;
+    }
+    peer->resent_frames[peer->resent++] = frame;
+    return 0;
+}
+
+// as the session does, rejected 0-RTT frames are queued again for 1-RTT packets
+static int on_drop_keys(void *const peer_, const u_int8_t enc_lv) {
+    peer_t *const peer = peer_;
+    if (enc_lv != GQUIC_ENC_LV_0RTT) {
+        return 0;
+    }
+    peer->dropped_0rtt = 1;
+    if (peer->est.conn.early_data == GQUIC_TLS_EARLY_DATA_REJECTED) {
+        gquic_packet_sent_packet_handler_reset_for_0rtt_reject(&peer->sent);
+    }
+    return 0;
+}
+
+// the bundled p12 files use RC2, which OpenSSL 3 no longer reads, so the bundle is made here
+static int get_cert(gquic_str_t *const cert_s, const gquic_tls_client_hello_msg_t *const hello) {
+    (void) hello;
+    FILE *f = NULL;
+    X509 *x509 = NULL;
+    EVP_PKEY *pkey = NULL;
+    PKCS12 *p12 = NULL;
+    u_int8_t *buf = NULL;
+    if ((f = fopen("test_certs/ed25519_req.pem", "r")) == NULL) {
+        return -1;
+    }
+    x509 = PEM_read_X509(f, NULL, NULL, NULL);
+    fclose(f);
+    if ((f = fopen("test_certs/ed25519_pkey.pem", "r")) == NULL) {
+        X509_free(x509);
+        return -2;
+    }
+    pkey = PEM_read_PrivateKey(f, NULL, NULL, NULL);
+    fclose(f);
+    if (x509 == NULL || pkey == NULL || (p12 = PKCS12_create(NULL, NULL, pkey, x509, NULL, 0, 0, 0, 0, 0)) == NULL) {
+        return -3;
+    }
+    gquic_str_alloc(cert_s, i2d_PKCS12(p12, NULL));
+    buf = GQUIC_STR_VAL(cert_s);
+    i2d_PKCS12(p12, &buf);
+    PKCS12_free(p12);
+    EVP_PKEY_free(pkey);
+    X509_free(x509);
+    return 0;
+}
+
+// the client installs the early keys before its ClientHello leaves, the 0-RTT packets follow it
+static int send_early(peer_t *const client) {
+    gquic_header_protector_t *protector = NULL;
+    gquic_common_long_header_sealer_t *sealer = NULL;
+    gquic_str_t text = { 32, client->early_packet };
+    gquic_str_t tag = { GQUIC_TLS_AEAD_TAG_SIZE, client->early_packet + 32 };
+    gquic_str_t addata = { 4, "head" };
+    gquic_packet_t *packet = NULL;
+    void **frame = NULL;
+    int i;
+    if (gquic_handshake_establish_get_0rtt_sealer(&protector, &sealer, &client->est) != 0) {
+        return -1;
+    }
+    memset(client->early_packet, 0xed, 32);
+    if (gquic_common_long_header_sealer_seal(&tag, &text, sealer, 0, &addata) != 0) {
+        return -2;
+    }
+    for (i = 0; i < EARLY_PACKETS; i++) {
+        packet = malloc(sizeof(gquic_packet_t));
+        gquic_packet_init(packet);
+        gquic_packet_sent_packet_handler_pop_pn(&packet->pn, &client->sent, GQUIC_ENC_LV_0RTT);
+        packet->len = 1200;
+        packet->enc_lv = GQUIC_ENC_LV_0RTT;
+        packet->send_time = 1000 * 1000;
+        packet->frames = malloc(sizeof(gquic_list_t));
+        gquic_list_head_init(packet->frames);
+        frame = gquic_list_alloc(sizeof(void *));
+        *frame = gquic_frame_max_data_alloc();
+        GQUIC_FRAME_META(*frame).on_lost.self = client;
+        GQUIC_FRAME_META(*frame).on_lost.cb = on_frame_lost;
+        gquic_list_insert_before(packet->frames, frame);
+        gquic_packet_sent_packet_handler_sent_packet(&client->sent, packet);
+    }
+    client->early_sent = 1;
+    return 0;
+}
+
+static void *pump(void *const arg) {
+    peer_t *const peer = arg;
+    flight_t *flight = NULL;
+    gquic_reader_str_t reader;
+    gquic_str_t msg;
+    size_t len = 0;
+    for ( ;; ) {
+        if (gquic_sem_list_pop((void **) &flight, &peer->in) != 0) {
+            break;
+        }
+        if (flight->enc_lv == 0) {
+            gquic_list_release(flight);
+            break;
+        }
+        if (peer->to->send_early && !peer->to->early_sent && send_early(peer->to) != 0) {
+            printf("no 0-RTT keys with the ClientHello\n");
+        }
+        reader = flight->data;
+        // a write may carry more than one handshake message, the establish takes them one at a time
+        while (GQUIC_STR_SIZE(&reader) >= 4) {
+            len = 4 + ((((u_int8_t *) GQUIC_STR_VAL(&reader))[1] << 16)
+                       | (((u_int8_t *) GQUIC_STR_VAL(&reader))[2] << 8)
+                       | ((u_int8_t *) GQUIC_STR_VAL(&reader))[3]);
+            gquic_str_init(&msg);
+            gquic_str_alloc(&msg, len);
+            memcpy(GQUIC_STR_VAL(&msg), GQUIC_STR_VAL(&reader), len);
+            gquic_reader_str_readed_size(&reader, len);
+            gquic_handshake_establish_handle_msg(&peer->est, &msg, flight->enc_lv);
+        }
+        gquic_str_reset(&flight->data);
+        gquic_list_release(flight);
+    }
+    return NULL;
+}
+
+static void *run(void *const arg) {
+    peer_t *const peer = arg;
+    peer->run_ret = gquic_handshake_establish_run(&peer->est);
+    return NULL;
+}
+
+static int peer_ctor(peer_t *const peer, peer_t *const to, const int is_client, const int early) {
+    gquic_str_t conn_id = { 8, "\x83\x94\xc8\xf0\x3e\x51\x57\x08" };
+    gquic_handshake_establish_init(&peer->est);
+    gquic_tls_config_init(&peer->cfg);
+    gquic_transport_parameters_init(&peer->params);
+    gquic_rtt_init(&peer->rtt);
+    gquic_sem_list_init(&peer->in);
+    peer->to = to;
+    peer->run_ret = 0;
+    peer->send_early = early;
+    peer->early_sent = 0;
+    peer->dropped_0rtt = 0;
+    peer->resent = 0;
+    gquic_packet_sent_packet_handler_init(&peer->sent);
+    gquic_packet_sent_packet_handler_ctor(&peer->sent, 0, &peer->rtt, GQUIC_CONG_CUBIC, 0, NULL, NULL);
+
+    peer->params.init_max_data = 1 << 20;
+    peer->params.init_max_stream_data_bidi_local = 1 << 18;
+    peer->params.init_max_stream_data_bidi_remote = 1 << 18;
+    peer->params.max_streams_bidi = 16;
+    peer->params.idle_timeout = 30 * 1000;
+    peer->params.max_ack_delay = 26 * 1000;
+    peer->params.ack_delay_exponent = 3;
+    peer->params.active_conn_id_limit = 4;
+    peer->cfg.insecure_skiy_verify = 1;
+    peer->cfg.max_early_data = 0xffffffff;
+    if (is_client) {
+        peer->cfg.cli_sess_cache = &cache.base;
+    }
+    else {
+        peer->cfg.get_ser_cert = get_cert;
+        peer->cfg.ticket_keys = &ticket_keys;
+        peer->cfg.anti_replay = &anti_replay;
+        gquic_str_copy(&peer->params.original_conn_id, &conn_id);
+    }
+    if (gquic_handshake_establish_ctor(&peer->est,
+                                       peer, initial_write,
+                                       peer, handshake_write,
+                                       peer, one_rtt_write,
+                                       NULL, NULL,
+                                       &peer->cfg, &conn_id, GQUIC_VERSION_1, &peer->params, &peer->rtt, &addr, is_client) != 0) {
+        return -1;
+    }
+    peer->est.events.on_err.self = peer;
+    peer->est.events.on_err.cb = on_err;
+    peer->est.events.on_restore_params.self = peer;
+    peer->est.events.on_restore_params.cb = on_restore_params;
+    peer->est.events.drop_keys.self = peer;
+    peer->est.events.drop_keys.cb = on_drop_keys;
+    return 0;
+}
+
+static int peer_dtor(peer_t *const peer) {
+    gquic_handshake_establish_dtor(&peer->est);
+    gquic_packet_sent_packet_handler_dtor(&peer->sent);
+    while (peer->resent > 0) {
+        gquic_frame_release(peer->resent_frames[--peer->resent]);
+    }
+    gquic_str_reset(&peer->params.original_conn_id);
+    return 0;
+}
+
+static int handshake(peer_t *const client, peer_t *const server, const int early) {
+    flight_t *end = NULL;
+    if (peer_ctor(client, server, 1, early) != 0 || peer_ctor(server, client, 0, 0) != 0) {
+        printf("ctor failed\n");
+        return -1;
+    }
+    pthread_create(&client->pump_thread, NULL, pump, client);
+    pthread_create(&server->pump_thread, NULL, pump, server);
+    pthread_create(&server->run_thread, NULL, run, server);
+    pthread_create(&client->run_thread, NULL, run, client);
+    pthread_join(client->run_thread, NULL);
+    pthread_join(server->run_thread, NULL);
+
+    // the server wrote its ticket before its run returned, so the ticket is queued ahead of these
+    end = gquic_list_alloc(sizeof(flight_t));
+    end->enc_lv = 0;
+    gquic_sem_list_push(&client->in, end);
+    end = gquic_list_alloc(sizeof(flight_t));
+    end->enc_lv = 0;
+    gquic_sem_list_push(&server->in, end);
+    pthread_join(client->pump_thread, NULL);
+    pthread_join(server->pump_thread, NULL);
+    if (client->run_ret != 0 || server->run_ret != 0) {
+        printf("handshake failed: client %d server %d\n", client->run_ret, server->run_ret);
+        return -1;
+    }
+    return 0;
+}
+
+// the server opens what the client sealed with its early traffic keys
+static int open_early(peer_t *const server, peer_t *const client) {
+    gquic_header_protector_t *protector = NULL;
+    gquic_common_long_header_opener_t *opener = NULL;
+    u_int8_t packet[32 + GQUIC_TLS_AEAD_TAG_SIZE];
+    gquic_str_t text = { 32, packet };
+    gquic_str_t tag = { GQUIC_TLS_AEAD_TAG_SIZE, packet + 32 };
+    gquic_str_t addata = { 4, "head" };
+    memcpy(packet, client->early_packet, sizeof(packet));
+    if (gquic_handshake_establish_get_0rtt_opener(&protector, &opener, &server->est) != 0) {
+        return -1;
+    }
+    if (gquic_common_long_header_opener_open(&text, opener, 0, &tag, &addata) != 0) {
+        return -2;
+    }
+    return packet[0] == 0xed && packet[31] == 0xed ? 0 : -3;
+}
+
+int main() {
+    peer_t client;
+    peer_t server;
+    gquic_tls_client_sess_state_t *ticket = NULL;
+    gquic_str_t cache_key = { 0, NULL };
+    gquic_str_t cert = { 0, NULL };
+    gquic_tls_lru_sess_cache_stats_t stats;
+    u_int64_t infly = 0;
+
+    // the handshake stalls rather than fails without a certificate
+    if (get_cert(&cert, NULL) != 0) {
+        printf("no test_certs\n");
+        return -1;
+    }
+    gquic_str_reset(&cert);
+    gquic_net_str_to_addr_v4(&addr, "127.0.0.1");
+    gquic_net_addr_to_str(&addr, &cache_key);
+    gquic_tls_lru_sess_cache_init(&cache);
+    gquic_tls_lru_sess_cache_ctor(&cache, GQUIC_TLS_LRU_SESS_CACHE_DEFAULT_CAP, 1);
+    gquic_tls_ticket_keys_init(&ticket_keys);
+    gquic_tls_ticket_keys_ctor(&ticket_keys, GQUIC_TLS_TICKET_KEYS_DEFAULT_INTERVAL, GQUIC_TLS_TICKET_KEYS_DEFAULT_KEEP);
+    gquic_tls_anti_replay_init(&anti_replay);
+    gquic_tls_anti_replay_ctor(&anti_replay, GQUIC_TLS_ANTI_REPLAY_DEFAULT_WINDOW, 64);
+
+    // a full handshake leaves a ticket that allows early data
+    if (handshake(&client, &server, 0) != 0) {
+        return -1;
+    }
+    gquic_tls_lru_sess_cache_stats(&stats, &cache);
+    if (client.est.conn.did_resume || stats.count != 1) {
+        printf("no ticket after the full handshake, %lu cached\n", stats.count);
+        return -1;
+    }
+    if (gquic_tls_lru_sess_cache_get(&ticket, &cache, &cache_key) != 0 || ticket == NULL || ticket->max_early_data == 0) {
+        printf("ticket does not allow early data\n");
+        return -1;
+    }
+    peer_dtor(&client);
+    peer_dtor(&server);
+
+    // resuming it, the server takes the 0-RTT packets and the client has nothing to resend
+    if (handshake(&client, &server, 1) != 0) {
+        return -1;
+    }
+    if (!client.est.conn.did_resume || !client.early_sent
+        || client.est.conn.early_data != GQUIC_TLS_EARLY_DATA_ACCEPTED
+        || server.est.conn.early_data != GQUIC_TLS_EARLY_DATA_ACCEPTED) {
+        printf("0-RTT not accepted: resumed %d, client %d, server %d\n",
+               client.est.conn.did_resume, client.est.conn.early_data, server.est.conn.early_data);
+        return -1;
+    }
+    if (open_early(&server, &client) != 0) {
+        printf("server cannot open the 0-RTT packet\n");
+        return -1;
+    }
+    if (!client.dropped_0rtt || client.est.zero_rtt_sealer.available || client.resent != 0) {
+        printf("accepted 0-RTT: dropped %d, resent %d\n", client.dropped_0rtt, client.resent);
+        return -1;
+    }
+    peer_dtor(&client);
+    peer_dtor(&server);
+
+    // the same ticket again is a replay, the server resumes but refuses the early data
+    gquic_tls_lru_sess_cache_put(&cache, &cache_key, ticket);
+    if (handshake(&client, &server, 1) != 0) {
+        return -1;
+    }
+    if (!client.est.conn.did_resume || !client.early_sent
+        || client.est.conn.early_data != GQUIC_TLS_EARLY_DATA_REJECTED
+        || anti_replay.replayed != 1) {
+        printf("replay not rejected: resumed %d, client %d, replayed %lu\n",
+               client.est.conn.did_resume, client.est.conn.early_data, anti_replay.replayed);
+        return -1;
+    }
+    if (open_early(&server, &client) == 0) {
+        printf("server opened a rejected 0-RTT packet\n");
+        return -1;
+    }
+    // every 0-RTT frame goes back to be sent in 1-RTT, and none of it counts as in flight or lost
+    infly = client.sent.infly_bytes;
+    if (!client.dropped_0rtt || client.resent != EARLY_PACKETS || infly != 0 || client.sent.spurious_losses != 0) {
+        printf("rejected 0-RTT: dropped %d, resent %d, in flight %lu\n", client.dropped_0rtt, client.resent, infly);
+        return -1;
+    }
+    peer_dtor(&client);
+    peer_dtor(&server);
+
+    gquic_tls_client_sess_state_release(ticket);
+    gquic_str_reset(&cache_key);
+    gquic_tls_anti_replay_dtor(&anti_replay);
+    gquic_tls_ticket_keys_dtor(&ticket_keys);
+    gquic_tls_lru_sess_cache_dtor(&cache);
+    printf("0-RTT accepted, then rejected and resent\n");
+    return 0;
+}
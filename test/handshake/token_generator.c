@@ -0,0 +1,86 @@
+#include "handshake/token_generator.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SEC (1000 * 1000UL)
+
+static int validate(gquic_handshake_token_generator_t *const gen, const gquic_str_t *const token, const gquic_net_addr_t *const addr,
+                    const u_int64_t now, gquic_handshake_token_t *const info) {
+    gquic_handshake_token_dtor(info);
+    gquic_handshake_token_init(info);
+    return gquic_handshake_token_generator_validate(info, gen, token, addr, now);
+}
+
+int main() {
+    u_int8_t secret[GQUIC_HANDSHAKE_TOKEN_SECRET_SIZE];
+    gquic_handshake_token_generator_t gen;
+    gquic_handshake_token_generator_t peer;
+    gquic_handshake_token_generator_t other;
+    gquic_net_addr_t addr;
+    gquic_net_addr_t moved;
+    gquic_handshake_token_t info;
+    gquic_str_t token = { 0, NULL };
+    gquic_str_t retry = { 0, NULL };
+    gquic_str_t odcid = { 8, "\x01\x02\x03\x04\x05\x06\x07\x08" };
+    const u_int64_t now = 1700000000 * SEC;
+
+    memset(secret, 0x42, sizeof(secret));
+    gquic_handshake_token_init(&info);
+    gquic_handshake_token_generator_init(&gen);
+    gquic_handshake_token_generator_init(&peer);
+    gquic_handshake_token_generator_init(&other);
+    gquic_handshake_token_generator_ctor(&gen, secret);
+    gquic_handshake_token_generator_ctor(&peer, secret);
+    gquic_handshake_token_generator_ctor(&other, NULL);
+    gquic_net_addr_init(&addr);
+    gquic_net_str_to_addr_v4(&addr, "192.0.2.1");
+    gquic_net_addr_init(&moved);
+    gquic_net_str_to_addr_v4(&moved, "192.0.2.2");
+
+    if (gquic_handshake_token_generator_new_token(&token, &gen, &addr, now) != 0) {
+        printf("new token failed\n");
+        return -1;
+    }
+    // any server holding the secret accepts it, a day later it has expired
+    if (validate(&peer, &token, &addr, now + 60 * SEC, &info) != GQUIC_HANDSHAKE_TOKEN_VALID || info.is_retry || info.sent_time != now) {
+        printf("token rejected\n");
+        return -1;
+    }
+    if (validate(&gen, &token, &addr, now + 25 * 60 * 60 * SEC, &info) != GQUIC_HANDSHAKE_TOKEN_EXPIRED) {
+        printf("old token accepted\n");
+        return -1;
+    }
+    if (validate(&gen, &token, &moved, now, &info) != GQUIC_HANDSHAKE_TOKEN_INVALID
+        || validate(&other, &token, &addr, now, &info) != GQUIC_HANDSHAKE_TOKEN_INVALID) {
+        printf("token accepted from another address or key\n");
+        return -1;
+    }
+    ((u_int8_t *) GQUIC_STR_VAL(&token))[14] ^= 1;
+    if (validate(&gen, &token, &addr, now, &info) != GQUIC_HANDSHAKE_TOKEN_INVALID) {
+        printf("damaged token accepted\n");
+        return -1;
+    }
+
+    if (gquic_handshake_token_generator_new_retry_token(&retry, &gen, &addr, &odcid, now) != 0) {
+        printf("new retry token failed\n");
+        return -1;
+    }
+    if (validate(&gen, &retry, &addr, now + 5 * SEC, &info) != GQUIC_HANDSHAKE_TOKEN_VALID
+        || !info.is_retry || gquic_str_cmp(&info.odcid, &odcid) != 0) {
+        printf("retry token rejected\n");
+        return -1;
+    }
+    if (validate(&gen, &retry, &addr, now + 11 * SEC, &info) != GQUIC_HANDSHAKE_TOKEN_EXPIRED) {
+        printf("old retry token accepted\n");
+        return -1;
+    }
+
+    gquic_str_reset(&token);
+    gquic_str_reset(&retry);
+    gquic_handshake_token_dtor(&info);
+    gquic_handshake_token_generator_dtor(&gen);
+    gquic_handshake_token_generator_dtor(&peer);
+    gquic_handshake_token_generator_dtor(&other);
+    printf("token generator ok\n");
+    return 0;
+}
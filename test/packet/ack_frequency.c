@@ -0,0 +1,130 @@
+#include "packet/received_packet_handler.h"
+#include "frame/ack_frequency.h"
+#include "frame/immediate_ack.h"
+#include "frame/parser.h"
+#include "frame/meta.h"
+#include "net/conn.h"
+#include "tls/common.h"
+#include <stdio.h>
+#include <sys/time.h>
+
+#define PACKETS 2000
+
+static u_int64_t now() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000 * 1000 + tv.tv_usec;
+}
+
+// feeds packets from..to (skipping skip), returns how many ACKs went out on their own
+static int receive(gquic_packet_received_packet_handlers_t *const handlers, const u_int64_t from, const u_int64_t to, const u_int64_t skip) {
+    gquic_frame_ack_t *ack = NULL;
+    u_int64_t pn = 0;
+    int acks = 0;
+    for (pn = from; pn <= to; pn++) {
+        if (pn == skip) {
+            continue;
+        }
+        gquic_packet_received_packet_handlers_received_packet(handlers, pn, now(), 1, GQUIC_ENC_LV_1RTT, GQUIC_NET_ECN_NOT_ECT);
+        ack = NULL;
+        gquic_packet_received_packet_handlers_get_ack_frame(&ack, handlers, GQUIC_ENC_LV_1RTT, 1);
+        if (ack != NULL) {
+            gquic_frame_release(ack);
+            acks++;
+        }
+    }
+    return acks;
+}
+
+int main() {
+    gquic_packet_received_packet_handlers_t handlers;
+    gquic_rtt_t rtt;
+    gquic_frame_ack_frequency_t *frame = gquic_frame_ack_frequency_alloc();
+    gquic_frame_ack_frequency_t *parsed = NULL;
+    gquic_frame_parser_t parser;
+    u_int8_t buf[64] = { 0 };
+    gquic_writer_str_t writer = { sizeof(buf), buf };
+    gquic_reader_str_t reader = { 0, buf };
+    int default_acks = 0;
+    int thinned_acks = 0;
+
+    GQUIC_FRAME_INIT(frame);
+    frame->seq = 0;
+    frame->ack_eliciting_threshold = 31;
+    frame->max_ack_delay = 5 * 1000;
+    frame->reordering_threshold = 3;
+    GQUIC_FRAME_SERIALIZE(frame, &writer);
+    gquic_writer_str_write_byte(&writer, 0x1f);
+    reader.size = sizeof(buf) - GQUIC_STR_SIZE(&writer);
+    gquic_frame_parser_init(&parser);
+    if (gquic_frame_parser_next((void **) &parsed, &parser, &reader, GQUIC_ENC_LV_1RTT) != 0
+        || parsed == NULL
+        || GQUIC_FRAME_META(parsed).type != 0xaf
+        || buf[0] != 0x40
+        || parsed->ack_eliciting_threshold != 31 || parsed->max_ack_delay != 5 * 1000 || parsed->reordering_threshold != 3) {
+        printf("ACK_FREQUENCY did not round trip\n");
+        return -1;
+    }
+    gquic_frame_release(parsed);
+    parsed = NULL;
+    if (gquic_frame_parser_next((void **) &parsed, &parser, &reader, GQUIC_ENC_LV_1RTT) != 0
+        || parsed == NULL || GQUIC_FRAME_META(parsed).type != 0x1f || GQUIC_STR_SIZE(&reader) != 0) {
+        printf("IMMEDIATE_ACK did not round trip\n");
+        return -1;
+    }
+    gquic_frame_release(parsed);
+
+    gquic_rtt_init(&rtt);
+    gquic_rtt_update(&rtt, 20 * 1000, 0);
+
+    gquic_packet_received_packet_handlers_init(&handlers);
+    gquic_packet_received_packet_handlers_ctor(&handlers, &rtt);
+    default_acks = receive(&handlers, 0, PACKETS - 1, -1);
+    gquic_packet_received_packet_handlers_dtor(&handlers);
+
+    gquic_packet_received_packet_handlers_init(&handlers);
+    gquic_packet_received_packet_handlers_ctor(&handlers, &rtt);
+    gquic_packet_received_packet_handlers_set_ack_frequency(&handlers, frame);
+    thinned_acks = receive(&handlers, 0, PACKETS - 1, -1);
+    printf("%d packets: %d ACKs by default, %d with a threshold of %lu\n", PACKETS, default_acks, thinned_acks, frame->ack_eliciting_threshold);
+    if (thinned_acks > PACKETS / 32 + 2 || thinned_acks * 3 > default_acks) {
+        printf("threshold not honoured\n");
+        return -1;
+    }
+    // the ones short of the threshold wait for the requested delay
+    if (handlers.one_rtt.ack_alarm == 0 || handlers.one_rtt.ack_alarm > now() + frame->max_ack_delay
+        || gquic_packet_received_packet_handlers_get_alarm_timeout(&handlers) != handlers.one_rtt.ack_alarm) {
+        printf("ack alarm %lu\n", handlers.one_rtt.ack_alarm);
+        return -1;
+    }
+
+    // a gap of three below the largest is acked at once
+    if (receive(&handlers, PACKETS, PACKETS + 3, PACKETS) != 1 || !handlers.one_rtt.has_last_ack || handlers.one_rtt.last_ack_largest != PACKETS + 3) {
+        printf("reordering not acked\n");
+        return -1;
+    }
+    // and so is the late packet filling it
+    if (receive(&handlers, PACKETS, PACKETS, -1) != 1) {
+        printf("late packet not acked\n");
+        return -1;
+    }
+    // a stale frame does not undo a newer one
+    frame->reordering_threshold = 0;
+    frame->seq = 1;
+    gquic_packet_received_packet_handlers_set_ack_frequency(&handlers, frame);
+    frame->reordering_threshold = 3;
+    frame->seq = 0;
+    gquic_packet_received_packet_handlers_set_ack_frequency(&handlers, frame);
+    if (receive(&handlers, PACKETS + 4, PACKETS + 8, PACKETS + 4) != 0) {
+        printf("reordering acked with the threshold off\n");
+        return -1;
+    }
+    gquic_packet_received_packet_handlers_immediate_ack(&handlers);
+    if (receive(&handlers, PACKETS + 9, PACKETS + 9, -1) != 1) {
+        printf("IMMEDIATE_ACK ignored\n");
+        return -1;
+    }
+    gquic_packet_received_packet_handlers_dtor(&handlers);
+    gquic_frame_release(frame);
+    return 0;
+}
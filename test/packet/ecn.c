@@ -0,0 +1,189 @@
+#include "packet/sent_packet_handler.h"
+#include "packet/received_packet_handler.h"
+#include "frame/max_data.h"
+#include "frame/meta.h"
+#include "net/conn.h"
+#include "tls/common.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MSS 1460
+#define RTT (20 * 1000)
+
+static int ce_events = 0;
+static u_int64_t sent[64];
+static int sent_count = 0;
+
+static int on_event(void *const self, gquic_event_t *const event) {
+    (void) self;
+    if (event->type == GQUIC_EVENT_ECN_CE) {
+        ce_events += event->p_size;
+    }
+    return 0;
+}
+
+static gquic_packet_t *send_packet(gquic_packet_sent_packet_handler_t *const handler, const u_int64_t now) {
+    gquic_packet_t *packet = malloc(sizeof(gquic_packet_t));
+    void **frame = NULL;
+    gquic_packet_init(packet);
+    gquic_packet_sent_packet_handler_pop_pn(&packet->pn, handler, GQUIC_ENC_LV_1RTT);
+    packet->len = MSS;
+    packet->enc_lv = GQUIC_ENC_LV_1RTT;
+    packet->send_time = now;
+    packet->frames = malloc(sizeof(gquic_list_t));
+    gquic_list_head_init(packet->frames);
+    frame = gquic_list_alloc(sizeof(void *));
+    *frame = gquic_frame_max_data_alloc();
+    gquic_list_insert_before(packet->frames, frame);
+    gquic_packet_sent_packet_handler_sent_packet(handler, packet);
+    sent[sent_count++] = packet->pn;
+    return packet;
+}
+
+// acks the from-th to the to-th packet sent, with ECN counts when type is 0x03
+static int ack(gquic_packet_sent_packet_handler_t *const handler,
+               const int from, const int to, const u_int8_t type,
+               const u_int64_t ect0, const u_int64_t ce, const u_int64_t now) {
+    gquic_frame_ack_t *frame = gquic_frame_ack_alloc();
+    int ret = 0;
+    int i = 0;
+    GQUIC_FRAME_INIT(frame);
+    GQUIC_FRAME_META(frame).type = type;
+    frame->largest_ack = sent[to];
+    for (i = to - 1; i >= from; i--) {
+        if (sent[i] + 1 == sent[i + 1]) {
+            if (frame->count == 0) {
+                frame->first_range++;
+            }
+            else {
+                frame->ranges[frame->count - 1].range++;
+            }
+        }
+        else {
+            // the packet number generator skipped one
+            frame->ranges[frame->count].gap = sent[i + 1] - sent[i] - 2;
+            frame->ranges[frame->count].range = 0;
+            frame->count++;
+        }
+    }
+    frame->ecn.ect[0] = ect0;
+    frame->ecn.ecn_ce = ce;
+    ret = gquic_packet_sent_packet_handler_received_ack(handler, frame, GQUIC_ENC_LV_1RTT, now);
+    gquic_frame_release(frame);
+    return ret;
+}
+
+static void setup(gquic_packet_sent_packet_handler_t *const handler, gquic_rtt_t *const rtt) {
+    gquic_rtt_init(rtt);
+    sent_count = 0;
+    gquic_packet_sent_packet_handler_init(handler);
+    gquic_packet_sent_packet_handler_ctor(handler, 0, rtt, GQUIC_CONG_CUBIC, 0, &ce_events, on_event);
+    gquic_packet_sent_packet_handler_set_peer_addr_validated(handler);
+    gquic_packet_sent_packet_handler_drop_packets(handler, GQUIC_ENC_LV_INITIAL);
+    gquic_packet_sent_packet_handler_drop_packets(handler, GQUIC_ENC_LV_HANDSHAKE);
+    gquic_packet_sent_packet_handler_set_handshake_complete(handler);
+    gquic_packet_sent_packet_handler_enable_ecn(handler);
+}
+
+int main() {
+    gquic_packet_received_packet_handlers_t handlers;
+    gquic_packet_sent_packet_handler_t handler;
+    gquic_rtt_t rtt;
+    gquic_frame_ack_t *frame = NULL;
+    u_int64_t now = 1000 * 1000;
+    u_int64_t cwnd = 0;
+    u_int64_t pn = 0;
+    int i = 0;
+
+    // the receiver counts each codepoint once per packet number and acks CE at once
+    gquic_rtt_init(&rtt);
+    gquic_rtt_update(&rtt, RTT, 0);
+    gquic_packet_received_packet_handlers_init(&handlers);
+    gquic_packet_received_packet_handlers_ctor(&handlers, &rtt);
+    for (pn = 0; pn < 200; pn++) {
+        gquic_packet_received_packet_handlers_received_packet(&handlers, pn, now, 1, GQUIC_ENC_LV_1RTT, GQUIC_NET_ECN_ECT0);
+    }
+    gquic_packet_received_packet_handlers_received_packet(&handlers, 199, now, 1, GQUIC_ENC_LV_1RTT, GQUIC_NET_ECN_ECT0);
+    gquic_packet_received_packet_handlers_get_ack_frame(&frame, &handlers, GQUIC_ENC_LV_1RTT, 0);
+    if (frame == NULL || GQUIC_FRAME_META(frame).type != 0x03 || frame->ecn.ect[0] != 200 || frame->ecn.ecn_ce != 0) {
+        printf("ACK_ECN not sent\n");
+        return -1;
+    }
+    gquic_frame_release(frame);
+    frame = NULL;
+    gquic_packet_received_packet_handlers_received_packet(&handlers, 200, now, 1, GQUIC_ENC_LV_1RTT, GQUIC_NET_ECN_CE);
+    gquic_packet_received_packet_handlers_get_ack_frame(&frame, &handlers, GQUIC_ENC_LV_1RTT, 1);
+    if (frame == NULL || frame->ecn.ect[0] != 200 || frame->ecn.ecn_ce != 1) {
+        printf("CE not acked at once\n");
+        return -1;
+    }
+    gquic_frame_release(frame);
+    gquic_packet_received_packet_handlers_dtor(&handlers);
+
+    // the testing packets are marked, then marking waits for the path to be validated
+    setup(&handler, &rtt);
+    for (i = 0; i < GQUIC_PACKET_ECN_TESTING_PACKETS + 2; i++) {
+        if (send_packet(&handler, now)->ecn != (i < GQUIC_PACKET_ECN_TESTING_PACKETS ? GQUIC_NET_ECN_ECT0 : GQUIC_NET_ECN_NOT_ECT)) {
+            printf("packet %d marked wrong\n", i);
+            return -1;
+        }
+    }
+    now += RTT;
+    if (ack(&handler, 0, GQUIC_PACKET_ECN_TESTING_PACKETS + 1, 0x03, GQUIC_PACKET_ECN_TESTING_PACKETS, 0, now) != 0
+        || handler.ecn.state != GQUIC_PACKET_ECN_CAPABLE
+        || send_packet(&handler, now)->ecn != GQUIC_NET_ECN_ECT0) {
+        printf("valid path not capable\n");
+        return -1;
+    }
+    for (i = 0; i < 20; i++) {
+        send_packet(&handler, now);
+    }
+    // CE shrinks the window like a loss, though nothing is lost
+    cwnd = GQUIC_CONG_CWND(&handler.cong);
+    now += RTT;
+    if (ack(&handler, 12, 22, 0x03, 20, 1, now) != 0
+        || GQUIC_CONG_CWND(&handler.cong) >= cwnd || GQUIC_CONG_CWND(&handler.cong) < cwnd / 2
+        || ce_events != 1 || handler.spurious_losses != 0) {
+        printf("CE ignored, cwnd %lu -> %lu\n", cwnd, GQUIC_CONG_CWND(&handler.cong));
+        return -1;
+    }
+    // once per window
+    cwnd = GQUIC_CONG_CWND(&handler.cong);
+    if (ack(&handler, 23, 32, 0x03, 28, 3, now) != 0 || GQUIC_CONG_CWND(&handler.cong) != cwnd || ce_events != 3) {
+        printf("second cut in a window, cwnd %lu -> %lu\n", cwnd, GQUIC_CONG_CWND(&handler.cong));
+        return -1;
+    }
+    printf("ECN capable, CE cut the window to %lu\n", cwnd);
+    gquic_packet_sent_packet_handler_dtor(&handler);
+
+    // a path that clears the ECN field fails validation and marking stops
+    setup(&handler, &rtt);
+    for (i = 0; i < GQUIC_PACKET_ECN_TESTING_PACKETS; i++) {
+        send_packet(&handler, now);
+    }
+    now += RTT;
+    if (ack(&handler, 0, GQUIC_PACKET_ECN_TESTING_PACKETS - 1, 0x02, 0, 0, now) != 0
+        || handler.ecn.state != GQUIC_PACKET_ECN_FAILED
+        || send_packet(&handler, now)->ecn != GQUIC_NET_ECN_NOT_ECT) {
+        printf("bleached path not detected\n");
+        return -1;
+    }
+    gquic_packet_sent_packet_handler_dtor(&handler);
+
+    // and so does a peer whose counts leave the marked packets unaccounted for
+    setup(&handler, &rtt);
+    for (i = 0; i < GQUIC_PACKET_ECN_TESTING_PACKETS; i++) {
+        send_packet(&handler, now);
+    }
+    now += RTT;
+    if (ack(&handler, 0, GQUIC_PACKET_ECN_TESTING_PACKETS - 1, 0x03, 0, 0, now) != 0) {
+        printf("unaccounted path ack rejected\n");
+        return -1;
+    }
+    if (handler.ecn.state != GQUIC_PACKET_ECN_FAILED) {
+        printf("unaccounted marks not detected\n");
+        return -1;
+    }
+    gquic_packet_sent_packet_handler_dtor(&handler);
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "packet/pacer.h"
+#include <stdio.h>
+
+#define MSS 1460
+#define RATE (100 * 1000 * 1000 / 8)
+#define DURATION (1000 * 1000)
+
+// sends whatever the pacer allows whenever its timer fires, returns the bytes sent
+static u_int64_t drive(gquic_packet_pacer_t *const pacer, const u_int64_t rate, u_int64_t *const max_burst, u_int64_t *const odd_batches) {
+    u_int64_t now = 0;
+    u_int64_t sent = 0;
+    u_int64_t count = 0;
+    u_int64_t i = 0;
+    u_int64_t next = 0;
+    *max_burst = 0;
+    *odd_batches = 0;
+    while (now < DURATION) {
+        count = gquic_packet_pacer_allowed_packets(pacer, rate, now);
+        if (count * MSS > *max_burst) {
+            *max_burst = count * MSS;
+        }
+        if (count % pacer->gso_segments != 0) {
+            (*odd_batches)++;
+        }
+        for (i = 0; i < count; i++) {
+            gquic_packet_pacer_sent_packet(pacer, rate, now, MSS);
+            sent += MSS;
+        }
+        if ((next = gquic_packet_pacer_next_release(pacer, rate, now)) == 0 || next <= now) {
+            printf("pacer did not arm its timer at %lu\n", now);
+            return 0;
+        }
+        now = next;
+    }
+    return sent;
+}
+
+int main() {
+    gquic_packet_pacer_t pacer;
+    u_int64_t sent = 0;
+    u_int64_t max_burst = 0;
+    u_int64_t odd_batches = 0;
+
+    gquic_packet_pacer_init(&pacer);
+    gquic_packet_pacer_ctor(&pacer, MSS, 0, 0);
+    sent = drive(&pacer, RATE, &max_burst, &odd_batches);
+    // the initial burst on top of one second at the rate
+    if (sent < (u_int64_t) RATE * 99 / 100 || sent > (u_int64_t) RATE * 101 / 100 + gquic_packet_pacer_max_burst(&pacer, RATE)) {
+        printf("paced %lu bytes in one second\n", sent);
+        return -1;
+    }
+    if (max_burst > gquic_packet_pacer_max_burst(&pacer, RATE)) {
+        printf("burst %lu above the quantum\n", max_burst);
+        return -1;
+    }
+
+    // with GSO the timer only fires for whole batches
+    gquic_packet_pacer_init(&pacer);
+    gquic_packet_pacer_ctor(&pacer, MSS, 20, 8);
+    sent = drive(&pacer, RATE, &max_burst, &odd_batches);
+    if (odd_batches != 0 || sent < (u_int64_t) RATE * 99 / 100) {
+        printf("gso paced %lu bytes, %lu partial batches\n", sent, odd_batches);
+        return -1;
+    }
+    if (gquic_packet_pacer_max_burst(&pacer, RATE) % (8 * MSS) != 0 || max_burst > gquic_packet_pacer_max_burst(&pacer, RATE)) {
+        printf("gso burst %lu\n", max_burst);
+        return -1;
+    }
+
+    // no rate from the controller yet, only the window limits sending
+    if (gquic_packet_pacer_next_release(&pacer, 0, 0) != 0 || gquic_packet_pacer_allowed_packets(&pacer, 0, 0) == 0) {
+        printf("unpaced sender held back\n");
+        return -1;
+    }
+    // with SO_TXTIME a whole window is stamped in one go, spaced at the rate
+    gquic_packet_pacer_init(&pacer);
+    gquic_packet_pacer_ctor(&pacer, MSS, 0, 0);
+    {
+        u_int64_t departure = 0;
+        u_int64_t first = 0;
+        u_int64_t i = 0;
+        for (i = 0; i < 1000; i++) {
+            departure = gquic_packet_pacer_departure_time(&pacer, RATE, 0, MSS);
+            if (i == GQUIC_PACKET_PACER_DEFAULT_BURST_PACKETS) {
+                first = departure;
+            }
+            if (i < GQUIC_PACKET_PACER_DEFAULT_BURST_PACKETS && departure != 0) {
+                printf("packet %lu of the initial burst held until %lu\n", i, departure);
+                return -1;
+            }
+            gquic_packet_pacer_sent_packet(&pacer, RATE, departure, MSS);
+        }
+        // 990 more packets at 116.8 us each
+        if (first == 0 || departure < (u_int64_t) 990 * MSS * 1000 * 1000 / RATE || departure > (u_int64_t) 991 * MSS * 1000 * 1000 / RATE) {
+            printf("window of 1000 packets stamped over %lu us\n", departure);
+            return -1;
+        }
+    }
+    printf("pacer ok\n");
+    return 0;
+}
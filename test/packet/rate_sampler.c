@@ -0,0 +1,89 @@
+#include "packet/rate_sampler.h"
+#include <stdio.h>
+
+#define MSS 1460
+#define RTT (50 * 1000)
+#define STEADY 1000
+#define COMPRESSED 1000
+#define APP_LIMITED 200
+#define PACKETS (STEADY + COMPRESSED + APP_LIMITED)
+
+static gquic_packet_t packets[PACKETS];
+static u_int64_t ack_time[PACKETS];
+
+int main() {
+    gquic_packet_rate_sampler_t sampler;
+    gquic_packet_rate_sample_t sample;
+    gquic_packet_rate_stats_t stats;
+    u_int64_t infly = 0;
+    u_int64_t now = 0;
+    u_int64_t sent = 0;
+    u_int64_t acked = 0;
+    u_int64_t send_time = 0;
+    u_int64_t max_compressed = 0;
+    const u_int64_t link_rate = MSS * 1000;
+
+    gquic_packet_rate_sampler_init(&sampler);
+    gquic_packet_rate_sample_init(&sample);
+    for (now = 0; acked < PACKETS; now += 1000) {
+        if (acked < sent && ack_time[acked] == now) {
+            while (acked < sent && ack_time[acked] == now) {
+                gquic_packet_rate_sampler_on_packet_acked(&sampler, &packets[acked++], now);
+                infly -= MSS;
+            }
+            gquic_packet_rate_sampler_generate(&sample, &sampler, RTT);
+            if (acked > STEADY && acked <= STEADY + COMPRESSED && sample.delivery_rate > max_compressed) {
+                max_compressed = sample.delivery_rate;
+            }
+            if (acked == STEADY) {
+                // one packet per ms over the whole flight
+                if (sample.delivery_rate < link_rate * 98 / 100 || sample.delivery_rate > link_rate * 102 / 100 || sample.is_app_limited) {
+                    printf("steady rate %lu\n", sample.delivery_rate);
+                    return -1;
+                }
+            }
+        }
+        // the app keeps running out of data, as the session reports whenever the window is left open
+        if (sent >= STEADY + COMPRESSED) {
+            gquic_packet_rate_sampler_on_app_limited(&sampler, infly);
+        }
+        // the app limited phase sends a packet every 4 ms
+        if (sent < PACKETS && (sent < STEADY + COMPRESSED || now >= send_time + 4000)) {
+            gquic_packet_init(&packets[sent]);
+            packets[sent].pn = sent;
+            packets[sent].len = MSS;
+            packets[sent].send_time = now;
+            gquic_packet_rate_sampler_on_packet_sent(&sampler, &packets[sent], infly);
+            infly += MSS;
+            ack_time[sent] = now + RTT;
+            // acks for the middle phase arrive ten at a time
+            if (sent >= STEADY && sent < STEADY + COMPRESSED) {
+                ack_time[sent] = now - (sent - STEADY) % 10 * 1000 + 9000 + RTT;
+            }
+            send_time = now;
+            sent++;
+        }
+    }
+
+    // a burst of acks delivers fast, but the packets were not sent any faster
+    if (max_compressed > link_rate * 102 / 100) {
+        printf("compressed acks rate %lu\n", max_compressed);
+        return -1;
+    }
+    if (!sample.is_app_limited || sample.delivery_rate > link_rate / 3) {
+        printf("app limited rate %lu flag %d\n", sample.delivery_rate, sample.is_app_limited);
+        return -1;
+    }
+    gquic_packet_rate_sampler_stats(&stats, &sampler);
+    // the slow samples were app limited, they do not pull the bandwidth down
+    if (stats.bandwidth < link_rate * 98 / 100 || stats.bandwidth > link_rate * 102 / 100) {
+        printf("bandwidth %lu\n", stats.bandwidth);
+        return -1;
+    }
+    if (stats.delivered != PACKETS * MSS || stats.app_limited_samples == 0 || stats.samples <= stats.app_limited_samples) {
+        printf("delivered %lu samples %lu app limited %lu\n", stats.delivered, stats.samples, stats.app_limited_samples);
+        return -1;
+    }
+    printf("rate sampler ok, bandwidth %lu bytes/s over %lu rounds\n", stats.bandwidth, stats.round_count);
+    return 0;
+}
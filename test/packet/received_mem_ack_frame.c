@@ -0,0 +1,66 @@
+#include "packet/received_packet_handler.h"
+#include "frame/meta.h"
+#include <stdio.h>
+
+int main() {
+    gquic_packet_received_mem_t mem;
+    u_int64_t pn = 0;
+    u_int64_t i = 0;
+    gquic_packet_received_mem_init(&mem);
+    for (pn = 0; pn < 10; pn++) {
+        gquic_packet_reveived_mem_received(&mem, pn);
+    }
+    gquic_packet_reveived_mem_received(&mem, 12);
+    for (pn = 14; pn <= 20; pn++) {
+        gquic_packet_reveived_mem_received(&mem, pn);
+    }
+    gquic_packet_reveived_mem_received(&mem, 400);
+    gquic_packet_reveived_mem_received(&mem, 398);
+    gquic_packet_reveived_mem_received(&mem, 13);
+
+    gquic_frame_ack_t *ack = gquic_frame_ack_alloc();
+    if (ack == NULL) {
+        return -1;
+    }
+    GQUIC_FRAME_INIT(ack);
+    gquic_packet_received_mem_fill_ack_frame(ack, &mem);
+
+    printf("%lu %lu %lu ", ack->largest_ack, ack->first_range, ack->count);
+    for (i = 0; i < ack->count; i++) {
+        printf("%lu %lu ", ack->ranges[i].gap, ack->ranges[i].range);
+    }
+    printf("\n");
+    if (ack->largest_ack != 400 || ack->first_range != 0 || ack->count != 3
+        || ack->ranges[0].gap != 0 || ack->ranges[0].range != 0
+        || ack->ranges[1].gap != 376 || ack->ranges[1].range != 8
+        || ack->ranges[2].gap != 1 || ack->ranges[2].range != 9) {
+        printf("unexpected ack ranges\n");
+        return -1;
+    }
+
+    gquic_frame_release(ack);
+
+    // a gap too large for an int between the largest packet and the deleted bound
+    gquic_packet_received_mem_init(&mem);
+    gquic_packet_reveived_mem_received(&mem, (1UL << 32) + 100);
+    gquic_packet_reveived_mem_received(&mem, (1UL << 32) + 99);
+    gquic_packet_received_mem_delete_below(&mem, 100);
+    if (!gquic_packet_received_mem_contains(&mem, (1UL << 32) + 99)
+        || gquic_packet_received_mem_highest_range_start(&mem) != (1UL << 32) + 99) {
+        printf("packet below the largest lost by delete_below\n");
+        return -1;
+    }
+
+    // every other packet missing, far more gaps than the window holds
+    gquic_packet_received_mem_init(&mem);
+    for (pn = 0; pn < 2 * 400 + GQUIC_PACKET_RECEIVED_MEM_WINDOW; pn += 2) {
+        gquic_packet_reveived_mem_received(&mem, pn);
+    }
+    for (pn = 0; pn < 2 * 400; pn += 2) {
+        if (!gquic_packet_received_mem_contains(&mem, pn) || gquic_packet_received_mem_contains(&mem, pn + 1)) {
+            printf("packet %lu forgotten with %d intervals\n", pn, mem.intervals_count);
+            return -1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+#include "packet/retry_policy.h"
+#include "packet/long_header_packet.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ROUNDS 100000
+
+static double wall() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static const gquic_str_t cli_dcid = { 8, "\x11\x12\x13\x14\x15\x16\x17\x18" };
+static const gquic_str_t cli_scid = { 4, "\x21\x22\x23\x24" };
+
+/* RFC 9001, A.4 */
+static const gquic_str_t vector_odcid = { 8, "\x83\x94\xc8\xf0\x3e\x51\x57\x08" };
+static const gquic_str_t vector_retry = { 36,
+    "\xff\x00\x00\x00\x01\x00\x08\xf0\x67\xa5\x50\x2a\x42\x62\xb5\x74\x6f\x6b\x65\x6e"
+    "\x04\xa2\x65\xba\x2e\xff\x4d\x82\x90\x58\xfb\x3f\x0f\x24\x96\xba" };
+
+// checks the tag a Retry ends with against the destination conn ID of the Initial
+static int verify_tag(const gquic_str_t *const packet, const gquic_version_t version, const gquic_str_t *const odcid) {
+    u_int8_t tag[GQUIC_PACKET_RETRY_TAG_SIZE];
+    gquic_str_t retry = { GQUIC_STR_SIZE(packet) - GQUIC_PACKET_RETRY_TAG_SIZE, GQUIC_STR_VAL(packet) };
+    if (gquic_packet_retry_integrity_tag(tag, version, odcid, &retry) != 0) {
+        return -1;
+    }
+    return memcmp(tag, GQUIC_STR_VAL(packet) + GQUIC_STR_SIZE(&retry), GQUIC_PACKET_RETRY_TAG_SIZE) == 0 ? 0 : -2;
+}
+
+static int initial(gquic_str_t *const packet, const gquic_str_t *const dcid, const gquic_str_t *const token) {
+    gquic_packet_long_header_t *header = gquic_packet_long_header_alloc();
+    gquic_packet_initial_header_t *initial_header = GQUIC_LONG_HEADER_SPEC(header);
+    gquic_writer_str_t writer;
+    header->flag = 0xc0 | 0x03;
+    header->version = GQUIC_VERSION_DRAFT_27;
+    header->dcid_len = GQUIC_STR_SIZE(dcid);
+    memcpy(header->dcid, GQUIC_STR_VAL(dcid), GQUIC_STR_SIZE(dcid));
+    header->scid_len = GQUIC_STR_SIZE(&cli_scid);
+    memcpy(header->scid, GQUIC_STR_VAL(&cli_scid), GQUIC_STR_SIZE(&cli_scid));
+    initial_header->token_len = GQUIC_STR_SIZE(token);
+    initial_header->token = NULL;
+    if (GQUIC_STR_SIZE(token) != 0) {
+        initial_header->token = malloc(GQUIC_STR_SIZE(token));
+        memcpy(initial_header->token, GQUIC_STR_VAL(token), GQUIC_STR_SIZE(token));
+    }
+    initial_header->len = 1200;
+    initial_header->pn = 0;
+    gquic_str_alloc(packet, gquic_packet_long_header_size(header) + 1200);
+    memset(GQUIC_STR_VAL(packet), 0, GQUIC_STR_SIZE(packet));
+    writer = *packet;
+    gquic_packet_long_header_serialize(header, &writer);
+    gquic_packet_long_header_release(header);
+    return 0;
+}
+
+int main() {
+    u_int8_t secret[GQUIC_HANDSHAKE_TOKEN_SECRET_SIZE];
+    gquic_handshake_token_generator_t gen;
+    gquic_packet_retry_policy_t policy;
+    gquic_packet_retry_decision_t decision;
+    gquic_packet_long_header_t *retry = NULL;
+    gquic_net_addr_t addr;
+    gquic_str_t packet = { 0, NULL };
+    gquic_str_t token = { 0, NULL };
+    gquic_reader_str_t reader;
+    u_int64_t now = 1700000000UL * 1000 * 1000;
+    double start;
+    int i;
+
+    memset(secret, 7, sizeof(secret));
+    gquic_handshake_token_generator_init(&gen);
+    gquic_handshake_token_generator_ctor(&gen, secret);
+    gquic_packet_retry_policy_init(&policy);
+    gquic_packet_retry_policy_ctor(&policy, &gen, 8, 2, 0);
+    gquic_net_addr_init(&addr);
+    gquic_net_str_to_addr_v4(&addr, "198.51.100.7");
+
+    if (verify_tag(&vector_retry, GQUIC_VERSION_1, &vector_odcid) != 0) {
+        printf("retry integrity tag does not match RFC 9001\n");
+        return -1;
+    }
+    initial(&packet, &cli_dcid, &token);
+
+    // idle: every Initial gets a session
+    gquic_packet_retry_decision_init(&decision);
+    if (gquic_packet_retry_policy_on_initial(&decision, &policy, &packet, &addr, now) != GQUIC_PACKET_RETRY_POLICY_ACCEPT
+        || GQUIC_STR_SIZE(&decision.odcid) != 0) {
+        printf("idle server retried\n");
+        return -1;
+    }
+    gquic_packet_retry_decision_dtor(&decision);
+
+    // two half-open sessions reach the limit, the next client is retried
+    gquic_packet_retry_policy_handshake_started(&policy);
+    gquic_packet_retry_policy_handshake_started(&policy);
+    gquic_packet_retry_decision_init(&decision);
+    if (gquic_packet_retry_policy_on_initial(&decision, &policy, &packet, &addr, now) != GQUIC_PACKET_RETRY_POLICY_RETRY) {
+        printf("loaded server accepted\n");
+        return -1;
+    }
+    retry = gquic_packet_long_header_alloc();
+    reader = decision.packet;
+    if (gquic_packet_long_header_deserialize(retry, &reader) != 0 || gquic_packet_long_header_type(retry) != GQUIC_LONG_HEADER_RETRY) {
+        printf("bad retry packet\n");
+        return -1;
+    }
+    gquic_str_t dcid = { retry->dcid_len, retry->dcid };
+    gquic_str_t scid = { retry->scid_len, retry->scid };
+    if (gquic_str_cmp(&dcid, &cli_scid) != 0 || retry->scid_len != 8) {
+        printf("retry conn IDs do not match\n");
+        return -1;
+    }
+    // only the client whose Initial went to cli_dcid takes it
+    if (verify_tag(&decision.packet, GQUIC_VERSION_DRAFT_27, &cli_dcid) != 0
+        || verify_tag(&decision.packet, GQUIC_VERSION_DRAFT_27, &cli_scid) == 0
+        || memcmp(((gquic_packet_retry_header_t *) GQUIC_LONG_HEADER_SPEC(retry))->tag,
+                  GQUIC_STR_VAL(&decision.packet) + GQUIC_STR_SIZE(&decision.packet) - GQUIC_PACKET_RETRY_TAG_SIZE,
+                  GQUIC_PACKET_RETRY_TAG_SIZE) != 0) {
+        printf("bad retry integrity tag\n");
+        return -1;
+    }
+    gquic_str_copy(&token, &reader);
+    gquic_str_reset(&packet);
+    gquic_packet_retry_decision_dtor(&decision);
+
+    // the client comes back with the token: let in, and the original dcid is recovered
+    initial(&packet, &scid, &token);
+    gquic_packet_retry_decision_init(&decision);
+    if (gquic_packet_retry_policy_on_initial(&decision, &policy, &packet, &addr, now + 1000) != GQUIC_PACKET_RETRY_POLICY_ACCEPT
+        || gquic_str_cmp(&decision.odcid, &cli_dcid) != 0) {
+        printf("retried client rejected\n");
+        return -1;
+    }
+    gquic_packet_retry_decision_dtor(&decision);
+    free(retry);
+    gquic_str_reset(&packet);
+    gquic_str_reset(&token);
+
+    // a spoofed flood costs one token per Initial
+    initial(&packet, &cli_dcid, &token);
+    start = wall();
+    for (i = 0; i < ROUNDS; i++) {
+        gquic_packet_retry_decision_init(&decision);
+        gquic_packet_retry_policy_on_initial(&decision, &policy, &packet, &addr, now);
+        gquic_packet_retry_decision_dtor(&decision);
+    }
+    printf("%.0f Retry/s\n", ROUNDS / (wall() - start));
+
+    // below 3/4 of the limit sessions are created right away again
+    gquic_packet_retry_policy_handshake_finished(&policy);
+    gquic_packet_retry_decision_init(&decision);
+    if (gquic_packet_retry_policy_on_initial(&decision, &policy, &packet, &addr, now) != GQUIC_PACKET_RETRY_POLICY_ACCEPT) {
+        printf("recovered server retried\n");
+        return -1;
+    }
+    gquic_packet_retry_decision_dtor(&decision);
+    if (policy.retries != ROUNDS + 1 || policy.retried_accepted != 1) {
+        printf("retries %lu retried accepted %lu\n", policy.retries, policy.retried_accepted);
+        return -1;
+    }
+
+    gquic_str_reset(&packet);
+    gquic_packet_retry_policy_dtor(&policy);
+    gquic_handshake_token_generator_dtor(&gen);
+    printf("retry policy ok\n");
+    return 0;
+}
@@ -0,0 +1,213 @@
+#include "packet/sent_packet_handler.h"
+#include "frame/max_data.h"
+#include "packet/send_mode.h"
+#include "tls/common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <malloc.h>
+#include <time.h>
+
+// 10 Gbit/s at 100 ms rtt keeps about 86k full sized packets in flight
+#define MSS 1460
+#define LINK_RATE (10ull * 1000 * 1000 * 1000 / 8)
+#define PROP_RTT (100 * 1000)
+#define BDP (LINK_RATE * PROP_RTT / (1000 * 1000))
+#define START (1000 * 1000)
+#define DURATION (3 * 1000 * 1000)
+// the window stops a little above the BDP, so the link stays busy without a growing queue
+#define MAX_CWND (BDP * 6 / 5)
+#define ACK_EVERY 2
+#define MAX_ACKS (1 << 21)
+// a few losses once the window is full
+#define LOSS_FROM (START + 2500 * 1000)
+#define LOSS_EVERY 20000
+
+typedef struct ack_s ack_t;
+struct ack_s {
+    u_int64_t time;
+    u_int64_t pn[ACK_EVERY];
+    int count;
+};
+
+static ack_t acks[MAX_ACKS];
+static ack_t pending;
+
+static double wall() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static gquic_packet_t *packet_alloc(const u_int64_t pn, const u_int64_t now) {
+    gquic_packet_t *packet = malloc(sizeof(gquic_packet_t));
+    void **frame = NULL;
+    gquic_packet_init(packet);
+    packet->pn = pn;
+    packet->len = MSS;
+    packet->enc_lv = GQUIC_ENC_LV_1RTT;
+    packet->send_time = now;
+    packet->frames = malloc(sizeof(gquic_list_t));
+    gquic_list_head_init(packet->frames);
+    frame = gquic_list_alloc(sizeof(void *));
+    *frame = gquic_frame_max_data_alloc();
+    gquic_list_insert_before(packet->frames, frame);
+    return packet;
+}
+
+static void ack_frame(gquic_frame_ack_t *const frame, const ack_t *const ack) {
+    int i = 0;
+    frame->largest_ack = ack->pn[ack->count - 1];
+    frame->delay = 0;
+    frame->first_range = 0;
+    frame->count = 0;
+    for (i = ack->count - 2; i >= 0; i--) {
+        if (ack->pn[i] + 1 == ack->pn[i + 1]) {
+            if (frame->count == 0) {
+                frame->first_range++;
+            }
+            else {
+                frame->ranges[frame->count - 1].range++;
+            }
+        }
+        else {
+            // the next range starts below a skipped packet number
+            frame->ranges[frame->count].gap = ack->pn[i + 1] - ack->pn[i] - 2;
+            frame->ranges[frame->count].range = 0;
+            frame->count++;
+        }
+    }
+}
+
+int main() {
+    gquic_packet_sent_packet_handler_t handler;
+    gquic_rtt_t rtt;
+    gquic_frame_ack_t frame;
+    u_int64_t now = START;
+    // ns, a packet takes 1.168 us on the wire
+    u_int64_t link_free = START * 1000ull;
+    u_int64_t ack_head = 0;
+    u_int64_t ack_tail = 0;
+    u_int64_t pn = 0;
+    u_int64_t sent = 0;
+    u_int64_t acked_bytes = 0;
+    u_int64_t goodput_from = 0;
+    u_int64_t goodput_bytes = 0;
+    u_int64_t max_tracked = 0;
+    // heap in use before the first packet and at the most packets tracked
+    size_t heap_base = 0;
+    size_t heap_peak = 0;
+    u_int64_t heap_tracked = 0;
+    u_int64_t small_ops = 0;
+    u_int64_t large_ops = 0;
+    double small_time = 0;
+    double large_time = 0;
+    double begin = 0;
+    double cost = 0;
+
+    gquic_rtt_init(&rtt);
+    gquic_packet_sent_packet_handler_init(&handler);
+    gquic_packet_sent_packet_handler_ctor(&handler, 0, &rtt, GQUIC_CONG_CUBIC, MAX_CWND, NULL, NULL);
+    gquic_packet_sent_packet_handler_set_peer_addr_validated(&handler);
+    gquic_packet_sent_packet_handler_drop_packets(&handler, GQUIC_ENC_LV_INITIAL);
+    gquic_packet_sent_packet_handler_drop_packets(&handler, GQUIC_ENC_LV_HANDSHAKE);
+    gquic_packet_sent_packet_handler_set_handshake_complete(&handler);
+    heap_base = mallinfo2().uordblks;
+
+    while (now < START + DURATION) {
+        begin = wall();
+        // the link serialises one packet at a time, acks come back one rtt later
+        if (ack_head != ack_tail && (acks[ack_head].time <= link_free / 1000
+                                     || gquic_packet_sent_packet_handler_send_mode(&handler) != GQUIC_SEND_MODE_ANY)) {
+            now = acks[ack_head].time;
+            ack_frame(&frame, &acks[ack_head]);
+            acked_bytes += acks[ack_head].count * MSS;
+            if (goodput_from != 0 && now >= goodput_from && now < LOSS_FROM) {
+                goodput_bytes += acks[ack_head].count * MSS;
+            }
+            if (gquic_packet_sent_packet_handler_received_ack(&handler, &frame, GQUIC_ENC_LV_1RTT, now) != 0) {
+                printf("ack of %lu rejected\n", frame.largest_ack);
+                return -1;
+            }
+            ack_head = (ack_head + 1) % MAX_ACKS;
+        }
+        else if (gquic_packet_sent_packet_handler_allowable_packets_count(&handler, MSS) != 0) {
+            now = link_free / 1000 > now ? link_free / 1000 : now;
+            gquic_packet_sent_packet_handler_pop_pn(&pn, &handler, GQUIC_ENC_LV_1RTT);
+            gquic_packet_sent_packet_handler_sent_packet(&handler, packet_alloc(pn, now));
+            sent++;
+            link_free = (link_free > now * 1000 ? link_free : now * 1000) + MSS * 1000ull * 1000 * 1000 / LINK_RATE;
+            if (now < LOSS_FROM || sent % LOSS_EVERY != 0) {
+                pending.pn[pending.count++] = pn;
+                pending.time = link_free / 1000 + PROP_RTT;
+            }
+            if (pending.count == ACK_EVERY) {
+                acks[ack_tail] = pending;
+                ack_tail = (ack_tail + 1) % MAX_ACKS;
+                pending.count = 0;
+            }
+        }
+        else if (pending.count != 0) {
+            // the receiver's ack delay timer
+            pending.time += 1000;
+            acks[ack_tail] = pending;
+            ack_tail = (ack_tail + 1) % MAX_ACKS;
+            pending.count = 0;
+            continue;
+        }
+        else {
+            printf("stalled at %lu with %lu packets tracked\n", now, handler.one_rtt_packets->mem.count);
+            return -1;
+        }
+        cost = wall() - begin;
+
+        if (handler.one_rtt_packets->mem.count > max_tracked) {
+            max_tracked = handler.one_rtt_packets->mem.count;
+            // the record, its frame list and ring slot of every tracked packet, measured
+            if (max_tracked % 1024 == 0) {
+                heap_peak = mallinfo2().uordblks;
+                heap_tracked = max_tracked;
+            }
+        }
+        if (handler.one_rtt_packets->mem.count < 1000) {
+            small_time += cost;
+            small_ops++;
+        }
+        else if (handler.one_rtt_packets->mem.count >= BDP / MSS / 2) {
+            large_time += cost;
+            large_ops++;
+        }
+        if (goodput_from == 0 && handler.infly_bytes >= BDP) {
+            goodput_from = now + PROP_RTT;
+        }
+    }
+
+    printf("10 Gbit/s x 100 ms: %lu packets sent, %lu tracked at most, %.0f ns per event below 1000 tracked, %.0f ns above %llu\n",
+           sent, max_tracked, small_time / small_ops * 1e9, large_time / large_ops * 1e9, BDP / MSS / 2);
+    printf("goodput %lu Mbit/s\n", goodput_bytes * 8 / (LOSS_FROM - goodput_from));
+    printf("per tracked packet: ring %lu bytes, record %lu, frame list %lu + %lu per frame, %lu bytes of heap measured with one frame\n",
+           handler.one_rtt_packets->mem.cap * sizeof(gquic_packet_t *) / max_tracked,
+           sizeof(gquic_packet_t),
+           sizeof(gquic_list_t),
+           sizeof(gquic_list_t) + sizeof(void *),
+           heap_tracked != 0 && heap_peak > heap_base ? (heap_peak - heap_base) / heap_tracked : 0);
+    // no fixed cap, the whole BDP is in flight
+    if (max_tracked < BDP / MSS) {
+        printf("in flight capped at %lu packets\n", max_tracked);
+        return -1;
+    }
+    if (goodput_from == 0 || goodput_bytes * 8 / (LOSS_FROM - goodput_from) < LINK_RATE * 8 / (1000 * 1000) * 9 / 10) {
+        printf("link not filled\n");
+        return -1;
+    }
+    if (handler.one_rtt_packets->mem.cap * sizeof(gquic_packet_t *) > 4 * max_tracked * sizeof(gquic_packet_t *)) {
+        printf("ring of %lu slots\n", handler.one_rtt_packets->mem.cap);
+        return -1;
+    }
+    // per packet work stays flat from a few packets to a full 10G window
+    if (large_time / large_ops > 8 * small_time / small_ops) {
+        printf("processing degrades with the window\n");
+        return -1;
+    }
+    gquic_packet_sent_packet_handler_dtor(&handler);
+    return 0;
+}
@@ -0,0 +1,149 @@
+#include "packet/sent_packet_handler.h"
+#include "frame/max_data.h"
+#include "packet/send_mode.h"
+#include "tls/common.h"
+#include <stdio.h>
+#include <malloc.h>
+
+// 100 Mbit/s, 20 ms rtt, every 50th packet overtaken by the 8 packets behind it
+#define MSS 1460
+#define LINK_RATE (100 * 1000 * 1000 / 8)
+#define PROP_RTT (20 * 1000)
+#define BDP ((u_int64_t) LINK_RATE * PROP_RTT / (1000 * 1000))
+#define REORDER_EVERY 50
+#define REORDER_DELAY 1000
+#define DURATION (2 * 1000 * 1000)
+#define MAX_ACKS (1 << 16)
+
+typedef struct ack_queue_s ack_queue_t;
+struct ack_queue_s {
+    u_int64_t time[MAX_ACKS];
+    u_int64_t pn[MAX_ACKS];
+    u_int64_t head;
+    u_int64_t tail;
+};
+
+static ack_queue_t in_order;
+static ack_queue_t reordered;
+static u_int64_t lost_count = 0;
+static u_int64_t last_loss_time = 0;
+
+static int on_event(void *const self, gquic_event_t *const event) {
+    (void) self;
+    if (event->type == GQUIC_EVENT_PACKET_LOST) {
+        lost_count++;
+        last_loss_time = event->time;
+    }
+    return 0;
+}
+
+static gquic_packet_t *packet_alloc(const u_int64_t pn, const u_int64_t now) {
+    gquic_packet_t *packet = malloc(sizeof(gquic_packet_t));
+    void **frame = NULL;
+    gquic_packet_init(packet);
+    packet->pn = pn;
+    packet->len = MSS;
+    packet->enc_lv = GQUIC_ENC_LV_1RTT;
+    packet->send_time = now;
+    packet->frames = malloc(sizeof(gquic_list_t));
+    gquic_list_head_init(packet->frames);
+    frame = gquic_list_alloc(sizeof(void *));
+    *frame = gquic_frame_max_data_alloc();
+    gquic_list_insert_before(packet->frames, frame);
+    return packet;
+}
+
+static void push(ack_queue_t *const queue, const u_int64_t pn, const u_int64_t time) {
+    queue->pn[queue->tail % MAX_ACKS] = pn;
+    queue->time[queue->tail % MAX_ACKS] = time;
+    queue->tail++;
+}
+
+int main() {
+    gquic_packet_sent_packet_handler_t handler;
+    gquic_rtt_t rtt;
+    gquic_frame_ack_t frame;
+    ack_queue_t *queue = NULL;
+    u_int64_t now = 0;
+    u_int64_t link_free = 0;
+    u_int64_t pn = 0;
+    u_int64_t sent = 0;
+    u_int64_t cwnd_before_loss = 0;
+    int had_loss = 0;
+
+    gquic_rtt_init(&rtt);
+    gquic_packet_sent_packet_handler_init(&handler);
+    gquic_packet_sent_packet_handler_ctor(&handler, 0, &rtt, GQUIC_CONG_CUBIC, 2 * BDP, &handler, on_event);
+    gquic_packet_sent_packet_handler_set_peer_addr_validated(&handler);
+    gquic_packet_sent_packet_handler_drop_packets(&handler, GQUIC_ENC_LV_INITIAL);
+    gquic_packet_sent_packet_handler_drop_packets(&handler, GQUIC_ENC_LV_HANDSHAKE);
+    gquic_packet_sent_packet_handler_set_handshake_complete(&handler);
+    // a skipped packet number would make some reorderings one packet deeper than others
+    handler.one_rtt_packets->pn_gen.skip = (u_int64_t) -1;
+
+    while (now < DURATION) {
+        queue = NULL;
+        if (in_order.head != in_order.tail) {
+            queue = &in_order;
+        }
+        if (reordered.head != reordered.tail
+            && (queue == NULL || reordered.time[reordered.head % MAX_ACKS] < queue->time[queue->head % MAX_ACKS])) {
+            queue = &reordered;
+        }
+        if (queue != NULL && (queue->time[queue->head % MAX_ACKS] <= link_free
+                              || gquic_packet_sent_packet_handler_allowable_packets_count(&handler, MSS) == 0)) {
+            // every packet is acked on its own, as it arrives
+            now = queue->time[queue->head % MAX_ACKS];
+            frame.largest_ack = queue->pn[queue->head % MAX_ACKS];
+            frame.delay = 0;
+            frame.first_range = 0;
+            frame.count = 0;
+            queue->head++;
+            if (gquic_packet_sent_packet_handler_received_ack(&handler, &frame, GQUIC_ENC_LV_1RTT, now) != 0) {
+                printf("ack of %lu rejected\n", frame.largest_ack);
+                return -1;
+            }
+        }
+        else if (gquic_packet_sent_packet_handler_allowable_packets_count(&handler, MSS) != 0) {
+            now = link_free > now ? link_free : now;
+            if (!had_loss) {
+                cwnd_before_loss = GQUIC_CONG_CWND(&handler.cong);
+            }
+            gquic_packet_sent_packet_handler_pop_pn(&pn, &handler, GQUIC_ENC_LV_1RTT);
+            gquic_packet_sent_packet_handler_sent_packet(&handler, packet_alloc(pn, now));
+            link_free = now + MSS * 1000 * 1000 / LINK_RATE;
+            if (++sent % REORDER_EVERY == 0) {
+                push(&reordered, pn, link_free + PROP_RTT + REORDER_DELAY);
+            }
+            else {
+                push(&in_order, pn, link_free + PROP_RTT);
+            }
+        }
+        else {
+            printf("stalled at %lu\n", now);
+            return -1;
+        }
+        had_loss = had_loss || lost_count != 0;
+    }
+
+    printf("%lu packets sent, %lu declared lost, %lu spurious, reordering threshold %lu packets, time threshold rtt + rtt >> %u\n",
+           sent, lost_count, handler.spurious_losses, handler.reordering_threshold, handler.reordering_shift);
+    printf("cwnd %lu before the first loss, %lu at the end\n", cwnd_before_loss, GQUIC_CONG_CWND(&handler.cong));
+    // nothing was dropped, every loss was reordering and was found out
+    if (lost_count == 0 || handler.spurious_losses != lost_count) {
+        printf("spurious losses not detected\n");
+        return -1;
+    }
+    // the threshold covers the reordering after the first one
+    if (handler.reordering_threshold <= GQUIC_PACKET_SENT_PACKET_HANDLER_PACKET_THRESHOLD || last_loss_time > DURATION / 4) {
+        printf("reordering still declared lost at %lu\n", last_loss_time);
+        return -1;
+    }
+    // the cut was undone
+    if (GQUIC_CONG_CWND(&handler.cong) < cwnd_before_loss || GQUIC_CONG_IN_RECOVERY(&handler.cong)) {
+        printf("cwnd not restored\n");
+        return -1;
+    }
+    gquic_packet_sent_packet_handler_dtor(&handler);
+    return 0;
+}
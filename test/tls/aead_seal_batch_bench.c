@@ -0,0 +1,110 @@
+#include "tls/cipher_suite.h"
+#include "../tls/cipher_suite.c"
+#include <stdio.h>
+#include <time.h>
+
+#define PACKET_SIZE 1200
+#define PACKETS (1 << 18)
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static u_int8_t packets[GQUIC_TLS_AEAD_MAX_BATCH][PACKET_SIZE + GQUIC_TLS_AEAD_TAG_SIZE];
+static u_int8_t ref_packets[GQUIC_TLS_AEAD_MAX_BATCH][PACKET_SIZE + GQUIC_TLS_AEAD_TAG_SIZE];
+static u_int64_t pns[GQUIC_TLS_AEAD_MAX_BATCH];
+
+int main() {
+    static const size_t bursts[] = { 1, 8, 32, 64 };
+    gquic_tls_aead_t aead;
+    gquic_str_t key = { 0, NULL };
+    gquic_str_t base = { 0, NULL };
+    u_int8_t header[20];
+    gquic_str_t texts[GQUIC_TLS_AEAD_MAX_BATCH];
+    gquic_str_t tags[GQUIC_TLS_AEAD_MAX_BATCH];
+    gquic_str_t nonces[GQUIC_TLS_AEAD_MAX_BATCH];
+    gquic_str_t addatas[GQUIC_TLS_AEAD_MAX_BATCH];
+    double start = 0;
+    double single = 0;
+    double batched = 0;
+    size_t burst = 0;
+    size_t i = 0;
+    size_t j = 0;
+    u_int64_t pn = 0;
+
+    gquic_str_alloc(&key, 16);
+    gquic_str_alloc(&base, 12);
+    for (i = 0; i < 16; i++) {
+        ((u_int8_t *) GQUIC_STR_VAL(&key))[i] = i;
+    }
+    for (i = 0; i < 12; i++) {
+        ((u_int8_t *) GQUIC_STR_VAL(&base))[i] = 0xf0 | i;
+    }
+    memset(header, 0xa5, sizeof(header));
+
+    gquic_tls_aead_init(&aead);
+    if (aead_aes_gcm_init_xor(&aead, &key, &base) != 0) {
+        return -1;
+    }
+
+    for (i = 0; i < GQUIC_TLS_AEAD_MAX_BATCH; i++) {
+        texts[i].size = PACKET_SIZE;
+        texts[i].val = packets[i];
+        tags[i].size = GQUIC_TLS_AEAD_TAG_SIZE;
+        tags[i].val = packets[i] + PACKET_SIZE;
+        nonces[i].size = sizeof(u_int64_t);
+        nonces[i].val = &pns[i];
+        addatas[i].size = sizeof(header);
+        addatas[i].val = header;
+    }
+
+    // the batch must produce exactly what sealing one packet at a time does
+    for (i = 0; i < GQUIC_TLS_AEAD_MAX_BATCH; i++) {
+        pns[i] = i * 3;
+        memset(packets[i], 0x5a ^ i, PACKET_SIZE);
+        memset(ref_packets[i], 0x5a ^ i, PACKET_SIZE);
+        gquic_str_t text = { PACKET_SIZE, ref_packets[i] };
+        gquic_str_t tag = { GQUIC_TLS_AEAD_TAG_SIZE, ref_packets[i] + PACKET_SIZE };
+        GQUIC_TLS_AEAD_SEAL(&tag, &text, &aead, &nonces[i], &addatas[i]);
+    }
+    if (GQUIC_TLS_AEAD_SEAL_BATCH(tags, texts, &aead, nonces, addatas, GQUIC_TLS_AEAD_MAX_BATCH) != 0) {
+        printf("batch seal failed\n");
+        return -1;
+    }
+    for (i = 0; i < GQUIC_TLS_AEAD_MAX_BATCH; i++) {
+        if (memcmp(packets[i], ref_packets[i], PACKET_SIZE + GQUIC_TLS_AEAD_TAG_SIZE) != 0) {
+            printf("mismatch at packet %lu\n", i);
+            return -1;
+        }
+    }
+
+    for (burst = 0; burst < sizeof(bursts) / sizeof(size_t); burst++) {
+        start = now();
+        for (pn = 0; pn < PACKETS; pn += bursts[burst]) {
+            for (j = 0; j < bursts[burst]; j++) {
+                pns[j] = pn + j;
+                GQUIC_TLS_AEAD_SEAL(&tags[j], &texts[j], &aead, &nonces[j], &addatas[j]);
+            }
+        }
+        single = now() - start;
+
+        start = now();
+        for (pn = 0; pn < PACKETS; pn += bursts[burst]) {
+            for (j = 0; j < bursts[burst]; j++) {
+                pns[j] = pn + j;
+            }
+            GQUIC_TLS_AEAD_SEAL_BATCH(tags, texts, &aead, nonces, addatas, bursts[burst]);
+        }
+        batched = now() - start;
+
+        printf("burst %2lu: single %.0f packets/s, batch %.0f packets/s\n",
+               bursts[burst], PACKETS / single, PACKETS / batched);
+    }
+
+    gquic_tls_aead_dtor(&aead);
+    gquic_str_reset(&key);
+    gquic_str_reset(&base);
+    return 0;
+}
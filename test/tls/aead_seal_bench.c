@@ -0,0 +1,116 @@
+#include "tls/cipher_suite.h"
+#include "../tls/cipher_suite.c"
+#include <stdio.h>
+#include <time.h>
+
+#define PACKET_SIZE 1200
+#define ROUNDS 200000
+
+/* the per-packet path the sealer used before contexts were kept per key */
+static int seal_per_packet(gquic_str_t *const tag,
+                           gquic_str_t *const cipher_text,
+                           const gquic_str_t *const key,
+                           const gquic_str_t *const base,
+                           const gquic_str_t *const nonce,
+                           const gquic_str_t *const plain_text,
+                           const gquic_str_t *const addata) {
+    u_int8_t iv[GQUIC_TLS_AEAD_MAX_IV_LEN];
+    EVP_CIPHER_CTX *ctx = NULL;
+    int outlen = 0;
+    int ret = 0;
+    aead_xor_nonce_wrapper(iv, base, nonce);
+    if ((ctx = EVP_CIPHER_CTX_new()) == NULL) {
+        return -1;
+    }
+    gquic_str_alloc(tag, GQUIC_TLS_AEAD_TAG_SIZE);
+    gquic_str_alloc(cipher_text, GQUIC_STR_SIZE(plain_text));
+    if (EVP_EncryptInit_ex(ctx, EVP_aes_128_gcm(), NULL, NULL, NULL) <= 0
+        || EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_IVLEN, GQUIC_STR_SIZE(base), NULL) <= 0
+        || EVP_EncryptInit_ex(ctx, NULL, NULL, GQUIC_STR_VAL(key), iv) <= 0
+        || EVP_EncryptUpdate(ctx, NULL, &outlen, GQUIC_STR_VAL(addata), GQUIC_STR_SIZE(addata)) <= 0
+        || EVP_EncryptUpdate(ctx, GQUIC_STR_VAL(cipher_text), &outlen, GQUIC_STR_VAL(plain_text), GQUIC_STR_SIZE(plain_text)) <= 0
+        || EVP_EncryptFinal_ex(ctx, GQUIC_STR_VAL(cipher_text) + outlen, &outlen) <= 0
+        || EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, GQUIC_TLS_AEAD_TAG_SIZE, GQUIC_STR_VAL(tag)) <= 0) {
+        ret = -2;
+    }
+    EVP_CIPHER_CTX_free(ctx);
+    return ret;
+}
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main() {
+    gquic_tls_aead_t aead;
+    gquic_str_t key = { 0, NULL };
+    gquic_str_t base = { 0, NULL };
+    gquic_str_t plain = { 0, NULL };
+    gquic_str_t addata = { 0, NULL };
+    u_int64_t pn = 0;
+    gquic_str_t nonce = { sizeof(u_int64_t), &pn };
+    u_int8_t packet[PACKET_SIZE + GQUIC_TLS_AEAD_TAG_SIZE];
+    gquic_str_t text = { PACKET_SIZE, packet };
+    gquic_str_t tag = { GQUIC_TLS_AEAD_TAG_SIZE, packet + PACKET_SIZE };
+    gquic_str_t cipher = { 0, NULL };
+    gquic_str_t ref_tag = { 0, NULL };
+    gquic_str_t ref_cipher = { 0, NULL };
+    double start = 0;
+    double per_packet = 0;
+    double per_key = 0;
+    int i = 0;
+
+    gquic_str_alloc(&key, 16);
+    gquic_str_alloc(&base, 16);
+    gquic_str_alloc(&plain, PACKET_SIZE);
+    gquic_str_alloc(&addata, 20);
+    for (i = 0; i < 16; i++) {
+        ((u_int8_t *) GQUIC_STR_VAL(&key))[i] = i;
+        ((u_int8_t *) GQUIC_STR_VAL(&base))[i] = 0xf0 | i;
+    }
+    memset(GQUIC_STR_VAL(&plain), 0x5a, PACKET_SIZE);
+    memset(GQUIC_STR_VAL(&addata), 0xa5, 20);
+
+    gquic_tls_aead_init(&aead);
+    if (aead_aes_gcm_init_xor(&aead, &key, &base) != 0) {
+        return -1;
+    }
+
+    for (pn = 0; pn < 16; pn++) {
+        memcpy(packet, GQUIC_STR_VAL(&plain), PACKET_SIZE);
+        GQUIC_TLS_AEAD_SEAL(&tag, &text, &aead, &nonce, &addata);
+        seal_per_packet(&ref_tag, &ref_cipher, &key, &base, &nonce, &plain, &addata);
+        if (gquic_str_cmp(&tag, &ref_tag) != 0 || gquic_str_cmp(&text, &ref_cipher) != 0) {
+            printf("mismatch at pn %lu\n", pn);
+            return -1;
+        }
+        if (GQUIC_TLS_AEAD_OPEN(&text, &aead, &nonce, &tag, &addata) != 0 || memcmp(packet, GQUIC_STR_VAL(&plain), PACKET_SIZE) != 0) {
+            printf("open failed at pn %lu\n", pn);
+            return -1;
+        }
+        gquic_str_reset(&ref_tag);
+        gquic_str_reset(&ref_cipher);
+    }
+
+    start = now();
+    for (pn = 0; pn < ROUNDS; pn++) {
+        seal_per_packet(&ref_tag, &cipher, &key, &base, &nonce, &plain, &addata);
+        gquic_str_reset(&ref_tag);
+        gquic_str_reset(&cipher);
+    }
+    per_packet = now() - start;
+
+    start = now();
+    for (pn = 0; pn < ROUNDS; pn++) {
+        GQUIC_TLS_AEAD_SEAL(&tag, &text, &aead, &nonce, &addata);
+    }
+    per_key = now() - start;
+
+    printf("per-packet ctx: %.0f packets/s\n", ROUNDS / per_packet);
+    printf("per-key ctx:    %.0f packets/s\n", ROUNDS / per_key);
+
+    gquic_tls_aead_dtor(&aead);
+    return 0;
+}
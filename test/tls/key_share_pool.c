@@ -0,0 +1,106 @@
+#include "tls/key_share_pool.h"
+#include "tls/common.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#define ROUNDS 2000
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int agree(const u_int16_t curve_id, gquic_tls_key_share_pool_t *const pool) {
+    gquic_tls_ecdhe_params_t cli;
+    gquic_tls_ecdhe_params_t ser;
+    gquic_str_t cli_pub = { 0, NULL };
+    gquic_str_t ser_pub = { 0, NULL };
+    gquic_str_t cli_shared = { 0, NULL };
+    gquic_str_t ser_shared = { 0, NULL };
+    int ret = 0;
+    gquic_tls_ecdhe_params_init(&cli);
+    gquic_tls_ecdhe_params_init(&ser);
+    if (gquic_tls_key_share_pool_take(&cli, pool, curve_id) != 0 || gquic_tls_key_share_pool_take(&ser, pool, curve_id) != 0) {
+        return -1;
+    }
+    if (GQUIC_TLS_ECDHE_PARAMS_CURVE_ID(&cli) != curve_id
+        || GQUIC_TLS_ECDHE_PARAMS_PUBLIC_KEY(&cli, &cli_pub) != 0
+        || GQUIC_TLS_ECDHE_PARAMS_PUBLIC_KEY(&ser, &ser_pub) != 0
+        || GQUIC_TLS_ECDHE_PARAMS_SHARED_KEY(&cli, &cli_shared, &ser_pub) != 0
+        || GQUIC_TLS_ECDHE_PARAMS_SHARED_KEY(&ser, &ser_shared, &cli_pub) != 0
+        || gquic_str_cmp(&cli_shared, &ser_shared) != 0) {
+        ret = -2;
+    }
+    gquic_str_reset(&cli_pub);
+    gquic_str_reset(&ser_pub);
+    gquic_str_reset(&cli_shared);
+    gquic_str_reset(&ser_shared);
+    gquic_tls_ecdhe_params_dtor(&cli);
+    gquic_tls_ecdhe_params_dtor(&ser);
+    return ret;
+}
+
+static double take_rate(const u_int16_t curve_id, gquic_tls_key_share_pool_t *const pool, const int pause_us) {
+    gquic_tls_ecdhe_params_t params;
+    double spent = 0;
+    double start = 0;
+    int i;
+    for (i = 0; i < ROUNDS; i++) {
+        start = now();
+        gquic_tls_ecdhe_params_init(&params);
+        gquic_tls_key_share_pool_take(&params, pool, curve_id);
+        spent += now() - start;
+        gquic_tls_ecdhe_params_dtor(&params);
+        if (pause_us != 0) {
+            usleep(pause_us);
+        }
+    }
+    return spent / ROUNDS * 1e6;
+}
+
+int main() {
+    gquic_list_t curves;
+    u_int16_t *curve = NULL;
+    gquic_tls_key_share_pool_t pool;
+    u_int64_t taken = 0;
+    u_int64_t starved = 0;
+
+    gquic_list_head_init(&curves);
+    curve = gquic_list_alloc(sizeof(u_int16_t));
+    *curve = GQUIC_TLS_CURVE_X25519;
+    gquic_list_insert_before(&curves, curve);
+    curve = gquic_list_alloc(sizeof(u_int16_t));
+    *curve = GQUIC_TLS_CURVE_P256;
+    gquic_list_insert_before(&curves, curve);
+
+    gquic_tls_key_share_pool_init(&pool);
+    if (gquic_tls_key_share_pool_ctor(&pool, &curves, GQUIC_TLS_KEY_SHARE_POOL_DEFAULT_CAP, GQUIC_TLS_KEY_SHARE_POOL_DEFAULT_LOW_WATER) != 0) {
+        printf("pool ctor failed\n");
+        return -1;
+    }
+    if (agree(GQUIC_TLS_CURVE_X25519, &pool) != 0 || agree(GQUIC_TLS_CURVE_P256, &pool) != 0) {
+        printf("key agreement failed\n");
+        return -1;
+    }
+
+    printf("X25519 take: inline %.1fus, bursty %.1fus, paced %.1fus\n",
+           take_rate(GQUIC_TLS_CURVE_X25519, NULL, 0),
+           take_rate(GQUIC_TLS_CURVE_X25519, &pool, 0),
+           take_rate(GQUIC_TLS_CURVE_X25519, &pool, 200));
+    printf("P-256 take: inline %.1fus, bursty %.1fus, paced %.1fus\n",
+           take_rate(GQUIC_TLS_CURVE_P256, NULL, 0),
+           take_rate(GQUIC_TLS_CURVE_P256, &pool, 0),
+           take_rate(GQUIC_TLS_CURVE_P256, &pool, 200));
+
+    gquic_tls_key_share_pool_stats(&taken, &starved, &pool, GQUIC_TLS_CURVE_P256);
+    printf("P-256 taken %lu, starved %lu\n", taken, starved);
+    if (taken != 2 * ROUNDS + 2) {
+        return -1;
+    }
+
+    gquic_tls_key_share_pool_dtor(&pool);
+    return 0;
+}
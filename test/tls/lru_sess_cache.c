@@ -0,0 +1,171 @@
+#include "tls/lru_sess_cache.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define THREADS 4
+#define SERVERS 256
+#define ROUNDS 200000
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void make_key(gquic_str_t *const key, char *const buf, const int n) {
+    key->size = snprintf(buf, 32, "server-%d.example:443", n);
+    key->val = buf;
+}
+
+static void make_state(gquic_tls_client_sess_state_t *const state, const u_int32_t tag, const time_t use_by) {
+    u_int8_t ticket[64];
+    gquic_str_t ticket_str = { sizeof(ticket), ticket };
+    gquic_str_t *cert = NULL;
+
+    gquic_tls_client_sess_state_init(state);
+    memset(ticket, tag, sizeof(ticket));
+    gquic_str_copy(&state->sess_ticket, &ticket_str);
+    gquic_str_copy(&state->master_sec, &ticket_str);
+    cert = gquic_list_alloc(sizeof(gquic_str_t));
+    gquic_str_copy(cert, &ticket_str);
+    gquic_list_insert_before(&state->ser_certs, cert);
+    state->ver = 0x0304;
+    state->age_add = tag;
+    state->use_by = use_by;
+}
+
+static int present(gquic_tls_lru_sess_cache_t *const cache, const int n) {
+    gquic_tls_client_sess_state_t *state = NULL;
+    gquic_str_t key;
+    char buf[32];
+    int ret;
+    make_key(&key, buf, n);
+    ret = cache->base.get(&state, cache->base.self, &key);
+    if (ret == 0) {
+        ret = state->age_add == (u_int32_t) n && !gquic_list_head_empty(&state->ser_certs);
+        gquic_tls_client_sess_state_release(state);
+        return ret;
+    }
+    return 0;
+}
+
+static int put(gquic_tls_lru_sess_cache_t *const cache, const int n, const time_t use_by) {
+    gquic_tls_client_sess_state_t state;
+    gquic_str_t key;
+    char buf[32];
+    int ret;
+    make_key(&key, buf, n);
+    make_state(&state, n, use_by);
+    ret = cache->base.put(cache->base.self, &key, &state);
+    gquic_tls_client_sess_state_dtor(&state);
+    return ret;
+}
+
+static int lru_order() {
+    gquic_tls_lru_sess_cache_t cache;
+    gquic_tls_lru_sess_cache_stats_t stats;
+    gquic_str_t key;
+    char buf[32];
+    time_t later = time(NULL) + 3600;
+
+    gquic_tls_lru_sess_cache_init(&cache);
+    gquic_tls_lru_sess_cache_ctor(&cache, 3, 1);
+    put(&cache, 1, later);
+    put(&cache, 2, later);
+    put(&cache, 3, later);
+    // touching 1 makes 2 the least recently used
+    if (!present(&cache, 1)) {
+        return -1;
+    }
+    put(&cache, 4, later);
+    if (present(&cache, 2) || !present(&cache, 1) || !present(&cache, 3) || !present(&cache, 4)) {
+        return -2;
+    }
+    // replacing a key keeps one entry
+    put(&cache, 4, later);
+    // a NULL state removes the key
+    make_key(&key, buf, 3);
+    cache.base.put(cache.base.self, &key, NULL);
+    if (present(&cache, 3)) {
+        return -3;
+    }
+    // past their lifetime, sessions are neither stored nor returned
+    put(&cache, 5, time(NULL) - 1);
+    if (present(&cache, 5)) {
+        return -4;
+    }
+    gquic_tls_lru_sess_cache_stats(&stats, &cache);
+    if (stats.count != 2 || stats.evicted != 1 || stats.hits != 4 || stats.misses != 3) {
+        printf("count %lu evicted %lu hits %lu misses %lu\n", stats.count, stats.evicted, stats.hits, stats.misses);
+        return -5;
+    }
+    gquic_tls_lru_sess_cache_dtor(&cache);
+    return 0;
+}
+
+static void *client_thread(void *const arg) {
+    gquic_tls_lru_sess_cache_t *const cache = arg;
+    gquic_tls_client_sess_state_t *state = NULL;
+    time_t later = time(NULL) + 3600;
+    unsigned int seed = (unsigned int) (size_t) pthread_self();
+    gquic_str_t key;
+    char buf[32];
+    int i;
+    int n;
+    for (i = 0; i < ROUNDS / THREADS; i++) {
+        // a skewed server popularity, like real clients see
+        n = rand_r(&seed) % SERVERS;
+        n = n * n / SERVERS;
+        make_key(&key, buf, n);
+        if (cache->base.get(&state, cache->base.self, &key) == 0) {
+            gquic_tls_client_sess_state_release(state);
+        }
+        else {
+            put(cache, n, later);
+        }
+    }
+    return NULL;
+}
+
+static int bench(const size_t cap, const size_t shards) {
+    gquic_tls_lru_sess_cache_t cache;
+    gquic_tls_lru_sess_cache_stats_t stats;
+    pthread_t threads[THREADS];
+    double start;
+    double elapsed;
+    int i;
+
+    gquic_tls_lru_sess_cache_init(&cache);
+    if (gquic_tls_lru_sess_cache_ctor(&cache, cap, shards) != 0) {
+        return -1;
+    }
+    start = now();
+    for (i = 0; i < THREADS; i++) {
+        pthread_create(&threads[i], NULL, client_thread, &cache);
+    }
+    for (i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    elapsed = now() - start;
+    gquic_tls_lru_sess_cache_stats(&stats, &cache);
+    printf("cap %3lu shards %2lu: %.0f lookups/s, hit rate %.1f%%, evicted %lu\n",
+           cap, shards, ROUNDS / elapsed, 100.0 * stats.hits / (stats.hits + stats.misses), stats.evicted);
+    gquic_tls_lru_sess_cache_dtor(&cache);
+    return 0;
+}
+
+int main() {
+    int ret;
+    if ((ret = lru_order()) != 0) {
+        printf("lru order failed: %d\n", ret);
+        return -1;
+    }
+    bench(64, 1);
+    bench(64, 8);
+    bench(256, 1);
+    bench(256, 8);
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include "tls/sign_pool.h"
+#include "tls/auth.h"
+#include "tls/common.h"
+#include <openssl/rsa.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <time.h>
+
+#define HANDSHAKE_THREADS 32
+#define HANDSHAKES_PER_THREAD 16
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+typedef struct key_server_s key_server_t;
+struct key_server_s {
+    EVP_PKEY *pkey;
+    int signed_count;
+};
+
+/* stands in for a remote key server: it signs with its own key */
+static int key_server_sign(gquic_str_t *const sig, void *const self, EVP_PKEY *const pkey, const u_int16_t sigalg, const gquic_str_t *const msg) {
+    key_server_t *const key_server = self;
+    (void) pkey;
+    __atomic_add_fetch(&key_server->signed_count, 1, __ATOMIC_RELAXED);
+    return gquic_tls_sign(sig, key_server->pkey, sigalg, msg);
+}
+
+typedef struct handshake_s handshake_t;
+struct handshake_s {
+    gquic_tls_sign_pool_t *pool;
+    const gquic_tls_signer_t *signer;
+    EVP_PKEY *pkey;
+    int failed;
+};
+
+static u_int8_t msg_cnt[130] = "GQUIC-TLSv1.3, server SignatureContent";
+
+static void *handshake_thread(void *const handshake_) {
+    handshake_t *const handshake = handshake_;
+    gquic_str_t msg = { sizeof(msg_cnt), msg_cnt };
+    gquic_str_t sig = { 0, NULL };
+    int i;
+    for (i = 0; i < HANDSHAKES_PER_THREAD; i++) {
+        if (gquic_tls_sign_pool_sign(&sig, handshake->pool, handshake->signer, handshake->pkey, GQUIC_SIGALG_PSS_SHA256, &msg) != 0 || GQUIC_STR_SIZE(&sig) != 256) {
+            handshake->failed = 1;
+        }
+        gquic_str_reset(&sig);
+        gquic_str_init(&sig);
+    }
+    return NULL;
+}
+
+static int run(const size_t workers, const gquic_tls_signer_t *const signer, EVP_PKEY *const pkey, double *const rate) {
+    gquic_tls_sign_pool_t pool;
+    pthread_t threads[HANDSHAKE_THREADS];
+    handshake_t handshakes[HANDSHAKE_THREADS];
+    double start = 0;
+    int i;
+    gquic_tls_sign_pool_init(&pool);
+    if (gquic_tls_sign_pool_ctor(&pool, workers) != 0) {
+        return -1;
+    }
+    start = now();
+    for (i = 0; i < HANDSHAKE_THREADS; i++) {
+        handshakes[i].pool = &pool;
+        handshakes[i].signer = signer;
+        handshakes[i].pkey = pkey;
+        handshakes[i].failed = 0;
+        pthread_create(&threads[i], NULL, handshake_thread, &handshakes[i]);
+    }
+    for (i = 0; i < HANDSHAKE_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        if (handshakes[i].failed) {
+            return -2;
+        }
+    }
+    *rate = HANDSHAKE_THREADS * HANDSHAKES_PER_THREAD / (now() - start);
+    gquic_tls_sign_pool_dtor(&pool);
+    return 0;
+}
+
+/* the signature must verify under the digest and padding of the scheme, and under no other */
+static int check_scheme(EVP_PKEY *const pkey) {
+    gquic_str_t msg = { sizeof(msg_cnt), msg_cnt };
+    gquic_str_t sig = { 0, NULL };
+    int ret = 0;
+    if (gquic_tls_sign(&sig, pkey, GQUIC_SIGALG_PSS_SHA256, &msg) != 0) {
+        return -1;
+    }
+    if (gquic_tls_verify_handshake_sign(EVP_sha256(), GQUIC_SIG_RSAPSS, pkey, &msg, &sig) != 0) {
+        ret = -2;
+    }
+    else if (gquic_tls_verify_handshake_sign(EVP_sha256(), GQUIC_SIG_PKCS1V15, pkey, &msg, &sig) == 0) {
+        ret = -3;
+    }
+    else if (gquic_tls_verify_handshake_sign(EVP_sha384(), GQUIC_SIG_RSAPSS, pkey, &msg, &sig) == 0) {
+        ret = -4;
+    }
+    gquic_str_reset(&sig);
+    return ret;
+}
+
+int main() {
+    EVP_PKEY *pkey = EVP_RSA_gen(2048);
+    key_server_t key_server = { EVP_RSA_gen(2048), 0 };
+    gquic_tls_signer_t local;
+    gquic_tls_signer_t remote;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    double rate = 0;
+    size_t workers;
+
+    if (pkey == NULL || key_server.pkey == NULL) {
+        return -1;
+    }
+    gquic_tls_signer_init(&local);
+    gquic_tls_signer_init(&remote);
+    remote.self = &key_server;
+    remote.sign = key_server_sign;
+
+    if (check_scheme(pkey) != 0) {
+        printf("rsa_pss_rsae_sha256 signature mismatch\n");
+        return -1;
+    }
+
+    printf("RSA-2048 CertificateVerify, %d concurrent handshakes, %ld cores\n", HANDSHAKE_THREADS, cores);
+    for (workers = 1; workers <= (size_t) (cores > 0 ? cores : 1) * 2; workers *= 2) {
+        if (run(workers, &local, pkey, &rate) != 0) {
+            printf("local signing failed\n");
+            return -1;
+        }
+        printf("%2lu workers: %.0f handshakes/s\n", workers, rate);
+    }
+
+    if (run(1, &remote, pkey, &rate) != 0 || key_server.signed_count != HANDSHAKE_THREADS * HANDSHAKES_PER_THREAD) {
+        printf("external signer failed\n");
+        return -1;
+    }
+    printf("external signer, 1 worker: %.0f handshakes/s\n", rate);
+
+    EVP_PKEY_free(pkey);
+    EVP_PKEY_free(key_server.pkey);
+    return 0;
+}
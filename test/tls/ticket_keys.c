@@ -0,0 +1,158 @@
+#include "tls/ticket_keys.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ROUNDS 100000
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static const gquic_str_t state = { 21, "resumption state 0123" };
+
+static int roundtrip(gquic_tls_ticket_keys_t *const enc_keys, gquic_tls_ticket_keys_t *const dec_keys, int *const is_oldkey) {
+    gquic_str_t ticket = { 0, NULL };
+    gquic_str_t plain = { 0, NULL };
+    int ret = 0;
+    if (gquic_tls_ticket_keys_encrypt(&ticket, enc_keys, &state) != 0) {
+        return -1;
+    }
+    if (gquic_tls_ticket_keys_decrypt(&plain, is_oldkey, dec_keys, &ticket) != 0) {
+        ret = -2;
+    }
+    else if (GQUIC_STR_SIZE(&plain) == 0) {
+        ret = 1;
+    }
+    else if (gquic_str_cmp(&plain, &state) != 0) {
+        ret = -3;
+    }
+    gquic_str_reset(&ticket);
+    gquic_str_reset(&plain);
+    return ret;
+}
+
+static int rotation() {
+    gquic_tls_ticket_keys_t keys;
+    gquic_str_t tickets[4];
+    gquic_str_t plain = { 0, NULL };
+    int is_oldkey = 0;
+    int i;
+    gquic_tls_ticket_keys_init(&keys);
+    if (gquic_tls_ticket_keys_ctor(&keys, 60, 3) != 0) {
+        return -1;
+    }
+    if (roundtrip(&keys, &keys, &is_oldkey) != 0 || is_oldkey) {
+        return -2;
+    }
+    // one ticket per key generation, rotating as if an interval had passed
+    for (i = 0; i < 4; i++) {
+        gquic_str_init(&tickets[i]);
+        if (gquic_tls_ticket_keys_encrypt(&tickets[i], &keys, &state) != 0) {
+            return -3;
+        }
+        keys.rotated_at -= 60;
+    }
+    gquic_tls_ticket_keys_encrypt(&plain, &keys, &state);
+    gquic_str_reset(&plain);
+    // keep = 3: the two previous generations still decrypt, as old keys
+    for (i = 0; i < 4; i++) {
+        gquic_tls_ticket_keys_decrypt(&plain, &is_oldkey, &keys, &tickets[i]);
+        if ((i < 2) != (GQUIC_STR_SIZE(&plain) == 0) || (i >= 2 && !is_oldkey)) {
+            printf("generation %d: size %lu old %d\n", i, GQUIC_STR_SIZE(&plain), is_oldkey);
+            return -4;
+        }
+        gquic_str_reset(&plain);
+    }
+    // a flipped bit fails the mac, which is a miss and not an error
+    ((u_int8_t *) GQUIC_STR_VAL(&tickets[3]))[40] ^= 1;
+    if (gquic_tls_ticket_keys_decrypt(&plain, &is_oldkey, &keys, &tickets[3]) != 0 || GQUIC_STR_SIZE(&plain) != 0) {
+        return -5;
+    }
+    for (i = 0; i < 4; i++) {
+        gquic_str_reset(&tickets[i]);
+    }
+    if (keys.unknown != 2 || keys.decrypted_old != 2) {
+        printf("unknown %lu decrypted old %lu\n", keys.unknown, keys.decrypted_old);
+        return -6;
+    }
+    gquic_tls_ticket_keys_dtor(&keys);
+    return 0;
+}
+
+static int shared_file() {
+    char path[] = "/tmp/gquic_ticket_keys_XXXXXX";
+    u_int8_t secrets[2 * GQUIC_TLS_TICKET_KEYS_SECRET_SIZE];
+    gquic_tls_ticket_keys_t a;
+    gquic_tls_ticket_keys_t b;
+    int is_oldkey = 0;
+    int fd;
+    memset(secrets, 0x5a, sizeof(secrets));
+    memset(secrets, 0xa5, GQUIC_TLS_TICKET_KEYS_SECRET_SIZE);
+    if ((fd = mkstemp(path)) < 0) {
+        return -1;
+    }
+    if (write(fd, secrets, sizeof(secrets)) != sizeof(secrets)) {
+        return -2;
+    }
+    close(fd);
+
+    gquic_tls_ticket_keys_init(&a);
+    gquic_tls_ticket_keys_init(&b);
+    gquic_tls_ticket_keys_ctor(&a, 0, 0);
+    gquic_tls_ticket_keys_ctor(&b, 0, 0);
+    // before loading, each process only knows its own random key
+    if (roundtrip(&a, &b, &is_oldkey) != 1) {
+        return -3;
+    }
+    if (gquic_tls_ticket_keys_load_file(&a, path) != 0 || gquic_tls_ticket_keys_load_file(&b, path) != 0) {
+        return -4;
+    }
+    if (roundtrip(&a, &b, &is_oldkey) != 0 || is_oldkey || roundtrip(&b, &a, &is_oldkey) != 0) {
+        return -5;
+    }
+    // b only holds the older secret: it still decrypts a's tickets, as an old key
+    gquic_tls_ticket_keys_set(&b, secrets + GQUIC_TLS_TICKET_KEYS_SECRET_SIZE, 1);
+    if (roundtrip(&b, &a, &is_oldkey) != 0 || !is_oldkey) {
+        return -6;
+    }
+    unlink(path);
+    gquic_tls_ticket_keys_dtor(&a);
+    gquic_tls_ticket_keys_dtor(&b);
+    return 0;
+}
+
+static int bench() {
+    gquic_tls_ticket_keys_t keys;
+    int is_oldkey = 0;
+    double start;
+    int i;
+    gquic_tls_ticket_keys_init(&keys);
+    gquic_tls_ticket_keys_ctor(&keys, 0, 0);
+    start = now();
+    for (i = 0; i < ROUNDS; i++) {
+        if (roundtrip(&keys, &keys, &is_oldkey) != 0) {
+            return -1;
+        }
+    }
+    printf("%.0f ticket encrypt+decrypt/s\n", ROUNDS / (now() - start));
+    gquic_tls_ticket_keys_dtor(&keys);
+    return 0;
+}
+
+int main() {
+    int ret;
+    if ((ret = rotation()) != 0) {
+        printf("rotation failed: %d\n", ret);
+        return -1;
+    }
+    if ((ret = shared_file()) != 0) {
+        printf("shared file failed: %d\n", ret);
+        return -1;
+    }
+    bench();
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include "tls/anti_replay.h"
+#include <malloc.h>
+#include <string.h>
+
+static u_int64_t gquic_tls_anti_replay_hash(const gquic_str_t *const);
+static int gquic_tls_anti_replay_contains(const u_int64_t *const, const size_t, const u_int64_t);
+static int gquic_tls_anti_replay_insert(u_int64_t *const, const size_t, const u_int64_t);
+
+int gquic_tls_anti_replay_init(gquic_tls_anti_replay_t *const ar) {
+    if (ar == NULL) {
+        return -1;
+    }
+    sem_init(&ar->mtx, 0, 1);
+    ar->window = GQUIC_TLS_ANTI_REPLAY_DEFAULT_WINDOW;
+    ar->cap = 0;
+    ar->count = 0;
+    ar->seen[0] = NULL;
+    ar->seen[1] = NULL;
+    ar->rotated_at = 0;
+    ar->accepted = 0;
+    ar->stale = 0;
+    ar->replayed = 0;
+    ar->full = 0;
+    return 0;
+}
+
+int gquic_tls_anti_replay_ctor(gquic_tls_anti_replay_t *const ar, const u_int64_t window, const size_t cap) {
+    size_t slots = 0;
+    if (ar == NULL) {
+        return -1;
+    }
+    ar->window = window == 0 ? GQUIC_TLS_ANTI_REPLAY_DEFAULT_WINDOW : window;
+    if (cap == 0) {
+        return 0;
+    }
+    // the load limit below then always leaves an empty slot to end a probe
+    for (slots = 4; slots < cap; slots <<= 1);
+    if ((ar->seen[0] = calloc(slots, sizeof(u_int64_t))) == NULL) {
+        return -2;
+    }
+    if ((ar->seen[1] = calloc(slots, sizeof(u_int64_t))) == NULL) {
+        free(ar->seen[0]);
+        ar->seen[0] = NULL;
+        return -3;
+    }
+    ar->cap = slots;
+    return 0;
+}
+
+int gquic_tls_anti_replay_dtor(gquic_tls_anti_replay_t *const ar) {
+    if (ar == NULL) {
+        return -1;
+    }
+    if (ar->seen[0] != NULL) {
+        free(ar->seen[0]);
+    }
+    if (ar->seen[1] != NULL) {
+        free(ar->seen[1]);
+    }
+    ar->seen[0] = NULL;
+    ar->seen[1] = NULL;
+    ar->cap = 0;
+    ar->count = 0;
+    sem_destroy(&ar->mtx);
+    return 0;
+}
+
+int gquic_tls_anti_replay_check(gquic_tls_anti_replay_t *const ar,
+                                const gquic_str_t *const ticket,
+                                const int64_t age_skew,
+                                const u_int64_t now) {
+    u_int64_t *tmp = NULL;
+    u_int64_t hash = 0;
+    int ret = GQUIC_TLS_ANTI_REPLAY_ACCEPT;
+    if (ar == NULL || ticket == NULL) {
+        return -1;
+    }
+    sem_wait(&ar->mtx);
+    if (age_skew > (int64_t) (ar->window / 2) || age_skew < -(int64_t) (ar->window / 2)) {
+        ar->stale++;
+        ret = GQUIC_TLS_ANTI_REPLAY_STALE;
+        goto finished;
+    }
+    if (ar->cap == 0) {
+        ar->accepted++;
+        goto finished;
+    }
+
+    // one rotation per window keeps every ticket for at least a window
+    if (now >= ar->rotated_at + ar->window) {
+        tmp = ar->seen[1];
+        ar->seen[1] = ar->seen[0];
+        ar->seen[0] = tmp;
+        memset(ar->seen[0], 0, sizeof(u_int64_t) * ar->cap);
+        ar->count = 0;
+        ar->rotated_at = now;
+    }
+    hash = gquic_tls_anti_replay_hash(ticket);
+    if (gquic_tls_anti_replay_contains(ar->seen[0], ar->cap, hash) || gquic_tls_anti_replay_contains(ar->seen[1], ar->cap, hash)) {
+        ar->replayed++;
+        ret = GQUIC_TLS_ANTI_REPLAY_REPLAYED;
+        goto finished;
+    }
+    // keep probe sequences short, and never forget a ticket to make room
+    if (ar->count >= ar->cap - ar->cap / 4) {
+        ar->full++;
+        ret = GQUIC_TLS_ANTI_REPLAY_FULL;
+        goto finished;
+    }
+    gquic_tls_anti_replay_insert(ar->seen[0], ar->cap, hash);
+    ar->count++;
+    ar->accepted++;
+finished:
+    sem_post(&ar->mtx);
+    return ret;
+}
+
+static u_int64_t gquic_tls_anti_replay_hash(const gquic_str_t *const ticket) {
+    const u_int8_t *p = GQUIC_STR_VAL(ticket);
+    u_int64_t hash = 0xcbf29ce484222325;
+    size_t i;
+    // FNV-1a, 0 marks an empty slot
+    for (i = 0; i < GQUIC_STR_SIZE(ticket); i++) {
+        hash ^= p[i];
+        hash *= 0x100000001b3;
+    }
+    return hash == 0 ? 1 : hash;
+}
+
+static int gquic_tls_anti_replay_contains(const u_int64_t *const set, const size_t cap, const u_int64_t hash) {
+    size_t i = hash & (cap - 1);
+    for (; set[i] != 0; i = (i + 1) & (cap - 1)) {
+        if (set[i] == hash) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int gquic_tls_anti_replay_insert(u_int64_t *const set, const size_t cap, const u_int64_t hash) {
+    size_t i = hash & (cap - 1);
+    for (; set[i] != 0; i = (i + 1) & (cap - 1));
+    set[i] = hash;
+    return 0;
+}
@@ -5,6 +5,7 @@
 #include "util/str.h"
 #include <string.h>
 #include <openssl/pkcs12.h>
+#include <openssl/rsa.h>
 
 int gquic_tls_selected_sigalg(u_int16_t *const sigalg,
                               u_int8_t *const sig_type,
@@ -89,18 +90,26 @@ int gquic_tls_selected_sigalg(u_int16_t *const sigalg,
 }
 
 int gquic_tls_verify_handshake_sign(const EVP_MD *const hash,
+                                    const u_int8_t sig_type,
                                     EVP_PKEY *const pubkey,
                                     const gquic_str_t *sign,
                                     const gquic_str_t *sig) {
     EVP_MD_CTX *ctx;
+    EVP_PKEY_CTX *pkey_ctx = NULL;
     int ret = 0;
     if (pubkey == NULL || sign == NULL || sig == NULL) {
         return -1;
     }
     ctx = EVP_MD_CTX_new();
-    if (EVP_DigestVerifyInit(ctx, NULL, hash, NULL, pubkey) <= 0) {
+    if (EVP_DigestVerifyInit(ctx, &pkey_ctx, hash, NULL, pubkey) <= 0) {
         goto failure;
     }
+    if (sig_type == GQUIC_SIG_RSAPSS) {
+        if (EVP_PKEY_CTX_set_rsa_padding(pkey_ctx, RSA_PKCS1_PSS_PADDING) <= 0
+            || EVP_PKEY_CTX_set_rsa_pss_saltlen(pkey_ctx, RSA_PSS_SALTLEN_DIGEST) <= 0) {
+            goto failure;
+        }
+    }
     if ((ret = EVP_DigestVerify(ctx, GQUIC_STR_VAL(sig), GQUIC_STR_SIZE(sig), GQUIC_STR_VAL(sign), GQUIC_STR_SIZE(sign))) != 1) {
         goto failure;
     }
@@ -210,7 +219,8 @@ int gquic_tls_sig_pubkey_from_x509(EVP_PKEY **const pubkey, const u_int8_t sig_t
         X509_free(x509);
         return -3;
     }
-    int x509_sig_type = X509_get_signature_type(x509);
+    // the key decides the schemes, not the algorithm the issuer signed the certificate with
+    int x509_sig_type = EVP_PKEY_get_base_id(*pubkey);
     X509_free(x509);
 
     switch (sig_type) {
@@ -255,21 +265,25 @@ int gquic_tls_sig_schemes_from_cert(gquic_list_t *const sig_schemes, const gquic
         PKCS12_free(p12);
         return -3;
     }
-    static const u_int16_t pkcs1_sig_schemes[] = {
+    // TLS 1.3 signs with an RSA key only under rsa_pss_rsae, PKCS#1 v1.5 is left for TLS 1.2
+    static const u_int16_t rsa_sig_schemes[] = {
+        GQUIC_SIGALG_PSS_SHA256,
+        GQUIC_SIGALG_PSS_SHA384,
+        GQUIC_SIGALG_PSS_SHA512,
         GQUIC_SIGALG_PKCS1_SHA1,
         GQUIC_SIGALG_PKCS1_SHA256,
         GQUIC_SIGALG_PKCS1_SHA384,
         GQUIC_SIGALG_PKCS1_SHA512
     };
 
-    switch (X509_get_signature_type(x509)) {
+    switch (EVP_PKEY_get_base_id(X509_get0_pubkey(x509))) {
     case EVP_PKEY_RSA:
-        for (i = 0; i < 4; i++) {
+        for (i = 0; i < (int) (sizeof(rsa_sig_schemes) / sizeof(u_int16_t)); i++) {
             if ((sig_scheme = gquic_list_alloc(sizeof(u_int16_t))) == NULL) {
                 PKCS12_free(p12);
                 return -4;
             }
-            *sig_scheme = pkcs1_sig_schemes[i];
+            *sig_scheme = rsa_sig_schemes[i];
             gquic_list_insert_before(sig_schemes, sig_scheme);
         }
         break;
@@ -9,11 +9,17 @@ typedef struct gquic_tls_aead_ctx_s gquic_tls_aead_ctx_t;
 struct gquic_tls_aead_ctx_s {
     const EVP_CIPHER *cipher;
     gquic_str_t nonce;
-    gquic_str_t key;
+    size_t iv_len;
 
-    int (*nonce_wrapper) (gquic_str_t *const, const gquic_str_t *const, const gquic_str_t *const);
+    /* keyed once when the aead is created; each packet only sets its iv */
+    EVP_CIPHER_CTX *seal_ctx;
+    EVP_CIPHER_CTX *open_ctx;
+
+    int (*nonce_wrapper) (u_int8_t *const, const gquic_str_t *const, const gquic_str_t *const);
 };
 
+#define GQUIC_TLS_AEAD_MAX_IV_LEN 32
+
 static int gquic_tls_aead_ctx_init(gquic_tls_aead_ctx_t *const ctx);
 static int gquic_tls_aead_ctx_dtor(gquic_tls_aead_ctx_t *const ctx);
 
@@ -38,34 +44,51 @@ static int mac_sha384_init(gquic_tls_mac_t *const, const u_int16_t, const gquic_
 static int aead_seal(gquic_str_t *const,
                      gquic_str_t *const,
                      EVP_CIPHER_CTX *const,
-                     const gquic_str_t *const,
                      const gquic_str_t *const);
 static int aead_open(gquic_str_t *const,
                      EVP_CIPHER_CTX *const,
                      const gquic_str_t *const,
-                     const gquic_str_t *const,
                      const gquic_str_t *const);
 
 static int gquic_tls_aead_seal(gquic_str_t *const,
                                gquic_str_t *const,
                                void *const,
                                const gquic_str_t *const,
-                               const gquic_str_t *const,
                                const gquic_str_t *const);
 
 static int gquic_tls_aead_open(gquic_str_t *const,
                                void *const,
                                const gquic_str_t *const,
                                const gquic_str_t *const,
-                               const gquic_str_t *const,
                                const gquic_str_t *const);
 
-static int aead_prefix_nonce_wrapper(gquic_str_t *const, const gquic_str_t *const, const gquic_str_t *const);
-static int aead_xor_nonce_wrapper(gquic_str_t *const, const gquic_str_t *const, const gquic_str_t *const);
+static int gquic_tls_aead_seal_batch(gquic_str_t *const,
+                                     gquic_str_t *const,
+                                     void *const,
+                                     const gquic_str_t *const,
+                                     const gquic_str_t *const,
+                                     const size_t);
+
+static int aead_prefix_nonce_wrapper(u_int8_t *const, const gquic_str_t *const, const gquic_str_t *const);
+static int aead_xor_nonce_wrapper(u_int8_t *const, const gquic_str_t *const, const gquic_str_t *const);
 
 static int aead_ctx_dtor(void *self);
-static inline int aead_aes_gcm_init(gquic_tls_aead_t *const, const gquic_str_t *const, const gquic_str_t *const);
-static inline int aead_chacha20_poly1305_init(gquic_tls_aead_t *const, const gquic_str_t *const, const gquic_str_t *const);
+static int aead_common_init(gquic_tls_aead_t *const,
+                            const EVP_CIPHER *const,
+                            const gquic_str_t *const,
+                            const gquic_str_t *const,
+                            int (*) (u_int8_t *const, const gquic_str_t *const, const gquic_str_t *const),
+                            const size_t);
+static inline int aead_aes_gcm_init(gquic_tls_aead_t *const,
+                                    const gquic_str_t *const,
+                                    const gquic_str_t *const,
+                                    int (*) (u_int8_t *const, const gquic_str_t *const, const gquic_str_t *const),
+                                    const size_t);
+static inline int aead_chacha20_poly1305_init(gquic_tls_aead_t *const,
+                                              const gquic_str_t *const,
+                                              const gquic_str_t *const,
+                                              int (*) (u_int8_t *const, const gquic_str_t *const, const gquic_str_t *const),
+                                              const size_t);
 static int aead_aes_gcm_init_prefix(gquic_tls_aead_t *const, const gquic_str_t *const, const gquic_str_t *const);
 static int aead_chacha20_poly1305_init_prefix(gquic_tls_aead_t *const, const gquic_str_t *const, const gquic_str_t *const);
 static int aead_aes_gcm_init_xor(gquic_tls_aead_t *const, const gquic_str_t *const, const gquic_str_t *const);
@@ -147,7 +170,7 @@ int gquic_tls_create_aead(gquic_tls_aead_t *const aead, const gquic_tls_cipher_s
         ret = -3;
         goto failure;
     }
-    if (gquic_tls_hkdf_expand_label(&iv, &hash, traffic_sec, NULL, &iv_label, suite->key_len) != 0) {
+    if (gquic_tls_hkdf_expand_label(&iv, &hash, traffic_sec, NULL, &iv_label, suite->iv_len) != 0) {
         ret = -4;
         goto failure;
     }
@@ -293,6 +316,7 @@ int gquic_tls_aead_init(gquic_tls_aead_t *const aead) {
     aead->self = NULL;
     aead->open = NULL;
     aead->seal = NULL;
+    aead->seal_batch = NULL;
     aead->dtor = NULL;
     return 0;
 }
@@ -304,6 +328,7 @@ int gquic_tls_aead_copy(gquic_tls_aead_t *const aead, const gquic_tls_aead_t *co
     aead->self = ref->self;
     aead->open = ref->open;
     aead->seal = ref->seal;
+    aead->seal_batch = ref->seal_batch;
 
     return 0;
 }
@@ -384,7 +409,9 @@ static int gquic_tls_aead_ctx_init(gquic_tls_aead_ctx_t *const ctx) {
     }
     ctx->cipher = NULL;
     gquic_str_init(&ctx->nonce);
-    gquic_str_init(&ctx->key);
+    ctx->iv_len = 0;
+    ctx->seal_ctx = NULL;
+    ctx->open_ctx = NULL;
     ctx->nonce_wrapper = NULL;
     return 0;
 }
@@ -394,7 +421,14 @@ static int gquic_tls_aead_ctx_dtor(gquic_tls_aead_ctx_t *const ctx) {
         return -1;
     }
     gquic_str_reset(&ctx->nonce);
-    gquic_str_reset(&ctx->key);
+    if (ctx->seal_ctx != NULL) {
+        EVP_CIPHER_CTX_free(ctx->seal_ctx);
+        ctx->seal_ctx = NULL;
+    }
+    if (ctx->open_ctx != NULL) {
+        EVP_CIPHER_CTX_free(ctx->open_ctx);
+        ctx->open_ctx = NULL;
+    }
     return 0;
 }
 
@@ -463,7 +497,19 @@ int gquic_tls_suite_aead_encrypt(gquic_str_t *const tag,
     if (tag == NULL || cipher_text == NULL || suite == NULL || nonce == NULL || plain_text == NULL || addata == NULL) {
         return -1;
     }
-    return GQUIC_TLS_AEAD_SEAL(tag, cipher_text, &suite->aead, nonce, plain_text, addata);
+    if (gquic_str_alloc(tag, GQUIC_TLS_AEAD_TAG_SIZE) != 0) {
+        return -2;
+    }
+    if (gquic_str_copy(cipher_text, plain_text) != 0) {
+        gquic_str_reset(tag);
+        return -3;
+    }
+    if (GQUIC_TLS_AEAD_SEAL(tag, cipher_text, &suite->aead, nonce, addata) != 0) {
+        gquic_str_reset(tag);
+        gquic_str_reset(cipher_text);
+        return -4;
+    }
+    return 0;
 }
 
 int gquic_tls_suite_decrypt(gquic_str_t *const result, gquic_tls_suite_t *const suite, const gquic_str_t *const cipher_text) {
@@ -482,7 +528,14 @@ int gquic_tls_suite_aead_decrypt(gquic_str_t *const plain_text,
     if (plain_text == NULL || suite == NULL || nonce == NULL || tag == NULL || cipher_text == NULL || addata == NULL) {
         return -1;
     }
-    return GQUIC_TLS_AEAD_OPEN(plain_text, &suite->aead, nonce, tag, cipher_text, addata);
+    if (gquic_str_copy(plain_text, cipher_text) != 0) {
+        return -2;
+    }
+    if (GQUIC_TLS_AEAD_OPEN(plain_text, &suite->aead, nonce, tag, addata) != 0) {
+        gquic_str_reset(plain_text);
+        return -3;
+    }
+    return 0;
 }
 
 int gquic_tls_mac_init(gquic_tls_mac_t *const mac) {
@@ -569,114 +622,84 @@ static int rsa_ka(gquic_tls_key_agreement_t *const ka, const u_int16_t ver) {
 }
 
 static int gquic_tls_aead_seal(gquic_str_t *const tag,
-                               gquic_str_t *const cipher_text,
+                               gquic_str_t *const text,
                                void *const aead,
                                const gquic_str_t *const nonce,
-                               const gquic_str_t *const plain_text,
                                const gquic_str_t *const addata) {
-
-    gquic_str_t iv;
-    EVP_CIPHER_CTX *ctx = NULL;
+    u_int8_t iv[GQUIC_TLS_AEAD_MAX_IV_LEN];
     gquic_tls_aead_ctx_t *aead_ctx = aead;
-    int ret = 0;
-    if (tag == NULL || cipher_text == NULL || aead == NULL || plain_text == NULL || addata == NULL || aead_ctx->nonce_wrapper == NULL) {
+    if (tag == NULL || text == NULL || aead == NULL || addata == NULL || aead_ctx->nonce_wrapper == NULL) {
         return -1;
     }
-    gquic_str_init(&iv);
-    if (aead_ctx->nonce_wrapper(&iv, &aead_ctx->nonce, nonce) != 0) {
-        ret = -2;
-        goto failure;
+    if (aead_ctx->nonce_wrapper(iv, &aead_ctx->nonce, nonce) != 0) {
+        return -2;
     }
-    if ((ctx = EVP_CIPHER_CTX_new()) == NULL) {
-        ret = -3;
-        goto failure;
+    if (EVP_EncryptInit_ex(aead_ctx->seal_ctx, NULL, NULL, NULL, iv) <= 0) {
+        return -3;
     }
-    if (EVP_EncryptInit_ex(ctx, aead_ctx->cipher, NULL, NULL, NULL) <= 0) {
-        ret = -4;
-        goto failure;
+    if (aead_seal(tag, text, aead_ctx->seal_ctx, addata) != 0) {
+        return -4;
     }
-    if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_IVLEN, GQUIC_STR_SIZE(&iv), NULL) <= 0) {
-        ret = -5;
-        goto failure;
+    return 0;
+}
+
+/*
+ * EVP offers no multi-buffer AES-GCM, so the packets are still encrypted one
+ * after the other. the batch derives every IV up front and then streams all
+ * packets through the same keyed context, which keeps the key schedule and
+ * GHASH tables hot and leaves only the EVP calls in the inner loop.
+ */
+static int gquic_tls_aead_seal_batch(gquic_str_t *const tags,
+                                     gquic_str_t *const texts,
+                                     void *const aead,
+                                     const gquic_str_t *const nonces,
+                                     const gquic_str_t *const addatas,
+                                     const size_t count) {
+    u_int8_t ivs[GQUIC_TLS_AEAD_MAX_BATCH][GQUIC_TLS_AEAD_MAX_IV_LEN];
+    gquic_tls_aead_ctx_t *aead_ctx = aead;
+    size_t i = 0;
+    if (tags == NULL || texts == NULL || aead == NULL || nonces == NULL || addatas == NULL || aead_ctx->nonce_wrapper == NULL) {
+        return -1;
     }
-    if (EVP_EncryptInit_ex(ctx, NULL, NULL, GQUIC_STR_VAL(&aead_ctx->key), GQUIC_STR_VAL(&iv)) <= 0) {
-        ret = -6;
-        goto failure;
+    if (count > GQUIC_TLS_AEAD_MAX_BATCH) {
+        return -2;
     }
-
-    if (aead_seal(tag, cipher_text, ctx, plain_text, addata) != 0) {
-        ret = -7;
-        goto failure;
+    for (i = 0; i < count; i++) {
+        if (aead_ctx->nonce_wrapper(ivs[i], &aead_ctx->nonce, &nonces[i]) != 0) {
+            return -3;
+        }
     }
-
-    if (ctx != NULL) {
-        EVP_CIPHER_CTX_free(ctx);
+    for (i = 0; i < count; i++) {
+        if (EVP_EncryptInit_ex(aead_ctx->seal_ctx, NULL, NULL, NULL, ivs[i]) <= 0) {
+            return -4;
+        }
+        if (aead_seal(&tags[i], &texts[i], aead_ctx->seal_ctx, &addatas[i]) != 0) {
+            return -5;
+        }
     }
-    gquic_str_reset(&iv);
     return 0;
-failure:
-    if (ctx != NULL) {
-        EVP_CIPHER_CTX_free(ctx);
-    }
-    gquic_str_reset(&iv);
-    return ret;
 }
 
-static int gquic_tls_aead_open(gquic_str_t *const plain_text,
+static int gquic_tls_aead_open(gquic_str_t *const text,
                                void *const aead,
                                const gquic_str_t *const nonce,
                                const gquic_str_t *const tag,
-                               const gquic_str_t *const cipher_text,
                                const gquic_str_t *const addata) {
-    gquic_str_t iv;
-    EVP_CIPHER_CTX *ctx = NULL;
+    u_int8_t iv[GQUIC_TLS_AEAD_MAX_IV_LEN];
     gquic_tls_aead_ctx_t *aead_ctx = aead;
-    int ret = 0;
-    if (plain_text == NULL
-        || tag == NULL
-        || cipher_text == NULL
-        || aead == NULL
-        || cipher_text == NULL
-        || addata == NULL
-        || aead_ctx->nonce_wrapper == NULL) {
+    if (text == NULL || tag == NULL || aead == NULL || addata == NULL || aead_ctx->nonce_wrapper == NULL) {
         return -1;
     }
-    gquic_str_init(&iv);
-    if (aead_ctx->nonce_wrapper(&iv, &aead_ctx->nonce, nonce) != 0) {
-        ret = -2;
-        goto failure;
-    }
-    if ((ctx = EVP_CIPHER_CTX_new()) == NULL) {
-        ret = -3;
-        goto failure;
-    }
-    if (EVP_DecryptInit_ex(ctx, aead_ctx->cipher, NULL, NULL, NULL) <= 0) {
-        ret = -4;
-        goto failure;
-    }
-    if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_IVLEN, GQUIC_STR_SIZE(&iv), NULL) <= 0) {
-        ret = -5;
-        goto failure;
-    }
-    if (EVP_DecryptInit_ex(ctx, NULL, NULL, GQUIC_STR_VAL(&aead_ctx->key), GQUIC_STR_VAL(&iv)) <= 0) {
-        ret = -6;
-        goto failure;
-    }
-
-    if (aead_open(plain_text, ctx, tag, cipher_text, addata) <= 0) {
+    if (aead_ctx->nonce_wrapper(iv, &aead_ctx->nonce, nonce) != 0) {
         return -2;
     }
-    if (ctx != NULL) {
-        EVP_CIPHER_CTX_free(ctx);
+    if (EVP_DecryptInit_ex(aead_ctx->open_ctx, NULL, NULL, NULL, iv) <= 0) {
+        return -3;
     }
-    gquic_str_reset(&iv);
-    return 0;
-failure:
-    if (ctx != NULL) {
-        EVP_CIPHER_CTX_free(ctx);
+    if (aead_open(text, aead_ctx->open_ctx, tag, addata) != 0) {
+        return -4;
     }
-    gquic_str_reset(&iv);
-    return ret;
+    return 0;
 }
 
 static int cipher_common(gquic_tls_cipher_t *const ret,
@@ -765,195 +788,218 @@ static int mac_sha384_init(gquic_tls_mac_t *const mac, const u_int16_t ver, cons
 }
 
 static int aead_seal(gquic_str_t *const tag,
-                     gquic_str_t *const cipher_text,
+                     gquic_str_t *const text,
                      EVP_CIPHER_CTX *const ctx,
-                     const gquic_str_t *const plain_text,
                      const gquic_str_t *const addata) {
     int outlen = 0;
-    if (tag == NULL || cipher_text == NULL || ctx == NULL || plain_text == NULL || addata == NULL) {
+    if (tag == NULL || text == NULL || ctx == NULL || addata == NULL) {
         return -1;
     }
-    if (gquic_str_alloc(tag, 16) != 0) {
+    if (GQUIC_STR_SIZE(tag) < GQUIC_TLS_AEAD_TAG_SIZE) {
         return -2;
     }
-    EVP_EncryptUpdate(ctx, NULL, &outlen, GQUIC_STR_VAL(addata), GQUIC_STR_SIZE(addata));
-    if (gquic_str_alloc(cipher_text, GQUIC_STR_SIZE(addata) + GQUIC_STR_SIZE(plain_text)) != 0) {
+    if (EVP_EncryptUpdate(ctx, NULL, &outlen, GQUIC_STR_VAL(addata), GQUIC_STR_SIZE(addata)) <= 0) {
         return -3;
     }
-    EVP_EncryptUpdate(ctx, GQUIC_STR_VAL(cipher_text), &outlen, GQUIC_STR_VAL(plain_text), GQUIC_STR_SIZE(plain_text));
-    cipher_text->size = outlen;
-    EVP_EncryptFinal_ex(ctx, GQUIC_STR_VAL(cipher_text), &outlen);
-    EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, 16, GQUIC_STR_VAL(tag));
+    if (EVP_EncryptUpdate(ctx, GQUIC_STR_VAL(text), &outlen, GQUIC_STR_VAL(text), GQUIC_STR_SIZE(text)) <= 0) {
+        return -4;
+    }
+    if (EVP_EncryptFinal_ex(ctx, GQUIC_STR_VAL(text) + outlen, &outlen) <= 0) {
+        return -5;
+    }
+    if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, GQUIC_TLS_AEAD_TAG_SIZE, GQUIC_STR_VAL(tag)) <= 0) {
+        return -6;
+    }
+    tag->size = GQUIC_TLS_AEAD_TAG_SIZE;
     return 0;
 }
 
-static int aead_open(gquic_str_t *const ret,
+static int aead_open(gquic_str_t *const text,
                      EVP_CIPHER_CTX *const ctx,
                      const gquic_str_t *const tag,
-                     const gquic_str_t *const cipher_text,
                      const gquic_str_t *const addata) {
     int outlen = 0;
-    if (ret == NULL || tag == NULL || cipher_text == NULL || ctx == NULL || cipher_text == NULL || addata == NULL) {
+    if (text == NULL || tag == NULL || ctx == NULL || addata == NULL) {
         return -1;
     }
-    EVP_DecryptUpdate(ctx, NULL, &outlen, GQUIC_STR_VAL(addata), GQUIC_STR_SIZE(addata));
-    if (gquic_str_alloc(ret, GQUIC_STR_SIZE(cipher_text) + GQUIC_STR_SIZE(addata)) != 0) {
+    if (EVP_DecryptUpdate(ctx, NULL, &outlen, GQUIC_STR_VAL(addata), GQUIC_STR_SIZE(addata)) <= 0) {
+        return -2;
+    }
+    if (EVP_DecryptUpdate(ctx, GQUIC_STR_VAL(text), &outlen, GQUIC_STR_VAL(text), GQUIC_STR_SIZE(text)) <= 0) {
         return -3;
     }
-    EVP_DecryptUpdate(ctx, GQUIC_STR_VAL(ret), &outlen, GQUIC_STR_VAL(cipher_text), GQUIC_STR_SIZE(cipher_text));
-    ret->size = outlen;
-    EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, GQUIC_STR_SIZE(tag), GQUIC_STR_VAL(tag));
-    return EVP_DecryptFinal_ex(ctx, GQUIC_STR_VAL(ret), &outlen);
+    if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, GQUIC_STR_SIZE(tag), GQUIC_STR_VAL(tag)) <= 0) {
+        return -4;
+    }
+    if (EVP_DecryptFinal_ex(ctx, GQUIC_STR_VAL(text) + outlen, &outlen) <= 0) {
+        return -5;
+    }
+    return 0;
 }
 
 static int aead_ctx_dtor(void *self) {
     return gquic_tls_aead_ctx_dtor(self);
 }
 
-static inline int aead_aes_gcm_init(gquic_tls_aead_t *const ret, const gquic_str_t *const key, const gquic_str_t *const nonce) {
+static int aead_common_init(gquic_tls_aead_t *const ret,
+                            const EVP_CIPHER *const cipher,
+                            const gquic_str_t *const key,
+                            const gquic_str_t *const nonce,
+                            int (*nonce_wrapper) (u_int8_t *const, const gquic_str_t *const, const gquic_str_t *const),
+                            const size_t iv_len) {
+    int exit_code = 0;
     gquic_tls_aead_ctx_t *ctx = NULL;
-    if (ret == NULL || key == NULL || nonce == NULL) {
+    if (ret == NULL || cipher == NULL || key == NULL || nonce == NULL || nonce_wrapper == NULL) {
         return -1;
     }
-    if ((ctx = malloc(sizeof(gquic_tls_aead_ctx_t))) == NULL) {
+    if (iv_len == 0 || iv_len > GQUIC_TLS_AEAD_MAX_IV_LEN) {
         return -2;
     }
-    gquic_tls_aead_ctx_init(ctx);
-    if (gquic_tls_aead_ctx_init(ctx) != 0) {
+    if ((ctx = malloc(sizeof(gquic_tls_aead_ctx_t))) == NULL) {
         return -3;
     }
-    if ((size_t) EVP_CIPHER_key_length(EVP_aes_128_gcm()) == GQUIC_STR_SIZE(key)) {
-        ctx->cipher = EVP_aes_128_gcm();
-    }
-    else if ((size_t) EVP_CIPHER_key_length(EVP_aes_192_gcm()) == GQUIC_STR_SIZE(key)) {
-        ctx->cipher = EVP_aes_192_gcm();
-    }
-    else if ((size_t) EVP_CIPHER_key_length(EVP_aes_256_gcm()) == GQUIC_STR_SIZE(key)) {
-        ctx->cipher = EVP_aes_256_gcm();
+    gquic_tls_aead_ctx_init(ctx);
+    ctx->cipher = cipher;
+    ctx->iv_len = iv_len;
+    ctx->nonce_wrapper = nonce_wrapper;
+    if (gquic_str_copy(&ctx->nonce, nonce) != 0) {
+        exit_code = -4;
+        goto failure;
     }
-    else {
-        return -4;
+    if ((ctx->seal_ctx = EVP_CIPHER_CTX_new()) == NULL || (ctx->open_ctx = EVP_CIPHER_CTX_new()) == NULL) {
+        exit_code = -5;
+        goto failure;
     }
-    if (gquic_str_copy(&ctx->nonce, nonce) != 0) {
-        return -5;
+    if (EVP_EncryptInit_ex(ctx->seal_ctx, cipher, NULL, NULL, NULL) <= 0
+        || EVP_CIPHER_CTX_ctrl(ctx->seal_ctx, EVP_CTRL_AEAD_SET_IVLEN, iv_len, NULL) <= 0
+        || EVP_EncryptInit_ex(ctx->seal_ctx, NULL, NULL, GQUIC_STR_VAL(key), NULL) <= 0) {
+        exit_code = -6;
+        goto failure;
     }
-    if (gquic_str_copy(&ctx->key, key) != 0) {
-        return -5;
+    if (EVP_DecryptInit_ex(ctx->open_ctx, cipher, NULL, NULL, NULL) <= 0
+        || EVP_CIPHER_CTX_ctrl(ctx->open_ctx, EVP_CTRL_AEAD_SET_IVLEN, iv_len, NULL) <= 0
+        || EVP_DecryptInit_ex(ctx->open_ctx, NULL, NULL, GQUIC_STR_VAL(key), NULL) <= 0) {
+        exit_code = -7;
+        goto failure;
     }
     ret->self = ctx;
     ret->open = gquic_tls_aead_open;
     ret->seal = gquic_tls_aead_seal;
+    ret->seal_batch = gquic_tls_aead_seal_batch;
     ret->dtor = aead_ctx_dtor;
     return 0;
+failure:
+    gquic_tls_aead_ctx_dtor(ctx);
+    free(ctx);
+    return exit_code;
 }
 
-static inline int aead_chacha20_poly1305_init(gquic_tls_aead_t *const ret, const gquic_str_t *const key, const gquic_str_t *const nonce) {
-    gquic_tls_aead_ctx_t *ctx = NULL;
+static inline int aead_aes_gcm_init(gquic_tls_aead_t *const ret,
+                                    const gquic_str_t *const key,
+                                    const gquic_str_t *const nonce,
+                                    int (*nonce_wrapper) (u_int8_t *const, const gquic_str_t *const, const gquic_str_t *const),
+                                    const size_t iv_len) {
+    const EVP_CIPHER *cipher = NULL;
     if (ret == NULL || key == NULL || nonce == NULL) {
         return -1;
     }
-    if ((ctx = malloc(sizeof(gquic_tls_aead_ctx_t))) == NULL) {
-        return -2;
+    if ((size_t) EVP_CIPHER_key_length(EVP_aes_128_gcm()) == GQUIC_STR_SIZE(key)) {
+        cipher = EVP_aes_128_gcm();
     }
-    gquic_tls_aead_ctx_init(ctx);
-    if (gquic_tls_aead_ctx_init(ctx) != 0) {
+    else if ((size_t) EVP_CIPHER_key_length(EVP_aes_192_gcm()) == GQUIC_STR_SIZE(key)) {
+        cipher = EVP_aes_192_gcm();
+    }
+    else if ((size_t) EVP_CIPHER_key_length(EVP_aes_256_gcm()) == GQUIC_STR_SIZE(key)) {
+        cipher = EVP_aes_256_gcm();
+    }
+    else {
         return -2;
     }
-    ctx->cipher = EVP_chacha20_poly1305();
-    if (gquic_str_copy(&ctx->nonce, nonce) != 0) {
-        return -5;
+    if (aead_common_init(ret, cipher, key, nonce, nonce_wrapper, iv_len) != 0) {
+        return -3;
     }
-    if (gquic_str_copy(&ctx->key, key) != 0) {
-        return -5;
+    return 0;
+}
+
+static inline int aead_chacha20_poly1305_init(gquic_tls_aead_t *const ret,
+                                              const gquic_str_t *const key,
+                                              const gquic_str_t *const nonce,
+                                              int (*nonce_wrapper) (u_int8_t *const, const gquic_str_t *const, const gquic_str_t *const),
+                                              const size_t iv_len) {
+    if (ret == NULL || key == NULL || nonce == NULL) {
+        return -1;
+    }
+    if (aead_common_init(ret, EVP_chacha20_poly1305(), key, nonce, nonce_wrapper, iv_len) != 0) {
+        return -2;
     }
-    ret->self = ctx;
-    ret->open = gquic_tls_aead_open;
-    ret->seal = gquic_tls_aead_seal;
-    ret->dtor = aead_ctx_dtor;
     return 0;
 }
 
 static int aead_aes_gcm_init_prefix(gquic_tls_aead_t *const ret, const gquic_str_t *const key, const gquic_str_t *const nonce) {
-    gquic_tls_aead_ctx_t *ctx = NULL;
     if (ret == NULL || key == NULL || nonce == NULL) {
         return -1;
     }
-    if (aead_aes_gcm_init(ret, key, nonce) != 0) {
+    if (aead_aes_gcm_init(ret, key, nonce, aead_prefix_nonce_wrapper, 12) != 0) {
         return -2;
     }
-    ctx = ret->self;
-    ctx->nonce_wrapper = aead_prefix_nonce_wrapper;
     return 0;
 }
 
 static int aead_chacha20_poly1305_init_prefix(gquic_tls_aead_t *const ret, const gquic_str_t *const key, const gquic_str_t *const nonce) {
-    gquic_tls_aead_ctx_t *ctx = NULL;
     if (ret == NULL || key == NULL || nonce == NULL) {
         return -1;
     }
-    if (aead_chacha20_poly1305_init(ret, key, nonce) != 0) {
+    if (aead_chacha20_poly1305_init(ret, key, nonce, aead_prefix_nonce_wrapper, 12) != 0) {
         return -2;
     }
-    ctx = ret->self;
-    ctx->nonce_wrapper = aead_prefix_nonce_wrapper;
     return 0;
 }
 
 static int aead_aes_gcm_init_xor(gquic_tls_aead_t *const ret, const gquic_str_t *const key, const gquic_str_t *const nonce) {
-    gquic_tls_aead_ctx_t *ctx = NULL;
     if (ret == NULL || key == NULL || nonce == NULL) {
         return -1;
     }
-    if (aead_aes_gcm_init(ret, key, nonce) != 0) {
+    if (aead_aes_gcm_init(ret, key, nonce, aead_xor_nonce_wrapper, GQUIC_STR_SIZE(nonce)) != 0) {
         return -2;
     }
-    ctx = ret->self;
-    ctx->nonce_wrapper = aead_xor_nonce_wrapper;
     return 0;
 }
 
 static int aead_chacha20_poly1305_init_xor(gquic_tls_aead_t *const ret, const gquic_str_t *const key, const gquic_str_t *const nonce) {
-    gquic_tls_aead_ctx_t *ctx = NULL;
     if (ret == NULL || key == NULL || nonce == NULL) {
         return -1;
     }
-    if (aead_chacha20_poly1305_init(ret, key, nonce) != 0) {
+    if (aead_chacha20_poly1305_init(ret, key, nonce, aead_xor_nonce_wrapper, GQUIC_STR_SIZE(nonce)) != 0) {
         return -2;
     }
-    ctx = ret->self;
-    ctx->nonce_wrapper = aead_xor_nonce_wrapper;
     return 0;
 }
 
-static int aead_prefix_nonce_wrapper(gquic_str_t *const ret, const gquic_str_t *const base, const gquic_str_t *const nonce) {
+static int aead_prefix_nonce_wrapper(u_int8_t *const ret, const gquic_str_t *const base, const gquic_str_t *const nonce) {
     if (ret == NULL || base == NULL || nonce == NULL) {
         return -1;
     }
-    if (gquic_str_init(ret) != 0) {
+    if (GQUIC_STR_SIZE(base) < 4 || GQUIC_STR_SIZE(nonce) < 8) {
         return -2;
     }
-    if (gquic_str_alloc(ret, 12) != 0) {
-        return -3;
-    }
-    memcpy(GQUIC_STR_VAL(ret), GQUIC_STR_VAL(base), 4);
-    memcpy(GQUIC_STR_VAL(ret) + 4, GQUIC_STR_VAL(nonce), 8);
+    memcpy(ret, GQUIC_STR_VAL(base), 4);
+    memcpy(ret + 4, GQUIC_STR_VAL(nonce), 8);
 
     return 0;
 }
 
-static int aead_xor_nonce_wrapper(gquic_str_t *const ret, const gquic_str_t *const base, const gquic_str_t *const nonce) {
+static int aead_xor_nonce_wrapper(u_int8_t *const ret, const gquic_str_t *const base, const gquic_str_t *const nonce) {
     size_t i;
     if (ret == NULL || base == NULL || nonce == NULL) {
         return -1;
     }
-    if (gquic_str_init(ret) != 0) {
-        return -2;
-    }
-    if (gquic_str_copy(ret, base) != 0) {
+    if (GQUIC_STR_SIZE(nonce) > GQUIC_STR_SIZE(base)) {
         return -2;
     }
+    // the nonce is right aligned against the iv
+    memcpy(ret, GQUIC_STR_VAL(base), GQUIC_STR_SIZE(base));
     for (i = 0; i < GQUIC_STR_SIZE(nonce); i++) {
-        ((unsigned char *) GQUIC_STR_VAL(ret))[i + 4] ^= ((unsigned char *) GQUIC_STR_VAL(nonce))[i];
+        ret[GQUIC_STR_SIZE(base) - GQUIC_STR_SIZE(nonce) + i] ^= ((unsigned char *) GQUIC_STR_VAL(nonce))[i];
     }
 
     return 0;
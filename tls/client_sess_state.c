@@ -0,0 +1,93 @@
+#include "tls/client_sess_state.h"
+#include <malloc.h>
+
+static int gquic_tls_client_sess_state_copy_str(void *const, const void *const);
+static int gquic_tls_client_sess_state_clear_strs(gquic_list_t *const);
+
+int gquic_tls_client_sess_state_init(gquic_tls_client_sess_state_t *const state) {
+    if (state == NULL) {
+        return -1;
+    }
+    gquic_str_init(&state->sess_ticket);
+    state->ver = 0;
+    state->cipher_suite = 0;
+    gquic_str_init(&state->master_sec);
+    gquic_list_head_init(&state->ser_certs);
+    gquic_list_head_init(&state->verified_chains);
+    state->received_at.tv_sec = 0;
+    state->received_at.tv_usec = 0;
+    gquic_str_init(&state->nonce);
+    state->use_by = 0;
+    state->age_add = 0;
+    state->max_early_data = 0;
+    gquic_str_init(&state->app_data);
+    return 0;
+}
+
+int gquic_tls_client_sess_state_dtor(gquic_tls_client_sess_state_t *const state) {
+    if (state == NULL) {
+        return -1;
+    }
+    gquic_str_reset(&state->sess_ticket);
+    gquic_str_reset(&state->master_sec);
+    gquic_str_reset(&state->nonce);
+    gquic_str_reset(&state->app_data);
+    gquic_tls_client_sess_state_clear_strs(&state->ser_certs);
+    gquic_tls_client_sess_state_clear_strs(&state->verified_chains);
+    return 0;
+}
+
+int gquic_tls_client_sess_state_copy(gquic_tls_client_sess_state_t *const state, const gquic_tls_client_sess_state_t *const ref) {
+    if (state == NULL || ref == NULL) {
+        return -1;
+    }
+    state->ver = ref->ver;
+    state->cipher_suite = ref->cipher_suite;
+    state->received_at = ref->received_at;
+    state->use_by = ref->use_by;
+    state->age_add = ref->age_add;
+    state->max_early_data = ref->max_early_data;
+    if (gquic_str_copy(&state->sess_ticket, &ref->sess_ticket) != 0
+        || gquic_str_copy(&state->master_sec, &ref->master_sec) != 0
+        || gquic_str_copy(&state->nonce, &ref->nonce) != 0
+        || gquic_str_copy(&state->app_data, &ref->app_data) != 0) {
+        return -2;
+    }
+    if (gquic_list_copy(&state->ser_certs, &ref->ser_certs, gquic_tls_client_sess_state_copy_str) != 0
+        || gquic_list_copy(&state->verified_chains, &ref->verified_chains, gquic_tls_client_sess_state_copy_str) != 0) {
+        return -3;
+    }
+    return 0;
+}
+
+gquic_tls_client_sess_state_t *gquic_tls_client_sess_state_alloc() {
+    gquic_tls_client_sess_state_t *state = malloc(sizeof(gquic_tls_client_sess_state_t));
+    if (state == NULL) {
+        return NULL;
+    }
+    gquic_tls_client_sess_state_init(state);
+    return state;
+}
+
+int gquic_tls_client_sess_state_release(gquic_tls_client_sess_state_t *const state) {
+    if (state == NULL) {
+        return -1;
+    }
+    gquic_tls_client_sess_state_dtor(state);
+    free(state);
+    return 0;
+}
+
+static int gquic_tls_client_sess_state_copy_str(void *const target, const void *const ref) {
+    return gquic_str_copy(target, ref);
+}
+
+static int gquic_tls_client_sess_state_clear_strs(gquic_list_t *const list) {
+    gquic_str_t *str = NULL;
+    while (!gquic_list_head_empty(list)) {
+        str = GQUIC_LIST_FIRST(list);
+        gquic_str_reset(str);
+        gquic_list_release(str);
+    }
+    return 0;
+}
@@ -1,3 +1,4 @@
+#include <openssl/evp.h>
 #include <openssl/sha.h>
 #include <string.h>
 #include "tls/config.h"
@@ -43,7 +44,6 @@ int gquic_tls_config_init(gquic_tls_config_t *const cfg) {
     cfg->min_v = 0;
     cfg->max_v = 0;
     cfg->dynamic_record_sizing_disabled = 0;
-    gquic_list_head_init(&cfg->sess_ticket_keys);
     cfg->renegotiation = 0;
     gquic_list_head_init(&cfg->curve_perfers);
     cfg->cli_sess_cache = NULL;
@@ -53,6 +53,12 @@ int gquic_tls_config_init(gquic_tls_config_t *const cfg) {
     cfg->verify_peer_certs = NULL;
     cfg->get_cli_cert = NULL;
     cfg->get_ser_cert = NULL;
+    gquic_tls_signer_init(&cfg->signer);
+    cfg->sign_pool = NULL;
+    cfg->key_share_pool = NULL;
+    cfg->ticket_keys = NULL;
+    cfg->max_early_data = 0;
+    cfg->anti_replay = NULL;
     gquic_tls_record_layer_init(&cfg->alt_record);
     cfg->enforce_next_proto_selection = 0;
     cfg->cli_auth = 0;
@@ -83,11 +89,11 @@ int gquic_tls_ticket_key_deserialize(gquic_tls_ticket_key_t *ticket_key, const v
     if (size != 32) {
         return -2;
     }
-    uint8_t hash[SHA256_DIGEST_LENGTH];
-    SHA256_CTX sha;
-    SHA256_Init(&sha);
-    SHA256_Update(&sha, buf, size);
-    SHA256_Final(hash, &sha);
+    // 48 bytes of key material need a digest longer than SHA-256
+    uint8_t hash[SHA512_DIGEST_LENGTH];
+    if (EVP_Digest(buf, size, hash, NULL, EVP_sha512(), NULL) <= 0) {
+        return -3;
+    }
     memcpy(ticket_key->name, hash, 16);
     memcpy(ticket_key->aes_key, hash + 16, 16);
     memcpy(ticket_key->hmac_key, hash + 32, 16);
@@ -121,7 +127,7 @@ int gquic_tls_config_supported_versions(gquic_list_t *ret, const gquic_tls_confi
 
 static u_int16_t __default_curve_preferences[] = {
     GQUIC_TLS_CURVE_X25519,
-    /*GQUIC_TLS_CURVE_P256,*/
+    GQUIC_TLS_CURVE_P256,
     /*GQUIC_TLS_CURVE_P384,*/
     /*GQUIC_TLS_CURVE_P521*/
 };
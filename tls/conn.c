@@ -36,6 +36,8 @@ static int gquic_compare_now_asn1_time(const ASN1_TIME *const);
 static int gquic_equal_common_name(const gquic_str_t *const, X509_NAME *const);
 
 static int gquic_tls_half_conn_inc_seq(gquic_tls_half_conn_t *const);
+static int gquic_tls_conn_handle_new_sess_ticket(gquic_tls_conn_t *const, const gquic_tls_new_sess_ticket_msg_t *const);
+static int gquic_tls_conn_copy_str(void *const, const void *const);
 
 
 int gquic_tls_half_conn_init(gquic_tls_half_conn_t *const half_conn) {
@@ -234,7 +236,14 @@ int gquic_tls_conn_init(gquic_tls_conn_t *const conn) {
     conn->buffering = 0;
     gquic_str_init(&conn->cli_proto);
     conn->cli_proto_fallback = 0;
+    conn->early_data = GQUIC_TLS_EARLY_DATA_NONE;
+    gquic_str_init(&conn->app_data);
     sem_init(&conn->handshake_mtx, 0, 1);
+    conn->ser_state = NULL;
+    conn->resumed = 0;
+    sem_init(&conn->resume_mtx, 0, 1);
+    conn->on_handshake_done.self = NULL;
+    conn->on_handshake_done.cb = NULL;
     return 0;
 
 }
@@ -342,7 +351,7 @@ int gquic_tls_conn_load_session(gquic_str_t *const cache_key,
     if (gquic_tls_conn_cli_sess_cache_key(cache_key, conn->addr, conn->cfg) != 0) {
         return -3;
     }
-    if (conn->cfg->cli_sess_cache->get(sess, conn->cfg->cli_sess_cache->self, cache_key) != 0 && *sess == NULL) {
+    if (conn->cfg->cli_sess_cache->get(sess, conn->cfg->cli_sess_cache->self, cache_key) != 0 || *sess == NULL) {
         return 0;
     }
     int ver_avail = 0;
@@ -416,6 +425,48 @@ int gquic_tls_conn_load_session(gquic_str_t *const cache_key,
     identity->obfuscated_ticket_age = ticket_age + (*sess)->age_add;
     gquic_list_insert_before(&hello->psk_identities, identity);
 
+    const gquic_tls_cipher_suite_t *psk_suite = NULL;
+    gquic_tls_mac_t hash;
+    gquic_str_t psk = { 0, NULL };
+    gquic_str_t *binder = NULL;
+    static const gquic_str_t label = { 10, "resumption" };
+    static const gquic_str_t resumption_binder_label = { 10, "res binder" };
+    if (gquic_tls_get_cipher_suite(&psk_suite, (*sess)->cipher_suite) != 0 || psk_suite == NULL) {
+        return -7;
+    }
+    gquic_tls_mac_init(&hash);
+    psk_suite->mac(&hash, GQUIC_TLS_VERSION_13, NULL);
+    if (gquic_tls_cipher_suite_expand_label(&psk, psk_suite, &(*sess)->master_sec, &label, &(*sess)->nonce, EVP_MD_size(hash.md)) != 0) {
+        gquic_tls_mac_dtor(&hash);
+        return -8;
+    }
+    if (gquic_tls_cipher_suite_extract(early_sec, psk_suite, &psk, NULL) != 0
+        || gquic_tls_cipher_suite_derive_secret(binder_key, psk_suite, NULL, early_sec, &resumption_binder_label) != 0) {
+        gquic_tls_mac_dtor(&hash);
+        gquic_str_reset(&psk);
+        return -9;
+    }
+    // the binder covers the hello up to the binders, so it is sized now and filled in once serialized
+    if ((binder = gquic_list_alloc(sizeof(gquic_str_t))) == NULL) {
+        gquic_tls_mac_dtor(&hash);
+        gquic_str_reset(&psk);
+        return -10;
+    }
+    gquic_str_init(binder);
+    if (gquic_str_alloc(binder, EVP_MD_size(hash.md)) != 0) {
+        gquic_list_release(binder);
+        gquic_tls_mac_dtor(&hash);
+        gquic_str_reset(&psk);
+        return -11;
+    }
+    memset(GQUIC_STR_VAL(binder), 0, GQUIC_STR_SIZE(binder));
+    gquic_list_insert_before(&hello->psk_binders, binder);
+    gquic_tls_mac_dtor(&hash);
+    gquic_str_reset(&psk);
+
+    if (conn->cfg->max_early_data != 0 && (*sess)->max_early_data != 0) {
+        hello->early_data = 1;
+    }
 
     return 0;
 }
@@ -747,7 +798,11 @@ int gquic_tls_conn_handshake(gquic_tls_conn_t *const conn) {
         }
     }
     else {
-        if ((ret = gquic_tls_server_handshake(conn)) != 0) {
+        if ((ret = gquic_tls_server_handshake(conn)) == GQUIC_TLS_HANDSHAKE_PENDING) {
+            // handshake_mtx is released when the suspended handshake ends
+            return GQUIC_TLS_HANDSHAKE_PENDING;
+        }
+        if (ret != 0) {
             return -3;
         }
     }
@@ -756,9 +811,20 @@ int gquic_tls_conn_handshake(gquic_tls_conn_t *const conn) {
     return 0;
 }
 
+int gquic_tls_conn_handshake_resume(gquic_tls_conn_t *const conn) {
+    if (conn == NULL) {
+        return -1;
+    }
+    if (conn->is_client) {
+        return 0;
+    }
+    return gquic_tls_server_handshake_resume(conn);
+}
+
 int gquic_tls_conn_get_sess_ticket(gquic_str_t *const msg, gquic_tls_conn_t *const conn) {
     int ret = 0;
     gquic_tls_sess_state_t state;
+    gquic_str_t plain = { 0, NULL };
     gquic_str_t *peer_cert = NULL;
     gquic_str_t *cert = NULL;
     gquic_tls_new_sess_ticket_msg_t *ticket = NULL;
@@ -768,7 +834,8 @@ int gquic_tls_conn_get_sess_ticket(gquic_str_t *const msg, gquic_tls_conn_t *con
     if (conn->is_client || conn->handshake_status != 1 || conn->cfg->alt_record.self == NULL) {
         return -2;
     }
-    if (conn->cfg->sess_ticket_disabled) {
+    // a ticket nobody can decrypt is not worth sending
+    if (conn->cfg->sess_ticket_disabled || conn->cfg->ticket_keys == NULL) {
         return 0;
     }
     if ((ticket = gquic_tls_new_sess_ticket_msg_alloc()) == NULL) {
@@ -777,209 +844,94 @@ int gquic_tls_conn_get_sess_ticket(gquic_str_t *const msg, gquic_tls_conn_t *con
     GQUIC_TLS_MSG_INIT(ticket);
     gquic_tls_sess_state_init(&state);
     GQUIC_LIST_FOREACH(peer_cert, &conn->peer_certs) {
-        if ((cert = gquic_list_alloc(sizeof(gquic_str_t *))) == NULL) {
-            return -3;
+        if ((cert = gquic_list_alloc(sizeof(gquic_str_t))) == NULL) {
+            ret = -3;
+            goto failure;
         }
         gquic_str_init(cert);
-        if (gquic_str_copy(cert, peer_cert) != 0) {
-            return -4;
-        }
         if (gquic_list_insert_before(&state.cert.certs, cert) != 0) {
-            return -5;
+            gquic_list_release(cert);
+            ret = -5;
+            goto failure;
+        }
+        if (gquic_str_copy(cert, peer_cert) != 0) {
+            ret = -4;
+            goto failure;
         }
     }
     // TODO copy ocsp and scts
     state.cipher_suite = conn->cipher_suite;
     if (gquic_str_copy(&state.resumption_sec, &conn->resumption_sec) != 0) {
-        return -6;
+        ret = -6;
+        goto failure;
     }
     state.create_at = time(NULL);
+    if (RAND_bytes((u_int8_t *) &state.age_add, sizeof(state.age_add)) <= 0) {
+        ret = -10;
+        goto failure;
+    }
+    state.max_early_data = conn->cfg->max_early_data;
 
-    if (gquic_str_alloc(&ticket->label, gquic_tls_sess_state_size(&state)) != 0) {
+    if (gquic_str_alloc(&plain, gquic_tls_sess_state_size(&state)) != 0) {
         ret = -7;
         goto failure;
     }
-    gquic_writer_str_t writer = ticket->label;
-    if (gquic_tls_sess_state_serialize(&state, &writer) <= 0) {
+    gquic_writer_str_t writer = plain;
+    if (gquic_tls_sess_state_serialize(&state, &writer) != 0) {
         ret = -8;
         goto failure;
     }
-    ticket->lifetime = 7 * 24 * 60;
+    if (gquic_tls_conn_encrypt_ticket(&ticket->label, conn, &plain) != 0) {
+        ret = -11;
+        goto failure;
+    }
+    ticket->lifetime = 7 * 24 * 60 * 60;
+    ticket->age_add = state.age_add;
+    ticket->max_early_data = state.max_early_data;
     if (gquic_tls_msg_combine_serialize(msg, ticket) != 0) {
         ret = -9;
         goto failure;
     }
+    gquic_str_reset(&plain);
+    gquic_tls_sess_state_dtor(&state);
     gquic_tls_msg_release(ticket);
     return 0;
 failure:
+    gquic_str_reset(&plain);
+    gquic_tls_sess_state_dtor(&state);
     gquic_tls_msg_release(ticket);
     return ret;
 }
 
 int gquic_tls_conn_encrypt_ticket(gquic_str_t *const encrypted, gquic_tls_conn_t *const conn, const gquic_str_t *const state) {
-    int ret = 0;
-    EVP_CIPHER_CTX *ctx = NULL;
-    HMAC_CTX *hmac = NULL;
-    int size = 0;
-    gquic_tls_ticket_key_t *key = NULL;
     if (encrypted == NULL || conn == NULL || state == NULL) {
         return -1;
     }
-    if ((ctx = EVP_CIPHER_CTX_new()) == NULL) {
+    if (conn->cfg->ticket_keys == NULL) {
         return -2;
     }
-    if (EVP_CIPHER_CTX_init(ctx) <= 0) {
-        ret = -3;
-        goto failure;
-    }
-    if ((hmac = HMAC_CTX_new()) == NULL) {
-        ret = -4;
-        goto failure;
-    }
-    if (gquic_str_alloc(encrypted, 16 + 16 + GQUIC_STR_SIZE(state) + 32) != 0) {
-        ret = -5;
-        goto failure;
-    }
-    if (RAND_bytes(GQUIC_STR_VAL(encrypted) + 16, 16) <= 0) {
-        ret = -6;
-        goto failure;
-    }
-    key = GQUIC_LIST_FIRST(&conn->cfg->sess_ticket_keys);
-    memcpy(GQUIC_STR_VAL(encrypted), key->name, 16);
-    if (EVP_EncryptInit_ex(ctx, EVP_aes_128_ctr(), NULL, key->aes_key, GQUIC_STR_VAL(encrypted) + 16) <= 0) {
-        ret = -7;
-        goto failure;
-    }
-    if (EVP_EncryptUpdate(ctx, GQUIC_STR_VAL(encrypted) + 16 + 16, &size, GQUIC_STR_VAL(state), GQUIC_STR_SIZE(state)) <= 0) {
-        ret = -8;
-        goto failure;
-    }
-    if (EVP_EncryptFinal_ex(ctx, GQUIC_STR_VAL(encrypted) + 16 + 16 + size, &size) <= 0) {
-        ret = -9;
-        goto failure;
-    }
-    if (HMAC_Init_ex(hmac, key->hmac_key, 16, EVP_sha256(), NULL) <= 0) {
-        ret = -10;
-        goto failure;
-    }
-    if (HMAC_Update(hmac, GQUIC_STR_VAL(encrypted), GQUIC_STR_SIZE(encrypted) - 32) <= 0) {
-        ret = -11;
-        goto failure;
-    }
-    if (HMAC_Final(hmac, GQUIC_STR_VAL(encrypted) + GQUIC_STR_SIZE(encrypted) - 32, (u_int32_t *) &size) <= 0) {
-        ret = -12;
-        goto failure;
-    }
-
-    if (ctx != NULL) {
-        EVP_CIPHER_CTX_free(ctx);
-    }
-    if (hmac != NULL) {
-        HMAC_CTX_free(hmac);
+    if (gquic_tls_ticket_keys_encrypt(encrypted, conn->cfg->ticket_keys, state) != 0) {
+        return -3;
     }
     return 0;
-failure:
-    if (ctx != NULL) {
-        EVP_CIPHER_CTX_free(ctx);
-    }
-    if (hmac != NULL) {
-        HMAC_CTX_free(hmac);
-    }
-    return ret;
 }
 
 int gquic_tls_conn_decrypt_ticket(gquic_str_t *const plain,
                                   int *const is_oldkey,
                                   gquic_tls_conn_t *const conn,
                                   const gquic_str_t *const encrypted) {
-    int ret = 0;
-    const gquic_str_t key_name = { 16, GQUIC_STR_VAL(encrypted) };
-    const gquic_str_t iv = { 16, GQUIC_STR_VAL(encrypted) + 16 };
-    const gquic_str_t mac = { 32, GQUIC_STR_VAL(encrypted) + GQUIC_STR_SIZE(encrypted) - 32 };
-    const gquic_str_t cipher_text = { GQUIC_STR_SIZE(encrypted) - 16 - 16 - 32, GQUIC_STR_VAL(encrypted) + 16 + 16 };
-    const gquic_list_t *keys = NULL;
-    const gquic_tls_ticket_key_t *key = NULL;
-    gquic_tls_ticket_key_t *key_itr = NULL;
-    u_int32_t size = 0;
-    u_int8_t mac_cnt[32] = { 0 };
-    const gquic_str_t mac_expect = { 32, mac_cnt };
-    HMAC_CTX *hmac = NULL;
-    EVP_CIPHER_CTX *ctx = NULL;
     if (plain == NULL || is_oldkey == NULL || conn == NULL || encrypted == NULL) {
         return -1;
     }
-    if (GQUIC_STR_SIZE(encrypted) < 16 + 16 + 32) {
-        return -2;
-    }
-    if ((hmac = HMAC_CTX_new()) == NULL) {
-        return -3;
-    }
-    if ((ctx = EVP_CIPHER_CTX_new()) == NULL) {
-        ret = -4;
-        goto failure;
-    }
-    keys = &conn->cfg->sess_ticket_keys;
-    GQUIC_LIST_FOREACH(key_itr, keys) {
-        const gquic_str_t name = { 16, key_itr->name };
-        if (gquic_str_cmp(&key_name, &name) == 0) {
-            key = key_itr;
-            break;
-        }
-    }
-    if (key == NULL) {
-        *is_oldkey = 0;
-        return 0;
-    }
-    if (HMAC_Init_ex(hmac, key->hmac_key, 16, EVP_sha256(), NULL) <= 0) {
-        ret = -5;
-        goto failure;
-    }
-    if (HMAC_Update(hmac, GQUIC_STR_VAL(encrypted), GQUIC_STR_SIZE(encrypted) - 32) <= 0) {
-        ret = -6;
-        goto failure;
-    }
-    if (HMAC_Final(hmac, mac_cnt, &size) <= 0) {
-        ret = -7;
-        goto failure;
-    }
-    if (gquic_str_cmp(&mac_expect, &mac) != 0) {
-        *is_oldkey = 0;
+    *is_oldkey = 0;
+    // without keys no ticket is ours, the client just gets a full handshake
+    if (conn->cfg->ticket_keys == NULL) {
         return 0;
     }
-    if (EVP_DecryptInit_ex(ctx, EVP_aes_128_ctr(), NULL, key->aes_key, GQUIC_STR_VAL(&iv)) <= 0) {
-        ret = -8;
-        goto failure;
-    }
-    if (gquic_str_alloc(plain, GQUIC_STR_SIZE(&cipher_text)) != 0) {
-        ret = -9;
-        goto failure;
-    }
-    if (EVP_DecryptUpdate(ctx, GQUIC_STR_VAL(plain), (int *) &size, GQUIC_STR_VAL(&cipher_text), GQUIC_STR_SIZE(&cipher_text)) != 0) {
-        ret = -10;
-        goto failure;
-    }
-    if (EVP_DecryptFinal_ex(ctx, GQUIC_STR_VAL(plain) + size, (int *) &size) <= 0) {
-        ret = -11;
-        goto failure;
-    }
-    *is_oldkey = 1;
-
-    if (ctx != NULL) {
-        EVP_CIPHER_CTX_free(ctx);
-    }
-    if (hmac != NULL) {
-        HMAC_CTX_free(hmac);
+    if (gquic_tls_ticket_keys_decrypt(plain, is_oldkey, conn->cfg->ticket_keys, encrypted) != 0) {
+        return -2;
     }
     return 0;
-failure:
-    *is_oldkey = 0;
-    if (ctx != NULL) {
-        EVP_CIPHER_CTX_free(ctx);
-    }
-    if (hmac != NULL) {
-        HMAC_CTX_free(hmac);
-    }
-    return ret;
 }
 
 int gquic_tls_conn_handle_post_handshake_msg(gquic_tls_conn_t *const conn) {
@@ -994,7 +946,11 @@ int gquic_tls_conn_handle_post_handshake_msg(gquic_tls_conn_t *const conn) {
 
     switch (GQUIC_TLS_MSG_META(msg).type) {
     case GQUIC_TLS_HANDSHAKE_MSG_TYPE_NEW_SESS_TICKET:
-        // TODO
+        if (gquic_tls_conn_handle_new_sess_ticket(conn, msg) != 0) {
+            gquic_tls_msg_release(msg);
+            return -3;
+        }
+        break;
     case GQUIC_TLS_HANDSHAKE_MSG_TYPE_KEY_UPDATE:
         // TODO
     default:
@@ -1004,3 +960,61 @@ int gquic_tls_conn_handle_post_handshake_msg(gquic_tls_conn_t *const conn) {
     gquic_tls_msg_release(msg);
     return 0;
 }
+
+static int gquic_tls_conn_handle_new_sess_ticket(gquic_tls_conn_t *const conn, const gquic_tls_new_sess_ticket_msg_t *const msg) {
+    gquic_tls_client_sess_state_t sess;
+    gquic_str_t cache_key = { 0, NULL };
+    const gquic_tls_cipher_suite_t *suite = NULL;
+    int ret = 0;
+    if (conn == NULL || msg == NULL) {
+        return -1;
+    }
+    if (!conn->is_client) {
+        gquic_tls_conn_send_alert(conn, GQUIC_TLS_ALERT_UNEXPECTED_MESSAGE);
+        return -2;
+    }
+    if (conn->cfg->sess_ticket_disabled || conn->cfg->cli_sess_cache == NULL || msg->lifetime == 0) {
+        return 0;
+    }
+    if (msg->lifetime > 7 * 24 * 60 * 60) {
+        gquic_tls_conn_send_alert(conn, GQUIC_TLS_ALERT_ILLEGAL_PARAMS);
+        return -3;
+    }
+    if (gquic_tls_get_cipher_suite(&suite, conn->cipher_suite) != 0 || suite == NULL || GQUIC_STR_SIZE(&conn->resumption_sec) == 0) {
+        gquic_tls_conn_send_alert(conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
+        return -4;
+    }
+
+    gquic_tls_client_sess_state_init(&sess);
+    sess.ver = conn->ver;
+    sess.cipher_suite = conn->cipher_suite;
+    sess.age_add = msg->age_add;
+    sess.max_early_data = msg->max_early_data;
+    gettimeofday(&sess.received_at, NULL);
+    sess.use_by = sess.received_at.tv_sec + msg->lifetime;
+    if (gquic_str_copy(&sess.sess_ticket, &msg->label) != 0
+        || gquic_str_copy(&sess.master_sec, &conn->resumption_sec) != 0
+        || gquic_str_copy(&sess.nonce, &msg->nonce) != 0
+        || gquic_str_copy(&sess.app_data, &conn->app_data) != 0
+        || gquic_list_copy(&sess.ser_certs, &conn->peer_certs, gquic_tls_conn_copy_str) != 0
+        || gquic_list_copy(&sess.verified_chains, &conn->verified_chains, gquic_tls_conn_copy_str) != 0) {
+        ret = -5;
+        goto finished;
+    }
+    if (gquic_tls_conn_cli_sess_cache_key(&cache_key, conn->addr, conn->cfg) != 0) {
+        ret = -6;
+        goto finished;
+    }
+    if (conn->cfg->cli_sess_cache->put(conn->cfg->cli_sess_cache->self, &cache_key, &sess) != 0) {
+        ret = -7;
+        goto finished;
+    }
+finished:
+    gquic_str_reset(&cache_key);
+    gquic_tls_client_sess_state_dtor(&sess);
+    return ret;
+}
+
+static int gquic_tls_conn_copy_str(void *const target, const void *const ref) {
+    return gquic_str_copy(target, ref);
+}
@@ -34,6 +34,7 @@ static int gquic_tls_encrypt_ext_msg_init(void *const msg) {
         return -1;
     }
     gquic_str_init(&spec->alpn_proto);
+    spec->early_data = 0;
     gquic_list_head_init(&spec->addition_exts);
     return 0;
 }
@@ -65,6 +66,8 @@ static ssize_t gquic_tls_encrypt_ext_msg_size(const void *const msg) {
     ret += 2;
     // alpn
     if (GQUIC_STR_SIZE(&spec->alpn_proto) != 0) ret += 2 + 2 + 2 + 1 + GQUIC_STR_SIZE(&spec->alpn_proto);
+    // early data
+    if (spec->early_data) ret += 2 + 2;
     gquic_tls_extension_t *ext;
     GQUIC_LIST_FOREACH(ext, &spec->addition_exts) ret += 2 + 2 + ext->data.size;
     return ret;
@@ -92,6 +95,10 @@ static int gquic_tls_encrypt_ext_msg_serialize(const void *const msg, gquic_writ
         __gquic_fill_str(writer, &spec->alpn_proto, 1);
         for (_lazy = 0; _lazy < 2; _lazy++) __gquic_fill_prefix_len(&prefix_len_stack, writer);
     }
+    if (spec->early_data) {
+        gquic_big_endian_writer_2byte(writer, GQUIC_TLS_EXTENSION_EARLY_DATA);
+        gquic_big_endian_writer_2byte(writer, 0);
+    }
     gquic_tls_extension_t *ext;
     GQUIC_LIST_FOREACH(ext, &spec->addition_exts) {
         gquic_big_endian_writer_2byte(writer, ext->type);
@@ -162,6 +169,11 @@ static ssize_t gquic_tls_encrypt_ext_msg_optional_deserialize(gquic_tls_encrypt_
             }
             break;
 
+        case GQUIC_TLS_EXTENSION_EARLY_DATA:
+            gquic_reader_str_readed_size(reader, 2);
+            msg->early_data = 1;
+            break;
+
         default:
             if ((field = gquic_list_alloc(sizeof(gquic_tls_extension_t))) == NULL) {
                 return -7;
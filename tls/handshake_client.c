@@ -65,6 +65,12 @@ static int gquic_tls_client_handshake_state_read_ser_finished(gquic_tls_handshak
 static int gquic_tls_client_handshake_state_send_cli_cert(gquic_tls_handshake_client_state_t *const);
 static int gquic_tls_client_handshake_state_send_cli_finished(gquic_tls_handshake_client_state_t *const);
 
+static int gquic_tls_client_handshake_update_binder(gquic_tls_client_hello_msg_t *const,
+                                                    const gquic_tls_cipher_suite_t *const,
+                                                    const gquic_str_t *const,
+                                                    gquic_tls_mac_t *const);
+static int gquic_tls_client_handshake_set_early_key(gquic_tls_handshake_client_state_t *const, const gquic_str_t *const);
+
 static int mutual_protocol(const gquic_str_t *const, const gquic_list_t *const);
 
 static int copy_peer_cert(void *const, const void *const);
@@ -77,6 +83,7 @@ int gquic_tls_handshake_client_state_init(gquic_tls_handshake_client_state_t *co
     cli_state->conn = NULL;
     cli_state->s_hello = NULL;
     cli_state->c_hello = NULL;
+    cli_state->sess = NULL;
     gquic_str_init(&cli_state->early_sec);
     gquic_str_init(&cli_state->binder_key);
     cli_state->cert_req = NULL;
@@ -246,7 +253,7 @@ static int gquic_tls_handshake_client_hello_edch_params_init(gquic_tls_ecdhe_par
         return -1;
     }
     if (*((u_int16_t *) GQUIC_LIST_FIRST(&msg->supported_versions)) == GQUIC_TLS_VERSION_13) {
-        if (gquic_tls_ecdhe_params_generate(params, GQUIC_TLS_CURVE_X25519) != 0) {
+        if (gquic_tls_key_share_pool_take(params, cfg->key_share_pool, GQUIC_TLS_CURVE_X25519) != 0) {
             ret = -2;
             goto failure;
         }
@@ -305,11 +312,34 @@ int gquic_tls_client_handshake(gquic_tls_conn_t *const conn) {
     if ((ret = gquic_tls_handshake_client_hello_init(&cli_state.c_hello, &cli_state.ecdhe_params, conn)) != 0) {
         return -4;
     }
-    if (gquic_tls_conn_load_session(&cache_key, &sess, &cli_state.early_sec, &cli_state.binder_key, conn, cli_state.c_hello) != 0) {
-        return -5;
+    ret = gquic_tls_conn_load_session(&cache_key, &sess, &cli_state.early_sec, &cli_state.binder_key, conn, cli_state.c_hello);
+    cli_state.sess = sess;
+    if (ret != 0) {
+        ret = -5;
+        goto failure;
+    }
+    if (!gquic_list_head_empty(&cli_state.c_hello->psk_identities)) {
+        const gquic_tls_cipher_suite_t *psk_suite = NULL;
+        gquic_tls_mac_t transport;
+        gquic_tls_mac_init(&transport);
+        if (gquic_tls_get_cipher_suite(&psk_suite, sess->cipher_suite) != 0
+            || psk_suite->mac(&transport, 0, NULL) != 0
+            || gquic_tls_client_handshake_update_binder(cli_state.c_hello, psk_suite, &cli_state.binder_key, &transport) != 0) {
+            gquic_tls_mac_dtor(&transport);
+            ret = -7;
+            goto failure;
+        }
+        gquic_tls_mac_dtor(&transport);
     }
     if (gquic_tls_msg_combine_serialize(&buf, cli_state.c_hello) != 0) {
-        return -6;
+        ret = -6;
+        goto failure;
+    }
+    // 0-RTT keys go in before the ClientHello leaves, early data rides along with it
+    cli_state.conn = conn;
+    if (cli_state.c_hello->early_data && gquic_tls_client_handshake_set_early_key(&cli_state, &buf) != 0) {
+        ret = -8;
+        goto failure;
     }
     if (gquic_tls_conn_write_record(&_, conn, GQUIC_TLS_RECORD_TYPE_HANDSHAKE, &buf) != 0) {
         ret = -9;
@@ -325,7 +355,6 @@ int gquic_tls_client_handshake(gquic_tls_conn_t *const conn) {
         goto failure;
     }
     cli_state.conn = conn;
-    cli_state.sess = sess;
     if ((ret = gquic_tls_client_handshake_state_handshake(&cli_state)) != 0) {
         ret = -12;
         goto failure;
@@ -500,6 +529,9 @@ int gquic_tls_handshake_client_state_dtor(gquic_tls_handshake_client_state_t *co
     if (cli_state->c_hello != NULL) {
         gquic_tls_msg_release(cli_state->c_hello);
     }
+    if (cli_state->sess != NULL) {
+        gquic_tls_client_sess_state_release(cli_state->sess);
+    }
     gquic_tls_ecdhe_params_dtor(&cli_state->ecdhe_params);
     gquic_str_reset(&cli_state->early_sec);
     gquic_str_reset(&cli_state->binder_key);
@@ -542,9 +574,12 @@ static int gquic_tls_client_handshake_state_process_hello_retry_request(gquic_tl
     if (cli_state == NULL) {
         return -1;
     }
-    if (gquic_tls_mac_md_sum(&ch_hash, &cli_state->transport) <= 0) {
+    if (gquic_tls_mac_md_sum(&ch_hash, &cli_state->transport) != 0) {
         return -2;
     }
+    if (gquic_tls_mac_md_reset(&cli_state->transport) != 0) {
+        return -3;
+    }
     const u_int8_t msg_hash_header_cnt[] = { GQUIC_TLS_HANDSHAKE_MSG_TYPE_MSG_HASH, 0, 0, (u_int8_t) GQUIC_STR_SIZE(&ch_hash) };
     const gquic_str_t msg_hash_header = { 4, (void *) msg_hash_header_cnt };
     gquic_tls_mac_md_update(&cli_state->transport, &msg_hash_header);
@@ -584,7 +619,7 @@ static int gquic_tls_client_handshake_state_process_hello_retry_request(gquic_tl
         gquic_tls_conn_send_alert(cli_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
         return -10;
     }
-    if (gquic_tls_ecdhe_params_generate(&cli_state->ecdhe_params, curve_id) != 0) {
+    if (gquic_tls_key_share_pool_take(&cli_state->ecdhe_params, cli_state->conn->cfg->key_share_pool, curve_id) != 0) {
         gquic_tls_conn_send_alert(cli_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
         return -11;
     }
@@ -606,12 +641,12 @@ static int gquic_tls_client_handshake_state_process_hello_retry_request(gquic_tl
         return -14;
     }
     key_share = NULL;
-
-    if (gquic_tls_msg_combine_serialize(&ch_buf, cli_state->c_hello) != 0) {
-        gquic_tls_conn_send_alert(cli_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
-        ret = -16;
-        goto failure;
+    // no early data after a HelloRetryRequest
+    if (cli_state->c_hello->early_data) {
+        cli_state->c_hello->early_data = 0;
+        cli_state->conn->early_data = GQUIC_TLS_EARLY_DATA_REJECTED;
     }
+
     if (!gquic_list_head_empty(&cli_state->c_hello->psk_identities)) {
         const gquic_tls_cipher_suite_t *psk_suite = NULL;
         if (gquic_tls_get_cipher_suite(&psk_suite, cli_state->sess->cipher_suite) != 0 || psk_suite == NULL) {
@@ -625,44 +660,16 @@ static int gquic_tls_client_handshake_state_process_hello_retry_request(gquic_tl
             gquic_tls_psk_identity_t *psk_identity = GQUIC_LIST_FIRST(&cli_state->c_hello->psk_identities);
             psk_identity->obfuscated_ticket_age = ticket_age + cli_state->sess->age_add;
 
+            // the binder covers the transcript so far, message_hash(CH1) and the HelloRetryRequest
             gquic_tls_mac_t transport;
             gquic_tls_mac_init(&transport);
-            cli_state->suite->mac(&transport, 0, NULL);
-
-            u_int8_t msg_hash_header_cnt[] = { GQUIC_TLS_HANDSHAKE_MSG_TYPE_MSG_HASH, 0, 0, (u_int8_t) GQUIC_STR_SIZE(&ch_hash) }; 
-            const gquic_str_t msg_hash_header = { 4, (void *) msg_hash_header_cnt };
-            const gquic_str_t ch_buf_without_binder = {
-                gquic_tls_client_hello_msg_size_without_binders(cli_state->c_hello),
-                GQUIC_STR_VAL(&ch_buf)
-            };
-            gquic_tls_mac_md_update(&transport, &msg_hash_header);
-            gquic_tls_mac_md_update(&transport, &ch_hash);
-            gquic_tls_mac_md_update(&transport, &sh_buf);
-            gquic_tls_mac_md_update(&transport, &ch_buf_without_binder);
-            gquic_str_t binder = { 0, NULL };
-            if (gquic_tls_mac_md_sum(&binder, &transport) != 0) {
-                ret = -18;
+            if (gquic_tls_mac_md_copy(&transport, &cli_state->transport) != 0
+                || gquic_tls_client_handshake_update_binder(cli_state->c_hello, cli_state->suite, &cli_state->binder_key, &transport) != 0) {
                 gquic_tls_mac_dtor(&transport);
+                ret = -18;
                 goto failure;
             }
             gquic_tls_mac_dtor(&transport);
-
-            size_t origin_psk_binders_count = 0;
-            void *_;
-            GQUIC_LIST_FOREACH(_, &cli_state->c_hello->psk_binders) origin_psk_binders_count++;
-            if (origin_psk_binders_count != 0) {
-                ret = -19;
-                gquic_str_reset(&binder);
-                goto failure;
-            }
-            gquic_str_t *psk_binder = GQUIC_LIST_FIRST(&cli_state->c_hello->psk_binders);
-            if (GQUIC_STR_SIZE(psk_binder) != GQUIC_STR_SIZE(&binder)) {
-                ret = -20;
-                gquic_str_reset(&binder);
-                goto failure;
-            }
-            gquic_str_reset(psk_binder);
-            psk_binder->val = GQUIC_STR_VAL(&binder);
         }
         else {
             while (!gquic_list_head_empty(&cli_state->c_hello->psk_identities)) {
@@ -678,11 +685,21 @@ static int gquic_tls_client_handshake_state_process_hello_retry_request(gquic_tl
         }
     }
 
+    if (gquic_tls_msg_combine_serialize(&ch_buf, cli_state->c_hello) != 0) {
+        gquic_tls_conn_send_alert(cli_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
+        ret = -16;
+        goto failure;
+    }
     if (gquic_tls_conn_write_record(&_, cli_state->conn, GQUIC_TLS_RECORD_TYPE_HANDSHAKE, &ch_buf) != 0) {
         gquic_tls_conn_send_alert(cli_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
         ret = -21;
         goto failure;
     }
+    if (gquic_tls_mac_md_update(&cli_state->transport, &ch_buf) != 0) {
+        gquic_tls_conn_send_alert(cli_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
+        ret = -24;
+        goto failure;
+    }
     if (cli_state->s_hello != NULL) {
         gquic_tls_msg_release(cli_state->s_hello);
         cli_state->s_hello = NULL;
@@ -726,7 +743,7 @@ static int gquic_tls_client_handshake_state_process_server_hello(gquic_tls_hands
         gquic_tls_conn_send_alert(cli_state->conn, GQUIC_TLS_ALERT_UNEXPECTED_MESSAGE);
         return -2;
     }
-    if (GQUIC_STR_SIZE(&cli_state->s_hello->cookie) == 0) {
+    if (GQUIC_STR_SIZE(&cli_state->s_hello->cookie) != 0) {
         gquic_tls_conn_send_alert(cli_state->conn, GQUIC_TLS_ALERT_UNSUPPORTED_EXTENSION);
         return -3;
     }
@@ -879,6 +896,7 @@ failure:
 
 static int gquic_tls_client_handshake_state_read_ser_params(gquic_tls_handshake_client_state_t *const cli_state) {
     gquic_tls_encrypt_ext_msg_t *msg = NULL;
+    gquic_tls_extension_t *ext = NULL;
     gquic_str_t buf = { 0, NULL };
     int ret = 0;
     if (cli_state == NULL) {
@@ -898,6 +916,26 @@ static int gquic_tls_client_handshake_state_read_ser_params(gquic_tls_handshake_
         ret = -4;
         goto failure;
     }
+    if (cli_state->conn->early_data == GQUIC_TLS_EARLY_DATA_OFFERED) {
+        cli_state->conn->early_data = msg->early_data ? GQUIC_TLS_EARLY_DATA_ACCEPTED : GQUIC_TLS_EARLY_DATA_REJECTED;
+    }
+    else if (msg->early_data) {
+        gquic_tls_conn_send_alert(cli_state->conn, GQUIC_TLS_ALERT_UNSUPPORTED_EXTENSION);
+        ret = -5;
+        goto failure;
+    }
+    // remembered with the next ticket, a later 0-RTT attempt starts from these parameters
+    GQUIC_LIST_FOREACH(ext, &msg->addition_exts) {
+        if (ext->type == GQUIC_TLS_EXTENSION_QUIC) {
+            gquic_str_reset(&cli_state->conn->app_data);
+            if (gquic_str_copy(&cli_state->conn->app_data, &ext->data) != 0) {
+                gquic_tls_conn_send_alert(cli_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
+                ret = -12;
+                goto failure;
+            }
+            break;
+        }
+    }
     if (gquic_tls_msg_combine_serialize(&buf, msg) != 0) {
         gquic_tls_conn_send_alert(cli_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
         ret = -6;
@@ -1054,7 +1092,7 @@ static int gquic_tls_client_handshake_state_read_ser_cert(gquic_tls_handshake_cl
         ret = -20;
         goto failure;
     }
-    if (gquic_tls_signed_msg(&sign, sig_hash, &ser_sign_cnt, &cli_state->transport) != 0) {
+    if (gquic_tls_signed_msg(&sign, NULL, &ser_sign_cnt, &cli_state->transport) != 0) {
         gquic_tls_conn_send_alert(cli_state->conn, GQUIC_TLS_ALERT_ILLEGAL_PARAMS);
         ret = -21;
         goto failure;
@@ -1064,7 +1102,7 @@ static int gquic_tls_client_handshake_state_read_ser_cert(gquic_tls_handshake_cl
         ret = -22;
         goto failure;
     }
-    if (gquic_tls_verify_handshake_sign(sig_hash, pubkey, &sign, &verify_msg->sign) != 0) {
+    if (gquic_tls_verify_handshake_sign(sig_hash, sig_type, pubkey, &sign, &verify_msg->sign) != 0) {
         gquic_tls_conn_send_alert(cli_state->conn, GQUIC_TLS_ALERT_DECRYPT_ERROR);
         ret = -23;
         goto failure;
@@ -1275,6 +1313,86 @@ failure:
     return ret;
 }
 
+static int gquic_tls_client_handshake_update_binder(gquic_tls_client_hello_msg_t *const c_hello,
+                                                    const gquic_tls_cipher_suite_t *const psk_suite,
+                                                    const gquic_str_t *const binder_key,
+                                                    gquic_tls_mac_t *const transport) {
+    int ret = 0;
+    gquic_str_t buf = { 0, NULL };
+    gquic_str_t binder = { 0, NULL };
+    gquic_str_t *psk_binder = NULL;
+    if (c_hello == NULL || psk_suite == NULL || binder_key == NULL || transport == NULL) {
+        return -1;
+    }
+    if (gquic_list_head_empty(&c_hello->psk_binders)) {
+        return -2;
+    }
+    if (gquic_tls_msg_combine_serialize(&buf, c_hello) != 0) {
+        return -3;
+    }
+    const gquic_str_t buf_without_binders = { gquic_tls_client_hello_msg_size_without_binders(c_hello), GQUIC_STR_VAL(&buf) };
+    if (gquic_tls_mac_md_update(transport, &buf_without_binders) != 0) {
+        ret = -4;
+        goto finished;
+    }
+    if (gquic_tls_cipher_suite_finished_hash(&binder, psk_suite, binder_key, transport) != 0) {
+        ret = -5;
+        goto finished;
+    }
+    psk_binder = GQUIC_LIST_FIRST(&c_hello->psk_binders);
+    if (GQUIC_STR_SIZE(psk_binder) != GQUIC_STR_SIZE(&binder)) {
+        ret = -6;
+        goto finished;
+    }
+    memcpy(GQUIC_STR_VAL(psk_binder), GQUIC_STR_VAL(&binder), GQUIC_STR_SIZE(&binder));
+finished:
+    gquic_str_reset(&buf);
+    gquic_str_reset(&binder);
+    return ret;
+}
+
+static int gquic_tls_client_handshake_set_early_key(gquic_tls_handshake_client_state_t *const cli_state, const gquic_str_t *const c_hello_buf) {
+    int ret = 0;
+    const gquic_tls_cipher_suite_t *psk_suite = NULL;
+    gquic_tls_mac_t transport;
+    gquic_str_t early_traffic_sec = { 0, NULL };
+    static const gquic_str_t cli_early_traffic_label = { 11, "c e traffic" };
+    if (cli_state == NULL || c_hello_buf == NULL) {
+        return -1;
+    }
+    gquic_tls_mac_init(&transport);
+    if (gquic_tls_get_cipher_suite(&psk_suite, cli_state->sess->cipher_suite) != 0 || psk_suite->mac(&transport, 0, NULL) != 0) {
+        return -2;
+    }
+    if (gquic_tls_mac_md_update(&transport, c_hello_buf) != 0) {
+        ret = -3;
+        goto finished;
+    }
+    if (gquic_tls_cipher_suite_derive_secret(&early_traffic_sec,
+                                             psk_suite,
+                                             &transport,
+                                             &cli_state->early_sec,
+                                             &cli_early_traffic_label) != 0) {
+        ret = -4;
+        goto finished;
+    }
+    // early data runs under the transport parameters of the connection the ticket came from
+    gquic_str_reset(&cli_state->conn->app_data);
+    if (gquic_str_copy(&cli_state->conn->app_data, &cli_state->sess->app_data) != 0) {
+        ret = -5;
+        goto finished;
+    }
+    cli_state->conn->early_data = GQUIC_TLS_EARLY_DATA_OFFERED;
+    if (gquic_tls_half_conn_set_key(&cli_state->conn->out, GQUIC_ENC_LV_0RTT, psk_suite, &early_traffic_sec) != 0) {
+        ret = -6;
+        goto finished;
+    }
+finished:
+    gquic_tls_mac_dtor(&transport);
+    gquic_str_reset(&early_traffic_sec);
+    return ret;
+}
+
 static int mutual_protocol(const gquic_str_t *const proto, const gquic_list_t *const perfer_protos) {
     if (proto == NULL || perfer_protos == NULL) {
         return -1;
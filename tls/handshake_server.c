@@ -11,8 +11,10 @@
 #include "tls/ticket.h"
 #include "tls/meta.h"
 #include <openssl/rand.h>
+#include <sys/time.h>
 #include <openssl/x509.h>
 #include <openssl/pkcs12.h>
+#include <malloc.h>
 
 static u_int16_t __supported_sign_algos[] = {
     GQUIC_SIGALG_ED25519,
@@ -36,9 +38,18 @@ static int gquic_tls_handshake_server_state_check_for_resumption(gquic_tls_hands
 static int gquic_tls_handshake_server_state_pick_cert(gquic_tls_handshake_server_state_t *const);
 static int gquic_tls_handshake_server_state_send_ser_params(gquic_tls_handshake_server_state_t *const);
 static int gquic_tls_handshake_server_state_send_ser_cert(gquic_tls_handshake_server_state_t *const);
+static int gquic_tls_handshake_server_state_send_cert_verify(gquic_tls_handshake_server_state_t *const, gquic_tls_cert_verify_msg_t *const);
+static int gquic_tls_handshake_server_state_suspend(gquic_tls_handshake_server_state_t *const);
+static int gquic_tls_handshake_server_state_signed(void *const, const int);
+static int gquic_tls_handshake_server_state_complete(gquic_tls_handshake_server_state_t *const, const int);
+static int gquic_tls_handshake_server_state_sign(gquic_str_t *const,
+                                                 gquic_tls_handshake_server_state_t *const,
+                                                 EVP_PKEY *const,
+                                                 const gquic_str_t *const);
 static int gquic_tls_handshake_server_state_send_ser_finished(gquic_tls_handshake_server_state_t *const);
 static int gquic_tls_handshake_server_state_read_cli_cert(gquic_tls_handshake_server_state_t *const);
 static int gquic_tls_handshake_server_state_read_cli_finished(gquic_tls_handshake_server_state_t *const);
+static int gquic_tls_handshake_server_state_read_cli(gquic_tls_handshake_server_state_t *const);
 static int gquic_tls_handshake_server_state_illegal_client_hello_change(gquic_tls_client_hello_msg_t *const, gquic_tls_client_hello_msg_t *const);
 static int gquic_tls_handshake_server_state_send_session_tickets(gquic_tls_handshake_server_state_t *const);
 static int gquic_tls_handshake_server_state_should_send_session_tickets(gquic_tls_handshake_server_state_t *const);
@@ -62,6 +73,7 @@ int gquic_tls_handshake_server_state_init(gquic_tls_handshake_server_state_t *co
     ser_state->s_hello = NULL;
     ser_state->sent_dummy_ccs = 0;
     ser_state->using_psk = 0;
+    ser_state->early_data = 0;
     ser_state->suite = NULL;
     gquic_str_init(&ser_state->cert);
     ser_state->sigalg = 0;
@@ -72,6 +84,10 @@ int gquic_tls_handshake_server_state_init(gquic_tls_handshake_server_state_t *co
     gquic_str_init(&ser_state->traffic_sec);
     gquic_tls_mac_init(&ser_state->transport);
     gquic_str_init(&ser_state->cli_finished);
+    ser_state->pkey = NULL;
+    ser_state->stage = GQUIC_TLS_SERVER_STAGE_RUNNING;
+    ser_state->verify_msg = NULL;
+    gquic_str_init(&ser_state->signed_cnt);
 
     return 0;
 }
@@ -94,34 +110,65 @@ int gquic_tls_handshake_server_state_release(gquic_tls_handshake_server_state_t
     gquic_str_reset(&ser_state->traffic_sec);
     gquic_tls_mac_dtor(&ser_state->transport);
     gquic_str_reset(&ser_state->cli_finished);
+    if (ser_state->pkey != NULL) {
+        EVP_PKEY_free(ser_state->pkey);
+    }
+    if (ser_state->verify_msg != NULL) {
+        gquic_tls_msg_release(ser_state->verify_msg);
+    }
+    gquic_str_reset(&ser_state->signed_cnt);
     return 0;
 }
 
 int gquic_tls_server_handshake(gquic_tls_conn_t *const conn) {
     int ret = 0;
-    gquic_tls_handshake_server_state_t ser_state;
+    gquic_tls_handshake_server_state_t *ser_state = NULL;
     if (conn == NULL) {
         return -1;
     }
-    gquic_tls_handshake_server_state_init(&ser_state);
-    ser_state.conn = conn;
+    if ((ser_state = malloc(sizeof(gquic_tls_handshake_server_state_t))) == NULL) {
+        return -3;
+    }
+    gquic_tls_handshake_server_state_init(ser_state);
+    ser_state->conn = conn;
     if (gquic_tls_conn_set_alt_record(conn) != 0) {
+        free(ser_state);
         return -2;
     }
-    if ((ret = gquic_tls_conn_read_handshake((void **) &ser_state.c_hello, conn)) != 0
-        || GQUIC_TLS_MSG_META(ser_state.c_hello).type != GQUIC_TLS_HANDSHAKE_MSG_TYPE_CLIENT_HELLO) {
-        gquic_tls_msg_release(ser_state.c_hello);
+    if ((ret = gquic_tls_conn_read_handshake((void **) &ser_state->c_hello, conn)) != 0
+        || GQUIC_TLS_MSG_META(ser_state->c_hello).type != GQUIC_TLS_HANDSHAKE_MSG_TYPE_CLIENT_HELLO) {
+        gquic_tls_msg_release(ser_state->c_hello);
+        free(ser_state);
         return -4;
     }
-    if ((ret = gquic_tls_server_handshake_state_handshake(&ser_state)) != 0) {
-        gquic_tls_handshake_server_state_release(&ser_state);
+    // a suspended handshake belongs to the sign pool from here on
+    if ((ret = gquic_tls_server_handshake_state_handshake(ser_state)) == GQUIC_TLS_HANDSHAKE_PENDING) {
+        return GQUIC_TLS_HANDSHAKE_PENDING;
+    }
+    gquic_tls_handshake_server_state_release(ser_state);
+    free(ser_state);
+    if (ret != 0) {
         return -5 + ret * 100;
     }
-    
-    gquic_tls_handshake_server_state_release(&ser_state);
     return 0;
 }
 
+int gquic_tls_server_handshake_resume(gquic_tls_conn_t *const conn) {
+    gquic_tls_handshake_server_state_t *ser_state = NULL;
+    if (conn == NULL) {
+        return -1;
+    }
+    sem_wait(&conn->resume_mtx);
+    conn->resumed = 1;
+    ser_state = conn->ser_state;
+    if (ser_state == NULL || ser_state->stage != GQUIC_TLS_SERVER_STAGE_WAIT_CLI_FINISHED) {
+        // not suspended, or the sign pool worker reads it once it is done
+        sem_post(&conn->resume_mtx);
+        return 0;
+    }
+    return gquic_tls_handshake_server_state_complete(ser_state, gquic_tls_handshake_server_state_read_cli(ser_state));
+}
+
 int gquic_tls_server_handshake_state_handshake(gquic_tls_handshake_server_state_t *const ser_state) {
     int ret = 0;
     if (ser_state == NULL) {
@@ -141,12 +188,20 @@ int gquic_tls_server_handshake_state_handshake(gquic_tls_handshake_server_state_
     if (gquic_tls_handshake_server_state_send_ser_params(ser_state) != 0) {
         return -5;
     }
-    if (gquic_tls_handshake_server_state_send_ser_cert(ser_state) != 0) {
-        return -6;
+    if ((ret = gquic_tls_handshake_server_state_send_ser_cert(ser_state)) != 0) {
+        return ret == GQUIC_TLS_HANDSHAKE_PENDING ? ret : -6;
     }
     if (gquic_tls_handshake_server_state_send_ser_finished(ser_state) != 0) {
         return -7;
     }
+
+    return gquic_tls_handshake_server_state_read_cli(ser_state);
+}
+
+static int gquic_tls_handshake_server_state_read_cli(gquic_tls_handshake_server_state_t *const ser_state) {
+    if (ser_state == NULL) {
+        return -1;
+    }
     if (gquic_tls_handshake_server_state_read_cli_cert(ser_state) != 0) {
         return -8;
     }
@@ -227,11 +282,6 @@ static int gquic_tls_handshake_server_state_process_cli_hello(gquic_tls_handshak
         ret = -9;
         goto failure;
     }
-    if (ser_state->c_hello->early_data) {
-        gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_UNSUPPORTED_EXTENSION);
-        ret = -10;
-        goto failure;
-    }
     if (gquic_str_copy(&ser_state->s_hello->sess_id, &ser_state->c_hello->sess_id) != 0) {
         gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
         ret = -11;
@@ -292,7 +342,7 @@ select_curve_perfers:
         }
         cli_key_share = GQUIC_LIST_FIRST(&ser_state->c_hello->key_shares);
     }
-    if (gquic_tls_ecdhe_params_generate(&ecdhe_param, selected_group) != 0) {
+    if (gquic_tls_key_share_pool_take(&ecdhe_param, ser_state->conn->cfg->key_share_pool, selected_group) != 0) {
         gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
         ret = -17;
         goto failure;
@@ -557,7 +607,7 @@ static int gquic_tls_handshake_server_state_check_for_resumption(gquic_tls_hands
         if (gquic_tls_sess_state_deserialize(&sess_state, &reader) != 0) {
             goto continue_loop;
         }
-        if (time(NULL) - sess_state.create_at < 7 * 24 * 60 * 60) {
+        if (time(NULL) - sess_state.create_at > 7 * 24 * 60 * 60) {
             goto continue_loop;
         }
         if (gquic_tls_get_cipher_suite(&psk_suite, sess_state.cipher_suite) != 0) {
@@ -618,7 +668,12 @@ static int gquic_tls_handshake_server_state_check_for_resumption(gquic_tls_hands
             gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
             goto failure;
         }
-        buf.size = gquic_tls_client_hello_msg_size_without_binders(ser_state->c_hello);
+        const gquic_str_t buf_without_binders = { gquic_tls_client_hello_msg_size_without_binders(ser_state->c_hello), GQUIC_STR_VAL(&buf) };
+        if (gquic_tls_mac_md_update(&transport, &buf_without_binders) != 0) {
+            ret = -9;
+            gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
+            goto failure;
+        }
         if (gquic_tls_cipher_suite_finished_hash(&psk_binder, ser_state->suite, &binder_key, &transport) != 0) {
             ret = -10;
             gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
@@ -639,7 +694,24 @@ static int gquic_tls_handshake_server_state_check_for_resumption(gquic_tls_hands
         }
 
         // TODO process client certs
-        
+
+        // 0-RTT is only taken on the first identity, with the ticket's own cipher suite
+        if (i == 0
+            && ser_state->c_hello->early_data
+            && ser_state->conn->cfg->max_early_data != 0
+            && sess_state.max_early_data != 0
+            && sess_state.cipher_suite == ser_state->suite->id
+            && ser_state->conn->cfg->anti_replay != NULL) {
+            struct timeval now;
+            gettimeofday(&now, NULL);
+            const int64_t now_ms = (int64_t) now.tv_sec * 1000 + now.tv_usec / 1000;
+            const int64_t age = (int64_t) now_ms - (int64_t) sess_state.create_at * 1000;
+            const int64_t reported_age = (u_int32_t) (identity->obfuscated_ticket_age - sess_state.age_add);
+            if (gquic_tls_anti_replay_check(ser_state->conn->cfg->anti_replay, &identity->label, reported_age - age, now_ms) == 0) {
+                ser_state->early_data = 1;
+            }
+        }
+
         ser_state->s_hello->selected_identity_persent = 1;
         ser_state->s_hello->selected_identity = i;
         ser_state->using_psk = 1;
@@ -744,6 +816,7 @@ static int gquic_tls_handshake_server_state_send_ser_params(gquic_tls_handshake_
     static const gquic_str_t derived_label = { 7, "derived" };
     static const gquic_str_t ser_handshake_traffic_label = { 12, "s hs traffic" };
     static const gquic_str_t cli_handshake_traffic_label = { 12, "c hs traffic" };
+    static const gquic_str_t cli_early_traffic_label = { 11, "c e traffic" };
     size_t _;
     const gquic_str_t *selected_proto = NULL;
     if (ser_state == NULL) {
@@ -764,6 +837,22 @@ static int gquic_tls_handshake_server_state_send_ser_params(gquic_tls_handshake_
         ret = -4;
         goto failure;
     }
+    if (ser_state->early_data) {
+        if (gquic_tls_cipher_suite_derive_secret(&cli_sec, ser_state->suite, &ser_state->transport, &ser_state->early_sec, &cli_early_traffic_label) != 0) {
+            gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
+            ret = -24;
+            goto failure;
+        }
+        if (gquic_tls_half_conn_set_key(&ser_state->conn->in, GQUIC_ENC_LV_0RTT, ser_state->suite, &cli_sec) != 0) {
+            gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
+            ret = -25;
+            goto failure;
+        }
+        gquic_str_reset(&cli_sec);
+        gquic_str_init(&cli_sec);
+        ser_state->conn->early_data = GQUIC_TLS_EARLY_DATA_ACCEPTED;
+        enc_ext->early_data = 1;
+    }
     gquic_str_reset(&buf);
     gquic_str_init(&buf);
     if (gquic_tls_msg_combine_serialize(&buf, ser_state->s_hello) != 0) {
@@ -885,7 +974,7 @@ static int gquic_tls_handshake_server_state_send_ser_params(gquic_tls_handshake_
     gquic_str_reset(&early_sec_derived_sec);
     gquic_str_reset(&cli_sec);
     gquic_str_reset(&ser_sec);
-    gquic_tls_msg_release(&enc_ext);
+    gquic_tls_msg_release(enc_ext);
     return 0;
 failure:
 
@@ -894,7 +983,7 @@ failure:
     gquic_str_reset(&early_sec_derived_sec);
     gquic_str_reset(&cli_sec);
     gquic_str_reset(&ser_sec);
-    gquic_tls_msg_release(&enc_ext);
+    gquic_tls_msg_release(enc_ext);
     return ret;
 }
 
@@ -924,9 +1013,7 @@ static int gquic_tls_handshake_server_state_send_ser_cert(gquic_tls_handshake_se
     gquic_tls_cert_verify_msg_t *verify_msg = NULL;
     gquic_str_t buf = { 0, NULL };
     PKCS12 *cert_p12 = NULL;
-    EVP_MD_CTX *md_ctx = NULL;
     X509 *x509 = NULL;
-    EVP_PKEY *pkey = NULL;
     u_int8_t *x509_cnt = NULL;
     const u_int8_t *cert_cnt = NULL;
     gquic_str_t *cert = NULL;
@@ -984,7 +1071,7 @@ static int gquic_tls_handshake_server_state_send_ser_cert(gquic_tls_handshake_se
         ret = -4;
         goto failure;
     }
-    if (PKCS12_parse(cert_p12, NULL, &pkey, &x509, NULL) <= 0) {
+    if (PKCS12_parse(cert_p12, NULL, &ser_state->pkey, &x509, NULL) <= 0) {
         gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
         ret = -5;
         goto failure;
@@ -1035,53 +1122,27 @@ static int gquic_tls_handshake_server_state_send_ser_cert(gquic_tls_handshake_se
         ret = -14;
         goto failure;
     }
-    if ((md_ctx = EVP_MD_CTX_new()) == NULL) {
-        gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
-        ret = -15;
-        goto failure;
-    }
-    if (EVP_MD_CTX_init(md_ctx) <= 0) {
-        gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
-        ret = -16;
-        goto failure;
-    }
-    if (EVP_DigestSignInit(md_ctx, NULL, NULL, NULL, pkey) <= 0) {
-        gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
-        ret = -17;
-        goto failure;
-    }
-    if (EVP_DigestSign(md_ctx, NULL, &_, GQUIC_STR_VAL(&buf), GQUIC_STR_SIZE(&buf)) <= 0) {
-        gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
-        ret = -18;
-        goto failure;
-    }
-    if (gquic_str_alloc(&verify_msg->sign, _) != 0) {
-        gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
-        ret = -19;
+    if (ser_state->conn->cfg->sign_pool != NULL && ser_state->conn->on_handshake_done.cb != NULL) {
+        // once submitted, ser_state belongs to the sign pool worker
+        ser_state->verify_msg = verify_msg;
+        verify_msg = NULL;
+        ser_state->signed_cnt = buf;
+        gquic_str_init(&buf);
+        if ((ret = gquic_tls_handshake_server_state_suspend(ser_state)) != GQUIC_TLS_HANDSHAKE_PENDING) {
+            gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
+            ret = -16;
+        }
         goto failure;
     }
-    if (EVP_DigestSign(md_ctx, GQUIC_STR_VAL(&verify_msg->sign), &_, GQUIC_STR_VAL(&buf), GQUIC_STR_SIZE(&buf)) <= 0) {
+    if (gquic_tls_handshake_server_state_sign(&verify_msg->sign, ser_state, ser_state->pkey, &buf) != 0) {
         gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
-        ret = -20;
+        ret = -15;
         goto failure;
     }
-    gquic_str_reset(&buf);
-    gquic_str_init(&buf);
-    if (gquic_tls_msg_combine_serialize(&buf, verify_msg) != 0) {
-        gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
+    if (gquic_tls_handshake_server_state_send_cert_verify(ser_state, verify_msg) != 0) {
         ret = -22;
         goto failure;
     }
-    if (gquic_tls_mac_md_update(&ser_state->transport, &buf) != 0) {
-        gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
-        ret = -23;
-        goto failure;
-    }
-    if (gquic_tls_conn_write_record(&_, ser_state->conn, GQUIC_TLS_RECORD_TYPE_HANDSHAKE, &buf) != 0) {
-        gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
-        ret = -24;
-        goto failure;
-    }
 
     gquic_tls_msg_release(cert_req);
     gquic_tls_msg_release(cert_msg);
@@ -1090,9 +1151,6 @@ static int gquic_tls_handshake_server_state_send_ser_cert(gquic_tls_handshake_se
     if (cert_p12 != NULL) {
         PKCS12_free(cert_p12);
     }
-    if (md_ctx != NULL) {
-        EVP_MD_CTX_free(md_ctx);
-    }
     return 0;
 failure:
 
@@ -1103,12 +1161,125 @@ failure:
     if (cert_p12 != NULL) {
         PKCS12_free(cert_p12);
     }
-    if (md_ctx != NULL) {
-        EVP_MD_CTX_free(md_ctx);
+    return ret;
+}
+
+static int gquic_tls_handshake_server_state_send_cert_verify(gquic_tls_handshake_server_state_t *const ser_state,
+                                                             gquic_tls_cert_verify_msg_t *const verify_msg) {
+    int ret = 0;
+    gquic_str_t buf = { 0, NULL };
+    size_t _;
+    if (ser_state == NULL || verify_msg == NULL) {
+        return -1;
+    }
+    if (gquic_tls_msg_combine_serialize(&buf, verify_msg) != 0) {
+        gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
+        return -2;
+    }
+    if (gquic_tls_mac_md_update(&ser_state->transport, &buf) != 0) {
+        gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
+        ret = -3;
+        goto finished;
+    }
+    if (gquic_tls_conn_write_record(&_, ser_state->conn, GQUIC_TLS_RECORD_TYPE_HANDSHAKE, &buf) != 0) {
+        gquic_tls_conn_send_alert(ser_state->conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
+        ret = -4;
+        goto finished;
     }
+
+finished:
+    gquic_str_reset(&buf);
     return ret;
 }
 
+static int gquic_tls_handshake_server_state_suspend(gquic_tls_handshake_server_state_t *const ser_state) {
+    gquic_tls_sign_job_t job;
+    gquic_tls_conn_t *const conn = ser_state->conn;
+    sem_wait(&conn->resume_mtx);
+    conn->ser_state = ser_state;
+    ser_state->stage = GQUIC_TLS_SERVER_STAGE_SIGNING;
+    sem_post(&conn->resume_mtx);
+
+    job.sig = &ser_state->verify_msg->sign;
+    job.signer = &conn->cfg->signer;
+    job.pkey = ser_state->pkey;
+    job.sigalg = ser_state->sigalg;
+    job.msg = &ser_state->signed_cnt;
+    job.on_done.self = conn;
+    job.on_done.cb = gquic_tls_handshake_server_state_signed;
+    if (gquic_tls_sign_pool_submit(conn->cfg->sign_pool, &job) != 0) {
+        sem_wait(&conn->resume_mtx);
+        conn->ser_state = NULL;
+        ser_state->stage = GQUIC_TLS_SERVER_STAGE_RUNNING;
+        sem_post(&conn->resume_mtx);
+        return -1;
+    }
+    return GQUIC_TLS_HANDSHAKE_PENDING;
+}
+
+// runs on the sign pool worker: the handshake goes on up to the client's Finished
+static int gquic_tls_handshake_server_state_signed(void *const conn_, const int sign_ret) {
+    int ret = 0;
+    gquic_tls_conn_t *const conn = conn_;
+    gquic_tls_handshake_server_state_t *ser_state = NULL;
+    sem_wait(&conn->resume_mtx);
+    ser_state = conn->ser_state;
+    if (sign_ret != 0) {
+        gquic_tls_conn_send_alert(conn, GQUIC_TLS_ALERT_INTERNAL_ERROR);
+        ret = -6;
+    }
+    else if (gquic_tls_handshake_server_state_send_cert_verify(ser_state, ser_state->verify_msg) != 0) {
+        ret = -6;
+    }
+    else if (gquic_tls_handshake_server_state_send_ser_finished(ser_state) != 0) {
+        ret = -7;
+    }
+    else if (!conn->resumed) {
+        ser_state->stage = GQUIC_TLS_SERVER_STAGE_WAIT_CLI_FINISHED;
+        sem_post(&conn->resume_mtx);
+        return 0;
+    }
+    else {
+        ret = gquic_tls_handshake_server_state_read_cli(ser_state);
+    }
+    return gquic_tls_handshake_server_state_complete(ser_state, ret);
+}
+
+// called with resume_mtx held, releases it before reporting the end of the handshake
+static int gquic_tls_handshake_server_state_complete(gquic_tls_handshake_server_state_t *const ser_state, const int ret) {
+    gquic_tls_conn_t *const conn = ser_state->conn;
+    conn->ser_state = NULL;
+    gquic_tls_handshake_server_state_release(ser_state);
+    free(ser_state);
+    if (ret == 0) {
+        conn->handshakes++;
+    }
+    sem_post(&conn->resume_mtx);
+    sem_post(&conn->handshake_mtx);
+    GQUIC_TLS_CONN_ON_HANDSHAKE_DONE(conn, ret == 0 ? 0 : -5 + ret * 100);
+    return 0;
+}
+
+static int gquic_tls_handshake_server_state_sign(gquic_str_t *const sig,
+                                                 gquic_tls_handshake_server_state_t *const ser_state,
+                                                 EVP_PKEY *const pkey,
+                                                 const gquic_str_t *const msg) {
+    const gquic_tls_config_t *cfg = NULL;
+    if (sig == NULL || ser_state == NULL || msg == NULL) {
+        return -1;
+    }
+    cfg = ser_state->conn->cfg;
+
+    // with no on_handshake_done to resume through, the handshake thread sleeps until a crypto worker has signed
+    if (cfg->sign_pool != NULL) {
+        return gquic_tls_sign_pool_sign(sig, cfg->sign_pool, &cfg->signer, pkey, ser_state->sigalg, msg);
+    }
+    if (cfg->signer.sign != NULL) {
+        return GQUIC_TLS_SIGNER_SIGN(sig, &cfg->signer, pkey, ser_state->sigalg, msg);
+    }
+    return gquic_tls_sign(sig, pkey, ser_state->sigalg, msg);
+}
+
 static int gquic_tls_handshake_server_state_request_cli_cert(gquic_tls_handshake_server_state_t *const ser_state) {
     if (ser_state == NULL) {
         return 0;
@@ -1271,7 +1442,7 @@ static int gquic_tls_handshake_server_state_send_session_tickets(gquic_tls_hands
     int ret = 0;
     gquic_tls_finished_msg_t *cli_finished = NULL;
     gquic_str_t buf = { 0, NULL };
-    static const gquic_str_t resumption_label = { 5, "res master" };
+    static const gquic_str_t resumption_label = { 10, "res master" };
     if (ser_state == NULL) {
         return -1;
     }
@@ -671,7 +671,7 @@ static int ecdhe_ka_process_ser_key_exchange(void *const self,
         ret = -22;
         goto failure;
     }
-    if (gquic_tls_verify_handshake_sign(hash, cert_pubkey, &sign, &sig) != 0) {
+    if (gquic_tls_verify_handshake_sign(hash, sig_type, cert_pubkey, &sign, &sig) != 0) {
         ret = -23;
         goto failure;
     }
@@ -3,6 +3,7 @@
 #include "util/str.h"
 #include "util/big_endian.h"
 #include <openssl/evp.h>
+#include <openssl/ec.h>
 #include <openssl/kdf.h>
 #include <openssl/rand.h>
 #include <string.h>
@@ -20,15 +21,30 @@ static int gquic_x25519_params_shared_key(const void *const, gquic_str_t *, cons
 static int gquic_tls_ecdhe_params_x25519_generate(gquic_tls_ecdhe_params_t *param);
 static int gquic_tls_ecdhe_params_x25519_dtor(void *const);
 
+typedef struct gquic_tls_p256_params_s gquic_tls_p256_params_t;
+struct gquic_tls_p256_params_s {
+    EVP_PKEY *pkey;
+};
+
+static u_int16_t gquic_p256_params_curve_id(const void *const);
+static int gquic_p256_params_public_key(const void *const, gquic_str_t *);
+static int gquic_p256_params_shared_key(const void *const, gquic_str_t *, const gquic_str_t *);
+
+static int gquic_tls_ecdhe_params_p256_generate(gquic_tls_ecdhe_params_t *param);
+static int gquic_tls_ecdhe_params_p256_dtor(void *const);
+
 int gquic_tls_ecdhe_params_generate(gquic_tls_ecdhe_params_t *param, const u_int16_t curve_id) {
     if (param == NULL) {
         return -1;
     }
-    if (curve_id != GQUIC_TLS_CURVE_X25519) {
-        return -2;
+    switch (curve_id) {
+    case GQUIC_TLS_CURVE_X25519:
+        return gquic_tls_ecdhe_params_x25519_generate(param);
+    case GQUIC_TLS_CURVE_P256:
+        return gquic_tls_ecdhe_params_p256_generate(param);
     }
 
-    return gquic_tls_ecdhe_params_x25519_generate(param);
+    return -2;
 }
 
 int gquic_tls_ecdhe_params_init(gquic_tls_ecdhe_params_t *param) {
@@ -163,6 +179,117 @@ static int gquic_tls_ecdhe_params_x25519_dtor(void *const self) {
     return 0;
 }
 
+static int gquic_tls_ecdhe_params_p256_generate(gquic_tls_ecdhe_params_t *param) {
+    gquic_tls_p256_params_t *p256_param = NULL;
+    if (param == NULL) {
+        return -1;
+    }
+    if ((p256_param = malloc(sizeof(gquic_tls_p256_params_t))) == NULL) {
+        return -2;
+    }
+    param->self = p256_param;
+    param->curve_id = gquic_p256_params_curve_id;
+    param->public_key = gquic_p256_params_public_key;
+    param->shared_key = gquic_p256_params_shared_key;
+    param->dtor = gquic_tls_ecdhe_params_p256_dtor;
+    p256_param->pkey = NULL;
+
+    if ((p256_param->pkey = EVP_EC_gen("P-256")) == NULL) {
+        return -3;
+    }
+    return 0;
+}
+
+static u_int16_t gquic_p256_params_curve_id(const void *const param) {
+    (void) param;
+    return GQUIC_TLS_CURVE_P256;
+}
+
+static int gquic_p256_params_public_key(const void *const self, gquic_str_t *ret) {
+    const gquic_tls_p256_params_t *const param = self;
+    u_int8_t *pub_key = NULL;
+    size_t size = 0;
+    if (self == NULL || ret == NULL) {
+        return -1;
+    }
+    if (gquic_str_init(ret) != 0) {
+        return -2;
+    }
+    // uncompressed point, as TLS 1.3 requires
+    if ((size = EVP_PKEY_get1_encoded_public_key(param->pkey, &pub_key)) == 0) {
+        return -3;
+    }
+    if (gquic_str_alloc(ret, size) != 0) {
+        OPENSSL_free(pub_key);
+        return -4;
+    }
+    memcpy(GQUIC_STR_VAL(ret), pub_key, size);
+    OPENSSL_free(pub_key);
+    return 0;
+}
+
+static int gquic_p256_params_shared_key(const void *const self, gquic_str_t *ret, const gquic_str_t *ref) {
+    const gquic_tls_p256_params_t *const param = self;
+    int code = 0;
+    EVP_PKEY *peerkey = NULL;
+    EVP_PKEY_CTX *ctx = NULL;
+    if (self == NULL || ret == NULL || ref == NULL) {
+        return -1;
+    }
+    if (GQUIC_STR_SIZE(ref) != 65) {
+        return -2;
+    }
+    gquic_str_init(ret);
+    if ((peerkey = EVP_PKEY_new()) == NULL) {
+        return -3;
+    }
+    if (EVP_PKEY_copy_parameters(peerkey, param->pkey) <= 0
+        || EVP_PKEY_set1_encoded_public_key(peerkey, GQUIC_STR_VAL(ref), GQUIC_STR_SIZE(ref)) <= 0) {
+        code = -4;
+        goto finished;
+    }
+    if ((ctx = EVP_PKEY_CTX_new(param->pkey, NULL)) == NULL) {
+        code = -5;
+        goto finished;
+    }
+    if (EVP_PKEY_derive_init(ctx) <= 0 || EVP_PKEY_derive_set_peer(ctx, peerkey) <= 0) {
+        code = -6;
+        goto finished;
+    }
+    if (EVP_PKEY_derive(ctx, NULL, &ret->size) <= 0) {
+        code = -7;
+        goto finished;
+    }
+    if (gquic_str_alloc(ret, GQUIC_STR_SIZE(ret)) != 0) {
+        code = -8;
+        goto finished;
+    }
+    if (EVP_PKEY_derive(ctx, GQUIC_STR_VAL(ret), &ret->size) <= 0) {
+        gquic_str_reset(ret);
+        code = -9;
+        goto finished;
+    }
+
+finished:
+    EVP_PKEY_free(peerkey);
+    if (ctx != NULL) {
+        EVP_PKEY_CTX_free(ctx);
+    }
+    return code;
+}
+
+static int gquic_tls_ecdhe_params_p256_dtor(void *const self) {
+    gquic_tls_p256_params_t *const p256_self = self;
+    if (self == NULL) {
+        return -1;
+    }
+    if (p256_self->pkey != NULL) {
+        EVP_PKEY_free(p256_self->pkey);
+        p256_self->pkey = NULL;
+    }
+    return 0;
+}
+
 int gquic_tls_hkdf_extract(gquic_str_t *const ret, gquic_tls_mac_t *const hash, const gquic_str_t *const secret, const gquic_str_t *const salt) {
     gquic_str_t default_secret = { 0, NULL };
     EVP_PKEY_CTX *ctx = NULL;
@@ -181,6 +308,9 @@ int gquic_tls_hkdf_extract(gquic_str_t *const ret, gquic_tls_mac_t *const hash,
     if (EVP_PKEY_CTX_set_hkdf_md(ctx, hash->md) <= 0) {
         return -5;
     }
+    if (EVP_PKEY_CTX_set_hkdf_mode(ctx, EVP_PKEY_HKDEF_MODE_EXTRACT_ONLY) <= 0) {
+        return -12;
+    }
     if (secret == NULL) {
         if (gquic_str_alloc(&default_secret, EVP_MD_size(hash->md)) != 0) {
             return -6;
@@ -239,6 +369,9 @@ int gquic_tls_hkdf_expand_label(gquic_str_t *const ret,
     if (EVP_PKEY_CTX_set_hkdf_md(ctx, hash->md) <= 0) {
         return -5;
     }
+    if (EVP_PKEY_CTX_set_hkdf_mode(ctx, EVP_PKEY_HKDEF_MODE_EXPAND_ONLY) <= 0) {
+        return -12;
+    }
     if (EVP_PKEY_CTX_set1_hkdf_key(ctx, GQUIC_STR_VAL(secret), GQUIC_STR_SIZE(secret)) <= 0) {
         return -6;
     }
@@ -259,7 +392,7 @@ int gquic_tls_hkdf_expand_label(gquic_str_t *const ret,
     if (EVP_PKEY_CTX_add1_hkdf_info(ctx, GQUIC_STR_VAL(&info), GQUIC_STR_SIZE(&info)) <= 0) {
         return -8;
     }
-    if (gquic_str_alloc(ret, EVP_MD_size(hash->md)) != 0) {
+    if (gquic_str_alloc(ret, length) != 0) {
         return -10;
     }
     if (EVP_PKEY_derive(ctx, GQUIC_STR_VAL(ret), &ret->size) <= 0) {
@@ -0,0 +1,207 @@
+#include "tls/key_share_pool.h"
+#include <malloc.h>
+
+static gquic_tls_key_share_pool_curve_t *gquic_tls_key_share_pool_find(gquic_tls_key_share_pool_t *const, const u_int16_t);
+static int gquic_tls_key_share_pool_fill(gquic_tls_key_share_pool_t *const, gquic_tls_key_share_pool_curve_t *const);
+static void *gquic_tls_key_share_pool_thread(void *const);
+
+int gquic_tls_key_share_pool_init(gquic_tls_key_share_pool_t *const pool) {
+    size_t i;
+    if (pool == NULL) {
+        return -1;
+    }
+    sem_init(&pool->mtx, 0, 1);
+    sem_init(&pool->refill, 0, 0);
+    pool->cap = 0;
+    pool->low_water = 0;
+    pool->curves_count = 0;
+    for (i = 0; i < GQUIC_TLS_KEY_SHARE_POOL_MAX_CURVES; i++) {
+        pool->curves[i].curve_id = 0;
+        pool->curves[i].keys = NULL;
+        pool->curves[i].head = 0;
+        pool->curves[i].count = 0;
+        pool->curves[i].taken = 0;
+        pool->curves[i].starved = 0;
+    }
+    pool->running = 0;
+    pool->closed = 0;
+    return 0;
+}
+
+int gquic_tls_key_share_pool_ctor(gquic_tls_key_share_pool_t *const pool,
+                                  gquic_list_t *const curve_perfers,
+                                  const size_t cap,
+                                  const size_t low_water) {
+    u_int16_t *curve_id = NULL;
+    gquic_tls_ecdhe_params_t probe;
+    size_t i;
+    if (pool == NULL || curve_perfers == NULL || cap == 0 || low_water > cap) {
+        return -1;
+    }
+    pool->cap = cap;
+    pool->low_water = low_water;
+    GQUIC_LIST_FOREACH(curve_id, curve_perfers) {
+        if (pool->curves_count == GQUIC_TLS_KEY_SHARE_POOL_MAX_CURVES) {
+            break;
+        }
+        // only the curves this build can generate get a ring
+        gquic_tls_ecdhe_params_init(&probe);
+        if (gquic_tls_ecdhe_params_generate(&probe, *curve_id) != 0) {
+            gquic_tls_ecdhe_params_dtor(&probe);
+            continue;
+        }
+        gquic_tls_ecdhe_params_dtor(&probe);
+        if ((pool->curves[pool->curves_count].keys = malloc(sizeof(gquic_tls_ecdhe_params_t) * cap)) == NULL) {
+            return -2;
+        }
+        pool->curves[pool->curves_count].curve_id = *curve_id;
+        pool->curves_count++;
+    }
+    for (i = 0; i < pool->curves_count; i++) {
+        if (gquic_tls_key_share_pool_fill(pool, &pool->curves[i]) != 0) {
+            return -3;
+        }
+    }
+    if (pthread_create(&pool->thread, NULL, gquic_tls_key_share_pool_thread, pool) != 0) {
+        return -4;
+    }
+    pool->running = 1;
+    return 0;
+}
+
+int gquic_tls_key_share_pool_dtor(gquic_tls_key_share_pool_t *const pool) {
+    gquic_tls_key_share_pool_curve_t *curve = NULL;
+    size_t i;
+    if (pool == NULL) {
+        return -1;
+    }
+    if (pool->running) {
+        sem_wait(&pool->mtx);
+        pool->closed = 1;
+        sem_post(&pool->mtx);
+        sem_post(&pool->refill);
+        pthread_join(pool->thread, NULL);
+        pool->running = 0;
+    }
+    for (i = 0; i < pool->curves_count; i++) {
+        curve = &pool->curves[i];
+        for (; curve->count > 0; curve->count--) {
+            gquic_tls_ecdhe_params_dtor(&curve->keys[curve->head]);
+            curve->head = (curve->head + 1) % pool->cap;
+        }
+        free(curve->keys);
+        curve->keys = NULL;
+    }
+    pool->curves_count = 0;
+    sem_destroy(&pool->mtx);
+    sem_destroy(&pool->refill);
+    return 0;
+}
+
+int gquic_tls_key_share_pool_take(gquic_tls_ecdhe_params_t *const params,
+                                  gquic_tls_key_share_pool_t *const pool,
+                                  const u_int16_t curve_id) {
+    gquic_tls_key_share_pool_curve_t *curve = NULL;
+    int refill = 0;
+    if (params == NULL) {
+        return -1;
+    }
+    if (pool == NULL || (curve = gquic_tls_key_share_pool_find(pool, curve_id)) == NULL) {
+        return gquic_tls_ecdhe_params_generate(params, curve_id);
+    }
+    sem_wait(&pool->mtx);
+    curve->taken++;
+    if (curve->count == 0) {
+        curve->starved++;
+        sem_post(&pool->mtx);
+        sem_post(&pool->refill);
+        return gquic_tls_ecdhe_params_generate(params, curve_id);
+    }
+    *params = curve->keys[curve->head];
+    curve->head = (curve->head + 1) % pool->cap;
+    curve->count--;
+    refill = curve->count == pool->low_water;
+    sem_post(&pool->mtx);
+
+    if (refill) {
+        sem_post(&pool->refill);
+    }
+    return 0;
+}
+
+int gquic_tls_key_share_pool_stats(u_int64_t *const taken,
+                                   u_int64_t *const starved,
+                                   gquic_tls_key_share_pool_t *const pool,
+                                   const u_int16_t curve_id) {
+    gquic_tls_key_share_pool_curve_t *curve = NULL;
+    if (taken == NULL || starved == NULL || pool == NULL) {
+        return -1;
+    }
+    if ((curve = gquic_tls_key_share_pool_find(pool, curve_id)) == NULL) {
+        return -2;
+    }
+    sem_wait(&pool->mtx);
+    *taken = curve->taken;
+    *starved = curve->starved;
+    sem_post(&pool->mtx);
+    return 0;
+}
+
+static gquic_tls_key_share_pool_curve_t *gquic_tls_key_share_pool_find(gquic_tls_key_share_pool_t *const pool,
+                                                                     const u_int16_t curve_id) {
+    size_t i;
+    for (i = 0; i < pool->curves_count; i++) {
+        if (pool->curves[i].curve_id == curve_id) {
+            return &pool->curves[i];
+        }
+    }
+    return NULL;
+}
+
+static int gquic_tls_key_share_pool_fill(gquic_tls_key_share_pool_t *const pool, gquic_tls_key_share_pool_curve_t *const curve) {
+    gquic_tls_ecdhe_params_t params;
+    for ( ;; ) {
+        sem_wait(&pool->mtx);
+        if (pool->closed || curve->count == pool->cap) {
+            sem_post(&pool->mtx);
+            return 0;
+        }
+        sem_post(&pool->mtx);
+
+        // keys are generated outside the lock so takes are never held up
+        gquic_tls_ecdhe_params_init(&params);
+        if (gquic_tls_ecdhe_params_generate(&params, curve->curve_id) != 0) {
+            gquic_tls_ecdhe_params_dtor(&params);
+            return -1;
+        }
+
+        sem_wait(&pool->mtx);
+        if (curve->count == pool->cap) {
+            sem_post(&pool->mtx);
+            gquic_tls_ecdhe_params_dtor(&params);
+            return 0;
+        }
+        curve->keys[(curve->head + curve->count) % pool->cap] = params;
+        curve->count++;
+        sem_post(&pool->mtx);
+    }
+}
+
+static void *gquic_tls_key_share_pool_thread(void *const pool_) {
+    gquic_tls_key_share_pool_t *const pool = pool_;
+    int closed = 0;
+    size_t i;
+    for ( ;; ) {
+        sem_wait(&pool->refill);
+        sem_wait(&pool->mtx);
+        closed = pool->closed;
+        sem_post(&pool->mtx);
+        if (closed) {
+            break;
+        }
+        for (i = 0; i < pool->curves_count; i++) {
+            gquic_tls_key_share_pool_fill(pool, &pool->curves[i]);
+        }
+    }
+    return NULL;
+}
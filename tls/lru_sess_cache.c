@@ -1,9 +1,257 @@
-#include "tls/client_sess_state.h"
-#include "util/rbtree.h"
-#include "util/list.h"
-
-typedef struct gquic_tls_lru_sess_cache_s gquic_tls_lru_sess_cache_t;
-struct gquic_tls_lru_sess_cache_s {
-    gquic_rbtree_t *m;
-    gquic_list_t q;
-};
+#include "tls/lru_sess_cache.h"
+#include <malloc.h>
+#include <string.h>
+#include <time.h>
+
+// the low bits of the hash pick the shard, so buckets index on the high bits
+#define GQUIC_TLS_LRU_SESS_CACHE_BUCKET(shard, hash) (((hash) >> 32) & (shard)->buckets_mask)
+
+static u_int64_t gquic_tls_lru_sess_cache_hash(const gquic_str_t *const);
+static gquic_tls_lru_sess_cache_entry_t **gquic_tls_lru_sess_cache_shard_find(gquic_tls_lru_sess_cache_shard_t *const,
+                                                                              const u_int64_t, const gquic_str_t *const);
+static int gquic_tls_lru_sess_cache_shard_remove(gquic_tls_lru_sess_cache_shard_t *const, gquic_tls_lru_sess_cache_entry_t **const);
+static int gquic_tls_lru_sess_cache_state_expired(const gquic_tls_client_sess_state_t *const, const time_t);
+static int gquic_tls_lru_sess_cache_get_wrapper(gquic_tls_client_sess_state_t **const, void *const, const gquic_str_t *const);
+static int gquic_tls_lru_sess_cache_put_wrapper(void *const, const gquic_str_t *const, const gquic_tls_client_sess_state_t *const);
+
+int gquic_tls_lru_sess_cache_init(gquic_tls_lru_sess_cache_t *const cache) {
+    if (cache == NULL) {
+        return -1;
+    }
+    cache->base.self = cache;
+    cache->base.get = gquic_tls_lru_sess_cache_get_wrapper;
+    cache->base.put = gquic_tls_lru_sess_cache_put_wrapper;
+    cache->shards = NULL;
+    cache->shards_count = 0;
+    return 0;
+}
+
+int gquic_tls_lru_sess_cache_ctor(gquic_tls_lru_sess_cache_t *const cache, const size_t cap, const size_t shards_count) {
+    gquic_tls_lru_sess_cache_shard_t *shard = NULL;
+    size_t buckets_count = 0;
+    size_t i;
+    if (cache == NULL || shards_count == 0) {
+        return -1;
+    }
+    if ((cache->shards = malloc(sizeof(gquic_tls_lru_sess_cache_shard_t) * shards_count)) == NULL) {
+        return -2;
+    }
+    for (i = 0; i < shards_count; i++) {
+        shard = &cache->shards[i];
+        sem_init(&shard->mtx, 0, 1);
+        gquic_list_head_init(&shard->q);
+        shard->count = 0;
+        shard->cap = (cap == 0 ? GQUIC_TLS_LRU_SESS_CACHE_DEFAULT_CAP : cap) / shards_count;
+        if (shard->cap == 0) {
+            shard->cap = 1;
+        }
+        // keep the load factor at or below one so a lookup walks about one entry
+        for (buckets_count = 1; buckets_count < shard->cap; buckets_count <<= 1);
+        shard->buckets_mask = buckets_count - 1;
+        shard->hits = 0;
+        shard->misses = 0;
+        shard->expired = 0;
+        shard->evicted = 0;
+        if ((shard->buckets = calloc(buckets_count, sizeof(gquic_tls_lru_sess_cache_entry_t *))) == NULL) {
+            cache->shards_count = i;
+            gquic_tls_lru_sess_cache_dtor(cache);
+            return -3;
+        }
+    }
+    cache->shards_count = shards_count;
+    return 0;
+}
+
+int gquic_tls_lru_sess_cache_dtor(gquic_tls_lru_sess_cache_t *const cache) {
+    gquic_tls_lru_sess_cache_shard_t *shard = NULL;
+    gquic_tls_lru_sess_cache_entry_t *entry = NULL;
+    size_t i;
+    if (cache == NULL) {
+        return -1;
+    }
+    for (i = 0; i < cache->shards_count; i++) {
+        shard = &cache->shards[i];
+        while (!gquic_list_head_empty(&shard->q)) {
+            entry = GQUIC_LIST_FIRST(&shard->q);
+            gquic_str_reset(&entry->key);
+            gquic_tls_client_sess_state_dtor(&entry->state);
+            gquic_list_release(entry);
+        }
+        free(shard->buckets);
+        sem_destroy(&shard->mtx);
+    }
+    if (cache->shards != NULL) {
+        free(cache->shards);
+    }
+    cache->shards = NULL;
+    cache->shards_count = 0;
+    return 0;
+}
+
+int gquic_tls_lru_sess_cache_get(gquic_tls_client_sess_state_t **const state, gquic_tls_lru_sess_cache_t *const cache, const gquic_str_t *const key) {
+    gquic_tls_lru_sess_cache_shard_t *shard = NULL;
+    gquic_tls_lru_sess_cache_entry_t **slot = NULL;
+    gquic_tls_lru_sess_cache_entry_t *entry = NULL;
+    u_int64_t hash = 0;
+    int ret = 0;
+    if (state == NULL || cache == NULL || key == NULL) {
+        return -1;
+    }
+    *state = NULL;
+    if (cache->shards_count == 0) {
+        return -2;
+    }
+    hash = gquic_tls_lru_sess_cache_hash(key);
+    shard = &cache->shards[hash % cache->shards_count];
+
+    sem_wait(&shard->mtx);
+    if ((slot = gquic_tls_lru_sess_cache_shard_find(shard, hash, key)) == NULL) {
+        shard->misses++;
+        ret = -3;
+        goto finished;
+    }
+    entry = *slot;
+    if (gquic_tls_lru_sess_cache_state_expired(&entry->state, time(NULL))) {
+        gquic_tls_lru_sess_cache_shard_remove(shard, slot);
+        shard->expired++;
+        shard->misses++;
+        ret = -4;
+        goto finished;
+    }
+    if ((*state = gquic_tls_client_sess_state_alloc()) == NULL) {
+        ret = -5;
+        goto finished;
+    }
+    if (gquic_tls_client_sess_state_copy(*state, &entry->state) != 0) {
+        gquic_tls_client_sess_state_release(*state);
+        *state = NULL;
+        ret = -6;
+        goto finished;
+    }
+    gquic_list_remove(entry);
+    gquic_list_insert_after(&shard->q, entry);
+    shard->hits++;
+finished:
+    sem_post(&shard->mtx);
+    return ret;
+}
+
+int gquic_tls_lru_sess_cache_put(gquic_tls_lru_sess_cache_t *const cache, const gquic_str_t *const key, const gquic_tls_client_sess_state_t *const state) {
+    gquic_tls_lru_sess_cache_shard_t *shard = NULL;
+    gquic_tls_lru_sess_cache_entry_t **slot = NULL;
+    gquic_tls_lru_sess_cache_entry_t *entry = NULL;
+    u_int64_t hash = 0;
+    int ret = 0;
+    if (cache == NULL || key == NULL) {
+        return -1;
+    }
+    if (cache->shards_count == 0) {
+        return -2;
+    }
+    hash = gquic_tls_lru_sess_cache_hash(key);
+    shard = &cache->shards[hash % cache->shards_count];
+
+    // copy outside the lock, the state carries whole certificate chains
+    if (state != NULL && !gquic_tls_lru_sess_cache_state_expired(state, time(NULL))) {
+        if ((entry = gquic_list_alloc(sizeof(gquic_tls_lru_sess_cache_entry_t))) == NULL) {
+            return -3;
+        }
+        entry->hash = hash;
+        entry->bucket_next = NULL;
+        gquic_tls_client_sess_state_init(&entry->state);
+        if (gquic_str_copy(&entry->key, key) != 0 || gquic_tls_client_sess_state_copy(&entry->state, state) != 0) {
+            gquic_str_reset(&entry->key);
+            gquic_tls_client_sess_state_dtor(&entry->state);
+            gquic_list_release(entry);
+            return -4;
+        }
+    }
+
+    sem_wait(&shard->mtx);
+    if ((slot = gquic_tls_lru_sess_cache_shard_find(shard, hash, key)) != NULL) {
+        gquic_tls_lru_sess_cache_shard_remove(shard, slot);
+    }
+    if (entry == NULL) {
+        goto finished;
+    }
+    if (shard->count >= shard->cap) {
+        slot = gquic_tls_lru_sess_cache_shard_find(shard,
+                                                   ((gquic_tls_lru_sess_cache_entry_t *) GQUIC_LIST_LAST(&shard->q))->hash,
+                                                   &((gquic_tls_lru_sess_cache_entry_t *) GQUIC_LIST_LAST(&shard->q))->key);
+        gquic_tls_lru_sess_cache_shard_remove(shard, slot);
+        shard->evicted++;
+    }
+    entry->bucket_next = shard->buckets[GQUIC_TLS_LRU_SESS_CACHE_BUCKET(shard, hash)];
+    shard->buckets[GQUIC_TLS_LRU_SESS_CACHE_BUCKET(shard, hash)] = entry;
+    gquic_list_insert_after(&shard->q, entry);
+    shard->count++;
+finished:
+    sem_post(&shard->mtx);
+    return ret;
+}
+
+int gquic_tls_lru_sess_cache_stats(gquic_tls_lru_sess_cache_stats_t *const stats, gquic_tls_lru_sess_cache_t *const cache) {
+    gquic_tls_lru_sess_cache_shard_t *shard = NULL;
+    size_t i;
+    if (stats == NULL || cache == NULL) {
+        return -1;
+    }
+    memset(stats, 0, sizeof(gquic_tls_lru_sess_cache_stats_t));
+    for (i = 0; i < cache->shards_count; i++) {
+        shard = &cache->shards[i];
+        sem_wait(&shard->mtx);
+        stats->hits += shard->hits;
+        stats->misses += shard->misses;
+        stats->expired += shard->expired;
+        stats->evicted += shard->evicted;
+        stats->count += shard->count;
+        sem_post(&shard->mtx);
+    }
+    return 0;
+}
+
+static u_int64_t gquic_tls_lru_sess_cache_hash(const gquic_str_t *const key) {
+    const u_int8_t *p = GQUIC_STR_VAL(key);
+    u_int64_t hash = 0xcbf29ce484222325;
+    size_t i;
+    // FNV-1a
+    for (i = 0; i < GQUIC_STR_SIZE(key); i++) {
+        hash ^= p[i];
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+static gquic_tls_lru_sess_cache_entry_t **gquic_tls_lru_sess_cache_shard_find(gquic_tls_lru_sess_cache_shard_t *const shard,
+                                                                              const u_int64_t hash, const gquic_str_t *const key) {
+    gquic_tls_lru_sess_cache_entry_t **slot = &shard->buckets[GQUIC_TLS_LRU_SESS_CACHE_BUCKET(shard, hash)];
+    for (; *slot != NULL; slot = &(*slot)->bucket_next) {
+        if ((*slot)->hash == hash && gquic_str_cmp(&(*slot)->key, key) == 0) {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+static int gquic_tls_lru_sess_cache_shard_remove(gquic_tls_lru_sess_cache_shard_t *const shard, gquic_tls_lru_sess_cache_entry_t **const slot) {
+    gquic_tls_lru_sess_cache_entry_t *entry = *slot;
+    *slot = entry->bucket_next;
+    gquic_str_reset(&entry->key);
+    gquic_tls_client_sess_state_dtor(&entry->state);
+    gquic_list_release(entry);
+    shard->count--;
+    return 0;
+}
+
+static int gquic_tls_lru_sess_cache_state_expired(const gquic_tls_client_sess_state_t *const state, const time_t now) {
+    // sessions below TLS 1.3 carry no ticket lifetime
+    return state->use_by != 0 && now > state->use_by;
+}
+
+static int gquic_tls_lru_sess_cache_get_wrapper(gquic_tls_client_sess_state_t **const state, void *const cache, const gquic_str_t *const key) {
+    return gquic_tls_lru_sess_cache_get(state, cache, key);
+}
+
+static int gquic_tls_lru_sess_cache_put_wrapper(void *const cache, const gquic_str_t *const key, const gquic_tls_client_sess_state_t *const state) {
+    return gquic_tls_lru_sess_cache_put(cache, key, state);
+}
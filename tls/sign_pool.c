@@ -0,0 +1,203 @@
+#include "tls/sign_pool.h"
+#include "tls/common.h"
+#include "tls/prf.h"
+#include <openssl/rsa.h>
+#include <malloc.h>
+#include <semaphore.h>
+
+typedef struct gquic_tls_sign_waiter_s gquic_tls_sign_waiter_t;
+struct gquic_tls_sign_waiter_s {
+    sem_t done;
+    int ret;
+};
+
+static void *gquic_tls_sign_pool_worker(void *const);
+static int gquic_tls_sign_waiter_done(void *const, const int);
+
+int gquic_tls_signer_init(gquic_tls_signer_t *const signer) {
+    if (signer == NULL) {
+        return -1;
+    }
+    signer->self = NULL;
+    signer->sign = NULL;
+    return 0;
+}
+
+int gquic_tls_sign(gquic_str_t *const sig, EVP_PKEY *const pkey, const u_int16_t sigalg, const gquic_str_t *const msg) {
+    int ret = 0;
+    size_t size = 0;
+    const EVP_MD *hash = NULL;
+    EVP_MD_CTX *md_ctx = NULL;
+    EVP_PKEY_CTX *pkey_ctx = NULL;
+    if (sig == NULL || pkey == NULL || msg == NULL) {
+        return -1;
+    }
+    if (gquic_tls_hash_from_sigalg(&hash, sigalg) != 0) {
+        return -7;
+    }
+    if ((md_ctx = EVP_MD_CTX_new()) == NULL) {
+        return -2;
+    }
+    if (EVP_DigestSignInit(md_ctx, &pkey_ctx, hash, NULL, pkey) <= 0) {
+        ret = -3;
+        goto finished;
+    }
+    if (gquic_tls_sig_from_sigalg(sigalg) == GQUIC_SIG_RSAPSS) {
+        if (EVP_PKEY_CTX_set_rsa_padding(pkey_ctx, RSA_PKCS1_PSS_PADDING) <= 0
+            || EVP_PKEY_CTX_set_rsa_pss_saltlen(pkey_ctx, RSA_PSS_SALTLEN_DIGEST) <= 0) {
+            ret = -8;
+            goto finished;
+        }
+    }
+    if (EVP_DigestSign(md_ctx, NULL, &size, GQUIC_STR_VAL(msg), GQUIC_STR_SIZE(msg)) <= 0) {
+        ret = -4;
+        goto finished;
+    }
+    if (gquic_str_alloc(sig, size) != 0) {
+        ret = -5;
+        goto finished;
+    }
+    if (EVP_DigestSign(md_ctx, GQUIC_STR_VAL(sig), &size, GQUIC_STR_VAL(msg), GQUIC_STR_SIZE(msg)) <= 0) {
+        gquic_str_reset(sig);
+        ret = -6;
+        goto finished;
+    }
+    sig->size = size;
+
+finished:
+    EVP_MD_CTX_free(md_ctx);
+    return ret;
+}
+
+int gquic_tls_sign_pool_init(gquic_tls_sign_pool_t *const pool) {
+    if (pool == NULL) {
+        return -1;
+    }
+    gquic_sem_list_init(&pool->jobs);
+    pool->threads = NULL;
+    pool->threads_count = 0;
+    return 0;
+}
+
+int gquic_tls_sign_pool_ctor(gquic_tls_sign_pool_t *const pool, const size_t threads_count) {
+    size_t i;
+    if (pool == NULL || threads_count == 0) {
+        return -1;
+    }
+    if ((pool->threads = malloc(sizeof(pthread_t) * threads_count)) == NULL) {
+        return -2;
+    }
+    for (i = 0; i < threads_count; i++) {
+        if (pthread_create(&pool->threads[i], NULL, gquic_tls_sign_pool_worker, pool) != 0) {
+            gquic_tls_sign_pool_dtor(pool);
+            return -3;
+        }
+        pool->threads_count++;
+    }
+    return 0;
+}
+
+int gquic_tls_sign_pool_dtor(gquic_tls_sign_pool_t *const pool) {
+    size_t i;
+    gquic_tls_sign_job_t *job = NULL;
+    if (pool == NULL) {
+        return -1;
+    }
+    gquic_sem_list_close(&pool->jobs);
+    for (i = 0; i < pool->threads_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    if (pool->threads != NULL) {
+        free(pool->threads);
+        pool->threads = NULL;
+    }
+    pool->threads_count = 0;
+
+    // jobs that never ran still have to be completed
+    while (!gquic_list_head_empty(GQUIC_SEM_LIST(&pool->jobs))) {
+        job = GQUIC_SEM_LIST_FIRST(&pool->jobs);
+        gquic_list_remove(job);
+        job->on_done.cb(job->on_done.self, -1);
+        gquic_list_release(job);
+    }
+    gquic_sem_list_sem_dtor(&pool->jobs);
+    return 0;
+}
+
+int gquic_tls_sign_pool_submit(gquic_tls_sign_pool_t *const pool, const gquic_tls_sign_job_t *const job) {
+    gquic_tls_sign_job_t *queued = NULL;
+    if (pool == NULL || job == NULL || job->sig == NULL || job->msg == NULL || job->on_done.cb == NULL) {
+        return -1;
+    }
+    if ((queued = gquic_list_alloc(sizeof(gquic_tls_sign_job_t))) == NULL) {
+        return -2;
+    }
+    *queued = *job;
+    if (gquic_sem_list_push(&pool->jobs, queued) != 0) {
+        gquic_list_release(queued);
+        return -3;
+    }
+    return 0;
+}
+
+int gquic_tls_sign_pool_sign(gquic_str_t *const sig,
+                             gquic_tls_sign_pool_t *const pool,
+                             const gquic_tls_signer_t *const signer,
+                             EVP_PKEY *const pkey,
+                             const u_int16_t sigalg,
+                             const gquic_str_t *const msg) {
+    gquic_tls_sign_job_t job;
+    gquic_tls_sign_waiter_t waiter;
+    if (sig == NULL || pool == NULL || msg == NULL) {
+        return -1;
+    }
+    sem_init(&waiter.done, 0, 0);
+    waiter.ret = 0;
+    job.sig = sig;
+    job.signer = signer;
+    job.pkey = pkey;
+    job.sigalg = sigalg;
+    job.msg = msg;
+    job.on_done.self = &waiter;
+    job.on_done.cb = gquic_tls_sign_waiter_done;
+    if (gquic_tls_sign_pool_submit(pool, &job) != 0) {
+        sem_destroy(&waiter.done);
+        return -2;
+    }
+    sem_wait(&waiter.done);
+    sem_destroy(&waiter.done);
+    return waiter.ret == 0 ? 0 : -3;
+}
+
+static void *gquic_tls_sign_pool_worker(void *const pool_) {
+    gquic_tls_sign_pool_t *const pool = pool_;
+    gquic_tls_sign_job_t *job = NULL;
+    int ret = 0;
+    for ( ;; ) {
+        job = NULL;
+        if (gquic_sem_list_pop((void **) &job, &pool->jobs) == -2) {
+            // wake the next worker, the pool is closed
+            GQUIC_SEM_LIST_NOTIFY(&pool->jobs);
+            break;
+        }
+        if (job == NULL) {
+            continue;
+        }
+        if (job->signer != NULL && job->signer->sign != NULL) {
+            ret = GQUIC_TLS_SIGNER_SIGN(job->sig, job->signer, job->pkey, job->sigalg, job->msg);
+        }
+        else {
+            ret = gquic_tls_sign(job->sig, job->pkey, job->sigalg, job->msg);
+        }
+        job->on_done.cb(job->on_done.self, ret);
+        gquic_list_release(job);
+    }
+    return NULL;
+}
+
+static int gquic_tls_sign_waiter_done(void *const waiter_, const int ret) {
+    gquic_tls_sign_waiter_t *const waiter = waiter_;
+    waiter->ret = ret;
+    sem_post(&waiter->done);
+    return 0;
+}
@@ -10,6 +10,8 @@ int gquic_tls_sess_state_init(gquic_tls_sess_state_t *const state) {
     }
     state->cipher_suite = 0;
     state->create_at = 0;
+    state->age_add = 0;
+    state->max_early_data = 0;
     gquic_str_init(&state->resumption_sec);
     gquic_tls_cert_init(&state->cert);
 
@@ -31,7 +33,7 @@ ssize_t gquic_tls_sess_state_size(const gquic_tls_sess_state_t *const state) {
     if (state == NULL) {
         return -1;
     }
-    ret += 2 + 1 + 2 + 8 + 1 + GQUIC_STR_SIZE(&state->resumption_sec) + gquic_tls_cert_size(&state->cert);
+    ret += 2 + 1 + 2 + 8 + 4 + 4 + 1 + GQUIC_STR_SIZE(&state->resumption_sec) + gquic_tls_cert_size(&state->cert);
     return ret;
 }
 
@@ -47,6 +49,8 @@ int gquic_tls_sess_state_serialize(const gquic_tls_sess_state_t *const state, gq
     gquic_big_endian_writer_1byte(writer, 0);
     gquic_big_endian_writer_2byte(writer, state->cipher_suite);
     gquic_big_endian_writer_8byte(writer, state->create_at);
+    gquic_big_endian_writer_4byte(writer, state->age_add);
+    gquic_big_endian_writer_4byte(writer, state->max_early_data);
     __gquic_fill_str(writer, &state->resumption_sec, 1);
     gquic_tls_cert_serialize(&state->cert, writer);
 
@@ -65,12 +69,18 @@ int gquic_tls_sess_state_deserialize(gquic_tls_sess_state_t *const state, gquic_
     if (__gquic_recovery_bytes(&state->create_at, 8, reader) != 0) {
         return -3;
     }
-    if (__gquic_recovery_str(&state->resumption_sec, 1, reader) != 0) {
+    if (__gquic_recovery_bytes(&state->age_add, 4, reader) != 0) {
         return -4;
     }
-    if (gquic_tls_cert_deserialize(&state->cert, reader) != 0) {
+    if (__gquic_recovery_bytes(&state->max_early_data, 4, reader) != 0) {
         return -5;
     }
+    if (__gquic_recovery_str(&state->resumption_sec, 1, reader) != 0) {
+        return -6;
+    }
+    if (gquic_tls_cert_deserialize(&state->cert, reader) != 0) {
+        return -7;
+    }
 
     return ret;
 }
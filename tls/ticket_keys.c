@@ -0,0 +1,517 @@
+#include "tls/ticket_keys.h"
+#include "tls/config.h"
+#include <openssl/core_names.h>
+#include <openssl/crypto.h>
+#include <openssl/rand.h>
+#include <sys/stat.h>
+#include <malloc.h>
+#include <stdio.h>
+#include <string.h>
+
+static int gquic_tls_ticket_keys_entry_ctor(gquic_tls_ticket_keys_entry_t *const, EVP_MAC *const, const u_int8_t *const);
+static int gquic_tls_ticket_keys_entry_dtor(gquic_tls_ticket_keys_entry_t *const);
+static int gquic_tls_ticket_keys_push(gquic_tls_ticket_keys_t *const, const u_int8_t *const);
+static int gquic_tls_ticket_keys_replace(gquic_tls_ticket_keys_t *const, const u_int8_t *const, const size_t);
+static int gquic_tls_ticket_keys_reindex(gquic_tls_ticket_keys_t *const);
+static int gquic_tls_ticket_keys_lookup(gquic_tls_ticket_keys_t *const, const u_int8_t *const);
+static int gquic_tls_ticket_keys_read_file(gquic_tls_ticket_keys_t *const, time_t *const);
+static int gquic_tls_ticket_keys_maintain(gquic_tls_ticket_keys_t *const, const time_t);
+
+int gquic_tls_ticket_keys_init(gquic_tls_ticket_keys_t *const keys) {
+    if (keys == NULL) {
+        return -1;
+    }
+    sem_init(&keys->mtx, 0, 1);
+    keys->interval = GQUIC_TLS_TICKET_KEYS_DEFAULT_INTERVAL;
+    keys->keep = GQUIC_TLS_TICKET_KEYS_DEFAULT_KEEP;
+    keys->entries = NULL;
+    keys->current = 0;
+    keys->count = 0;
+    keys->index = NULL;
+    keys->index_mask = 0;
+    keys->rotated_at = 0;
+    gquic_str_init(&keys->path);
+    keys->checked_at = 0;
+    keys->mtime = 0;
+    keys->hmac = NULL;
+    keys->encrypted = 0;
+    keys->decrypted = 0;
+    keys->decrypted_old = 0;
+    keys->unknown = 0;
+    return 0;
+}
+
+int gquic_tls_ticket_keys_ctor(gquic_tls_ticket_keys_t *const keys, const time_t interval, const size_t keep) {
+    size_t slots = 0;
+    u_int8_t secret[GQUIC_TLS_TICKET_KEYS_SECRET_SIZE];
+    if (keys == NULL) {
+        return -1;
+    }
+    if (interval != 0) {
+        keys->interval = interval;
+    }
+    if (keep != 0) {
+        keys->keep = keep;
+    }
+    if ((keys->hmac = EVP_MAC_fetch(NULL, "HMAC", NULL)) == NULL) {
+        return -2;
+    }
+    if ((keys->entries = calloc(keys->keep, sizeof(gquic_tls_ticket_keys_entry_t))) == NULL) {
+        gquic_tls_ticket_keys_dtor(keys);
+        return -3;
+    }
+    // at most half full, a miss ends after a probe or two
+    for (slots = 4; slots < 2 * keys->keep; slots <<= 1);
+    if ((keys->index = calloc(slots, sizeof(size_t))) == NULL) {
+        gquic_tls_ticket_keys_dtor(keys);
+        return -4;
+    }
+    keys->index_mask = slots - 1;
+
+    // a key of its own until one is set or loaded
+    if (RAND_bytes(secret, sizeof(secret)) <= 0) {
+        gquic_tls_ticket_keys_dtor(keys);
+        return -5;
+    }
+    if (gquic_tls_ticket_keys_push(keys, secret) != 0) {
+        OPENSSL_cleanse(secret, sizeof(secret));
+        gquic_tls_ticket_keys_dtor(keys);
+        return -6;
+    }
+    OPENSSL_cleanse(secret, sizeof(secret));
+    keys->rotated_at = time(NULL);
+    return 0;
+}
+
+int gquic_tls_ticket_keys_dtor(gquic_tls_ticket_keys_t *const keys) {
+    size_t i;
+    if (keys == NULL) {
+        return -1;
+    }
+    if (keys->entries != NULL) {
+        for (i = 0; i < keys->keep; i++) {
+            gquic_tls_ticket_keys_entry_dtor(&keys->entries[i]);
+        }
+        free(keys->entries);
+    }
+    if (keys->index != NULL) {
+        free(keys->index);
+    }
+    if (keys->hmac != NULL) {
+        EVP_MAC_free(keys->hmac);
+    }
+    keys->entries = NULL;
+    keys->index = NULL;
+    keys->hmac = NULL;
+    keys->count = 0;
+    gquic_str_reset(&keys->path);
+    sem_destroy(&keys->mtx);
+    return 0;
+}
+
+int gquic_tls_ticket_keys_set(gquic_tls_ticket_keys_t *const keys, const u_int8_t *const secrets, const size_t count) {
+    int ret = 0;
+    if (keys == NULL || secrets == NULL || count == 0) {
+        return -1;
+    }
+    if (keys->entries == NULL) {
+        return -2;
+    }
+    sem_wait(&keys->mtx);
+    if (gquic_tls_ticket_keys_replace(keys, secrets, count) != 0) {
+        ret = -3;
+    }
+    sem_post(&keys->mtx);
+    return ret;
+}
+
+int gquic_tls_ticket_keys_load_file(gquic_tls_ticket_keys_t *const keys, const char *const path) {
+    int ret = 0;
+    time_t mtime = 0;
+    size_t path_len = 0;
+    if (keys == NULL || path == NULL) {
+        return -1;
+    }
+    if (keys->entries == NULL) {
+        return -2;
+    }
+    sem_wait(&keys->mtx);
+    gquic_str_reset(&keys->path);
+    path_len = strlen(path);
+    if (gquic_str_alloc(&keys->path, path_len + 1) != 0) {
+        ret = -3;
+        goto finished;
+    }
+    memcpy(GQUIC_STR_VAL(&keys->path), path, path_len + 1);
+    if (gquic_tls_ticket_keys_read_file(keys, &mtime) != 0) {
+        gquic_str_reset(&keys->path);
+        ret = -4;
+        goto finished;
+    }
+    keys->mtime = mtime;
+    keys->checked_at = time(NULL);
+finished:
+    sem_post(&keys->mtx);
+    return ret;
+}
+
+int gquic_tls_ticket_keys_encrypt(gquic_str_t *const encrypted, gquic_tls_ticket_keys_t *const keys, const gquic_str_t *const state) {
+    int ret = 0;
+    int size = 0;
+    size_t mac_size = 0;
+    EVP_CIPHER_CTX *enc = NULL;
+    EVP_MAC_CTX *mac = NULL;
+    gquic_tls_ticket_keys_entry_t *entry = NULL;
+    if (encrypted == NULL || keys == NULL || state == NULL) {
+        return -1;
+    }
+    if (gquic_str_alloc(encrypted, 16 + 16 + GQUIC_STR_SIZE(state) + 32) != 0) {
+        return -2;
+    }
+    sem_wait(&keys->mtx);
+    gquic_tls_ticket_keys_maintain(keys, time(NULL));
+    if (keys->count == 0) {
+        sem_post(&keys->mtx);
+        ret = -3;
+        goto failure;
+    }
+    // copies keep the key schedule, the lock only covers picking the key
+    entry = &keys->entries[keys->current];
+    if ((enc = EVP_CIPHER_CTX_new()) == NULL || EVP_CIPHER_CTX_copy(enc, entry->enc) <= 0) {
+        sem_post(&keys->mtx);
+        ret = -4;
+        goto failure;
+    }
+    if ((mac = EVP_MAC_CTX_dup(entry->mac)) == NULL) {
+        sem_post(&keys->mtx);
+        ret = -5;
+        goto failure;
+    }
+    memcpy(GQUIC_STR_VAL(encrypted), entry->name, 16);
+    keys->encrypted++;
+    sem_post(&keys->mtx);
+
+    if (RAND_bytes(GQUIC_STR_VAL(encrypted) + 16, 16) <= 0) {
+        ret = -6;
+        goto failure;
+    }
+    if (EVP_EncryptInit_ex(enc, NULL, NULL, NULL, GQUIC_STR_VAL(encrypted) + 16) <= 0) {
+        ret = -7;
+        goto failure;
+    }
+    if (EVP_EncryptUpdate(enc, GQUIC_STR_VAL(encrypted) + 16 + 16, &size, GQUIC_STR_VAL(state), GQUIC_STR_SIZE(state)) <= 0) {
+        ret = -8;
+        goto failure;
+    }
+    if (EVP_EncryptFinal_ex(enc, GQUIC_STR_VAL(encrypted) + 16 + 16 + size, &size) <= 0) {
+        ret = -9;
+        goto failure;
+    }
+    if (EVP_MAC_update(mac, GQUIC_STR_VAL(encrypted), GQUIC_STR_SIZE(encrypted) - 32) <= 0) {
+        ret = -10;
+        goto failure;
+    }
+    if (EVP_MAC_final(mac, GQUIC_STR_VAL(encrypted) + GQUIC_STR_SIZE(encrypted) - 32, &mac_size, 32) <= 0) {
+        ret = -11;
+        goto failure;
+    }
+
+    EVP_CIPHER_CTX_free(enc);
+    EVP_MAC_CTX_free(mac);
+    return 0;
+failure:
+    if (enc != NULL) {
+        EVP_CIPHER_CTX_free(enc);
+    }
+    if (mac != NULL) {
+        EVP_MAC_CTX_free(mac);
+    }
+    gquic_str_reset(encrypted);
+    return ret;
+}
+
+int gquic_tls_ticket_keys_decrypt(gquic_str_t *const plain,
+                                  int *const is_oldkey,
+                                  gquic_tls_ticket_keys_t *const keys,
+                                  const gquic_str_t *const encrypted) {
+    int ret = 0;
+    int idx = 0;
+    int size = 0;
+    size_t mac_size = 0;
+    u_int8_t mac_cnt[32];
+    EVP_CIPHER_CTX *dec = NULL;
+    EVP_MAC_CTX *mac = NULL;
+    if (plain == NULL || is_oldkey == NULL || keys == NULL || encrypted == NULL) {
+        return -1;
+    }
+    *is_oldkey = 0;
+    // not one of ours, the client just gets a full handshake
+    if (GQUIC_STR_SIZE(encrypted) < 16 + 16 + 32) {
+        return 0;
+    }
+    const gquic_str_t iv = { 16, GQUIC_STR_VAL(encrypted) + 16 };
+    const gquic_str_t cipher_text = { GQUIC_STR_SIZE(encrypted) - 16 - 16 - 32, GQUIC_STR_VAL(encrypted) + 16 + 16 };
+    const u_int8_t *const tag = GQUIC_STR_VAL(encrypted) + GQUIC_STR_SIZE(encrypted) - 32;
+
+    sem_wait(&keys->mtx);
+    gquic_tls_ticket_keys_maintain(keys, time(NULL));
+    if ((idx = gquic_tls_ticket_keys_lookup(keys, GQUIC_STR_VAL(encrypted))) < 0) {
+        keys->unknown++;
+        sem_post(&keys->mtx);
+        return 0;
+    }
+    if ((dec = EVP_CIPHER_CTX_new()) == NULL || EVP_CIPHER_CTX_copy(dec, keys->entries[idx].dec) <= 0) {
+        sem_post(&keys->mtx);
+        ret = -2;
+        goto finished;
+    }
+    if ((mac = EVP_MAC_CTX_dup(keys->entries[idx].mac)) == NULL) {
+        sem_post(&keys->mtx);
+        ret = -3;
+        goto finished;
+    }
+    *is_oldkey = (size_t) idx != keys->current;
+    sem_post(&keys->mtx);
+
+    if (EVP_MAC_update(mac, GQUIC_STR_VAL(encrypted), GQUIC_STR_SIZE(encrypted) - 32) <= 0) {
+        ret = -4;
+        goto finished;
+    }
+    if (EVP_MAC_final(mac, mac_cnt, &mac_size, sizeof(mac_cnt)) <= 0) {
+        ret = -5;
+        goto finished;
+    }
+    if (CRYPTO_memcmp(mac_cnt, tag, sizeof(mac_cnt)) != 0) {
+        *is_oldkey = 0;
+        goto finished;
+    }
+    if (EVP_DecryptInit_ex(dec, NULL, NULL, NULL, GQUIC_STR_VAL(&iv)) <= 0) {
+        ret = -6;
+        goto finished;
+    }
+    if (gquic_str_alloc(plain, GQUIC_STR_SIZE(&cipher_text)) != 0) {
+        ret = -7;
+        goto finished;
+    }
+    if (EVP_DecryptUpdate(dec, GQUIC_STR_VAL(plain), &size, GQUIC_STR_VAL(&cipher_text), GQUIC_STR_SIZE(&cipher_text)) <= 0) {
+        ret = -8;
+        goto finished;
+    }
+    if (EVP_DecryptFinal_ex(dec, GQUIC_STR_VAL(plain) + size, &size) <= 0) {
+        ret = -9;
+        goto finished;
+    }
+    sem_wait(&keys->mtx);
+    keys->decrypted++;
+    if (*is_oldkey) {
+        keys->decrypted_old++;
+    }
+    sem_post(&keys->mtx);
+finished:
+    if (ret != 0) {
+        *is_oldkey = 0;
+        gquic_str_reset(plain);
+    }
+    if (dec != NULL) {
+        EVP_CIPHER_CTX_free(dec);
+    }
+    if (mac != NULL) {
+        EVP_MAC_CTX_free(mac);
+    }
+    return ret;
+}
+
+static int gquic_tls_ticket_keys_entry_ctor(gquic_tls_ticket_keys_entry_t *const entry, EVP_MAC *const hmac, const u_int8_t *const secret) {
+    int ret = 0;
+    gquic_tls_ticket_key_t key;
+    OSSL_PARAM params[] = {
+        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, "SHA256", 0),
+        OSSL_PARAM_construct_end()
+    };
+    if (gquic_tls_ticket_key_deserialize(&key, secret, GQUIC_TLS_TICKET_KEYS_SECRET_SIZE) != 0) {
+        return -1;
+    }
+    memcpy(entry->name, key.name, 16);
+    if ((entry->enc = EVP_CIPHER_CTX_new()) == NULL
+        || EVP_EncryptInit_ex(entry->enc, EVP_aes_128_ctr(), NULL, key.aes_key, NULL) <= 0) {
+        ret = -2;
+        goto finished;
+    }
+    if ((entry->dec = EVP_CIPHER_CTX_new()) == NULL
+        || EVP_DecryptInit_ex(entry->dec, EVP_aes_128_ctr(), NULL, key.aes_key, NULL) <= 0) {
+        ret = -3;
+        goto finished;
+    }
+    if ((entry->mac = EVP_MAC_CTX_new(hmac)) == NULL
+        || EVP_MAC_init(entry->mac, key.hmac_key, sizeof(key.hmac_key), params) <= 0) {
+        ret = -4;
+        goto finished;
+    }
+finished:
+    if (ret != 0) {
+        gquic_tls_ticket_keys_entry_dtor(entry);
+    }
+    OPENSSL_cleanse(&key, sizeof(key));
+    return ret;
+}
+
+static int gquic_tls_ticket_keys_entry_dtor(gquic_tls_ticket_keys_entry_t *const entry) {
+    if (entry->enc != NULL) {
+        EVP_CIPHER_CTX_free(entry->enc);
+    }
+    if (entry->dec != NULL) {
+        EVP_CIPHER_CTX_free(entry->dec);
+    }
+    if (entry->mac != NULL) {
+        EVP_MAC_CTX_free(entry->mac);
+    }
+    memset(entry, 0, sizeof(gquic_tls_ticket_keys_entry_t));
+    return 0;
+}
+
+static int gquic_tls_ticket_keys_push(gquic_tls_ticket_keys_t *const keys, const u_int8_t *const secret) {
+    gquic_tls_ticket_keys_entry_t entry;
+    size_t slot = 0;
+    memset(&entry, 0, sizeof(entry));
+    if (gquic_tls_ticket_keys_entry_ctor(&entry, keys->hmac, secret) != 0) {
+        return -1;
+    }
+    // older keys follow the current one around the ring, the oldest is overwritten
+    slot = keys->count == 0 ? 0 : (keys->current + keys->keep - 1) % keys->keep;
+    gquic_tls_ticket_keys_entry_dtor(&keys->entries[slot]);
+    keys->entries[slot] = entry;
+    keys->current = slot;
+    if (keys->count < keys->keep) {
+        keys->count++;
+    }
+    return gquic_tls_ticket_keys_reindex(keys);
+}
+
+static int gquic_tls_ticket_keys_replace(gquic_tls_ticket_keys_t *const keys, const u_int8_t *const secrets, const size_t count) {
+    gquic_tls_ticket_keys_entry_t *entries = NULL;
+    size_t n = count < keys->keep ? count : keys->keep;
+    size_t i;
+    if ((entries = calloc(keys->keep, sizeof(gquic_tls_ticket_keys_entry_t))) == NULL) {
+        return -1;
+    }
+    // all or nothing, a bad secret leaves the old keys in place
+    for (i = 0; i < n; i++) {
+        if (gquic_tls_ticket_keys_entry_ctor(&entries[i], keys->hmac, secrets + i * GQUIC_TLS_TICKET_KEYS_SECRET_SIZE) != 0) {
+            while (i-- > 0) {
+                gquic_tls_ticket_keys_entry_dtor(&entries[i]);
+            }
+            free(entries);
+            return -2;
+        }
+    }
+    for (i = 0; i < keys->keep; i++) {
+        gquic_tls_ticket_keys_entry_dtor(&keys->entries[i]);
+    }
+    free(keys->entries);
+    keys->entries = entries;
+    keys->current = 0;
+    keys->count = n;
+    keys->rotated_at = time(NULL);
+    return gquic_tls_ticket_keys_reindex(keys);
+}
+
+static int gquic_tls_ticket_keys_reindex(gquic_tls_ticket_keys_t *const keys) {
+    u_int64_t hash = 0;
+    size_t idx = 0;
+    size_t i;
+    memset(keys->index, 0, sizeof(size_t) * (keys->index_mask + 1));
+    for (i = 0; i < keys->count; i++) {
+        idx = (keys->current + i) % keys->keep;
+        // names are hash output already
+        memcpy(&hash, keys->entries[idx].name, sizeof(hash));
+        for (hash &= keys->index_mask; keys->index[hash] != 0; hash = (hash + 1) & keys->index_mask);
+        keys->index[hash] = idx + 1;
+    }
+    return 0;
+}
+
+static int gquic_tls_ticket_keys_lookup(gquic_tls_ticket_keys_t *const keys, const u_int8_t *const name) {
+    u_int64_t hash = 0;
+    memcpy(&hash, name, sizeof(hash));
+    for (hash &= keys->index_mask; keys->index[hash] != 0; hash = (hash + 1) & keys->index_mask) {
+        if (memcmp(keys->entries[keys->index[hash] - 1].name, name, 16) == 0) {
+            return keys->index[hash] - 1;
+        }
+    }
+    return -1;
+}
+
+static int gquic_tls_ticket_keys_read_file(gquic_tls_ticket_keys_t *const keys, time_t *const mtime) {
+    int ret = 0;
+    FILE *fp = NULL;
+    struct stat st;
+    u_int8_t *secrets = NULL;
+    size_t count = 0;
+    if ((fp = fopen(GQUIC_STR_VAL(&keys->path), "rb")) == NULL) {
+        return -1;
+    }
+    if (fstat(fileno(fp), &st) != 0) {
+        ret = -2;
+        goto finished;
+    }
+    // a file caught half written is left for the next check
+    if (st.st_size == 0 || st.st_size % GQUIC_TLS_TICKET_KEYS_SECRET_SIZE != 0) {
+        ret = -3;
+        goto finished;
+    }
+    count = st.st_size / GQUIC_TLS_TICKET_KEYS_SECRET_SIZE;
+    if (count > keys->keep) {
+        count = keys->keep;
+    }
+    if ((secrets = malloc(count * GQUIC_TLS_TICKET_KEYS_SECRET_SIZE)) == NULL) {
+        ret = -4;
+        goto finished;
+    }
+    if (fread(secrets, GQUIC_TLS_TICKET_KEYS_SECRET_SIZE, count, fp) != count) {
+        ret = -5;
+        goto finished;
+    }
+    if (gquic_tls_ticket_keys_replace(keys, secrets, count) != 0) {
+        ret = -6;
+        goto finished;
+    }
+    *mtime = st.st_mtime;
+finished:
+    if (secrets != NULL) {
+        OPENSSL_cleanse(secrets, count * GQUIC_TLS_TICKET_KEYS_SECRET_SIZE);
+        free(secrets);
+    }
+    fclose(fp);
+    return ret;
+}
+
+static int gquic_tls_ticket_keys_maintain(gquic_tls_ticket_keys_t *const keys, const time_t now) {
+    struct stat st;
+    time_t mtime = 0;
+    u_int8_t secret[GQUIC_TLS_TICKET_KEYS_SECRET_SIZE];
+    if (GQUIC_STR_SIZE(&keys->path) != 0) {
+        if (now < keys->checked_at + GQUIC_TLS_TICKET_KEYS_FILE_CHECK_INTERVAL) {
+            return 0;
+        }
+        keys->checked_at = now;
+        if (stat(GQUIC_STR_VAL(&keys->path), &st) != 0 || st.st_mtime == keys->mtime) {
+            return 0;
+        }
+        // keep serving the old keys if the new file is unusable
+        if (gquic_tls_ticket_keys_read_file(keys, &mtime) == 0) {
+            keys->mtime = mtime;
+        }
+        return 0;
+    }
+    if (now < keys->rotated_at + keys->interval) {
+        return 0;
+    }
+    if (RAND_bytes(secret, sizeof(secret)) <= 0) {
+        return -1;
+    }
+    if (gquic_tls_ticket_keys_push(keys, secret) == 0) {
+        keys->rotated_at = now;
+    }
+    OPENSSL_cleanse(secret, sizeof(secret));
+    return 0;
+}
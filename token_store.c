@@ -0,0 +1,151 @@
+#include "token_store.h"
+#include <string.h>
+
+static gquic_lru_token_store_entry_t *gquic_lru_token_store_find(gquic_lru_token_store_t *const, const gquic_str_t *const);
+static int gquic_lru_token_store_entry_release(gquic_lru_token_store_entry_t *const);
+static int gquic_lru_token_store_pop_wrapper(gquic_str_t *const, void *const, const gquic_str_t *const);
+static int gquic_lru_token_store_put_wrapper(void *const, const gquic_str_t *const, const gquic_str_t *const);
+
+int gquic_lru_token_store_init(gquic_lru_token_store_t *const store) {
+    if (store == NULL) {
+        return -1;
+    }
+    store->base.self = store;
+    store->base.pop = gquic_lru_token_store_pop_wrapper;
+    store->base.put = gquic_lru_token_store_put_wrapper;
+    sem_init(&store->mtx, 0, 1);
+    gquic_list_head_init(&store->q);
+    store->count = 0;
+    store->cap = GQUIC_LRU_TOKEN_STORE_DEFAULT_CAP;
+    return 0;
+}
+
+int gquic_lru_token_store_ctor(gquic_lru_token_store_t *const store, const size_t cap) {
+    if (store == NULL) {
+        return -1;
+    }
+    if (cap != 0) {
+        store->cap = cap;
+    }
+    return 0;
+}
+
+int gquic_lru_token_store_dtor(gquic_lru_token_store_t *const store) {
+    if (store == NULL) {
+        return -1;
+    }
+    while (!gquic_list_head_empty(&store->q)) {
+        gquic_lru_token_store_entry_release(GQUIC_LIST_FIRST(&store->q));
+    }
+    store->count = 0;
+    sem_destroy(&store->mtx);
+    return 0;
+}
+
+int gquic_lru_token_store_pop(gquic_str_t *const token, gquic_lru_token_store_t *const store, const gquic_str_t *const key) {
+    gquic_lru_token_store_entry_t *entry = NULL;
+    int ret = 0;
+    if (token == NULL || store == NULL || key == NULL) {
+        return -1;
+    }
+    sem_wait(&store->mtx);
+    if ((entry = gquic_lru_token_store_find(store, key)) == NULL) {
+        ret = -2;
+        goto finished;
+    }
+    // newest first, the token is handed over and forgotten
+    *token = entry->tokens[entry->head];
+    gquic_str_init(&entry->tokens[entry->head]);
+    entry->head = (entry->head + GQUIC_LRU_TOKEN_STORE_TOKENS_PER_SERVER - 1) % GQUIC_LRU_TOKEN_STORE_TOKENS_PER_SERVER;
+    if (--entry->count == 0) {
+        gquic_lru_token_store_entry_release(entry);
+        store->count--;
+        goto finished;
+    }
+    gquic_list_remove(entry);
+    gquic_list_insert_after(&store->q, entry);
+finished:
+    sem_post(&store->mtx);
+    return ret;
+}
+
+int gquic_lru_token_store_put(gquic_lru_token_store_t *const store, const gquic_str_t *const key, const gquic_str_t *const token) {
+    gquic_lru_token_store_entry_t *entry = NULL;
+    gquic_str_t copy = { 0, NULL };
+    size_t i;
+    int ret = 0;
+    if (store == NULL || key == NULL || token == NULL) {
+        return -1;
+    }
+    if (gquic_str_copy(&copy, token) != 0) {
+        return -2;
+    }
+    sem_wait(&store->mtx);
+    if ((entry = gquic_lru_token_store_find(store, key)) != NULL) {
+        gquic_list_remove(entry);
+    }
+    else {
+        if (store->count >= store->cap) {
+            gquic_lru_token_store_entry_release(GQUIC_LIST_LAST(&store->q));
+            store->count--;
+        }
+        if ((entry = gquic_list_alloc(sizeof(gquic_lru_token_store_entry_t))) == NULL) {
+            gquic_str_reset(&copy);
+            ret = -3;
+            goto finished;
+        }
+        gquic_str_init(&entry->key);
+        for (i = 0; i < GQUIC_LRU_TOKEN_STORE_TOKENS_PER_SERVER; i++) {
+            gquic_str_init(&entry->tokens[i]);
+        }
+        entry->head = 0;
+        entry->count = 0;
+        if (gquic_str_copy(&entry->key, key) != 0) {
+            gquic_str_reset(&copy);
+            gquic_list_release(entry);
+            ret = -4;
+            goto finished;
+        }
+        store->count++;
+    }
+    // a full ring overwrites its oldest token
+    entry->head = (entry->head + 1) % GQUIC_LRU_TOKEN_STORE_TOKENS_PER_SERVER;
+    gquic_str_reset(&entry->tokens[entry->head]);
+    entry->tokens[entry->head] = copy;
+    if (entry->count < GQUIC_LRU_TOKEN_STORE_TOKENS_PER_SERVER) {
+        entry->count++;
+    }
+    gquic_list_insert_after(&store->q, entry);
+finished:
+    sem_post(&store->mtx);
+    return ret;
+}
+
+static gquic_lru_token_store_entry_t *gquic_lru_token_store_find(gquic_lru_token_store_t *const store, const gquic_str_t *const key) {
+    gquic_lru_token_store_entry_t *entry = NULL;
+    // a client talks to few enough servers that a walk beats keeping an index
+    GQUIC_LIST_FOREACH(entry, &store->q) {
+        if (gquic_str_cmp(&entry->key, key) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static int gquic_lru_token_store_entry_release(gquic_lru_token_store_entry_t *const entry) {
+    size_t i;
+    gquic_str_reset(&entry->key);
+    for (i = 0; i < GQUIC_LRU_TOKEN_STORE_TOKENS_PER_SERVER; i++) {
+        gquic_str_reset(&entry->tokens[i]);
+    }
+    gquic_list_release(entry);
+    return 0;
+}
+
+static int gquic_lru_token_store_pop_wrapper(gquic_str_t *const token, void *const store, const gquic_str_t *const key) {
+    return gquic_lru_token_store_pop(token, store, key);
+}
+
+static int gquic_lru_token_store_put_wrapper(void *const store, const gquic_str_t *const key, const gquic_str_t *const token) {
+    return gquic_lru_token_store_put(store, key, token);
+}
@@ -0,0 +1,64 @@
+#include "util/max_filter.h"
+#include <stddef.h>
+
+int gquic_max_filter_init(gquic_max_filter_t *const filter, const u_int64_t window) {
+    if (filter == NULL) {
+        return -1;
+    }
+    filter->window = window;
+    gquic_max_filter_reset(filter, 0, 0);
+    return 0;
+}
+
+int gquic_max_filter_reset(gquic_max_filter_t *const filter, const u_int64_t val, const u_int64_t time) {
+    if (filter == NULL) {
+        return -1;
+    }
+    filter->estimates[0].val = val;
+    filter->estimates[0].time = time;
+    filter->estimates[1] = filter->estimates[0];
+    filter->estimates[2] = filter->estimates[0];
+    return 0;
+}
+
+int gquic_max_filter_update(gquic_max_filter_t *const filter, const u_int64_t val, const u_int64_t time) {
+    gquic_max_filter_sample_t *estimates = NULL;
+    gquic_max_filter_sample_t sample = { val, time };
+    if (filter == NULL) {
+        return -1;
+    }
+    estimates = filter->estimates;
+    // a new max, or nothing seen for a whole window
+    if (estimates[0].val == 0 || val >= estimates[0].val || time - estimates[2].time > filter->window) {
+        return gquic_max_filter_reset(filter, val, time);
+    }
+    if (val >= estimates[1].val) {
+        estimates[1] = sample;
+        estimates[2] = sample;
+    }
+    else if (val >= estimates[2].val) {
+        estimates[2] = sample;
+    }
+
+    // the best estimate fell out of the window, the others move up
+    if (time - estimates[0].time > filter->window) {
+        estimates[0] = estimates[1];
+        estimates[1] = estimates[2];
+        estimates[2] = sample;
+        if (time - estimates[0].time > filter->window) {
+            estimates[0] = estimates[1];
+            estimates[1] = estimates[2];
+        }
+        return 0;
+    }
+    // keep the second and third best from a later part of the window than the best
+    if (estimates[1].val == estimates[0].val && time - estimates[1].time > filter->window / 4) {
+        estimates[1] = sample;
+        estimates[2] = sample;
+        return 0;
+    }
+    if (estimates[2].val == estimates[1].val && time - estimates[2].time > filter->window / 2) {
+        estimates[2] = sample;
+    }
+    return 0;
+}
@@ -32,7 +32,7 @@ int gquic_rtt_update(gquic_rtt_t *rtt, const u_int64_t send, const u_int64_t ack
         rtt->mean_dev = sample / 2;
     }
     else {
-        rtt->mean_dev = 0.75 * rtt->mean_dev + 0.25 * fabs((double) (rtt->smooth - sample));
+        rtt->mean_dev = 0.75 * rtt->mean_dev + 0.25 * fabs((double) rtt->smooth - (double) sample);
         rtt->smooth = 0.875 * rtt->smooth + 0.125 * sample;
     }
     return 0;